@@ -65,6 +65,7 @@ either expressed or implied, of the Regents of The University of Michigan.
 
 extern zarray_t *apriltag_quad_gradient(apriltag_detector_t *td, image_u8_t *im);
 extern zarray_t *apriltag_quad_thresh(apriltag_detector_t *td, image_u8_t *im);
+extern void apriltag_quad_thresh_workspace_destroy(struct apriltag_quad_thresh_workspace *ws);
 
 // Regresses a model of the form:
 // intensity(x,y) = C0*x + C1*y + CC2
@@ -387,6 +388,7 @@ void apriltag_detector_destroy(apriltag_detector_t *td)
 {
     timeprofile_destroy(td->tp);
     workerpool_destroy(td->wp);
+    apriltag_quad_thresh_workspace_destroy(td->qtw);
 
     apriltag_detector_clear_families(td);
 
@@ -198,6 +198,10 @@ struct apriltag_detector
 
     // Used for thread safety.
     pthread_mutex_t mutex;
+
+    // Working memory of the quad detection, kept from one call to
+    // apriltag_detector_detect() to the other. (ViSP)
+    struct apriltag_quad_thresh_workspace *qtw;
 };
 
 // Represents the detection of a tag. These are returned to the user
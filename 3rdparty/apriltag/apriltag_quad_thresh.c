@@ -53,6 +53,11 @@ either expressed or implied, of the Regents of The University of Michigan.
 #define random rand
 #endif
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define APRILTAG_HAVE_SSE2 1
+#endif
+
 static inline uint32_t u64hash_2(uint64_t x) {
     return (2654435761 * x) >> 32;
     return (uint32_t) x;
@@ -64,6 +69,10 @@ struct uint64_zarray_entry
     zarray_t *cluster;
 
     struct uint64_zarray_entry *next;
+
+    // bucket of the entry in the cluster map, and creation rank
+    uint32_t bucket;
+    int order;
 };
 
 #ifndef M_PI
@@ -86,6 +95,12 @@ struct unionfind_task
     image_u8_t *im;
 };
 
+struct quad_fit_scratch
+{
+    struct line_fit_pt *lfps;
+    int lfps_alloc;
+};
+
 struct quad_task
 {
     zarray_t *clusters;
@@ -95,8 +110,104 @@ struct quad_task
     int w, h;
 
     image_u8_t *im;
+    struct quad_fit_scratch *scratch;
 };
 
+// Working memory of apriltag_quad_thresh(). It is owned by the detector
+// and the buffers only grow, so that once they fit the image size the
+// detection does not allocate memory anymore. (ViSP)
+struct apriltag_quad_thresh_workspace
+{
+    // threshold image, with the stride of the input image
+    image_u8_t threshim;
+    size_t threshim_alloc;
+
+    // min/max of the tiles, before and after the 3x3 dilation
+    uint8_t *tiles;
+    size_t tiles_alloc;
+
+    unionfind_t uf;
+    uint32_t uf_alloc;
+
+    // cluster hash map. All the buckets are NULL between two calls.
+    struct uint64_zarray_entry **clustermap;
+    int clustermap_alloc;
+
+    // entries of the cluster map with their points; the first nentries
+    // ones are used by the current call.
+    struct uint64_zarray_entry **entries;
+    int nentries, entries_size, entries_alloc;
+
+    zarray_t *clusters;
+
+    // quad fitting buffers, one per quad task
+    struct quad_fit_scratch *scratch;
+    int scratch_size;
+};
+
+static void *workspace_grow(void *buf, size_t *alloc, size_t size)
+{
+    if (size <= *alloc)
+        return buf;
+
+    free(buf);
+    *alloc = size;
+    return malloc(size);
+}
+
+static struct uint64_zarray_entry *workspace_new_entry(struct apriltag_quad_thresh_workspace *ws)
+{
+    if (ws->nentries == ws->entries_size) {
+        if (ws->entries_size == ws->entries_alloc) {
+            ws->entries_alloc = ws->entries_alloc ? 2*ws->entries_alloc : 256;
+            ws->entries = realloc(ws->entries, ws->entries_alloc * sizeof *ws->entries);
+        }
+
+        struct uint64_zarray_entry *entry = calloc(1, sizeof(struct uint64_zarray_entry));
+        entry->cluster = zarray_create(sizeof(struct pt));
+        ws->entries[ws->entries_size++] = entry;
+    }
+
+    struct uint64_zarray_entry *entry = ws->entries[ws->nentries];
+    entry->order = ws->nentries++;
+    zarray_clear(entry->cluster);
+    return entry;
+}
+
+// order of the clusters of the original hash map traversal: by bucket,
+// and the last added entry first in a bucket.
+static int entry_compare_bucket(const void *_a, const void *_b)
+{
+    const struct uint64_zarray_entry *a = *(struct uint64_zarray_entry* const*) _a;
+    const struct uint64_zarray_entry *b = *(struct uint64_zarray_entry* const*) _b;
+
+    if (a->bucket != b->bucket)
+        return (a->bucket < b->bucket) ? -1 : 1;
+    return b->order - a->order;
+}
+
+void apriltag_quad_thresh_workspace_destroy(struct apriltag_quad_thresh_workspace *ws)
+{
+    if (!ws)
+        return;
+
+    free(ws->threshim.buf);
+    free(ws->tiles);
+    free(ws->uf.data);
+    free(ws->clustermap);
+    for (int i = 0; i < ws->entries_size; i++) {
+        zarray_destroy(ws->entries[i]->cluster);
+        free(ws->entries[i]);
+    }
+    free(ws->entries);
+    if (ws->clusters)
+        zarray_destroy(ws->clusters);
+    for (int i = 0; i < ws->scratch_size; i++)
+        free(ws->scratch[i].lfps);
+    free(ws->scratch);
+    free(ws);
+}
+
 struct remove_vertex
 {
     int i;           // which vertex to remove?
@@ -735,7 +846,7 @@ int quad_segment_agg(apriltag_detector_t *td, zarray_t *cluster, struct line_fit
 }
 
 // return 1 if the quad looks okay, 0 if it should be discarded
-int fit_quad(apriltag_detector_t *td, image_u8_t *im, zarray_t *cluster, struct quad *quad)
+int fit_quad(apriltag_detector_t *td, image_u8_t *im, zarray_t *cluster, struct quad *quad, struct quad_fit_scratch *scratch)
 {
     int res = 0;
 
@@ -903,7 +1014,18 @@ int fit_quad(apriltag_detector_t *td, image_u8_t *im, zarray_t *cluster, struct
     // Step 2. Precompute statistics that allow line fit queries to be
     // efficiently computed for any contiguous range of indices.
 
-    struct line_fit_pt *lfps = calloc(sz, sizeof(struct line_fit_pt));
+    struct line_fit_pt *lfps;
+    if (scratch) {
+        if (scratch->lfps_alloc < sz) {
+            free(scratch->lfps);
+            scratch->lfps = malloc(sz * sizeof(struct line_fit_pt));
+            scratch->lfps_alloc = sz;
+        }
+        lfps = scratch->lfps;
+        memset(&lfps[0], 0, sizeof(struct line_fit_pt));
+    } else {
+        lfps = calloc(sz, sizeof(struct line_fit_pt));
+    }
 
     for (int i = 0; i < sz; i++) {
         struct pt *p;
@@ -1167,7 +1289,8 @@ int fit_quad(apriltag_detector_t *td, image_u8_t *im, zarray_t *cluster, struct
 */
   finish:
 
-    free(lfps);
+    if (!scratch)
+        free(lfps);
 
     return res;
 }
@@ -1237,7 +1360,7 @@ static void do_quad_task(void *p)
         struct quad quad;
         memset(&quad, 0, sizeof(struct quad));
 
-        if (fit_quad(td, task->im, cluster, &quad)) {
+        if (fit_quad(td, task->im, cluster, &quad, task->scratch)) {
             pthread_mutex_lock(&td->mutex);
 
             zarray_add(quads, &quad);
@@ -1252,8 +1375,13 @@ image_u8_t *threshold(apriltag_detector_t *td, image_u8_t *im)
     assert(w < 32768);
     assert(h < 32768);
 
-    image_u8_t *threshim = image_u8_create_alignment(w, h, s);
-    assert(threshim->stride == s);
+    struct apriltag_quad_thresh_workspace *ws = td->qtw;
+    uint8_t *buf = workspace_grow(ws->threshim.buf, &ws->threshim_alloc, (size_t) h * s);
+
+    // const initializer
+    image_u8_t tmp = { .width = w, .height = h, .stride = s, .buf = buf };
+    memcpy(&ws->threshim, &tmp, sizeof(image_u8_t));
+    image_u8_t *threshim = &ws->threshim;
 
     // The idea is to find the maximum and minimum values in a
     // window around each pixel. If it's a contrast-free region
@@ -1285,12 +1413,45 @@ image_u8_t *threshold(apriltag_detector_t *td, image_u8_t *im)
     int tw = w / tilesz;
     int th = h / tilesz;
 
-    uint8_t *im_max = calloc(tw*th, sizeof(uint8_t));
-    uint8_t *im_min = calloc(tw*th, sizeof(uint8_t));
+    ws->tiles = workspace_grow(ws->tiles, &ws->tiles_alloc, 4 * (size_t) tw * th);
+    uint8_t *im_max = ws->tiles;
+    uint8_t *im_min = im_max + tw*th;
 
     // first, collect min/max statistics for each tile
     for (int ty = 0; ty < th; ty++) {
-        for (int tx = 0; tx < tw; tx++) {
+        int tx = 0;
+
+#if APRILTAG_HAVE_SSE2
+        // 4 tiles at a time: min/max of the 4 rows, then of the 4
+        // columns of each tile, whose result is in the lowest byte of
+        // each 32 bits lane.
+        const __m128i lowest_byte = _mm_set1_epi32(0xff);
+        for (; tx + 4 <= tw; tx += 4) {
+            const uint8_t *row = &im->buf[(ty*tilesz)*s + tx*tilesz];
+            __m128i vmin = _mm_loadu_si128((const __m128i*) row);
+            __m128i vmax = vmin;
+            for (int dy = 1; dy < tilesz; dy++) {
+                __m128i v = _mm_loadu_si128((const __m128i*) (row + dy*s));
+                vmin = _mm_min_epu8(vmin, v);
+                vmax = _mm_max_epu8(vmax, v);
+            }
+            vmin = _mm_min_epu8(vmin, _mm_srli_epi32(vmin, 8));
+            vmin = _mm_min_epu8(vmin, _mm_srli_epi32(vmin, 16));
+            vmax = _mm_max_epu8(vmax, _mm_srli_epi32(vmax, 8));
+            vmax = _mm_max_epu8(vmax, _mm_srli_epi32(vmax, 16));
+
+            vmin = _mm_and_si128(vmin, lowest_byte);
+            vmin = _mm_packus_epi16(_mm_packs_epi32(vmin, vmin), vmin);
+            vmax = _mm_and_si128(vmax, lowest_byte);
+            vmax = _mm_packus_epi16(_mm_packs_epi32(vmax, vmax), vmax);
+
+            int32_t mins = _mm_cvtsi128_si32(vmin), maxs = _mm_cvtsi128_si32(vmax);
+            memcpy(&im_min[ty*tw+tx], &mins, 4);
+            memcpy(&im_max[ty*tw+tx], &maxs, 4);
+        }
+#endif
+
+        for (; tx < tw; tx++) {
             uint8_t max = 0, min = 255;
 
             for (int dy = 0; dy < tilesz; dy++) {
@@ -1314,8 +1475,8 @@ image_u8_t *threshold(apriltag_detector_t *td, image_u8_t *im)
     // over larger areas. This reduces artifacts due to abrupt changes
     // in the threshold value.
     if (1) {
-        uint8_t *im_max_tmp = calloc(tw*th, sizeof(uint8_t));
-        uint8_t *im_min_tmp = calloc(tw*th, sizeof(uint8_t));
+        uint8_t *im_max_tmp = im_min + tw*th;
+        uint8_t *im_min_tmp = im_max_tmp + tw*th;
 
         for (int ty = 0; ty < th; ty++) {
             for (int tx = 0; tx < tw; tx++) {
@@ -1341,14 +1502,55 @@ image_u8_t *threshold(apriltag_detector_t *td, image_u8_t *im)
                 im_min_tmp[ty*tw + tx] = min;
             }
         }
-        free(im_max);
-        free(im_min);
         im_max = im_max_tmp;
         im_min = im_min_tmp;
     }
 
     for (int ty = 0; ty < th; ty++) {
-        for (int tx = 0; tx < tw; tx++) {
+        int tx = 0;
+
+#if APRILTAG_HAVE_SSE2
+        // 4 tiles at a time, with the min/max of each tile repeated
+        // over its 4 columns. A pixel is white if it is strictly above
+        // the threshold, that is if the saturated difference is not 0.
+        if (td->qtp.min_white_black_diff <= 255) {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i ones = _mm_set1_epi8(-1);
+            const __m128i gray = _mm_set1_epi8(127);
+            const __m128i min_diff = _mm_set1_epi8((char) (td->qtp.min_white_black_diff > 0 ? td->qtp.min_white_black_diff : 0));
+
+            for (; tx + 4 <= tw; tx += 4) {
+                int32_t mins, maxs;
+                memcpy(&mins, &im_min[ty*tw + tx], 4);
+                memcpy(&maxs, &im_max[ty*tw + tx], 4);
+
+                __m128i vmin = _mm_cvtsi32_si128(mins);
+                vmin = _mm_unpacklo_epi8(vmin, vmin);
+                vmin = _mm_unpacklo_epi16(vmin, vmin);
+                __m128i vmax = _mm_cvtsi32_si128(maxs);
+                vmax = _mm_unpacklo_epi8(vmax, vmax);
+                vmax = _mm_unpacklo_epi16(vmax, vmax);
+
+                // low contrast: max - min < min_white_black_diff
+                __m128i diff = _mm_subs_epu8(vmax, vmin);
+                __m128i low = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_subs_epu8(min_diff, diff), zero), ones);
+                __m128i low_value = _mm_and_si128(low, gray);
+
+                // min + (max - min) / 2
+                __m128i thresh = _mm_add_epi8(vmin, _mm_and_si128(_mm_srli_epi16(diff, 1), _mm_set1_epi8(0x7f)));
+
+                for (int dy = 0; dy < tilesz; dy++) {
+                    const int offset = (ty*tilesz + dy)*s + tx*tilesz;
+                    __m128i v = _mm_loadu_si128((const __m128i*) &im->buf[offset]);
+                    __m128i black = _mm_cmpeq_epi8(_mm_subs_epu8(v, thresh), zero);
+                    __m128i white = _mm_andnot_si128(_mm_or_si128(black, low), ones);
+                    _mm_storeu_si128((__m128i*) &threshim->buf[offset], _mm_or_si128(white, low_value));
+                }
+            }
+        }
+#endif
+
+        for (; tx < tw; tx++) {
 
             int min = im_min[ty*tw + tx];
             int max = im_max[ty*tw + tx];
@@ -1426,9 +1628,6 @@ image_u8_t *threshold(apriltag_detector_t *td, image_u8_t *im)
         }
     }
 
-    free(im_min);
-    free(im_max);
-
     // this is a dilate/erode deglitching scheme that does not improve
     // anything as far as I can tell.
     if (0 || td->qtp.deglitch) {
@@ -1596,6 +1795,10 @@ zarray_t *apriltag_quad_thresh(apriltag_detector_t *td, image_u8_t *im)
 
     int w = im->width, h = im->height;
 
+    if (!td->qtw)
+        td->qtw = calloc(1, sizeof(struct apriltag_quad_thresh_workspace));
+    struct apriltag_quad_thresh_workspace *ws = td->qtw;
+
     image_u8_t *threshim = threshold(td, im);
     int ts = threshim->stride;
 
@@ -1605,7 +1808,17 @@ zarray_t *apriltag_quad_thresh(apriltag_detector_t *td, image_u8_t *im)
     ////////////////////////////////////////////////////////
     // step 2. find connected components.
 
-    unionfind_t *uf = unionfind_create(w * h);
+    unionfind_t *uf = &ws->uf;
+    if (ws->uf_alloc < (uint32_t) (w * h + 1)) {
+        free(uf->data);
+        ws->uf_alloc = w * h + 1;
+        uf->data = malloc(ws->uf_alloc * sizeof(struct ufrec));
+    }
+    uf->maxid = w * h;
+    for (uint32_t i = 0; i <= uf->maxid; i++) {
+        uf->data[i].size = 1;
+        uf->data[i].parent = i;
+    }
 
     if (td->nthreads <= 1) {
         for (int y = 0; y < h - 1; y++) {
@@ -1653,7 +1866,13 @@ zarray_t *apriltag_quad_thresh(apriltag_detector_t *td, image_u8_t *im)
     // XXX sizing??
     int nclustermap = 2*w*h - 1;
 
-    struct uint64_zarray_entry **clustermap = calloc(nclustermap, sizeof(struct uint64_zarray_entry*));
+    if (ws->clustermap_alloc < nclustermap) {
+        free(ws->clustermap);
+        ws->clustermap = calloc(nclustermap, sizeof(struct uint64_zarray_entry*));
+        ws->clustermap_alloc = nclustermap;
+    }
+    struct uint64_zarray_entry **clustermap = ws->clustermap;
+    ws->nentries = 0;
 
     for (int y = 1; y < h-1; y++) {
         for (int x = 1; x < w-1; x++) {
@@ -1705,9 +1924,9 @@ zarray_t *apriltag_quad_thresh(apriltag_detector_t *td, image_u8_t *im)
                     }                                                   \
                                                                         \
                     if (!entry) {                                       \
-                        entry = calloc(1, sizeof(struct uint64_zarray_entry)); \
+                        entry = workspace_new_entry(ws);                \
                         entry->id = clusterid;                          \
-                        entry->cluster = zarray_create(sizeof(struct pt)); \
+                        entry->bucket = clustermap_bucket;              \
                         entry->next = clustermap[clustermap_bucket];    \
                         clustermap[clustermap_bucket] = entry;          \
                     }                                                   \
@@ -1728,8 +1947,6 @@ zarray_t *apriltag_quad_thresh(apriltag_detector_t *td, image_u8_t *im)
     }
 #undef DO_CONN
 
-    image_u8_destroy(threshim);
-
     // make segmentation image.
     if (td->debug) {
         image_u8x3_t *d = image_u8x3_create(w, h);
@@ -1772,14 +1989,18 @@ zarray_t *apriltag_quad_thresh(apriltag_detector_t *td, image_u8_t *im)
 
     ////////////////////////////////////////////////////////
     // step 3. process each connected component.
-    zarray_t *clusters = zarray_create(sizeof(zarray_t*)); //, uint64_zarray_hash_size(clustermap));
+    if (!ws->clusters)
+        ws->clusters = zarray_create(sizeof(zarray_t*));
+    zarray_t *clusters = ws->clusters;
+    zarray_clear(clusters);
     if (1) {
-        for (int i = 0; i < nclustermap; i++) {
+        // same order as a traversal of the hash map, without reading
+        // all its buckets.
+        qsort(ws->entries, ws->nentries, sizeof *ws->entries, entry_compare_bucket);
 
-            for (struct uint64_zarray_entry *entry = clustermap[i]; entry; entry = entry->next) {
-                // XXX reject clusters here?
-                zarray_add(clusters, &entry->cluster);
-            }
+        for (int i = 0; i < ws->nentries; i++) {
+            // XXX reject clusters here?
+            zarray_add(clusters, &ws->entries[i]->cluster);
         }
     }
 
@@ -1816,17 +2037,9 @@ zarray_t *apriltag_quad_thresh(apriltag_detector_t *td, image_u8_t *im)
         image_u8x3_destroy(d);
     }
 
-    if (1) {
-      for (int i = 0; i < nclustermap; i++) {
-        struct uint64_zarray_entry *entry = clustermap[i];
-        while (entry) {
-          struct uint64_zarray_entry *tmp = entry->next;
-          free(entry);
-          entry = tmp;
-        }
-      }
-      free(clustermap);
-    }
+    // empty the hash map for the next call; the entries are kept.
+    for (int i = 0; i < ws->nentries; i++)
+        clustermap[ws->entries[i]->bucket] = NULL;
 
     zarray_t *quads = zarray_create(sizeof(struct quad));
 
@@ -1838,6 +2051,13 @@ zarray_t *apriltag_quad_thresh(apriltag_detector_t *td, image_u8_t *im)
     struct quad_task tasks[sz / chunksize + 1];
 #endif
 
+    if (ws->scratch_size < sz / chunksize + 1) {
+        int scratch_size = sz / chunksize + 1;
+        ws->scratch = realloc(ws->scratch, scratch_size * sizeof *ws->scratch);
+        memset(&ws->scratch[ws->scratch_size], 0, (scratch_size - ws->scratch_size) * sizeof *ws->scratch);
+        ws->scratch_size = scratch_size;
+    }
+
     int ntasks = 0;
     for (int i = 0; i < sz; i += chunksize) {
         tasks[ntasks].td = td;
@@ -1848,6 +2068,7 @@ zarray_t *apriltag_quad_thresh(apriltag_detector_t *td, image_u8_t *im)
         tasks[ntasks].quads = quads;
         tasks[ntasks].clusters = clusters;
         tasks[ntasks].im = im;
+        tasks[ntasks].scratch = &ws->scratch[ntasks];
 
         workerpool_add_task(td->wp, do_quad_task, &tasks[ntasks]);
         ntasks++;
@@ -1901,16 +2122,8 @@ zarray_t *apriltag_quad_thresh(apriltag_detector_t *td, image_u8_t *im)
 
     //        printf("  %d %d %d %d\n", indices[0], indices[1], indices[2], indices[3]);
 
-    unionfind_destroy(uf);
-
-    for (int i = 0; i < zarray_size(clusters); i++) {
-        zarray_t *cluster;
-        zarray_get(clusters, i, &cluster);
-        zarray_destroy(cluster);
-    }
-
-    zarray_destroy(clusters);
-
+    // the threshold image, the union-find, and the clusters belong to
+    // the workspace.
 
     return quads;
 }
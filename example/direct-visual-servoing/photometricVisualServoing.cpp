@@ -60,6 +60,7 @@
 #include <visp3/gui/vpDisplayX.h>
 
 #include <visp3/visual_features/vpFeatureLuminance.h>
+#include <visp3/vs/vpServoPhotometric.h>
 #include <visp3/io/vpParseArgv.h>
 
 #include <visp3/robot/vpImageSimulator.h>
@@ -361,38 +362,22 @@ main(int argc, const char ** argv)
     sId.setCameraParameters(cam) ;
     sId.buildFrom(Id) ;
 
-    // Matrice d'interaction, Hessien, erreur,...
-    vpMatrix Lsd;   // matrice d'interaction a la position desiree
-    vpMatrix Hsd;  // hessien a la position desiree
-    vpMatrix H ; // Hessien utilise pour le levenberg-Marquartd
-    vpColVector error ; // Erreur I-I*
-
-    // Compute the interaction matrix
-    // link the variation of image intensity to camera motion
-
-    // here it is computed at the desired position
-    sId.interaction(Lsd) ;
-
-    // Compute the Hessian H = L^TL
-    Hsd = Lsd.AtA() ;
-
-    // Compute the Hessian diagonal for the Levenberg-Marquartd
-    // optimization process
-    unsigned int n = 6 ;
-    vpMatrix diagHsd(n,n) ;
-    diagHsd.eye(n);
-    for(unsigned int i = 0 ; i < n ; i++) diagHsd[i][i] = Hsd[i][i];
-
     // ------------------------------------------------------
     // Control law
-    double lambda ; //gain
-    vpColVector e ;
+    // The interaction matrix is computed at the desired position and
+    // the Hessian H = L^T L is accumulated without building L
+    vpServoPhotometric servo;
+    servo.setInteractionMatrixType(vpFeatureLuminance::DESIRED);
+    // Levenberg-Marquartd optimization process
+    servo.setDampingType(vpServoPhotometric::LEVENBERG_MARQUARDT);
+
     vpColVector v ; // camera velocity send to the robot
 
     // ----------------------------------------------------------
     // Minimisation
 
     double mu ;  // mu = 0 : Gauss Newton ; mu != 0  : LM
+    double lambda ; //gain
     double lambdaGN;
 
     mu       =  0.01;
@@ -429,31 +414,22 @@ main(int argc, const char ** argv)
       // Compute current visual feature
       sI.buildFrom(I) ;
 
-      // compute current error
-      sI.error(sId,error) ;
-
-      normeError = (error.sumSquare());
-      std::cout << "|e| "<<normeError <<std::endl ;
-
       // double t = vpTime::measureTimeMs() ;
 
       // ---------- Levenberg Marquardt method --------------
+      if (iter > iterGN)
       {
-        if (iter > iterGN)
-        {
-          mu = 0.0001 ;
-          lambda = lambdaGN;
-        }
-
-        // Compute the levenberg Marquartd term
-        {
-          H = ((mu * diagHsd) + Hsd).inverseByLU();
-        }
-        //	compute the control law
-        e = H * Lsd.t() *error ;
-
-        v = - lambda*e;
+        mu = 0.0001 ;
+        lambda = lambdaGN;
       }
+      servo.setMu(mu);
+      servo.setLambda(lambda);
+
+      //	compute the control law
+      v = servo.computeControlLaw(sI, sId);
+
+      normeError = servo.getErrorSquaredNorm();
+      std::cout << "|e| "<<normeError <<std::endl ;
 
       std::cout << "lambda = " << lambda << "  mu = " << mu ;
       std::cout << " |Tc| = " << sqrt(v.sumSquare()) << std::endl;
@@ -242,6 +242,8 @@ public:
   void init(unsigned int height, unsigned int width, Type value);
   //! init from an image stored as a continuous array in memory
   void init(Type * const array, const unsigned int height, const unsigned int width, const bool copyData=false);
+  //! init as a view of an image stored as a continuous array in memory owned by the caller
+  void initView(Type * const array, const unsigned int height, const unsigned int width);
   void insert(const vpImage<Type> &src, const vpImagePoint &topLeft);
 
   //------------------------------------------------------------------
@@ -349,6 +351,7 @@ private:
   unsigned int width;   ///! number of columns
   unsigned int height;  ///! number of rows
   Type **row;           ///! points the row pointer array
+  bool hasOwnership;    ///! true if the bitmap was allocated by this image, false if it points to an external array
 };
 
 template<class Type>
@@ -673,11 +676,13 @@ vpImage<Type>::init(unsigned int h, unsigned int w)
     }
   }
 
-  if ((h != this->height) || (w != this->width))
+  // An external array is never reused to store the image
+  if ((h != this->height) || (w != this->width) || !hasOwnership)
   {
     if (bitmap != NULL) {
       vpDEBUG_TRACE(10,"Destruction bitmap[]");
-      delete [] bitmap;
+      if (hasOwnership)
+        delete [] bitmap;
       bitmap = NULL;
     }
   }
@@ -687,7 +692,10 @@ vpImage<Type>::init(unsigned int h, unsigned int w)
 
   npixels=width*height;
 
-  if (bitmap == NULL)  bitmap = new  Type[npixels];
+  if (bitmap == NULL) {
+    bitmap = new  Type[npixels];
+    hasOwnership = true;
+  }
 
   if (bitmap == NULL)
   {
@@ -718,6 +726,8 @@ vpImage<Type>::init(unsigned int h, unsigned int w)
   \param copyData : If false (by default) only the memory address is copied, otherwise the data are copied.
 
   \exception vpException::memoryAllocationError
+
+  \sa initView()
 */
 template<class Type>
 void
@@ -730,13 +740,15 @@ vpImage<Type>::init(Type * const array, const unsigned int h, const unsigned int
     }
   }
 
-  //Delete bitmap if copyData==false, otherwise only if the dimension differs
-  if ( (copyData && ((h != this->height) || (w != this->width))) || !copyData ) {
+  //Delete bitmap if copyData==false, otherwise only if the dimension differs or if it is not owned
+  if ( (copyData && ((h != this->height) || (w != this->width) || !hasOwnership)) || !copyData ) {
     if (bitmap != NULL) {
-      delete [] bitmap;
+      if (hasOwnership)
+        delete [] bitmap;
       bitmap = NULL;
     }
   }
+  hasOwnership = true;
 
   this->width = w;
   this->height = h;
@@ -769,6 +781,29 @@ vpImage<Type>::init(Type * const array, const unsigned int h, const unsigned int
   }
 }
 
+/*!
+  \brief Image initialization as a view
+
+  Make the image point to image data stored as a continuous array in memory, without
+  copying them. Unlike init(Type * const, unsigned int, unsigned int, bool), the array
+  is not freed by the image: it remains owned by the caller and has to stay valid while
+  the image uses it. Resizing the image or initializing it again allocates a new bitmap
+  and leaves the array untouched.
+
+  \param array : Image data stored as a continuous array in memory.
+  \param h : Image height.
+  \param w : Image width.
+
+  \exception vpException::memoryAllocationError
+*/
+template<class Type>
+void
+vpImage<Type>::initView(Type * const array, const unsigned int h, const unsigned int w)
+{
+  init(array, h, w, false);
+  hasOwnership = false;
+}
+
 /*!
   \brief Constructor
 
@@ -789,7 +824,7 @@ vpImage<Type>::init(Type * const array, const unsigned int h, const unsigned int
 */
 template<class Type>
 vpImage<Type>::vpImage(unsigned int h, unsigned int w)
-  : bitmap(NULL), display(NULL), npixels(0), width(0), height(0), row(NULL)
+  : bitmap(NULL), display(NULL), npixels(0), width(0), height(0), row(NULL), hasOwnership(true)
 {
   init(h,w,0);
 }
@@ -813,7 +848,7 @@ vpImage<Type>::vpImage(unsigned int h, unsigned int w)
 */
 template<class Type>
 vpImage<Type>::vpImage (unsigned int h, unsigned int w, Type value)
-  : bitmap(NULL), display(NULL), npixels(0), width(0), height(0), row(NULL)
+  : bitmap(NULL), display(NULL), npixels(0), width(0), height(0), row(NULL), hasOwnership(true)
 {
   init(h,w,value);
 }
@@ -834,7 +869,7 @@ vpImage<Type>::vpImage (unsigned int h, unsigned int w, Type value)
 */
 template<class Type>
 vpImage<Type>::vpImage (Type * const array, const unsigned int h, const unsigned int w, const bool copyData)
-  : bitmap(NULL), display(NULL), npixels(0), width(0), height(0), row(NULL)
+  : bitmap(NULL), display(NULL), npixels(0), width(0), height(0), row(NULL), hasOwnership(true)
 {
   init(array, h, w, copyData);
 }
@@ -850,7 +885,7 @@ vpImage<Type>::vpImage (Type * const array, const unsigned int h, const unsigned
 */
 template<class Type>
 vpImage<Type>::vpImage()
-  : bitmap(NULL), display(NULL), npixels(0), width(0), height(0), row(NULL)
+  : bitmap(NULL), display(NULL), npixels(0), width(0), height(0), row(NULL), hasOwnership(true)
 {
 }
 
@@ -925,9 +960,11 @@ vpImage<Type>::destroy()
   {
   //  vpERROR_TRACE("Deallocate bitmap memory %p",bitmap);
 //    vpDEBUG_TRACE(20,"Deallocate bitmap memory %p",bitmap);
-    delete [] bitmap;
+    if (hasOwnership)
+      delete [] bitmap;
     bitmap = NULL;
   }
+  hasOwnership = true;
 
 
   if (row!=NULL)
@@ -957,7 +994,7 @@ vpImage<Type>::~vpImage()
 */
 template<class Type>
 vpImage<Type>::vpImage(const vpImage<Type>& I)
-  : bitmap(NULL), display(NULL), npixels(0), width(0), height(0), row(NULL)
+  : bitmap(NULL), display(NULL), npixels(0), width(0), height(0), row(NULL), hasOwnership(true)
 {
   resize(I.getHeight(),I.getWidth());
   memcpy(bitmap, I.bitmap, I.npixels*sizeof(Type));
@@ -969,8 +1006,10 @@ vpImage<Type>::vpImage(const vpImage<Type>& I)
 */
 template<class Type>
 vpImage<Type>::vpImage(vpImage<Type> &&I)
-  : bitmap(I.bitmap), display(I.display), npixels(I.npixels), width(I.width), height(I.height), row(I.row)
+  : bitmap(I.bitmap), display(I.display), npixels(I.npixels), width(I.width), height(I.height), row(I.row),
+    hasOwnership(I.hasOwnership)
 {
+  I.hasOwnership = true;
   I.bitmap = NULL;
   I.display = NULL;
   I.npixels = 0;
@@ -1932,6 +1971,7 @@ void swap(vpImage<Type> &first, vpImage<Type> &second) {
   swap(first.width, second.width);
   swap(first.height, second.height);
   swap(first.row, second.row);
+  swap(first.hasOwnership, second.hasOwnership);
 }
 
 #endif
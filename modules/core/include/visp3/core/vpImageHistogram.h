@@ -0,0 +1,108 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Parallel computation of image histograms.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpImageHistogram.h
+  \brief Parallel computation of the histograms of grey, color, 16 bits and
+  floating point images, and of joint histograms.
+*/
+
+#ifndef vpImageHistogram_h
+#define vpImageHistogram_h
+
+#include <stdint.h>
+#include <vector>
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpRGBa.h>
+
+/*!
+  \class vpImageHistogram
+  \ingroup group_core_histogram
+
+  \brief Compute image histograms with privatised sub-histograms and row
+  band threading.
+
+  Each band of rows of the image is counted in its own histogram, split in
+  interleaved tables where consecutive pixels are counted in different
+  tables. A run of identical values, which is frequent in real images, thus
+  does not serialize the increments on the same counter. The tables and the
+  bands are summed at the end with SSE2 when available. The bands are counted
+  in parallel, one per thread, with OpenMP or with vpThread when OpenMP is not
+  available.
+
+  All the functions resize the histograms to the requested number of bins.
+  With a number of threads of 0 or 1, the histogram is computed in the
+  calling thread.
+
+  \code
+#include <visp3/core/vpImageHistogram.h>
+
+int main()
+{
+  vpImage<unsigned char> I(3000, 4000);
+  // ...
+  std::vector<unsigned int> hist;
+  vpImageHistogram::calculate(I, hist, 256, 4); // 256 bins, 4 threads
+
+  vpImage<vpRGBa> C(3000, 4000);
+  std::vector<unsigned int> histR, histG, histB, histA;
+  vpImageHistogram::calculate(C, histR, histG, histB, histA, 256, 4);
+}
+  \endcode
+
+  \sa vpHistogram
+*/
+class VISP_EXPORT vpImageHistogram
+{
+public:
+  static void calculate(const vpImage<unsigned char> &I, std::vector<unsigned int> &hist, const unsigned int nbins = 256,
+                        const unsigned int nbThreads = 1);
+  static void calculate(const vpImage<unsigned char> &I, unsigned int *hist, const unsigned int nbins = 256,
+                        const unsigned int nbThreads = 1);
+  static void calculate(const vpImage<vpRGBa> &I, std::vector<unsigned int> &histR, std::vector<unsigned int> &histG,
+                        std::vector<unsigned int> &histB, std::vector<unsigned int> &histA,
+                        const unsigned int nbins = 256, const unsigned int nbThreads = 1);
+  static void calculate(const vpImage<uint16_t> &I, std::vector<unsigned int> &hist, const unsigned int nbins = 65536,
+                        const unsigned int maxValue = 65535, const unsigned int nbThreads = 1);
+  static void calculate(const vpImage<float> &I, std::vector<unsigned int> &hist, const unsigned int nbins,
+                        const float minValue, const float maxValue, const unsigned int nbThreads = 1);
+  static void calculate(const vpImage<unsigned char> &I1, const vpImage<unsigned char> &I2,
+                        std::vector<unsigned int> &hist, const unsigned int nbins1 = 256,
+                        const unsigned int nbins2 = 256, const unsigned int nbThreads = 1);
+};
+
+#endif
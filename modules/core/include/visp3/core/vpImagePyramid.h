@@ -0,0 +1,149 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Reusable image pyramid.
+ *
+ *****************************************************************************/
+
+#ifndef vpImagePyramid_H
+#define vpImagePyramid_H
+
+/*!
+  \file vpImagePyramid.h
+  \brief Reusable image pyramid.
+*/
+
+#include <vector>
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpImage.h>
+
+/*!
+  \class vpImagePyramid
+
+  \ingroup group_core_image
+
+  \brief Image pyramid whose buffers are kept from one frame to the next.
+
+  Level 0 is the image passed to build(); it is not copied, so it has to stay
+  valid as long as the pyramid is used. Copying a pyramid copies all its levels,
+  the full resolution one included. Level \f$ k \f$ has a size of
+  \f$ \lfloor h/2^k \rfloor \times \lfloor w/2^k \rfloor \f$ and is computed
+  from level \f$ k-1 \f$ either with the separable 5-tap
+  \f$ \left[ 1\ 4\ 6\ 4\ 1 \right] / 16 \f$ Gaussian kernel used by
+  vpImageFilter::getGaussPyramidal() (default), or by simply keeping one pixel
+  over two (vpImagePyramid::DECIMATION).
+
+  Since the level buffers are only reallocated when the input size changes,
+  a pyramid computed once per frame can be handed to several trackers
+  (vpTemplateTracker::track(const vpImagePyramid &),
+  vpMbEdgeTracker::track(const vpImagePyramid &)) without any allocation
+  in steady state.
+
+  \code
+#include <visp3/core/vpImagePyramid.h>
+
+int main()
+{
+  vpImage<unsigned char> I(480, 640, 128);
+  vpImagePyramid pyramid(3);
+  pyramid.setNbThreads(2);
+
+  for (int frame = 0; frame < 10; frame++) {
+    // ... acquire I
+    pyramid.build(I);
+    const vpImage<unsigned char> &I2 = pyramid[2]; // 120 x 160 image
+    std::cout << I2.getHeight() << "x" << I2.getWidth() << std::endl;
+  }
+
+  return 0;
+}
+  \endcode
+*/
+class VISP_EXPORT vpImagePyramid
+{
+public:
+  /*! Filter used to compute a level from the previous one. */
+  typedef enum {
+    GAUSSIAN_FILTER, /*!< 5-tap Gaussian smoothing followed by a subsampling by 2. */
+    DECIMATION       /*!< Subsampling by 2 without any smoothing. */
+  } vpPyramidFilterType;
+
+  explicit vpImagePyramid(const unsigned int nbLevels=1, const vpPyramidFilterType &type=GAUSSIAN_FILTER);
+  vpImagePyramid(const vpImagePyramid &pyramid);
+  virtual ~vpImagePyramid();
+
+  void build(const vpImage<unsigned char> &I);
+
+  /*! Return the filter used to compute the levels. */
+  inline vpPyramidFilterType getFilterType() const { return m_filterType; }
+  const vpImage<unsigned char> &getLevel(const unsigned int level) const;
+  /*! Return the number of levels, including the full resolution level 0. */
+  inline unsigned int getNbLevels() const { return m_nbLevels; }
+  /*! Return the number of threads used to compute the levels. */
+  inline unsigned int getNbThreads() const { return m_nbThreads; }
+
+  /*! Return true if build() was called since the last parameter change. */
+  inline bool isBuilt() const { return m_base != NULL; }
+
+  vpImagePyramid &operator=(const vpImagePyramid &pyramid);
+  /*! Return the image at the given level. \sa getLevel() */
+  inline const vpImage<unsigned char> &operator[](const unsigned int level) const { return getLevel(level); }
+
+  void setFilterType(const vpPyramidFilterType &type);
+  void setNbLevels(const unsigned int nbLevels);
+  void setNbThreads(const unsigned int nbThreads);
+
+  static void pyrDown(const vpImage<unsigned char> &I, vpImage<unsigned char> &Idown,
+                      const vpPyramidFilterType &type=GAUSSIAN_FILTER, const unsigned int nbThreads=1);
+
+private:
+  static void decimate(const vpImage<unsigned char> &I, vpImage<unsigned char> &Idown, const unsigned int nbThreads);
+  static void pyrDown(const vpImage<unsigned char> &I, vpImage<unsigned char> &Itmp, vpImage<unsigned char> &Idown,
+                      const unsigned int nbThreads);
+
+  //! Full resolution image given to build(), not owned, or m_baseCopy for a copied pyramid
+  const vpImage<unsigned char> *m_base;
+  //! Copy of the full resolution image of the pyramid this one was copied from
+  vpImage<unsigned char> m_baseCopy;
+  //! Filter used to compute the levels
+  vpPyramidFilterType m_filterType;
+  //! Levels 1 to m_nbLevels-1, kept between two calls to build()
+  std::vector< vpImage<unsigned char> > m_levels;
+  //! Number of levels
+  unsigned int m_nbLevels;
+  //! Number of threads
+  unsigned int m_nbThreads;
+  //! Horizontally filtered images, one per level
+  std::vector< vpImage<unsigned char> > m_tmp;
+};
+
+#endif
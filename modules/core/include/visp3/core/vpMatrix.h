@@ -107,6 +107,13 @@ class VISP_EXPORT vpMatrix : public vpArray2D<double>
     LU_DECOMPOSITION     /*!< LU decomposition method. */
   } vpDetMethod;
 
+  /*!
+    Largest size of the matrices handled by the decompositions working on stack
+    storage: inverseByLUSmall(), inverseByCholeskySmall(), inverseByQRSmall(),
+    svdSmall() and pseudoInverseSmall().
+  */
+  static const unsigned int smallMatrixMaxSize = 12;
+
  public:
   /*!
     Basic constructor of a matrix of double. Number of columns and rows are zero.
@@ -361,6 +368,7 @@ class VISP_EXPORT vpMatrix : public vpArray2D<double>
 #  if (VISP_HAVE_OPENCV_VERSION >= 0x020101)
   vpMatrix inverseByLUOpenCV() const;
 #  endif
+  vpMatrix inverseByLUSmall() const;
 #endif // #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
   // inverse matrix A using the Cholesky decomposition (only for real symmetric matrices)
@@ -373,8 +381,12 @@ class VISP_EXPORT vpMatrix : public vpArray2D<double>
 #  if (VISP_HAVE_OPENCV_VERSION >= 0x020101)
   vpMatrix inverseByCholeskyOpenCV() const;
 #  endif
+  vpMatrix inverseByCholeskySmall() const;
 #endif // #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
+  // inverse matrix A using the LDLT decomposition (only for real symmetric matrices)
+  vpMatrix inverseByLDLT() const;
+
   // inverse matrix A using the QR decomposition
   vpMatrix inverseByQR() const;
 
@@ -382,6 +394,7 @@ class VISP_EXPORT vpMatrix : public vpArray2D<double>
 #  if defined(VISP_HAVE_LAPACK)
   vpMatrix inverseByQRLapack() const;
 #  endif
+  vpMatrix inverseByQRSmall() const;
 #endif // #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
   vpMatrix pseudoInverse(double svThreshold=1e-6) const;
@@ -415,6 +428,11 @@ class VISP_EXPORT vpMatrix : public vpArray2D<double>
   unsigned int pseudoInverseGsl(vpMatrix &Ap, vpColVector &sv, double svThreshold=1e-6) const;
   unsigned int pseudoInverseGsl(vpMatrix &Ap, vpColVector &sv, double svThreshold, vpMatrix &imA, vpMatrix &imAt, vpMatrix &kerAt) const;
 #  endif
+  vpMatrix pseudoInverseSmall(double svThreshold=1e-6) const;
+  unsigned int pseudoInverseSmall(vpMatrix &Ap, double svThreshold=1e-6) const;
+  unsigned int pseudoInverseSmall(vpMatrix &Ap, vpColVector &sv, double svThreshold=1e-6) const;
+  unsigned int pseudoInverseSmall(vpMatrix &Ap, vpColVector &sv, double svThreshold, vpMatrix &imA, vpMatrix &imAt) const;
+  unsigned int pseudoInverseSmall(vpMatrix &Ap, vpColVector &sv, double svThreshold, vpMatrix &imA, vpMatrix &imAt, vpMatrix &kerAt) const;
 #endif // #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
   //@}
@@ -448,6 +466,7 @@ class VISP_EXPORT vpMatrix : public vpArray2D<double>
 #  if (VISP_HAVE_OPENCV_VERSION >= 0x020101) // Require opencv >= 2.1.1
   void svdOpenCV(vpColVector &w, vpMatrix &V);
 #  endif
+  void svdSmall(vpColVector &w, vpMatrix &V);
 #endif
   //@}
 
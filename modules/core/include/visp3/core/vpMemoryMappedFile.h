@@ -0,0 +1,116 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Read-only memory-mapped file.
+ *
+ *****************************************************************************/
+
+#ifndef vpMemoryMappedFile_H
+#define vpMemoryMappedFile_H
+
+/*!
+  \file vpMemoryMappedFile.h
+  \brief Read-only memory-mapped file.
+*/
+
+#include <string>
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \class vpMemoryMappedFile
+  \ingroup group_core_files_io
+
+  \brief Map the content of a file in memory.
+
+  The file is mapped with mmap() on UNIX systems and with a file mapping object on
+  Windows, so that its pages are only read from the disk when they are accessed.
+  The mapping is private: the data can be modified in memory, for instance by a
+  cv::Mat or a vpImage built on it, but the changes are never written back to the
+  file. When the system does not support memory mapping, the whole file is read
+  in a heap buffer.
+
+  \code
+#include <visp3/core/vpMemoryMappedFile.h>
+
+int main()
+{
+  vpMemoryMappedFile file("data.bin");
+  const unsigned char *data = file.getData();
+  std::cout << "First byte of " << file.getSize() << " bytes: " << (int) data[0] << std::endl;
+}
+  \endcode
+*/
+class VISP_EXPORT vpMemoryMappedFile
+{
+public:
+  vpMemoryMappedFile();
+  explicit vpMemoryMappedFile(const std::string &filename);
+  virtual ~vpMemoryMappedFile();
+
+  void close();
+
+  /*! Return a pointer to the file content, NULL if no file is open or if the file is empty. */
+  inline unsigned char *getData() { return m_data; }
+  /*! Return a pointer to the file content, NULL if no file is open or if the file is empty. */
+  inline const unsigned char *getData() const { return m_data; }
+  /*! Return the size of the file in bytes. */
+  inline size_t getSize() const { return m_size; }
+
+  /*! Return true if a file is open. */
+  inline bool isOpen() const { return m_isOpen; }
+  /*! Return true if the file is memory-mapped, false if it was read in a heap buffer. */
+  inline bool isMapped() const { return m_isMapped; }
+
+  void open(const std::string &filename);
+  void swap(vpMemoryMappedFile &file);
+
+private:
+  // A mapping cannot be shared between two objects
+  vpMemoryMappedFile(const vpMemoryMappedFile &);
+  vpMemoryMappedFile &operator=(const vpMemoryMappedFile &);
+
+  //! File content
+  unsigned char *m_data;
+  //! True if a file is open
+  bool m_isOpen;
+  //! True if m_data is a memory mapping, false if it is a heap buffer
+  bool m_isMapped;
+  //! File size
+  size_t m_size;
+#if defined(_WIN32)
+  //! Windows file mapping object
+  void *m_mappingHandle;
+#endif
+};
+
+#endif
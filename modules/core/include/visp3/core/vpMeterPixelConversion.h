@@ -48,9 +48,12 @@
 
 */
 
+#include <vector>
+
 #include <visp3/core/vpCameraParameters.h>
 #include <visp3/core/vpCircle.h>
 #include <visp3/core/vpException.h>
+#include <visp3/core/vpHomogeneousMatrix.h>
 #include <visp3/core/vpImagePoint.h>
 #include <visp3/core/vpMath.h>
 
@@ -64,6 +67,14 @@
 
   This class relates to vpCameraParameters.
 
+  To project a set of 3D points, convertPoints() and projectPoints() process
+  arrays of coordinates with SSE2 instructions when available, instead of a
+  vpPoint per point:
+  \code
+  std::vector<double> oX, oY, oZ; // Coordinates of the points in the object frame
+  std::vector<double> u, v;
+  vpMeterPixelConversion::projectPoints(cam, cMo, oX, oY, oZ, u, v);
+  \endcode
 */
 class VISP_EXPORT vpMeterPixelConversion
 {
@@ -76,6 +87,21 @@ public:
                             const double &rho_m, const double &theta_m,
                             double &rho_p, double &theta_p) ;
 
+    static void convertPoints(const vpCameraParameters &cam,
+                              const std::vector<double> &x, const std::vector<double> &y,
+                              std::vector<double> &u, std::vector<double> &v);
+
+    static void projectPoints(const vpHomogeneousMatrix &cMo,
+                              const std::vector<double> &oX, const std::vector<double> &oY,
+                              const std::vector<double> &oZ,
+                              std::vector<double> &x, std::vector<double> &y,
+                              const unsigned int nbThreads = 1);
+    static void projectPoints(const vpCameraParameters &cam, const vpHomogeneousMatrix &cMo,
+                              const std::vector<double> &oX, const std::vector<double> &oY,
+                              const std::vector<double> &oZ,
+                              std::vector<double> &u, std::vector<double> &v,
+                              const unsigned int nbThreads = 1);
+
 /*!
 
   \brief Point coordinates conversion from normalized coordinates
@@ -53,6 +53,8 @@
 #  include <netinet/in.h>
 #  include <arpa/inet.h>
 #  include <netdb.h>
+#  include <netinet/tcp.h>
+#  include <sys/uio.h>
 #else
 #  include<io.h>
 //#  include<winsock.h>
@@ -60,6 +62,10 @@
 //#  pragma comment(lib, "ws2_32.lib") // Done by CMake in main CMakeLists.txt
 #endif
 
+#if defined(__linux__)
+#  include <sys/epoll.h>
+#endif
+
 #if defined(__APPLE__) && defined(__MACH__) // Apple OSX and iOS (Darwin)
 #  include <TargetConditionals.h> // To detect OSX or IOS using TARGET_OS_IPHONE or TARGET_OS_IOS macro
 #endif
@@ -77,6 +83,27 @@
   \warning This class shouldn't be used directly. You better use vpClient and
   vpServer to simulate your network. Some exemples are provided in these classes.
 
+  By default the requests are sent as text: the parameters are concatenated
+  between separators and the receiver searches the separators in the received
+  characters. When setBinaryMode() is turned on, on both sides, the requests
+  are sent with a length-prefixed binary framing:
+  - a header of 12 bytes: a magic number, the number of parameters and the
+    size of the request id, as 32 bits integers in network byte order;
+  - the request id followed by the size of each parameter as 64 bits integers;
+  - the parameters, without separator.
+
+  The message is sent with a single scatter/gather system call that reads the
+  parameters where they are, and especially the buffers added with
+  vpRequest::addParameterBuffer() without copying them. On reception, the
+  sizes are known before the payload so each parameter is read directly in the
+  memory given by vpRequest::getReceptionBuffer(), for instance the bitmap of
+  an image or the data of a matrix. Several connections are multiplexed with
+  epoll on Linux and a partially received message is resumed at the next call,
+  so that a slow emitter never blocks the others. As long as a received
+  request has not been handled, the following messages of the same connection
+  stay buffered and the messages of other connections for the same request
+  wait, so that a request is never overwritten before being decoded.
+
   \sa vpServer
   \sa vpNetwork
 */
@@ -84,6 +111,42 @@ class VISP_EXPORT vpNetwork
 {
 protected:
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
+  // State of the reception of a binary message on one connection
+  struct vpBinaryReception{
+    typedef enum {
+      WAIT_HEADER,  // Waiting for the fixed size header
+      WAIT_META,    // Waiting for the request id and the sizes of the parameters
+      WAIT_PARAMS,  // Receiving the parameters
+      WAIT_REQUEST, // Complete but the request is being filled or waits to be handled
+      CORRUPTED     // Wrong magic number or sizes
+    } vpStageType;
+
+    vpStageType                      stage;
+    char                             header[12];
+    size_t                           headerReceived;
+    std::vector<char>                meta;
+    size_t                           metaReceived;
+    int                              request;
+    int                              completed; // Request of the last message, parsing waits for its handling
+    bool                             direct;
+    std::vector<size_t>              sizes;
+    unsigned int                     param;
+    size_t                           paramReceived;
+    bool                             paramStarted;
+    char                            *target;
+    std::vector< std::vector<char> > staged;
+    std::vector<char>                buffer;
+    size_t                           begin;
+    size_t                           end;
+    bool                             configured;
+    bool                             registered;
+
+    vpBinaryReception()
+      : stage(WAIT_HEADER), headerReceived(0), meta(), metaReceived(0), request(-1), completed(-1), direct(false),
+        sizes(), param(0), paramReceived(0), paramStarted(false), target(NULL), staged(), buffer(), begin(0), end(0),
+        configured(false), registered(false) {}
+  };
+
   struct vpReceptor{
 #if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
     int                   socketFileDescriptorReceptor;
@@ -94,8 +157,9 @@ protected:
 #endif
     struct sockaddr_in    receptorAddress;
     std::string           receptorIP;
+    vpBinaryReception     binary;
 
-    vpReceptor() : socketFileDescriptorReceptor(0), receptorAddressSize(), receptorAddress(), receptorIP() {}
+    vpReceptor() : socketFileDescriptorReceptor(0), receptorAddressSize(), receptorAddress(), receptorIP(), binary() {}
   };
   
   struct vpEmitter{
@@ -132,6 +196,7 @@ protected:
   std::vector<vpRequest*> request_list;
   
   unsigned int            max_size_message;
+  size_t                  max_size_binary_message;
   std::string             separator;
   std::string             beginning;
   std::string             end;
@@ -144,6 +209,13 @@ protected:
   long                    tv_usec;
   
   bool                    verboseMode;
+
+  bool                    binaryMode;
+  std::vector<int>        binaryCompleted;
+#if defined(__linux__)
+  int                     epollFileDescriptor;
+  std::vector<int>        epollSockets;
+#endif
   
 private:
   
@@ -154,6 +226,17 @@ private:
   void              _receiveRequestFrom(const unsigned int &receptorEmitting);
   int               _receiveRequestOnce();
   int               _receiveRequestOnceFrom(const unsigned int &receptorEmitting);
+
+  void              _completeBinary(vpReceptor &receptor);
+  void              _configureBinary(vpReceptor &receptor);
+  void              _disconnectBinary(const unsigned int &receptorEmitting);
+  bool              _isRequestBusy(const int &request, const vpReceptor &receptor) const;
+  bool              _isRequestQueued(const int &request) const;
+  void              _parseBinary(vpReceptor &receptor);
+  int               _receiveBinaryFrom(const unsigned int &receptorEmitting);
+  int               _receiveBinaryOnce();
+  void              _resumeBinary(vpReceptor &receptor);
+  int               _sendBinaryRequestTo(vpRequest &req, const unsigned int &dest);
   
 public:
 
@@ -162,6 +245,15 @@ public:
   
   void              addDecodingRequest(vpRequest *);
   
+  /*!
+    Tell if the requests are sent and received with the binary framing.
+
+    \sa vpNetwork::setBinaryMode()
+
+    \return True in binary mode, false in text mode.
+  */
+  bool              getBinaryMode() const { return binaryMode; }
+
   int               getReceptorIndex(const char *name);
   
   /*!
@@ -185,6 +277,16 @@ public:
     \return Acutal max size value.
   */
   unsigned int      getMaxSizeReceivedMessage(){ return max_size_message; }
+
+  /*!
+    Get the maximum size of the parameters of a message that can be received
+    in binary mode.
+
+    \sa vpNetwork::setMaxSizeReceivedBinaryMessage()
+
+    \return Actual max size value.
+  */
+  size_t            getMaxSizeReceivedBinaryMessage(){ return max_size_binary_message; }
   
   void      print(const char *id = "");
   
@@ -216,6 +318,8 @@ public:
   int               sendAndEncodeRequest(vpRequest &req);
   int               sendAndEncodeRequestTo(vpRequest &req, const unsigned int &dest);
   
+  void              setBinaryMode(const bool &binary);
+
   /*!
     Change the maximum size that the emitter can receive (in request mode).
     
@@ -224,6 +328,17 @@ public:
     \param s : new maximum size value.
   */
   void              setMaxSizeReceivedMessage(const unsigned int &s){ max_size_message = s;}
+
+  /*!
+    Change the maximum size of the parameters of a message that can be
+    received in binary mode. A connection that announces a bigger message is
+    closed before anything is allocated. Initially this value is set to 256 MB.
+
+    \sa vpNetwork::getMaxSizeReceivedBinaryMessage()
+
+    \param s : new maximum size value, in bytes.
+  */
+  void              setMaxSizeReceivedBinaryMessage(const size_t &s){ max_size_binary_message = s;}
   
   /*!
     Change the time the emitter spend to check if he receives a message from a receptor.
@@ -45,6 +45,7 @@
 #include <visp3/core/vpImageException.h>
 
 #include <string.h>
+#include <utility>
 #include <vector>
 
 /*!
@@ -123,6 +124,59 @@ void vpRequestImage::decode(){
   }
 }
   \endcode
+
+  When the network is in binary mode (see vpNetwork::setBinaryMode()), the
+  bitmap can be sent and received without any copy. addParameterBuffer()
+  only keeps a pointer on the pixels, that are read by the system call that
+  sends the message, and getReceptionBuffer() is redefined so that the pixels
+  are received directly in the image, the height and the width being already
+  known when the third parameter arrives.
+
+  \code
+class vpRequestImage : public vpRequest
+{
+private:
+  vpImage<unsigned char> *I;
+  unsigned int h, w; // Kept alive until the request is sent
+
+public:
+  vpRequestImage(vpImage<unsigned char> *Im) : I(Im), h(0), w(0) { request_id = "image"; }
+
+  virtual void encode(){
+    clear();
+    h = I->getHeight();
+    w = I->getWidth();
+    addParameterObject(&h);
+    addParameterObject(&w);
+    addParameterBuffer(I->bitmap, h*w*sizeof(unsigned char));
+  }
+
+  virtual void *getReceptionBuffer(const unsigned int &index, const size_t &sizeOfObject){
+    if(index == 2 && listOfParams.size() == 2){
+      memcpy((void*)&h, (void*)listOfParams[0].c_str(), sizeof(unsigned int));
+      memcpy((void*)&w, (void*)listOfParams[1].c_str(), sizeof(unsigned int));
+      if((size_t)h*w == sizeOfObject){
+        I->resize(h,w);
+        return (void*)I->bitmap;
+      }
+    }
+    return vpRequest::getReceptionBuffer(index, sizeOfObject);
+  }
+
+  virtual void decode(){
+    // In binary mode the bitmap is already in I and the third parameter is empty
+    if(listOfParams.size() == 3 && listOfParams[2].size() != 0){
+      memcpy((void*)&h, (void*)listOfParams[0].c_str(), sizeof(unsigned int));
+      memcpy((void*)&w, (void*)listOfParams[1].c_str(), sizeof(unsigned int));
+      I->resize(h,w);
+      memcpy((void*)I->bitmap,(void*)listOfParams[2].c_str(),w*h*sizeof(unsigned char));
+    }
+  }
+};
+  \endcode
+
+  The same applies to a vpMatrix or a vpColVector, whose coefficients are
+  stored in the contiguous array vpArray2D::data.
   
   \sa vpClient
   \sa vpServer
@@ -133,6 +187,7 @@ class VISP_EXPORT vpRequest
 protected:
   std::string               request_id;
   std::vector<std::string>  listOfParams;
+  std::vector< std::pair<const char *, size_t> > listOfBuffers;
   
 public:
                 vpRequest();
@@ -143,6 +198,7 @@ public:
   void          addParameter(std::vector<std::string> &listOfparams);
   template<typename T>
   void          addParameterObject(T * params, const int &sizeOfObject = sizeof(T));
+  void          addParameterBuffer(const void *params, const size_t &sizeOfObject);
   
   /*!
     Decode the parameters of the request (Funtion that has to be redifined).
@@ -154,7 +210,7 @@ public:
   /*!
     Clear the parameters of the request.
   */
-  void          clear(){ listOfParams.clear(); }
+  void          clear(){ listOfParams.clear(); listOfBuffers.clear(); }
   
   /*!
     Encode the parameters of the request (Funtion that has to be redifined).
@@ -177,6 +233,10 @@ public:
   */ 
   inline const  std::string& operator[](const unsigned int &i) const { return listOfParams[i];}
   
+  const char   *getParameterData(const unsigned int &i, size_t &sizeOfObject) const;
+
+  virtual void *getReceptionBuffer(const unsigned int &index, const size_t &sizeOfObject);
+
   /*!
     Get the ID of the request.
     
@@ -154,6 +154,14 @@ int main(int argc,const char** argv)
 }
   \endcode
 
+  To receive the streams of many clients, turn on vpNetwork::setBinaryMode()
+  on the server and on the clients: the requests are then received without
+  intermediate copy and the clients are multiplexed with epoll on Linux. In
+  that mode checkForConnections() only checks the pending connections,
+  without waiting, and the deconnections are detected by the reception of the
+  requests. Increase setMaxNumberOfClients() when many clients connect at the
+  same time. testNetworkBenchmark.cpp compares both modes on localhost.
+
   \sa vpClient
   \sa vpRequest
   \sa vpNetwork
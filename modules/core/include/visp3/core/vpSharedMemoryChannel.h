@@ -0,0 +1,240 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Publish images and poses to local processes through shared memory.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpSharedMemoryChannel.h
+  \brief Publish/subscribe channel between local processes in POSIX shared memory.
+*/
+
+#ifndef vpSharedMemoryChannel_h
+#define vpSharedMemoryChannel_h
+
+#include <visp3/core/vpConfig.h>
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+
+#include <string>
+
+#include <visp3/core/vpColVector.h>
+#include <visp3/core/vpHomogeneousMatrix.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpRGBa.h>
+
+/*!
+  \class vpSharedMemoryChannel
+
+  \ingroup group_core_network
+
+  \brief Publish images, homogeneous matrices and column vectors to the
+  processes of the same computer through a POSIX shared memory segment.
+
+  The publisher creates the channel with create(). It owns a ring of slots,
+  each large enough for the biggest data to publish, and publish() copies the
+  data in the next slot with its sequence number and its timestamp. Any
+  number of subscribers attach to the channel with open() and read the slots
+  without lock and without writing in the shared memory: each slot is
+  protected by a sequence lock that the publisher makes odd while it writes,
+  so that a reader detects and retries a slot that was overwritten while it
+  was read. On Linux, wait() sleeps on a futex that publish() wakes up.
+
+  A subscriber reads the frames in one of the following modes:
+  - vpSharedMemoryChannel::LATEST_FRAME: read() returns the most recent
+    frame not yet read.
+  - vpSharedMemoryChannel::EVERY_FRAME: read() returns the frames in
+    publication order, as long as they are still in the ring. The frames that
+    were overwritten before being read are counted by getDroppedCount().
+
+  getView() gives a vpImage whose bitmap is the slot in the shared segment,
+  without any copy. The view stays valid until the publisher reuses the slot,
+  that is during the publication of getNbSlots()-1 other frames, and
+  isViewValid() tells if it has been overwritten. The segment is mapped read
+  only by the subscribers: the view must not be modified.
+
+  Publisher side, for instance in a capture process:
+  \code
+#include <visp3/core/vpSharedMemoryChannel.h>
+
+int main()
+{
+  vpImage<unsigned char> I(480, 640);
+  vpSharedMemoryChannel channel;
+  channel.create("camera", I.getSize(), 4);
+  for (;;) {
+    // ... acquire I
+    channel.publish(I); // Timestamped with vpTime::measureTimeMs()
+  }
+}
+  \endcode
+
+  Subscriber side, for instance in a tracking process:
+  \code
+#include <visp3/core/vpSharedMemoryChannel.h>
+#include <visp3/core/vpTime.h>
+
+int main()
+{
+  vpImage<unsigned char> I;
+  vpSharedMemoryChannel channel;
+  channel.open("camera");
+  while (channel.wait(1000)) {
+    if (channel.getView(I)) { // No copy
+      // ... process I
+      if (! channel.isViewValid())
+        std::cout << "Frame " << channel.getSequence() << " overwritten during the processing" << std::endl;
+      std::cout << "Latency: " << vpTime::measureTimeMs() - channel.getTimestamp() << " ms" << std::endl;
+    }
+  }
+}
+  \endcode
+
+  \note The sequence numbers start at 1 and are 32 bits wide. The timestamps
+  are in ms, as given by vpTime::measureTimeMs(), so that they can be compared
+  between processes.
+*/
+class VISP_EXPORT vpSharedMemoryChannel
+{
+public:
+  /*! \enum vpDataType
+    Type of the data of a frame.
+  */
+  typedef enum {
+    NO_DATA,            /*!< No frame read yet */
+    IMAGE_UCHAR,        /*!< vpImage<unsigned char> */
+    IMAGE_RGBA,         /*!< vpImage<vpRGBa> */
+    HOMOGENEOUS_MATRIX, /*!< vpHomogeneousMatrix */
+    COLUMN_VECTOR       /*!< vpColVector */
+  } vpDataType;
+
+  /*! \enum vpReadModeType
+    Frame returned by read() and getView().
+  */
+  typedef enum {
+    LATEST_FRAME, /*!< The most recent frame, older ones are skipped */
+    EVERY_FRAME   /*!< The frames in publication order while they are in the ring */
+  } vpReadModeType;
+
+  vpSharedMemoryChannel();
+  virtual ~vpSharedMemoryChannel();
+
+  void create(const std::string &name, unsigned int maxDataSize, unsigned int nbSlots = 4);
+  void open(const std::string &name);
+  void close();
+
+  unsigned int publish(const vpImage<unsigned char> &I, double timestamp = -1);
+  unsigned int publish(const vpImage<vpRGBa> &I, double timestamp = -1);
+  unsigned int publish(const vpHomogeneousMatrix &M, double timestamp = -1);
+  unsigned int publish(const vpColVector &v, double timestamp = -1);
+
+  bool wait(double timeoutMs = -1);
+  bool read(vpImage<unsigned char> &I);
+  bool read(vpImage<vpRGBa> &I);
+  bool read(vpHomogeneousMatrix &M);
+  bool read(vpColVector &v);
+  bool getView(vpImage<unsigned char> &I);
+  bool getView(vpImage<vpRGBa> &I);
+  bool isViewValid() const;
+
+  unsigned int getCapacity() const;
+  /*!
+    Return the type of the last frame read or published.
+  */
+  inline vpDataType getDataType() const { return m_type; }
+  /*!
+    Return the number of frames that were skipped by the subscriber, because
+    they were overwritten before being read in vpSharedMemoryChannel::EVERY_FRAME
+    mode, or because a more recent frame was available in
+    vpSharedMemoryChannel::LATEST_FRAME mode.
+  */
+  inline unsigned int getDroppedCount() const { return m_dropped; }
+  unsigned int getLastSequence() const;
+  unsigned int getNbSlots() const;
+  /*!
+    Return the read mode of the subscriber.
+    \sa setReadMode()
+  */
+  inline vpReadModeType getReadMode() const { return m_mode; }
+  /*!
+    Return the sequence number of the last frame read or published.
+  */
+  inline unsigned int getSequence() const { return m_sequence; }
+  /*!
+    Return the timestamp in ms of the last frame read or published.
+  */
+  inline double getTimestamp() const { return m_timestamp; }
+  /*!
+    Return true if the channel is created or opened.
+  */
+  inline bool isOpen() const { return m_segment != NULL; }
+  /*!
+    Return true if the channel was created by this object with create().
+  */
+  inline bool isPublisher() const { return m_publisher; }
+  bool isPublisherClosed() const;
+  /*!
+    Set the read mode of the subscriber.
+    \sa getReadMode()
+  */
+  inline void setReadMode(vpReadModeType mode) { m_mode = mode; }
+
+private:
+  const unsigned char *beginRead(vpDataType type, unsigned int elementSize, unsigned int &rows, unsigned int &cols,
+                                 unsigned int &sequence, unsigned int &lock);
+  bool endRead(unsigned int sequence, unsigned int lock);
+  unsigned int publishData(vpDataType type, unsigned int rows, unsigned int cols, const void *data, size_t size,
+                           double timestamp);
+
+  std::string m_name;
+  int m_fd;
+  unsigned char *m_segment;
+  size_t m_segmentSize;
+  bool m_publisher;
+  vpReadModeType m_mode;
+  vpDataType m_type;
+  unsigned int m_sequence;
+  double m_timestamp;
+  unsigned int m_dropped;
+  unsigned int m_firstSequence;
+  double m_pendingTimestamp;
+  vpDataType m_pendingType;
+  unsigned int m_viewSequence;
+  unsigned int m_viewLock;
+
+  // Non copyable
+  vpSharedMemoryChannel(const vpSharedMemoryChannel &);
+  vpSharedMemoryChannel &operator=(const vpSharedMemoryChannel &);
+};
+
+#endif
+#endif
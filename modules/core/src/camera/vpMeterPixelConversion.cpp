@@ -47,6 +47,141 @@
 #include <visp3/core/vpException.h>
 #include <visp3/core/vpMath.h>
 #include <visp3/core/vpDebug.h>
+#include <visp3/core/vpCPUFeatures.h>
+
+#include <algorithm>
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
+
+namespace {
+  //! Pose and conversion to pixels applied to the points of projectRange()
+  struct vpProjection {
+    double M[12];
+    double px, py, u0, v0, kud;
+    bool pixel, distortion;
+  };
+
+  vpProjection projection(const vpHomogeneousMatrix &cMo)
+  {
+    vpProjection p;
+    for (unsigned int i = 0; i < 3; i++)
+      for (unsigned int j = 0; j < 4; j++)
+        p.M[4*i + j] = cMo[i][j];
+    p.px = p.py = 1.;
+    p.u0 = p.v0 = p.kud = 0.;
+    p.pixel = p.distortion = false;
+    return p;
+  }
+
+  vpProjection projection(const vpCameraParameters &cam, const vpHomogeneousMatrix &cMo)
+  {
+    vpProjection p = projection(cMo);
+    p.pixel = true;
+    p.distortion = (cam.get_projModel() == vpCameraParameters::perspectiveProjWithDistortion);
+    p.px = cam.get_px();
+    p.py = cam.get_py();
+    p.u0 = cam.get_u0();
+    p.v0 = cam.get_v0();
+    p.kud = cam.get_kud();
+    return p;
+  }
+
+  /*!
+    Project the points in [begin ; end[. The operations are done in the same
+    order as vpPoint::track() and vpMeterPixelConversion::convertPoint(), also by
+    the SSE2 version.
+  */
+  void projectRange(const vpProjection &p, const double *oX, const double *oY, const double *oZ,
+                    double *u, double *v, const unsigned int begin, const unsigned int end,
+                    const bool useSSE2)
+  {
+    const double *M = p.M;
+    unsigned int i = begin;
+#if VISP_HAVE_SSE2
+    if (useSSE2) {
+      const __m128d m0 = _mm_set1_pd(M[0]), m1 = _mm_set1_pd(M[1]), m2 = _mm_set1_pd(M[2]), m3 = _mm_set1_pd(M[3]);
+      const __m128d m4 = _mm_set1_pd(M[4]), m5 = _mm_set1_pd(M[5]), m6 = _mm_set1_pd(M[6]), m7 = _mm_set1_pd(M[7]);
+      const __m128d m8 = _mm_set1_pd(M[8]), m9 = _mm_set1_pd(M[9]), m10 = _mm_set1_pd(M[10]), m11 = _mm_set1_pd(M[11]);
+      const __m128d px = _mm_set1_pd(p.px), py = _mm_set1_pd(p.py), u0 = _mm_set1_pd(p.u0), v0 = _mm_set1_pd(p.v0);
+      const __m128d kud = _mm_set1_pd(p.kud), one = _mm_set1_pd(1.);
+
+      for (; i + 2 <= end; i += 2) {
+        const __m128d vX = _mm_loadu_pd(oX + i), vY = _mm_loadu_pd(oY + i), vZ = _mm_loadu_pd(oZ + i);
+        const __m128d X = _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(m0, vX), _mm_mul_pd(m1, vY)), _mm_mul_pd(m2, vZ)), m3);
+        const __m128d Y = _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(m4, vX), _mm_mul_pd(m5, vY)), _mm_mul_pd(m6, vZ)), m7);
+        const __m128d Z = _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(m8, vX), _mm_mul_pd(m9, vY)), _mm_mul_pd(m10, vZ)), m11);
+        __m128d x = _mm_div_pd(X, Z), y = _mm_div_pd(Y, Z);
+        if (p.distortion) {
+          const __m128d r2 = _mm_add_pd(one, _mm_mul_pd(kud, _mm_add_pd(_mm_mul_pd(x, x), _mm_mul_pd(y, y))));
+          x = _mm_add_pd(u0, _mm_mul_pd(_mm_mul_pd(px, x), r2));
+          y = _mm_add_pd(v0, _mm_mul_pd(_mm_mul_pd(py, y), r2));
+        }
+        else if (p.pixel) {
+          x = _mm_add_pd(_mm_mul_pd(x, px), u0);
+          y = _mm_add_pd(_mm_mul_pd(y, py), v0);
+        }
+        _mm_storeu_pd(u + i, x);
+        _mm_storeu_pd(v + i, y);
+      }
+    }
+#else
+    (void)useSSE2;
+#endif
+
+    for (; i < end; i++) {
+      const double X = M[0] * oX[i] + M[1] * oY[i] + M[2] * oZ[i] + M[3];
+      const double Y = M[4] * oX[i] + M[5] * oY[i] + M[6] * oZ[i] + M[7];
+      const double Z = M[8] * oX[i] + M[9] * oY[i] + M[10] * oZ[i] + M[11];
+      const double x = X / Z, y = Y / Z;
+      if (p.distortion) {
+        const double r2 = 1. + p.kud * (x*x + y*y);
+        u[i] = p.u0 + p.px * x * r2;
+        v[i] = p.v0 + p.py * y * r2;
+      }
+      else if (p.pixel) {
+        u[i] = x * p.px + p.u0;
+        v[i] = y * p.py + p.v0;
+      }
+      else {
+        u[i] = x;
+        v[i] = y;
+      }
+    }
+  }
+
+  void projectPointSet(const vpProjection &p,
+                       const std::vector<double> &oX, const std::vector<double> &oY, const std::vector<double> &oZ,
+                       std::vector<double> &u, std::vector<double> &v, const unsigned int nbThreads)
+  {
+    if (oY.size() != oX.size() || oZ.size() != oX.size()) {
+      throw(vpException(vpException::dimensionError,
+                        "Cannot project %d points with %d Y and %d Z coordinates",
+                        (int)oX.size(), (int)oY.size(), (int)oZ.size()));
+    }
+    const unsigned int n = (unsigned int)oX.size();
+    u.resize(n);
+    v.resize(n);
+    if (n == 0)
+      return;
+
+    const bool useSSE2 = vpCPUFeatures::checkSSE2();
+    // Blocks of points shared between the threads
+    const unsigned int blockSize = 4096;
+    const int nbBlocks = (int)((n + blockSize - 1) / blockSize);
+#ifdef VISP_HAVE_OPENMP
+    #pragma omp parallel for num_threads(nbThreads) if(nbThreads > 1 && nbBlocks > 1)
+#else
+    (void)nbThreads;
+#endif
+    for (int b = 0; b < nbBlocks; b++) {
+      const unsigned int begin = (unsigned int)b * blockSize;
+      projectRange(p, &oX[0], &oY[0], &oZ[0], &u[0], &v[0], begin, std::min(n, begin + blockSize), useSSE2);
+    }
+  }
+}
 
 //! Line coordinates conversion (rho,theta).
 void
@@ -111,3 +246,81 @@ vpMeterPixelConversion::convertEllipse(const vpCameraParameters &cam,
   mu02_p = mu02_m*vpMath::sqr(cam.get_py());
 }
 
+/*!
+  Converts a set of points from normalized coordinates \f$(x,y)\f$ in meter to
+  pixel coordinates \f$(u,v)\f$, as convertPoint() does for each point.
+
+  \param cam [in]: Intrinsic camera parameters.
+  \param x, y [in]: Coordinates of the points in meter in the image plane.
+  \param u, v [out]: Coordinates of the points in pixels, resized to the number of points.
+
+  \exception vpException::dimensionError : If \e x and \e y do not have the same size.
+*/
+void
+vpMeterPixelConversion::convertPoints(const vpCameraParameters &cam,
+                                      const std::vector<double> &x, const std::vector<double> &y,
+                                      std::vector<double> &u, std::vector<double> &v)
+{
+  if (y.size() != x.size()) {
+    throw(vpException(vpException::dimensionError,
+                      "Cannot convert %d points with %d y coordinates", (int)x.size(), (int)y.size()));
+  }
+  u.resize(x.size());
+  v.resize(x.size());
+  if (cam.get_projModel() == vpCameraParameters::perspectiveProjWithDistortion) {
+    for (size_t i = 0; i < x.size(); i++)
+      convertPointWithDistortion(cam, x[i], y[i], u[i], v[i]);
+  }
+  else {
+    for (size_t i = 0; i < x.size(); i++)
+      convertPointWithoutDistortion(cam, x[i], y[i], u[i], v[i]);
+  }
+}
+
+/*!
+  Perspective projection of a set of 3D points in the image plane, as
+  vpPoint::track() does for each point.
+
+  \param cMo [in]: Pose of the object frame in the camera frame.
+  \param oX, oY, oZ [in]: Coordinates of the points in the object frame.
+  \param x, y [out]: Normalized coordinates of the points in meter in the image plane,
+  resized to the number of points.
+  \param nbThreads [in]: Number of threads used to project the points when ViSP is built
+  with OpenMP.
+
+  \exception vpException::dimensionError : If the coordinates do not have the same size.
+*/
+void
+vpMeterPixelConversion::projectPoints(const vpHomogeneousMatrix &cMo,
+                                      const std::vector<double> &oX, const std::vector<double> &oY,
+                                      const std::vector<double> &oZ,
+                                      std::vector<double> &x, std::vector<double> &y,
+                                      const unsigned int nbThreads)
+{
+  projectPointSet(projection(cMo), oX, oY, oZ, x, y, nbThreads);
+}
+
+/*!
+  Perspective projection of a set of 3D points in the image, with the camera
+  projection model including the distortion. The points are transformed,
+  projected and converted in pixels in a single pass, as vpPoint::track()
+  followed by convertPoint() does for each point.
+
+  \param cam [in]: Intrinsic camera parameters.
+  \param cMo [in]: Pose of the object frame in the camera frame.
+  \param oX, oY, oZ [in]: Coordinates of the points in the object frame.
+  \param u, v [out]: Coordinates of the points in pixels, resized to the number of points.
+  \param nbThreads [in]: Number of threads used to project the points when ViSP is built
+  with OpenMP.
+
+  \exception vpException::dimensionError : If the coordinates do not have the same size.
+*/
+void
+vpMeterPixelConversion::projectPoints(const vpCameraParameters &cam, const vpHomogeneousMatrix &cMo,
+                                      const std::vector<double> &oX, const std::vector<double> &oY,
+                                      const std::vector<double> &oZ,
+                                      std::vector<double> &u, std::vector<double> &v,
+                                      const unsigned int nbThreads)
+{
+  projectPointSet(projection(cam, cMo), oX, oY, oZ, u, v, nbThreads);
+}
@@ -2866,6 +2866,30 @@ void vpImageConvert::RGBToRGBa(unsigned char* rgb, unsigned char* rgba, unsigned
   unsigned char *pt_end = rgb + 3*size;
   unsigned char *pt_output = rgba;
 
+  bool checkSSSE3 = vpCPUFeatures::checkSSSE3();
+#if !VISP_HAVE_SSSE3
+  checkSSSE3 = false;
+#endif
+
+  if (checkSSSE3) {
+#if VISP_HAVE_SSSE3
+    //Spread 4 RGB pixels over 16 bytes and set the alpha component
+    const __m128i mask = _mm_set_epi8(
+          -1, 11, 10, 9, -1, 8, 7, 6, -1, 5, 4, 3, -1, 2, 1, 0
+          );
+    const __m128i alpha = _mm_set1_epi32((int) ((unsigned int) vpRGBa::alpha_default << 24));
+
+    //A 16 bytes load reads 4 bytes after the 4 pixels: stop 6 pixels before the end
+    unsigned int i = 0;
+    for (; i + 6 <= size; i += 4) {
+      const __m128i data = _mm_loadu_si128((const __m128i *) pt_input);
+      _mm_storeu_si128((__m128i *) pt_output, _mm_or_si128(_mm_shuffle_epi8(data, mask), alpha));
+      pt_input += 12;
+      pt_output += 16;
+    }
+#endif
+  }
+
   while(pt_input != pt_end) {
     *(pt_output++) = *(pt_input++) ; // R
     *(pt_output++) = *(pt_input++) ; // G
@@ -2887,6 +2911,29 @@ void vpImageConvert::RGBaToRGB(unsigned char* rgba, unsigned char* rgb, unsigned
   unsigned char *pt_end = rgba + 4*size;
   unsigned char *pt_output = rgb;
 
+  bool checkSSSE3 = vpCPUFeatures::checkSSSE3();
+#if !VISP_HAVE_SSSE3
+  checkSSSE3 = false;
+#endif
+
+  if (checkSSSE3) {
+#if VISP_HAVE_SSSE3
+    //Pack the RGB components of 4 pixels in the first 12 bytes
+    const __m128i mask = _mm_set_epi8(
+          -1, -1, -1, -1, 14, 13, 12, 10, 9, 8, 6, 5, 4, 2, 1, 0
+          );
+
+    //A 16 bytes store writes 4 bytes after the 4 pixels: stop 6 pixels before the end
+    unsigned int i = 0;
+    for (; i + 6 <= size; i += 4) {
+      const __m128i data = _mm_loadu_si128((const __m128i *) pt_input);
+      _mm_storeu_si128((__m128i *) pt_output, _mm_shuffle_epi8(data, mask));
+      pt_input += 16;
+      pt_output += 12;
+    }
+#endif
+  }
+
   while(pt_input != pt_end) {
     *(pt_output++) = *(pt_input++) ; // R
     *(pt_output++) = *(pt_input++) ; // G
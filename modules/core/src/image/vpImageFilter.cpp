@@ -38,6 +38,7 @@
 
 #include <visp3/core/vpImageFilter.h>
 #include <visp3/core/vpImageConvert.h>
+#include <visp3/core/vpImagePyramid.h>
 #if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020408)
 #  include <opencv2/imgproc/imgproc.hpp>
 #elif defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020101)
@@ -743,7 +744,6 @@ void vpImageFilter::getGradYGauss2D(const vpImage<unsigned char> &I, vpImage<dou
 //operation pour pyramide gaussienne
 void vpImageFilter::getGaussPyramidal(const vpImage<unsigned char> &I, vpImage<unsigned char>& GI)
 {
-  vpImage<unsigned char> GIx;
 #if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x030000)
   cv::Mat imgsrc, imgdest;
   vpImageConvert::convert(I, imgsrc);
@@ -768,8 +768,7 @@ void vpImageFilter::getGaussPyramidal(const vpImage<unsigned char> &I, vpImage<u
   //vpImage<unsigned char> sGI;sGI=GI;
 
 #else
-  vpImageFilter::getGaussXPyramidal(I,GIx);
-  vpImageFilter::getGaussYPyramidal(GIx,GI);
+  vpImagePyramid::pyrDown(I, GI);
 #endif
 }
 
@@ -0,0 +1,390 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Reusable image pyramid.
+ *
+ *****************************************************************************/
+
+#include <algorithm>
+#include <string.h>
+
+#include <visp3/core/vpCPUFeatures.h>
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpImagePyramid.h>
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
+
+namespace {
+  /*
+    Horizontal [1 4 6 4 1]/16 filtering of one row followed by a subsampling by 2.
+    The first and last output pixels are copied as done in vpImageFilter::getGaussXPyramidal().
+  */
+  void pyrDownRowX(const unsigned char *src, unsigned char *dst, const unsigned int w, const bool useSSE2)
+  {
+    if (w == 0) {
+      return;
+    }
+
+    dst[0] = src[0];
+    unsigned int j = 1;
+
+#if VISP_HAVE_SSE2
+    if (useSSE2) {
+      const __m128i mask = _mm_set1_epi16(0x00FF);
+      // Reads src[2j-2 ... 2j+17], that is inside the row while j+9 <= w
+      for (; j + 9 <= w; j += 8) {
+        const unsigned char *p = src + 2*j - 2;
+        const __m128i a = _mm_loadu_si128( (const __m128i*) p );
+        const __m128i b = _mm_loadu_si128( (const __m128i*) (p + 2) );
+        const __m128i c = _mm_loadu_si128( (const __m128i*) (p + 4) );
+
+        const __m128i a_even = _mm_and_si128(a, mask);
+        const __m128i a_odd  = _mm_srli_epi16(a, 8);
+        const __m128i b_even = _mm_and_si128(b, mask);
+        const __m128i b_odd  = _mm_srli_epi16(b, 8);
+        const __m128i c_even = _mm_and_si128(c, mask);
+
+        __m128i sum = _mm_add_epi16(a_even, c_even);
+        sum = _mm_add_epi16(sum, _mm_slli_epi16(_mm_add_epi16(a_odd, b_odd), 2));
+        sum = _mm_add_epi16(sum, _mm_add_epi16(_mm_slli_epi16(b_even, 2), _mm_slli_epi16(b_even, 1)));
+        sum = _mm_srli_epi16(sum, 4);
+
+        _mm_storel_epi64( (__m128i*) (dst + j), _mm_packus_epi16(sum, sum) );
+      }
+    }
+#else
+    (void)useSSE2;
+#endif
+
+    for (; j + 1 < w; j++) {
+      const unsigned char *p = src + 2*j - 2;
+      dst[j] = (unsigned char) ( (p[0] + 4*(p[1] + p[3]) + 6*p[2] + p[4]) >> 4 );
+    }
+
+    dst[w-1] = src[2*w-1];
+  }
+
+  /*
+    Vertical [1 4 6 4 1]/16 filtering of five consecutive rows.
+  */
+  void pyrDownRowY(const unsigned char *r0, const unsigned char *r1, const unsigned char *r2,
+                   const unsigned char *r3, const unsigned char *r4, unsigned char *dst,
+                   const unsigned int w, const bool useSSE2)
+  {
+    unsigned int j = 0;
+
+#if VISP_HAVE_SSE2
+    if (useSSE2) {
+      const __m128i zero = _mm_setzero_si128();
+      for (; j + 16 <= w; j += 16) {
+        const __m128i v0 = _mm_loadu_si128( (const __m128i*) (r0 + j) );
+        const __m128i v1 = _mm_loadu_si128( (const __m128i*) (r1 + j) );
+        const __m128i v2 = _mm_loadu_si128( (const __m128i*) (r2 + j) );
+        const __m128i v3 = _mm_loadu_si128( (const __m128i*) (r3 + j) );
+        const __m128i v4 = _mm_loadu_si128( (const __m128i*) (r4 + j) );
+
+        __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(v0, zero), _mm_unpacklo_epi8(v4, zero));
+        __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(v0, zero), _mm_unpackhi_epi8(v4, zero));
+
+        const __m128i s13_lo = _mm_add_epi16(_mm_unpacklo_epi8(v1, zero), _mm_unpacklo_epi8(v3, zero));
+        const __m128i s13_hi = _mm_add_epi16(_mm_unpackhi_epi8(v1, zero), _mm_unpackhi_epi8(v3, zero));
+        lo = _mm_add_epi16(lo, _mm_slli_epi16(s13_lo, 2));
+        hi = _mm_add_epi16(hi, _mm_slli_epi16(s13_hi, 2));
+
+        const __m128i v2_lo = _mm_unpacklo_epi8(v2, zero);
+        const __m128i v2_hi = _mm_unpackhi_epi8(v2, zero);
+        lo = _mm_add_epi16(lo, _mm_add_epi16(_mm_slli_epi16(v2_lo, 2), _mm_slli_epi16(v2_lo, 1)));
+        hi = _mm_add_epi16(hi, _mm_add_epi16(_mm_slli_epi16(v2_hi, 2), _mm_slli_epi16(v2_hi, 1)));
+
+        _mm_storeu_si128( (__m128i*) (dst + j), _mm_packus_epi16(_mm_srli_epi16(lo, 4), _mm_srli_epi16(hi, 4)) );
+      }
+    }
+#else
+    (void)useSSE2;
+#endif
+
+    for (; j < w; j++) {
+      dst[j] = (unsigned char) ( (r0[j] + 4*(r1[j] + r3[j]) + 6*r2[j] + r4[j]) >> 4 );
+    }
+  }
+
+  /*
+    Keep one pixel over two of a row.
+  */
+  void decimateRow(const unsigned char *src, unsigned char *dst, const unsigned int w, const bool useSSE2)
+  {
+    unsigned int j = 0;
+
+#if VISP_HAVE_SSE2
+    if (useSSE2) {
+      const __m128i mask = _mm_set1_epi16(0x00FF);
+      for (; j + 16 <= w; j += 16) {
+        const __m128i a = _mm_and_si128(_mm_loadu_si128( (const __m128i*) (src + 2*j) ), mask);
+        const __m128i b = _mm_and_si128(_mm_loadu_si128( (const __m128i*) (src + 2*j + 16) ), mask);
+        _mm_storeu_si128( (__m128i*) (dst + j), _mm_packus_epi16(a, b) );
+      }
+    }
+#else
+    (void)useSSE2;
+#endif
+
+    for (; j < w; j++) {
+      dst[j] = src[2*j];
+    }
+  }
+}
+
+/*!
+  Create a pyramid.
+
+  \param nbLevels : Number of levels, including the full resolution level 0. Should be greater than 0.
+  \param type : Filter used to compute a level from the previous one.
+*/
+vpImagePyramid::vpImagePyramid(const unsigned int nbLevels, const vpPyramidFilterType &type)
+  : m_base(NULL), m_baseCopy(), m_filterType(type), m_levels(), m_nbLevels(1), m_nbThreads(1), m_tmp()
+{
+  setNbLevels(nbLevels);
+}
+
+/*!
+  Copy constructor.
+*/
+vpImagePyramid::vpImagePyramid(const vpImagePyramid &pyramid)
+  : m_base(NULL), m_baseCopy(), m_filterType(GAUSSIAN_FILTER), m_levels(), m_nbLevels(1), m_nbThreads(1), m_tmp()
+{
+  *this = pyramid;
+}
+
+/*!
+  Destructor.
+*/
+vpImagePyramid::~vpImagePyramid()
+{
+}
+
+/*!
+  Copy operator. All the levels are copied, including the full resolution image, so that
+  the copy remains valid when the image given to \e pyramid build() is released.
+*/
+vpImagePyramid &vpImagePyramid::operator=(const vpImagePyramid &pyramid)
+{
+  if (this == &pyramid) {
+    return *this;
+  }
+
+  if (pyramid.m_base != NULL) {
+    m_baseCopy = *pyramid.m_base;
+    m_base = &m_baseCopy;
+  }
+  else {
+    m_baseCopy.destroy();
+    m_base = NULL;
+  }
+  m_filterType = pyramid.m_filterType;
+  m_levels = pyramid.m_levels;
+  m_nbLevels = pyramid.m_nbLevels;
+  m_nbThreads = pyramid.m_nbThreads;
+  m_tmp.resize(pyramid.m_tmp.size());
+
+  return *this;
+}
+
+/*!
+  Compute all the levels of the pyramid from the full resolution image \e I.
+  The level buffers are reused when the size of \e I does not change.
+
+  \param I : Full resolution image. It is not copied and should outlive the use of the pyramid.
+*/
+void vpImagePyramid::build(const vpImage<unsigned char> &I)
+{
+  m_base = &I;
+
+  const vpImage<unsigned char> *prev = &I;
+  for (unsigned int level = 1; level < m_nbLevels; level++) {
+    if (m_filterType == DECIMATION) {
+      decimate(*prev, m_levels[level-1], m_nbThreads);
+    }
+    else {
+      pyrDown(*prev, m_tmp[level-1], m_levels[level-1], m_nbThreads);
+    }
+    prev = &m_levels[level-1];
+  }
+}
+
+/*!
+  Return the image at the given level, 0 being the full resolution image passed to build().
+
+  \exception vpException::notInitialized : If build() was not called.
+  \exception vpException::dimensionError : If \e level is greater than or equal to getNbLevels().
+*/
+const vpImage<unsigned char> &vpImagePyramid::getLevel(const unsigned int level) const
+{
+  if (m_base == NULL) {
+    throw vpException(vpException::notInitialized, "The image pyramid is not built");
+  }
+  if (level >= m_nbLevels) {
+    throw vpException(vpException::dimensionError, "Level %d is out of the pyramid (%d levels)", level, m_nbLevels);
+  }
+
+  return level == 0 ? *m_base : m_levels[level-1];
+}
+
+/*!
+  Set the filter used to compute a level from the previous one.
+  The pyramid has to be built again if the filter changes.
+*/
+void vpImagePyramid::setFilterType(const vpPyramidFilterType &type)
+{
+  if (type != m_filterType) {
+    m_filterType = type;
+    m_base = NULL;
+  }
+}
+
+/*!
+  Set the number of levels including the full resolution level 0.
+  The buffers of the levels that are kept are not released.
+  The pyramid has to be built again if the number of levels changes.
+
+  \exception vpException::badValue : If \e nbLevels is 0.
+*/
+void vpImagePyramid::setNbLevels(const unsigned int nbLevels)
+{
+  if (nbLevels == 0) {
+    throw vpException(vpException::badValue, "An image pyramid should have at least one level");
+  }
+
+  if (nbLevels != m_nbLevels || m_levels.size() != nbLevels-1) {
+    m_nbLevels = nbLevels;
+    m_levels.resize(nbLevels-1);
+    m_tmp.resize(nbLevels-1);
+    m_base = NULL;
+  }
+}
+
+/*!
+  Set the number of threads used to compute each level. It is only taken into account
+  when ViSP is built with OpenMP.
+
+  \param nbThreads : Number of threads. 0 or 1 to use a single thread.
+*/
+void vpImagePyramid::setNbThreads(const unsigned int nbThreads)
+{
+  m_nbThreads = nbThreads > 0 ? nbThreads : 1;
+}
+
+/*!
+  Compute the next pyramid level of an image.
+
+  When \e type is vpImagePyramid::GAUSSIAN_FILTER, the result is the same as the one
+  obtained with vpImageFilter::getGaussXPyramidal() followed by vpImageFilter::getGaussYPyramidal().
+
+  \param I : Input image.
+  \param Idown : Image of size \f$ \lfloor h/2 \rfloor \times \lfloor w/2 \rfloor \f$. \e I and \e Idown may be
+  the same image.
+  \param type : Filter used before the subsampling.
+  \param nbThreads : Number of threads, only used when ViSP is built with OpenMP.
+*/
+void vpImagePyramid::pyrDown(const vpImage<unsigned char> &I, vpImage<unsigned char> &Idown,
+                             const vpPyramidFilterType &type, const unsigned int nbThreads)
+{
+  if (type == DECIMATION) {
+    if (&I == &Idown) {
+      vpImage<unsigned char> I_copy = I;
+      decimate(I_copy, Idown, nbThreads);
+    }
+    else {
+      decimate(I, Idown, nbThreads);
+    }
+  }
+  else {
+    vpImage<unsigned char> Itmp;
+    pyrDown(I, Itmp, Idown, nbThreads);
+  }
+}
+
+void vpImagePyramid::decimate(const vpImage<unsigned char> &I, vpImage<unsigned char> &Idown, const unsigned int nbThreads)
+{
+  const unsigned int h = I.getHeight() / 2, w = I.getWidth() / 2;
+  Idown.resize(h, w);
+
+  const bool useSSE2 = vpCPUFeatures::checkSSE2();
+#ifdef VISP_HAVE_OPENMP
+  #pragma omp parallel for num_threads(nbThreads) if(nbThreads > 1)
+#else
+  (void)nbThreads;
+#endif
+  for (int i = 0; i < (int)h; i++) {
+    decimateRow(I[2*i], Idown[i], w, useSSE2);
+  }
+}
+
+void vpImagePyramid::pyrDown(const vpImage<unsigned char> &I, vpImage<unsigned char> &Itmp,
+                             vpImage<unsigned char> &Idown, const unsigned int nbThreads)
+{
+  const unsigned int h = I.getHeight() / 2, w = I.getWidth() / 2;
+  const bool useSSE2 = vpCPUFeatures::checkSSE2();
+
+  // Horizontal pass; only the rows used by the vertical pass are filtered
+  const unsigned int nbRows = std::min(I.getHeight(), 2*h);
+  Itmp.resize(nbRows, w);
+#ifdef VISP_HAVE_OPENMP
+  #pragma omp parallel for num_threads(nbThreads) if(nbThreads > 1)
+#else
+  (void)nbThreads;
+#endif
+  for (int i = 0; i < (int)nbRows; i++) {
+    pyrDownRowX(I[i], Itmp[i], w, useSSE2);
+  }
+
+  // Vertical pass; the first and last rows are copied as done in vpImageFilter::getGaussYPyramidal()
+  Idown.resize(h, w);
+  if (w == 0) {
+    return;
+  }
+#ifdef VISP_HAVE_OPENMP
+  #pragma omp parallel for num_threads(nbThreads) if(nbThreads > 1)
+#endif
+  for (int i = 0; i < (int)h; i++) {
+    if (i == (int)h-1) {
+      memcpy(Idown[i], Itmp[2*h-1], w);
+    }
+    else if (i == 0) {
+      memcpy(Idown[i], Itmp[0], w);
+    }
+    else {
+      pyrDownRowY(Itmp[2*i-2], Itmp[2*i-1], Itmp[2*i], Itmp[2*i+1], Itmp[2*i+2], Idown[i], w, useSSE2);
+    }
+  }
+}
@@ -1825,7 +1825,11 @@ int main()
 }
   \endcode
 
-  \sa svdLapack(), svdEigen3(), svdOpenCV(), svdGsl()
+  \note Matrices with at least as many rows as columns and at most smallMatrixMaxSize
+  columns can also be decomposed by svdSmall(), which works on stack storage without
+  any 3rd party. It is never selected by this function and has to be called explicitly.
+
+  \sa svdSmall(), svdLapack(), svdEigen3(), svdOpenCV(), svdGsl()
 */
 void
 vpMatrix::svd(vpColVector &w, vpMatrix &V)
@@ -1850,6 +1854,8 @@ vpMatrix::svd(vpColVector &w, vpMatrix &V)
 
   \note By default, this function uses Lapack 3rd party. It is also possible to use a specific 3rd party
   suffixing this function name with one of the following 3rd party names (Lapack, Eigen3, OpenCV or Gsl).
+  Matrices with at most smallMatrixMaxSize rows or columns can also be inverted without 3rd party
+  on stack storage by pseudoInverseSmall(), which has to be called explicitly.
 
   \warning To inverse a square n-by-n matrix, you have to use rather one of the following functions
   inverseByLU(), inverseByQR(), inverseByCholesky() that are kwown as faster.
@@ -1919,6 +1925,8 @@ vpMatrix::pseudoInverse(vpMatrix &Ap, double svThreshold) const
 
   \note By default, this function uses Lapack 3rd party. It is also possible to use a specific 3rd party
   suffixing this function name with one of the following 3rd party names (Lapack, Eigen3, OpenCV or Gsl).
+  Matrices with at most smallMatrixMaxSize rows or columns can also be inverted without 3rd party
+  on stack storage by pseudoInverseSmall(), which has to be called explicitly.
 
   \warning To inverse a square n-by-n matrix, you have to use rather one of the following functions
   inverseByLU(), inverseByQR(), inverseByCholesky() that are kwown as faster.
@@ -3391,6 +3399,8 @@ unsigned int vpMatrix::pseudoInverseGsl(vpMatrix &Ap, vpColVector &sv, double sv
 
   \note By default, this function uses Lapack 3rd party. It is also possible to use a specific 3rd party
   suffixing this function name with one of the following 3rd party names (Lapack, Eigen3, OpenCV or Gsl).
+  Matrices with at most smallMatrixMaxSize rows or columns can also be inverted without 3rd party
+  on stack storage by pseudoInverseSmall(), which has to be called explicitly.
 
   \warning To inverse a square n-by-n matrix, you have to use rather one of the following
   functions inverseByLU(), inverseByQR(), inverseByCholesky() that are kwown as faster.
@@ -3549,6 +3559,8 @@ vpMatrix::pseudoInverse(vpMatrix &Ap, vpColVector &sv, double svThreshold, vpMat
 
   \note By default, this function uses Lapack 3rd party. It is also possible to use a specific 3rd party
   suffixing this function name with one of the following 3rd party names (Lapack, Eigen3, OpenCV or Gsl).
+  Matrices with at most smallMatrixMaxSize columns can also be inverted without 3rd party on stack
+  storage by pseudoInverseSmall(), which has to be called explicitly.
 
   \warning To inverse a square n-by-n matrix, you have to use rather inverseByLU(), inverseByCholesky(),
   or inverseByQR() that are kwown as faster.
@@ -99,7 +99,11 @@ int main()
 }
   \endcode
 
-  \sa pseudoInverse()
+  \note Matrices with at most smallMatrixMaxSize rows can also be inverted by
+  inverseByCholeskySmall(), which works on stack storage without any 3rd party. It is never
+  selected by this function and has to be called explicitly.
+
+  \sa inverseByCholeskySmall(), inverseByLDLT(), pseudoInverse()
 */
 
 vpMatrix
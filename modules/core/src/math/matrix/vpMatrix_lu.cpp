@@ -123,7 +123,11 @@ int main()
 }
   \endcode
 
-  \sa inverseByLULapack(), inverseByLUEigen3(), inverseByLUOpenCV(), inverseByLUGsl(), pseudoInverse()
+  \note Matrices with at most smallMatrixMaxSize rows can also be inverted by inverseByLUSmall(),
+  which works on stack storage without any 3rd party. It is never selected by this function and
+  has to be called explicitly.
+
+  \sa inverseByLUSmall(), inverseByLULapack(), inverseByLUEigen3(), inverseByLUOpenCV(), inverseByLUGsl(), pseudoInverse()
 */
 vpMatrix vpMatrix::inverseByLU() const
 {
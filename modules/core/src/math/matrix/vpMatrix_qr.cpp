@@ -234,7 +234,9 @@ vpMatrix vpMatrix::inverseByQRLapack() const
 /*!
   Compute the inverse of a n-by-n matrix using the QR decomposition.
   Only available if Lapack 3rd party is installed. If Lapack is not installed we use a
-  Lapack built-in version.
+  Lapack built-in version. Matrices with at most smallMatrixMaxSize rows can also be
+  inverted without 3rd party on stack storage by inverseByQRSmall(), which has to be
+  called explicitly.
 
   \return The inverse matrix.
 
@@ -259,7 +261,7 @@ int main()
 }
   \endcode
 
-  \sa inverseByLU(), inverseByCholesky()
+  \sa inverseByLU(), inverseByCholesky(), inverseByQRSmall()
 */
 vpMatrix
 vpMatrix::inverseByQR() const
@@ -0,0 +1,817 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Cholesky, LDLT, LU, QR and SVD decompositions of small matrices.
+ *
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <visp3/core/vpColVector.h>
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpMatrix.h>
+#include <visp3/core/vpMatrixException.h>
+
+namespace {
+  const unsigned int maxSize = vpMatrix::smallMatrixMaxSize;
+
+  void copyMatrix(const vpMatrix &A, double *a)
+  {
+    const unsigned int size = A.size();
+    for (unsigned int i = 0; i < size; i++) {
+      a[i] = A.data[i];
+    }
+  }
+
+  /*!
+    Cholesky decomposition \f$ A = L L^T \f$ of the n x n matrix stored in \e a. The
+    lower triangle of \e a is replaced by \e L. Return false if A is not positive definite.
+  */
+  bool choleskyDecomposition(double *a, const unsigned int n)
+  {
+    for (unsigned int j = 0; j < n; j++) {
+      double *aj = a + j * n;
+      double d = aj[j];
+      for (unsigned int k = 0; k < j; k++) {
+        d -= aj[k] * aj[k];
+      }
+      if (!(d > 0)) {
+        return false;
+      }
+      d = sqrt(d);
+      aj[j] = d;
+
+      for (unsigned int i = j + 1; i < n; i++) {
+        double *ai = a + i * n;
+        double s = ai[j];
+        for (unsigned int k = 0; k < j; k++) {
+          s -= ai[k] * aj[k];
+        }
+        ai[j] = s / d;
+      }
+    }
+    return true;
+  }
+
+  /*!
+    Decomposition \f$ A = L D L^T \f$ of the n x n symmetric matrix stored in \e a, with
+    \e L unit lower triangular and \e D diagonal. The strict lower triangle of \e a is
+    replaced by \e L and its diagonal by \e D. Return false if a pivot is null.
+  */
+  bool ldltDecomposition(double *a, const unsigned int n)
+  {
+    for (unsigned int j = 0; j < n; j++) {
+      double *aj = a + j * n;
+      double d = aj[j];
+      for (unsigned int k = 0; k < j; k++) {
+        d -= aj[k] * aj[k] * a[k * n + k];
+      }
+      if (d == 0) {
+        return false;
+      }
+      aj[j] = d;
+
+      for (unsigned int i = j + 1; i < n; i++) {
+        double *ai = a + i * n;
+        double s = ai[j];
+        for (unsigned int k = 0; k < j; k++) {
+          s -= ai[k] * aj[k] * a[k * n + k];
+        }
+        ai[j] = s / d;
+      }
+    }
+    return true;
+  }
+
+  /*!
+    Replace the lower triangle of the n x n matrix stored in \e a by its inverse. When
+    \e unitDiagonal is true, the diagonal is considered as ones and left untouched.
+  */
+  void invertLowerTriangular(double *a, const unsigned int n, const bool unitDiagonal)
+  {
+    for (unsigned int j = 0; j < n; j++) {
+      if (!unitDiagonal) {
+        a[j * n + j] = 1 / a[j * n + j];
+      }
+      const double xjj = unitDiagonal ? 1 : a[j * n + j];
+
+      // Rows below j of the column j of the inverse, in increasing order
+      for (unsigned int i = j + 1; i < n; i++) {
+        const double *ai = a + i * n;
+        double s = ai[j] * xjj;
+        for (unsigned int k = j + 1; k < i; k++) {
+          s += ai[k] * a[k * n + j];
+        }
+        a[i * n + j] = unitDiagonal ? -s : -s / ai[i];
+      }
+    }
+  }
+
+  /*!
+    Return \f$ X^T D^{-1} X \f$ where \e X is the lower triangle of the n x n matrix
+    stored in \e x. If \e d is NULL, \e D is the identity. If \e unitDiagonal is true,
+    the diagonal of \e X is considered as ones.
+  */
+  vpMatrix lowerTransposeTimesLower(const double *x, const double *d, const unsigned int n, const bool unitDiagonal)
+  {
+    vpMatrix Ainv(n, n);
+    for (unsigned int i = 0; i < n; i++) {
+      for (unsigned int j = 0; j <= i; j++) {
+        double s = 0;
+        for (unsigned int k = i; k < n; k++) {
+          double xki = (k == i && unitDiagonal) ? 1 : x[k * n + i];
+          double xkj = (k == j && unitDiagonal) ? 1 : x[k * n + j];
+          s += (d == NULL) ? xki * xkj : xki * xkj / d[k];
+        }
+        Ainv[i][j] = Ainv[j][i] = s;
+      }
+    }
+    return Ainv;
+  }
+
+  /*!
+    Solve \f$ R X = B \f$ in place in \e b, where \e R is the upper triangle of \e r.
+    Return false if \e R is singular.
+  */
+  bool solveUpperTriangular(const double *r, double *b, const unsigned int n)
+  {
+    for (unsigned int i = n; i-- > 0;) {
+      const double *ri = r + i * n;
+      if (ri[i] == 0) {
+        return false;
+      }
+      for (unsigned int j = 0; j < n; j++) {
+        double s = b[i * n + j];
+        for (unsigned int k = i + 1; k < n; k++) {
+          s -= ri[k] * b[k * n + j];
+        }
+        b[i * n + j] = s / ri[i];
+      }
+    }
+    return true;
+  }
+
+  /*!
+    One-sided Jacobi orthogonalization of the k rows of the k x l matrix \e W with
+    k <= l, whose element (r, c) is w[r * rs + c * cs]. On return the rows of \e W are
+    orthogonal and the initial matrix is \f$ Q W \f$ with \e Q orthogonal.
+  */
+  void jacobiRows(double *w, const unsigned int k, const unsigned int l, const size_t rs, const size_t cs,
+                  double q[][maxSize])
+  {
+    for (unsigned int i = 0; i < k; i++) {
+      for (unsigned int j = 0; j < k; j++) {
+        q[i][j] = (i == j) ? 1.0 : 0.0;
+      }
+    }
+
+    for (unsigned int sweep = 0; sweep < 30; sweep++) {
+      bool rotated = false;
+      for (unsigned int p = 0; p + 1 < k; p++) {
+        for (unsigned int r = p + 1; r < k; r++) {
+          double *wp = w + p * rs, *wr = w + r * rs;
+          double alpha = 0, beta = 0, gamma = 0;
+          for (unsigned int c = 0; c < l; c++) {
+            const double up = wp[c * cs], ur = wr[c * cs];
+            alpha += up * up;
+            beta += ur * ur;
+            gamma += up * ur;
+          }
+          if (gamma == 0 || fabs(gamma) <= std::numeric_limits<double>::epsilon() * sqrt(alpha * beta)) {
+            continue;
+          }
+
+          rotated = true;
+          const double zeta = (beta - alpha) / (2 * gamma);
+          const double t = (zeta >= 0 ? 1.0 : -1.0) / (fabs(zeta) + sqrt(1 + zeta * zeta));
+          const double cos_ = 1 / sqrt(1 + t * t);
+          const double sin_ = cos_ * t;
+          for (unsigned int c = 0; c < l; c++) {
+            const double up = wp[c * cs], ur = wr[c * cs];
+            wp[c * cs] = cos_ * up - sin_ * ur;
+            wr[c * cs] = sin_ * up + cos_ * ur;
+          }
+          for (unsigned int i = 0; i < k; i++) {
+            const double qp = q[i][p], qr = q[i][r];
+            q[i][p] = cos_ * qp - sin_ * qr;
+            q[i][r] = sin_ * qp + cos_ * qr;
+          }
+        }
+      }
+      if (!rotated) {
+        break;
+      }
+    }
+  }
+
+  /*!
+    Norms of the rows of the matrix orthogonalized by jacobiRows() and their order by
+    decreasing norm.
+  */
+  void sortRowNorms(const double *w, const unsigned int k, const unsigned int l, const size_t rs, const size_t cs,
+                    double *sigma, unsigned int *order)
+  {
+    for (unsigned int r = 0; r < k; r++) {
+      double norm = 0;
+      for (unsigned int c = 0; c < l; c++) {
+        norm += w[r * rs + c * cs] * w[r * rs + c * cs];
+      }
+      sigma[r] = sqrt(norm);
+      order[r] = r;
+      for (unsigned int i = r; i > 0 && sigma[order[i-1]] < sigma[order[i]]; i--) {
+        std::swap(order[i-1], order[i]);
+      }
+    }
+  }
+
+  /*!
+    Replace the vectors that are not flagged as valid by unit vectors orthogonal to all
+    the other ones. Element i of vector t is u[t * vs + i * es].
+  */
+  void completeOrthonormalBasis(double *u, const unsigned int dim, const unsigned int nbVectors, const size_t vs,
+                                const size_t es, bool *valid)
+  {
+    // The sum of the squared distances of the canonical vectors to the span of the valid
+    // vectors is at least 1, so that a candidate over this threshold always exists
+    const double threshold = 1.0 / sqrt(2.0 * dim);
+    unsigned int candidate = 0;
+    for (unsigned int t = 0; t < nbVectors; t++) {
+      if (valid[t]) {
+        continue;
+      }
+
+      double *x = u + t * vs;
+      for (; candidate < dim; candidate++) {
+        for (unsigned int i = 0; i < dim; i++) {
+          x[i * es] = (i == candidate) ? 1.0 : 0.0;
+        }
+        for (unsigned int pass = 0; pass < 2; pass++) {
+          for (unsigned int s = 0; s < nbVectors; s++) {
+            if (!valid[s]) {
+              continue;
+            }
+            const double *y = u + s * vs;
+            double dot = 0;
+            for (unsigned int i = 0; i < dim; i++) {
+              dot += x[i * es] * y[i * es];
+            }
+            for (unsigned int i = 0; i < dim; i++) {
+              x[i * es] -= dot * y[i * es];
+            }
+          }
+        }
+
+        double norm = 0;
+        for (unsigned int i = 0; i < dim; i++) {
+          norm += x[i * es] * x[i * es];
+        }
+        norm = sqrt(norm);
+        if (norm > threshold) {
+          for (unsigned int i = 0; i < dim; i++) {
+            x[i * es] /= norm;
+          }
+          break;
+        }
+      }
+      candidate++;
+      valid[t] = true;
+    }
+  }
+
+  unsigned int smallPseudoInverse(const vpMatrix &A, vpMatrix &Ap, vpColVector &sv, const double svThreshold,
+                                  vpMatrix *imA, vpMatrix *imAt, vpMatrix *kerAt)
+  {
+    const unsigned int m = A.getRows(), n = A.getCols();
+    const bool tall = (m >= n);
+    const unsigned int k = tall ? n : m, l = tall ? m : n;
+    if (k > maxSize || (kerAt != NULL && n > maxSize)) {
+      throw(vpMatrixException(vpMatrixException::matrixError,
+                              "Cannot compute the pseudo inverse of a (%ux%u) matrix with pseudoInverseSmall()", m, n));
+    }
+    if (&Ap == &A) {
+      vpMatrix A_ = A;
+      return smallPseudoInverse(A_, Ap, sv, svThreshold, imA, imAt, kerAt);
+    }
+
+    // Ap is used as work space. It receives A^T, so that its rows are the rows of W = A^T
+    // when m >= n, and its columns the rows of W = A otherwise.
+    if (Ap.getRows() != n || Ap.getCols() != m) {
+      Ap.resize(n, m, false);
+    }
+    for (unsigned int i = 0; i < m; i++) {
+      for (unsigned int j = 0; j < n; j++) {
+        Ap[j][i] = A[i][j];
+      }
+    }
+    double *w = Ap.data;
+    const size_t rs = tall ? m : 1, cs = tall ? 1 : m;
+
+    double q[maxSize][maxSize], sigma[maxSize];
+    unsigned int order[maxSize];
+    jacobiRows(w, k, l, rs, cs, q);
+    sortRowNorms(w, k, l, rs, cs, sigma, order);
+
+    if (sv.getRows() != k) {
+      sv.resize(k, false);
+    }
+    unsigned int rank = 0;
+    for (unsigned int r = 0; r < k; r++) {
+      sv[r] = sigma[order[r]];
+      if (sv[r] > sv[0] * svThreshold) {
+        rank++;
+      }
+    }
+
+    // A = W^T S^-1 S Q^T when m >= n, Q S S^-1 W otherwise: the left and right singular
+    // vectors are swapped between both cases
+    vpMatrix *imW = tall ? imA : imAt;
+    vpMatrix *imQ = tall ? imAt : imA;
+    if (imW != NULL) {
+      if (imW->getRows() != l || imW->getCols() != rank) {
+        imW->resize(l, rank, false);
+      }
+      for (unsigned int c = 0; c < l; c++) {
+        for (unsigned int r = 0; r < rank; r++) {
+          (*imW)[c][r] = w[order[r] * rs + c * cs] / sv[r];
+        }
+      }
+    }
+    if (imQ != NULL) {
+      if (imQ->getRows() != k || imQ->getCols() != rank) {
+        imQ->resize(k, rank, false);
+      }
+      for (unsigned int i = 0; i < k; i++) {
+        for (unsigned int r = 0; r < rank; r++) {
+          (*imQ)[i][r] = q[i][order[r]];
+        }
+      }
+    }
+    if (kerAt != NULL) {
+      if (kerAt->getRows() != n - rank || kerAt->getCols() != n) {
+        kerAt->resize(n - rank, n, false);
+      }
+      if (tall) {
+        for (unsigned int t = 0; t < n - rank; t++) {
+          for (unsigned int i = 0; i < n; i++) {
+            (*kerAt)[t][i] = q[i][order[rank + t]];
+          }
+        }
+      }
+      else {
+        // The kernel is the orthogonal complement of the first rows of W in R^n
+        double basis[maxSize][maxSize];
+        bool valid[maxSize];
+        for (unsigned int r = 0; r < n; r++) {
+          valid[r] = (r < rank);
+          for (unsigned int c = 0; r < rank && c < n; c++) {
+            basis[r][c] = w[order[r] * rs + c * cs] / sv[r];
+          }
+        }
+        completeOrthonormalBasis(&basis[0][0], n, n, maxSize, 1, valid);
+        for (unsigned int t = 0; t < n - rank; t++) {
+          for (unsigned int c = 0; c < n; c++) {
+            (*kerAt)[t][c] = basis[rank + t][c];
+          }
+        }
+      }
+    }
+
+    // Pseudo inverse written over W, one column (m >= n) or one row (m < n) at a time
+    double tmp[maxSize];
+    if (tall) {
+      for (unsigned int j = 0; j < m; j++) {
+        for (unsigned int r = 0; r < rank; r++) {
+          tmp[r] = w[order[r] * m + j] / (sv[r] * sv[r]);
+        }
+        for (unsigned int i = 0; i < n; i++) {
+          double s = 0;
+          for (unsigned int r = 0; r < rank; r++) {
+            s += q[i][order[r]] * tmp[r];
+          }
+          w[i * m + j] = s;
+        }
+      }
+    }
+    else {
+      for (unsigned int j = 0; j < n; j++) {
+        double *row = w + j * m;
+        for (unsigned int r = 0; r < rank; r++) {
+          tmp[r] = row[order[r]] / (sv[r] * sv[r]);
+        }
+        for (unsigned int i = 0; i < m; i++) {
+          double s = 0;
+          for (unsigned int r = 0; r < rank; r++) {
+            s += q[i][order[r]] * tmp[r];
+          }
+          row[i] = s;
+        }
+      }
+    }
+
+    return rank;
+  }
+}
+
+/*!
+  Compute the inverse of a n-by-n real symmetric positive definite matrix with
+  \f$ n \leq \f$ smallMatrixMaxSize using a Cholesky decomposition on stack storage.
+  inverseByCholesky() does not use this kernel: call inverseByCholeskySmall() explicitly
+  for such matrices.
+
+  \return The inverse matrix.
+
+  \exception vpMatrixException::matrixError : If the matrix is not square or too large.
+  \exception vpException::fatalError : If the matrix is not positive definite.
+
+  \sa inverseByCholesky()
+*/
+vpMatrix vpMatrix::inverseByCholeskySmall() const
+{
+  if (rowNum != colNum || rowNum > smallMatrixMaxSize) {
+    throw(vpMatrixException(vpMatrixException::matrixError,
+                            "Cannot inverse a (%ux%u) matrix with inverseByCholeskySmall()", rowNum, colNum));
+  }
+
+  double a[maxSize * maxSize];
+  copyMatrix(*this, a);
+  if (!choleskyDecomposition(a, rowNum)) {
+    throw(vpException(vpException::fatalError, "Cannot inverse by Cholesky: the matrix is not positive definite"));
+  }
+  invertLowerTriangular(a, rowNum, false);
+
+  return lowerTransposeTimesLower(a, NULL, rowNum, false);
+}
+
+/*!
+  Compute the inverse of a n-by-n real symmetric matrix using the decomposition
+  \f$ {\bf A} = {\bf L} {\bf D} {\bf L}^\top \f$ where \f$ \bf L \f$ is unit lower
+  triangular and \f$ \bf D \f$ diagonal. Unlike inverseByCholesky(), the matrix does not
+  need to be positive definite, but the decomposition is not pivoted: it fails when a
+  leading principal minor is null.
+
+  Matrices with \f$ n \leq \f$ smallMatrixMaxSize are decomposed on stack storage.
+
+  \return The inverse matrix.
+
+  \exception vpMatrixException::matrixError : If the matrix is not square.
+  \exception vpException::fatalError : If a pivot is null.
+
+  \sa inverseByCholesky()
+*/
+vpMatrix vpMatrix::inverseByLDLT() const
+{
+  if (rowNum != colNum) {
+    throw(vpMatrixException(vpMatrixException::matrixError,
+                            "Cannot inverse a non-square matrix (%ux%u) by LDLT", rowNum, colNum));
+  }
+
+  double a_[maxSize * maxSize];
+  vpMatrix A;
+  double *a = a_;
+  if (rowNum > smallMatrixMaxSize) {
+    A = *this;
+    a = A.data;
+  }
+  else {
+    copyMatrix(*this, a);
+  }
+
+  if (!ldltDecomposition(a, rowNum)) {
+    throw(vpException(vpException::fatalError, "Cannot inverse by LDLT: null pivot"));
+  }
+
+  std::vector<double> d(rowNum);
+  for (unsigned int i = 0; i < rowNum; i++) {
+    d[i] = a[i * rowNum + i];
+  }
+  invertLowerTriangular(a, rowNum, true);
+
+  return lowerTransposeTimesLower(a, &d[0], rowNum, true);
+}
+
+/*!
+  Compute the inverse of a n-by-n matrix with \f$ n \leq \f$ smallMatrixMaxSize using a LU
+  decomposition with partial pivoting on stack storage. inverseByLU() does not use this
+  kernel: call inverseByLUSmall() explicitly for such matrices.
+
+  \return The inverse matrix.
+
+  \exception vpMatrixException::matrixError : If the matrix is not square or too large.
+  \exception vpException::fatalError : If the matrix is singular.
+
+  \sa inverseByLU()
+*/
+vpMatrix vpMatrix::inverseByLUSmall() const
+{
+  if (rowNum != colNum || rowNum > smallMatrixMaxSize) {
+    throw(vpMatrixException(vpMatrixException::matrixError,
+                            "Cannot inverse a (%ux%u) matrix with inverseByLUSmall()", rowNum, colNum));
+  }
+
+  const unsigned int n = rowNum;
+  double a[maxSize * maxSize];
+  unsigned int perm[maxSize];
+  copyMatrix(*this, a);
+  for (unsigned int i = 0; i < n; i++) {
+    perm[i] = i;
+  }
+
+  for (unsigned int k = 0; k < n; k++) {
+    unsigned int pivot = k;
+    for (unsigned int i = k + 1; i < n; i++) {
+      if (fabs(a[i * n + k]) > fabs(a[pivot * n + k])) {
+        pivot = i;
+      }
+    }
+    if (a[pivot * n + k] == 0) {
+      throw(vpException(vpException::fatalError, "Cannot inverse by LU: the matrix is singular"));
+    }
+    if (pivot != k) {
+      std::swap_ranges(a + k * n, a + (k + 1) * n, a + pivot * n);
+      std::swap(perm[k], perm[pivot]);
+    }
+    for (unsigned int i = k + 1; i < n; i++) {
+      const double f = a[i * n + k] / a[k * n + k];
+      a[i * n + k] = f;
+      for (unsigned int j = k + 1; j < n; j++) {
+        a[i * n + j] -= f * a[k * n + j];
+      }
+    }
+  }
+
+  // Solve L U X = P I
+  double b[maxSize * maxSize];
+  for (unsigned int i = 0; i < n; i++) {
+    for (unsigned int j = 0; j < n; j++) {
+      b[i * n + j] = (perm[i] == j) ? 1.0 : 0.0;
+    }
+  }
+  for (unsigned int i = 1; i < n; i++) {
+    for (unsigned int k = 0; k < i; k++) {
+      const double f = a[i * n + k];
+      for (unsigned int j = 0; j < n; j++) {
+        b[i * n + j] -= f * b[k * n + j];
+      }
+    }
+  }
+  solveUpperTriangular(a, b, n);
+
+  vpMatrix Ainv(n, n);
+  for (unsigned int i = 0; i < n * n; i++) {
+    Ainv.data[i] = b[i];
+  }
+  return Ainv;
+}
+
+/*!
+  Compute the inverse of a n-by-n matrix with \f$ n \leq \f$ smallMatrixMaxSize using a
+  Householder QR decomposition on stack storage. inverseByQR() does not use this kernel:
+  call inverseByQRSmall() explicitly for such matrices.
+
+  \return The inverse matrix.
+
+  \exception vpMatrixException::matrixError : If the matrix is not square or too large.
+  \exception vpException::fatalError : If the matrix is singular.
+
+  \sa inverseByQR()
+*/
+vpMatrix vpMatrix::inverseByQRSmall() const
+{
+  if (rowNum != colNum || rowNum > smallMatrixMaxSize) {
+    throw(vpMatrixException(vpMatrixException::matrixError,
+                            "Cannot inverse a (%ux%u) matrix with inverseByQRSmall()", rowNum, colNum));
+  }
+
+  const unsigned int n = rowNum;
+  double a[maxSize * maxSize], b[maxSize * maxSize], v[maxSize];
+  copyMatrix(*this, a);
+  for (unsigned int i = 0; i < n; i++) {
+    for (unsigned int j = 0; j < n; j++) {
+      b[i * n + j] = (i == j) ? 1.0 : 0.0;
+    }
+  }
+
+  // A = Q R with Q^T = H_n-1 ... H_0, the reflections being applied to B = I on the fly
+  for (unsigned int k = 0; k < n; k++) {
+    double norm = 0;
+    for (unsigned int i = k; i < n; i++) {
+      norm += a[i * n + k] * a[i * n + k];
+    }
+    norm = sqrt(norm);
+    if (norm == 0) {
+      continue;
+    }
+
+    const double alpha = (a[k * n + k] > 0) ? -norm : norm;
+    double vnorm2 = 0;
+    for (unsigned int i = k; i < n; i++) {
+      v[i] = a[i * n + k] - ((i == k) ? alpha : 0);
+      vnorm2 += v[i] * v[i];
+    }
+    if (vnorm2 == 0) {
+      continue;
+    }
+
+    for (unsigned int j = k; j < n; j++) {
+      double s = 0;
+      for (unsigned int i = k; i < n; i++) {
+        s += v[i] * a[i * n + j];
+      }
+      s = 2 * s / vnorm2;
+      for (unsigned int i = k; i < n; i++) {
+        a[i * n + j] -= s * v[i];
+      }
+    }
+    for (unsigned int j = 0; j < n; j++) {
+      double s = 0;
+      for (unsigned int i = k; i < n; i++) {
+        s += v[i] * b[i * n + j];
+      }
+      s = 2 * s / vnorm2;
+      for (unsigned int i = k; i < n; i++) {
+        b[i * n + j] -= s * v[i];
+      }
+    }
+  }
+
+  if (!solveUpperTriangular(a, b, n)) {
+    throw(vpException(vpException::fatalError, "Cannot inverse by QR: the matrix is singular"));
+  }
+
+  vpMatrix Ainv(n, n);
+  for (unsigned int i = 0; i < n * n; i++) {
+    Ainv.data[i] = b[i];
+  }
+  return Ainv;
+}
+
+/*!
+  Singular value decomposition of a m-by-n matrix with \f$ m \geq n \f$ and
+  \f$ n \leq \f$ smallMatrixMaxSize by a one-sided Jacobi method. The matrix is replaced by
+  \f$ U \f$, as with svd(). svd() does not use this kernel: call svdSmall() explicitly for
+  such matrices.
+
+  \param w : Vector of singular values, in decreasing order.
+  \param V : Matrix \f$ V \f$.
+
+  \exception vpMatrixException::matrixError : If the matrix has more columns than rows or
+  more than smallMatrixMaxSize columns.
+
+  \sa svd()
+*/
+void vpMatrix::svdSmall(vpColVector &w, vpMatrix &V)
+{
+  if (rowNum < colNum || colNum > smallMatrixMaxSize) {
+    throw(vpMatrixException(vpMatrixException::matrixError,
+                            "Cannot compute the SVD of a (%ux%u) matrix with svdSmall()", rowNum, colNum));
+  }
+
+  const unsigned int m = rowNum, n = colNum;
+  double q[maxSize][maxSize], sigma[maxSize];
+  unsigned int order[maxSize];
+  // The rows of W are the columns of the matrix
+  jacobiRows(data, n, m, 1, n, q);
+  sortRowNorms(data, n, m, 1, n, sigma, order);
+
+  if (w.getRows() != n) {
+    w.resize(n, false);
+  }
+  if (V.getRows() != n || V.getCols() != n) {
+    V.resize(n, n, false);
+  }
+  bool valid[maxSize];
+  for (unsigned int t = 0; t < n; t++) {
+    w[t] = sigma[order[t]];
+    valid[t] = (w[t] > w[0] * std::numeric_limits<double>::epsilon());
+    for (unsigned int i = 0; i < n; i++) {
+      V[i][t] = q[i][order[t]];
+    }
+  }
+
+  // Sort and normalize the columns of U, then complete the ones of the null singular values
+  double tmp[maxSize];
+  for (unsigned int i = 0; i < m; i++) {
+    double *row = rowPtrs[i];
+    for (unsigned int t = 0; t < n; t++) {
+      tmp[t] = valid[t] ? row[order[t]] / w[t] : 0;
+    }
+    for (unsigned int t = 0; t < n; t++) {
+      row[t] = tmp[t];
+    }
+  }
+  completeOrthonormalBasis(data, m, n, 1, n, valid);
+}
+
+/*!
+  Compute and return the Moore-Penros pseudo inverse \f$A^+\f$ of a m-by-n matrix \f$\bf A\f$
+  with \f$ \min(m, n) \leq \f$ smallMatrixMaxSize, using a one-sided Jacobi SVD. See
+  pseudoInverseSmall(vpMatrix &, vpColVector &, double, vpMatrix &, vpMatrix &) const.
+
+  \param svThreshold : Threshold used to test the singular values.
+  \return The Moore-Penros pseudo inverse \f$ A^+ \f$.
+*/
+vpMatrix vpMatrix::pseudoInverseSmall(double svThreshold) const
+{
+  vpMatrix Ap;
+  vpColVector sv;
+  smallPseudoInverse(*this, Ap, sv, svThreshold, NULL, NULL, NULL);
+  return Ap;
+}
+
+/*!
+  Compute the Moore-Penros pseudo inverse \f$A^+\f$ of a m-by-n matrix \f$\bf A\f$
+  with \f$ \min(m, n) \leq \f$ smallMatrixMaxSize and return the rank of the matrix. See
+  pseudoInverseSmall(vpMatrix &, vpColVector &, double, vpMatrix &, vpMatrix &) const.
+*/
+unsigned int vpMatrix::pseudoInverseSmall(vpMatrix &Ap, double svThreshold) const
+{
+  vpColVector sv;
+  return smallPseudoInverse(*this, Ap, sv, svThreshold, NULL, NULL, NULL);
+}
+
+/*!
+  Compute the Moore-Penros pseudo inverse \f$A^+\f$ of a m-by-n matrix \f$\bf A\f$ with
+  \f$ \min(m, n) \leq \f$ smallMatrixMaxSize, its singular values, and return the rank of
+  the matrix. See pseudoInverseSmall(vpMatrix &, vpColVector &, double, vpMatrix &, vpMatrix &) const.
+*/
+unsigned int vpMatrix::pseudoInverseSmall(vpMatrix &Ap, vpColVector &sv, double svThreshold) const
+{
+  return smallPseudoInverse(*this, Ap, sv, svThreshold, NULL, NULL, NULL);
+}
+
+/*!
+  Compute the Moore-Penros pseudo inverse \f$A^+\f$ of a m-by-n matrix \f$\bf A\f$ with
+  \f$ \min(m, n) \leq \f$ smallMatrixMaxSize, along with the singular values and the images
+  of \f$\bf A\f$ and \f$\bf A^\top\f$, and return the rank of the matrix.
+
+  The singular value decomposition is computed by a one-sided Jacobi method that
+  orthogonalizes the \f$ \min(m, n) \f$ rows of \f$ \bf A^\top \f$ or of \f$ \bf A \f$, using
+  \e Ap as work space and stack storage for the rotations. When the outputs keep the same
+  size from one call to the other, no memory is allocated. pseudoInverse() does not use
+  this kernel: call one of the pseudoInverseSmall() overloads explicitly for such matrices.
+
+  \param Ap : The Moore-Penros pseudo inverse \f$ A^+ \f$.
+  \param sv : Singular values, in decreasing order.
+  \param svThreshold : Threshold used to test the singular values. A singular value
+  lower than this threshold times the largest one is considered as null.
+  \param imA : \f$ \mbox{Im}({\bf A}) \f$, m-by-r matrix.
+  \param imAt : \f$ \mbox{Im}({\bf A}^\top) \f$, n-by-r matrix.
+
+  \return The rank r of the matrix.
+
+  \exception vpMatrixException::matrixError : If \f$ \min(m, n) \f$ is greater than
+  smallMatrixMaxSize.
+
+  \sa pseudoInverse()
+*/
+unsigned int vpMatrix::pseudoInverseSmall(vpMatrix &Ap, vpColVector &sv, double svThreshold,
+                                          vpMatrix &imA, vpMatrix &imAt) const
+{
+  return smallPseudoInverse(*this, Ap, sv, svThreshold, &imA, &imAt, NULL);
+}
+
+/*!
+  Compute the Moore-Penros pseudo inverse \f$A^+\f$ of a m-by-n matrix \f$\bf A\f$, its
+  singular values, the images of \f$\bf A\f$ and \f$\bf A^\top\f$ and the kernel of
+  \f$\bf A\f$, and return the rank of the matrix. The matrix should have at most
+  smallMatrixMaxSize columns. See
+  pseudoInverseSmall(vpMatrix &, vpColVector &, double, vpMatrix &, vpMatrix &) const.
+
+  \param kerAt : The matrix whose rows span the kernel of \f$\bf A\f$, (n-r)-by-n.
+*/
+unsigned int vpMatrix::pseudoInverseSmall(vpMatrix &Ap, vpColVector &sv, double svThreshold,
+                                          vpMatrix &imA, vpMatrix &imAt, vpMatrix &kerAt) const
+{
+  return smallPseudoInverse(*this, Ap, sv, svThreshold, &imA, &imAt, &kerAt);
+}
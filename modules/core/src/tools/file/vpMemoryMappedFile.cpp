@@ -0,0 +1,207 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Read-only memory-mapped file.
+ *
+ *****************************************************************************/
+
+#include <algorithm>
+#include <fstream>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpMemoryMappedFile.h>
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  define VISP_HAVE_MMAP
+#elif defined(_WIN32) && !defined(WINRT)
+#  include <windows.h>
+#  define VISP_HAVE_WIN32_FILE_MAPPING
+#endif
+
+/*!
+  Default constructor. No file is open.
+*/
+vpMemoryMappedFile::vpMemoryMappedFile()
+  : m_data(NULL), m_isOpen(false), m_isMapped(false), m_size(0)
+#if defined(_WIN32)
+  , m_mappingHandle(NULL)
+#endif
+{
+}
+
+/*!
+  Open and map a file.
+
+  \param filename : Path of the file.
+  \exception vpException::ioError : If the file cannot be opened.
+*/
+vpMemoryMappedFile::vpMemoryMappedFile(const std::string &filename)
+  : m_data(NULL), m_isOpen(false), m_isMapped(false), m_size(0)
+#if defined(_WIN32)
+  , m_mappingHandle(NULL)
+#endif
+{
+  open(filename);
+}
+
+/*!
+  Destructor that unmaps the file.
+*/
+vpMemoryMappedFile::~vpMemoryMappedFile()
+{
+  close();
+}
+
+/*!
+  Unmap the file. The pointers returned by getData() are no more valid.
+*/
+void vpMemoryMappedFile::close()
+{
+  if (m_isMapped) {
+#if defined(VISP_HAVE_MMAP)
+    munmap(m_data, m_size);
+#elif defined(VISP_HAVE_WIN32_FILE_MAPPING)
+    UnmapViewOfFile(m_data);
+    CloseHandle((HANDLE) m_mappingHandle);
+    m_mappingHandle = NULL;
+#endif
+  } else {
+    delete[] m_data;
+  }
+
+  m_data = NULL;
+  m_size = 0;
+  m_isOpen = false;
+  m_isMapped = false;
+}
+
+/*!
+  Open and map a file. A previously opened file is closed.
+
+  \param filename : Path of the file.
+  \exception vpException::ioError : If the file cannot be opened.
+*/
+void vpMemoryMappedFile::open(const std::string &filename)
+{
+  close();
+
+#if defined(VISP_HAVE_MMAP)
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw vpException(vpException::ioError, "Cannot open file %s", filename.c_str());
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw vpException(vpException::ioError, "Cannot get the size of file %s", filename.c_str());
+  }
+
+  m_size = (size_t) st.st_size;
+  if (m_size > 0) {
+    void *data = mmap(NULL, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED) {
+      m_data = (unsigned char *) data;
+      m_isMapped = true;
+    }
+  }
+  ::close(fd);
+#elif defined(VISP_HAVE_WIN32_FILE_MAPPING)
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    throw vpException(vpException::ioError, "Cannot open file %s", filename.c_str());
+  }
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    CloseHandle(file);
+    throw vpException(vpException::ioError, "Cannot get the size of file %s", filename.c_str());
+  }
+
+  m_size = (size_t) size.QuadPart;
+  if (m_size > 0) {
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if (mapping != NULL) {
+      void *data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+      if (data != NULL) {
+        m_data = (unsigned char *) data;
+        m_mappingHandle = mapping;
+        m_isMapped = true;
+      } else {
+        CloseHandle(mapping);
+      }
+    }
+  }
+  CloseHandle(file);
+#endif
+
+  if (!m_isMapped) {
+    // No memory mapping available, read the whole file
+    std::ifstream file(filename.c_str(), std::ifstream::binary);
+    if (!file.is_open()) {
+      throw vpException(vpException::ioError, "Cannot open file %s", filename.c_str());
+    }
+    file.seekg(0, std::ios::end);
+    m_size = (size_t) file.tellg();
+    file.seekg(0, std::ios::beg);
+    if (m_size > 0) {
+      m_data = new unsigned char[m_size];
+      if (!file.read((char *) m_data, (std::streamsize) m_size)) {
+        close();
+        throw vpException(vpException::ioError, "Cannot read file %s", filename.c_str());
+      }
+    }
+  }
+
+  m_isOpen = true;
+}
+
+/*!
+  Exchange the content of two mapped files without remapping them.
+
+  \param file : Other mapped file.
+*/
+void vpMemoryMappedFile::swap(vpMemoryMappedFile &file)
+{
+  std::swap(m_data, file.m_data);
+  std::swap(m_isOpen, file.m_isOpen);
+  std::swap(m_isMapped, file.m_isMapped);
+  std::swap(m_size, file.m_size);
+#if defined(_WIN32)
+  std::swap(m_mappingHandle, file.m_mappingHandle);
+#endif
+}
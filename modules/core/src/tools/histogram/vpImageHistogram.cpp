@@ -0,0 +1,553 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Parallel computation of image histograms.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpImageHistogram.cpp
+  \brief Parallel computation of image histograms.
+*/
+
+#include <algorithm>
+#include <string.h>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpImageHistogram.h>
+
+// Without OpenMP the bands are counted with vpThread
+#if !defined(VISP_HAVE_OPENMP) && (defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0)))
+#  include <visp3/core/vpThread.h>
+#  define VISP_HISTOGRAM_USE_THREAD 1
+#endif
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+// Interleaved tables used when the histogram is small enough to stay in cache
+const unsigned int vpMaxInterleavedBins = 4096;
+
+// dst[i] += src[i]
+void vp_addHistogram(unsigned int *dst, const unsigned int *src, size_t size)
+{
+  size_t i = 0;
+#if VISP_HAVE_SSE2
+  for (const size_t size4 = size & ~(size_t)3; i < size4; i += 4) {
+    __m128i sum = _mm_add_epi32(_mm_loadu_si128((const __m128i *)(dst + i)), _mm_loadu_si128((const __m128i *)(src + i)));
+    _mm_storeu_si128((__m128i *)(dst + i), sum);
+  }
+#endif
+  for (; i < size; i++) {
+    dst[i] += src[i];
+  }
+}
+
+#if VISP_HISTOGRAM_USE_THREAD
+// Band of rows counted in a vpThread
+template <class Counter>
+struct vpBand {
+  const Counter *counter;
+  unsigned int rowBegin;
+  unsigned int rowEnd;
+  unsigned int *hist;
+};
+
+template <class Counter>
+vpThread::Return vp_countBandThread(vpThread::Args args)
+{
+  const vpBand<Counter> *band = static_cast<const vpBand<Counter> *>(args);
+  (*band->counter)(band->rowBegin, band->rowEnd, band->hist);
+  return 0;
+}
+#endif
+
+/*
+  Split the rows of the image in bands, one per thread, count each band with
+  the counter in its own histogram and sum the histograms in hist, an array
+  of size bins. The counter adds the counts of the rows [rowBegin, rowEnd[ to
+  a histogram of size bins.
+*/
+template <class Counter>
+void vp_countBands(const Counter &counter, unsigned int height, size_t size, unsigned int nbThreads,
+                   unsigned int *hist)
+{
+  memset(hist, 0, size * sizeof(unsigned int));
+
+  unsigned int nbBands = 1;
+#if defined(VISP_HAVE_OPENMP) || VISP_HISTOGRAM_USE_THREAD
+  if (nbThreads > 1 && height > 1) {
+    nbBands = std::min(nbThreads, height);
+  }
+#else
+  (void)nbThreads;
+#endif
+
+  std::vector<unsigned int> others((nbBands - 1) * size, 0);
+
+#if VISP_HISTOGRAM_USE_THREAD
+  // The first band is counted in the calling thread
+  std::vector<vpBand<Counter> > bands(nbBands);
+  std::vector<vpThread *> threads;
+  for (unsigned int band = 0; band < nbBands; band++) {
+    bands[band].counter = &counter;
+    bands[band].rowBegin = (unsigned int)((unsigned long long)height * band / nbBands);
+    bands[band].rowEnd = (unsigned int)((unsigned long long)height * (band + 1) / nbBands);
+    bands[band].hist = band == 0 ? hist : &others[(band - 1) * size];
+    if (band > 0) {
+      threads.push_back(new vpThread((vpThread::Fn)vp_countBandThread<Counter>, (vpThread::Args)&bands[band]));
+    }
+  }
+  counter(bands[0].rowBegin, bands[0].rowEnd, hist);
+  for (size_t i = 0; i < threads.size(); i++) {
+    threads[i]->join();
+    delete threads[i];
+  }
+#else
+#ifdef VISP_HAVE_OPENMP
+  #pragma omp parallel for num_threads(nbBands) if(nbBands > 1)
+#endif
+  for (int band = 0; band < (int)nbBands; band++) {
+    unsigned int rowBegin = (unsigned int)((unsigned long long)height * band / nbBands);
+    unsigned int rowEnd = (unsigned int)((unsigned long long)height * (band + 1) / nbBands);
+    counter(rowBegin, rowEnd, band == 0 ? hist : &others[(band - 1) * size]);
+  }
+#endif
+
+  for (unsigned int band = 1; band < nbBands; band++) {
+    vp_addHistogram(hist, &others[(band - 1) * size], size);
+  }
+}
+
+template <class Counter>
+void vp_countBands(const Counter &counter, unsigned int height, size_t size, unsigned int nbThreads,
+                   std::vector<unsigned int> &hist)
+{
+  hist.resize(size);
+  vp_countBands(counter, height, size, nbThreads, &hist[0]);
+}
+
+// Gather the bins of a 256 bins histogram in nbins bins, as vpHistogram does
+void vp_foldHistogram(const unsigned int *raw, unsigned int nbins, unsigned int *hist)
+{
+  memset(hist, 0, nbins * sizeof(unsigned int));
+  for (unsigned int i = 0; i < 256; i++) {
+    hist[(unsigned int)(i * nbins / 256.0)] += raw[i];
+  }
+}
+
+void vp_foldHistogram(const unsigned int *raw, unsigned int nbins, std::vector<unsigned int> &hist)
+{
+  hist.resize(nbins);
+  vp_foldHistogram(raw, nbins, &hist[0]);
+}
+
+// Grey level values, counted on 256 bins in four interleaved tables
+struct vpGreyCounter {
+  const unsigned char *bitmap;
+  unsigned int width;
+
+  void operator()(unsigned int rowBegin, unsigned int rowEnd, unsigned int *hist) const
+  {
+    unsigned int tables[4][256];
+    memset(tables, 0, sizeof(tables));
+
+    const unsigned char *ptr = bitmap + (size_t)rowBegin * width;
+    const unsigned char *end = bitmap + (size_t)rowEnd * width;
+    for (; ptr + 4 <= end; ptr += 4) {
+      ++tables[0][ptr[0]];
+      ++tables[1][ptr[1]];
+      ++tables[2][ptr[2]];
+      ++tables[3][ptr[3]];
+    }
+    for (; ptr != end; ++ptr) {
+      ++tables[0][*ptr];
+    }
+
+    for (unsigned int k = 0; k < 4; k++) {
+      vp_addHistogram(hist, tables[k], 256);
+    }
+  }
+};
+
+// RGBa values, counted on 4x256 bins (R, G, B then A) in two interleaved tables
+struct vpRGBaCounter {
+  const unsigned char *bitmap;
+  unsigned int width;
+
+  void operator()(unsigned int rowBegin, unsigned int rowEnd, unsigned int *hist) const
+  {
+    unsigned int tables[2][4 * 256];
+    memset(tables, 0, sizeof(tables));
+
+    const unsigned char *ptr = bitmap + (size_t)rowBegin * width * 4;
+    const unsigned char *end = bitmap + (size_t)rowEnd * width * 4;
+    for (; ptr + 8 <= end; ptr += 8) {
+      ++tables[0][ptr[0]];
+      ++tables[0][256 + ptr[1]];
+      ++tables[0][512 + ptr[2]];
+      ++tables[0][768 + ptr[3]];
+      ++tables[1][ptr[4]];
+      ++tables[1][256 + ptr[5]];
+      ++tables[1][512 + ptr[6]];
+      ++tables[1][768 + ptr[7]];
+    }
+    for (; ptr != end; ptr += 4) {
+      ++tables[0][ptr[0]];
+      ++tables[0][256 + ptr[1]];
+      ++tables[0][512 + ptr[2]];
+      ++tables[0][768 + ptr[3]];
+    }
+
+    vp_addHistogram(hist, tables[0], 4 * 256);
+    vp_addHistogram(hist, tables[1], 4 * 256);
+  }
+};
+
+/*
+  Values mapped to a bin with a look-up table. The last bin of the counted
+  histogram, of index nbins, receives the values to ignore.
+*/
+template <typename Type>
+struct vpLutCounter {
+  const Type *bitmap;
+  unsigned int width;
+  const unsigned int *lut;
+  unsigned int nbins;
+
+  void operator()(unsigned int rowBegin, unsigned int rowEnd, unsigned int *hist) const
+  {
+    const Type *ptr = bitmap + (size_t)rowBegin * width;
+    const Type *end = bitmap + (size_t)rowEnd * width;
+    size_t size = nbins + 1;
+
+    if (nbins > vpMaxInterleavedBins) {
+      for (; ptr != end; ++ptr) {
+        ++hist[lut[*ptr]];
+      }
+      return;
+    }
+
+    std::vector<unsigned int> tables(3 * size, 0);
+    unsigned int *table1 = &tables[0], *table2 = table1 + size, *table3 = table2 + size;
+    for (; ptr + 4 <= end; ptr += 4) {
+      ++hist[lut[ptr[0]]];
+      ++table1[lut[ptr[1]]];
+      ++table2[lut[ptr[2]]];
+      ++table3[lut[ptr[3]]];
+    }
+    for (; ptr != end; ++ptr) {
+      ++hist[lut[*ptr]];
+    }
+
+    for (unsigned int k = 0; k < 3; k++) {
+      vp_addHistogram(hist, &tables[k * size], size);
+    }
+  }
+};
+
+// Floating point values in [minValue, maxValue], the bin nbins receives the other ones
+struct vpFloatCounter {
+  const float *bitmap;
+  unsigned int width;
+  float minValue;
+  float maxValue;
+  unsigned int nbins;
+
+  inline unsigned int bin(float value) const
+  {
+    if (!(value >= minValue && value <= maxValue)) { // Also true for NaN
+      return nbins;
+    }
+    unsigned int index = (unsigned int)((value - minValue) / (maxValue - minValue) * nbins);
+    return index < nbins ? index : nbins - 1;
+  }
+
+  void operator()(unsigned int rowBegin, unsigned int rowEnd, unsigned int *hist) const
+  {
+    const float *ptr = bitmap + (size_t)rowBegin * width;
+    const float *end = bitmap + (size_t)rowEnd * width;
+    size_t size = nbins + 1;
+
+    if (nbins > vpMaxInterleavedBins) {
+      for (; ptr != end; ++ptr) {
+        ++hist[bin(*ptr)];
+      }
+      return;
+    }
+
+    std::vector<unsigned int> tables(3 * size, 0);
+    unsigned int *table1 = &tables[0], *table2 = table1 + size, *table3 = table2 + size;
+    for (; ptr + 4 <= end; ptr += 4) {
+      ++hist[bin(ptr[0])];
+      ++table1[bin(ptr[1])];
+      ++table2[bin(ptr[2])];
+      ++table3[bin(ptr[3])];
+    }
+    for (; ptr != end; ++ptr) {
+      ++hist[bin(*ptr)];
+    }
+
+    for (unsigned int k = 0; k < 3; k++) {
+      vp_addHistogram(hist, &tables[k * size], size);
+    }
+  }
+};
+
+// Pairs of grey level values, the index of the bin is lut1[I1] + lut2[I2]
+struct vpJointCounter {
+  const unsigned char *bitmap1;
+  const unsigned char *bitmap2;
+  unsigned int width;
+  unsigned int lut1[256];
+  unsigned int lut2[256];
+
+  void operator()(unsigned int rowBegin, unsigned int rowEnd, unsigned int *hist) const
+  {
+    const unsigned char *ptr1 = bitmap1 + (size_t)rowBegin * width;
+    const unsigned char *ptr2 = bitmap2 + (size_t)rowBegin * width;
+    const unsigned char *end1 = bitmap1 + (size_t)rowEnd * width;
+    for (; ptr1 != end1; ++ptr1, ++ptr2) {
+      ++hist[lut1[*ptr1] + lut2[*ptr2]];
+    }
+  }
+};
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Compute the histogram of a grey level image.
+
+  \param I : Grey level image.
+  \param hist : Histogram resized to \e nbins bins. The level \e l is
+  counted in the bin \f$ \lfloor l \times nbins / 256 \rfloor \f$.
+  \param nbins : Number of bins, in [1, 256].
+  \param nbThreads : Number of threads used to count the bands of rows.
+
+  \exception vpException::badValue : The number of bins is not in [1, 256].
+*/
+void vpImageHistogram::calculate(const vpImage<unsigned char> &I, std::vector<unsigned int> &hist,
+                                 const unsigned int nbins, const unsigned int nbThreads)
+{
+  if (nbins == 0 || nbins > 256) {
+    throw(vpException(vpException::badValue, "Cannot compute a grey level histogram of %u bins", nbins));
+  }
+
+  hist.resize(nbins);
+  calculate(I, &hist[0], nbins, nbThreads);
+}
+
+/*!
+  Compute the histogram of a grey level image in an array allocated by the
+  caller, for instance the one of a vpHistogram.
+
+  \param I : Grey level image.
+  \param hist : Array of \e nbins bins. The level \e l is counted in the bin
+  \f$ \lfloor l \times nbins / 256 \rfloor \f$.
+  \param nbins : Number of bins, in [1, 256].
+  \param nbThreads : Number of threads used to count the bands of rows.
+
+  \exception vpException::badValue : The number of bins is not in [1, 256].
+*/
+void vpImageHistogram::calculate(const vpImage<unsigned char> &I, unsigned int *hist, const unsigned int nbins,
+                                 const unsigned int nbThreads)
+{
+  if (nbins == 0 || nbins > 256) {
+    throw(vpException(vpException::badValue, "Cannot compute a grey level histogram of %u bins", nbins));
+  }
+
+  vpGreyCounter counter;
+  counter.bitmap = I.bitmap;
+  counter.width = I.getWidth();
+
+  if (nbins == 256) {
+    vp_countBands(counter, I.getHeight(), 256, nbThreads, hist);
+  } else {
+    unsigned int raw[256];
+    vp_countBands(counter, I.getHeight(), 256, nbThreads, raw);
+    vp_foldHistogram(raw, nbins, hist);
+  }
+}
+
+/*!
+  Compute the histograms of the four channels of a color image in a single
+  pass over the image.
+
+  \param I : Color image.
+  \param histR : Histogram of the red channel, resized to \e nbins bins.
+  \param histG : Histogram of the green channel, resized to \e nbins bins.
+  \param histB : Histogram of the blue channel, resized to \e nbins bins.
+  \param histA : Histogram of the alpha channel, resized to \e nbins bins.
+  \param nbins : Number of bins, in [1, 256].
+  \param nbThreads : Number of threads used to count the bands of rows.
+
+  \exception vpException::badValue : The number of bins is not in [1, 256].
+*/
+void vpImageHistogram::calculate(const vpImage<vpRGBa> &I, std::vector<unsigned int> &histR,
+                                 std::vector<unsigned int> &histG, std::vector<unsigned int> &histB,
+                                 std::vector<unsigned int> &histA, const unsigned int nbins,
+                                 const unsigned int nbThreads)
+{
+  if (nbins == 0 || nbins > 256) {
+    throw(vpException(vpException::badValue, "Cannot compute a color histogram of %u bins", nbins));
+  }
+
+  vpRGBaCounter counter;
+  counter.bitmap = (const unsigned char *)I.bitmap;
+  counter.width = I.getWidth();
+
+  std::vector<unsigned int> raw;
+  vp_countBands(counter, I.getHeight(), 4 * 256, nbThreads, raw);
+
+  vp_foldHistogram(&raw[0], nbins, histR);
+  vp_foldHistogram(&raw[256], nbins, histG);
+  vp_foldHistogram(&raw[512], nbins, histB);
+  vp_foldHistogram(&raw[768], nbins, histA);
+}
+
+/*!
+  Compute the histogram of a 16 bits image, for instance a depth image.
+
+  \param I : 16 bits image.
+  \param hist : Histogram resized to \e nbins bins. The value \e v is
+  counted in the bin \f$ \lfloor v \times nbins / (maxValue+1) \rfloor \f$.
+  The values greater than \e maxValue are not counted.
+  \param nbins : Number of bins, in [1, maxValue+1].
+  \param maxValue : Greatest value counted in the histogram.
+  \param nbThreads : Number of threads used to count the bands of rows.
+
+  \exception vpException::badValue : The number of bins is not in [1,
+  maxValue+1] or maxValue is greater than 65535.
+*/
+void vpImageHistogram::calculate(const vpImage<uint16_t> &I, std::vector<unsigned int> &hist,
+                                 const unsigned int nbins, const unsigned int maxValue,
+                                 const unsigned int nbThreads)
+{
+  if (maxValue > 65535 || nbins == 0 || nbins > maxValue + 1) {
+    throw(vpException(vpException::badValue, "Cannot compute a histogram of %u bins of the values in [0, %u]", nbins,
+                      maxValue));
+  }
+
+  std::vector<unsigned int> lut(65536, nbins);
+  for (unsigned int v = 0; v <= maxValue; v++) {
+    lut[v] = (unsigned int)((unsigned long long)v * nbins / (maxValue + 1));
+  }
+
+  vpLutCounter<uint16_t> counter;
+  counter.bitmap = I.bitmap;
+  counter.width = I.getWidth();
+  counter.lut = &lut[0];
+  counter.nbins = nbins;
+
+  vp_countBands(counter, I.getHeight(), nbins + 1, nbThreads, hist);
+  hist.resize(nbins); // Drop the values greater than maxValue
+}
+
+/*!
+  Compute the histogram of a floating point image.
+
+  \param I : Floating point image.
+  \param hist : Histogram resized to \e nbins bins of equal width between
+  \e minValue and \e maxValue. The values out of [minValue, maxValue] and
+  NaN are not counted; \e maxValue is counted in the last bin.
+  \param nbins : Number of bins.
+  \param minValue : Smallest value counted in the histogram.
+  \param maxValue : Greatest value counted in the histogram.
+  \param nbThreads : Number of threads used to count the bands of rows.
+
+  \exception vpException::badValue : The number of bins is 0 or \e maxValue
+  is not greater than \e minValue.
+*/
+void vpImageHistogram::calculate(const vpImage<float> &I, std::vector<unsigned int> &hist, const unsigned int nbins,
+                                 const float minValue, const float maxValue, const unsigned int nbThreads)
+{
+  if (nbins == 0 || !(maxValue > minValue)) {
+    throw(vpException(vpException::badValue, "Cannot compute a histogram of %u bins of the values in [%f, %f]", nbins,
+                      minValue, maxValue));
+  }
+
+  vpFloatCounter counter;
+  counter.bitmap = I.bitmap;
+  counter.width = I.getWidth();
+  counter.minValue = minValue;
+  counter.maxValue = maxValue;
+  counter.nbins = nbins;
+
+  vp_countBands(counter, I.getHeight(), nbins + 1, nbThreads, hist);
+  hist.resize(nbins); // Drop the values out of the range
+}
+
+/*!
+  Compute the joint histogram of two grey level images of the same size, for
+  instance to compute their mutual information.
+
+  \param I1 : First grey level image.
+  \param I2 : Second grey level image.
+  \param hist : Histogram resized to \e nbins1 x \e nbins2 bins, stored row
+  by row: the pixels with the level \e l1 in \e I1 and \e l2 in \e I2 are
+  counted in the bin \f$ b_1 \times nbins2 + b_2 \f$ with
+  \f$ b_1 = \lfloor l_1 \times nbins1 / 256 \rfloor \f$ and
+  \f$ b_2 = \lfloor l_2 \times nbins2 / 256 \rfloor \f$.
+  \param nbins1 : Number of bins for \e I1, in [1, 256].
+  \param nbins2 : Number of bins for \e I2, in [1, 256].
+  \param nbThreads : Number of threads used to count the bands of rows.
+
+  \exception vpException::dimensionError : The images have not the same size.
+  \exception vpException::badValue : A number of bins is not in [1, 256].
+*/
+void vpImageHistogram::calculate(const vpImage<unsigned char> &I1, const vpImage<unsigned char> &I2,
+                                 std::vector<unsigned int> &hist, const unsigned int nbins1,
+                                 const unsigned int nbins2, const unsigned int nbThreads)
+{
+  if (I1.getHeight() != I2.getHeight() || I1.getWidth() != I2.getWidth()) {
+    throw(vpException(vpException::dimensionError, "Cannot compute the joint histogram of a %ux%u and a %ux%u image",
+                      I1.getWidth(), I1.getHeight(), I2.getWidth(), I2.getHeight()));
+  }
+  if (nbins1 == 0 || nbins1 > 256 || nbins2 == 0 || nbins2 > 256) {
+    throw(vpException(vpException::badValue, "Cannot compute a joint histogram of %ux%u bins", nbins1, nbins2));
+  }
+
+  vpJointCounter counter;
+  counter.bitmap1 = I1.bitmap;
+  counter.bitmap2 = I2.bitmap;
+  counter.width = I1.getWidth();
+  for (unsigned int i = 0; i < 256; i++) {
+    counter.lut1[i] = (unsigned int)(i * nbins1 / 256.0) * nbins2;
+    counter.lut2[i] = (unsigned int)(i * nbins2 / 256.0);
+  }
+
+  vp_countBands(counter, I1.getHeight(), (size_t)nbins1 * nbins2, nbThreads, hist);
+}
@@ -39,11 +39,42 @@
 
 #include <visp3/core/vpNetwork.h>
 
+#include <algorithm>
+#include <errno.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+const unsigned int vpBinaryMagic = 0x7670424e; // "vpBN"
+const unsigned int vpBinaryHeaderSize = 12;
+const unsigned int vpBinaryMaxParams = 65536;
+const unsigned int vpBinaryMaxIdSize = 4096;
+const size_t vpBinaryBufferSize = 65536;
+const int vpBinaryMaxIovec = 64;
+
+void vp_writeUInt32(char *dst, const unsigned int &value)
+{
+  unsigned int v = (unsigned int)htonl(value);
+  memcpy(dst, &v, sizeof(unsigned int));
+}
+
+unsigned int vp_readUInt32(const char *src)
+{
+  unsigned int v;
+  memcpy(&v, src, sizeof(unsigned int));
+  return (unsigned int)ntohl(v);
+}
+}
+#endif
+
 vpNetwork::vpNetwork()
   : emitter(), receptor_list(), readFileDescriptor(), socketMax(0), request_list(),
-    max_size_message(999999), separator("[*@*]"), beginning("[*start*]"), end("[*end*]"),
+    max_size_message(999999), max_size_binary_message((size_t)1 << 28), separator("[*@*]"), beginning("[*start*]"), end("[*end*]"),
     param_sep("[*|*]"), currentMessageReceived(), tv(), tv_sec(0), tv_usec(10),
-    verboseMode(false)
+    verboseMode(false), binaryMode(false), binaryCompleted()
+#if defined(__linux__)
+  , epollFileDescriptor(-1), epollSockets()
+#endif
 {
   tv.tv_sec = tv_sec;
 #if TARGET_OS_IPHONE
@@ -63,6 +94,10 @@ vpNetwork::vpNetwork()
 
 vpNetwork::~vpNetwork()
 {
+#if defined(__linux__)
+  if(epollFileDescriptor != -1)
+    close(epollFileDescriptor);
+#endif
 #if defined(_WIN32)
   WSACleanup();
 #endif
@@ -201,14 +236,18 @@ int vpNetwork::sendRequestTo(vpRequest &req, const unsigned int &dest)
     return 0;
   }
 
+  if(binaryMode)
+    return _sendBinaryRequestTo(req, dest);
+
   std::string message = beginning + req.getId() + separator;
 
-  if(req.size() != 0){
-    message += req[0];
+  for(unsigned int i = 0 ; i < req.size() ; i++){
+    if(i != 0)
+      message += param_sep;
 
-    for(unsigned int i = 1 ; i < req.size() ; i++){
-        message += param_sep + req[i];
-    }
+    size_t sizeOfParam;
+    const char *param = req.getParameterData(i, sizeOfParam);
+    message.append(param, sizeOfParam);
   }
 
   message += end;
@@ -512,6 +551,15 @@ std::vector<int> vpNetwork::_handleRequests()
 */
 int vpNetwork::_handleFirstRequest()
 {
+  if(binaryMode){
+    if(binaryCompleted.size() == 0)
+      return -1;
+
+    int indRequest = binaryCompleted[0];
+    binaryCompleted.erase(binaryCompleted.begin());
+    return indRequest;
+  }
+
   size_t indStart = currentMessageReceived.find(beginning);
   size_t indSep = currentMessageReceived.find(separator);
   size_t indEnd = currentMessageReceived.find(end);
@@ -578,7 +626,7 @@ int vpNetwork::_handleFirstRequest()
   size_t indEndParam = currentMessageReceived.find(param_sep,indDebParam);
 
   std::string param;
-  while(indEndParam != std::string::npos || indEndParam < indEnd)
+  while(indEndParam != std::string::npos && indEndParam < indEnd)
   {
     param = currentMessageReceived.substr((unsigned)indDebParam,(unsigned)(indEndParam - indDebParam));
     request_list[(unsigned)indRequest]->addParameter(param);
@@ -660,6 +708,9 @@ int vpNetwork::_receiveRequestOnce()
     return -1;
   }
 
+  if(binaryMode)
+    return _receiveBinaryOnce();
+
   tv.tv_sec = tv_sec;
 #if TARGET_OS_IPHONE
   tv.tv_usec = (int)tv_usec;
@@ -757,6 +808,18 @@ int vpNetwork::_receiveRequestOnceFrom(const unsigned int &receptorEmitting)
   tv.tv_usec = tv_usec;
 #endif
 
+  if(binaryMode){
+    // Messages that were waiting for the handling of a request
+    _resumeBinary(receptor_list[receptorEmitting]);
+    if(receptor_list[receptorEmitting].binary.stage == vpBinaryReception::CORRUPTED){
+      _disconnectBinary(receptorEmitting);
+      return -1;
+    }
+    // Do not wait for new bytes when a request is already waiting to be handled
+    if(binaryCompleted.size() != 0)
+      tv.tv_sec = tv.tv_usec = 0;
+  }
+
   FD_ZERO(&readFileDescriptor);
 
   socketMax = receptor_list[receptorEmitting].socketFileDescriptorReceptor;
@@ -775,6 +838,9 @@ int vpNetwork::_receiveRequestOnceFrom(const unsigned int &receptorEmitting)
   }
   else{
     if(FD_ISSET((unsigned int)receptor_list[receptorEmitting].socketFileDescriptorReceptor,&readFileDescriptor)){
+      if(binaryMode)
+        return _receiveBinaryFrom(receptorEmitting);
+
       char *buf = new char [max_size_message];
 #if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
       numbytes=(int)recv(receptor_list[receptorEmitting].socketFileDescriptorReceptor, buf, max_size_message, 0);
@@ -799,5 +865,635 @@ int vpNetwork::_receiveRequestOnceFrom(const unsigned int &receptorEmitting)
   return numbytes;
 }
 
+/*!
+  Choose how the requests are sent and received. The same mode has to be used
+  by the emitter and the receptor, and it should be changed before exchanging
+  any request.
+
+  In binary mode, the requests are framed by their size instead of
+  separators, their parameters are sent and received without intermediate
+  copy (see vpRequest::addParameterBuffer() and
+  vpRequest::getReceptionBuffer()), and the connections are multiplexed with
+  epoll on Linux. The Nagle algorithm is disabled on the sockets to reduce the
+  latency of small requests.
+
+  \sa vpNetwork::getBinaryMode()
+
+  \param binary : True to use the binary framing, false to use the text
+  framing (default).
+*/
+void vpNetwork::setBinaryMode(const bool &binary)
+{
+  binaryMode = binary;
+  binaryCompleted.clear();
+  for(unsigned int i = 0 ; i < receptor_list.size() ; i++)
+  {
+    bool registered = receptor_list[i].binary.registered;
+    receptor_list[i].binary = vpBinaryReception();
+    receptor_list[i].binary.registered = registered;
+  }
+}
+
+/*!
+  Send a request with the binary framing. The header, the sizes and the
+  parameters are gathered by sendmsg() from where they are stored.
+
+  \param req : Request to send.
+  \param dest : Index of the receptor receiving the request.
+
+  \return The number of bytes that have been sent, -1 if an error occured.
+*/
+int vpNetwork::_sendBinaryRequestTo(vpRequest &req, const unsigned int &dest)
+{
+  vpReceptor &receptor = receptor_list[dest];
+  _configureBinary(receptor);
+
+  std::string id = req.getId();
+  unsigned int nbParams = req.size();
+
+  std::vector<char> meta(vpBinaryHeaderSize + id.size() + 8*nbParams);
+  vp_writeUInt32(&meta[0], vpBinaryMagic);
+  vp_writeUInt32(&meta[4], nbParams);
+  vp_writeUInt32(&meta[8], (unsigned int)id.size());
+  if(id.size() != 0)
+    memcpy(&meta[vpBinaryHeaderSize], id.data(), id.size());
+
+  std::vector<const char *> parts(1, &meta[0]);
+  std::vector<size_t> partSizes(1, meta.size());
+  char *sizes = &meta[vpBinaryHeaderSize + id.size()];
+  for(unsigned int i = 0 ; i < nbParams ; i++)
+  {
+    size_t sizeOfParam;
+    const char *param = req.getParameterData(i, sizeOfParam);
+    vp_writeUInt32(sizes + 8*i, (unsigned int)((sizeOfParam >> 16) >> 16));
+    vp_writeUInt32(sizes + 8*i + 4, (unsigned int)(sizeOfParam & 0xffffffff));
+    if(sizeOfParam != 0){
+      parts.push_back(param);
+      partSizes.push_back(sizeOfParam);
+    }
+  }
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+  int flags = 0;
+#if defined(__linux__)
+  flags = MSG_NOSIGNAL; // Only for Linux
+#endif
+
+  size_t part = 0, offset = 0, sent = 0;
+  while(part < parts.size())
+  {
+    struct iovec iov[vpBinaryMaxIovec];
+    int iovcnt = 0;
+    for(size_t k = part ; k < parts.size() && iovcnt < vpBinaryMaxIovec ; k++, iovcnt++){
+      size_t skip = (k == part) ? offset : 0;
+      iov[iovcnt].iov_base = (void*)(parts[k] + skip);
+      iov[iovcnt].iov_len = partSizes[k] - skip;
+    }
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iovcnt;
+
+    ssize_t numbytes = sendmsg(receptor.socketFileDescriptorReceptor, &msg, flags);
+    if(numbytes < 0){
+      if(errno == EINTR)
+        continue;
+      if(verboseMode)
+        vpERROR_TRACE( "Cannot send the binary request" );
+      return -1;
+    }
+
+    sent += (size_t)numbytes;
+    size_t left = (size_t)numbytes;
+    while(left > 0){
+      size_t remaining = partSizes[part] - offset;
+      if(left >= remaining){
+        left -= remaining;
+        part++;
+        offset = 0;
+      }
+      else{
+        offset += left;
+        left = 0;
+      }
+    }
+  }
+
+  return (int)sent;
+#else
+  std::string message;
+  for(size_t k = 0 ; k < parts.size() ; k++)
+    message.append(parts[k], partSizes[k]);
+
+  size_t sent = 0;
+  while(sent < message.size()){
+    int numbytes = send((unsigned)receptor.socketFileDescriptorReceptor, message.c_str() + sent, (int)(message.size() - sent), 0);
+    if(numbytes < 0){
+      if(verboseMode)
+        vpERROR_TRACE( "Cannot send the binary request" );
+      return -1;
+    }
+    sent += (size_t)numbytes;
+  }
+
+  return (int)sent;
+#endif
+}
+
+/*!
+  Prepare a connection for the binary framing: allocate its reception buffer
+  and disable the Nagle algorithm.
+
+  \param receptor : Connection to configure.
+*/
+void vpNetwork::_configureBinary(vpReceptor &receptor)
+{
+  if(receptor.binary.configured)
+    return;
+
+  int noDelay = 1;
+  setsockopt(receptor.socketFileDescriptorReceptor, IPPROTO_TCP, TCP_NODELAY, (const char*)&noDelay, sizeof(noDelay));
+  receptor.binary.buffer.resize(vpBinaryBufferSize);
+  receptor.binary.configured = true;
+}
+
+/*!
+  Tell if a request is being filled directly by another connection than the
+  given one, or if it has been received and waits to be handled.
+
+  \param request : Index of the request.
+  \param receptor : Connection asking for the request.
+
+  \return True if the request can not be used by the connection yet.
+*/
+bool vpNetwork::_isRequestBusy(const int &request, const vpReceptor &receptor) const
+{
+  if(_isRequestQueued(request))
+    return true;
+
+  for(unsigned int i = 0 ; i < receptor_list.size() ; i++)
+  {
+    const vpBinaryReception &other = receptor_list[i].binary;
+    if(&receptor_list[i] != &receptor && other.stage == vpBinaryReception::WAIT_PARAMS
+       && other.direct && other.request == request)
+      return true;
+  }
+
+  return false;
+}
+
+/*!
+  Tell if a request has been received and waits to be handled by
+  _handleFirstRequest().
+
+  \param request : Index of the request.
+
+  \return True if the request is queued.
+*/
+bool vpNetwork::_isRequestQueued(const int &request) const
+{
+  return std::find(binaryCompleted.begin(), binaryCompleted.end(), request) != binaryCompleted.end();
+}
+
+/*!
+  Finish the reception of a binary message. The staged parameters are given
+  to the request and the request is queued for the handling.
+
+  \param receptor : Connection that received the message.
+*/
+void vpNetwork::_completeBinary(vpReceptor &receptor)
+{
+  vpBinaryReception &state = receptor.binary;
+
+  if(state.request >= 0 && (unsigned)state.request < request_list.size())
+  {
+    if(!state.direct)
+    {
+      if(_isRequestBusy(state.request, receptor)){
+        state.stage = vpBinaryReception::WAIT_REQUEST;
+        return;
+      }
+
+      vpRequest *req = request_list[(unsigned)state.request];
+      req->clear();
+      for(unsigned int i = 0 ; i < state.sizes.size() ; i++){
+        char *dst = (char*)req->getReceptionBuffer(i, state.sizes[i]);
+        if(state.sizes[i] != 0 && dst != NULL)
+          memcpy(dst, &state.staged[i][0], state.sizes[i]);
+      }
+      state.staged.clear();
+    }
+
+    binaryCompleted.push_back(state.request);
+    state.completed = state.request;
+  }
+
+  state.stage = vpBinaryReception::WAIT_HEADER;
+  state.headerReceived = 0;
+  state.request = -1;
+  state.direct = false;
+  state.target = NULL;
+}
+
+/*!
+  Consume the bytes of the reception buffer of a connection, and move its
+  state forward. The parameters are copied where getReceptionBuffer() asks,
+  or staged when the request is being filled by another connection. The
+  parsing stops after a complete message as long as its request is not
+  handled: the next message of the connection could be for the same request.
 
+  \param receptor : Connection to process.
+*/
+void vpNetwork::_parseBinary(vpReceptor &receptor)
+{
+  vpBinaryReception &state = receptor.binary;
 
+  for(;;)
+  {
+    size_t available = state.end - state.begin;
+
+    if(state.stage == vpBinaryReception::WAIT_HEADER)
+    {
+      if(state.completed >= 0){
+        if(_isRequestQueued(state.completed))
+          return;
+        state.completed = -1;
+      }
+
+      size_t n = (std::min)(available, (size_t)vpBinaryHeaderSize - state.headerReceived);
+      if(n != 0){
+        memcpy(state.header + state.headerReceived, &state.buffer[state.begin], n);
+        state.begin += n;
+        state.headerReceived += n;
+      }
+      if(state.headerReceived < vpBinaryHeaderSize)
+        return;
+
+      unsigned int magic = vp_readUInt32(state.header);
+      unsigned int nbParams = vp_readUInt32(state.header + 4);
+      unsigned int idSize = vp_readUInt32(state.header + 8);
+      if(magic != vpBinaryMagic || nbParams > vpBinaryMaxParams || idSize > vpBinaryMaxIdSize){
+        state.stage = vpBinaryReception::CORRUPTED;
+        return;
+      }
+
+      state.sizes.resize(nbParams);
+      state.meta.resize(idSize + 8*nbParams);
+      state.metaReceived = 0;
+      state.stage = vpBinaryReception::WAIT_META;
+    }
+    else if(state.stage == vpBinaryReception::WAIT_META)
+    {
+      size_t n = (std::min)(available, state.meta.size() - state.metaReceived);
+      if(n != 0){
+        memcpy(&state.meta[state.metaReceived], &state.buffer[state.begin], n);
+        state.begin += n;
+        state.metaReceived += n;
+      }
+      if(state.metaReceived < state.meta.size())
+        return;
+
+      size_t idSize = state.meta.size() - 8*state.sizes.size();
+      std::string id = (idSize != 0) ? std::string(&state.meta[0], idSize) : std::string();
+      // The parameters are allocated with the announced sizes: bound them before
+      size_t total = 0;
+      for(unsigned int i = 0 ; i < state.sizes.size() ; i++){
+        unsigned int high = vp_readUInt32(&state.meta[idSize + 8*i]);
+        unsigned int low = vp_readUInt32(&state.meta[idSize + 8*i + 4]);
+        if(sizeof(size_t) < 8 && high != 0){
+          state.stage = vpBinaryReception::CORRUPTED;
+          return;
+        }
+        state.sizes[i] = (((size_t)high << 16) << 16) | (size_t)low;
+        if(state.sizes[i] > max_size_binary_message - total){
+          if(verboseMode)
+            vpTRACE("The received message exceeds the maximum size");
+          state.stage = vpBinaryReception::CORRUPTED;
+          return;
+        }
+        total += state.sizes[i];
+      }
+
+      state.request = -1;
+      for(unsigned int i = 0 ; i < request_list.size() ; i++){
+        if(id == request_list[i]->getId()){
+          state.request = (int)i;
+          break;
+        }
+      }
+
+      if(state.request < 0){
+        if(verboseMode)
+          vpTRACE("No request corresponds to the received message");
+        state.direct = false;
+      }
+      else{
+        state.direct = !_isRequestBusy(state.request, receptor);
+        if(state.direct)
+          request_list[(unsigned)state.request]->clear();
+        else
+          state.staged.assign(state.sizes.size(), std::vector<char>());
+      }
+
+      state.param = 0;
+      state.paramReceived = 0;
+      state.paramStarted = false;
+      state.stage = vpBinaryReception::WAIT_PARAMS;
+    }
+    else if(state.stage == vpBinaryReception::WAIT_PARAMS)
+    {
+      if(state.param == state.sizes.size()){
+        _completeBinary(receptor);
+        if(state.stage != vpBinaryReception::WAIT_HEADER)
+          return;
+        continue;
+      }
+
+      size_t sizeOfParam = state.sizes[state.param];
+      if(!state.paramStarted){
+        state.target = NULL;
+        if(state.direct){
+          state.target = (char*)request_list[(unsigned)state.request]->getReceptionBuffer(state.param, sizeOfParam);
+          if(state.target == NULL && sizeOfParam != 0){
+            if(verboseMode)
+              vpTRACE("No reception buffer for the parameter");
+            state.stage = vpBinaryReception::CORRUPTED;
+            return;
+          }
+        }
+        else if(state.request >= 0){
+          state.staged[state.param].resize(sizeOfParam);
+          if(sizeOfParam != 0)
+            state.target = &state.staged[state.param][0];
+        }
+        state.paramStarted = true;
+      }
+
+      size_t n = (std::min)(available, sizeOfParam - state.paramReceived);
+      if(n != 0){
+        if(state.target != NULL)
+          memcpy(state.target + state.paramReceived, &state.buffer[state.begin], n);
+        state.begin += n;
+        state.paramReceived += n;
+      }
+      if(state.paramReceived < sizeOfParam)
+        return;
+
+      state.param++;
+      state.paramReceived = 0;
+      state.paramStarted = false;
+    }
+    else
+      return;
+  }
+}
+
+/*!
+  Receive the available bytes of a connection in binary mode. The end of the
+  current parameter is received directly in its final location and the bytes
+  that follow it in the reception buffer of the connection, with a single
+  recvmsg() call.
+
+  \param receptorEmitting : Index of the receptor emitting the message.
+
+  \return The number of bytes received, -1 if an error occured.
+*/
+int vpNetwork::_receiveBinaryFrom(const unsigned int &receptorEmitting)
+{
+  vpReceptor &receptor = receptor_list[receptorEmitting];
+  vpBinaryReception &state = receptor.binary;
+  _configureBinary(receptor);
+
+  _resumeBinary(receptor);
+  if(state.stage == vpBinaryReception::CORRUPTED){
+    _disconnectBinary(receptorEmitting);
+    return -1;
+  }
+
+  // The buffered messages wait for the handling of the previous request, the
+  // next bytes are left in the socket
+  if(state.stage == vpBinaryReception::WAIT_REQUEST || state.begin != state.end)
+    return 0;
+  state.begin = state.end = 0;
+
+  char *target = NULL;
+  size_t remaining = 0;
+  if(state.stage == vpBinaryReception::WAIT_PARAMS && state.paramStarted && state.target != NULL){
+    target = state.target + state.paramReceived;
+    remaining = state.sizes[state.param] - state.paramReceived;
+  }
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+  struct iovec iov[2];
+  int iovcnt = 0;
+  if(remaining != 0){
+    iov[iovcnt].iov_base = (void*)target;
+    iov[iovcnt].iov_len = remaining;
+    iovcnt++;
+  }
+  iov[iovcnt].iov_base = (void*)&state.buffer[0];
+  iov[iovcnt].iov_len = state.buffer.size();
+  iovcnt++;
+
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = iov;
+  msg.msg_iovlen = iovcnt;
+
+  int numbytes = (int)recvmsg(receptor.socketFileDescriptorReceptor, &msg, 0);
+#else
+  int numbytes;
+  if(remaining != 0)
+    numbytes = recv((unsigned int)receptor.socketFileDescriptorReceptor, target, (int)remaining, 0);
+  else
+    numbytes = recv((unsigned int)receptor.socketFileDescriptorReceptor, &state.buffer[0], (int)state.buffer.size(), 0);
+#endif
+
+  if(numbytes <= 0)
+  {
+    std::cout << "Disconnected : " << inet_ntoa(receptor.receptorAddress.sin_addr) << std::endl;
+    receptor_list.erase(receptor_list.begin()+(int)receptorEmitting);
+    return numbytes;
+  }
+
+  size_t received = (size_t)numbytes;
+  if(remaining != 0){
+    size_t direct = (std::min)(received, remaining);
+    state.paramReceived += direct;
+    received -= direct;
+  }
+  state.end = received;
+
+  _parseBinary(receptor);
+
+  if(state.stage == vpBinaryReception::CORRUPTED)
+  {
+    _disconnectBinary(receptorEmitting);
+    return -1;
+  }
+
+  return numbytes;
+}
+
+/*!
+  Continue the parsing of the bytes already buffered for a connection, once
+  the request that stopped it has been handled.
+
+  \param receptor : Connection to process.
+*/
+void vpNetwork::_resumeBinary(vpReceptor &receptor)
+{
+  vpBinaryReception &state = receptor.binary;
+
+  if(state.stage == vpBinaryReception::WAIT_REQUEST){
+    _completeBinary(receptor);
+    if(state.stage == vpBinaryReception::WAIT_REQUEST)
+      return;
+  }
+  _parseBinary(receptor);
+}
+
+/*!
+  Close a connection that sent an incorrect binary message.
+
+  \param receptorEmitting : Index of the receptor emitting the message.
+*/
+void vpNetwork::_disconnectBinary(const unsigned int &receptorEmitting)
+{
+  vpReceptor &receptor = receptor_list[receptorEmitting];
+  if(verboseMode)
+    vpTRACE("Incorrect message");
+  std::cout << "Disconnected : " << inet_ntoa(receptor.receptorAddress.sin_addr) << std::endl;
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+  shutdown( receptor.socketFileDescriptorReceptor, SHUT_RDWR );
+#else // _WIN32
+  shutdown( receptor.socketFileDescriptorReceptor, SD_BOTH );
+#endif
+  receptor_list.erase(receptor_list.begin()+(int)receptorEmitting);
+}
+
+/*!
+  Receive the available bytes of all the connections that are ready, in
+  binary mode. The connections are watched with epoll on Linux, and with
+  select() otherwise.
+
+  \return The number of bytes received, -1 if an error occured.
+*/
+int vpNetwork::_receiveBinaryOnce()
+{
+  // Messages that were waiting for the handling of a request
+  for(unsigned int i = 0 ; i < receptor_list.size() ; ){
+    _resumeBinary(receptor_list[i]);
+    if(receptor_list[i].binary.stage == vpBinaryReception::CORRUPTED)
+      _disconnectBinary(i);
+    else
+      i++;
+  }
+  if(receptor_list.size() == 0)
+    return -1;
+
+  // Do not wait for new bytes when a request is already waiting to be handled
+  long timeoutSec = tv_sec, timeoutUSec = tv_usec;
+  if(binaryCompleted.size() != 0)
+    timeoutSec = timeoutUSec = 0;
+
+  std::vector<int> ready;
+
+#if defined(__linux__)
+  if(epollFileDescriptor == -1){
+    epollFileDescriptor = epoll_create(1);
+    if(epollFileDescriptor == -1){
+      if(verboseMode)
+        vpERROR_TRACE( "Epoll error" );
+      return -1;
+    }
+  }
+
+  // Register the new connections and forget the removed ones
+  std::vector<int> sockets(receptor_list.size());
+  for(unsigned int i = 0 ; i < receptor_list.size() ; i++){
+    if(!receptor_list[i].binary.registered){
+      struct epoll_event event;
+      memset(&event, 0, sizeof(event));
+      event.events = EPOLLIN;
+      event.data.fd = receptor_list[i].socketFileDescriptorReceptor;
+      if(epoll_ctl(epollFileDescriptor, EPOLL_CTL_ADD, event.data.fd, &event) == -1 && errno != EEXIST){
+        if(verboseMode)
+          vpERROR_TRACE( "Epoll error" );
+        return -1;
+      }
+      receptor_list[i].binary.registered = true;
+    }
+    sockets[i] = receptor_list[i].socketFileDescriptorReceptor;
+  }
+  std::sort(sockets.begin(), sockets.end());
+  if(sockets != epollSockets){
+    std::vector<int> removed(epollSockets.size());
+    removed.erase(std::set_difference(epollSockets.begin(), epollSockets.end(), sockets.begin(), sockets.end(),
+                                      removed.begin()), removed.end());
+    for(unsigned int i = 0 ; i < removed.size() ; i++){
+      struct epoll_event event; // Ignored, but required by old kernels
+      epoll_ctl(epollFileDescriptor, EPOLL_CTL_DEL, removed[i], &event);
+    }
+    epollSockets = sockets;
+  }
+
+  struct epoll_event events[vpBinaryMaxIovec];
+  int value = epoll_wait(epollFileDescriptor, events, vpBinaryMaxIovec, (int)(timeoutSec*1000 + timeoutUSec/1000));
+  if(value == -1){
+    if(errno == EINTR)
+      return 0;
+    if(verboseMode)
+      vpERROR_TRACE( "Epoll error" );
+    return -1;
+  }
+
+  for(int k = 0 ; k < value ; k++)
+    ready.push_back(events[k].data.fd);
+#else
+  tv.tv_sec = timeoutSec;
+#if TARGET_OS_IPHONE
+  tv.tv_usec = (int)timeoutUSec;
+#else
+  tv.tv_usec = timeoutUSec;
+#endif
+
+  FD_ZERO(&readFileDescriptor);
+
+  for(unsigned int i=0; i<receptor_list.size(); i++){
+    if(i == 0)
+      socketMax = receptor_list[i].socketFileDescriptorReceptor;
+
+    FD_SET((unsigned)receptor_list[i].socketFileDescriptorReceptor,&readFileDescriptor);
+    if(socketMax < receptor_list[i].socketFileDescriptorReceptor) socketMax = receptor_list[i].socketFileDescriptorReceptor;
+  }
+
+  int value = select((int)socketMax+1,&readFileDescriptor,NULL,NULL,&tv);
+  if(value == -1){
+    if(verboseMode)
+      vpERROR_TRACE( "Select error" );
+    return -1;
+  }
+
+  for(unsigned int i=0; i<receptor_list.size(); i++){
+    if(FD_ISSET((unsigned int)receptor_list[i].socketFileDescriptorReceptor,&readFileDescriptor))
+      ready.push_back((int)receptor_list[i].socketFileDescriptorReceptor);
+  }
+#endif
+
+  // Receptors may be removed on disconnection, so they are looked for by socket
+  int numbytes = 0;
+  for(unsigned int k = 0 ; k < ready.size() ; k++){
+    for(unsigned int i = 0 ; i < receptor_list.size() ; i++){
+      if((int)receptor_list[i].socketFileDescriptorReceptor == ready[k]){
+        int received = _receiveBinaryFrom(i);
+        if(received > 0)
+          numbytes += received;
+        break;
+      }
+    }
+  }
+
+  return numbytes;
+}
@@ -39,7 +39,7 @@
 #include <visp3/core/vpRequest.h>
 
 vpRequest::vpRequest()
-  : request_id(""), listOfParams()
+  : request_id(""), listOfParams(), listOfBuffers()
 {}
 
 vpRequest::~vpRequest()
@@ -83,3 +83,75 @@ void vpRequest::addParameter(std::vector< std::string > &listOfparams)
   for(unsigned int i = 0; i < listOfparams.size() ; i++)
     listOfparams.push_back(listOfparams[i]);
 }
+
+/*!
+  Add a buffer as parameter of the request, without copying it.
+
+  Contrary to addParameterObject(), only the address and the size of the
+  buffer are kept: the buffer must stay valid and unchanged until the request
+  is sent. In binary mode (see vpNetwork::setBinaryMode()) the buffer is read
+  directly by the system call that sends the message. The corresponding
+  element of operator[]() is an empty string.
+
+  \sa vpRequest::addParameterObject(), vpRequest::getParameterData()
+
+  \param params : Address of the buffer.
+  \param sizeOfObject : Size of the buffer in bytes.
+*/
+void vpRequest::addParameterBuffer(const void *params, const size_t &sizeOfObject)
+{
+  // Parameters pushed directly in listOfParams by a child class are not buffers
+  listOfBuffers.resize(listOfParams.size(), std::make_pair((const char *)NULL, (size_t)0));
+
+  listOfParams.push_back(std::string());
+  listOfBuffers.push_back(std::make_pair((const char *)params, sizeOfObject));
+}
+
+/*!
+  Get the bytes of a parameter, either added as a string or as a buffer.
+
+  \sa vpRequest::addParameterBuffer()
+
+  \param i : Index of the parameter.
+  \param sizeOfObject : Size of the parameter in bytes.
+
+  \return Address of the first byte of the parameter.
+*/
+const char *vpRequest::getParameterData(const unsigned int &i, size_t &sizeOfObject) const
+{
+  if(i < listOfBuffers.size() && listOfBuffers[i].first != NULL){
+    sizeOfObject = listOfBuffers[i].second;
+    return listOfBuffers[i].first;
+  }
+
+  sizeOfObject = listOfParams[i].size();
+  return listOfParams[i].data();
+}
+
+/*!
+  Give the memory where a parameter is received in binary mode (see
+  vpNetwork::setBinaryMode()). The parameters are received in increasing
+  order, so the previous ones are available when this function is called.
+
+  The default implementation stores the parameter in a string, as in text
+  mode. It can be redefined to receive the parameter directly in its final
+  location, for instance the bitmap of an image after having resized it from
+  the previous parameters. In that case, the corresponding element of
+  operator[]() stays empty.
+
+  \param index : Index of the parameter.
+  \param sizeOfObject : Size of the parameter in bytes.
+
+  \return Address of a memory of at least sizeOfObject bytes.
+*/
+void *vpRequest::getReceptionBuffer(const unsigned int &index, const size_t &sizeOfObject)
+{
+  if(listOfParams.size() <= index)
+    listOfParams.resize(index+1);
+
+  listOfParams[index].resize(sizeOfObject);
+  if(sizeOfObject == 0)
+    return NULL;
+
+  return (void*)&listOfParams[index][0];
+}
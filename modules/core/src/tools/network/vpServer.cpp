@@ -214,7 +214,15 @@ bool vpServer::checkForConnections()
   socketMax = emitter.socketFileDescriptorEmitter;
   FD_SET((unsigned)emitter.socketFileDescriptorEmitter,&readFileDescriptor);
 
-  for(unsigned int i=0; i<receptor_list.size(); i++){
+  // In binary mode the deconnections are detected by the reception of the
+  // requests, so that the clients that stream data are not polled twice, and
+  // the waiting is left to the reception
+  if(binaryMode){
+    tv.tv_sec = 0;
+    tv.tv_usec = 0;
+  }
+
+  for(unsigned int i=0; i<receptor_list.size() && !binaryMode; i++){
     FD_SET((unsigned)receptor_list[i].socketFileDescriptorReceptor,&readFileDescriptor);
 
     if(i == 0)
@@ -0,0 +1,784 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Publish images and poses to local processes through shared memory.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpSharedMemoryChannel.h>
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#endif
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpTime.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+const unsigned int vpChannelMagic = 0x76705348; // "vpSH"
+const unsigned int vpChannelVersion = 1;
+const size_t vpChannelAlignment = 64;            // Cache line
+const unsigned int vpChannelMaxAttempts = 1000;  // Reads restarted before giving up
+
+// Header at the beginning of the segment
+struct vpChannelHeader {
+  volatile unsigned int magic;
+  unsigned int version;
+  unsigned int nbSlots;
+  unsigned int capacity;
+  volatile unsigned int lastSequence;
+  volatile unsigned int futex;
+  volatile unsigned int closed;
+};
+
+// Header of a slot, followed by the data
+struct vpChannelSlot {
+  volatile unsigned int lock;
+  unsigned int sequence;
+  unsigned int type;
+  unsigned int rows;
+  unsigned int cols;
+  unsigned int size;
+  double timestamp;
+};
+
+size_t vp_align(size_t size) { return (size + vpChannelAlignment - 1) / vpChannelAlignment * vpChannelAlignment; }
+
+size_t vp_slotStride(unsigned int capacity) { return vp_align(sizeof(vpChannelSlot)) + vp_align(capacity); }
+
+size_t vp_segmentSize(unsigned int nbSlots, unsigned int capacity)
+{
+  return vp_align(sizeof(vpChannelHeader)) + nbSlots * vp_slotStride(capacity);
+}
+
+// Loads never write in the segment, that is mapped read only by the subscribers.
+// The barrier keeps the reads that follow the load after it.
+inline unsigned int vp_load(const volatile unsigned int *ptr)
+{
+  unsigned int value = *ptr;
+  __sync_synchronize();
+  return value;
+}
+
+// Load that validates the reads done before it: the barrier keeps them before
+// the load, so that a slot overwritten while it was read is detected
+inline unsigned int vp_validate(const volatile unsigned int *ptr)
+{
+  __sync_synchronize();
+  return *ptr;
+}
+
+inline void vp_store(volatile unsigned int *ptr, unsigned int value)
+{
+  __sync_synchronize();
+  *ptr = value;
+  __sync_synchronize();
+}
+
+void vp_futexWake(volatile unsigned int *ptr)
+{
+#if defined(__linux__)
+  syscall(SYS_futex, ptr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#else
+  (void)ptr;
+#endif
+}
+
+// Sleep while *ptr is equal to value, at most timeoutMs if positive
+void vp_futexWait(const volatile unsigned int *ptr, unsigned int value, double timeoutMs)
+{
+#if defined(__linux__)
+  struct timespec timeout;
+  if (timeoutMs >= 0) {
+    timeout.tv_sec = (time_t)(timeoutMs / 1000.);
+    timeout.tv_nsec = (long)((timeoutMs - timeout.tv_sec * 1000.) * 1e6);
+  }
+  syscall(SYS_futex, ptr, FUTEX_WAIT, value, timeoutMs >= 0 ? &timeout : NULL, NULL, 0);
+#else
+  (void)ptr;
+  (void)value;
+  vpTime::sleepMs(timeoutMs >= 0 && timeoutMs < 0.1 ? timeoutMs : 0.1);
+#endif
+}
+
+std::string vp_shmName(const std::string &name) { return (!name.empty() && name[0] == '/') ? name : "/" + name; }
+}
+#endif
+
+/*!
+  Default constructor. The channel has to be created with create() or opened
+  with open().
+*/
+vpSharedMemoryChannel::vpSharedMemoryChannel()
+  : m_name(), m_fd(-1), m_segment(NULL), m_segmentSize(0), m_publisher(false), m_mode(LATEST_FRAME),
+    m_type(NO_DATA), m_sequence(0), m_timestamp(0), m_dropped(0), m_firstSequence(0), m_pendingTimestamp(0),
+    m_pendingType(NO_DATA), m_viewSequence(0), m_viewLock(0)
+{
+}
+
+/*!
+  Destructor that calls close().
+*/
+vpSharedMemoryChannel::~vpSharedMemoryChannel() { close(); }
+
+/*!
+  Create the channel as publisher. A segment with the same name left by a
+  previous publisher is removed first; the subscribers attached to it have
+  to open() the channel again.
+
+  \param name : Name of the channel, shared by the publisher and the
+  subscribers. The segment appears as /dev/shm/<name> on Linux.
+  \param maxDataSize : Size in bytes of the biggest data that will be
+  published, for instance I.getSize() for a vpImage<unsigned char> and
+  I.getSize()*sizeof(vpRGBa) for a vpImage<vpRGBa>.
+  \param nbSlots : Number of frames in the ring.
+
+  \exception vpException::badValue : nbSlots is 0.
+  \exception vpException::ioError : The segment cannot be created.
+*/
+void vpSharedMemoryChannel::create(const std::string &name, unsigned int maxDataSize, unsigned int nbSlots)
+{
+  close();
+
+  if (nbSlots == 0) {
+    throw(vpException(vpException::badValue, "A shared memory channel needs at least one slot"));
+  }
+
+  std::string shmName = vp_shmName(name);
+  shm_unlink(shmName.c_str());
+
+  int fd = shm_open(shmName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0666);
+  if (fd == -1) {
+    throw(vpException(vpException::ioError, "Cannot create the shared memory %s: %s", shmName.c_str(),
+                      strerror(errno)));
+  }
+
+  size_t size = vp_segmentSize(nbSlots, maxDataSize);
+  void *segment = MAP_FAILED;
+  if (ftruncate(fd, (off_t)size) == 0) {
+    segment = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  if (segment == MAP_FAILED) {
+    int error = errno;
+    ::close(fd);
+    shm_unlink(shmName.c_str());
+    throw(vpException(vpException::ioError, "Cannot allocate %lu bytes of shared memory for %s: %s",
+                      (unsigned long)size, shmName.c_str(), strerror(error)));
+  }
+
+  // The segment is filled with zeros by ftruncate(), the magic number is written last
+  vpChannelHeader *header = (vpChannelHeader *)segment;
+  header->version = vpChannelVersion;
+  header->nbSlots = nbSlots;
+  header->capacity = maxDataSize;
+  vp_store(&header->magic, vpChannelMagic);
+
+  m_name = shmName;
+  m_fd = fd;
+  m_segment = (unsigned char *)segment;
+  m_segmentSize = size;
+  m_publisher = true;
+  m_type = NO_DATA;
+  m_sequence = 0;
+  m_timestamp = 0;
+  m_dropped = 0;
+}
+
+/*!
+  Open the channel as subscriber. The segment is mapped read only.
+
+  \param name : Name given to create() by the publisher.
+
+  \exception vpException::ioError : The segment does not exist.
+  \exception vpException::badValue : The segment is not a channel, or its
+  publisher has not finished to create it yet.
+*/
+void vpSharedMemoryChannel::open(const std::string &name)
+{
+  close();
+
+  std::string shmName = vp_shmName(name);
+  int fd = shm_open(shmName.c_str(), O_RDONLY, 0);
+  if (fd == -1) {
+    throw(vpException(vpException::ioError, "Cannot open the shared memory %s: %s", shmName.c_str(),
+                      strerror(errno)));
+  }
+
+  struct stat st;
+  void *segment = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(vpChannelHeader)) {
+    segment = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  if (segment == MAP_FAILED) {
+    ::close(fd);
+    throw(vpException(vpException::ioError, "Cannot map the shared memory %s", shmName.c_str()));
+  }
+
+  const vpChannelHeader *header = (const vpChannelHeader *)segment;
+  if (vp_load(&header->magic) != vpChannelMagic || header->version != vpChannelVersion || header->nbSlots == 0 ||
+      vp_segmentSize(header->nbSlots, header->capacity) != (size_t)st.st_size) {
+    munmap(segment, (size_t)st.st_size);
+    ::close(fd);
+    throw(vpException(vpException::badValue, "The shared memory %s is not a ready channel", shmName.c_str()));
+  }
+
+  m_name = shmName;
+  m_fd = fd;
+  m_segment = (unsigned char *)segment;
+  m_segmentSize = (size_t)st.st_size;
+  m_publisher = false;
+  m_type = NO_DATA;
+  m_sequence = 0;
+  m_timestamp = 0;
+  m_dropped = 0;
+  // The frames published from now on, or the last one already published, are
+  // expected to be read; the ones skipped before the first read are dropped
+  m_firstSequence = vp_load(&header->lastSequence);
+  if (m_firstSequence == 0)
+    m_firstSequence = 1;
+  m_viewSequence = 0;
+}
+
+/*!
+  Close the channel. The publisher removes the segment name and wakes up the
+  subscribers, whose wait() returns false; the subscribers keep their mapping
+  until they close the channel.
+*/
+void vpSharedMemoryChannel::close()
+{
+  if (m_segment == NULL)
+    return;
+
+  if (m_publisher) {
+    vpChannelHeader *header = (vpChannelHeader *)m_segment;
+    vp_store(&header->closed, 1);
+    __sync_fetch_and_add(&header->futex, 1);
+    vp_futexWake(&header->futex);
+    shm_unlink(m_name.c_str());
+  }
+
+  munmap(m_segment, m_segmentSize);
+  ::close(m_fd);
+  m_segment = NULL;
+  m_segmentSize = 0;
+  m_fd = -1;
+  m_publisher = false;
+}
+
+/*!
+  Return the size in bytes of the biggest data that can be published.
+*/
+unsigned int vpSharedMemoryChannel::getCapacity() const
+{
+  return m_segment ? ((const vpChannelHeader *)m_segment)->capacity : 0;
+}
+
+/*!
+  Return the sequence number of the last published frame, 0 if none.
+*/
+unsigned int vpSharedMemoryChannel::getLastSequence() const
+{
+  return m_segment ? vp_load(&((const vpChannelHeader *)m_segment)->lastSequence) : 0;
+}
+
+/*!
+  Return the number of frames in the ring.
+*/
+unsigned int vpSharedMemoryChannel::getNbSlots() const
+{
+  return m_segment ? ((const vpChannelHeader *)m_segment)->nbSlots : 0;
+}
+
+/*!
+  Return true if the publisher closed the channel. The frames still in the
+  ring can be read, but no new frame will be published.
+*/
+bool vpSharedMemoryChannel::isPublisherClosed() const
+{
+  return m_segment ? vp_load(&((const vpChannelHeader *)m_segment)->closed) != 0 : true;
+}
+
+/*!
+  Publish an image.
+
+  \param I : Image to copy in the next slot.
+  \param timestamp : Timestamp in ms of the image. When negative,
+  vpTime::measureTimeMs() is used.
+
+  \return The sequence number of the frame.
+
+  \exception vpException::notInitialized : The channel was not created by create().
+  \exception vpException::dimensionError : The image is bigger than the capacity of the channel.
+*/
+unsigned int vpSharedMemoryChannel::publish(const vpImage<unsigned char> &I, double timestamp)
+{
+  return publishData(IMAGE_UCHAR, I.getHeight(), I.getWidth(), I.bitmap, I.getSize(), timestamp);
+}
+
+/*!
+  Publish a color image.
+
+  \param I : Image to copy in the next slot.
+  \param timestamp : Timestamp in ms of the image. When negative,
+  vpTime::measureTimeMs() is used.
+
+  \return The sequence number of the frame.
+
+  \exception vpException::notInitialized : The channel was not created by create().
+  \exception vpException::dimensionError : The image is bigger than the capacity of the channel.
+*/
+unsigned int vpSharedMemoryChannel::publish(const vpImage<vpRGBa> &I, double timestamp)
+{
+  return publishData(IMAGE_RGBA, I.getHeight(), I.getWidth(), I.bitmap, I.getSize() * sizeof(vpRGBa), timestamp);
+}
+
+/*!
+  Publish a homogeneous matrix, for instance a pose.
+
+  \param M : Matrix to copy in the next slot.
+  \param timestamp : Timestamp in ms of the matrix. When negative,
+  vpTime::measureTimeMs() is used.
+
+  \return The sequence number of the frame.
+
+  \exception vpException::notInitialized : The channel was not created by create().
+  \exception vpException::dimensionError : The capacity of the channel is smaller than 16 doubles.
+*/
+unsigned int vpSharedMemoryChannel::publish(const vpHomogeneousMatrix &M, double timestamp)
+{
+  return publishData(HOMOGENEOUS_MATRIX, 4, 4, M.data, 16 * sizeof(double), timestamp);
+}
+
+/*!
+  Publish a column vector, for instance a velocity.
+
+  \param v : Vector to copy in the next slot.
+  \param timestamp : Timestamp in ms of the vector. When negative,
+  vpTime::measureTimeMs() is used.
+
+  \return The sequence number of the frame.
+
+  \exception vpException::notInitialized : The channel was not created by create().
+  \exception vpException::dimensionError : The vector is bigger than the capacity of the channel.
+*/
+unsigned int vpSharedMemoryChannel::publish(const vpColVector &v, double timestamp)
+{
+  return publishData(COLUMN_VECTOR, v.getRows(), 1, v.data, v.getRows() * sizeof(double), timestamp);
+}
+
+/*!
+  Copy the data in the next slot of the ring, under its sequence lock, then
+  make it the last frame and wake up the waiting subscribers.
+*/
+unsigned int vpSharedMemoryChannel::publishData(vpDataType type, unsigned int rows, unsigned int cols,
+                                                const void *data, size_t size, double timestamp)
+{
+  if (m_segment == NULL || !m_publisher) {
+    throw(vpException(vpException::notInitialized, "The shared memory channel is not created"));
+  }
+
+  vpChannelHeader *header = (vpChannelHeader *)m_segment;
+  if (size > header->capacity) {
+    throw(vpException(vpException::dimensionError, "Cannot publish %lu bytes in the shared memory channel %s of %u bytes",
+                      (unsigned long)size, m_name.c_str(), header->capacity));
+  }
+
+  if (timestamp < 0)
+    timestamp = vpTime::measureTimeMs();
+
+  unsigned int sequence = m_sequence + 1;
+  if (sequence == 0) // 0 means no frame
+    sequence = 1;
+
+  vpChannelSlot *slot = (vpChannelSlot *)(m_segment + vp_align(sizeof(vpChannelHeader)) +
+                                          (sequence % header->nbSlots) * vp_slotStride(header->capacity));
+  unsigned int lock = slot->lock;
+  vp_store(&slot->lock, lock + 1); // Odd: the readers of this slot will retry
+
+  slot->sequence = sequence;
+  slot->type = (unsigned int)type;
+  slot->rows = rows;
+  slot->cols = cols;
+  slot->size = (unsigned int)size;
+  slot->timestamp = timestamp;
+  if (size != 0)
+    memcpy((unsigned char *)slot + vp_align(sizeof(vpChannelSlot)), data, size);
+
+  vp_store(&slot->lock, lock + 2);
+  vp_store(&header->lastSequence, sequence);
+
+  __sync_fetch_and_add(&header->futex, 1);
+  vp_futexWake(&header->futex);
+
+  m_type = type;
+  m_sequence = sequence;
+  m_timestamp = timestamp;
+
+  return sequence;
+}
+
+/*!
+  Wait for a frame that was not read yet.
+
+  \param timeoutMs : Maximal waiting time in ms, or a negative value to wait
+  without limit.
+
+  \return true if a new frame can be read, false on timeout or when the
+  publisher closed the channel.
+
+  \exception vpException::notInitialized : The channel was not opened by open().
+*/
+bool vpSharedMemoryChannel::wait(double timeoutMs)
+{
+  if (m_segment == NULL || m_publisher) {
+    throw(vpException(vpException::notInitialized, "The shared memory channel is not opened"));
+  }
+
+  const vpChannelHeader *header = (const vpChannelHeader *)m_segment;
+  double t0 = vpTime::measureTimeMs();
+  for (;;) {
+    // Read the futex before the sequence so that a publication in between is not missed
+    unsigned int futex = vp_load(&header->futex);
+    unsigned int last = vp_load(&header->lastSequence);
+    if (last != 0 && last != m_sequence)
+      return true;
+    if (vp_load(&header->closed))
+      return false;
+
+    double remaining = -1;
+    if (timeoutMs >= 0) {
+      remaining = timeoutMs - (vpTime::measureTimeMs() - t0);
+      if (remaining <= 0)
+        return false;
+    }
+    vp_futexWait(&header->futex, futex, remaining);
+  }
+}
+
+/*!
+  Find the slot of the next frame to read according to the read mode, and
+  check that its header describes data of the requested type.
+
+  \return The address of the data in the slot, or NULL when there is no new
+  frame. The data has to be validated by endRead() once used.
+*/
+const unsigned char *vpSharedMemoryChannel::beginRead(vpDataType type, unsigned int elementSize, unsigned int &rows,
+                                                      unsigned int &cols, unsigned int &sequence, unsigned int &lock)
+{
+  if (m_segment == NULL || m_publisher) {
+    throw(vpException(vpException::notInitialized, "The shared memory channel is not opened"));
+  }
+
+  const vpChannelHeader *header = (const vpChannelHeader *)m_segment;
+  for (unsigned int attempt = 0; attempt < vpChannelMaxAttempts; attempt++) {
+    unsigned int last = vp_load(&header->lastSequence);
+    if (last == 0 || last == m_sequence)
+      return NULL;
+
+    sequence = last;
+    if (m_mode == EVERY_FRAME && m_sequence != 0) {
+      sequence = m_sequence + 1;
+      if (sequence == 0)
+        sequence = 1;
+      if (last - sequence >= header->nbSlots) // Overwritten, start at the oldest frame of the ring
+        sequence = last - header->nbSlots + 1;
+    }
+
+    const vpChannelSlot *slot = (const vpChannelSlot *)(m_segment + vp_align(sizeof(vpChannelHeader)) +
+                                                        (sequence % header->nbSlots) * vp_slotStride(header->capacity));
+    lock = vp_load(&slot->lock);
+    if ((lock & 1) != 0 || slot->sequence != sequence)
+      continue; // Being written, the next attempt looks for a more recent frame
+
+    unsigned int slotType = slot->type;
+    rows = slot->rows;
+    cols = slot->cols;
+    size_t size = slot->size;
+    m_pendingTimestamp = slot->timestamp;
+    m_pendingType = (vpDataType)slotType;
+
+    if (slotType == (unsigned int)type && size <= header->capacity && (size_t)rows * cols * elementSize == size)
+      return (const unsigned char *)slot + vp_align(sizeof(vpChannelSlot));
+
+    // Either a torn read or a frame of another type
+    if (vp_validate(&slot->lock) == lock && slotType != (unsigned int)type) {
+      throw(vpException(vpException::badValue, "The frame %u of the shared memory channel %s is not of the requested type",
+                        sequence, m_name.c_str()));
+    }
+  }
+
+  return NULL;
+}
+
+/*!
+  Check that the slot was not overwritten while its data was used, and in
+  that case make it the last frame read.
+
+  \return true if the data read since beginRead() is valid.
+*/
+bool vpSharedMemoryChannel::endRead(unsigned int sequence, unsigned int lock)
+{
+  const vpChannelHeader *header = (const vpChannelHeader *)m_segment;
+  const vpChannelSlot *slot = (const vpChannelSlot *)(m_segment + vp_align(sizeof(vpChannelHeader)) +
+                                                      (sequence % header->nbSlots) * vp_slotStride(header->capacity));
+  if (vp_validate(&slot->lock) != lock)
+    return false;
+
+  if (m_sequence != 0)
+    m_dropped += sequence - m_sequence - 1;
+  else if (sequence > m_firstSequence)
+    m_dropped += sequence - m_firstSequence;
+  m_sequence = sequence;
+  m_timestamp = m_pendingTimestamp;
+  m_type = m_pendingType;
+
+  return true;
+}
+
+/*!
+  Copy the next frame in an image, according to the read mode.
+
+  \param I : Image resized to the size of the frame.
+
+  \return true if a new frame was read, false if there is no new frame.
+
+  \exception vpException::notInitialized : The channel was not opened by open().
+  \exception vpException::badValue : The frame is not a vpImage<unsigned char>.
+*/
+bool vpSharedMemoryChannel::read(vpImage<unsigned char> &I)
+{
+  for (unsigned int attempt = 0; attempt < vpChannelMaxAttempts; attempt++) {
+    unsigned int rows, cols, sequence, lock;
+    const unsigned char *data = beginRead(IMAGE_UCHAR, sizeof(unsigned char), rows, cols, sequence, lock);
+    if (data == NULL)
+      return false;
+
+    I.resize(rows, cols);
+    memcpy(I.bitmap, data, I.getSize());
+    if (endRead(sequence, lock))
+      return true;
+  }
+
+  return false;
+}
+
+/*!
+  Copy the next frame in a color image, according to the read mode.
+
+  \param I : Image resized to the size of the frame.
+
+  \return true if a new frame was read, false if there is no new frame.
+
+  \exception vpException::notInitialized : The channel was not opened by open().
+  \exception vpException::badValue : The frame is not a vpImage<vpRGBa>.
+*/
+bool vpSharedMemoryChannel::read(vpImage<vpRGBa> &I)
+{
+  for (unsigned int attempt = 0; attempt < vpChannelMaxAttempts; attempt++) {
+    unsigned int rows, cols, sequence, lock;
+    const unsigned char *data = beginRead(IMAGE_RGBA, sizeof(vpRGBa), rows, cols, sequence, lock);
+    if (data == NULL)
+      return false;
+
+    I.resize(rows, cols);
+    memcpy((unsigned char *)I.bitmap, data, I.getSize() * sizeof(vpRGBa));
+    if (endRead(sequence, lock))
+      return true;
+  }
+
+  return false;
+}
+
+/*!
+  Copy the next frame in a homogeneous matrix, according to the read mode.
+
+  \param M : Matrix to update.
+
+  \return true if a new frame was read, false if there is no new frame.
+
+  \exception vpException::notInitialized : The channel was not opened by open().
+  \exception vpException::badValue : The frame is not a vpHomogeneousMatrix.
+*/
+bool vpSharedMemoryChannel::read(vpHomogeneousMatrix &M)
+{
+  for (unsigned int attempt = 0; attempt < vpChannelMaxAttempts; attempt++) {
+    unsigned int rows, cols, sequence, lock;
+    const unsigned char *data = beginRead(HOMOGENEOUS_MATRIX, sizeof(double), rows, cols, sequence, lock);
+    if (data == NULL)
+      return false;
+
+    if (rows != 4 || cols != 4)
+      continue;
+
+    double buffer[16];
+    memcpy(buffer, data, sizeof(buffer));
+    if (endRead(sequence, lock)) {
+      memcpy(M.data, buffer, sizeof(buffer));
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/*!
+  Copy the next frame in a column vector, according to the read mode.
+
+  \param v : Vector resized to the size of the frame.
+
+  \return true if a new frame was read, false if there is no new frame.
+
+  \exception vpException::notInitialized : The channel was not opened by open().
+  \exception vpException::badValue : The frame is not a vpColVector.
+*/
+bool vpSharedMemoryChannel::read(vpColVector &v)
+{
+  for (unsigned int attempt = 0; attempt < vpChannelMaxAttempts; attempt++) {
+    unsigned int rows, cols, sequence, lock;
+    const unsigned char *data = beginRead(COLUMN_VECTOR, sizeof(double), rows, cols, sequence, lock);
+    if (data == NULL)
+      return false;
+
+    if (cols != 1)
+      continue;
+
+    v.resize(rows, false);
+    if (rows != 0)
+      memcpy(v.data, data, rows * sizeof(double));
+    if (endRead(sequence, lock))
+      return true;
+  }
+
+  return false;
+}
+
+/*!
+  Make an image point to the next frame in the shared segment, according to
+  the read mode, without copy.
+
+  The view is valid until the publisher reuses the slot: check
+  isViewValid() after having used it. The segment is mapped read only, the
+  view must not be modified. A later resize of the image allocates its own
+  bitmap.
+
+  \param I : Image that becomes a view of the frame.
+
+  \return true if a new frame is viewed, false if there is no new frame.
+
+  \exception vpException::notInitialized : The channel was not opened by open().
+  \exception vpException::badValue : The frame is not a vpImage<unsigned char>.
+*/
+bool vpSharedMemoryChannel::getView(vpImage<unsigned char> &I)
+{
+  for (unsigned int attempt = 0; attempt < vpChannelMaxAttempts; attempt++) {
+    unsigned int rows, cols, sequence, lock;
+    const unsigned char *data = beginRead(IMAGE_UCHAR, sizeof(unsigned char), rows, cols, sequence, lock);
+    if (data == NULL)
+      return false;
+
+    I.initView(const_cast<unsigned char *>(data), rows, cols);
+    if (endRead(sequence, lock)) {
+      m_viewSequence = sequence;
+      m_viewLock = lock;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/*!
+  Make a color image point to the next frame in the shared segment,
+  according to the read mode, without copy.
+
+  \sa getView(vpImage<unsigned char> &)
+
+  \param I : Image that becomes a view of the frame.
+
+  \return true if a new frame is viewed, false if there is no new frame.
+
+  \exception vpException::notInitialized : The channel was not opened by open().
+  \exception vpException::badValue : The frame is not a vpImage<vpRGBa>.
+*/
+bool vpSharedMemoryChannel::getView(vpImage<vpRGBa> &I)
+{
+  for (unsigned int attempt = 0; attempt < vpChannelMaxAttempts; attempt++) {
+    unsigned int rows, cols, sequence, lock;
+    const unsigned char *data = beginRead(IMAGE_RGBA, sizeof(vpRGBa), rows, cols, sequence, lock);
+    if (data == NULL)
+      return false;
+
+    I.initView((vpRGBa *)const_cast<unsigned char *>(data), rows, cols);
+    if (endRead(sequence, lock)) {
+      m_viewSequence = sequence;
+      m_viewLock = lock;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/*!
+  Tell if the frame given by the last getView() is still in its slot.
+
+  \return false if the publisher started to overwrite the frame, or if no
+  view was given.
+*/
+bool vpSharedMemoryChannel::isViewValid() const
+{
+  if (m_segment == NULL || m_publisher || m_viewSequence == 0)
+    return false;
+
+  const vpChannelHeader *header = (const vpChannelHeader *)m_segment;
+  const vpChannelSlot *slot = (const vpChannelSlot *)(m_segment + vp_align(sizeof(vpChannelHeader)) +
+                                                      (m_viewSequence % header->nbSlots) * vp_slotStride(header->capacity));
+  return vp_validate(&slot->lock) == m_viewLock;
+}
+
+#elif !defined(VISP_BUILD_SHARED_LIBS)
+// Work arround to avoid warning: libvisp_core.a(vpSharedMemoryChannel.cpp.o) has no symbols
+void dummy_vpSharedMemoryChannel(){};
+#endif
@@ -0,0 +1,154 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Projection of a set of 3D points with vpMeterPixelConversion::projectPoints().
+ *
+ *****************************************************************************/
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpMeterPixelConversion.h>
+#include <visp3/core/vpPoint.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+
+/*!
+  \example testProjectPoints.cpp
+
+  \brief Check that vpMeterPixelConversion::projectPoints() and convertPoints() give
+  the same coordinates as vpPoint::track() and vpMeterPixelConversion::convertPoint()
+  with and without distortion, and compare their computation times.
+*/
+
+namespace {
+  bool check(const std::string &name, const std::vector<double> &u, const std::vector<double> &v,
+             const std::vector<double> &u_ref, const std::vector<double> &v_ref) {
+    if (u.size() != u_ref.size() || v.size() != v_ref.size()) {
+      std::cerr << name << ": wrong number of points" << std::endl;
+      return false;
+    }
+    double err = 0;
+    for (size_t i = 0; i < u.size(); i++) {
+      err = std::max(err, std::max(std::fabs(u[i] - u_ref[i]), std::fabs(v[i] - v_ref[i])));
+    }
+    if (err > 1e-9) {
+      std::cerr << name << ": error " << err << std::endl;
+      return false;
+    }
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+    const unsigned int n = 100001;
+    vpUniRand rng(42);
+    std::vector<double> oX(n), oY(n), oZ(n);
+    for (unsigned int i = 0; i < n; i++) {
+      oX[i] = rng() - 0.5;
+      oY[i] = rng() - 0.5;
+      oZ[i] = 0.2 * rng();
+    }
+    const vpHomogeneousMatrix cMo(0.1, -0.05, 1.5, vpMath::rad(10), vpMath::rad(-20), vpMath::rad(30));
+
+    vpCameraParameters cams[2];
+    cams[0].initPersProjWithoutDistortion(600, 610, 320, 240);
+    cams[1].initPersProjWithDistortion(600, 610, 320, 240, -0.2, 0.21);
+
+    // Reference with a vpPoint per point
+    std::vector<double> x_ref(n), y_ref(n);
+    double t_ref = vpTime::measureTimeMs();
+    vpPoint P;
+    for (unsigned int i = 0; i < n; i++) {
+      P.setWorldCoordinates(oX[i], oY[i], oZ[i]);
+      P.track(cMo);
+      x_ref[i] = P.get_x();
+      y_ref[i] = P.get_y();
+    }
+    t_ref = vpTime::measureTimeMs() - t_ref;
+
+    std::vector<double> x, y;
+    double t = vpTime::measureTimeMs();
+    vpMeterPixelConversion::projectPoints(cMo, oX, oY, oZ, x, y);
+    t = vpTime::measureTimeMs() - t;
+    if (!check("Normalized coordinates", x, y, x_ref, y_ref)) {
+      return EXIT_FAILURE;
+    }
+    std::cout << "Projection of " << n << " points: " << t_ref << " ms with vpPoint::track(), " << t
+              << " ms with vpMeterPixelConversion::projectPoints()" << std::endl;
+
+    vpMeterPixelConversion::projectPoints(cMo, oX, oY, oZ, x, y, 4);
+    if (!check("Normalized coordinates with 4 threads", x, y, x_ref, y_ref)) {
+      return EXIT_FAILURE;
+    }
+
+    for (unsigned int k = 0; k < 2; k++) {
+      std::vector<double> u_ref(n), v_ref(n), u, v;
+      for (unsigned int i = 0; i < n; i++) {
+        vpMeterPixelConversion::convertPoint(cams[k], x_ref[i], y_ref[i], u_ref[i], v_ref[i]);
+      }
+      const std::string name = (k == 0) ? "Without distortion" : "With distortion";
+
+      vpMeterPixelConversion::convertPoints(cams[k], x_ref, y_ref, u, v);
+      if (!check(name + ", convertPoints()", u, v, u_ref, v_ref)) {
+        return EXIT_FAILURE;
+      }
+      vpMeterPixelConversion::projectPoints(cams[k], cMo, oX, oY, oZ, u, v);
+      if (!check(name + ", projectPoints()", u, v, u_ref, v_ref)) {
+        return EXIT_FAILURE;
+      }
+      vpMeterPixelConversion::projectPoints(cams[k], cMo, oX, oY, oZ, u, v, 4);
+      if (!check(name + ", projectPoints() with 4 threads", u, v, u_ref, v_ref)) {
+        return EXIT_FAILURE;
+      }
+    }
+
+    // The coordinates must have the same size
+    try {
+      oZ.pop_back();
+      vpMeterPixelConversion::projectPoints(cMo, oX, oY, oZ, x, y);
+      std::cerr << "Coordinates of different sizes should throw an exception" << std::endl;
+      return EXIT_FAILURE;
+    } catch(const vpException &e) {
+      std::cout << "Expected exception: " << e.getStringMessage() << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+  } catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,186 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test vpImagePyramid.
+ *
+ *****************************************************************************/
+
+#include <iostream>
+#include <visp3/core/vpImageFilter.h>
+#include <visp3/core/vpImagePyramid.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+
+/*!
+  \example testImagePyramid.cpp
+
+  \brief Test vpImagePyramid against vpImageFilter::getGaussXPyramidal() / getGaussYPyramidal()
+  and a naive subsampling.
+*/
+
+namespace {
+  bool sameImage(const vpImage<unsigned char> &I1, const vpImage<unsigned char> &I2) {
+    if (I1.getHeight() != I2.getHeight() || I1.getWidth() != I2.getWidth()) {
+      std::cerr << "Size mismatch: " << I1.getHeight() << "x" << I1.getWidth() << " vs "
+                << I2.getHeight() << "x" << I2.getWidth() << std::endl;
+      return false;
+    }
+
+    for (unsigned int i = 0; i < I1.getSize(); i++) {
+      if (I1.bitmap[i] != I2.bitmap[i]) {
+        std::cerr << "Pixel mismatch at " << i << ": " << (int) I1.bitmap[i] << " vs " << (int) I2.bitmap[i] << std::endl;
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool checkPyramid(const vpImage<unsigned char> &I, const unsigned int nbLevels, const unsigned int nbThreads) {
+    vpImagePyramid gaussian(nbLevels), decimation(nbLevels, vpImagePyramid::DECIMATION);
+    gaussian.setNbThreads(nbThreads);
+    decimation.setNbThreads(nbThreads);
+
+    // Build twice to check that the buffers are reused
+    gaussian.build(I);
+    decimation.build(I);
+    std::vector<unsigned char *> bitmaps;
+    for (unsigned int level = 1; level < nbLevels; level++) {
+      bitmaps.push_back(gaussian[level].bitmap);
+    }
+    gaussian.build(I);
+    decimation.build(I);
+
+    vpImage<unsigned char> Iref = I, Itmp, Idown;
+    for (unsigned int level = 1; level < nbLevels; level++) {
+      if (gaussian[level].bitmap != bitmaps[level-1]) {
+        std::cerr << "Level " << level << " was reallocated" << std::endl;
+        return false;
+      }
+
+      vpImageFilter::getGaussXPyramidal(Iref, Itmp);
+      vpImageFilter::getGaussYPyramidal(Itmp, Iref);
+      if (!sameImage(gaussian[level], Iref)) {
+        std::cerr << "Gaussian level " << level << " differs from the reference" << std::endl;
+        return false;
+      }
+
+      unsigned int scale = 1 << level;
+      Idown.resize(I.getHeight() / scale, I.getWidth() / scale);
+      for (unsigned int i = 0; i < Idown.getHeight(); i++) {
+        for (unsigned int j = 0; j < Idown.getWidth(); j++) {
+          Idown[i][j] = I[i*scale][j*scale];
+        }
+      }
+      if (!sameImage(decimation[level], Idown)) {
+        std::cerr << "Decimation level " << level << " differs from the reference" << std::endl;
+        return false;
+      }
+    }
+
+    return &gaussian[0] == &I;
+  }
+}
+
+int main()
+{
+  try {
+    vpUniRand rng(17);
+    const unsigned int sizes[][2] = { {480, 640}, {481, 641}, {37, 53}, {100, 23}, {12, 12} };
+
+    for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+      vpImage<unsigned char> I(sizes[k][0], sizes[k][1]);
+      for (unsigned int i = 0; i < I.getSize(); i++) {
+        I.bitmap[i] = (unsigned char) (rng() * 256);
+      }
+
+      for (unsigned int nbThreads = 1; nbThreads <= 4; nbThreads *= 2) {
+        std::cout << "Check pyramid of a " << I.getHeight() << "x" << I.getWidth() << " image with "
+                  << nbThreads << " thread(s)" << std::endl;
+        if (!checkPyramid(I, 3, nbThreads)) {
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    // A copied pyramid does not depend on the image given to the original one
+    vpImagePyramid copy;
+    {
+      vpImage<unsigned char> I(48, 64);
+      for (unsigned int i = 0; i < I.getSize(); i++) {
+        I.bitmap[i] = (unsigned char) (rng() * 256);
+      }
+      vpImagePyramid original(2);
+      original.build(I);
+      copy = original;
+      if (&copy[0] == &I || !sameImage(copy[0], I) || !sameImage(copy[1], original[1])) {
+        std::cerr << "Wrong copy of the pyramid" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    if (copy[0].getWidth() != 64 || copy[1].getWidth() != 32) {
+      std::cerr << "The copied pyramid was released with the original one" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    vpImage<unsigned char> I(1080, 1920);
+    for (unsigned int i = 0; i < I.getSize(); i++) {
+      I.bitmap[i] = (unsigned char) (rng() * 256);
+    }
+
+    const int nbIterations = 20;
+    vpImage<unsigned char> I1, I2;
+    double t = vpTime::measureTimeMs();
+    for (int iter = 0; iter < nbIterations; iter++) {
+      vpImageFilter::getGaussXPyramidal(I, I1);
+      vpImageFilter::getGaussYPyramidal(I1, I2);
+      vpImageFilter::getGaussXPyramidal(I2, I1);
+      vpImageFilter::getGaussYPyramidal(I1, I2);
+    }
+    double t_ref = (vpTime::measureTimeMs() - t) / nbIterations;
+
+    vpImagePyramid pyramid(3);
+    t = vpTime::measureTimeMs();
+    for (int iter = 0; iter < nbIterations; iter++) {
+      pyramid.build(I);
+    }
+    double t_pyr = (vpTime::measureTimeMs() - t) / nbIterations;
+
+    std::cout << "Mean time for a 3 levels pyramid of a " << I.getHeight() << "x" << I.getWidth()
+              << " image: getGaussXPyramidal() + getGaussYPyramidal(): " << t_ref
+              << " ms ; vpImagePyramid::build(): " << t_pyr << " ms" << std::endl;
+
+    return EXIT_SUCCESS;
+  } catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,108 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test images pointing to an external array.
+ *
+ *****************************************************************************/
+
+#include <iostream>
+#include <visp3/core/vpImage.h>
+
+/*!
+  \example testImageView.cpp
+
+  \brief Test vpImage::initView(): the image uses the array of the caller without
+  copying nor freeing it, and an image built from an array with copyData=false
+  still takes its ownership.
+*/
+
+int main()
+{
+  try {
+    const unsigned int h = 4, w = 6;
+    unsigned char array[h * w];
+    for (unsigned int i = 0; i < h * w; i++) {
+      array[i] = (unsigned char) i;
+    }
+
+    {
+      vpImage<unsigned char> I;
+      I.initView(array, h, w);
+      if (I.bitmap != array || I.getHeight() != h || I.getWidth() != w || I[2][3] != 2 * w + 3) {
+        std::cerr << "The view does not point to the array" << std::endl;
+        return EXIT_FAILURE;
+      }
+      I[1][1] = 200;
+      if (array[w + 1] != 200) {
+        std::cerr << "The view does not write in the array" << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      // A copy of a view owns its pixels
+      vpImage<unsigned char> I_copy = I;
+      if (I_copy.bitmap == array || I_copy != I) {
+        std::cerr << "Wrong copy of a view" << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      // Resizing a view with the same size allocates a new bitmap
+      I.resize(h, w);
+      if (I.bitmap == array) {
+        std::cerr << "The array is reused after resize()" << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      I.initView(array, h, w);
+      I.init(h, w, 0);
+      if (I.bitmap == array || array[w + 1] != 200) {
+        std::cerr << "The array is modified by init()" << std::endl;
+        return EXIT_FAILURE;
+      }
+      I.initView(array, h, w);
+    }
+    // The array, which is on the stack, was not freed by the destruction of the view
+    array[0] = 1;
+
+    // With copyData=false the image takes the ownership of the array, as before
+    unsigned char *owned = new unsigned char[h * w];
+    vpImage<unsigned char> I_owner(owned, h, w, false);
+    if (I_owner.bitmap != owned) {
+      std::cerr << "The array is not used by the image" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cout << "vpImage::initView() is ok" << std::endl;
+    return EXIT_SUCCESS;
+  } catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,350 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test and benchmark the decompositions of small matrices.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testMatrixSmall.cpp
+
+  \brief Check the Cholesky, LDLT, LU, QR and SVD decompositions of small matrices
+  working on stack storage against the 3rd party backends, and compare their
+  computation times.
+*/
+
+#include <cmath>
+#include <iostream>
+#include <string>
+
+#include <visp3/core/vpColVector.h>
+#include <visp3/core/vpMatrix.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+
+namespace {
+  vpMatrix randomMatrix(vpUniRand &rng, const unsigned int rows, const unsigned int cols) {
+    vpMatrix A(rows, cols);
+    for (unsigned int i = 0; i < A.size(); i++) {
+      A.data[i] = 2 * rng() - 1;
+    }
+    return A;
+  }
+
+  //! Random symmetric positive definite matrix
+  vpMatrix randomSpdMatrix(vpUniRand &rng, const unsigned int n) {
+    vpMatrix A = randomMatrix(rng, n + 2, n);
+    return A.AtA();
+  }
+
+  //! Matrix of rank \e rank
+  vpMatrix randomRankDeficientMatrix(vpUniRand &rng, const unsigned int rows, const unsigned int cols,
+                                     const unsigned int rank) {
+    return randomMatrix(rng, rows, rank) * randomMatrix(rng, rank, cols);
+  }
+
+  double maxError(const vpMatrix &A, const vpMatrix &B) {
+    if (A.getRows() != B.getRows() || A.getCols() != B.getCols()) {
+      return 1e10;
+    }
+    double err = 0;
+    for (unsigned int i = 0; i < A.size(); i++) {
+      err = (std::max)(err, std::fabs(A.data[i] - B.data[i]));
+    }
+    return err;
+  }
+
+  double identityError(const vpMatrix &A) {
+    vpMatrix I;
+    I.eye(A.getRows());
+    return maxError(A, I);
+  }
+
+  bool check(const std::string &name, const double error, const double threshold) {
+    if (error > threshold) {
+      std::cerr << name << ": error " << error << " is over " << threshold << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  bool testInverse(vpUniRand &rng, const unsigned int n) {
+    vpMatrix A = randomMatrix(rng, n, n), S = randomSpdMatrix(rng, n);
+    vpMatrix D(n, n);
+    for (unsigned int i = 0; i < n; i++) {
+      D[i][i] = (i % 2) ? -1 : 1;
+    }
+    // Symmetric indefinite matrix
+    vpMatrix T = S * D * S;
+
+    return check("inverseByLUSmall()", identityError(A * A.inverseByLUSmall()), 1e-8) &&
+           check("inverseByQRSmall()", identityError(A * A.inverseByQRSmall()), 1e-8) &&
+           check("inverseByCholeskySmall()", identityError(S * S.inverseByCholeskySmall()), 1e-8) &&
+           check("inverseByLDLT() positive definite", identityError(S * S.inverseByLDLT()), 1e-8) &&
+           check("inverseByLDLT() indefinite", identityError(T * T.inverseByLDLT()), 1e-6);
+  }
+
+  bool testSvd(vpUniRand &rng, const unsigned int rows, const unsigned int cols, const unsigned int rank) {
+    vpMatrix A = randomRankDeficientMatrix(rng, rows, cols, rank), U = A, V;
+    vpColVector w;
+    U.svdSmall(w, V);
+
+    vpMatrix S;
+    S.diag(w);
+    for (unsigned int i = 1; i < w.size(); i++) {
+      if (w[i] > w[i-1]) {
+        std::cerr << "svdSmall(): the singular values are not sorted" << std::endl;
+        return false;
+      }
+    }
+
+    return check("svdSmall() reconstruction", maxError(U * S * V.t(), A), 1e-10) &&
+           check("svdSmall() U orthogonality", identityError(U.AtA()), 1e-10) &&
+           check("svdSmall() V orthogonality", identityError(V.AtA()), 1e-10);
+  }
+
+  bool testPseudoInverse(vpUniRand &rng, const unsigned int rows, const unsigned int cols, const unsigned int rank) {
+    vpMatrix A = randomRankDeficientMatrix(rng, rows, cols, rank);
+
+    // The kernel is only computed for matrices with few columns
+    const bool withKernel = (cols <= vpMatrix::smallMatrixMaxSize);
+    vpMatrix Ap, imA, imAt, kerAt;
+    vpColVector sv;
+    unsigned int r = withKernel ? A.pseudoInverseSmall(Ap, sv, 1e-6, imA, imAt, kerAt)
+                                : A.pseudoInverseSmall(Ap, sv, 1e-6, imA, imAt);
+    if (r != rank) {
+      std::cerr << "pseudoInverseSmall(): rank " << r << " instead of " << rank << std::endl;
+      return false;
+    }
+
+    // Moore-Penrose conditions
+    bool ok = check("pseudoInverseSmall() A A+ A = A", maxError(A * Ap * A, A), 1e-9) &&
+              check("pseudoInverseSmall() A+ A A+ = A+", maxError(Ap * A * Ap, Ap), 1e-9) &&
+              check("pseudoInverseSmall() A A+ symmetric", maxError(A * Ap, (A * Ap).t()), 1e-9) &&
+              check("pseudoInverseSmall() A+ A symmetric", maxError(Ap * A, (Ap * A).t()), 1e-9);
+    if (!ok) {
+      return false;
+    }
+
+    // Projectors on the images and the kernel
+    ok = check("pseudoInverseSmall() im(A)", maxError(imA * imA.t(), A * Ap), 1e-9) &&
+         check("pseudoInverseSmall() im(A^T)", maxError(imAt * imAt.t(), Ap * A), 1e-9);
+    if (!ok) {
+      return false;
+    }
+    if (withKernel) {
+      if (kerAt.getRows() != cols - rank || kerAt.getCols() != cols) {
+        std::cerr << "pseudoInverseSmall(): wrong kernel size" << std::endl;
+        return false;
+      }
+      if (rank < cols) {
+        vpMatrix I;
+        I.eye(cols);
+        ok = check("pseudoInverseSmall() ker(A)", maxError(kerAt.t() * kerAt, I - Ap * A), 1e-9) &&
+             check("pseudoInverseSmall() A ker(A)", maxError(A * kerAt.t(), vpMatrix(rows, cols - rank)), 1e-9);
+        if (!ok) {
+          return false;
+        }
+      }
+    }
+
+#if defined(VISP_HAVE_LAPACK)
+    vpMatrix Ap_ref;
+    vpColVector sv_ref;
+    A.pseudoInverseLapack(Ap_ref, sv_ref, 1e-6);
+    ok = check("pseudoInverseSmall() vs Lapack", maxError(Ap, Ap_ref), 1e-9) &&
+         check("pseudoInverseSmall() singular values vs Lapack", maxError(sv, sv_ref), 1e-9);
+#endif
+
+    return ok;
+  }
+
+  template <typename Function>
+  double benchmark(Function f, const vpMatrix &A, const unsigned int nbIterations) {
+    double t = vpTime::measureTimeMs();
+    for (unsigned int i = 0; i < nbIterations; i++) {
+      f(A);
+    }
+    return (vpTime::measureTimeMs() - t) * 1000 / nbIterations;
+  }
+
+  void luSmall(const vpMatrix &A) { A.inverseByLUSmall(); }
+  void choleskySmall(const vpMatrix &A) { A.inverseByCholeskySmall(); }
+  void ldlt(const vpMatrix &A) { A.inverseByLDLT(); }
+  void qrSmall(const vpMatrix &A) { A.inverseByQRSmall(); }
+  void svdSmall(const vpMatrix &A) { vpMatrix U = A, V; vpColVector w; U.svdSmall(w, V); }
+  void pinvSmall(const vpMatrix &A) { A.pseudoInverseSmall(); }
+#if defined(VISP_HAVE_LAPACK)
+  void luLapack(const vpMatrix &A) { A.inverseByLULapack(); }
+  void choleskyLapack(const vpMatrix &A) { A.inverseByCholeskyLapack(); }
+  void qrLapack(const vpMatrix &A) { A.inverseByQRLapack(); }
+  void svdLapack(const vpMatrix &A) { vpMatrix U = A, V; vpColVector w; U.svdLapack(w, V); }
+  void pinvLapack(const vpMatrix &A) { A.pseudoInverseLapack(); }
+#endif
+#if defined(VISP_HAVE_EIGEN3)
+  void luEigen3(const vpMatrix &A) { A.inverseByLUEigen3(); }
+  void svdEigen3(const vpMatrix &A) { vpMatrix U = A, V; vpColVector w; U.svdEigen3(w, V); }
+  void pinvEigen3(const vpMatrix &A) { A.pseudoInverseEigen3(); }
+#endif
+#if (VISP_HAVE_OPENCV_VERSION >= 0x020101)
+  void luOpenCV(const vpMatrix &A) { A.inverseByLUOpenCV(); }
+  void choleskyOpenCV(const vpMatrix &A) { A.inverseByCholeskyOpenCV(); }
+  void svdOpenCV(const vpMatrix &A) { vpMatrix U = A, V; vpColVector w; U.svdOpenCV(w, V); }
+  void pinvOpenCV(const vpMatrix &A) { A.pseudoInverseOpenCV(); }
+#endif
+#if defined(VISP_HAVE_GSL)
+  void luGsl(const vpMatrix &A) { A.inverseByLUGsl(); }
+  void svdGsl(const vpMatrix &A) { vpMatrix U = A, V; vpColVector w; U.svdGsl(w, V); }
+  void pinvGsl(const vpMatrix &A) { A.pseudoInverseGsl(); }
+#endif
+
+  void printTime(const std::string &name, const double t) {
+    std::cout << "  " << name << ": " << t << " us" << std::endl;
+  }
+}
+
+int main()
+{
+  try {
+    vpUniRand rng(4321);
+    for (unsigned int n = 1; n <= vpMatrix::smallMatrixMaxSize; n++) {
+      if (!testInverse(rng, n) || !testSvd(rng, n + 3, n, n) || !testSvd(rng, n, n, (n + 1) / 2) ||
+          !testPseudoInverse(rng, n + 5, n, n) || !testPseudoInverse(rng, n + 5, n, (n + 1) / 2) ||
+          !testPseudoInverse(rng, n, n + 5, n) || !testPseudoInverse(rng, n, n + 5, (n + 1) / 2)) {
+        std::cerr << "Failure for size " << n << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    std::cout << "The decompositions of small matrices are correct" << std::endl;
+
+    // The small matrices code is only used on request: the default inversions keep their 3rd party
+    vpMatrix A = randomMatrix(rng, 6, 6);
+#if defined(VISP_HAVE_LAPACK)
+    vpMatrix J = randomMatrix(rng, 8, 6);
+    vpMatrix U = J, V, U_ref = J, V_ref;
+    vpColVector w, w_ref;
+    U.svd(w, V);
+    U_ref.svdLapack(w_ref, V_ref);
+    if (maxError(A.inverseByLU(), A.inverseByLULapack()) > 0 || maxError(J.pseudoInverse(), J.pseudoInverseLapack()) > 0 ||
+        maxError(U, U_ref) > 0 || maxError(V, V_ref) > 0) {
+      std::cerr << "The small matrices are not dispatched to the default 3rd party" << std::endl;
+      return EXIT_FAILURE;
+    }
+#endif
+
+    // Errors
+    try {
+      randomMatrix(rng, 13, 13).inverseByLUSmall();
+      std::cerr << "A 13x13 matrix should not be accepted by inverseByLUSmall()" << std::endl;
+      return EXIT_FAILURE;
+    } catch(const vpException &e) {
+      std::cout << "Expected exception: " << e.getStringMessage() << std::endl;
+    }
+    try {
+      vpMatrix B(3, 3);
+      B[0][0] = 1; B[1][1] = -1; B[2][2] = 1;
+      B.inverseByCholeskySmall();
+      std::cerr << "An indefinite matrix should not be inverted by Cholesky" << std::endl;
+      return EXIT_FAILURE;
+    } catch(const vpException &e) {
+      std::cout << "Expected exception: " << e.getStringMessage() << std::endl;
+    }
+
+    // Computation times
+    const unsigned int nbIterations = 20000;
+    vpMatrix S = randomSpdMatrix(rng, 6), N = randomMatrix(rng, 40, 6);
+    std::cout << "6x6 inverse by LU" << std::endl;
+    printTime("Small", benchmark(luSmall, A, nbIterations));
+#if defined(VISP_HAVE_LAPACK)
+    printTime("Lapack", benchmark(luLapack, A, nbIterations));
+#endif
+#if defined(VISP_HAVE_EIGEN3)
+    printTime("Eigen3", benchmark(luEigen3, A, nbIterations));
+#endif
+#if (VISP_HAVE_OPENCV_VERSION >= 0x020101)
+    printTime("OpenCV", benchmark(luOpenCV, A, nbIterations));
+#endif
+#if defined(VISP_HAVE_GSL)
+    printTime("Gsl", benchmark(luGsl, A, nbIterations));
+#endif
+
+    std::cout << "6x6 inverse by Cholesky" << std::endl;
+    printTime("Small", benchmark(choleskySmall, S, nbIterations));
+    printTime("Small LDLT", benchmark(ldlt, S, nbIterations));
+#if defined(VISP_HAVE_LAPACK)
+    printTime("Lapack", benchmark(choleskyLapack, S, nbIterations));
+#endif
+#if (VISP_HAVE_OPENCV_VERSION >= 0x020101)
+    printTime("OpenCV", benchmark(choleskyOpenCV, S, nbIterations));
+#endif
+
+    std::cout << "6x6 inverse by QR" << std::endl;
+    printTime("Small", benchmark(qrSmall, A, nbIterations));
+#if defined(VISP_HAVE_LAPACK)
+    printTime("Lapack", benchmark(qrLapack, A, nbIterations));
+#endif
+
+    std::cout << "40x6 SVD" << std::endl;
+    printTime("Small", benchmark(svdSmall, N, nbIterations));
+#if defined(VISP_HAVE_LAPACK)
+    printTime("Lapack", benchmark(svdLapack, N, nbIterations));
+#endif
+#if defined(VISP_HAVE_EIGEN3)
+    printTime("Eigen3", benchmark(svdEigen3, N, nbIterations));
+#endif
+#if (VISP_HAVE_OPENCV_VERSION >= 0x020101)
+    printTime("OpenCV", benchmark(svdOpenCV, N, nbIterations));
+#endif
+#if defined(VISP_HAVE_GSL)
+    printTime("Gsl", benchmark(svdGsl, N, nbIterations));
+#endif
+
+    std::cout << "40x6 pseudo inverse" << std::endl;
+    printTime("Small", benchmark(pinvSmall, N, nbIterations));
+#if defined(VISP_HAVE_LAPACK)
+    printTime("Lapack", benchmark(pinvLapack, N, nbIterations));
+#endif
+#if defined(VISP_HAVE_EIGEN3)
+    printTime("Eigen3", benchmark(pinvEigen3, N, nbIterations));
+#endif
+#if (VISP_HAVE_OPENCV_VERSION >= 0x020101)
+    printTime("OpenCV", benchmark(pinvOpenCV, N, nbIterations));
+#endif
+#if defined(VISP_HAVE_GSL)
+    printTime("Gsl", benchmark(pinvGsl, N, nbIterations));
+#endif
+
+    return EXIT_SUCCESS;
+  } catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,562 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Throughput and latency of the text and binary TCP transports on localhost.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testNetworkBenchmark.cpp
+
+  Measure on localhost the throughput of clients streaming thumbnails and
+  poses to a server, and the round trip latency of a small request, with the
+  text and the binary framing of vpNetwork. It also checks that messages
+  received back to back are decoded one by one with their own content.
+*/
+
+#include <visp3/core/vpConfig.h>
+
+#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if !defined(_WIN32)
+#  include <arpa/inet.h>
+#  include <netinet/in.h>
+#  include <sys/socket.h>
+#  include <unistd.h>
+#endif
+
+#include <visp3/core/vpClient.h>
+#include <visp3/core/vpColVector.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpServer.h>
+#include <visp3/core/vpThread.h>
+#include <visp3/core/vpTime.h>
+
+namespace
+{
+// Thumbnail received directly in the image in binary mode
+class vpRequestThumbnail : public vpRequest
+{
+public:
+  vpRequestThumbnail(vpImage<unsigned char> *Im) : I(Im), h(0), w(0) { request_id = "thumbnail"; }
+
+  virtual void encode()
+  {
+    clear();
+    h = I->getHeight();
+    w = I->getWidth();
+    addParameterObject(&h);
+    addParameterObject(&w);
+    addParameterBuffer(I->bitmap, h * w);
+  }
+
+  virtual void *getReceptionBuffer(const unsigned int &index, const size_t &sizeOfObject)
+  {
+    if (index == 2 && listOfParams.size() == 2) {
+      memcpy((void *)&h, (void *)listOfParams[0].c_str(), sizeof(unsigned int));
+      memcpy((void *)&w, (void *)listOfParams[1].c_str(), sizeof(unsigned int));
+      if ((size_t)h * w == sizeOfObject) {
+        I->resize(h, w);
+        return (void *)I->bitmap;
+      }
+    }
+    return vpRequest::getReceptionBuffer(index, sizeOfObject);
+  }
+
+  virtual void decode()
+  {
+    if (listOfParams.size() == 3 && listOfParams[2].size() != 0) {
+      memcpy((void *)&h, (void *)listOfParams[0].c_str(), sizeof(unsigned int));
+      memcpy((void *)&w, (void *)listOfParams[1].c_str(), sizeof(unsigned int));
+      I->resize(h, w);
+      memcpy((void *)I->bitmap, (void *)listOfParams[2].c_str(), h * w);
+    }
+  }
+
+private:
+  vpImage<unsigned char> *I;
+  unsigned int h, w;
+};
+
+// Pose received directly in the vector in binary mode
+class vpRequestPose : public vpRequest
+{
+public:
+  vpRequestPose(const char *id, vpColVector *pose) : v(pose) { request_id = id; }
+
+  virtual void encode()
+  {
+    clear();
+    addParameterBuffer(v->data, v->size() * sizeof(double));
+  }
+
+  virtual void *getReceptionBuffer(const unsigned int &index, const size_t &sizeOfObject)
+  {
+    if (index == 0 && sizeOfObject == v->size() * sizeof(double))
+      return (void *)v->data;
+    return vpRequest::getReceptionBuffer(index, sizeOfObject);
+  }
+
+  virtual void decode()
+  {
+    if (listOfParams.size() == 1 && listOfParams[0].size() == v->size() * sizeof(double))
+      memcpy((void *)v->data, (void *)listOfParams[0].c_str(), v->size() * sizeof(double));
+  }
+
+private:
+  vpColVector *v;
+};
+
+struct vpBenchmark {
+  unsigned int port;
+  bool binary;
+  unsigned int nbFrames;
+  unsigned int width;
+  unsigned int height;
+  bool ping;
+  double meanRoundTrip;
+  bool failed;
+};
+
+// Frame index written in the first two pixels, pixel values stay below the
+// characters of the separators of the text framing
+void fillThumbnail(vpImage<unsigned char> &I, unsigned int frame)
+{
+  unsigned char *bitmap = I.bitmap;
+  for (unsigned int i = 0; i < I.getSize(); i++)
+    bitmap[i] = (unsigned char)((i + frame) % 32);
+  bitmap[0] = (unsigned char)(frame % 32);
+  bitmap[1] = (unsigned char)((frame / 32) % 32);
+}
+
+bool checkThumbnail(const vpImage<unsigned char> &I, unsigned int nbFrames)
+{
+  if (I.getSize() < 2)
+    return false;
+  unsigned int frame = I.bitmap[0] + 32 * I.bitmap[1];
+  if (frame >= nbFrames)
+    return false;
+  for (unsigned int i = 2; i < I.getSize(); i++)
+    if (I.bitmap[i] != (unsigned char)((i + frame) % 32))
+      return false;
+  return true;
+}
+
+vpThread::Return clientFunction(vpThread::Args args)
+{
+  vpBenchmark &bench = *((vpBenchmark *)args);
+
+  vpClient client;
+  client.setBinaryMode(bench.binary);
+  client.setTimeoutUSec(1000);
+  if (!client.connectToIP("127.0.0.1", bench.port)) {
+    bench.failed = true;
+    return 0;
+  }
+
+  vpColVector pose(6);
+  if (bench.ping) {
+    vpRequestPose reqPing("ping", &pose);
+    client.addDecodingRequest(&reqPing);
+
+    double total = 0;
+    for (unsigned int m = 0; m < bench.nbFrames && !bench.failed; m++) {
+      pose = 0;
+      pose[0] = m;
+      double t0 = vpTime::measureTimeMs();
+      client.sendAndEncodeRequest(reqPing);
+
+      pose[0] = -1;
+      while (pose[0] != m) {
+        if (client.getNumberOfServers() == 0 || vpTime::measureTimeMs() - t0 > 10000) {
+          bench.failed = true;
+          break;
+        }
+        client.receiveAndDecodeRequestOnce();
+      }
+      total += vpTime::measureTimeMs() - t0;
+    }
+    bench.meanRoundTrip = total / bench.nbFrames;
+  } else {
+    vpImage<unsigned char> I(bench.height, bench.width);
+    vpRequestThumbnail reqThumbnail(&I);
+    vpRequestPose reqPose("pose", &pose);
+
+    for (unsigned int f = 0; f < bench.nbFrames; f++) {
+      fillThumbnail(I, f);
+      for (unsigned int k = 0; k < pose.size(); k++)
+        pose[k] = 0.25 * (f + k);
+      if (client.sendAndEncodeRequest(reqThumbnail) <= 0 || client.sendAndEncodeRequest(reqPose) <= 0) {
+        bench.failed = true;
+        break;
+      }
+    }
+  }
+
+  client.stop();
+  return 0;
+}
+
+// Pose sent with a thumbnail, return the frame index or -1 if it is not consistent
+int checkPose(const vpColVector &pose, unsigned int nbFrames)
+{
+  int frame = (int)(pose[0] / 0.25);
+  if (frame < 0 || frame >= (int)nbFrames)
+    return -1;
+  for (unsigned int k = 0; k < pose.size(); k++)
+    if (pose[k] != 0.25 * (frame + k))
+      return -1;
+  return frame;
+}
+
+// Small thumbnails and poses are sent back to back, so that a single read
+// gets several messages for the same request. Every message has to be decoded
+// with its own content, and in the order of emission for one client.
+bool checkBackToBack(unsigned int port, bool binary, unsigned int nbClients, unsigned int nbFrames)
+{
+  vpServer serv((int)port);
+  serv.setBinaryMode(binary);
+  serv.setTimeoutUSec(1000);
+  serv.setMaxNumberOfClients(nbClients);
+  if (!serv.start())
+    return false;
+
+  vpImage<unsigned char> I;
+  vpColVector pose(6);
+  vpRequestThumbnail reqThumbnail(&I);
+  vpRequestPose reqPose("pose", &pose);
+  serv.addDecodingRequest(&reqThumbnail);
+  serv.addDecodingRequest(&reqPose);
+
+  std::vector<vpBenchmark> benchs(nbClients);
+  std::vector<vpThread *> clients(nbClients);
+  for (unsigned int c = 0; c < nbClients; c++) {
+    vpBenchmark bench = {port, binary, nbFrames, 16, 12, false, 0, false};
+    benchs[c] = bench;
+    clients[c] = new vpThread(clientFunction, (vpThread::Args)&benchs[c]);
+  }
+
+  unsigned int nbThumbnails = 0, nbPoses = 0;
+  bool ok = true;
+  double t0 = vpTime::measureTimeMs();
+  while (ok && (nbThumbnails < nbClients * nbFrames || nbPoses < nbClients * nbFrames)) {
+    serv.checkForConnections();
+    if (serv.getNumberOfClients() == 0 && nbThumbnails + nbPoses == 0) {
+      ok = (vpTime::measureTimeMs() - t0 < 20000);
+      continue;
+    }
+
+    int index = serv.receiveAndDecodeRequestOnce();
+    if (index != -1) {
+      if (serv.getRequestIdFromIndex(index) == "thumbnail") {
+        if (!checkThumbnail(I, nbFrames) || I.getWidth() != 16 || I.getHeight() != 12 ||
+            (nbClients == 1 && I.bitmap[0] + 32u * I.bitmap[1] != nbThumbnails)) {
+          std::cerr << "Wrong thumbnail " << nbThumbnails << " received" << std::endl;
+          ok = false;
+        }
+        nbThumbnails++;
+      } else {
+        int frame = checkPose(pose, nbFrames);
+        if (frame < 0 || (nbClients == 1 && frame != (int)nbPoses)) {
+          std::cerr << "Wrong pose " << nbPoses << " received: " << pose.t() << std::endl;
+          ok = false;
+        }
+        nbPoses++;
+      }
+    }
+    if (vpTime::measureTimeMs() - t0 > 60000) {
+      std::cerr << "Timeout: " << nbThumbnails << " thumbnails and " << nbPoses << " poses received" << std::endl;
+      ok = false;
+    }
+  }
+
+  for (unsigned int c = 0; c < nbClients; c++) {
+    delete clients[c];
+    ok = ok && !benchs[c].failed;
+  }
+
+  return ok;
+}
+
+#if !defined(_WIN32)
+void writeUInt32(std::vector<char> &message, unsigned int value)
+{
+  unsigned int v = htonl(value);
+  message.insert(message.end(), (const char *)&v, (const char *)&v + sizeof(v));
+}
+
+// A raw client announces a binary message with huge parameter sizes. The
+// server has to close the connection without allocating them.
+bool checkOversizedMessage(unsigned int port, const std::vector<unsigned long long> &sizes)
+{
+  vpServer serv((int)port);
+  serv.setBinaryMode(true);
+  serv.setTimeoutUSec(1000);
+  if (!serv.start())
+    return false;
+
+  vpImage<unsigned char> I;
+  vpRequestThumbnail reqThumbnail(&I);
+  serv.addDecodingRequest(&reqThumbnail);
+
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_port = htons((unsigned short)port);
+  address.sin_addr.s_addr = inet_addr("127.0.0.1");
+  if (fd < 0 || connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0) {
+    std::cerr << "Cannot connect the raw client" << std::endl;
+    return false;
+  }
+
+  const std::string id = "thumbnail";
+  std::vector<char> message;
+  writeUInt32(message, 0x7670424e); // Magic number
+  writeUInt32(message, (unsigned int)sizes.size());
+  writeUInt32(message, (unsigned int)id.size());
+  message.insert(message.end(), id.begin(), id.end());
+  for (size_t i = 0; i < sizes.size(); i++) {
+    writeUInt32(message, (unsigned int)(sizes[i] >> 32));
+    writeUInt32(message, (unsigned int)(sizes[i] & 0xffffffff));
+  }
+  bool ok = (send(fd, &message[0], message.size(), 0) == (ssize_t)message.size());
+
+  bool connected = false;
+  double t0 = vpTime::measureTimeMs();
+  while (ok) {
+    serv.checkForConnections();
+    if (serv.getNumberOfClients() != 0)
+      connected = true;
+    else if (connected)
+      break; // Closed by the server
+    if (vpTime::measureTimeMs() - t0 > 10000) {
+      std::cerr << "The connection of the oversized message was not closed" << std::endl;
+      ok = false;
+    }
+    if (connected && serv.receiveRequestOnce() != -1) {
+      std::cerr << "An oversized message was received" << std::endl;
+      ok = false;
+    }
+  }
+
+  close(fd);
+  return ok;
+}
+#endif
+
+// Stream thumbnails and poses from several clients, return the elapsed time in ms or -1
+double benchmarkThroughput(unsigned int port, bool binary, unsigned int nbClients, unsigned int nbFrames,
+                           unsigned int width, unsigned int height)
+{
+  vpServer serv((int)port);
+  serv.setBinaryMode(binary);
+  serv.setTimeoutUSec(1000);
+  serv.setMaxNumberOfClients(nbClients); // Size of the queue of pending connections
+  if (!serv.start())
+    return -1;
+
+  vpImage<unsigned char> I;
+  vpColVector pose(6);
+  vpRequestThumbnail reqThumbnail(&I);
+  vpRequestPose reqPose("pose", &pose);
+  serv.addDecodingRequest(&reqThumbnail);
+  serv.addDecodingRequest(&reqPose);
+
+  std::vector<vpBenchmark> benchs(nbClients);
+  std::vector<vpThread *> clients(nbClients);
+  for (unsigned int c = 0; c < nbClients; c++) {
+    vpBenchmark bench = {port, binary, nbFrames, width, height, false, 0, false};
+    benchs[c] = bench;
+    clients[c] = new vpThread(clientFunction, (vpThread::Args)&benchs[c]);
+  }
+
+  unsigned int nbThumbnails = 0, nbPoses = 0;
+  bool ok = true;
+  double t0 = vpTime::measureTimeMs(), tStart = -1;
+  while (ok && (nbThumbnails < nbClients * nbFrames || nbPoses < nbClients * nbFrames)) {
+    serv.checkForConnections();
+    if (serv.getNumberOfClients() == 0) {
+      ok = (vpTime::measureTimeMs() - t0 < 20000);
+      continue;
+    }
+    if (tStart < 0)
+      tStart = vpTime::measureTimeMs();
+
+    std::vector<int> res = serv.receiveAndDecodeRequest();
+    for (unsigned int i = 0; i < res.size(); i++) {
+      if (serv.getRequestIdFromIndex(res[i]) == "thumbnail") {
+        nbThumbnails++;
+        if (!checkThumbnail(I, nbFrames) || I.getWidth() != width || I.getHeight() != height) {
+          std::cerr << "Wrong thumbnail received" << std::endl;
+          ok = false;
+        }
+      } else
+        nbPoses++;
+    }
+    if (vpTime::measureTimeMs() - t0 > 60000) {
+      std::cerr << "Timeout: " << nbThumbnails << " thumbnails and " << nbPoses << " poses received" << std::endl;
+      ok = false;
+    }
+  }
+  double elapsed = vpTime::measureTimeMs() - tStart;
+
+  for (unsigned int c = 0; c < nbClients; c++) {
+    delete clients[c];
+    ok = ok && !benchs[c].failed;
+  }
+
+  return ok ? elapsed : -1;
+}
+
+// Ping-pong of a small request, return the mean round trip time in ms or -1
+double benchmarkLatency(unsigned int port, bool binary, unsigned int nbPings)
+{
+  vpServer serv((int)port);
+  serv.setBinaryMode(binary);
+  serv.setTimeoutUSec(1000);
+  if (!serv.start())
+    return -1;
+
+  vpColVector pose(6);
+  vpRequestPose reqPing("ping", &pose);
+  serv.addDecodingRequest(&reqPing);
+
+  vpBenchmark bench = {port, binary, nbPings, 0, 0, true, 0, false};
+  vpThread client(clientFunction, (vpThread::Args)&bench);
+
+  unsigned int nbReceived = 0;
+  double t0 = vpTime::measureTimeMs();
+  while (nbReceived < nbPings && vpTime::measureTimeMs() - t0 < 60000) {
+    serv.checkForConnections();
+    if (serv.getNumberOfClients() == 0)
+      continue;
+    if (serv.receiveAndDecodeRequestOnce() != -1) {
+      nbReceived++;
+      serv.sendAndEncodeRequestTo(reqPing, 0);
+    }
+  }
+  client.join();
+
+  return (nbReceived == nbPings && !bench.failed) ? bench.meanRoundTrip : -1;
+}
+}
+
+int main(int argc, const char **argv)
+{
+  unsigned int port = 35100;
+  unsigned int nbClients = 30;
+  unsigned int nbFrames = 200;
+  unsigned int nbPings = 500;
+  for (int i = 1; i < argc; i++) {
+    if (std::string(argv[i]) == "-p" && i + 1 < argc)
+      port = (unsigned int)atoi(argv[++i]);
+    else if (std::string(argv[i]) == "-c" && i + 1 < argc)
+      nbClients = (unsigned int)atoi(argv[++i]);
+    else if (std::string(argv[i]) == "-n" && i + 1 < argc)
+      nbFrames = (unsigned int)atoi(argv[++i]);
+    else if (std::string(argv[i]) == "--help" || std::string(argv[i]) == "-h") {
+      std::cout << "Usage: " << argv[0] << " [-p <first port>] [-c <clients>] [-n <frames per client>] [--help]"
+                << std::endl;
+      return EXIT_SUCCESS;
+    }
+  }
+
+  try {
+    const unsigned int width = 160, height = 120;
+    const double frameSize = width * height + 6 * sizeof(double);
+
+#if !defined(_WIN32)
+    // A single parameter of 2^48 bytes, and parameters whose sum exceeds the 256 MB limit
+    std::vector<unsigned long long> hugeSize(1, 1ULL << 48), hugeTotal;
+    hugeTotal.push_back(8);
+    hugeTotal.push_back(200ULL << 20);
+    hugeTotal.push_back(200ULL << 20);
+    if (!checkOversizedMessage(port++, hugeSize) || !checkOversizedMessage(port++, hugeTotal)) {
+      std::cerr << "Oversized binary message check failed" << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::cout << "binary mode: oversized messages rejected" << std::endl;
+#endif
+
+    for (unsigned int mode = 0; mode < 2; mode++) {
+      bool binary = (mode == 1);
+      std::string name = binary ? "binary" : "text";
+
+      double latency = benchmarkLatency(port++, binary, nbPings);
+      if (latency < 0) {
+        std::cerr << "Latency benchmark failed in " << name << " mode" << std::endl;
+        return EXIT_FAILURE;
+      }
+      std::cout << name << " mode: mean round trip " << latency << " ms" << std::endl;
+
+      // The text framing mixes the bytes of concurrent clients: one client only
+      for (unsigned int clients = 1; clients <= (binary ? 4u : 1u); clients += 3) {
+        if (!checkBackToBack(port++, binary, clients, nbFrames)) {
+          std::cerr << "Back to back messages check failed in " << name << " mode with " << clients << " client(s)"
+                    << std::endl;
+          return EXIT_FAILURE;
+        }
+        std::cout << name << " mode: " << clients << " client(s), back to back messages decoded" << std::endl;
+      }
+
+      // The text framing mixes the bytes of concurrent clients: one client only
+      for (unsigned int clients = 1; clients <= (binary ? nbClients : 1); clients = (std::max)(clients + 1, nbClients)) {
+        double elapsed = benchmarkThroughput(port++, binary, clients, nbFrames, width, height);
+        if (elapsed < 0) {
+          std::cerr << "Throughput benchmark failed in " << name << " mode" << std::endl;
+          return EXIT_FAILURE;
+        }
+        std::cout << name << " mode: " << clients << " client(s), " << clients * nbFrames
+                  << " thumbnails and poses in " << elapsed << " ms ("
+                  << clients * nbFrames * frameSize / (elapsed * 1000.) << " MB/s)" << std::endl;
+      }
+    }
+
+    return EXIT_SUCCESS;
+  } catch (vpException &e) {
+    std::cout << "Catch an exception: " << e << std::endl;
+    return EXIT_FAILURE;
+  }
+}
+
+#else
+int main()
+{
+  std::cout << "You do not have threading capabilities to run this benchmark" << std::endl;
+  return 0;
+}
+#endif
@@ -0,0 +1,228 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the parallel computation of image histograms.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testImageHistogram.cpp
+
+  \brief Compare the histograms given by vpImageHistogram with a reference
+  computation, for all the image types and several numbers of threads, and
+  check that vpHistogram counts in its own array.
+*/
+
+#include <iostream>
+#include <limits>
+
+#include <visp3/core/vpHistogram.h>
+#include <visp3/core/vpImageHistogram.h>
+#include <visp3/core/vpTime.h>
+
+namespace
+{
+unsigned int state = 12345;
+
+// Deterministic pseudo-random values, with runs of identical values
+unsigned int nextValue()
+{
+  state = state * 1103515245 + 12345;
+  return (state >> 8) & 0xffff;
+}
+
+template <typename Type> void fill(vpImage<Type> &I, unsigned int modulo)
+{
+  for (unsigned int i = 0; i < I.getSize(); i++) {
+    I.bitmap[i] = (i % 7 < 3 && i > 0) ? I.bitmap[i - 1] : (Type)(nextValue() % modulo);
+  }
+}
+
+bool compare(const std::vector<unsigned int> &hist, const std::vector<unsigned int> &reference,
+             const std::string &name)
+{
+  if (hist.size() != reference.size()) {
+    std::cerr << name << ": " << hist.size() << " bins instead of " << reference.size() << std::endl;
+    return false;
+  }
+  for (size_t i = 0; i < hist.size(); i++) {
+    if (hist[i] != reference[i]) {
+      std::cerr << name << ": bin " << i << " is " << hist[i] << " instead of " << reference[i] << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int main()
+{
+  try {
+    const unsigned int nbThreads[] = {1, 3, 8};
+    vpImage<unsigned char> I(301, 217), I2(301, 217);
+    vpImage<vpRGBa> C(123, 97);
+    vpImage<uint16_t> D(211, 173);
+    vpImage<float> F(97, 131);
+    fill(I, 256);
+    fill(I2, 256);
+    for (unsigned int i = 0; i < C.getSize(); i++) {
+      C.bitmap[i] = vpRGBa((unsigned char)nextValue(), (unsigned char)(nextValue() % 16), (unsigned char)nextValue(), 255);
+    }
+    fill(D, 5000); // Some values greater than the maximal value 4095
+    for (unsigned int i = 0; i < F.getSize(); i++) {
+      F.bitmap[i] = (nextValue() % 1200) / 1000.f - 0.1f; // In [-0.1, 1.099]
+    }
+    F.bitmap[0] = 1.f;
+    F.bitmap[1] = std::numeric_limits<float>::quiet_NaN();
+
+    for (size_t t = 0; t < sizeof(nbThreads) / sizeof(nbThreads[0]); t++) {
+      std::vector<unsigned int> hist, reference;
+      const unsigned int nbBins[] = {256, 101, 1};
+      for (size_t b = 0; b < sizeof(nbBins) / sizeof(nbBins[0]); b++) {
+        reference.assign(nbBins[b], 0);
+        for (unsigned int i = 0; i < I.getSize(); i++) {
+          reference[(unsigned int)(I.bitmap[i] * nbBins[b] / 256.0)]++;
+        }
+        vpImageHistogram::calculate(I, hist, nbBins[b], nbThreads[t]);
+        if (!compare(hist, reference, "Grey level histogram")) {
+          return EXIT_FAILURE;
+        }
+
+        // vpHistogram counts in its own array, that is kept between two calls
+        vpHistogram h;
+        h.calculate(I, nbBins[b], nbThreads[t]);
+        const unsigned int *values = h.getValues();
+        h.calculate(I, nbBins[b], nbThreads[t]);
+        if (h.getValues() != values) {
+          std::cerr << "vpHistogram reallocated its array" << std::endl;
+          return EXIT_FAILURE;
+        }
+        if (!compare(std::vector<unsigned int>(values, values + nbBins[b]), reference, "vpHistogram")) {
+          return EXIT_FAILURE;
+        }
+      }
+
+      std::vector<unsigned int> histR, histG, histB, histA;
+      vpImageHistogram::calculate(C, histR, histG, histB, histA, 64, nbThreads[t]);
+      for (unsigned int c = 0; c < 4; c++) {
+        reference.assign(64, 0);
+        for (unsigned int i = 0; i < C.getSize(); i++) {
+          reference[((const unsigned char *)&C.bitmap[i])[c] / 4]++;
+        }
+        const std::vector<unsigned int> &channel = c == 0 ? histR : (c == 1 ? histG : (c == 2 ? histB : histA));
+        if (!compare(channel, reference, "Color histogram")) {
+          return EXIT_FAILURE;
+        }
+      }
+
+      reference.assign(512, 0);
+      for (unsigned int i = 0; i < D.getSize(); i++) {
+        if (D.bitmap[i] <= 4095)
+          reference[D.bitmap[i] / 8]++;
+      }
+      vpImageHistogram::calculate(D, hist, 512, 4095, nbThreads[t]);
+      if (!compare(hist, reference, "16 bits histogram")) {
+        return EXIT_FAILURE;
+      }
+
+      reference.assign(10, 0);
+      for (unsigned int i = 0; i < F.getSize(); i++) {
+        float v = F.bitmap[i];
+        if (v >= 0.f && v <= 1.f)
+          reference[std::min(9u, (unsigned int)(v * 10))]++;
+      }
+      vpImageHistogram::calculate(F, hist, 10, 0.f, 1.f, nbThreads[t]);
+      if (!compare(hist, reference, "Floating point histogram")) {
+        return EXIT_FAILURE;
+      }
+
+      reference.assign(32 * 16, 0);
+      for (unsigned int i = 0; i < I.getSize(); i++) {
+        reference[(I.bitmap[i] / 8) * 16 + I2.bitmap[i] / 16]++;
+      }
+      vpImageHistogram::calculate(I, I2, hist, 32, 16, nbThreads[t]);
+      if (!compare(hist, reference, "Joint histogram")) {
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Empty image
+    std::vector<unsigned int> hist;
+    vpImage<unsigned char> E;
+    vpImageHistogram::calculate(E, hist, 256, 4);
+    if (hist.size() != 256 || hist[0] != 0) {
+      std::cerr << "Wrong histogram of an empty image" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    bool exceptionThrown = false;
+    try {
+      vpImageHistogram::calculate(I, hist, 0);
+    } catch (vpException &) {
+      exceptionThrown = true;
+    }
+    if (!exceptionThrown) {
+      std::cerr << "No exception for 0 bins" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Timing on a 12 MP image
+    vpImage<unsigned char> L(3000, 4000);
+    fill(L, 256);
+    const int nbIterations = 10;
+    std::vector<unsigned int> reference(256);
+    double t = vpTime::measureTimeMs();
+    for (int iteration = 0; iteration < nbIterations; iteration++) {
+      std::fill(reference.begin(), reference.end(), 0);
+      for (unsigned int i = 0; i < L.getSize(); i++) {
+        reference[L.bitmap[i]]++;
+      }
+    }
+    std::cout << "Single table: " << (vpTime::measureTimeMs() - t) / nbIterations << " ms" << std::endl;
+    for (size_t k = 0; k < sizeof(nbThreads) / sizeof(nbThreads[0]); k++) {
+      t = vpTime::measureTimeMs();
+      for (int iteration = 0; iteration < nbIterations; iteration++) {
+        vpImageHistogram::calculate(L, hist, 256, nbThreads[k]);
+      }
+      std::cout << "vpImageHistogram with " << nbThreads[k] << " thread(s): "
+                << (vpTime::measureTimeMs() - t) / nbIterations << " ms" << std::endl;
+      if (!compare(hist, reference, "12 MP histogram")) {
+        return EXIT_FAILURE;
+      }
+    }
+
+    std::cout << "vpImageHistogram is ok" << std::endl;
+    return EXIT_SUCCESS;
+  } catch (vpException &e) {
+    std::cerr << "Catch an exception: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
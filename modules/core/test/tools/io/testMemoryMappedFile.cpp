@@ -0,0 +1,124 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test vpMemoryMappedFile.
+ *
+ *****************************************************************************/
+
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpMemoryMappedFile.h>
+
+/*!
+  \example testMemoryMappedFile.cpp
+
+  \brief Test that vpMemoryMappedFile gives the file content and never writes it back.
+*/
+
+int main()
+{
+  try {
+#if defined(_WIN32)
+    std::string directory = "C:/temp";
+#else
+    std::string directory = "/tmp";
+#endif
+    vpIoTools::makeDirectory(directory);
+    std::string filename = vpIoTools::createFilePath(directory, "testMemoryMappedFile.bin");
+
+    std::vector<unsigned char> content(100003);
+    for (size_t i = 0; i < content.size(); i++) {
+      content[i] = (unsigned char) ((i * 7 + 3) % 251);
+    }
+    {
+      std::ofstream file(filename.c_str(), std::ofstream::binary);
+      file.write((const char *) &content[0], (std::streamsize) content.size());
+    }
+
+    {
+      vpMemoryMappedFile mapped(filename);
+      std::cout << "File " << filename << " is " << (mapped.isMapped() ? "memory-mapped" : "read in memory")
+                << std::endl;
+      if (!mapped.isOpen() || mapped.getSize() != content.size()) {
+        std::cerr << "Wrong file size: " << mapped.getSize() << std::endl;
+        return EXIT_FAILURE;
+      }
+      for (size_t i = 0; i < content.size(); i++) {
+        if (mapped.getData()[i] != content[i]) {
+          std::cerr << "Wrong byte at " << i << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+
+      // Private mapping: the change must not reach the file
+      mapped.getData()[0] = (unsigned char) (content[0] + 1);
+
+      vpMemoryMappedFile other;
+      other.swap(mapped);
+      if (mapped.isOpen() || !other.isOpen() || other.getData()[0] != (unsigned char) (content[0] + 1)) {
+        std::cerr << "Swap failed" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    vpMemoryMappedFile mapped(filename);
+    if (mapped.getData()[0] != content[0]) {
+      std::cerr << "The file was modified" << std::endl;
+      return EXIT_FAILURE;
+    }
+    mapped.close();
+    if (mapped.isOpen() || mapped.getData() != NULL) {
+      std::cerr << "Close failed" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    bool exceptionThrown = false;
+    try {
+      mapped.open(filename + ".missing");
+    } catch (const vpException &) {
+      exceptionThrown = true;
+    }
+    if (!exceptionThrown) {
+      std::cerr << "No exception for a missing file" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    vpIoTools::remove(filename);
+    std::cout << "vpMemoryMappedFile is ok" << std::endl;
+    return EXIT_SUCCESS;
+  } catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
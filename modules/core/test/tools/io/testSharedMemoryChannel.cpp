@@ -0,0 +1,268 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the shared memory publish/subscribe channel.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testSharedMemoryChannel.cpp
+
+  \brief Test vpSharedMemoryChannel in a single process and between a
+  publisher child process and a subscriber.
+*/
+
+#include <iostream>
+#include <sstream>
+
+#include <visp3/core/vpSharedMemoryChannel.h>
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <visp3/core/vpTime.h>
+
+namespace
+{
+void fill(vpImage<unsigned char> &I, unsigned int value)
+{
+  for (unsigned int i = 0; i < I.getSize(); i++)
+    I.bitmap[i] = (unsigned char)((i + value) % 256);
+}
+
+bool check(const vpImage<unsigned char> &I, unsigned int value)
+{
+  for (unsigned int i = 0; i < I.getSize(); i++)
+    if (I.bitmap[i] != (unsigned char)((i + value) % 256))
+      return false;
+  return true;
+}
+}
+
+int main()
+{
+  std::ostringstream name;
+  name << "testSharedMemoryChannel_" << getpid();
+  const unsigned int nbSlots = 4;
+
+  try {
+    vpImage<unsigned char> I(120, 160);
+    vpSharedMemoryChannel publisher;
+    publisher.create(name.str(), I.getSize(), nbSlots);
+
+    vpSharedMemoryChannel latest, every;
+    latest.open(name.str());
+    every.open(name.str());
+    every.setReadMode(vpSharedMemoryChannel::EVERY_FRAME);
+
+    vpImage<unsigned char> J;
+    if (latest.read(J) || latest.wait(1)) {
+      std::cerr << "Frame read before any publication" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // First frame, then nbSlots+2 frames, so that the second one is overwritten
+    fill(I, 1);
+    publisher.publish(I, 1.);
+    if (!every.read(J) || every.getSequence() != 1 || !check(J, 1) || every.getTimestamp() != 1.) {
+      std::cerr << "Wrong first frame" << std::endl;
+      return EXIT_FAILURE;
+    }
+    for (unsigned int k = 2; k <= nbSlots + 3; k++) {
+      fill(I, k);
+      publisher.publish(I, (double)k);
+    }
+
+    if (!latest.wait(0) || !latest.read(J) || latest.getSequence() != nbSlots + 3 || !check(J, nbSlots + 3)) {
+      std::cerr << "Latest frame not read" << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (latest.read(J)) {
+      std::cerr << "The latest frame is read twice" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // The subscriber reading every frame restarts at the oldest one of the ring
+    unsigned int expected = 4;
+    while (every.read(J)) {
+      if (every.getSequence() != expected || !check(J, expected)) {
+        std::cerr << "Wrong frame " << every.getSequence() << ", expected " << expected << std::endl;
+        return EXIT_FAILURE;
+      }
+      expected++;
+    }
+    if (expected != nbSlots + 4 || every.getDroppedCount() != 2) {
+      std::cerr << "Wrong dropped count: " << every.getDroppedCount() << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // A view is invalidated when its slot is reused
+    fill(I, 100);
+    publisher.publish(I);
+    vpImage<unsigned char> V;
+    if (!latest.getView(V) || !check(V, 100) || !latest.isViewValid()) {
+      std::cerr << "Wrong view" << std::endl;
+      return EXIT_FAILURE;
+    }
+    for (unsigned int k = 0; k < nbSlots - 1; k++) {
+      publisher.publish(I);
+    }
+    if (!latest.isViewValid()) {
+      std::cerr << "View invalidated too early" << std::endl;
+      return EXIT_FAILURE;
+    }
+    publisher.publish(I);
+    if (latest.isViewValid()) {
+      std::cerr << "Overwritten view still valid" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Other data types
+    vpHomogeneousMatrix cMo(0.1, 0.2, 0.3, 0.4, 0.5, 0.6), M;
+    publisher.publish(cMo);
+    bool exceptionThrown = false;
+    try {
+      latest.read(J);
+    } catch (vpException &) {
+      exceptionThrown = true;
+    }
+    if (!exceptionThrown) {
+      std::cerr << "No exception for a type mismatch" << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (!latest.read(M) || latest.getDataType() != vpSharedMemoryChannel::HOMOGENEOUS_MATRIX) {
+      std::cerr << "Pose not read" << std::endl;
+      return EXIT_FAILURE;
+    }
+    for (unsigned int i = 0; i < 16; i++) {
+      if (M.data[i] != cMo.data[i]) {
+        std::cerr << "Wrong pose" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    vpColVector v(6), w;
+    for (unsigned int i = 0; i < v.getRows(); i++)
+      v[i] = i * 0.5;
+    publisher.publish(v);
+    if (!latest.read(w) || w.getRows() != v.getRows()) {
+      std::cerr << "Column vector not read" << std::endl;
+      return EXIT_FAILURE;
+    }
+    for (unsigned int i = 0; i < v.getRows(); i++) {
+      if (w[i] != v[i]) {
+        std::cerr << "Wrong column vector" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    exceptionThrown = false;
+    try {
+      vpImage<unsigned char> big(I.getHeight() + 1, I.getWidth());
+      publisher.publish(big);
+    } catch (vpException &) {
+      exceptionThrown = true;
+    }
+    if (!exceptionThrown) {
+      std::cerr << "No exception for a frame bigger than the capacity" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    double t = vpTime::measureTimeMs();
+    if (latest.wait(20) || vpTime::measureTimeMs() - t < 15) {
+      std::cerr << "Wrong wait timeout" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    publisher.close();
+    if (!latest.isPublisherClosed() || latest.wait()) {
+      std::cerr << "Closing not detected" << std::endl;
+      return EXIT_FAILURE;
+    }
+    latest.close();
+    every.close();
+
+    // A child process publishes, the parent waits for its frames
+    const unsigned int nbFrames = 200;
+    publisher.create(name.str(), I.getSize(), nbSlots);
+    latest.open(name.str());
+    pid_t pid = fork();
+    if (pid == -1) {
+      std::cerr << "Cannot fork" << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (pid == 0) {
+      for (unsigned int k = 1; k <= nbFrames; k++) {
+        fill(I, k);
+        publisher.publish(I);
+        vpTime::sleepMs(1);
+      }
+      publisher.close();
+      _exit(EXIT_SUCCESS);
+    }
+
+    unsigned int nbRead = 0;
+    double latency = 0;
+    bool valid = true;
+    while (latest.wait(5000)) {
+      if (latest.read(J)) {
+        latency += vpTime::measureTimeMs() - latest.getTimestamp();
+        valid = valid && check(J, latest.getSequence());
+        nbRead++;
+      }
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (!valid || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS || latest.getSequence() != nbFrames ||
+        nbRead + latest.getDroppedCount() != nbFrames) {
+      std::cerr << "Wrong frames from the publisher process" << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::cout << "Read " << nbRead << "/" << nbFrames << " frames from the publisher process with a mean latency of "
+              << latency / nbRead << " ms" << std::endl;
+
+    std::cout << "vpSharedMemoryChannel is ok" << std::endl;
+    return EXIT_SUCCESS;
+  } catch (vpException &e) {
+    std::cerr << "Catch an exception: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
+
+#else
+int main()
+{
+  std::cout << "vpSharedMemoryChannel is only available on unix-like systems" << std::endl;
+  return EXIT_SUCCESS;
+}
+#endif
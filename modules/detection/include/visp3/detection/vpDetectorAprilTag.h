@@ -141,6 +141,11 @@ Tag code 1:
   Pose: 0.08951250829  0.02243780207  0.306540622  1.998073197  2.061488008  -0.8699567948
   \endcode
 
+  When several tags are detected, their poses are computed in parallel with the
+  number of threads set by setAprilTagNbThreads(). To reduce the detection time
+  in a video stream, setAprilTagTrackingMode() restricts the search to the
+  neighbourhood of the tags detected in the previous image.
+
   Other examples are also provided in tutorial-apriltag-detector.cpp and
   tutorial-apriltag-detector-live.cpp
 */
@@ -183,6 +188,7 @@ public:
   void setAprilTagRefineDecode(const bool refineDecode);
   void setAprilTagRefineEdges(const bool refineEdges);
   void setAprilTagRefinePose(const bool refinePose);
+  void setAprilTagTrackingMode(const bool tracking, const unsigned int fullFrameSweepPeriod=10, const double roiMargin=0.5);
 
   /*! Allow to enable the display of overlay tag information in the windows (vpDisplay) associated to the input image. */
   inline void setDisplayTag(const bool display) {
@@ -35,6 +35,9 @@
 #include <visp3/core/vpConfig.h>
 
 #ifdef VISP_HAVE_APRILTAG
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <map>
 
 #include <apriltag.h>
@@ -50,13 +53,16 @@
 #include <visp3/core/vpDisplay.h>
 #include <visp3/core/vpPoint.h>
 #include <visp3/core/vpPixelMeterConversion.h>
+#include <visp3/core/vpRect.h>
 #include <visp3/vision/vpPose.h>
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 class vpDetectorAprilTag::Impl {
 public:
   Impl(const vpAprilTagFamily &tagFamily, const vpPoseEstimationMethod &method)
-    : m_cam(), m_poseEstimationMethod(method), m_tagFamily(tagFamily), m_tagPoses(), m_tagSize(1.0), m_td(NULL), m_tf(NULL) {
+    : m_cam(), m_poseEstimationMethod(method), m_tagFamily(tagFamily), m_tagPoses(), m_tagSize(1.0), m_td(NULL), m_tf(NULL),
+      m_tracking(false), m_fullFrameSweepPeriod(10), m_trackingRoiMargin(0.5), m_frameIndex(0), m_lastWidth(0), m_lastHeight(0),
+      m_lastPolygons() {
     switch (m_tagFamily) {
       case TAG_36h11:
         m_tf = tag36h11_create();
@@ -131,22 +137,45 @@ public:
               const bool computePose, const bool displayTag) {
     m_tagPoses.clear();
 
-    image_u8_t im = { /*.width =*/ (int32_t) I.getWidth(),
-                      /*.height =*/ (int32_t) I.getHeight(),
-                      /*.stride =*/ (int32_t) I.getWidth(),
-                      /*.buf =*/ I.bitmap
-                    };
-
-    zarray_t *detections = apriltag_detector_detect(m_td, &im);
-    int nb_detections = zarray_size(detections);
-    bool detected = nb_detections > 0;
+    // In tracking mode, only the neighbourhood of the tags of the previous frame is searched, except every m_fullFrameSweepPeriod frames
+    std::vector<zarray_t *> detectionLists;
+    bool fullFrame = !m_tracking || m_lastPolygons.empty() || m_frameIndex % m_fullFrameSweepPeriod == 0 ||
+        m_lastWidth != I.getWidth() || m_lastHeight != I.getHeight();
+    if (!fullFrame) {
+      std::vector<vpRect> rois;
+      computeTrackingRois(I, rois);
+      for (size_t i = 0; i < rois.size(); i++) {
+        detectionLists.push_back(detectInRoi(I, rois[i]));
+      }
+      if (nbDetections(detectionLists) == 0) {
+        // All the tags are lost, search them in the whole image
+        destroyDetections(detectionLists);
+        fullFrame = true;
+      }
+    }
+    if (fullFrame) {
+      detectionLists.push_back(detectInRoi(I, vpRect(0, 0, I.getWidth(), I.getHeight())));
+      m_frameIndex = 0;
+    }
+    m_frameIndex++;
+    m_lastWidth = I.getWidth();
+    m_lastHeight = I.getHeight();
+
+    std::vector<apriltag_detection_t *> detections;
+    for (size_t l = 0; l < detectionLists.size(); l++) {
+      for (int i = 0; i < zarray_size(detectionLists[l]); i++) {
+        apriltag_detection_t *det;
+        zarray_get(detectionLists[l], i, &det);
+        detections.push_back(det);
+      }
+    }
+    bool detected = !detections.empty();
 
-    polygons.resize( (size_t) nb_detections);
-    messages.resize( (size_t) nb_detections);
+    polygons.resize(detections.size());
+    messages.resize(detections.size());
 
-    for (int i = 0; i < zarray_size(detections); i++) {
-      apriltag_detection_t *det;
-      zarray_get(detections, i, &det);
+    for (size_t i = 0; i < detections.size(); i++) {
+      apriltag_detection_t *det = detections[i];
 
       std::vector<vpImagePoint> polygon;
       for (int j = 0; j < 4; j++) {
@@ -163,101 +192,229 @@ public:
         vpDisplay::displayLine(I, (int)det->p[1][1], (int)det->p[1][0], (int)det->p[2][1], (int)det->p[2][0], vpColor::blue, 2);
         vpDisplay::displayLine(I, (int)det->p[2][1], (int)det->p[2][0], (int)det->p[3][1], (int)det->p[3][0], vpColor::yellow, 2);
       }
+    }
+    m_lastPolygons = polygons;
+
+    // An exception cannot leave the parallel loop: the error of each tag is
+    // kept and the one of the first failing tag is thrown once the detections are freed
+    std::vector<unsigned char> failed;
+    std::vector<int> errorCodes;
+    std::vector<std::string> errors;
+    if (computePose) {
+      // The pose of each tag is independent of the others
+      m_tagPoses.resize(detections.size());
+      failed.assign(detections.size(), 0);
+      errorCodes.assign(detections.size(), vpException::fatalError);
+      errors.assign(detections.size(), std::string());
+      const int nbThreads = m_td->nthreads;
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for num_threads(nbThreads) if(nbThreads > 1 && detections.size() > 1) schedule(dynamic)
+#else
+      (void)nbThreads;
+#endif
+      for (int i = 0; i < (int)detections.size(); i++) {
+        try {
+          computeTagPose(detections[(size_t)i], m_tagPoses[(size_t)i]);
+        }
+        catch(vpException &e) {
+          failed[(size_t)i] = 1;
+          errorCodes[(size_t)i] = e.getCode();
+          errors[(size_t)i] = e.getStringMessage();
+        }
+        catch(const std::exception &e) {
+          failed[(size_t)i] = 1;
+          errors[(size_t)i] = e.what();
+        }
+        catch(...) {
+          failed[(size_t)i] = 1;
+          errors[(size_t)i] = "Unknown error";
+        }
+      }
+    }
+
+    for (size_t i = 0; i < failed.size(); i++) {
+      if (failed[i]) {
+        const int id = detections[i]->id;
+        destroyDetections(detectionLists);
+        throw vpException(errorCodes[i], "Cannot compute the pose of tag %d: %s", id, errors[i].c_str());
+      }
+    }
+    destroyDetections(detectionLists);
+
+    return detected;
+  }
 
-      if (computePose) {
-        vpHomogeneousMatrix cMo;
-        if (m_poseEstimationMethod == HOMOGRAPHY_VIRTUAL_VS || m_poseEstimationMethod == BEST_RESIDUAL_VIRTUAL_VS) {
-          double fx = m_cam.get_px(), fy = m_cam.get_py();
-          double cx = m_cam.get_u0(), cy = m_cam.get_v0();
+  /*!
+    Detect the tags in a region of the image. The image is not copied, the
+    region is seen as an image whose stride is the image width. The
+    coordinates of the detections are expressed in the whole image.
+  */
+  zarray_t *detectInRoi(const vpImage<unsigned char> &I, const vpRect &roi) {
+    const unsigned int u0 = (unsigned int) roi.getLeft(), v0 = (unsigned int) roi.getTop();
+    image_u8_t im = { /*.width =*/ (int32_t) roi.getWidth(),
+                      /*.height =*/ (int32_t) roi.getHeight(),
+                      /*.stride =*/ (int32_t) I.getWidth(),
+                      /*.buf =*/ I.bitmap + v0 * I.getWidth() + u0
+                    };
 
-          matd_t *M = homography_to_pose(det->H, fx, fy, cx, cy, m_tagSize/2);
+    zarray_t *detections = apriltag_detector_detect(m_td, &im);
+    if (u0 == 0 && v0 == 0)
+      return detections;
 
-          for (int i = 0; i < 3; i++) {
-            for (int j = 0; j < 3; j++) {
-              cMo[i][j] = MATD_EL(M, i, j);
-            }
-            cMo[i][3] = MATD_EL(M, i, 3);
+    for (int i = 0; i < zarray_size(detections); i++) {
+      apriltag_detection_t *det;
+      zarray_get(detections, i, &det);
+      det->c[0] += u0;
+      det->c[1] += v0;
+      for (int j = 0; j < 4; j++) {
+        det->p[j][0] += u0;
+        det->p[j][1] += v0;
+      }
+      // H is the homography from the tag to the region: translate it to the image
+      for (int j = 0; j < 3; j++) {
+        MATD_EL(det->H, 0, j) += u0 * MATD_EL(det->H, 2, j);
+        MATD_EL(det->H, 1, j) += v0 * MATD_EL(det->H, 2, j);
+      }
+    }
+    return detections;
+  }
+
+  /*!
+    Regions around the tags detected in the previous frame, enlarged by
+    m_trackingRoiMargin times their size. The regions that overlap are merged.
+  */
+  void computeTrackingRois(const vpImage<unsigned char> &I, std::vector<vpRect> &rois) const {
+    rois.clear();
+    for (size_t i = 0; i < m_lastPolygons.size(); i++) {
+      vpRect bbox(m_lastPolygons[i]);
+      const double margin = m_trackingRoiMargin * (std::max)(bbox.getWidth(), bbox.getHeight()) + 8;
+      const double left = (std::max)(0., floor(bbox.getLeft() - margin));
+      const double top = (std::max)(0., floor(bbox.getTop() - margin));
+      const double right = (std::min)((double) I.getWidth(), ceil(bbox.getLeft() + bbox.getWidth() + margin));
+      const double bottom = (std::min)((double) I.getHeight(), ceil(bbox.getTop() + bbox.getHeight() + margin));
+      if (right > left && bottom > top)
+        rois.push_back(vpRect(left, top, right - left, bottom - top));
+    }
+
+    bool merged = true;
+    while (merged) {
+      merged = false;
+      for (size_t i = 0; i < rois.size() && !merged; i++) {
+        for (size_t j = i + 1; j < rois.size() && !merged; j++) {
+          const vpRect &a = rois[i], &b = rois[j];
+          if (a.getLeft() < b.getLeft() + b.getWidth() && b.getLeft() < a.getLeft() + a.getWidth() &&
+              a.getTop() < b.getTop() + b.getHeight() && b.getTop() < a.getTop() + a.getHeight()) {
+            const double left = (std::min)(a.getLeft(), b.getLeft()), top = (std::min)(a.getTop(), b.getTop());
+            const double right = (std::max)(a.getLeft() + a.getWidth(), b.getLeft() + b.getWidth());
+            const double bottom = (std::max)(a.getTop() + a.getHeight(), b.getTop() + b.getHeight());
+            rois[i] = vpRect(left, top, right - left, bottom - top);
+            rois.erase(rois.begin() + (std::ptrdiff_t) j);
+            merged = true;
           }
+        }
+      }
+    }
+  }
+
+  void computeTagPose(const apriltag_detection_t *det, vpHomogeneousMatrix &cMo) const {
+    if (m_poseEstimationMethod == HOMOGRAPHY_VIRTUAL_VS || m_poseEstimationMethod == BEST_RESIDUAL_VIRTUAL_VS) {
+      double fx = m_cam.get_px(), fy = m_cam.get_py();
+      double cx = m_cam.get_u0(), cy = m_cam.get_v0();
+
+      matd_t *M = homography_to_pose(det->H, fx, fy, cx, cy, m_tagSize/2);
+
+      for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+          cMo[i][j] = MATD_EL(M, i, j);
+        }
+        cMo[i][3] = MATD_EL(M, i, 3);
+      }
+
+      matd_destroy(M);
+    }
+
+    //Add marker object points
+    vpPoint pt;
+    vpImagePoint imPt;
+    double x = 0.0, y = 0.0;
+    std::vector<vpPoint> pts(4);
+    pt.setWorldCoordinates(-m_tagSize/2.0, -m_tagSize/2.0, 0.0);
+    imPt.set_uv(det->p[0][0], det->p[0][1]);
+    vpPixelMeterConversion::convertPoint(m_cam, imPt, x, y);
+    pt.set_x(x);
+    pt.set_y(y);
+    pts[0] = pt;
+
+    pt.setWorldCoordinates(m_tagSize/2.0, -m_tagSize/2.0, 0.0);
+    imPt.set_uv(det->p[1][0], det->p[1][1]);
+    vpPixelMeterConversion::convertPoint(m_cam, imPt, x, y);
+    pt.set_x(x);
+    pt.set_y(y);
+    pts[1] = pt;
+
+    pt.setWorldCoordinates(m_tagSize/2.0, m_tagSize/2.0, 0.0);
+    imPt.set_uv(det->p[2][0], det->p[2][1]);
+    vpPixelMeterConversion::convertPoint(m_cam, imPt, x, y);
+    pt.set_x(x);
+    pt.set_y(y);
+    pts[2] = pt;
+
+    pt.setWorldCoordinates(-m_tagSize/2.0, m_tagSize/2.0, 0.0);
+    imPt.set_uv(det->p[3][0], det->p[3][1]);
+    vpPixelMeterConversion::convertPoint(m_cam, imPt, x, y);
+    pt.set_x(x);
+    pt.set_y(y);
+    pts[3] = pt;
+
+    vpPose pose;
+    pose.addPoints(pts);
+
+    if (m_poseEstimationMethod != HOMOGRAPHY_VIRTUAL_VS) {
+      if (m_poseEstimationMethod == BEST_RESIDUAL_VIRTUAL_VS) {
+        vpHomogeneousMatrix cMo_dementhon, cMo_lagrange, cMo_homography = cMo;
+
+        double residual_dementhon = std::numeric_limits<double>::max(), residual_lagrange = std::numeric_limits<double>::max();
+        double residual_homography = pose.computeResidual(cMo_homography);
+
+        if (pose.computePose(vpPose::DEMENTHON, cMo_dementhon)) {
+          residual_dementhon = pose.computeResidual(cMo_dementhon);
+        }
 
-          matd_destroy(M);
+        if (pose.computePose(vpPose::LAGRANGE, cMo_lagrange)) {
+          residual_lagrange = pose.computeResidual(cMo_lagrange);
         }
 
-        //Add marker object points
-        vpPoint pt;
-        vpImagePoint imPt;
-        double x = 0.0, y = 0.0;
-        std::vector<vpPoint> pts(4);
-        pt.setWorldCoordinates(-m_tagSize/2.0, -m_tagSize/2.0, 0.0);
-        imPt.set_uv(det->p[0][0], det->p[0][1]);
-        vpPixelMeterConversion::convertPoint(m_cam, imPt, x, y);
-        pt.set_x(x);
-        pt.set_y(y);
-        pts[0] = pt;
-
-        pt.setWorldCoordinates(m_tagSize/2.0, -m_tagSize/2.0, 0.0);
-        imPt.set_uv(det->p[1][0], det->p[1][1]);
-        vpPixelMeterConversion::convertPoint(m_cam, imPt, x, y);
-        pt.set_x(x);
-        pt.set_y(y);
-        pts[1] = pt;
-
-        pt.setWorldCoordinates(m_tagSize/2.0, m_tagSize/2.0, 0.0);
-        imPt.set_uv(det->p[2][0], det->p[2][1]);
-        vpPixelMeterConversion::convertPoint(m_cam, imPt, x, y);
-        pt.set_x(x);
-        pt.set_y(y);
-        pts[2] = pt;
-
-        pt.setWorldCoordinates(-m_tagSize/2.0, m_tagSize/2.0, 0.0);
-        imPt.set_uv(det->p[3][0], det->p[3][1]);
-        vpPixelMeterConversion::convertPoint(m_cam, imPt, x, y);
-        pt.set_x(x);
-        pt.set_y(y);
-        pts[3] = pt;
-
-        vpPose pose;
-        pose.addPoints(pts);
-
-        if (m_poseEstimationMethod != HOMOGRAPHY_VIRTUAL_VS) {
-          if (m_poseEstimationMethod == BEST_RESIDUAL_VIRTUAL_VS) {
-            vpHomogeneousMatrix cMo_dementhon, cMo_lagrange, cMo_homography = cMo;
-
-            double residual_dementhon = std::numeric_limits<double>::max(), residual_lagrange = std::numeric_limits<double>::max();
-            double residual_homography = pose.computeResidual(cMo_homography);
-
-            if (pose.computePose(vpPose::DEMENTHON, cMo_dementhon)) {
-              residual_dementhon = pose.computeResidual(cMo_dementhon);
-            }
-
-            if (pose.computePose(vpPose::LAGRANGE, cMo_lagrange)) {
-              residual_lagrange = pose.computeResidual(cMo_lagrange);
-            }
-
-            if (residual_dementhon < residual_lagrange) {
-              if (residual_dementhon < residual_homography) {
-                cMo = cMo_dementhon;
-              } else {
-                cMo = cMo_homography;
-              }
-            } else if (residual_lagrange < residual_homography) {
-              cMo = cMo_lagrange;
-            } else {
-//              cMo = cMo_homography; //already the case
-            }
+        if (residual_dementhon < residual_lagrange) {
+          if (residual_dementhon < residual_homography) {
+            cMo = cMo_dementhon;
           } else {
-            pose.computePose(m_mapOfCorrespondingPoseMethods[m_poseEstimationMethod], cMo);
+            cMo = cMo_homography;
           }
+        } else if (residual_lagrange < residual_homography) {
+          cMo = cMo_lagrange;
+        } else {
+//          cMo = cMo_homography; //already the case
         }
-
-        //Compute final pose using VVS
-        pose.computePose(vpPose::VIRTUAL_VS, cMo);
-        m_tagPoses.push_back(cMo);
+      } else {
+        pose.computePose(m_mapOfCorrespondingPoseMethods.find(m_poseEstimationMethod)->second, cMo);
       }
     }
 
-    apriltag_detections_destroy(detections);
+    //Compute final pose using VVS
+    pose.computePose(vpPose::VIRTUAL_VS, cMo);
+  }
 
-    return detected;
+  static int nbDetections(const std::vector<zarray_t *> &detectionLists) {
+    int nb = 0;
+    for (size_t i = 0; i < detectionLists.size(); i++)
+      nb += zarray_size(detectionLists[i]);
+    return nb;
+  }
+
+  static void destroyDetections(std::vector<zarray_t *> &detectionLists) {
+    for (size_t i = 0; i < detectionLists.size(); i++)
+      apriltag_detections_destroy(detectionLists[i]);
+    detectionLists.clear();
   }
 
   void getTagPoses(std::vector<vpHomogeneousMatrix> &tagPoses) const {
@@ -292,6 +449,14 @@ public:
     m_td->refine_pose = refinePose ? 1 : 0;
   }
 
+  void setTrackingMode(const bool tracking, const unsigned int fullFrameSweepPeriod, const double roiMargin) {
+    m_tracking = tracking;
+    m_fullFrameSweepPeriod = (fullFrameSweepPeriod > 0) ? fullFrameSweepPeriod : 1;
+    m_trackingRoiMargin = roiMargin;
+    m_lastPolygons.clear();
+    m_frameIndex = 0;
+  }
+
   void setTagSize(const double tagSize) {
     m_tagSize = tagSize;
   }
@@ -309,6 +474,12 @@ protected:
   double m_tagSize;
   apriltag_detector_t *m_td;
   apriltag_family_t *m_tf;
+  bool m_tracking;
+  unsigned int m_fullFrameSweepPeriod;
+  double m_trackingRoiMargin;
+  unsigned int m_frameIndex;
+  unsigned int m_lastWidth, m_lastHeight;
+  std::vector<std::vector<vpImagePoint> > m_lastPolygons;
 };
 #endif // DOXYGEN_SHOULD_SKIP_THIS
 
@@ -367,7 +538,10 @@ bool vpDetectorAprilTag::detect(const vpImage<unsigned char> &I, const double ta
 }
 
 /*!
-  Set the number of threads for April Tag detection (default is 1).
+  Set the number of threads for April Tag detection (default is 1). When
+  ViSP is built with OpenMP, the poses of the tags detected by
+  detect(const vpImage<unsigned char> &, const double, const vpCameraParameters &, std::vector<vpHomogeneousMatrix> &)
+  are also computed with this number of threads.
 
   \param nThreads : Number of thread.
 */
@@ -376,6 +550,22 @@ void vpDetectorAprilTag::setAprilTagNbThreads(const int nThreads) {
     m_impl->setNbThreads(nThreads);
 }
 
+/*!
+  Enable or disable the tracking mode. In tracking mode, detect() only
+  searches the tags in the neighbourhood of the tags detected in the previous
+  image, which is faster when the tags move little from one image to the
+  other. The whole image is searched every \e fullFrameSweepPeriod images to
+  find the new tags, and when no tag is found in the neighbourhoods.
+
+  \param tracking : If true, enable the tracking mode (default is false).
+  \param fullFrameSweepPeriod : Number of images between two detections in the whole image.
+  \param roiMargin : The neighbourhood of a tag is its bounding box enlarged on each side by
+  \e roiMargin times its size, plus 8 pixels.
+*/
+void vpDetectorAprilTag::setAprilTagTrackingMode(const bool tracking, const unsigned int fullFrameSweepPeriod, const double roiMargin) {
+  m_impl->setTrackingMode(tracking, fullFrameSweepPeriod, roiMargin);
+}
+
 /*!
   Set the method to use to compute the pose, \see vpPoseEstimationMethod
 
@@ -0,0 +1,228 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Benchmark of the AprilTag pose estimation and tracking mode on synthetic images.
+ *
+ *****************************************************************************/
+/*!
+  \example testAprilTagMultiPose.cpp
+
+  \brief Detect 24 AprilTag 36h11 patterns rendered in synthetic images, check
+  that the poses computed with several threads and in tracking mode match the
+  full frame detection, and measure the detection time.
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <visp3/core/vpTime.h>
+#include <visp3/detection/vpDetectorAprilTag.h>
+
+#if defined(VISP_HAVE_APRILTAG)
+
+namespace {
+  // 36 bits codes of the first 36h11 tags, as the 4 most and the 32 less significant bits
+  const unsigned int nbTags = 24;
+  const unsigned int codes[nbTags][2] = {
+    {0xd, 0x5d628584}, {0xd, 0x97f18b49}, {0xd, 0xd280910e}, {0xe, 0x479e9c98}, {0xe, 0xbcbca822}, {0xf, 0x31dab3ac},
+    {0x0, 0x56a5d085}, {0x1, 0x0652e1d4}, {0x2, 0x2b1dfead}, {0x2, 0x65ad0472}, {0x3, 0x4fe91b86}, {0x3, 0xff962cd5},
+    {0x4, 0x3a25329a}, {0x4, 0x74b4385f}, {0x4, 0xe9d243e9}, {0x5, 0x246149ae}, {0x5, 0x997f5538}, {0x6, 0x83bb6c4c},
+    {0x6, 0xbe4a7211}, {0x7, 0xe3158eea}, {0x8, 0x1da494af}, {0x8, 0x58339a74}, {0x8, 0xcd51a5fe}, {0x9, 0xf21cc2d7}
+  };
+  const unsigned int cellSize = 8;         // Size of a bit of the tag in pixel
+  const unsigned int tagWidth = 8 * cellSize; // Width of the black border of the tag in pixel
+
+  /*!
+    Render the 24 tags on a 6 by 4 grid, shifted by (du, dv) pixels. The tag i
+    covers the pixels [u_i, u_i + tagWidth[ x [v_i, v_i + tagWidth[.
+  */
+  void renderTags(vpImage<unsigned char> &I, const unsigned int du, const unsigned int dv,
+                  std::vector<vpImagePoint> &topLeft) {
+    I.resize(960, 1280, 200);
+    topLeft.resize(nbTags);
+    for (unsigned int i = 0; i < nbTags; i++) {
+      const unsigned int u0 = 80 + 200 * (i % 6) + du, v0 = 120 + 200 * (i / 6) + dv;
+      topLeft[i].set_uv(u0, v0);
+      for (unsigned int by = 0; by < 8; by++) {
+        for (unsigned int bx = 0; bx < 8; bx++) {
+          bool white = false;
+          if (bx > 0 && bx < 7 && by > 0 && by < 7) {
+            const unsigned int bit = 35 - ((by - 1) * 6 + (bx - 1));
+            white = ((bit >= 32 ? codes[i][0] >> (bit - 32) : codes[i][1] >> bit) & 1) != 0;
+          }
+          for (unsigned int v = 0; v < cellSize; v++) {
+            for (unsigned int u = 0; u < cellSize; u++) {
+              I[v0 + by * cellSize + v][u0 + bx * cellSize + u] = white ? 200 : 20;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  int tagId(const std::string &message) {
+    return atoi(message.substr(message.find("id: ") + 4).c_str());
+  }
+
+  /*!
+    Check that each tag is detected once and that its position matches the rendering.
+  */
+  bool checkPoses(const std::string &name, vpDetectorAprilTag &detector, const std::vector<vpHomogeneousMatrix> &cMo,
+                  const std::vector<vpImagePoint> &topLeft, const vpCameraParameters &cam, const double tagSize,
+                  std::vector<vpHomogeneousMatrix> &poses) {
+    if (detector.getNbObjects() != nbTags || cMo.size() != nbTags) {
+      std::cerr << name << ": " << detector.getNbObjects() << " tags detected instead of " << nbTags << std::endl;
+      return false;
+    }
+
+    const double Z = cam.get_px() * tagSize / tagWidth;
+    poses.assign(nbTags, vpHomogeneousMatrix());
+    std::vector<bool> found(nbTags, false);
+    for (size_t i = 0; i < nbTags; i++) {
+      int id = tagId(detector.getMessage(i));
+      if (id < 0 || id >= (int) nbTags || found[(size_t) id]) {
+        std::cerr << name << ": unexpected tag " << detector.getMessage(i) << std::endl;
+        return false;
+      }
+      found[(size_t) id] = true;
+      poses[(size_t) id] = cMo[i];
+
+      const double uc = topLeft[(size_t) id].get_u() + (tagWidth - 1) / 2.0;
+      const double vc = topLeft[(size_t) id].get_v() + (tagWidth - 1) / 2.0;
+      const double X = (uc - cam.get_u0()) * Z / cam.get_px(), Y = (vc - cam.get_v0()) * Z / cam.get_py();
+      const double error = sqrt(vpMath::sqr(cMo[i][0][3] - X) + vpMath::sqr(cMo[i][1][3] - Y) +
+                                vpMath::sqr(cMo[i][2][3] - Z));
+      if (error > 0.005) {
+        std::cerr << name << ": tag " << id << " is at " << cMo[i].getTranslationVector().t() << " instead of "
+                  << X << " " << Y << " " << Z << std::endl;
+        return false;
+      }
+    }
+    return true;
+  }
+
+  double maxTranslationError(const std::vector<vpHomogeneousMatrix> &poses1,
+                             const std::vector<vpHomogeneousMatrix> &poses2) {
+    double error = 0;
+    for (size_t i = 0; i < poses1.size(); i++) {
+      error = (std::max)(error, (poses1[i].getTranslationVector() - poses2[i].getTranslationVector()).euclideanNorm());
+    }
+    return error;
+  }
+}
+
+int main()
+{
+  try {
+    vpCameraParameters cam;
+    cam.initPersProjWithoutDistortion(800, 800, 640, 480);
+    const double tagSize = 0.08;
+    const unsigned int nbFrames = 20;
+
+    vpImage<unsigned char> I;
+    std::vector<vpImagePoint> topLeft;
+    std::vector<vpHomogeneousMatrix> cMo, poses, poses_ref;
+
+    // Full frame detection with the pose of the tags computed one after the other
+    vpDetectorAprilTag detector(vpDetectorAprilTag::TAG_36h11);
+    double t_full = 0;
+    for (unsigned int frame = 0; frame < nbFrames; frame++) {
+      renderTags(I, 2 * frame, frame, topLeft);
+      double t = vpTime::measureTimeMs();
+      detector.detect(I, tagSize, cam, cMo);
+      t_full += vpTime::measureTimeMs() - t;
+      if (!checkPoses("Full frame", detector, cMo, topLeft, cam, tagSize, poses_ref)) {
+        return EXIT_FAILURE;
+      }
+    }
+
+    // The poses do not depend on the number of threads
+    vpDetectorAprilTag detector_threads(vpDetectorAprilTag::TAG_36h11);
+    detector_threads.setAprilTagNbThreads(4);
+    detector_threads.detect(I, tagSize, cam, cMo);
+    if (!checkPoses("4 threads", detector_threads, cMo, topLeft, cam, tagSize, poses)) {
+      return EXIT_FAILURE;
+    }
+    if (maxTranslationError(poses, poses_ref) > 0) {
+      std::cerr << "The poses depend on the number of threads" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Tracking mode: only the neighbourhood of the tags of the previous frame is searched
+    vpDetectorAprilTag detector_tracking(vpDetectorAprilTag::TAG_36h11);
+    detector_tracking.setAprilTagTrackingMode(true, 10);
+    double t_tracking = 0;
+    for (unsigned int frame = 0; frame < nbFrames; frame++) {
+      renderTags(I, 2 * frame, frame, topLeft);
+      double t = vpTime::measureTimeMs();
+      detector_tracking.detect(I, tagSize, cam, cMo);
+      t_tracking += vpTime::measureTimeMs() - t;
+      std::stringstream ss;
+      ss << "Tracking mode, frame " << frame;
+      if (!checkPoses(ss.str(), detector_tracking, cMo, topLeft, cam, tagSize, poses)) {
+        return EXIT_FAILURE;
+      }
+    }
+
+    // A tag that moves out of its region is found again by the full frame sweep
+    renderTags(I, 0, 0, topLeft);
+    detector_tracking.detect(I, tagSize, cam, cMo);
+    renderTags(I, 100, 100, topLeft);
+    for (unsigned int frame = 0; frame < 10; frame++) {
+      detector_tracking.detect(I, tagSize, cam, cMo);
+      if (detector_tracking.getNbObjects() == nbTags) {
+        break;
+      }
+    }
+    if (!checkPoses("Tracking mode after a jump", detector_tracking, cMo, topLeft, cam, tagSize, poses)) {
+      return EXIT_FAILURE;
+    }
+
+    std::cout << "Mean detection and pose time of " << nbTags << " tags in a " << I.getWidth() << "x"
+              << I.getHeight() << " image:" << std::endl;
+    std::cout << "  full frame: " << t_full / nbFrames << " ms" << std::endl;
+    std::cout << "  tracking mode with a full frame every 10 frames: " << t_tracking / nbFrames << " ms"
+              << std::endl;
+    return EXIT_SUCCESS;
+  } catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
+#else
+int main()
+{
+  std::cout << "Need ViSP AprilTag 3rd party" << std::endl;
+  return 0;
+}
+#endif
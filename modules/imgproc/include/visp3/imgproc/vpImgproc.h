@@ -73,9 +73,11 @@ namespace vp
   VISP_EXPORT void adjust(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2, const double alpha, const double beta);
 
   VISP_EXPORT void clahe(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, const int blockRadius=150,
-                         const int bins=256, const float slope=3.0f, const bool fast=true);
+                         const int bins=256, const float slope=3.0f, const bool fast=true,
+                         const unsigned int nbThreads=1);
   VISP_EXPORT void clahe(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2, const int blockRadius=150,
-                         const int bins=256, const float slope=3.0f, const bool fast=true);
+                         const int bins=256, const float slope=3.0f, const bool fast=true,
+                         const unsigned int nbThreads=1);
 
   VISP_EXPORT void equalizeHistogram(vpImage<unsigned char> &I);
   VISP_EXPORT void equalizeHistogram(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2);
@@ -81,46 +81,129 @@
   \brief Contrast Limited Adaptive Histogram Equalization (CLAHE).
 */
 
+#include <string.h>
+
 #include <visp3/imgproc/vpImgproc.h>
 #include <visp3/core/vpImageConvert.h>
 
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
+
 namespace {
   int fastRound(const float value) {
     return (int) (value + 0.5f);
   }
 
-  void clipHistogram(const std::vector<int> &hist, std::vector<int> &clippedHist, const int limit) {
-    clippedHist = hist;
-    int clippedEntries = 0, clippedEntriesBefore = 0;
-    int histlength = (int) hist.size();
+  // Bin of each gray level, computed once instead of at each pixel access
+  void computeBins(const int bins, int (&lut)[256]) {
+    for (int i = 0; i < 256; i++) {
+      lut[i] = fastRound(i / 255.0f * bins);
+    }
+  }
 
-    do {
-      clippedEntriesBefore = clippedEntries;
-      clippedEntries = 0;
-      for (int i = 0; i < histlength; i++) {
-        int d = clippedHist[i] - limit;
-        if (d > 0) {
-          clippedEntries += d;
-          clippedHist[i] = limit;
-        }
-      }
+  // hist[i] += column[i]
+  void addHistogram(int *hist, const int *column, const int histlength) {
+    int i = 0;
+#if VISP_HAVE_SSE2
+    for (const int histlength4 = histlength & ~3; i < histlength4; i += 4) {
+      __m128i sum = _mm_add_epi32(_mm_loadu_si128((const __m128i *) (hist + i)),
+                                  _mm_loadu_si128((const __m128i *) (column + i)));
+      _mm_storeu_si128((__m128i *) (hist + i), sum);
+    }
+#endif
+    for (; i < histlength; i++) {
+      hist[i] += column[i];
+    }
+  }
 
-      int d = clippedEntries / (histlength);
-      int m = clippedEntries % (histlength);
-      for (int i = 0; i < histlength; i++) {
-        clippedHist[i] += d;
+  // hist[i] -= column[i]
+  void subHistogram(int *hist, const int *column, const int histlength) {
+    int i = 0;
+#if VISP_HAVE_SSE2
+    for (const int histlength4 = histlength & ~3; i < histlength4; i += 4) {
+      __m128i diff = _mm_sub_epi32(_mm_loadu_si128((const __m128i *) (hist + i)),
+                                   _mm_loadu_si128((const __m128i *) (column + i)));
+      _mm_storeu_si128((__m128i *) (hist + i), diff);
+    }
+#endif
+    for (; i < histlength; i++) {
+      hist[i] -= column[i];
+    }
+  }
+
+  // dst[i] = min(src[i] + value, limit), return the sum of the clipped entries
+  int addAndClip(const int *src, int *dst, const int histlength, const int value, const int limit) {
+    int clippedEntries = 0;
+    int i = 0;
+#if VISP_HAVE_SSE2
+    const __m128i vvalue = _mm_set1_epi32(value), vlimit = _mm_set1_epi32(limit), zero = _mm_setzero_si128();
+    __m128i vclipped = _mm_setzero_si128();
+    for (const int histlength4 = histlength & ~3; i < histlength4; i += 4) {
+      __m128i v = _mm_add_epi32(_mm_loadu_si128((const __m128i *) (src + i)), vvalue);
+      __m128i d = _mm_sub_epi32(v, vlimit);
+      d = _mm_and_si128(d, _mm_cmpgt_epi32(d, zero));
+      vclipped = _mm_add_epi32(vclipped, d);
+      _mm_storeu_si128((__m128i *) (dst + i), _mm_sub_epi32(v, d));
+    }
+    int sums[4];
+    _mm_storeu_si128((__m128i *) sums, vclipped);
+    clippedEntries = sums[0] + sums[1] + sums[2] + sums[3];
+#endif
+    for (; i < histlength; i++) {
+      int v = src[i] + value;
+      int d = v - limit;
+      if (d > 0) {
+        clippedEntries += d;
+        v = limit;
       }
+      dst[i] = v;
+    }
+    return clippedEntries;
+  }
+
+  /*
+    Clip the histogram and redistribute the clipped entries until no entry is
+    clipped anymore. Return false if no bin exceeds the limit: the clipped
+    histogram is then the histogram itself.
+
+    The entries redistributed uniformly at one iteration are added during the
+    clipping of the next one, which gives the same result with a single pass
+    over the histogram per iteration.
+  */
+  bool clipHistogram(const int *hist, int *clippedHist, const int histlength, const int limit) {
+    int clippedEntries = addAndClip(hist, clippedHist, histlength, 0, limit), clippedEntriesBefore = 0;
+    if (clippedEntries == 0) {
+      return false;
+    }
 
+    int d = 0;
+    while (true) {
+      d = clippedEntries / (histlength);
+      int m = clippedEntries % (histlength);
       if (m != 0) {
         int s = (histlength - 1) / m;
         for (int i = s / 2; i < histlength; i += s) {
           ++(clippedHist[i]);
         }
       }
-    } while (clippedEntries != clippedEntriesBefore);
+
+      if (clippedEntries == clippedEntriesBefore) {
+        break;
+      }
+      clippedEntriesBefore = clippedEntries;
+      clippedEntries = addAndClip(clippedHist, clippedHist, histlength, d, limit);
+    }
+
+    for (int i = 0; i < histlength; i++) {
+      clippedHist[i] += d;
+    }
+
+    return true;
   }
 
-  void createHistogram(const int blockRadius, const int bins, const int blockXCenter,
+  void createHistogram(const int blockRadius, const int (&lut)[256], const int blockXCenter,
                        const int blockYCenter, const vpImage<unsigned char> &I,
                        std::vector<int> &hist) {
     std::fill(hist.begin(), hist.end(), 0);
@@ -131,14 +214,17 @@ namespace {
     int yMax = std::min( (int) I.getHeight(), blockYCenter + blockRadius + 1 );
 
     for (int y = yMin; y < yMax; ++y) {
+      const unsigned char *row = I[y];
       for (int x = xMin; x < xMax; ++x) {
-        ++hist[fastRound(I[y][x] / 255.0f * bins)];
+        ++hist[lut[row[x]]];
       }
     }
   }
 
-  std::vector<float> createTransfer(const std::vector<int> &hist, const int limit, std::vector<int> &cdfs) {
-    clipHistogram(hist, cdfs, limit);
+  void createTransfer(const std::vector<int> &hist, const int limit, std::vector<int> &cdfs, float *transfer) {
+    if (!clipHistogram(&hist[0], &cdfs[0], (int) hist.size(), limit)) {
+      cdfs = hist;
+    }
     int hMin = (int) hist.size() - 1;
 
     for (int i = 0; i < hMin; ++i) {
@@ -155,16 +241,12 @@ namespace {
     int cdfMin = cdfs[hMin];
     int cdfMax = cdfs[hist.size() - 1];
 
-    std::vector<float> transfer(hist.size());
-    for (int i = 0; i < (int) transfer.size(); ++i) {
+    for (int i = 0; i < (int) hist.size(); ++i) {
       transfer[i] = (cdfs[i] - cdfMin) / (float) (cdfMax - cdfMin);
     }
-
-    return transfer;
   }
 
-  float transferValue(const int v, std::vector<int> &clippedHist) {
-    int clippedHistLength = (int) clippedHist.size();
+  float transferValue(const int v, const int *clippedHist, const int clippedHistLength) {
     int hMin = clippedHistLength - 1;
     for (int i = 0; i < hMin; i++) {
       if (clippedHist[i] != 0) {
@@ -186,53 +268,27 @@ namespace {
     return (cdf - cdfMin) / (float) (cdfMax - cdfMin);
   }
 
-  float transferValue(const int v, const std::vector<int> &hist, std::vector<int> &clippedHist, const int limit) {
-    clipHistogram(hist, clippedHist, limit);
-
-    return transferValue(v, clippedHist);
-  }
-}
-
-/*!
-  \ingroup group_imgproc_brightness
-
-   Adjust the contrast of a grayscale image locally using the Contrast Limited Adaptative Histogram Equalization method.
-   The limit parameter allows to limit the slope of the transformation function to prevent the overamplification of noise.
-   This method is a transcription of the CLAHE ImageJ plugin code by Stephan Saalfeld.
-
-   \param I1 : The first grayscale image.
-   \param I2 : The second grayscale image after application of the CLAHE method.
-   \param blockRadius : The size (2*blockRadius+1) of the local region around a pixel for which the histogram is equalized.
-   This size should be larger than the size of features to be preserved.
-   \param bins : The number of histogram bins used for histogram equalization (between 1 and 256).
-   The number of histogram bins should be smaller than the number of pixels in a block.
-   \param slope : Limits the contrast stretch in the intensity transfer function.
-   Very large values will let the histogram equalization do whatever it wants to do, that is result in maximal local contrast.
-   The value 1 will result in the original image.
-   \param fast : Use the fast but less accurate version of the filter. The fast version does not evaluate the intensity
-   transfer function for each pixel independently but for a grid of adjacent boxes of the given block size only
-   and interpolates for locations in between.
-*/
-void vp::clahe(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, const int blockRadius,
-               const int bins, const float slope, const bool fast) {
-  if (blockRadius < 0) {
-    std::cerr << "Error: blockRadius < 0!" << std::endl;
-    return;
-  }
-
-  if (bins < 0 || bins > 256) {
-    std::cerr << "Error: (bins < 0 || bins > 256)!" << std::endl;
-    return;
-  }
-
-  if ((unsigned int) (2*blockRadius+1) > I1.getWidth() || (unsigned int) (2*blockRadius+1) > I1.getHeight()) {
-    std::cerr << "Error: (unsigned int) (2*blockRadius+1) > I1.getWidth() || (unsigned int) (2*blockRadius+1) > I1.getHeight()!" << std::endl;
-    return;
+  // Number of bands of rows processed in parallel
+  int getNbBands(const unsigned int nbThreads, const int nbRows) {
+#ifdef VISP_HAVE_OPENMP
+    if (nbThreads > 1 && nbRows > 1) {
+      return std::min((int) nbThreads, nbRows);
+    }
+#else
+    (void) nbThreads;
+    (void) nbRows;
+#endif
+    return 1;
   }
 
-  I2.resize(I1.getHeight(), I1.getWidth());
-
-  if (fast) {
+  /*
+    Evaluate the transfer functions on a grid of blocks and interpolate them
+    for the pixels in between. The cells between two rows of blocks are split
+    in bands processed in parallel; in a band, the transfer functions of a
+    row of blocks are computed once and shared by the cells above and below.
+  */
+  void claheFast(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, const int blockRadius,
+                 const int bins, const float slope, const unsigned int nbThreads) {
     int blockSize = 2 * blockRadius + 1;
     int limit = (int)( slope * blockSize * blockSize / bins + 0.5 );
 
@@ -297,159 +353,326 @@ void vp::clahe(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, con
       rs[nr + 1] = I1.getHeight() - blockRadius - 1;
     }
 
-    std::vector<int> hist((size_t) (bins+1));
-    std::vector<int> cdfs((size_t) (bins+1));
-    std::vector<float> tl;
-    std::vector<float> tr;
-    std::vector<float> br;
-    std::vector<float> bl;
-
-    for (int r = 0; r <= (int) rs.size(); ++r) {
-      int r0 = std::max(0, r - 1);
-      int r1 = std::min((int) rs.size() - 1, r);
-      int dr = rs[r1] - rs[r0];
-
-      createHistogram(blockRadius, bins, cs[0], rs[r0], I1, hist);
-      tr = createTransfer(hist, limit, cdfs);
-      if (r0 == r1) {
-        br = tr;
-      } else {
-        createHistogram(blockRadius, bins, cs[0], rs[r1], I1, hist);
-        br = createTransfer(hist, limit, cdfs);
+    const int length = bins + 1;
+    const int nbCols = (int) cs.size();
+    int lut[256];
+    computeBins(bins, lut);
+
+    // Interpolation weights of the columns and of the rows
+    std::vector<float> wxs(I1.getWidth(), 1.0f), wys(I1.getHeight(), 1.0f);
+    for (int c = 1; c < nbCols; ++c) {
+      int dc = cs[c] - cs[c - 1];
+      for (int x = cs[c - 1]; x < cs[c]; ++x) {
+        wxs[x] = (float) (cs[c] - x) / dc;
       }
+    }
+    for (int r = 1; r < (int) rs.size(); ++r) {
+      int dr = rs[r] - rs[r - 1];
+      for (int y = rs[r - 1]; y < rs[r]; ++y) {
+        wys[y] = (float) (rs[r] - y) / dr;
+      }
+    }
 
-      int yMin = (r == 0 ? 0 : rs[r0]);
-      int yMax = (r < (int) rs.size() ? rs[r1] : I1.getHeight());
-
-      for (int c = 0; c <= (int) cs.size(); ++c) {
-        int c0 = std::max(0, c - 1);
-        int c1 = std::min((int) cs.size() - 1, c);
-        int dc = cs[c1] - cs[c0];
-
-        tl = tr;
-        bl = br;
+    const int nbCellRows = (int) rs.size() + 1;
+    const int nbBands = getNbBands(nbThreads, nbCellRows);
 
-        if (c0 != c1) {
-          createHistogram(blockRadius, bins, cs[c1], rs[r0], I1, hist);
-          tr = createTransfer(hist, limit, cdfs);
-          if (r0 == r1) {
-            br = tr;
+#ifdef VISP_HAVE_OPENMP
+    #pragma omp parallel for num_threads(nbBands) if(nbBands > 1)
+#endif
+    for (int band = 0; band < nbBands; band++) {
+      std::vector<int> hist((size_t) length);
+      std::vector<int> cdfs((size_t) length);
+      // Transfer functions of the blocks of the rows above and below the cells
+      std::vector<float> top((size_t) (nbCols * length)), bottom((size_t) (nbCols * length));
+      int topRow = -1, bottomRow = -1;
+
+      for (int r = nbCellRows * band / nbBands; r < nbCellRows * (band + 1) / nbBands; ++r) {
+        int r0 = std::max(0, r - 1);
+        int r1 = std::min((int) rs.size() - 1, r);
+
+        if (topRow != r0) {
+          if (bottomRow == r0) {
+            top.swap(bottom);
+            std::swap(topRow, bottomRow);
           } else {
-            createHistogram(blockRadius, bins, cs[c1], rs[r1], I1, hist);
-            br = createTransfer(hist, limit, cdfs);
+            for (int c = 0; c < nbCols; ++c) {
+              createHistogram(blockRadius, lut, cs[c], rs[r0], I1, hist);
+              createTransfer(hist, limit, cdfs, &top[c * length]);
+            }
+            topRow = r0;
           }
         }
-
-        int xMin = (c == 0 ? 0 : cs[c0]);
-        int xMax = (c < (int) cs.size() ? cs[c1] : I1.getWidth());
-        for (int y = yMin; y < yMax; ++y) {
-          float wy = (float) (rs[r1] - y) / dr;
-
-          for (int x = xMin; x < xMax; ++x) {
-            float wx = (float) (cs[c1] - x) / dc;
-            int v = fastRound(I1[y][x] / 255.0f * bins);
-            float t00 = tl[v];
-            float t01 = tr[v];
-            float t10 = bl[v];
-            float t11 = br[v];
-            float t0 = 0.0f, t1 = 0.0f;
-
-            if (c0 == c1) {
-              t0 = t00;
-              t1 = t10;
-            } else {
-              t0 = wx * t00 + (1.0f - wx) * t01;
-              t1 = wx * t10 + (1.0f - wx) * t11;
+        if (r0 != r1 && bottomRow != r1) {
+          for (int c = 0; c < nbCols; ++c) {
+            createHistogram(blockRadius, lut, cs[c], rs[r1], I1, hist);
+            createTransfer(hist, limit, cdfs, &bottom[c * length]);
+          }
+          bottomRow = r1;
+        }
+        const float *trs = &top[0];
+        const float *brs = (r0 == r1) ? &top[0] : &bottom[0];
+
+        int yMin = (r == 0 ? 0 : rs[r0]);
+        int yMax = (r < (int) rs.size() ? rs[r1] : I1.getHeight());
+
+        for (int c = 0; c <= nbCols; ++c) {
+          int c0 = std::max(0, c - 1);
+          int c1 = std::min(nbCols - 1, c);
+
+          const float *tl = trs + c0 * length;
+          const float *tr = trs + c1 * length;
+          const float *bl = brs + c0 * length;
+          const float *br = brs + c1 * length;
+
+          int xMin = (c == 0 ? 0 : cs[c0]);
+          int xMax = (c < nbCols ? cs[c1] : I1.getWidth());
+          for (int y = yMin; y < yMax; ++y) {
+            float wy = wys[y];
+            const unsigned char *src = I1[y];
+            unsigned char *dst = I2[y];
+            int x = xMin;
+
+#if VISP_HAVE_SSE2
+            if (c0 != c1 && r0 != r1) {
+              // Interpolate four pixels at once between the four transfer functions
+              const __m128 one = _mm_set1_ps(1.0f), scale = _mm_set1_ps(255.0f), half = _mm_set1_ps(0.5f);
+              const __m128 vwy = _mm_set1_ps(wy), vwy1 = _mm_sub_ps(one, vwy);
+              for (; x + 4 <= xMax; x += 4) {
+                int v0 = lut[src[x]], v1 = lut[src[x + 1]], v2 = lut[src[x + 2]], v3 = lut[src[x + 3]];
+                __m128 wx = _mm_loadu_ps(&wxs[x]);
+                __m128 wx1 = _mm_sub_ps(one, wx);
+                __m128 t0 = _mm_add_ps(_mm_mul_ps(wx, _mm_setr_ps(tl[v0], tl[v1], tl[v2], tl[v3])),
+                                       _mm_mul_ps(wx1, _mm_setr_ps(tr[v0], tr[v1], tr[v2], tr[v3])));
+                __m128 t1 = _mm_add_ps(_mm_mul_ps(wx, _mm_setr_ps(bl[v0], bl[v1], bl[v2], bl[v3])),
+                                       _mm_mul_ps(wx1, _mm_setr_ps(br[v0], br[v1], br[v2], br[v3])));
+                __m128 t = _mm_add_ps(_mm_mul_ps(vwy, t0), _mm_mul_ps(vwy1, t1));
+                __m128i value = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(t, scale), half));
+                // Saturate to [0, 255]
+                value = _mm_packs_epi32(value, value);
+                value = _mm_packus_epi16(value, value);
+                int packed = _mm_cvtsi128_si32(value);
+                memcpy(dst + x, &packed, 4);
+              }
             }
+#endif
 
-            float t = (r0 == r1) ? t0 : wy * t0 + (1.0f - wy) * t1;
-            I2[y][x] = std::max( 0, std::min(255, fastRound(t * 255.0f)) );
+            for (; x < xMax; ++x) {
+              float wx = wxs[x];
+              int v = lut[src[x]];
+              float t00 = tl[v];
+              float t01 = tr[v];
+              float t10 = bl[v];
+              float t11 = br[v];
+              float t0 = 0.0f, t1 = 0.0f;
+
+              if (c0 == c1) {
+                t0 = t00;
+                t1 = t10;
+              } else {
+                t0 = wx * t00 + (1.0f - wx) * t01;
+                t1 = wx * t10 + (1.0f - wx) * t11;
+              }
+
+              float t = (r0 == r1) ? t0 : wy * t0 + (1.0f - wy) * t1;
+              dst[x] = (unsigned char) std::max( 0, std::min(255, fastRound(t * 255.0f)) );
+            }
           }
         }
       }
     }
-  } else {
-    std::vector<int> hist(bins+1), prev_hist(bins+1);
-    std::vector<int> clippedHist(bins+1);
-
-    bool first = true;
-    int xMin0 = 0;
-    int xMax0 = std::min((int) I1.getWidth(), blockRadius);
-
-    for (int y = 0; y < (int) I1.getHeight(); y++) {
-      int yMin = std::max(0, y - (int) blockRadius);
-      int yMax = std::min((int) I1.getHeight(), y + blockRadius + 1);
-      int h = yMax - yMin;
-
-#if 0
-      std::fill(hist.begin(), hist.end(), 0);
-      // Compute histogram for the current block
-      for (int yi = yMin; yi < yMax; yi++) {
-        for (int xi = xMin0; xi < xMax0; xi++) {
-          ++hist[fastRound(I1[yi][xi] / 255.0f * bins)];
-        }
-      }
-#else
-      if (first) {
-        first = false;
-        // Compute histogram for the block at (0,0)
-        for (int yi = yMin; yi < yMax; yi++) {
-          for (int xi = xMin0; xi < xMax0; xi++) {
-            ++hist[fastRound(I1[yi][xi] / 255.0f * bins)];
+  }
+
+  /*
+    Evaluate the transfer function of the block around each pixel. The block
+    histogram slides along the row: the column entering the block is added and
+    the column leaving it is removed. For large blocks, each column is itself
+    a histogram that slides down the image, so that sliding the block costs
+    2*(bins+1) additions whatever its size; for small blocks, the pixels of
+    the columns are counted directly. The rows are split in bands processed
+    in parallel, each band starting with its own histograms.
+  */
+  void claheExact(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, const int blockRadius,
+                  const int bins, const float slope, const unsigned int nbThreads) {
+    const int width = (int) I1.getWidth();
+    const int height = (int) I1.getHeight();
+    const int length = bins + 1;
+    const bool useColumnHistograms = 4 * (2 * blockRadius + 1) > length;
+    int lut[256];
+    computeBins(bins, lut);
+
+    const int nbBands = getNbBands(nbThreads, height);
+
+#ifdef VISP_HAVE_OPENMP
+    #pragma omp parallel for num_threads(nbBands) if(nbBands > 1)
+#endif
+    for (int band = 0; band < nbBands; band++) {
+      const int yBegin = height * band / nbBands;
+      const int yEnd = height * (band + 1) / nbBands;
+
+      std::vector<int> hist((size_t) length), prev_hist((size_t) length);
+      std::vector<int> clippedHist((size_t) length);
+      std::vector<int> columns(useColumnHistograms ? (size_t) width * length : 0);
+
+      int xMin0 = 0;
+      int xMax0 = std::min(width, blockRadius);
+
+      for (int y = yBegin; y < yEnd; y++) {
+        int yMin = std::max(0, y - (int) blockRadius);
+        int yMax = std::min(height, y + blockRadius + 1);
+        int h = yMax - yMin;
+
+        if (useColumnHistograms) {
+          if (y == yBegin) {
+            // Histograms of the columns for the first block of the band
+            for (int yi = yMin; yi < yMax; yi++) {
+              const unsigned char *row = I1[yi];
+              for (int xi = 0; xi < width; xi++) {
+                ++columns[(size_t) xi * length + lut[row[xi]]];
+              }
+            }
+          } else {
+            if (yMin > 0) {
+              // Sliding column histograms, remove top
+              const unsigned char *row = I1[yMin - 1];
+              for (int xi = 0; xi < width; xi++) {
+                --columns[(size_t) xi * length + lut[row[xi]]];
+              }
+            }
+
+            if (y + blockRadius < height) {
+              // Sliding column histograms, add bottom
+              const unsigned char *row = I1[yMax - 1];
+              for (int xi = 0; xi < width; xi++) {
+                ++columns[(size_t) xi * length + lut[row[xi]]];
+              }
+            }
           }
-        }
-      } else {
-        hist = prev_hist;
 
-        if (yMin > 0) {
-          int yMin1 = yMin - 1;
-          // Sliding histogram, remove top
+          std::fill(hist.begin(), hist.end(), 0);
           for (int xi = xMin0; xi < xMax0; xi++) {
-            --hist[fastRound(I1[yMin1][xi] / 255.0f * bins)];
+            addHistogram(&hist[0], &columns[(size_t) xi * length], length);
           }
-        }
+        } else {
+          if (y == yBegin) {
+            std::fill(hist.begin(), hist.end(), 0);
+            // Compute histogram for the first block of the band
+            for (int yi = yMin; yi < yMax; yi++) {
+              for (int xi = xMin0; xi < xMax0; xi++) {
+                ++hist[lut[I1[yi][xi]]];
+              }
+            }
+          } else {
+            hist = prev_hist;
+
+            if (yMin > 0) {
+              int yMin1 = yMin - 1;
+              // Sliding histogram, remove top
+              for (int xi = xMin0; xi < xMax0; xi++) {
+                --hist[lut[I1[yMin1][xi]]];
+              }
+            }
 
-        if (y + blockRadius < (int) I1.getHeight()) {
-          int yMax1 = yMax - 1;
-          // Sliding histogram, add bottom
-          for (int xi = xMin0; xi < xMax0; xi++) {
-            ++hist[fastRound(I1[yMax1][xi] / 255.0f * bins)];
+            if (y + blockRadius < height) {
+              int yMax1 = yMax - 1;
+              // Sliding histogram, add bottom
+              for (int xi = xMin0; xi < xMax0; xi++) {
+                ++hist[lut[I1[yMax1][xi]]];
+              }
+            }
           }
+          prev_hist = hist;
         }
-      }
-      prev_hist = hist;
-#endif
 
-      for (int x = 0; x < (int) I1.getWidth(); x++) {
-        int xMin = std::max(0, x - (int) blockRadius);
-        int xMax = x + blockRadius + 1;
-
-        if (xMin > 0) {
-          int xMin1 = xMin - 1;
-          // Sliding histogram, remove left
-          for (int yi = yMin; yi < yMax; yi++) {
-            --hist[fastRound(I1[yi][xMin1] / 255.0f * bins)];
+        const unsigned char *src = I1[y];
+        unsigned char *dst = I2[y];
+        for (int x = 0; x < width; x++) {
+          int xMin = std::max(0, x - (int) blockRadius);
+          int xMax = x + blockRadius + 1;
+
+          if (xMin > 0) {
+            int xMin1 = xMin - 1;
+            // Sliding histogram, remove left
+            if (useColumnHistograms) {
+              subHistogram(&hist[0], &columns[(size_t) xMin1 * length], length);
+            } else {
+              for (int yi = yMin; yi < yMax; yi++) {
+                --hist[lut[I1[yi][xMin1]]];
+              }
+            }
           }
-        }
 
-        if (xMax <= (int) I1.getWidth()) {
-          int xMax1 = xMax - 1;
-          // Sliding histogram, add right
-          for (int yi = yMin; yi < yMax; yi++) {
-            ++hist[fastRound(I1[yi][xMax1] / 255.0f * bins)];
+          if (xMax <= width) {
+            int xMax1 = xMax - 1;
+            // Sliding histogram, add right
+            if (useColumnHistograms) {
+              addHistogram(&hist[0], &columns[(size_t) xMax1 * length], length);
+            } else {
+              for (int yi = yMin; yi < yMax; yi++) {
+                ++hist[lut[I1[yi][xMax1]]];
+              }
+            }
           }
-        }
 
-        int v = fastRound(I1[y][x] / 255.0f * bins);
-        int w = std::min((int) I1.getWidth(), xMax) - xMin;
-        int n = h*w;
-        int limit = (int) (slope * n / bins + 0.5f);
-        I2[y][x] = fastRound(transferValue(v, hist, clippedHist, limit) * 255.0f);
+          int v = lut[src[x]];
+          int w = std::min(width, xMax) - xMin;
+          int n = h*w;
+          int limit = (int) (slope * n / bins + 0.5f);
+          const int *clipped = clipHistogram(&hist[0], &clippedHist[0], length, limit) ? &clippedHist[0] : &hist[0];
+          dst[x] = (unsigned char) fastRound(transferValue(v, clipped, length) * 255.0f);
+        }
       }
     }
   }
 }
 
+/*!
+  \ingroup group_imgproc_brightness
+
+   Adjust the contrast of a grayscale image locally using the Contrast Limited Adaptative Histogram Equalization method.
+   The limit parameter allows to limit the slope of the transformation function to prevent the overamplification of noise.
+   This method is a transcription of the CLAHE ImageJ plugin code by Stephan Saalfeld.
+
+   \param I1 : The first grayscale image.
+   \param I2 : The second grayscale image after application of the CLAHE method.
+   \param blockRadius : The size (2*blockRadius+1) of the local region around a pixel for which the histogram is equalized.
+   This size should be larger than the size of features to be preserved.
+   \param bins : The number of histogram bins used for histogram equalization (between 1 and 256).
+   The number of histogram bins should be smaller than the number of pixels in a block.
+   \param slope : Limits the contrast stretch in the intensity transfer function.
+   Very large values will let the histogram equalization do whatever it wants to do, that is result in maximal local contrast.
+   The value 1 will result in the original image.
+   \param fast : Use the fast but less accurate version of the filter. The fast version does not evaluate the intensity
+   transfer function for each pixel independently but for a grid of adjacent boxes of the given block size only
+   and interpolates for locations in between.
+   \param nbThreads : Number of threads that process bands of rows in parallel (requires OpenMP).
+   The result does not depend on the number of threads.
+*/
+void vp::clahe(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, const int blockRadius,
+               const int bins, const float slope, const bool fast, const unsigned int nbThreads) {
+  if (blockRadius < 0) {
+    std::cerr << "Error: blockRadius < 0!" << std::endl;
+    return;
+  }
+
+  if (bins < 0 || bins > 256) {
+    std::cerr << "Error: (bins < 0 || bins > 256)!" << std::endl;
+    return;
+  }
+
+  if ((unsigned int) (2*blockRadius+1) > I1.getWidth() || (unsigned int) (2*blockRadius+1) > I1.getHeight()) {
+    std::cerr << "Error: (unsigned int) (2*blockRadius+1) > I1.getWidth() || (unsigned int) (2*blockRadius+1) > I1.getHeight()!" << std::endl;
+    return;
+  }
+
+  I2.resize(I1.getHeight(), I1.getWidth());
+
+  if (fast) {
+    claheFast(I1, I2, blockRadius, bins, slope, nbThreads);
+  } else {
+    claheExact(I1, I2, blockRadius, bins, slope, nbThreads);
+  }
+}
+
 /*!
   \ingroup group_imgproc_brightness
 
@@ -469,9 +692,10 @@ void vp::clahe(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, con
   \param fast : Use the fast but less accurate version of the filter. The fast version does not evaluate the intensity
   transfer function for each pixel independently but for a grid of adjacent boxes of the given block size only
   and interpolates for locations in between.
+  \param nbThreads : Number of threads that process bands of rows of each channel in parallel (requires OpenMP).
 */
 void vp::clahe(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2, const int blockRadius,
-               const int bins, const float slope, const bool fast) {
+               const int bins, const float slope, const bool fast, const unsigned int nbThreads) {
   //Split
   vpImage<unsigned char> pR(I1.getHeight(), I1.getWidth());
   vpImage<unsigned char> pG(I1.getHeight(), I1.getWidth());
@@ -482,9 +706,9 @@ void vp::clahe(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2, const int blockRa
 
   //Apply CLAHE independently on RGB channels
   vpImage<unsigned char> resR, resG, resB;
-  clahe(pR, resR, blockRadius, bins, slope, fast);
-  clahe(pG, resG, blockRadius, bins, slope, fast);
-  clahe(pB, resB, blockRadius, bins, slope, fast);
+  clahe(pR, resR, blockRadius, bins, slope, fast, nbThreads);
+  clahe(pG, resG, blockRadius, bins, slope, fast, nbThreads);
+  clahe(pB, resB, blockRadius, bins, slope, fast, nbThreads);
 
   I2.resize(I1.getHeight(), I1.getWidth());
   unsigned int size = I2.getWidth()*I2.getHeight();
@@ -63,9 +63,70 @@
 
 #include <visp3/imgproc/vpImgproc.h>
 #include <visp3/core/vpMath.h>
-#include <visp3/core/vpHistogram.h>
 #include <visp3/core/vpImageConvert.h>
 #include <visp3/core/vpImageFilter.h>
+#include <visp3/core/vpImageHistogram.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+/*
+  Build the look-up table that equalizes a 256 bins histogram of nbPixels
+  pixels. Return false if there is only one brightness value, in which case
+  the look-up table is left unchanged.
+*/
+bool equalizationLut(const std::vector<unsigned int> &hist, const unsigned int nbPixels, unsigned char (&lut)[256]) {
+  //Calculate the cumulative distribution function
+  unsigned int cdf[256];
+  unsigned int cdfMin = /*std::numeric_limits<unsigned int>::max()*/ UINT_MAX, cdfMax = 0;
+  unsigned int minValue = /*std::numeric_limits<unsigned int>::max()*/ UINT_MAX, maxValue = 0;
+  cdf[0] = hist[0];
+
+  if(cdf[0] < cdfMin && cdf[0] > 0) {
+    cdfMin = cdf[0];
+    minValue = 0;
+  }
+
+  for(unsigned int i = 1; i < 256; i++) {
+    cdf[i] = cdf[i-1] + hist[i];
+
+    if(cdf[i] < cdfMin && cdf[i] > 0) {
+      cdfMin = cdf[i];
+      minValue = i;
+    }
+
+    if(cdf[i] > cdfMax) {
+      cdfMax = cdf[i];
+      maxValue = i;
+    }
+  }
+
+  if(nbPixels == cdfMin) {
+    //Only one brightness value in the image
+    return false;
+  }
+
+  //Construct the look-up table
+  for(unsigned int x = minValue; x <= maxValue; x++) {
+    lut[x] = vpMath::round( (cdf[x]-cdfMin) / (double) (nbPixels-cdfMin) * 255.0 );
+  }
+
+  return true;
+}
+
+//Smallest and greatest values with a non zero count in a 256 bins histogram
+void histogramRange(const std::vector<unsigned int> &hist, unsigned char &min, unsigned char &max) {
+  unsigned int first = 0, last = 255;
+  while(first < 255 && hist[first] == 0) {
+    first++;
+  }
+  while(last > first && hist[last] == 0) {
+    last--;
+  }
+  min = (unsigned char) first;
+  max = (unsigned char) last;
+}
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
 
 
 /*!
@@ -160,47 +221,13 @@ void vp::equalizeHistogram(vpImage<unsigned char> &I) {
   }
 
   //Calculate the histogram
-  vpHistogram hist;
-  hist.calculate(I);
-
-  //Calculate the cumulative distribution function
-  unsigned int cdf[256];
-  unsigned int cdfMin = /*std::numeric_limits<unsigned int>::max()*/ UINT_MAX, cdfMax = 0;
-  unsigned int minValue = /*std::numeric_limits<unsigned int>::max()*/ UINT_MAX, maxValue = 0;
-  cdf[0] = hist[0];
-
-  if(cdf[0] < cdfMin && cdf[0] > 0) {
-    cdfMin = cdf[0];
-    minValue = 0;
-  }
-
-  for(unsigned int i = 1; i < 256; i++) {
-    cdf[i] = cdf[i-1] + hist[i];
-
-    if(cdf[i] < cdfMin && cdf[i] > 0) {
-      cdfMin = cdf[i];
-      minValue = i;
-    }
+  std::vector<unsigned int> hist;
+  vpImageHistogram::calculate(I, hist);
 
-    if(cdf[i] > cdfMax) {
-      cdfMax = cdf[i];
-      maxValue = i;
-    }
-  }
-
-  unsigned int nbPixels = I.getWidth()*I.getHeight();
-  if(nbPixels == cdfMin) {
-    //Only one brightness value in the image
-    return;
-  }
-
-  //Construct the look-up table
   unsigned char lut[256];
-  for(unsigned int x = minValue; x <= maxValue; x++) {
-    lut[x] = vpMath::round( (cdf[x]-cdfMin) / (double) (nbPixels-cdfMin) * 255.0 );
+  if(equalizationLut(hist, I.getSize(), lut)) {
+    I.performLut(lut);
   }
-
-  I.performLut(lut);
 }
 
 /*!
@@ -235,41 +262,28 @@ void vp::equalizeHistogram(vpImage<vpRGBa> &I, const bool useHSV) {
   }
 
   if(!useHSV) {
-    //Split the RGBa image into 4 images
-    vpImage<unsigned char> pR(I.getHeight(), I.getWidth());
-    vpImage<unsigned char> pG(I.getHeight(), I.getWidth());
-    vpImage<unsigned char> pB(I.getHeight(), I.getWidth());
-    vpImage<unsigned char> pa(I.getHeight(), I.getWidth());
-
-    vpImageConvert::split(I, &pR, &pG, &pB, &pa);
-
-    //Apply histogram equalization for each channel
-    vp::equalizeHistogram(pR);
-    vp::equalizeHistogram(pG);
-    vp::equalizeHistogram(pB);
-
-    //Merge the result in I
-    unsigned int size = I.getWidth()*I.getHeight();
-    unsigned char *ptrStart = (unsigned char*) I.bitmap;
-    unsigned char *ptrEnd = ptrStart + size*4;
-    unsigned char *ptrCurrent = ptrStart;
-
-    unsigned int cpt = 0;
-    while(ptrCurrent != ptrEnd) {
-      *ptrCurrent = pR.bitmap[cpt];
-      ++ptrCurrent;
-
-      *ptrCurrent = pG.bitmap[cpt];
-      ++ptrCurrent;
-
-      *ptrCurrent = pB.bitmap[cpt];
-      ++ptrCurrent;
-
-      *ptrCurrent = pa.bitmap[cpt];
-      ++ptrCurrent;
-
-      cpt++;
+    //Histograms of the channels in a single pass
+    std::vector<unsigned int> histR, histG, histB, histA;
+    vpImageHistogram::calculate(I, histR, histG, histB, histA);
+
+    //Equalize each channel with its own look-up table, the alpha channel is kept
+    unsigned char lutR[256], lutG[256], lutB[256];
+    for(unsigned int i = 0; i < 256; i++) {
+      lutR[i] = lutG[i] = lutB[i] = (unsigned char) i;
     }
+    equalizationLut(histR, I.getSize(), lutR);
+    equalizationLut(histG, I.getSize(), lutG);
+    equalizationLut(histB, I.getSize(), lutB);
+
+    vpRGBa lut[256];
+    for(unsigned int i = 0; i < 256; i++) {
+      lut[i].R = lutR[i];
+      lut[i].G = lutG[i];
+      lut[i].B = lutB[i];
+      lut[i].A = (unsigned char) i;
+    }
+
+    I.performLut(lut);
   } else {
     vpImage<unsigned char> hue(I.getHeight(), I.getWidth());
     vpImage<unsigned char> saturation(I.getHeight(), I.getWidth());
@@ -439,31 +453,14 @@ void vp::stretchContrast(vpImage<vpRGBa> &I) {
   //Find min and max intensity values
   vpRGBa min = 255, max = 0;
 
-  //Split the RGBa image into 4 images
-  vpImage<unsigned char> pR(I.getHeight(), I.getWidth());
-  vpImage<unsigned char> pG(I.getHeight(), I.getWidth());
-  vpImage<unsigned char> pB(I.getHeight(), I.getWidth());
-  vpImage<unsigned char> pa(I.getHeight(), I.getWidth());
-
-  vpImageConvert::split(I, &pR, &pG, &pB, &pa);
-  //Min max values calculated for each channel
-  unsigned char minChannel, maxChannel;
-  pR.getMinMaxValue(minChannel, maxChannel);
-  min.R = minChannel;
-  max.R = maxChannel;
-
-  pG.getMinMaxValue(minChannel, maxChannel);
-  min.G = minChannel;
-  max.G = maxChannel;
-
-  pB.getMinMaxValue(minChannel, maxChannel);
-  min.B = minChannel;
-  max.B = maxChannel;
-
-  pa.getMinMaxValue(minChannel, maxChannel);
-  min.A = minChannel;
-  max.A = maxChannel;
+  //Min max values of each channel from their histograms, in a single pass
+  std::vector<unsigned int> histR, histG, histB, histA;
+  vpImageHistogram::calculate(I, histR, histG, histB, histA);
 
+  histogramRange(histR, min.R, max.R);
+  histogramRange(histG, min.G, max.G);
+  histogramRange(histB, min.B, max.B);
+  histogramRange(histA, min.A, max.A);
 
   //Construct the look-up table
   vpRGBa lut[256];
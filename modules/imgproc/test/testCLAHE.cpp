@@ -0,0 +1,193 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the sliding window and multi-threaded CLAHE.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testCLAHE.cpp
+
+  \brief Compare the exact CLAHE with a computation of the histogram of the
+  block around each pixel, and check that the result of the exact and fast
+  CLAHE does not depend on the number of threads.
+*/
+
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpTime.h>
+#include <visp3/imgproc/vpImgproc.h>
+
+namespace
+{
+unsigned int state = 12345;
+
+// Deterministic pseudo-random values
+unsigned int nextValue()
+{
+  state = state * 1103515245 + 12345;
+  return (state >> 8) & 0xffff;
+}
+
+// Low contrast image: a few gray level plateaus with some noise
+void fill(vpImage<unsigned char> &I)
+{
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    for (unsigned int j = 0; j < I.getWidth(); j++) {
+      I[i][j] = (unsigned char)(100 + 10 * ((i / 23 + j / 17) % 3) + nextValue() % 12);
+    }
+  }
+}
+
+// Exact CLAHE computed from the histogram of the block around each pixel
+void reference(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, int blockRadius, int bins, float slope)
+{
+  const int height = (int)I1.getHeight(), width = (int)I1.getWidth();
+  I2.resize(I1.getHeight(), I1.getWidth());
+  std::vector<int> hist((size_t)bins + 1);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      int yMin = std::max(0, y - blockRadius), yMax = std::min(height, y + blockRadius + 1);
+      int xMin = std::max(0, x - blockRadius), xMax = std::min(width, x + blockRadius + 1);
+      std::fill(hist.begin(), hist.end(), 0);
+      for (int i = yMin; i < yMax; i++) {
+        for (int j = xMin; j < xMax; j++) {
+          ++hist[(int)(I1[i][j] / 255.0f * bins + 0.5f)];
+        }
+      }
+
+      int length = bins + 1;
+      int limit = (int)(slope * (yMax - yMin) * (xMax - xMin) / bins + 0.5f);
+      int clippedEntries = 0, clippedEntriesBefore = 0;
+      do {
+        clippedEntriesBefore = clippedEntries;
+        clippedEntries = 0;
+        for (int i = 0; i < length; i++) {
+          if (hist[i] > limit) {
+            clippedEntries += hist[i] - limit;
+            hist[i] = limit;
+          }
+        }
+        for (int i = 0; i < length; i++) {
+          hist[i] += clippedEntries / length;
+        }
+        int m = clippedEntries % length;
+        if (m != 0) {
+          for (int i = ((length - 1) / m) / 2; i < length; i += (length - 1) / m) {
+            ++hist[i];
+          }
+        }
+      } while (clippedEntries != clippedEntriesBefore);
+
+      int v = (int)(I1[y][x] / 255.0f * bins + 0.5f);
+      int hMin = 0;
+      while (hMin < length - 1 && hist[hMin] == 0) {
+        hMin++;
+      }
+      int cdf = 0, cdfMax = 0;
+      for (int i = hMin; i < length; i++) {
+        if (i <= v) {
+          cdf += hist[i];
+        }
+        cdfMax += hist[i];
+      }
+      I2[y][x] = (unsigned char)((cdf - hist[hMin]) / (float)(cdfMax - hist[hMin]) * 255.0f + 0.5f);
+    }
+  }
+}
+
+bool compare(const vpImage<unsigned char> &I, const vpImage<unsigned char> &J, const std::string &name)
+{
+  if (I.getHeight() != J.getHeight() || I.getWidth() != J.getWidth()) {
+    std::cerr << name << ": wrong size" << std::endl;
+    return false;
+  }
+  for (unsigned int i = 0; i < I.getSize(); i++) {
+    if (I.bitmap[i] != J.bitmap[i]) {
+      std::cerr << name << ": pixel " << i << " is " << (int)I.bitmap[i] << " instead of " << (int)J.bitmap[i]
+                << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int main()
+{
+  vpImage<unsigned char> I(97, 131);
+  fill(I);
+
+  const int blockRadius[] = {2, 10, 40};
+  const int bins[] = {256, 17};
+  for (size_t r = 0; r < sizeof(blockRadius) / sizeof(blockRadius[0]); r++) {
+    for (size_t b = 0; b < sizeof(bins) / sizeof(bins[0]); b++) {
+      vpImage<unsigned char> ref, exact, fast, J;
+      reference(I, ref, blockRadius[r], bins[b], 3.0f);
+      vp::clahe(I, exact, blockRadius[r], bins[b], 3.0f, false);
+      if (!compare(exact, ref, "Exact CLAHE")) {
+        return EXIT_FAILURE;
+      }
+      vp::clahe(I, fast, blockRadius[r], bins[b], 3.0f, true);
+
+      const unsigned int nbThreads[] = {2, 3, 8};
+      for (size_t t = 0; t < sizeof(nbThreads) / sizeof(nbThreads[0]); t++) {
+        vp::clahe(I, J, blockRadius[r], bins[b], 3.0f, false, nbThreads[t]);
+        if (!compare(J, ref, "Multi-threaded exact CLAHE")) {
+          return EXIT_FAILURE;
+        }
+        vp::clahe(I, J, blockRadius[r], bins[b], 3.0f, true, nbThreads[t]);
+        if (!compare(J, fast, "Multi-threaded fast CLAHE")) {
+          return EXIT_FAILURE;
+        }
+      }
+    }
+  }
+
+  // Timing on a 1.3 MP image
+  vpImage<unsigned char> L(972, 1296), J;
+  fill(L);
+  const unsigned int nbThreads[] = {1, 4};
+  for (size_t t = 0; t < sizeof(nbThreads) / sizeof(nbThreads[0]); t++) {
+    double time = vpTime::measureTimeMs();
+    vp::clahe(L, J, 40, 256, 3.0f, false, nbThreads[t]);
+    std::cout << "Exact CLAHE with " << nbThreads[t] << " thread(s): " << vpTime::measureTimeMs() - time << " ms"
+              << std::endl;
+    time = vpTime::measureTimeMs();
+    vp::clahe(L, J, 150, 256, 3.0f, true, nbThreads[t]);
+    std::cout << "Fast CLAHE with " << nbThreads[t] << " thread(s): " << vpTime::measureTimeMs() - time << " ms"
+              << std::endl;
+  }
+
+  std::cout << "CLAHE is ok" << std::endl;
+  return EXIT_SUCCESS;
+}
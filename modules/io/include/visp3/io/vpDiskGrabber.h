@@ -104,6 +104,22 @@ int main(){
     g.acquire(I) ;
   }
 }
+\endcode
+
+  When the images are processed offline, reading and decoding them can take a large share of the
+  processing time. setPrefetch() enables a mode where background threads decode the next images
+  of the sequence into a ring of buffers while the current one is processed. The images are
+  still returned in order, the step and the seeks done with setImageNumber() or
+  acquire(I, image_number) are taken into account, and once the ring is filled the buffers are
+  recycled from one image to the other.
+\code
+  vpDiskGrabber g("/local/soft/ViSP/ViSP-images/cube/image.%04d.pgm");
+  g.setImageNumber(1);
+  g.setPrefetch(8, 2); // 8 images decoded in advance by 2 threads
+  for (unsigned int cpt = 0; cpt < 100; cpt++) {
+    g.acquire(I);
+    // process I
+  }
 \endcode
 */
 class VISP_EXPORT vpDiskGrabber  : public vpFrameGrabber
@@ -121,8 +137,14 @@ private:
   bool m_use_generic_name;
   std::string m_generic_name;
 
+  unsigned int m_prefetch_buffers; //!< number of images decoded in advance, 0 if disabled
+  unsigned int m_prefetch_threads; //!< number of decoding threads
+  class Prefetcher;
+  Prefetcher *m_prefetcher;
+
 public:
   vpDiskGrabber();
+  vpDiskGrabber(const vpDiskGrabber &g);
   explicit vpDiskGrabber(const std::string &genericName);
   explicit vpDiskGrabber(const std::string &dir, const std::string &basename,
                          long number, int step, unsigned int noz,
@@ -142,18 +164,31 @@ public:
     Return the current image number.
   */
   long getImageNumber() { return m_image_number; };
+  /*!
+    Return the number of images decoded in advance, 0 if the prefetch mode is disabled.
+
+    \sa setPrefetch()
+  */
+  unsigned int getPrefetchBufferCount() const { return m_prefetch_buffers; }
 
   void open(vpImage<unsigned char> &I) ;
   void open(vpImage<vpRGBa> &I) ;
   void open(vpImage<float> &I) ;
 
+  vpDiskGrabber &operator=(const vpDiskGrabber &g);
+
   void setBaseName(const std::string &name);
   void setDirectory(const std::string &dir);
   void setExtension(const std::string &ext);
   void setGenericName(const std::string &genericName);
   void setImageNumber(long number) ;
   void setNumberOfZero(unsigned int noz);
+  void setPrefetch(unsigned int nbBuffers, unsigned int nbThreads=1);
   void setStep(long step);
+
+private:
+  std::string getImageName(long number) const;
+  template<class Type> void read(vpImage<Type> &I);
 } ;
 
 #endif
@@ -0,0 +1,145 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Common definitions of the frame sequence container.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpFrameSequence.h
+  \brief Common definitions of the frame sequence container.
+*/
+
+#ifndef vpFrameSequence_h
+#define vpFrameSequence_h
+
+#include <stdint.h>
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpHomogeneousMatrix.h>
+
+/*!
+  \class vpFrameSequence
+
+  \ingroup group_io_video
+
+  \brief Common definitions of the frame sequence container written by
+  vpFrameSequenceWriter and read by vpFrameSequenceReader.
+
+  A frame sequence is a single file that stores raw grey level, RGBa, depth
+  (uint16_t) and float images with, for each frame, a timestamp, a camera id and
+  an optional pose. It is meant to record and replay sequences without creating a
+  file per image and without any image decoding.
+
+  All the values are stored in little endian. The file starts with a 64 bytes
+  header:
+  - the magic number "VPFRMSEQ" and the format version (1);
+  - the number of frames and the offset of the frame index. Both are 0 while the
+    file is written: the reader of a file that was not closed, for instance after
+    a crash, rebuilds the index by going through the frames.
+
+  Each frame is then a chunk made of a 192 bytes header (type, size, compression,
+  camera id, timestamp, pose, stored size) followed by the pixels. The chunks and
+  the pixels start on 64 bytes boundaries, so that uncompressed pixels can be used
+  in place once the file is memory-mapped. The pixels can optionally be compressed
+  with compressLZ4() in the LZ4 block format. The index that ends the file gives
+  the offset of each chunk.
+*/
+class VISP_EXPORT vpFrameSequence
+{
+public:
+  //! Type of the pixels of a frame
+  typedef enum {
+    GREY_FRAME = 0,  //!< vpImage<unsigned char>
+    RGBA_FRAME = 1,  //!< vpImage<vpRGBa>
+    DEPTH_FRAME = 2, //!< vpImage<uint16_t>
+    FLOAT_FRAME = 3  //!< vpImage<float>
+  } vpFrameType;
+
+  //! Compression of the pixels of a frame
+  typedef enum {
+    NO_COMPRESSION = 0, //!< Raw pixels
+    LZ4_COMPRESSION = 1 //!< Pixels compressed in the LZ4 block format
+  } vpCompressionType;
+
+  /*!
+    Metadata recorded with each frame.
+  */
+  struct vpFrameMetadata {
+    vpFrameMetadata() : timestamp(0.), cameraId(0), hasPose(false), pose() {}
+
+    double timestamp;         //!< Acquisition time of the frame
+    unsigned int cameraId;    //!< Id of the camera that acquired the frame
+    bool hasPose;             //!< True if pose is set
+    vpHomogeneousMatrix pose; //!< Pose associated to the frame, for instance the camera pose cMw
+  };
+
+  static size_t compressLZ4(const unsigned char *src, const size_t size, unsigned char *dst, const size_t capacity);
+  static size_t decompressLZ4(const unsigned char *src, const size_t size, unsigned char *dst, const size_t capacity);
+  /*!
+    Return the size of the buffer that compressLZ4() needs in the worst case to compress \e size bytes.
+  */
+  static inline size_t getLZ4Bound(const size_t size) { return size + size / 255 + 16; }
+  static unsigned int getPixelSize(const vpFrameType &type);
+
+protected:
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+  enum {
+    FILE_HEADER_SIZE = 64,
+    FRAME_HEADER_SIZE = 192,
+    BLOCK_ALIGNMENT = 64
+  };
+
+  //! Content of the header of a frame
+  struct vpFrameHeader {
+    vpFrameHeader() : type(GREY_FRAME), width(0), height(0), compression(NO_COMPRESSION), storedSize(0),
+      offset(0), metadata() {}
+
+    vpFrameType type;
+    unsigned int width;
+    unsigned int height;
+    vpCompressionType compression;
+    uint64_t storedSize; //!< Size of the stored pixels, in bytes
+    uint64_t offset;     //!< Offset of the frame header in the file
+    vpFrameMetadata metadata;
+  };
+
+  static uint64_t alignOffset(const uint64_t offset);
+  static void encodeFileHeader(const uint64_t frameCount, const uint64_t indexOffset, unsigned char *data);
+  static bool decodeFileHeader(const unsigned char *data, uint64_t &frameCount, uint64_t &indexOffset);
+  static void encodeFrameHeader(const vpFrameHeader &header, unsigned char *data);
+  static bool decodeFrameHeader(const unsigned char *data, vpFrameHeader &header);
+  static void loadUInt64(const unsigned char *data, uint64_t &value);
+  static void storeUInt64(unsigned char *data, const uint64_t value);
+#endif
+};
+
+#endif
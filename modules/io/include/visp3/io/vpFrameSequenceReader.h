@@ -0,0 +1,152 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Read a frame sequence container.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpFrameSequenceReader.h
+  \brief Read a frame sequence container.
+*/
+
+#ifndef vpFrameSequenceReader_h
+#define vpFrameSequenceReader_h
+
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpMemoryMappedFile.h>
+#include <visp3/core/vpRGBa.h>
+#include <visp3/io/vpFrameSequence.h>
+
+/*!
+  \class vpFrameSequenceReader
+
+  \ingroup group_io_video
+
+  \brief Replay a frame sequence file written by vpFrameSequenceWriter (see
+  vpFrameSequence).
+
+  The file is memory-mapped and any frame can be read in constant time. By
+  default the frames that are not compressed are not copied: the image read by
+  read() points to the mapped pixels. Such an image stays valid until the reader is
+  closed or destroyed; it can be modified without modifying the file, but the
+  modification is then seen by the next read of the same frame. setZeroCopy(false)
+  makes read() always copy the pixels in the image.
+
+  A file that was not closed by the writer, for instance after a crash, is still
+  read: the frame index is rebuilt by going through the frames.
+
+  \code
+#include <visp3/io/vpFrameSequenceReader.h>
+
+int main()
+{
+  vpFrameSequenceReader reader("session.vpseq");
+  vpImage<vpRGBa> I_color;
+  vpImage<uint16_t> I_depth;
+  for (unsigned int i = 0; i < reader.getFrameCount(); i++) {
+    vpFrameSequence::vpFrameMetadata metadata = reader.getMetadata(i);
+    if (reader.getFrameType(i) == vpFrameSequence::DEPTH_FRAME) {
+      reader.read(I_depth, i);
+    }
+    else {
+      reader.read(I_color, i);
+    }
+  }
+}
+  \endcode
+*/
+class VISP_EXPORT vpFrameSequenceReader : public vpFrameSequence
+{
+public:
+  vpFrameSequenceReader();
+  explicit vpFrameSequenceReader(const std::string &filename);
+  virtual ~vpFrameSequenceReader();
+
+  void close();
+
+  /*!
+    Return the number of frames of the file.
+  */
+  inline unsigned int getFrameCount() const { return (unsigned int) m_frames.size(); }
+  vpFrameType getFrameType(const unsigned int index) const;
+  unsigned int getHeight(const unsigned int index) const;
+  vpFrameMetadata getMetadata(const unsigned int index) const;
+  unsigned int getWidth(const unsigned int index) const;
+  /*!
+    Return true if the uncompressed frames are read without copy.
+  */
+  inline bool getZeroCopy() const { return m_zeroCopy; }
+  /*!
+    Return true if a file is open.
+  */
+  inline bool isOpen() const { return m_file.isOpen(); }
+
+  void open(const std::string &filename);
+
+  void read(vpImage<unsigned char> &I, const unsigned int index);
+  void read(vpImage<vpRGBa> &I, const unsigned int index);
+  void read(vpImage<uint16_t> &I, const unsigned int index);
+  void read(vpImage<float> &I, const unsigned int index);
+
+  /*!
+    Enable or disable the zero-copy read of the uncompressed frames. It is enabled by default.
+  */
+  inline void setZeroCopy(const bool zeroCopy) { m_zeroCopy = zeroCopy; }
+
+private:
+  // A mapping cannot be shared between two objects
+  vpFrameSequenceReader(const vpFrameSequenceReader &);
+  vpFrameSequenceReader &operator=(const vpFrameSequenceReader &);
+
+  const vpFrameHeader &getHeader(const unsigned int index) const;
+  static bool hasValidSize(const vpFrameHeader &header);
+  void readIndex();
+  void rebuildIndex();
+  template<class Type> void readFrame(vpImage<Type> &I, const vpFrameHeader &header);
+
+  //! Mapped file
+  vpMemoryMappedFile m_file;
+  //! Name of the mapped file
+  std::string m_filename;
+  //! Header of each frame
+  std::vector<vpFrameHeader> m_frames;
+  //! True if the uncompressed frames are read without copy
+  bool m_zeroCopy;
+  //! Frame read before a conversion to the requested image type
+  vpImage<unsigned char> m_grey;
+  vpImage<vpRGBa> m_color;
+};
+
+#endif
@@ -0,0 +1,144 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Write a frame sequence container.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpFrameSequenceWriter.h
+  \brief Write a frame sequence container.
+*/
+
+#ifndef vpFrameSequenceWriter_h
+#define vpFrameSequenceWriter_h
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpRGBa.h>
+#include <visp3/io/vpFrameSequence.h>
+
+/*!
+  \class vpFrameSequenceWriter
+
+  \ingroup group_io_video
+
+  \brief Record raw grey level, RGBa, depth and float images with their metadata
+  in a single frame sequence file (see vpFrameSequence), to be replayed with
+  vpFrameSequenceReader or vpVideoReader.
+
+  The frames of several cameras and of different types can be interleaved in the
+  same file. With setCompression(vpFrameSequence::LZ4_COMPRESSION), the pixels
+  of each frame are compressed if it makes them smaller.
+
+  \code
+#include <visp3/io/vpFrameSequenceWriter.h>
+
+int main()
+{
+  vpImage<vpRGBa> I_color(480, 640);
+  vpImage<uint16_t> I_depth(480, 640);
+
+  vpFrameSequenceWriter writer("session.vpseq");
+  writer.setCompression(vpFrameSequence::LZ4_COMPRESSION);
+  for (unsigned int i = 0; i < 100; i++) {
+    // Acquire I_color and I_depth
+    vpFrameSequence::vpFrameMetadata metadata;
+    metadata.timestamp = vpTime::measureTimeMs();
+    metadata.cameraId = 0;
+    writer.write(I_color, metadata);
+    metadata.cameraId = 1;
+    writer.write(I_depth, metadata);
+  }
+  writer.close();
+}
+  \endcode
+*/
+class VISP_EXPORT vpFrameSequenceWriter : public vpFrameSequence
+{
+public:
+  vpFrameSequenceWriter();
+  explicit vpFrameSequenceWriter(const std::string &filename);
+  virtual ~vpFrameSequenceWriter();
+
+  void close();
+
+  /*!
+    Return the compression of the frames.
+  */
+  inline vpCompressionType getCompression() const { return m_compression; }
+  /*!
+    Return the number of frames written in the file.
+  */
+  inline unsigned int getFrameCount() const { return (unsigned int) m_offsets.size(); }
+  /*!
+    Return true if a file is open.
+  */
+  inline bool isOpen() const { return m_file.is_open(); }
+
+  void open(const std::string &filename);
+  /*!
+    Set the compression of the next frames. By default the frames are not compressed.
+  */
+  inline void setCompression(const vpCompressionType &compression) { m_compression = compression; }
+
+  void write(const vpImage<unsigned char> &I, const vpFrameMetadata &metadata = vpFrameMetadata());
+  void write(const vpImage<vpRGBa> &I, const vpFrameMetadata &metadata = vpFrameMetadata());
+  void write(const vpImage<uint16_t> &I, const vpFrameMetadata &metadata = vpFrameMetadata());
+  void write(const vpImage<float> &I, const vpFrameMetadata &metadata = vpFrameMetadata());
+
+private:
+  // A file cannot be written by two objects
+  vpFrameSequenceWriter(const vpFrameSequenceWriter &);
+  vpFrameSequenceWriter &operator=(const vpFrameSequenceWriter &);
+
+  void writeFrame(const vpFrameType &type, const unsigned int width, const unsigned int height,
+                  const unsigned char *data, const vpFrameMetadata &metadata);
+  void writePadding(const uint64_t offset);
+
+  //! File being written
+  std::ofstream m_file;
+  //! Name of the file being written
+  std::string m_filename;
+  //! Offset of the header of each frame
+  std::vector<uint64_t> m_offsets;
+  //! Current position in the file
+  uint64_t m_position;
+  //! Compression of the frames
+  vpCompressionType m_compression;
+  //! Compressed pixels, kept from one frame to the other
+  std::vector<unsigned char> m_buffer;
+};
+
+#endif
@@ -50,8 +50,11 @@
 #include <visp3/core/vpRGBa.h>
 #include <visp3/core/vpImageConvert.h>
 
+#include <stdint.h>
 #include <stdio.h>
 #include <iostream>
+#include <string>
+#include <vector>
 
 #if defined(_WIN32)
 // Include WinSock2.h before windows.h to ensure that winsock.h is not included by windows.h 
@@ -77,7 +80,11 @@
 
   \brief Read/write images with various image format.
 
-  This class has its own implementation of PGM and PPM images read/write.
+  This class has its own implementation of PGM and PPM images read/write. The
+  header is parsed directly from the file and the pixels are read or written with a
+  single call. 16 bits PGM images, for instance depth images, are handled by
+  readPGM(vpImage<uint16_t> &, const std::string &) and
+  writePGM(const vpImage<uint16_t> &, const std::string &).
 
   This class may benefit from optional 3rd parties:
   - libpng: If installed this optional 3rd party is used to read/write PNG images.
@@ -112,6 +119,35 @@ int main()
 }
   \endcode
 
+  readBatch() and writeBatch() read or write a list of images with several threads
+  when ViSP is built with OpenMP. Each image is decoded or encoded by its own codec
+  context, an error on one file is reported for this file without stopping the batch,
+  and an optional callback follows the progress.
+
+  \code
+#include <visp3/io/vpImageIo.h>
+
+void progress(unsigned int nbProcessed, unsigned int nbImages, const std::string &filename, bool success, void *)
+{
+  std::cout << nbProcessed << "/" << nbImages << " " << filename << (success ? "" : " failed") << std::endl;
+}
+
+int main()
+{
+  std::vector<std::string> filenames;
+  filenames.push_back("image0001.jpg");
+  filenames.push_back("image0002.jpg");
+
+  std::vector<vpImage<unsigned char> > I;
+  std::vector<std::string> errors;
+  unsigned int nbRead = vpImageIo::readBatch(I, filenames, errors, 0, progress);
+  for (size_t i = 0; i < errors.size(); i++) {
+    if (! errors[i].empty())
+      std::cout << "Cannot read " << filenames[i] << ": " << errors[i] << std::endl;
+  }
+}
+  \endcode
+
   This other example available in tutorial-image-reader.cpp shows how to read/write
   jpeg images. It supposes that \c libjpeg is installed.
   \include tutorial-image-reader.cpp
@@ -142,6 +178,17 @@ private:
   static std::string getExtension(const std::string &filename);
 
 public:
+  /*!
+    Function called by the batch functions each time an image is processed.
+
+    \param nbProcessed : Number of images of the batch already processed, including this one.
+    \param nbImages : Number of images of the batch.
+    \param filename : Name of the file that was read or written.
+    \param success : True if the image was read or written.
+    \param data : Pointer given to the batch function.
+  */
+  typedef void (*vpBatchProgressCallback)(unsigned int nbProcessed, unsigned int nbImages,
+                                          const std::string &filename, bool success, void *data);
 
   static void read(vpImage<unsigned char> &I, const std::string &filename) ;
   static void read(vpImage<vpRGBa> &I, const std::string &filename) ;
@@ -149,9 +196,25 @@ public:
   static void write(const vpImage<unsigned char> &I, const std::string &filename) ;
   static void write(const vpImage<vpRGBa> &I, const std::string &filename) ;
 
+  static unsigned int readBatch(std::vector<vpImage<unsigned char> > &I, const std::vector<std::string> &filenames,
+                                std::vector<std::string> &errors, unsigned int nbThreads = 0,
+                                vpBatchProgressCallback callback = NULL, void *data = NULL);
+  static unsigned int readBatch(std::vector<vpImage<vpRGBa> > &I, const std::vector<std::string> &filenames,
+                                std::vector<std::string> &errors, unsigned int nbThreads = 0,
+                                vpBatchProgressCallback callback = NULL, void *data = NULL);
+
+  static unsigned int writeBatch(const std::vector<vpImage<unsigned char> > &I,
+                                 const std::vector<std::string> &filenames, std::vector<std::string> &errors,
+                                 unsigned int nbThreads = 0, vpBatchProgressCallback callback = NULL,
+                                 void *data = NULL);
+  static unsigned int writeBatch(const std::vector<vpImage<vpRGBa> > &I, const std::vector<std::string> &filenames,
+                                 std::vector<std::string> &errors, unsigned int nbThreads = 0,
+                                 vpBatchProgressCallback callback = NULL, void *data = NULL);
+
   static void readPFM(vpImage<float> &I, const std::string &filename) ;
 
   static void readPGM(vpImage<unsigned char> &I, const std::string &filename) ;
+  static void readPGM(vpImage<uint16_t> &I, const std::string &filename) ;
   static void readPGM(vpImage<vpRGBa> &I, const std::string &filename) ;
 
   static void readPPM(vpImage<unsigned char> &I, const std::string &filename) ;
@@ -171,6 +234,7 @@ public:
 
   static void writePGM(const vpImage<unsigned char> &I, const std::string &filename) ;
   static void writePGM(const vpImage<short> &I, const std::string &filename) ;
+  static void writePGM(const vpImage<uint16_t> &I, const std::string &filename) ;
   static void writePGM(const vpImage<vpRGBa> &I, const std::string &filename) ;
 
   static void writePPM(const vpImage<unsigned char> &I, const std::string &filename) ;
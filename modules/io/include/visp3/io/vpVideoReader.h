@@ -48,6 +48,7 @@
 #include <string>
 
 #include <visp3/io/vpDiskGrabber.h>
+#include <visp3/io/vpFrameSequenceReader.h>
 
 #if VISP_HAVE_OPENCV_VERSION >= 0x020200
 #include "opencv2/highgui/highgui.hpp"
@@ -64,7 +65,9 @@
   images. As it inherits from the vpFrameGrabber Class, it can be used like an
   other frame grabber class.
 
-  This class has its own implementation to read a sequence of PGM and PPM images.
+  This class has its own implementation to read a sequence of PGM and PPM images, and
+  to read the grey level and color frames of a frame sequence file (.vpseq extension)
+  recorded with vpFrameSequenceWriter or vpVideoWriter.
 
   This class may benefit from optional 3rd parties:
   - libpng: If installed this optional 3rd party is used to read a sequence of PNG images.
@@ -161,6 +164,17 @@ int main()
   return 0;
 }
   \endcode
+
+  When a sequence of images is processed offline, setPrefetch() allows to read and decode
+  the next images in background threads while the current one is processed (see
+  vpDiskGrabber::setPrefetch()).
+  \code
+  reader.setFileName("./image/image%04d.jpeg");
+  reader.setPrefetch(8, 2); // 8 images decoded in advance by 2 threads
+  reader.open(I);
+  while (! reader.end() )
+    reader.acquire(I);
+  \endcode
 */
 
 class VISP_EXPORT vpVideoReader : public vpFrameGrabber
@@ -168,6 +182,10 @@ class VISP_EXPORT vpVideoReader : public vpFrameGrabber
 private:
     //!To read sequences of images
     vpDiskGrabber *imSequence;
+    //!To read frame sequence files
+    vpFrameSequenceReader *frameSequence;
+    //!Index of the next frame read from a frame sequence file
+    long frameSequenceNext;
 #if VISP_HAVE_OPENCV_VERSION >= 0x020100
     //!To read video files with OpenCV
     cv::VideoCapture capture;
@@ -196,6 +214,8 @@ private:
       FORMAT_WMV,
       FORMAT_FLV,
       FORMAT_MKV,
+      // Frame sequence file
+      FORMAT_FRAME_SEQUENCE,
       FORMAT_UNKNOWN
     } vpVideoFormatType;
 
@@ -219,6 +239,10 @@ private:
     //!The frame step
     long frameStep;
     double frameRate;
+    //!Number of images of a sequence decoded in advance
+    unsigned int prefetchBuffers;
+    //!Number of threads that decode the images of a sequence in advance
+    unsigned int prefetchThreads;
 
 //private:
 //#ifndef DOXYGEN_SHOULD_SKIP_THIS
@@ -329,6 +353,7 @@ public:
     inline void resetFrameCounter() {frameCount = firstFrame;}
     void setFileName(const char *filename);
     void setFileName(const std::string &filename);
+    void setPrefetch(unsigned int nbBuffers, unsigned int nbThreads=1);
     /*!
       Enables to set the first frame index if you want to use the class like a grabber (ie with the
       acquire method).
@@ -375,6 +400,8 @@ private:
     long extractImageIndex(const std::string &imageName, const std::string &format);
     bool checkImageNameFormat(const std::string &format);
     void getProperties();
+    template<class Type> void acquireFrameSequence(vpImage<Type> &I);
+    template<class Type> bool getFrameSequenceFrame(vpImage<Type> &I, long frame);
 };
 
 #endif
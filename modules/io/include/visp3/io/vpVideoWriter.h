@@ -46,6 +46,7 @@
 
 #include <string>
 
+#include <visp3/io/vpFrameSequenceWriter.h>
 #include <visp3/io/vpImageIo.h>
 
 #if VISP_HAVE_OPENCV_VERSION >= 0x020200
@@ -62,7 +63,9 @@
 
   \brief Class that enables to write easily a video file or a sequence of images.
 
-  This class has its own implementation to write a sequence of PGM and PPM images.
+  This class has its own implementation to write a sequence of PGM and PPM images, and
+  to record grey level and color frames in a frame sequence file (.vpseq extension) that
+  can be replayed with vpVideoReader or vpFrameSequenceReader.
 
   This class may benefit from optional 3rd parties:
   - libpng: If installed this optional 3rd party is used to write a sequence of PNG images.
@@ -166,6 +169,7 @@ class VISP_EXPORT vpVideoWriter
       FORMAT_MPEG,
       FORMAT_MPEG4,
       FORMAT_MOV,
+      FORMAT_FRAME_SEQUENCE,
       FORMAT_UNKNOWN
     } vpVideoFormatType;
 
@@ -191,6 +195,12 @@ class VISP_EXPORT vpVideoWriter
     unsigned int width;
     unsigned int height;
 
+    //!To write frame sequence files
+    vpFrameSequenceWriter *frameSequence;
+
+    vpVideoWriter(const vpVideoWriter &);
+    vpVideoWriter &operator=(const vpVideoWriter &);
+
   public:
     vpVideoWriter();
     ~vpVideoWriter();
@@ -41,6 +41,12 @@
   \brief Read/write images
 */
 
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdlib.h> //strtoul
+#include <string.h> //memcpy
+#include <vector>
+
 #include <visp3/core/vpImage.h>
 #include <visp3/io/vpImageIo.h>
 #include <visp3/core/vpImageConvert.h> //image  conversion
@@ -50,6 +56,145 @@ void vp_decodeHeaderPNM(const std::string &filename, std::ifstream &fd, const st
                      unsigned int &w, unsigned int &h, unsigned int &maxval);
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+  /*!
+   * Read the next token of a PNM header, skipping white spaces and comments. The
+   * white space that ends the token is also read, so that after the last token of
+   * the header the stream is positioned on the first byte of the raster.
+   * \param fd[in] : File desdcriptor.
+   * \param token[out] : Token read.
+   * \return false if the end of the file is reached before a token.
+   */
+  bool vp_readTokenPNM(std::ifstream &fd, std::string &token)
+  {
+    token.clear();
+    int c = fd.get();
+    for (;;) {
+      if (c == std::char_traits<char>::eof()) {
+        return false;
+      }
+      if (c == '#') {
+        // A comment goes up to the end of the line
+        while (c != '\n' && c != '\r' && c != std::char_traits<char>::eof()) {
+          c = fd.get();
+        }
+        continue;
+      }
+      if (c != ' ' && c != '\t' && c != '\n' && c != '\r' && c != '\v' && c != '\f') {
+        break;
+      }
+      c = fd.get();
+    }
+
+    while (c != ' ' && c != '\t' && c != '\n' && c != '\r' && c != '\v' && c != '\f' &&
+           c != std::char_traits<char>::eof()) {
+      if (c == '#') {
+        fd.unget();
+        break;
+      }
+      token += (char) c;
+      c = fd.get();
+    }
+    return true;
+  }
+
+  /*!
+   * Open a PNM file and decode its header, checking the size and the maximum value.
+   */
+  void vp_openPNM(const std::string &filename, std::ifstream &fd, const std::string &magic,
+                  unsigned int &w, unsigned int &h, const unsigned int maxval_max, unsigned int &maxval)
+  {
+    const unsigned int w_max = 100000, h_max = 100000;
+
+    fd.open(filename.c_str(), std::ios::binary);
+    // Open the filename
+    if(! fd.is_open()) {
+      throw (vpImageException(vpImageException::ioError, "Cannot open file \"%s\"", filename.c_str())) ;
+    }
+
+    vp_decodeHeaderPNM(filename, fd, magic, w, h, maxval);
+
+    if (w > w_max || h > h_max) {
+      fd.close();
+      throw(vpException(vpException::badValue, "Bad image size in \"%s\"",  filename.c_str()));
+    }
+    if (maxval > maxval_max || maxval == 0)
+    {
+      fd.close();
+      throw (vpImageException(vpImageException::ioError,
+                              "Bad maxval in \"%s\"",  filename.c_str()));
+    }
+  }
+
+  /*!
+   * Read the raster of a PNM file in a single call.
+   */
+  void vp_readRasterPNM(const std::string &filename, std::ifstream &fd, void *data, const size_t nbyte)
+  {
+    fd.read((char *)data, (std::streamsize) nbyte);
+    if (! fd) {
+      fd.close();
+      throw (vpImageException(vpImageException::ioError,
+                              "Read only %d of %d bytes in file \"%s\"", (int) fd.gcount(), (int) nbyte, filename.c_str()));
+    }
+    fd.close();
+  }
+
+  /*!
+   * Write a PNM file with its header and its raster in a single call.
+   */
+  void vp_writePNM(const std::string &filename, const std::string &type, const std::string &magic,
+                   unsigned int w, unsigned int h, unsigned int maxval, const void *data, const size_t nbyte)
+  {
+    // Test the filename
+    if (filename.empty())   {
+      throw (vpImageException(vpImageException::ioError,
+             "Cannot create %s file: filename empty", type.c_str())) ;
+    }
+
+    FILE *fd = fopen(filename.c_str(), "wb");
+
+    if (fd == NULL) {
+      throw (vpImageException(vpImageException::ioError,
+             "Cannot create %s file \"%s\"", type.c_str(), filename.c_str())) ;
+    }
+
+    // Write the head
+    fprintf(fd, "%s\n", magic.c_str());  // Magic number
+    fprintf(fd, "%u %u\n", w, h);        // Image size
+    fprintf(fd, "%u\n", maxval);         // Max level
+
+    // Write the bitmap
+    size_t ierr = fwrite(data, 1, nbyte, fd) ;
+    if (ierr != nbyte) {
+      fclose(fd);
+      throw (vpImageException(vpImageException::ioError,
+             "Cannot save %s file \"%s\": only %d over %d bytes saved", type.c_str(), filename.c_str(),
+             (int) ierr, (int) nbyte)) ;
+    }
+
+    fflush(fd);
+    fclose(fd);
+  }
+
+  //Return true on little endian architectures, where the 16 bits samples of a PGM file are swapped
+  bool vp_isLittleEndian()
+  {
+    const uint16_t value = 1;
+    unsigned char byte;
+    memcpy(&byte, &value, 1);
+    return byte == 1;
+  }
+
+  //Swap the bytes of 16 bits samples
+  void vp_swapBytes16(const uint16_t *src, uint16_t *dst, const size_t size)
+  {
+    for (size_t i = 0; i < size; i++) {
+      dst[i] = (uint16_t) ((src[i] >> 8) | (src[i] << 8));
+    }
+  }
+}
+
 /*!
  * Decode the PNM image header.
  * \param filename[in] : File name.
@@ -61,55 +206,33 @@ void vp_decodeHeaderPNM(const std::string &filename, std::ifstream &fd, const st
  */
 void vp_decodeHeaderPNM(const std::string &filename, std::ifstream &fd, const std::string &magic, unsigned int &w, unsigned int &h, unsigned int &maxval)
 {
-  std::string line;
-  unsigned int nb_elt = 4, cpt_elt=0;
-  while(cpt_elt != nb_elt) {
-    // Skip empty lines or lines starting with # (comment)
-    while (std::getline(fd, line) && (line.compare(0, 1, "#") == 0 || line.size() == 0)) {};
+  std::string token;
+  if (! vp_readTokenPNM(fd, token)) {
+    fd.close();
+    throw (vpImageException(vpImageException::ioError,
+                            "Cannot read header of file \"%s\"",  filename.c_str()));
+  }
+  if (token != magic) {
+    fd.close();
+    throw (vpImageException(vpImageException::ioError,
+                            "\"%s\" is not a PNM file with magic number %s", filename.c_str(), magic.c_str()));
+  }
 
-    if (fd.eof()) {
+  unsigned int *values[3] = { &w, &h, &maxval };
+  for (unsigned int i = 0; i < 3; i++) {
+    char *end = NULL;
+    if (! vp_readTokenPNM(fd, token) || token.empty() || token[0] == '-') {
       fd.close();
       throw (vpImageException(vpImageException::ioError,
-            "Cannot read header of file \"%s\"",  filename.c_str()));
+                              "Cannot read header of file \"%s\"",  filename.c_str()));
     }
-
-    std::vector<std::string> header = vpIoTools::splitChain(line, std::string(" "));
-
-    if(header.size() == 0) {
+    const unsigned long value = strtoul(token.c_str(), &end, 10);
+    if (*end != '\0' || value > 0xffffffffUL) {
       fd.close();
       throw (vpImageException(vpImageException::ioError,
                               "Cannot read header of file \"%s\"",  filename.c_str()));
     }
-
-    if (cpt_elt == 0) { // decode magic
-      if (header[0].compare(0, magic.size(), magic) != 0) {
-        fd.close();
-        throw (vpImageException(vpImageException::ioError,
-                                "\"%s\" is not a PNM file with magic number %s", filename.c_str(), magic.c_str()));
-      }
-      cpt_elt ++;
-      header.erase(header.begin(), header.begin()+1); // erase first element that is processed
-    }
-    while(header.size()) {
-      if (cpt_elt == 1) { // decode width
-        std::istringstream ss(header[0]);
-        ss >> w;
-        cpt_elt ++;
-        header.erase(header.begin(), header.begin()+1); // erase first element that is processed
-      }
-      else if (cpt_elt == 2) { // decode height
-        std::istringstream ss(header[0]);
-        ss >> h;
-        cpt_elt ++;
-        header.erase(header.begin(), header.begin()+1); // erase first element that is processed
-      }
-      else if (cpt_elt == 3) { // decode maxval
-        std::istringstream ss(header[0]);
-        ss >> maxval;
-        cpt_elt ++;
-        header.erase(header.begin(), header.begin()+1); // erase first element that is processed
-      }
-    }
+    *values[i] = (unsigned int) value;
   }
 }
 #endif
@@ -491,40 +614,7 @@ vpImageIo::write(const vpImage<vpRGBa> &I, const std::string &filename)
 void
 vpImageIo::writePFM(const vpImage<float> &I, const std::string &filename)
 {
-  FILE* fd;
-
-  // Test the filename
-  if (filename.empty())   {
-    throw (vpImageException(vpImageException::ioError,
-           "Cannot write PFM image: filename empty")) ;
-  }
-
-  fd = fopen(filename.c_str(), "wb");
-
-  if (fd == NULL) {
-    throw (vpImageException(vpImageException::ioError,
-           "Cannot create PFM file \"%s\"", filename.c_str())) ;
-  }
-
-  // Write the head
-  fprintf(fd, "P8\n");					// Magic number
-  fprintf(fd, "%u %u\n", I.getWidth(), I.getHeight());	// Image size
-  fprintf(fd, "255\n");					// Max level
-
-  // Write the bitmap
-  size_t ierr;
-  size_t nbyte = I.getWidth()*I.getHeight();
-
-  ierr = fwrite(I.bitmap, sizeof(float), nbyte, fd) ;
-  if (ierr != nbyte) {
-    fclose(fd);
-    throw (vpImageException(vpImageException::ioError,
-           "Cannot save PFM file \"%s\": only %d bytes over %d saved ", filename.c_str(), ierr, nbyte)) ;
-  }
-
-  fflush(fd);
-  fclose(fd);
-
+  vp_writePNM(filename, "PFM", "P8", I.getWidth(), I.getHeight(), 255, I.bitmap, sizeof(float) * I.getSize());
 }
 //--------------------------------------------------------------------------
 // PGM
@@ -541,45 +631,13 @@ vpImageIo::writePFM(const vpImage<float> &I, const std::string &filename)
 void
 vpImageIo::writePGM(const vpImage<unsigned char> &I, const std::string &filename)
 {
-
-  FILE* fd;
-
-  // Test the filename
-  if (filename.empty())   {
-    throw (vpImageException(vpImageException::ioError,
-           "Cannot create PGM file: filename empty")) ;
-  }
-
-  fd = fopen(filename.c_str(), "wb");
-
-  if (fd == NULL) {
-     throw (vpImageException(vpImageException::ioError,
-           "Cannot create PGM file \"%s\"", filename.c_str())) ;
-  }
-
-  // Write the head
-  fprintf(fd, "P5\n");					// Magic number
-  fprintf(fd, "%u %u\n", I.getWidth(), I.getHeight());	// Image size
-  fprintf(fd, "255\n");					// Max level
-
-  // Write the bitmap
-  size_t ierr;
-  size_t nbyte = I.getWidth()*I.getHeight();
-
-  ierr = fwrite(I.bitmap, sizeof(unsigned char), nbyte, fd) ;
-  if (ierr != nbyte) {
-    fclose(fd);
-    throw (vpImageException(vpImageException::ioError,
-           "Cannot save PGM file \"%s\": only %d over %d bytes saved", filename.c_str(), ierr, nbyte)) ;
-  }
-
-  fflush(fd);
-  fclose(fd);
+  vp_writePNM(filename, "PGM", "P5", I.getWidth(), I.getHeight(), 255, I.bitmap, I.getSize());
 }
 
 /*!
   Write the content of the image bitmap in the file which name is given by \e
   filename. This function writes a portable gray pixmap (PGM P5) file.
+  Only the lowest byte of each pixel is saved.
 
   \param I : Image to save as a (PGM P5) file.
   \param filename : Name of the file containing the image.
@@ -587,66 +645,58 @@ vpImageIo::writePGM(const vpImage<unsigned char> &I, const std::string &filename
 void
 vpImageIo::writePGM(const vpImage<short> &I, const std::string &filename)
 {
-  vpImage<unsigned char> Iuc ;
-  unsigned int nrows = I.getHeight();
-  unsigned int ncols = I.getWidth();
-
-  Iuc.resize(nrows, ncols);
+  const unsigned int size = I.getSize();
+  std::vector<unsigned char> data(size);
 
-  for (unsigned int i=0 ; i < nrows * ncols ; i++)
-    Iuc.bitmap[i] =  (unsigned char)I.bitmap[i] ;
+  for (unsigned int i=0 ; i < size ; i++)
+    data[i] = (unsigned char)I.bitmap[i] ;
 
-  vpImageIo::writePGM(Iuc, filename) ;
+  vp_writePNM(filename, "PGM", "P5", I.getWidth(), I.getHeight(), 255, size ? &data[0] : NULL, size);
 }
+
 /*!
   Write the content of the image bitmap in the file which name is given by \e
-  filename. This function writes a portable gray pixmap (PGM P5) file.
-  Color image is converted into a grayscale image.
+  filename. This function writes a 16 bits portable gray pixmap (PGM P5) file
+  with a maximum value of 65535, for instance to save a depth image.
 
   \param I : Image to save as a (PGM P5) file.
   \param filename : Name of the file containing the image.
 */
-
 void
-vpImageIo::writePGM(const vpImage<vpRGBa> &I, const std::string &filename)
+vpImageIo::writePGM(const vpImage<uint16_t> &I, const std::string &filename)
 {
+  const unsigned int size = I.getSize();
 
-  FILE* fd;
-
-  // Test the filename
-  if (filename.empty())   {
-    throw (vpImageException(vpImageException::ioError,
-           "Cannot create PGM file: filename empty")) ;
+  if (vp_isLittleEndian()) {
+    // The samples are stored in big endian
+    std::vector<uint16_t> data(size);
+    if (size > 0) {
+      vp_swapBytes16(I.bitmap, &data[0], size);
+    }
+    vp_writePNM(filename, "PGM", "P5", I.getWidth(), I.getHeight(), 65535, size ? &data[0] : NULL,
+                2 * (size_t) size);
   }
-
-  fd = fopen(filename.c_str(), "wb");
-
-  if (fd == NULL) {
-     throw (vpImageException(vpImageException::ioError,
-           "Cannot create PGM file \"%s\"", filename.c_str())) ;
+  else {
+    vp_writePNM(filename, "PGM", "P5", I.getWidth(), I.getHeight(), 65535, I.bitmap, 2 * (size_t) size);
   }
+}
 
-  // Write the head
-  fprintf(fd, "P5\n");					// Magic number
-  fprintf(fd, "%u %u\n", I.getWidth(), I.getHeight());	// Image size
-  fprintf(fd, "255\n");					// Max level
+/*!
+  Write the content of the image bitmap in the file which name is given by \e
+  filename. This function writes a portable gray pixmap (PGM P5) file.
+  Color image is converted into a grayscale image.
 
-  // Write the bitmap
-  size_t ierr;
-  size_t nbyte = I.getWidth()*I.getHeight();
+  \param I : Image to save as a (PGM P5) file.
+  \param filename : Name of the file containing the image.
+*/
 
+void
+vpImageIo::writePGM(const vpImage<vpRGBa> &I, const std::string &filename)
+{
   vpImage<unsigned char> Itmp ;
   vpImageConvert::convert(I,Itmp) ;
 
-  ierr = fwrite(Itmp.bitmap, sizeof(unsigned char), nbyte, fd) ;
-  if (ierr != nbyte) {
-    fclose(fd);
-    throw (vpImageException(vpImageException::ioError,
-                            "Cannot save PGM file \"%s\": only %d over %d bytes saved", filename.c_str(), ierr, nbyte)) ;
-  }
-
-  fflush(fd);
-  fclose(fd);
+  vpImageIo::writePGM(Itmp, filename) ;
 }
 
 /*!
@@ -669,42 +719,14 @@ void
 vpImageIo::readPFM(vpImage<float> &I, const std::string &filename)
 {
   unsigned int w=0, h=0, maxval=0;
-  unsigned int w_max = 100000, h_max = 100000, maxval_max = 255;
-  std::string magic("P8");
-
-  std::ifstream fd(filename.c_str(), std::ios::binary);
-
-  // Open the filename
-  if(! fd.is_open()) {
-    throw (vpImageException(vpImageException::ioError, "Cannot open file \"%s\"", filename.c_str())) ;
-  }
-
-  vp_decodeHeaderPNM(filename, fd, magic, w, h, maxval);
-
-  if (w > w_max || h > h_max) {
-    fd.close();
-    throw(vpException(vpException::badValue, "Bad image size in \"%s\"",  filename.c_str()));
-  }
-  if (maxval > maxval_max)
-  {
-    fd.close();
-    throw (vpImageException(vpImageException::ioError,
-                            "Bad maxval in \"%s\"",  filename.c_str()));
-  }
+  std::ifstream fd;
+  vp_openPNM(filename, fd, "P8", w, h, 255, maxval);
 
   if ((h != I.getHeight())||( w != I.getWidth())) {
     I.resize(h,w) ;
   }
 
-  unsigned int nbyte = I.getHeight()*I.getWidth();
-  fd.read ((char *)I.bitmap, sizeof(float) * nbyte);
-  if (! fd) {
-    fd.close();
-    throw (vpImageException(vpImageException::ioError,
-                            "Read only %d of %d bytes in file \"%s\"", fd.gcount(), nbyte, filename.c_str()));
-  }
-
-  fd.close();
+  vp_readRasterPNM(filename, fd, I.bitmap, sizeof(float) * I.getSize());
 }
 
 
@@ -727,42 +749,59 @@ void
 vpImageIo::readPGM(vpImage<unsigned char> &I, const std::string &filename)
 {
   unsigned int w=0, h=0, maxval=0;
-  unsigned int w_max = 100000, h_max = 100000, maxval_max = 255;
-  std::string magic("P5");
-
-  std::ifstream fd(filename.c_str(), std::ios::binary);
+  std::ifstream fd;
+  vp_openPNM(filename, fd, "P5", w, h, 255, maxval);
 
-  // Open the filename
-  if(! fd.is_open()) {
-    throw (vpImageException(vpImageException::ioError, "Cannot open file \"%s\"", filename.c_str())) ;
+  if ((h != I.getHeight())||( w != I.getWidth())) {
+    I.resize(h,w) ;
   }
 
-  vp_decodeHeaderPNM(filename, fd, magic, w, h, maxval);
+  vp_readRasterPNM(filename, fd, I.bitmap, I.getSize());
+}
 
-  if (w > w_max || h > h_max) {
-    fd.close();
-    throw(vpException(vpException::badValue, "Bad image size in \"%s\"",  filename.c_str()));
-  }
-  if (maxval > maxval_max)
-  {
-    fd.close();
-    throw (vpImageException(vpImageException::ioError,
-                            "Bad maxval in \"%s\"",  filename.c_str()));
-  }
+/*!
+  Read a 8 or 16 bits PGM P5 file and initialize an image, for instance a depth image.
+
+  Read the contents of the portable gray pixmap (PGM P5) filename, allocate
+  memory for the corresponding image, and set the bitmap whith the content of
+  the file. The pixel values are not scaled: the pixels of a 8 bits file are lower
+  than 256.
+
+  If the image has been already initialized, memory allocation is done
+  only if the new image size is different, else we re-use the same
+  memory space.
+
+  \param I : Image to set with the \e filename content.
+  \param filename : Name of the file containing the image.
+*/
+
+void
+vpImageIo::readPGM(vpImage<uint16_t> &I, const std::string &filename)
+{
+  unsigned int w=0, h=0, maxval=0;
+  std::ifstream fd;
+  vp_openPNM(filename, fd, "P5", w, h, 65535, maxval);
 
   if ((h != I.getHeight())||( w != I.getWidth())) {
     I.resize(h,w) ;
   }
 
-  unsigned int nbyte = I.getHeight()*I.getWidth();
-  fd.read ((char *)I.bitmap, nbyte);
-  if (! fd) {
-    fd.close();
-    throw (vpImageException(vpImageException::ioError,
-                            "Read only %d of %d bytes in file \"%s\"", fd.gcount(), nbyte, filename.c_str()));
+  const unsigned int size = I.getSize();
+  if (maxval < 256) {
+    // One byte per pixel, read in the second half of the bitmap and widened in place
+    unsigned char *data = (unsigned char *) I.bitmap + size;
+    vp_readRasterPNM(filename, fd, data, size);
+    for (unsigned int i = 0; i < size; i++) {
+      I.bitmap[i] = data[i];
+    }
+  }
+  else {
+    // Two bytes per pixel stored in big endian
+    vp_readRasterPNM(filename, fd, I.bitmap, 2 * (size_t) size);
+    if (vp_isLittleEndian()) {
+      vp_swapBytes16(I.bitmap, I.bitmap, size);
+    }
   }
-
-  fd.close();
 }
 
 /*!
@@ -817,11 +856,20 @@ vpImageIo::readPGM(vpImage<vpRGBa> &I, const std::string &filename)
 void
 vpImageIo::readPPM(vpImage<unsigned char> &I, const std::string &filename)
 {
-  vpImage<vpRGBa> Itmp ;
+  unsigned int w=0, h=0, maxval=0;
+  std::ifstream fd;
+  vp_openPNM(filename, fd, "P6", w, h, 255, maxval);
 
-  vpImageIo::readPPM(Itmp, filename) ;
+  if ((h != I.getHeight())||( w != I.getWidth())) {
+    I.resize(h,w) ;
+  }
 
-  vpImageConvert::convert(Itmp, I) ;
+  const unsigned int size = I.getSize();
+  std::vector<unsigned char> rgb(3 * (size_t) size);
+  if (size > 0) {
+    vp_readRasterPNM(filename, fd, &rgb[0], rgb.size());
+    vpImageConvert::RGBToGrey(&rgb[0], I.bitmap, size);
+  }
 }
 
 
@@ -840,53 +888,19 @@ void
 vpImageIo::readPPM(vpImage<vpRGBa> &I, const std::string &filename)
 {
   unsigned int w=0, h=0, maxval=0;
-  unsigned int w_max = 100000, h_max = 100000, maxval_max = 255;
-  std::string magic("P6");
-
-  std::ifstream fd(filename.c_str(), std::ios::binary);
-
-  // Open the filename
-  if(! fd.is_open()) {
-    throw (vpImageException(vpImageException::ioError, "Cannot open file \"%s\"", filename.c_str())) ;
-  }
-
-  vp_decodeHeaderPNM(filename, fd, magic, w, h, maxval);
-
-  if (w > w_max || h > h_max) {
-    fd.close();
-    throw(vpException(vpException::badValue, "Bad image size in \"%s\"",  filename.c_str()));
-  }
-  if (maxval > maxval_max)
-  {
-    fd.close();
-    throw (vpImageException(vpImageException::ioError,
-                            "Bad maxval in \"%s\"",  filename.c_str()));
-  }
+  std::ifstream fd;
+  vp_openPNM(filename, fd, "P6", w, h, 255, maxval);
 
   if ((h != I.getHeight())||( w != I.getWidth())) {
     I.resize(h,w) ;
   }
 
-  for(unsigned int i=0;i<I.getHeight();i++) {
-    for(unsigned int j=0;j<I.getWidth();j++) {
-      unsigned char rgb[3];
-      fd.read((char *)&rgb, 3);
-
-      if (! fd) {
-        fd.close();
-        throw (vpImageException(vpImageException::ioError,
-                                "Read only %d of %d bytes in file \"%s\"",
-                                (i*I.getWidth() + j)*3 + fd.gcount(), I.getSize()*3, filename.c_str()));
-      }
-
-      I[i][j].R = rgb[0];
-      I[i][j].G = rgb[1];
-      I[i][j].B = rgb[2];
-      I[i][j].A = vpRGBa::alpha_default;
-    }
+  const unsigned int size = I.getSize();
+  std::vector<unsigned char> rgb(3 * (size_t) size);
+  if (size > 0) {
+    vp_readRasterPNM(filename, fd, &rgb[0], rgb.size());
+    vpImageConvert::RGBToRGBa(&rgb[0], (unsigned char *) I.bitmap, size);
   }
-
-  fd.close();
 }
 
 /*!
@@ -902,11 +916,13 @@ vpImageIo::readPPM(vpImage<vpRGBa> &I, const std::string &filename)
 void
 vpImageIo::writePPM(const vpImage<unsigned char> &I, const std::string &filename)
 {
-  vpImage<vpRGBa> Itmp ;
-
-  vpImageConvert::convert(I, Itmp) ;
+  const unsigned int size = I.getSize();
+  std::vector<unsigned char> rgb(3 * (size_t) size);
+  for (unsigned int i = 0; i < size; i++) {
+    rgb[3*i] = rgb[3*i+1] = rgb[3*i+2] = I.bitmap[i];
+  }
 
-  vpImageIo::writePPM(Itmp, filename) ;
+  vp_writePNM(filename, "PPM", "P6", I.getWidth(), I.getHeight(), 255, size ? &rgb[0] : NULL, rgb.size());
 }
 
 
@@ -920,53 +936,67 @@ vpImageIo::writePPM(const vpImage<unsigned char> &I, const std::string &filename
 void
 vpImageIo::writePPM(const vpImage<vpRGBa> &I, const std::string &filename)
 {
-  FILE* f;
-
-  // Test the filename
-  if (filename.empty())   {
-    throw (vpImageException(vpImageException::ioError,
-           "Cannot create PPM file: filename empty")) ;
+  const unsigned int size = I.getSize();
+  std::vector<unsigned char> rgb(3 * (size_t) size);
+  if (size > 0) {
+    vpImageConvert::RGBaToRGB((unsigned char *) I.bitmap, &rgb[0], size);
   }
 
-  f = fopen(filename.c_str(), "wb");
+  vp_writePNM(filename, "PPM", "P6", I.getWidth(), I.getHeight(), 255, size ? &rgb[0] : NULL, rgb.size());
+}
 
-  if (f == NULL) {
-     throw (vpImageException(vpImageException::ioError,
-           "Cannot create PPM file \"%s\"", filename.c_str())) ;
-  }
+//--------------------------------------------------------------------------
+// JPEG
+//--------------------------------------------------------------------------
 
-  fprintf(f,"P6\n");			         // Magic number
-  fprintf(f,"%u %u\n", I.getWidth(), I.getHeight());	// Image size
-  fprintf(f,"%d\n", 255);	        	// Max level
+#if defined(VISP_HAVE_JPEG)
 
-  for(unsigned int i=0;i<I.getHeight();i++)
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+  /*!
+   * libjpeg error manager. The default one calls exit() on errors; this one jumps
+   * back to the vpImageIo function that called libjpeg, which releases libjpeg and
+   * throws a vpImageException.
+   */
+  struct vpJpegErrorManager {
+    struct jpeg_error_mgr pub;
+    void (*defaultEmitMessage)(j_common_ptr, int);
+    jmp_buf setjmpBuffer;
+    char message[JMSG_LENGTH_MAX];
+  };
+
+  void vp_jpegErrorExit(j_common_ptr cinfo)
   {
-    for(unsigned int j=0;j<I.getWidth();j++)
-    {
-      vpRGBa v = I[i][j];
-      unsigned char rgb[3];
-      rgb[0] = v.R;
-      rgb[1] = v.G;
-      rgb[2] = v.B;
-
-      size_t res = fwrite(&rgb, 1, 3, f);
-      if (res != 3) {
-        fclose(f);
-        throw (vpImageException(vpImageException::ioError,
-                                "cannot write file \"%s\"", filename.c_str())) ;
-      }
+    vpJpegErrorManager *err = (vpJpegErrorManager *) cinfo->err;
+    (*cinfo->err->format_message)(cinfo, err->message);
+    longjmp(err->setjmpBuffer, 1);
+  }
+
+  /*!
+   * For libjpeg a truncated file is only a warning: the missing part of the image
+   * is filled with grey pixels. It is handled as an error. The other messages are
+   * processed as usual.
+   */
+  void vp_jpegEmitMessage(j_common_ptr cinfo, int msg_level)
+  {
+    if (msg_level < 0 && cinfo->err->msg_code == JWRN_JPEG_EOF) {
+      vp_jpegErrorExit(cinfo);
     }
+    vpJpegErrorManager *err = (vpJpegErrorManager *) cinfo->err;
+    (*err->defaultEmitMessage)(cinfo, msg_level);
   }
 
-  fflush(f);
-  fclose(f);
+  struct jpeg_error_mgr *vp_jpegErrorManager(vpJpegErrorManager &err)
+  {
+    jpeg_std_error(&err.pub);
+    err.pub.error_exit = vp_jpegErrorExit;
+    err.defaultEmitMessage = err.pub.emit_message;
+    err.pub.emit_message = vp_jpegEmitMessage;
+    err.message[0] = '\0';
+    return &err.pub;
+  }
 }
-
-//--------------------------------------------------------------------------
-// JPEG
-//--------------------------------------------------------------------------
-
-#if defined(VISP_HAVE_JPEG)
+#endif // DOXYGEN_SHOULD_SKIP_THIS
 
 /*!
   Write the content of the image bitmap in the file which name is given by \e
@@ -974,24 +1004,20 @@ vpImageIo::writePPM(const vpImage<vpRGBa> &I, const std::string &filename)
 
   \param I : Image to save as a JPEG file.
   \param filename : Name of the file containing the image.
+
+  \exception vpImageException::ioError : If the file cannot be created or if
+  libjpeg reports an error, for instance when the image is empty.
 */
 void
 vpImageIo::writeJPEG(const vpImage<unsigned char> &I, const std::string &filename)
 {
-  struct jpeg_compress_struct cinfo;
-  struct jpeg_error_mgr jerr;
-  FILE *file;
-
-  cinfo.err = jpeg_std_error(&jerr);
-  jpeg_create_compress(&cinfo);
-
   // Test the filename
   if (filename.empty())   {
      throw (vpImageException(vpImageException::ioError,
            "Cannot create JPEG file: filename empty")) ;
   }
 
-  file = fopen(filename.c_str(), "wb");
+  FILE *file = fopen(filename.c_str(), "wb");
 
   if (file == NULL) {
     throw (vpImageException(vpImageException::ioError,
@@ -1000,6 +1026,20 @@ vpImageIo::writeJPEG(const vpImage<unsigned char> &I, const std::string &filenam
 
   unsigned int width = I.getWidth();
   unsigned int height = I.getHeight();
+  // The objects used by libjpeg are created before setjmp() so that they are
+  // released when an error is thrown
+  std::vector<unsigned char> line(width);
+
+  struct jpeg_compress_struct cinfo;
+  vpJpegErrorManager jerr;
+  cinfo.err = vp_jpegErrorManager(jerr);
+  if (setjmp(jerr.setjmpBuffer)) {
+    jpeg_destroy_compress(&cinfo);
+    fclose(file);
+    throw (vpImageException(vpImageException::ioError,
+                            "Cannot write JPEG file \"%s\": %s", filename.c_str(), jerr.message)) ;
+  }
+  jpeg_create_compress(&cinfo);
 
   jpeg_stdio_dest(&cinfo, file);
 
@@ -1011,22 +1051,20 @@ vpImageIo::writeJPEG(const vpImage<unsigned char> &I, const std::string &filenam
 
   jpeg_start_compress(&cinfo,TRUE);
 
-  unsigned char *line;
-  line = new unsigned char[width];
   unsigned char* input = (unsigned char*)I.bitmap;
   while (cinfo.next_scanline < cinfo.image_height)
   {
+    JSAMPROW row = &line[0];
     for (unsigned int i = 0; i < width; i++)
     {
       line[i] = *(input);
       input++;
     }
-    jpeg_write_scanlines(&cinfo, &line, 1);
+    jpeg_write_scanlines(&cinfo, &row, 1);
   }
 
   jpeg_finish_compress(&cinfo);
   jpeg_destroy_compress(&cinfo);
-  delete [] line;
   fclose(file);
 }
 
@@ -1036,24 +1074,20 @@ vpImageIo::writeJPEG(const vpImage<unsigned char> &I, const std::string &filenam
 
   \param I : Image to save as a JPEG file.
   \param filename : Name of the file containing the image.
+
+  \exception vpImageException::ioError : If the file cannot be created or if
+  libjpeg reports an error, for instance when the image is empty.
 */
 void
 vpImageIo::writeJPEG(const vpImage<vpRGBa> &I, const std::string &filename)
 {
-  struct jpeg_compress_struct cinfo;
-  struct jpeg_error_mgr jerr;
-  FILE *file;
-
-  cinfo.err = jpeg_std_error(&jerr);
-  jpeg_create_compress(&cinfo);
-
   // Test the filename
   if (filename.empty())   {
      throw (vpImageException(vpImageException::ioError,
            "Cannot create JPEG file: filename empty")) ;
   }
 
-  file = fopen(filename.c_str(), "wb");
+  FILE *file = fopen(filename.c_str(), "wb");
 
   if (file == NULL) {
     throw (vpImageException(vpImageException::ioError,
@@ -1062,6 +1096,20 @@ vpImageIo::writeJPEG(const vpImage<vpRGBa> &I, const std::string &filename)
 
   unsigned int width = I.getWidth();
   unsigned int height = I.getHeight();
+  // The objects used by libjpeg are created before setjmp() so that they are
+  // released when an error is thrown
+  std::vector<unsigned char> line(3 * (size_t) width);
+
+  struct jpeg_compress_struct cinfo;
+  vpJpegErrorManager jerr;
+  cinfo.err = vp_jpegErrorManager(jerr);
+  if (setjmp(jerr.setjmpBuffer)) {
+    jpeg_destroy_compress(&cinfo);
+    fclose(file);
+    throw (vpImageException(vpImageException::ioError,
+                            "Cannot write JPEG file \"%s\": %s", filename.c_str(), jerr.message)) ;
+  }
+  jpeg_create_compress(&cinfo);
 
   jpeg_stdio_dest(&cinfo, file);
 
@@ -1073,11 +1121,10 @@ vpImageIo::writeJPEG(const vpImage<vpRGBa> &I, const std::string &filename)
 
   jpeg_start_compress(&cinfo,TRUE);
 
-  unsigned char *line;
-  line = new unsigned char[3*width];
   unsigned char* input = (unsigned char*)I.bitmap;
   while (cinfo.next_scanline < cinfo.image_height)
   {
+    JSAMPROW row = &line[0];
     for (unsigned int i = 0; i < width; i++)
     {
       line[i*3] = *(input); input++;
@@ -1085,12 +1132,11 @@ vpImageIo::writeJPEG(const vpImage<vpRGBa> &I, const std::string &filename)
       line[i*3+2] = *(input); input++;
       input++;
     }
-    jpeg_write_scanlines(&cinfo, &line, 1);
+    jpeg_write_scanlines(&cinfo, &row, 1);
   }
 
   jpeg_finish_compress(&cinfo);
   jpeg_destroy_compress(&cinfo);
-  delete [] line;
   fclose(file);
 }
 
@@ -1109,30 +1155,40 @@ vpImageIo::writeJPEG(const vpImage<vpRGBa> &I, const std::string &filename)
   \param I : Image to set with the \e filename content.
   \param filename : Name of the file containing the image.
 
+  \exception vpImageException::ioError : If the file cannot be opened, or if it is
+  corrupted or truncated.
 */
 void
 vpImageIo::readJPEG(vpImage<unsigned char> &I, const std::string &filename)
 {
-  struct jpeg_decompress_struct cinfo;
-  struct jpeg_error_mgr jerr;
-  FILE *file;
-
-  cinfo.err = jpeg_std_error(&jerr);
-  jpeg_create_decompress(&cinfo);
-
   // Test the filename
   if (filename.empty())   {
      throw (vpImageException(vpImageException::ioError,
            "Cannot read JPEG image: filename empty")) ;
   }
 
-  file = fopen(filename.c_str(), "rb");
+  FILE *file = fopen(filename.c_str(), "rb");
 
   if (file == NULL) {
      throw (vpImageException(vpImageException::ioError,
            "Cannot read JPEG file \"%s\"", filename.c_str())) ;
   }
 
+  // The objects used by libjpeg are created before setjmp() so that they are
+  // released when an error is thrown
+  vpImage<vpRGBa> Ic;
+
+  struct jpeg_decompress_struct cinfo;
+  vpJpegErrorManager jerr;
+  cinfo.err = vp_jpegErrorManager(jerr);
+  if (setjmp(jerr.setjmpBuffer)) {
+    jpeg_destroy_decompress(&cinfo);
+    fclose(file);
+    throw (vpImageException(vpImageException::ioError,
+                            "Cannot read JPEG file \"%s\": %s", filename.c_str(), jerr.message)) ;
+  }
+  jpeg_create_decompress(&cinfo);
+
   jpeg_stdio_src(&cinfo, file);
   jpeg_read_header(&cinfo, TRUE);
 
@@ -1149,7 +1205,7 @@ vpImageIo::readJPEG(vpImage<unsigned char> &I, const std::string &filename)
                       ((j_common_ptr) &cinfo, JPOOL_IMAGE, rowbytes, 1);
 
   if (cinfo.out_color_space == JCS_RGB) {
-    vpImage<vpRGBa> Ic(height,width);
+    Ic.resize(height,width);
     unsigned char* output = (unsigned char*)Ic.bitmap;
     while (cinfo.output_scanline<cinfo.output_height)	{
       jpeg_read_scanlines(&cinfo,buffer,1);
@@ -1195,30 +1251,41 @@ vpImageIo::readJPEG(vpImage<unsigned char> &I, const std::string &filename)
 
   \param I : Color image to set with the \e filename content.
   \param filename : Name of the file containing the image.
+
+  \exception vpImageException::ioError : If the file cannot be opened, or if it is
+  corrupted or truncated.
 */
 void
 vpImageIo::readJPEG(vpImage<vpRGBa> &I, const std::string &filename)
 {
-  struct jpeg_decompress_struct cinfo;
-  struct jpeg_error_mgr jerr;
-  FILE *file;
-
-  cinfo.err = jpeg_std_error(&jerr);
-  jpeg_create_decompress(&cinfo);
-
   // Test the filename
   if (filename.empty())   {
      throw (vpImageException(vpImageException::ioError,
            "Cannot read JPEG image: filename empty")) ;
   }
 
-  file = fopen(filename.c_str(), "rb");
+  FILE *file = fopen(filename.c_str(), "rb");
 
   if (file == NULL) {
      throw (vpImageException(vpImageException::ioError,
            "Cannot read JPEG file \"%s\"", filename.c_str())) ;
   }
 
+  // The objects used by libjpeg are created before setjmp() so that they are
+  // released when an error is thrown
+  vpImage<unsigned char> Ig;
+
+  struct jpeg_decompress_struct cinfo;
+  vpJpegErrorManager jerr;
+  cinfo.err = vp_jpegErrorManager(jerr);
+  if (setjmp(jerr.setjmpBuffer)) {
+    jpeg_destroy_decompress(&cinfo);
+    fclose(file);
+    throw (vpImageException(vpImageException::ioError,
+                            "Cannot read JPEG file \"%s\": %s", filename.c_str(), jerr.message)) ;
+  }
+  jpeg_create_decompress(&cinfo);
+
   jpeg_stdio_src(&cinfo, file);
 
   jpeg_read_header(&cinfo, TRUE);
@@ -1252,7 +1319,7 @@ vpImageIo::readJPEG(vpImage<vpRGBa> &I, const std::string &filename)
 
   else if (cinfo.out_color_space == JCS_GRAYSCALE)
   {
-    vpImage<unsigned char> Ig(height,width);
+    Ig.resize(height,width);
 
     while (cinfo.output_scanline<cinfo.output_height)
     {
@@ -1711,6 +1778,12 @@ vpImageIo::readPNG(vpImage<unsigned char> &I, const std::string &filename)
           "error reading png file")) ;
   }
 
+  // The buffers are created before setjmp() so that they are released when an
+  // error is thrown
+  std::vector<png_bytep> rowPtrs;
+  std::vector<unsigned char> data;
+  vpImage<vpRGBa> Ic;
+
   /* initialize the setjmp for returning properly after a libpng error occured */
   if (setjmp (png_jmpbuf (png_ptr)))
   {
@@ -1766,17 +1839,17 @@ vpImageIo::readPNG(vpImage<unsigned char> &I, const std::string &filename)
   if ( (width != I.getWidth()) || (height != I.getHeight()) )
     I.resize(height,width);
 
-  png_bytep* rowPtrs = new png_bytep[height];
+  rowPtrs.resize(height);
 
   unsigned int stride = png_get_rowbytes(png_ptr, info_ptr);
-  unsigned char* data = new  unsigned char[stride * height];
+  data.resize((size_t) stride * height);
 
   for (unsigned int  i =0; i < height; i++)
-    rowPtrs[i] = (png_bytep)data + (i * stride);
+    rowPtrs[i] = (png_bytep)&data[0] + (i * stride);
 
-  png_read_image(png_ptr, rowPtrs);
+  png_read_image(png_ptr, &rowPtrs[0]);
 
-  vpImage<vpRGBa> Ic(height,width);
+  Ic.resize(height,width);
   unsigned char* output;
 
   switch (channels)
@@ -1822,8 +1895,6 @@ vpImageIo::readPNG(vpImage<unsigned char> &I, const std::string &filename)
     break;
   }
 
-  delete [] (png_bytep)rowPtrs;
-  delete [] data;
   png_read_end (png_ptr, NULL);
   png_destroy_read_struct (&png_ptr, &info_ptr, NULL);
   fclose(file);
@@ -1903,6 +1974,12 @@ vpImageIo::readPNG(vpImage<vpRGBa> &I, const std::string &filename)
            "PNG read error")) ;
   }
 
+  // The buffers are created before setjmp() so that they are released when an
+  // error is thrown
+  std::vector<png_bytep> rowPtrs;
+  std::vector<unsigned char> data;
+  vpImage<unsigned char> Ig;
+
   /* initialize the setjmp for returning properly after a libpng error occured */
   if (setjmp (png_jmpbuf (png_ptr)))
   {
@@ -1958,18 +2035,18 @@ vpImageIo::readPNG(vpImage<vpRGBa> &I, const std::string &filename)
   if ( (width != I.getWidth()) || (height != I.getHeight()) )
     I.resize(height,width);
 
-  png_bytep* rowPtrs = new png_bytep[height];
+  rowPtrs.resize(height);
 
   unsigned int stride = png_get_rowbytes(png_ptr, info_ptr);
-  unsigned char* data = new  unsigned char[stride * height];
+  data.resize((size_t) stride * height);
 
 
   for (unsigned int  i =0; i < height; i++)
-    rowPtrs[i] = (png_bytep)data + (i * stride);
+    rowPtrs[i] = (png_bytep)&data[0] + (i * stride);
 
-  png_read_image(png_ptr, rowPtrs);
+  png_read_image(png_ptr, &rowPtrs[0]);
 
-  vpImage<unsigned char> Ig(height,width);
+  Ig.resize(height,width);
   unsigned char* output;
 
   switch (channels)
@@ -2015,8 +2092,6 @@ vpImageIo::readPNG(vpImage<vpRGBa> &I, const std::string &filename)
     break;
   }
 
-  delete [] (png_bytep)rowPtrs;
-  delete [] data;
   png_read_end (png_ptr, NULL);
   png_destroy_read_struct (&png_ptr, &info_ptr, NULL);
   fclose(file);
@@ -0,0 +1,221 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Read/write lists of images with several threads.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpImageIoBatch.cpp
+  \brief Read/write lists of images with several threads.
+*/
+
+#include <visp3/core/vpImageException.h>
+#include <visp3/io/vpImageIo.h>
+
+#if defined(VISP_HAVE_OPENMP)
+#  include <omp.h>
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+  /*!
+    Call \e process on each image of a batch with \e nbThreads threads. The exceptions
+    thrown for an image are stored in \e errors, the callback is called by one thread at a
+    time.
+  */
+  template<class Image, class Process>
+  unsigned int vp_processBatch(Image *I, const std::vector<std::string> &filenames, std::vector<std::string> &errors,
+                               unsigned int nbThreads, vpImageIo::vpBatchProgressCallback callback, void *data,
+                               Process process)
+  {
+    const int nbImages = (int) filenames.size();
+    errors.assign(filenames.size(), std::string());
+    unsigned int nbProcessed = 0, nbSucceeded = 0;
+
+#if defined(VISP_HAVE_OPENMP)
+    const int nbThreadsUsed = nbThreads > 0 ? (int) nbThreads : omp_get_max_threads();
+#pragma omp parallel for num_threads(nbThreadsUsed) if(nbThreadsUsed > 1 && nbImages > 1) schedule(dynamic)
+#else
+    (void) nbThreads;
+#endif
+    for (int i = 0; i < nbImages; i++) {
+      bool success = false;
+      try {
+        process(I[i], filenames[(size_t) i]);
+        success = true;
+      }
+      catch(const vpException &e) {
+        errors[(size_t) i] = e.getStringMessage();
+      }
+      catch(const std::exception &e) {
+        errors[(size_t) i] = e.what();
+      }
+      catch(...) {
+        errors[(size_t) i] = "Unknown error";
+      }
+
+#if defined(VISP_HAVE_OPENMP)
+#pragma omp critical(vpImageIoBatchProgress)
+#endif
+      {
+        nbProcessed++;
+        if (success) {
+          nbSucceeded++;
+        }
+        if (callback != NULL) {
+          callback(nbProcessed, (unsigned int) nbImages, filenames[(size_t) i], success, data);
+        }
+      }
+    }
+
+    return nbSucceeded;
+  }
+
+  struct vpReadImage {
+    template<class Type> void operator()(vpImage<Type> &I, const std::string &filename) const {
+      vpImageIo::read(I, filename);
+    }
+  };
+
+  struct vpWriteImage {
+    template<class Type> void operator()(const vpImage<Type> &I, const std::string &filename) const {
+      vpImageIo::write(I, filename);
+    }
+  };
+}
+#endif
+
+/*!
+  Read a list of images with several threads.
+
+  The images are read as with read(), the format being given by the extension of each
+  file. With OpenMP the files are shared out between \e nbThreads threads; each
+  image is decoded with its own codec context, so that the images are decoded
+  concurrently. Without OpenMP the images are read one after the other.
+
+  A file that cannot be read does not stop the batch: its error message is set in
+  \e errors and the corresponding image is left as is.
+
+  \param I : Images read. The vector is resized to the number of files.
+  \param filenames : Names of the files to read.
+  \param errors : Error message of each file, empty if the file was read.
+  \param nbThreads : Number of threads. If 0, the default number of OpenMP threads is used.
+  \param callback : If not NULL, function called after each image, by one thread at a time.
+  \param data : Pointer given to \e callback.
+  \return The number of images that were read.
+*/
+unsigned int vpImageIo::readBatch(std::vector<vpImage<unsigned char> > &I, const std::vector<std::string> &filenames,
+                                  std::vector<std::string> &errors, unsigned int nbThreads,
+                                  vpBatchProgressCallback callback, void *data)
+{
+  I.resize(filenames.size());
+  return vp_processBatch(I.empty() ? NULL : &I[0], filenames, errors, nbThreads, callback, data, vpReadImage());
+}
+
+/*!
+  Read a list of color images with several threads.
+
+  See readBatch(std::vector<vpImage<unsigned char> > &, const std::vector<std::string> &, std::vector<std::string> &, unsigned int, vpBatchProgressCallback, void *).
+
+  \param I : Images read. The vector is resized to the number of files.
+  \param filenames : Names of the files to read.
+  \param errors : Error message of each file, empty if the file was read.
+  \param nbThreads : Number of threads. If 0, the default number of OpenMP threads is used.
+  \param callback : If not NULL, function called after each image, by one thread at a time.
+  \param data : Pointer given to \e callback.
+  \return The number of images that were read.
+*/
+unsigned int vpImageIo::readBatch(std::vector<vpImage<vpRGBa> > &I, const std::vector<std::string> &filenames,
+                                  std::vector<std::string> &errors, unsigned int nbThreads,
+                                  vpBatchProgressCallback callback, void *data)
+{
+  I.resize(filenames.size());
+  return vp_processBatch(I.empty() ? NULL : &I[0], filenames, errors, nbThreads, callback, data, vpReadImage());
+}
+
+/*!
+  Write a list of images with several threads.
+
+  The images are written as with write(), the format being given by the extension of
+  each file. With OpenMP the files are shared out between \e nbThreads threads, each
+  image being encoded with its own codec context. Without OpenMP the images are written
+  one after the other.
+
+  A file that cannot be written does not stop the batch: its error message is set in
+  \e errors.
+
+  \param I : Images to write.
+  \param filenames : Names of the files, as many as images.
+  \param errors : Error message of each file, empty if the file was written.
+  \param nbThreads : Number of threads. If 0, the default number of OpenMP threads is used.
+  \param callback : If not NULL, function called after each image, by one thread at a time.
+  \param data : Pointer given to \e callback.
+  \return The number of images that were written.
+
+  \exception vpException::dimensionError : If there are not as many images as files.
+*/
+unsigned int vpImageIo::writeBatch(const std::vector<vpImage<unsigned char> > &I,
+                                   const std::vector<std::string> &filenames, std::vector<std::string> &errors,
+                                   unsigned int nbThreads, vpBatchProgressCallback callback, void *data)
+{
+  if (I.size() != filenames.size()) {
+    throw(vpException(vpException::dimensionError, "%u images for %u files", (unsigned int) I.size(),
+                      (unsigned int) filenames.size()));
+  }
+  return vp_processBatch(I.empty() ? NULL : &I[0], filenames, errors, nbThreads, callback, data, vpWriteImage());
+}
+
+/*!
+  Write a list of color images with several threads.
+
+  See writeBatch(const std::vector<vpImage<unsigned char> > &, const std::vector<std::string> &, std::vector<std::string> &, unsigned int, vpBatchProgressCallback, void *).
+
+  \param I : Images to write.
+  \param filenames : Names of the files, as many as images.
+  \param errors : Error message of each file, empty if the file was written.
+  \param nbThreads : Number of threads. If 0, the default number of OpenMP threads is used.
+  \param callback : If not NULL, function called after each image, by one thread at a time.
+  \param data : Pointer given to \e callback.
+  \return The number of images that were written.
+
+  \exception vpException::dimensionError : If there are not as many images as files.
+*/
+unsigned int vpImageIo::writeBatch(const std::vector<vpImage<vpRGBa> > &I, const std::vector<std::string> &filenames,
+                                   std::vector<std::string> &errors, unsigned int nbThreads,
+                                   vpBatchProgressCallback callback, void *data)
+{
+  if (I.size() != filenames.size()) {
+    throw(vpException(vpException::dimensionError, "%u images for %u files", (unsigned int) I.size(),
+                      (unsigned int) filenames.size()));
+  }
+  return vp_processBatch(I.empty() ? NULL : &I[0], filenames, errors, nbThreads, callback, data, vpWriteImage());
+}
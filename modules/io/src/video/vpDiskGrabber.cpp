@@ -39,13 +39,294 @@
 
 #include <visp3/io/vpDiskGrabber.h>
 
+#include <algorithm>
+#include <vector>
+
+#include <visp3/core/vpImageException.h>
+#include <visp3/core/vpThread.h>
+
+namespace {
+  void readImage(vpImage<unsigned char> &I, const std::string &filename)
+  {
+    vpImageIo::read(I, filename);
+  }
+
+  void readImage(vpImage<vpRGBa> &I, const std::string &filename)
+  {
+    vpImageIo::read(I, filename);
+  }
+
+  void readImage(vpImage<float> &I, const std::string &filename)
+  {
+    vpImageIo::readPFM(I, filename);
+  }
+}
+
+#if defined(VISP_HAVE_PTHREAD)
+
+/*!
+  Ring of images decoded in advance by background threads.
+
+  The consumer, ie the thread that calls vpDiskGrabber::acquire(), is the only one that
+  builds the image names and assigns the slots of the ring: slot \e i of the ring holds the
+  image at position \e k of the sequence with k = i modulo the ring size. The decoding
+  threads pick the queued slot that is the closest to the image expected by the consumer,
+  so that the images are decoded in order.
+
+  The decoded image is swapped with the one given by the caller, the buffer of the caller
+  being recycled to decode a next image.
+*/
+class vpDiskGrabber::Prefetcher
+{
+public:
+  Prefetcher(unsigned int nbBuffers, unsigned int nbThreads);
+  ~Prefetcher();
+
+  template<class Type> void acquire(vpImage<Type> &I, const vpDiskGrabber &g);
+
+private:
+  typedef enum {
+    IMAGE_NONE,
+    IMAGE_UCHAR,
+    IMAGE_RGBA,
+    IMAGE_FLOAT
+  } vpImageType;
+
+  typedef enum {
+    SLOT_FREE,
+    SLOT_QUEUED,
+    SLOT_DECODING,
+    SLOT_READY,
+    SLOT_FAILED
+  } vpSlotState;
+
+  struct vpSlot {
+    vpSlot() : state(SLOT_FREE), number(0), name(), I_uchar(), I_rgba(), I_float(),
+      imageError(false), errorCode(0), errorMessage() {}
+
+    vpSlotState state;
+    long number;
+    std::string name;
+    vpImage<unsigned char> I_uchar;
+    vpImage<vpRGBa> I_rgba;
+    vpImage<float> I_float;
+    bool imageError; //!< true if the error was a vpImageException
+    int errorCode;
+    std::string errorMessage;
+  };
+
+  static vpImageType getType(const vpImage<unsigned char> &) { return IMAGE_UCHAR; }
+  static vpImageType getType(const vpImage<vpRGBa> &) { return IMAGE_RGBA; }
+  static vpImageType getType(const vpImage<float> &) { return IMAGE_FLOAT; }
+  static vpImage<unsigned char> &getBuffer(vpSlot &slot, const vpImage<unsigned char> &) { return slot.I_uchar; }
+  static vpImage<vpRGBa> &getBuffer(vpSlot &slot, const vpImage<vpRGBa> &) { return slot.I_rgba; }
+  static vpImage<float> &getBuffer(vpSlot &slot, const vpImage<float> &) { return slot.I_float; }
+
+  static vpThread::Return decodeThread(vpThread::Args args);
+  void decode();
+  void restart(vpImageType type, const vpDiskGrabber &g);
+
+  std::vector<vpSlot> m_slots;
+  std::vector<vpThread *> m_threads;
+  pthread_mutex_t m_mutex;
+  pthread_cond_t m_cond;
+  vpImageType m_type; //!< Type of the decoded images
+  long m_step;        //!< Step between two images of the ring
+  size_t m_pos;       //!< Slot of the next image returned to the consumer
+  bool m_stop;
+
+  // Non copyable
+  Prefetcher(const Prefetcher &);
+  Prefetcher &operator=(const Prefetcher &);
+};
+
+vpDiskGrabber::Prefetcher::Prefetcher(unsigned int nbBuffers, unsigned int nbThreads)
+  : m_slots(nbBuffers), m_threads(), m_mutex(), m_cond(), m_type(IMAGE_NONE), m_step(0), m_pos(0), m_stop(false)
+{
+  pthread_mutex_init(&m_mutex, NULL);
+  pthread_cond_init(&m_cond, NULL);
+  for (unsigned int i = 0; i < nbThreads; i++) {
+    m_threads.push_back(new vpThread(decodeThread, (vpThread::Args)this));
+  }
+}
+
+vpDiskGrabber::Prefetcher::~Prefetcher()
+{
+  pthread_mutex_lock(&m_mutex);
+  m_stop = true;
+  pthread_cond_broadcast(&m_cond);
+  pthread_mutex_unlock(&m_mutex);
+
+  // The destructor of vpThread waits for the end of the thread
+  for (size_t i = 0; i < m_threads.size(); i++) {
+    delete m_threads[i];
+  }
+
+  pthread_cond_destroy(&m_cond);
+  pthread_mutex_destroy(&m_mutex);
+}
+
+vpThread::Return vpDiskGrabber::Prefetcher::decodeThread(vpThread::Args args)
+{
+  static_cast<Prefetcher *>(args)->decode();
+  return 0;
+}
+
+/*!
+  Loop of a decoding thread.
+*/
+void vpDiskGrabber::Prefetcher::decode()
+{
+  const size_t nbSlots = m_slots.size();
+
+  pthread_mutex_lock(&m_mutex);
+  while (!m_stop) {
+    vpSlot *slot = NULL;
+    for (size_t i = 0; i < nbSlots && slot == NULL; i++) {
+      vpSlot &candidate = m_slots[(m_pos + i) % nbSlots];
+      if (candidate.state == SLOT_QUEUED) {
+        slot = &candidate;
+      }
+    }
+    if (slot == NULL) {
+      pthread_cond_wait(&m_cond, &m_mutex);
+      continue;
+    }
+
+    // While the slot is decoded, only this thread accesses to it
+    slot->state = SLOT_DECODING;
+    const vpImageType type = m_type;
+    pthread_mutex_unlock(&m_mutex);
+
+    bool decoded = false;
+    try {
+      if (type == IMAGE_UCHAR) {
+        readImage(slot->I_uchar, slot->name);
+      }
+      else if (type == IMAGE_RGBA) {
+        readImage(slot->I_rgba, slot->name);
+      }
+      else {
+        readImage(slot->I_float, slot->name);
+      }
+      decoded = true;
+    }
+    catch(vpImageException &e) {
+      slot->imageError = true;
+      slot->errorCode = e.getCode();
+      slot->errorMessage = e.getStringMessage();
+    }
+    catch(vpException &e) {
+      slot->imageError = false;
+      slot->errorCode = e.getCode();
+      slot->errorMessage = e.getStringMessage();
+    }
+    catch(...) {
+      slot->imageError = false;
+      slot->errorCode = vpException::ioError;
+      slot->errorMessage = "Cannot read " + slot->name;
+    }
+
+    pthread_mutex_lock(&m_mutex);
+    slot->state = decoded ? SLOT_READY : SLOT_FAILED;
+    pthread_cond_broadcast(&m_cond);
+  }
+  pthread_mutex_unlock(&m_mutex);
+}
+
+/*!
+  Discard the content of the ring and queue the images that follow the current image
+  number of \e g. Must be called with the mutex locked.
+*/
+void vpDiskGrabber::Prefetcher::restart(vpImageType type, const vpDiskGrabber &g)
+{
+  for (size_t i = 0; i < m_slots.size(); i++) {
+    if (m_slots[i].state != SLOT_DECODING) {
+      m_slots[i].state = SLOT_FREE;
+    }
+  }
+
+  // The buffers of the images being decoded are reused
+  bool decoding = true;
+  while (decoding) {
+    decoding = false;
+    for (size_t i = 0; i < m_slots.size() && !decoding; i++) {
+      decoding = (m_slots[i].state == SLOT_DECODING);
+    }
+    if (decoding) {
+      pthread_cond_wait(&m_cond, &m_mutex);
+    }
+  }
+
+  m_type = type;
+  m_step = g.m_image_step;
+  m_pos = 0;
+  for (size_t i = 0; i < m_slots.size(); i++) {
+    m_slots[i].number = g.m_image_number + (long)i * m_step;
+    m_slots[i].name = g.getImageName(m_slots[i].number);
+    m_slots[i].state = SLOT_QUEUED;
+  }
+  pthread_cond_broadcast(&m_cond);
+}
+
+/*!
+  Get the image with the current image number of \e g, and queue the image that will be
+  needed after the last one of the ring.
+*/
+template<class Type>
+void vpDiskGrabber::Prefetcher::acquire(vpImage<Type> &I, const vpDiskGrabber &g)
+{
+  const vpImageType type = getType(I);
+
+  pthread_mutex_lock(&m_mutex);
+  vpSlot *slot = &m_slots[m_pos];
+  if (type != m_type || g.m_image_step != m_step || slot->state == SLOT_FREE ||
+      slot->number != g.m_image_number || slot->name != g.getImageName(g.m_image_number)) {
+    // The type of the images, the sequence or the image number changed
+    restart(type, g);
+    slot = &m_slots[m_pos];
+  }
+
+  while (slot->state != SLOT_READY && slot->state != SLOT_FAILED) {
+    pthread_cond_wait(&m_cond, &m_mutex);
+  }
+
+  const bool failed = (slot->state == SLOT_FAILED);
+  const bool imageError = slot->imageError;
+  const int errorCode = slot->errorCode;
+  const std::string errorMessage = slot->errorMessage;
+  if (!failed) {
+    vpImage<Type> &buffer = getBuffer(*slot, I);
+    vpDisplay *display = I.display;
+    swap(I, buffer);
+    buffer.display = I.display;
+    I.display = display;
+  }
+
+  slot->number += (long)m_slots.size() * m_step;
+  slot->name = g.getImageName(slot->number);
+  slot->state = SLOT_QUEUED;
+  m_pos = (m_pos + 1) % m_slots.size();
+  pthread_cond_broadcast(&m_cond);
+  pthread_mutex_unlock(&m_mutex);
+
+  if (failed) {
+    if (imageError) {
+      throw(vpImageException(errorCode, errorMessage));
+    }
+    throw(vpException(errorCode, errorMessage));
+  }
+}
+
+#endif
 
 /*!
   Elementary constructor.
 */
 vpDiskGrabber::vpDiskGrabber()
   : m_image_number(0), m_image_number_next(0), m_image_step(1), m_number_of_zero(0),
-    m_directory("/tmp"), m_base_name("I"), m_extension("pgm"), m_use_generic_name(false), m_generic_name("empty")
+    m_directory("/tmp"), m_base_name("I"), m_extension("pgm"), m_use_generic_name(false), m_generic_name("empty"),
+    m_prefetch_buffers(0), m_prefetch_threads(0), m_prefetcher(NULL)
 {
   init = false;
 }
@@ -55,7 +336,8 @@ vpDiskGrabber::vpDiskGrabber()
 */
 vpDiskGrabber::vpDiskGrabber(const std::string &generic_name)
   : m_image_number(0), m_image_number_next(0), m_image_step(1), m_number_of_zero(0),
-    m_directory("/tmp"), m_base_name("I"), m_extension("pgm"), m_use_generic_name(true), m_generic_name(generic_name)
+    m_directory("/tmp"), m_base_name("I"), m_extension("pgm"), m_use_generic_name(true), m_generic_name(generic_name),
+    m_prefetch_buffers(0), m_prefetch_threads(0), m_prefetcher(NULL)
 {
   init = false;
 }
@@ -77,11 +359,46 @@ vpDiskGrabber::vpDiskGrabber(const std::string &dir, const std::string &basename
                              int step, unsigned int noz,
                              const std::string &ext)
   : m_image_number(number), m_image_number_next(number), m_image_step(step), m_number_of_zero(noz),
-    m_directory(dir), m_base_name(basename), m_extension(ext), m_use_generic_name(false), m_generic_name("empty")
+    m_directory(dir), m_base_name(basename), m_extension(ext), m_use_generic_name(false), m_generic_name("empty"),
+    m_prefetch_buffers(0), m_prefetch_threads(0), m_prefetcher(NULL)
 {
   init = false;
 }
 
+/*!
+  Copy constructor. The prefetch settings are copied, but not the images already
+  decoded in advance.
+*/
+vpDiskGrabber::vpDiskGrabber(const vpDiskGrabber &g)
+  : vpFrameGrabber(g), m_image_number(0), m_image_number_next(0), m_image_step(1), m_number_of_zero(0),
+    m_directory(), m_base_name(), m_extension(), m_use_generic_name(false), m_generic_name(),
+    m_prefetch_buffers(0), m_prefetch_threads(0), m_prefetcher(NULL)
+{
+  *this = g;
+}
+
+/*!
+  Copy operator. The prefetch settings are copied, but not the images already
+  decoded in advance.
+*/
+vpDiskGrabber &vpDiskGrabber::operator=(const vpDiskGrabber &g)
+{
+  if (this != &g) {
+    vpFrameGrabber::operator=(g);
+    m_image_number = g.m_image_number;
+    m_image_number_next = g.m_image_number_next;
+    m_image_step = g.m_image_step;
+    m_number_of_zero = g.m_number_of_zero;
+    m_directory = g.m_directory;
+    m_base_name = g.m_base_name;
+    m_extension = g.m_extension;
+    m_use_generic_name = g.m_use_generic_name;
+    m_generic_name = g.m_generic_name;
+    setPrefetch(g.m_prefetch_buffers, g.m_prefetch_threads);
+  }
+  return *this;
+}
+
 /*!
   Read the first image of the sequence.
   The image number is not incremented.
@@ -143,6 +460,28 @@ vpDiskGrabber::open(vpImage<float> &I)
   init = true;
 }
 
+/*!
+  Read the image with the current image number, either from the disk or from the images
+  decoded in advance if the prefetch mode is enabled.
+*/
+template<class Type>
+void
+vpDiskGrabber::read(vpImage<Type> &I)
+{
+#if defined(VISP_HAVE_PTHREAD)
+  if (m_prefetcher != NULL) {
+    m_prefetcher->acquire(I, *this);
+  }
+  else
+#endif
+  {
+    readImage(I, getImageName(m_image_number));
+  }
+
+  width = I.getWidth();
+  height = I.getHeight();
+}
+
 /*!
   Acquire an image reading the next image from the disk.
   After this call, the image number is incremented considering the step.
@@ -153,22 +492,8 @@ void
 vpDiskGrabber::acquire(vpImage<unsigned char> &I)
 {
   m_image_number = m_image_number_next;
-  std::stringstream ss;
-
-  if(m_use_generic_name) {
-    char filename[FILENAME_MAX];
-    sprintf(filename, m_generic_name.c_str(), m_image_number);
-    ss << filename;
-  }
-  else {
-    ss << m_directory << "/" << m_base_name << std::setfill('0') << std::setw(m_number_of_zero) << m_image_number << "." << m_extension;
-  }
-
   m_image_number_next += m_image_step;
-  vpImageIo::read(I, ss.str()) ;
-
-  width = I.getWidth();
-  height = I.getHeight();
+  read(I);
 }
 
 /*!
@@ -181,23 +506,8 @@ void
 vpDiskGrabber::acquire(vpImage<vpRGBa> &I)
 {
   m_image_number = m_image_number_next;
-  std::stringstream ss;
-
-  if(m_use_generic_name) {
-    char filename[FILENAME_MAX];
-    sprintf(filename, m_generic_name.c_str(), m_image_number);
-    ss << filename;
-  }
-  else {
-    ss << m_directory << "/" << m_base_name << std::setfill('0') << std::setw(m_number_of_zero) << m_image_number << "." << m_extension;
-  }
-
   m_image_number_next += m_image_step;
-
-  vpImageIo::read(I, ss.str()) ;
-
-  width = I.getWidth();
-  height = I.getHeight();
+  read(I);
 }
 
 /*!
@@ -210,27 +520,14 @@ void
 vpDiskGrabber::acquire(vpImage<float> &I)
 {
   m_image_number = m_image_number_next;
-  std::stringstream ss;
-  if(m_use_generic_name) {
-    char filename[FILENAME_MAX];
-    sprintf(filename, m_generic_name.c_str(), m_image_number);
-    ss << filename;
-  }
-  else {
-    ss << m_directory << "/" << m_base_name << std::setfill('0') << std::setw(m_number_of_zero) << m_image_number << "." << m_extension;
-  }
-
   m_image_number_next += m_image_step;
-
-  vpImageIo::readPFM(I, ss.str());
-
-  width = I.getWidth();
-  height = I.getHeight();
+  read(I);
 }
 
 /*!
   Acquire an image reading the image with number \e img_number from the disk.
-  After this call, the image number is incremented considering the step.
+  After this call, the image number is set to \e img_number and the next image
+  number is incremented considering the step.
 
   \param I : The image read from a file.
   \param img_number : The number of the desired image.
@@ -238,28 +535,15 @@ vpDiskGrabber::acquire(vpImage<float> &I)
 void
 vpDiskGrabber::acquire(vpImage<unsigned char> &I, long img_number)
 {
-  m_image_number = m_image_number_next;
-  std::stringstream ss;
-  if(m_use_generic_name) {
-    char filename[FILENAME_MAX];
-    sprintf(filename, m_generic_name.c_str(), m_image_number);
-    ss << filename;
-  }
-  else {
-    ss << m_directory << "/" << m_base_name << std::setfill('0') << std::setw(m_number_of_zero) << img_number << "." << m_extension;
-  }
-
-  m_image_number_next += m_image_step;
-
-  vpImageIo::read(I, ss.str());
-
-  width = I.getWidth();
-  height = I.getHeight();
+  m_image_number = img_number;
+  m_image_number_next = img_number + m_image_step;
+  read(I);
 }
 
 /*!
   Acquire an image reading the image with number \e img_number from the disk.
-  After this call, the image number is incremented considering the step.
+  After this call, the image number is set to \e img_number and the next image
+  number is incremented considering the step.
 
   \param I : The image read from a file.
   \param img_number : The number of the desired image.
@@ -267,29 +551,16 @@ vpDiskGrabber::acquire(vpImage<unsigned char> &I, long img_number)
 void
 vpDiskGrabber::acquire(vpImage<vpRGBa> &I, long img_number)
 {
-  m_image_number = m_image_number_next;
-  std::stringstream ss;
-  if(m_use_generic_name) {
-    char filename[FILENAME_MAX];
-    sprintf(filename, m_generic_name.c_str(), m_image_number);
-    ss << filename;
-  }
-  else {
-    ss << m_directory << "/" << m_base_name << std::setfill('0') << std::setw(m_number_of_zero) << img_number << "." << m_extension;
-  }
-
-  m_image_number_next += m_image_step;
-
-  vpImageIo::read(I, ss.str());
-
-  width = I.getWidth();
-  height = I.getHeight();
+  m_image_number = img_number;
+  m_image_number_next = img_number + m_image_step;
+  read(I);
 }
 
 
 /*!
   Acquire an image reading the pfm image with number \e img_number from the disk.
-  After this call, the image number is incremented considering the step.
+  After this call, the image number is set to \e img_number and the next image
+  number is incremented considering the step.
 
   \param I : The image read from a file.
   \param img_number : The number of the desired image.
@@ -297,23 +568,26 @@ vpDiskGrabber::acquire(vpImage<vpRGBa> &I, long img_number)
 void
 vpDiskGrabber::acquire(vpImage<float> &I, long img_number)
 {
-  m_image_number = m_image_number_next;
-  std::stringstream ss;
+  m_image_number = img_number;
+  m_image_number_next = img_number + m_image_step;
+  read(I);
+}
+
+/*!
+  Return the name of the file of the image with number \e number.
+*/
+std::string
+vpDiskGrabber::getImageName(long number) const
+{
   if(m_use_generic_name) {
     char filename[FILENAME_MAX];
-    sprintf(filename, m_generic_name.c_str(), m_image_number);
-    ss << filename;
-  }
-  else {
-    ss << m_directory << "/" << m_base_name << std::setfill('0') << std::setw(m_number_of_zero) << img_number << "." << m_extension;
+    sprintf(filename, m_generic_name.c_str(), number);
+    return filename;
   }
 
-  m_image_number_next += m_image_step;
-
-  vpImageIo::readPFM(I, ss.str());
-
-  width = I.getWidth();
-  height = I.getHeight();
+  std::stringstream ss;
+  ss << m_directory << "/" << m_base_name << std::setfill('0') << std::setw(m_number_of_zero) << number << "." << m_extension;
+  return ss.str();
 }
 
 /*!
@@ -329,12 +603,11 @@ vpDiskGrabber::close()
 
 
 /*!
-  Destructor
-
-  In fact nothing to destroy...
+  Destructor. Stop the threads of the prefetch mode.
  */
 vpDiskGrabber::~vpDiskGrabber()
 {
+  setPrefetch(0);
 }
 
 
@@ -375,6 +648,44 @@ vpDiskGrabber::setImageNumber(long number)
   m_image_number_next = number;
 }
 
+/*!
+  Enable or disable the prefetch mode.
+
+  In the prefetch mode, \e nbThreads background threads read and decode the images
+  that follow the current one into a ring of \e nbBuffers images. acquire() returns
+  the images in the same order as without prefetch, waiting if needed for the image to
+  be decoded, and the images are not copied: the buffer of the image given to acquire()
+  is recycled to decode a next image. When the image number, the step, the name of the
+  images or the type of the images change, the images decoded in advance are discarded.
+
+  An error when reading an image is reported by acquire() when this image is requested,
+  so that reading the images beyond the end of the sequence in advance is harmless.
+
+  \param nbBuffers : Number of images decoded in advance. 0 disables the prefetch mode.
+  \param nbThreads : Number of decoding threads, at most \e nbBuffers.
+
+  \note The prefetch mode needs pthread. Without it the images are read when they are
+  requested.
+*/
+void
+vpDiskGrabber::setPrefetch(unsigned int nbBuffers, unsigned int nbThreads)
+{
+  nbThreads = (std::max)(1u, (std::min)(nbThreads, nbBuffers));
+  if (nbBuffers == m_prefetch_buffers && (nbBuffers == 0 || nbThreads == m_prefetch_threads)) {
+    return;
+  }
+
+#if defined(VISP_HAVE_PTHREAD)
+  delete m_prefetcher;
+  m_prefetcher = NULL;
+  if (nbBuffers > 0) {
+    m_prefetcher = new Prefetcher(nbBuffers, nbThreads);
+  }
+#endif
+  m_prefetch_buffers = nbBuffers;
+  m_prefetch_threads = (nbBuffers > 0) ? nbThreads : 0;
+}
+
 /*!
   Set the step between two images.
 */
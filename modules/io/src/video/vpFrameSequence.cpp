@@ -0,0 +1,393 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Common definitions of the frame sequence container.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpFrameSequence.cpp
+  \brief Common definitions of the frame sequence container.
+*/
+
+#include <string.h> //memcpy
+#include <vector>
+
+#include <visp3/core/vpException.h>
+#include <visp3/io/vpFrameSequence.h>
+
+namespace {
+  //Magic numbers and version of the frame sequence file
+  const char frameSequenceMagic[8] = { 'V', 'P', 'F', 'R', 'M', 'S', 'E', 'Q' };
+  const char frameMagic[4] = { 'V', 'P', 'F', 'R' };
+  const unsigned int frameSequenceVersion = 1;
+  //Flags of a frame header
+  const unsigned int frameHasPose = 0x1;
+
+  //Parameters of the LZ4 block format: a match is at least 4 bytes long, the last
+  //5 bytes are always literals and the last match starts at least 12 bytes before the end
+  const size_t lz4MinMatch = 4;
+  const size_t lz4LastLiterals = 5;
+  const size_t lz4MatchFindLimit = 12;
+  const size_t lz4MaxDistance = 65535;
+  const unsigned int lz4HashLog = 16;
+
+  //Store an unsigned 32 bits integer in little endian
+  void storeUInt32LE(unsigned char *ptr, const uint32_t value) {
+    ptr[0] = (unsigned char) value;
+    ptr[1] = (unsigned char) (value >> 8);
+    ptr[2] = (unsigned char) (value >> 16);
+    ptr[3] = (unsigned char) (value >> 24);
+  }
+
+  //Load an unsigned 32 bits integer stored in little endian
+  uint32_t loadUInt32LE(const unsigned char *ptr) {
+    return (uint32_t) ptr[0] | ((uint32_t) ptr[1] << 8) | ((uint32_t) ptr[2] << 16) | ((uint32_t) ptr[3] << 24);
+  }
+
+  //Store a double in little endian
+  void storeDoubleLE(unsigned char *ptr, const double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    storeUInt32LE(ptr, (uint32_t) bits);
+    storeUInt32LE(ptr + 4, (uint32_t) (bits >> 32));
+  }
+
+  //Load a double stored in little endian
+  double loadDoubleLE(const unsigned char *ptr) {
+    uint64_t bits = (uint64_t) loadUInt32LE(ptr) | ((uint64_t) loadUInt32LE(ptr + 4) << 32);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  inline uint32_t lz4Read32(const unsigned char *ptr) {
+    uint32_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return value;
+  }
+
+  inline uint32_t lz4Hash(const uint32_t sequence) {
+    return (sequence * 2654435761U) >> (32 - lz4HashLog);
+  }
+
+  //Write the part of a literal or match length that does not fit in the token
+  unsigned char *lz4WriteLength(unsigned char *op, size_t length) {
+    while (length >= 255) {
+      *op++ = 255;
+      length -= 255;
+    }
+    *op++ = (unsigned char) length;
+    return op;
+  }
+
+  //Read the part of a literal or match length that does not fit in the token
+  size_t lz4ReadLength(const unsigned char *&ip, const unsigned char *iend) {
+    size_t length = 0;
+    unsigned char byte;
+    do {
+      if (ip >= iend) {
+        throw vpException(vpException::ioError, "Corrupted LZ4 data");
+      }
+      byte = *ip++;
+      length += byte;
+    } while (byte == 255);
+    return length;
+  }
+}
+
+/*!
+  Compress a buffer in the LZ4 block format.
+
+  The compression is greedy, with a hash table of the last positions of 4 bytes
+  sequences, and skips faster over incompressible data. The output can be
+  decompressed by decompressLZ4() or by any LZ4 block decoder.
+
+  \param src : Data to compress.
+  \param size : Size of the data, in bytes.
+  \param dst : Compressed data.
+  \param capacity : Size of \e dst, at least getLZ4Bound(size).
+  \return The size of the compressed data, in bytes.
+
+  \exception vpException::badValue : If \e capacity is lower than getLZ4Bound(size).
+*/
+size_t vpFrameSequence::compressLZ4(const unsigned char *src, const size_t size, unsigned char *dst, const size_t capacity)
+{
+  if (capacity < getLZ4Bound(size)) {
+    throw vpException(vpException::badValue, "The LZ4 output buffer is too small");
+  }
+
+  unsigned char *op = dst;
+  const unsigned char *anchor = src;
+
+  if (size > lz4MatchFindLimit) {
+    std::vector<uint32_t> table((size_t) 1 << lz4HashLog, 0);
+    const unsigned char *const mflimit = src + size - lz4MatchFindLimit;
+    const unsigned char *const matchlimit = src + size - lz4LastLiterals;
+    const unsigned char *ip = src;
+    unsigned int misses = 0;
+
+    while (ip < mflimit) {
+      const uint32_t sequence = lz4Read32(ip);
+      uint32_t &entry = table[lz4Hash(sequence)];
+      const unsigned char *ref = src + entry;
+      entry = (uint32_t) (ip - src);
+
+      if (ref >= ip || (size_t) (ip - ref) > lz4MaxDistance || lz4Read32(ref) != sequence) {
+        // Skip faster over data that does not compress
+        ip += 1 + (misses++ >> 6);
+        continue;
+      }
+      misses = 0;
+
+      // Extend the match backward and forward
+      while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+        ip--;
+        ref--;
+      }
+      const unsigned char *end = ip + lz4MinMatch;
+      const unsigned char *refEnd = ref + lz4MinMatch;
+      while (end < matchlimit && *end == *refEnd) {
+        end++;
+        refEnd++;
+      }
+
+      // Sequence: token, literals, offset and match length
+      const size_t literalLength = (size_t) (ip - anchor);
+      const size_t matchLength = (size_t) (end - ip) - lz4MinMatch;
+      unsigned char *token = op++;
+      *token = (unsigned char) (((literalLength >= 15) ? 15 : literalLength) << 4);
+      if (literalLength >= 15) {
+        op = lz4WriteLength(op, literalLength - 15);
+      }
+      memcpy(op, anchor, literalLength);
+      op += literalLength;
+
+      const size_t offset = (size_t) (ip - ref);
+      *op++ = (unsigned char) offset;
+      *op++ = (unsigned char) (offset >> 8);
+      if (matchLength >= 15) {
+        *token |= 15;
+        op = lz4WriteLength(op, matchLength - 15);
+      } else {
+        *token |= (unsigned char) matchLength;
+      }
+
+      ip = end;
+      anchor = ip;
+    }
+  }
+
+  // Last literals
+  const size_t literalLength = (size_t) (src + size - anchor);
+  unsigned char *token = op++;
+  *token = (unsigned char) (((literalLength >= 15) ? 15 : literalLength) << 4);
+  if (literalLength >= 15) {
+    op = lz4WriteLength(op, literalLength - 15);
+  }
+  memcpy(op, anchor, literalLength);
+  op += literalLength;
+
+  return (size_t) (op - dst);
+}
+
+/*!
+  Decompress a buffer in the LZ4 block format.
+
+  \param src : Compressed data.
+  \param size : Size of the compressed data, in bytes.
+  \param dst : Decompressed data.
+  \param capacity : Size of \e dst.
+  \return The size of the decompressed data, in bytes.
+
+  \exception vpException::ioError : If the data are corrupted or do not fit in \e dst.
+*/
+size_t vpFrameSequence::decompressLZ4(const unsigned char *src, const size_t size, unsigned char *dst, const size_t capacity)
+{
+  const unsigned char *ip = src;
+  const unsigned char *const iend = src + size;
+  unsigned char *op = dst;
+  unsigned char *const oend = dst + capacity;
+
+  for (;;) {
+    if (ip >= iend) {
+      throw vpException(vpException::ioError, "Corrupted LZ4 data");
+    }
+    const unsigned int token = *ip++;
+
+    size_t literalLength = token >> 4;
+    if (literalLength == 15) {
+      literalLength += lz4ReadLength(ip, iend);
+    }
+    if ((size_t) (iend - ip) < literalLength || (size_t) (oend - op) < literalLength) {
+      throw vpException(vpException::ioError, "Corrupted LZ4 data");
+    }
+    memcpy(op, ip, literalLength);
+    op += literalLength;
+    ip += literalLength;
+
+    // The last sequence only has literals
+    if (ip == iend) {
+      break;
+    }
+
+    if (iend - ip < 2) {
+      throw vpException(vpException::ioError, "Corrupted LZ4 data");
+    }
+    const size_t offset = (size_t) ip[0] | ((size_t) ip[1] << 8);
+    ip += 2;
+    if (offset == 0 || offset > (size_t) (op - dst)) {
+      throw vpException(vpException::ioError, "Corrupted LZ4 data");
+    }
+
+    size_t matchLength = token & 15;
+    if (matchLength == 15) {
+      matchLength += lz4ReadLength(ip, iend);
+    }
+    matchLength += lz4MinMatch;
+    if ((size_t) (oend - op) < matchLength) {
+      throw vpException(vpException::ioError, "Corrupted LZ4 data");
+    }
+
+    const unsigned char *match = op - offset;
+    if (offset >= matchLength) {
+      memcpy(op, match, matchLength);
+    } else {
+      // Overlapping copy that repeats the last offset bytes
+      for (size_t i = 0; i < matchLength; i++) {
+        op[i] = match[i];
+      }
+    }
+    op += matchLength;
+  }
+
+  return (size_t) (op - dst);
+}
+
+/*!
+  Return the size of a pixel of a frame, in bytes.
+*/
+unsigned int vpFrameSequence::getPixelSize(const vpFrameType &type)
+{
+  switch (type) {
+  case GREY_FRAME:
+    return 1;
+  case DEPTH_FRAME:
+    return 2;
+  case RGBA_FRAME:
+  case FLOAT_FRAME:
+  default:
+    return 4;
+  }
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+//Round up an offset to the block alignment
+uint64_t vpFrameSequence::alignOffset(const uint64_t offset)
+{
+  return (offset + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT;
+}
+
+void vpFrameSequence::storeUInt64(unsigned char *data, const uint64_t value)
+{
+  storeUInt32LE(data, (uint32_t) value);
+  storeUInt32LE(data + 4, (uint32_t) (value >> 32));
+}
+
+void vpFrameSequence::loadUInt64(const unsigned char *data, uint64_t &value)
+{
+  value = (uint64_t) loadUInt32LE(data) | ((uint64_t) loadUInt32LE(data + 4) << 32);
+}
+
+void vpFrameSequence::encodeFileHeader(const uint64_t frameCount, const uint64_t indexOffset, unsigned char *data)
+{
+  memset(data, 0, FILE_HEADER_SIZE);
+  memcpy(data, frameSequenceMagic, sizeof(frameSequenceMagic));
+  storeUInt32LE(data + 8, frameSequenceVersion);
+  storeUInt64(data + 16, frameCount);
+  storeUInt64(data + 24, indexOffset);
+}
+
+bool vpFrameSequence::decodeFileHeader(const unsigned char *data, uint64_t &frameCount, uint64_t &indexOffset)
+{
+  if (memcmp(data, frameSequenceMagic, sizeof(frameSequenceMagic)) != 0 ||
+      loadUInt32LE(data + 8) != frameSequenceVersion) {
+    return false;
+  }
+  loadUInt64(data + 16, frameCount);
+  loadUInt64(data + 24, indexOffset);
+  return true;
+}
+
+void vpFrameSequence::encodeFrameHeader(const vpFrameHeader &header, unsigned char *data)
+{
+  memset(data, 0, FRAME_HEADER_SIZE);
+  memcpy(data, frameMagic, sizeof(frameMagic));
+  storeUInt32LE(data + 4, (uint32_t) header.type);
+  storeUInt32LE(data + 8, header.width);
+  storeUInt32LE(data + 12, header.height);
+  storeUInt32LE(data + 16, (uint32_t) header.compression);
+  storeUInt32LE(data + 20, header.metadata.cameraId);
+  storeUInt32LE(data + 24, header.metadata.hasPose ? frameHasPose : 0);
+  storeUInt64(data + 32, header.storedSize);
+  storeDoubleLE(data + 40, header.metadata.timestamp);
+  for (unsigned int i = 0; i < 3; i++) {
+    for (unsigned int j = 0; j < 4; j++) {
+      storeDoubleLE(data + 48 + 8 * (4 * i + j), header.metadata.pose[i][j]);
+    }
+  }
+}
+
+bool vpFrameSequence::decodeFrameHeader(const unsigned char *data, vpFrameHeader &header)
+{
+  const uint32_t type = loadUInt32LE(data + 4);
+  const uint32_t compression = loadUInt32LE(data + 16);
+  if (memcmp(data, frameMagic, sizeof(frameMagic)) != 0 || type > FLOAT_FRAME || compression > LZ4_COMPRESSION) {
+    return false;
+  }
+
+  header.type = (vpFrameType) type;
+  header.width = loadUInt32LE(data + 8);
+  header.height = loadUInt32LE(data + 12);
+  header.compression = (vpCompressionType) compression;
+  header.metadata.cameraId = loadUInt32LE(data + 20);
+  header.metadata.hasPose = (loadUInt32LE(data + 24) & frameHasPose) != 0;
+  loadUInt64(data + 32, header.storedSize);
+  header.metadata.timestamp = loadDoubleLE(data + 40);
+  header.metadata.pose.eye();
+  for (unsigned int i = 0; i < 3; i++) {
+    for (unsigned int j = 0; j < 4; j++) {
+      header.metadata.pose[i][j] = loadDoubleLE(data + 48 + 8 * (4 * i + j));
+    }
+  }
+  return true;
+}
+#endif
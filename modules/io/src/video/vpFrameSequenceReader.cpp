@@ -0,0 +1,352 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Read a frame sequence container.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpFrameSequenceReader.cpp
+  \brief Read a frame sequence container.
+*/
+
+#include <algorithm>
+#include <string.h> //memcpy
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpImageConvert.h>
+#include <visp3/io/vpFrameSequenceReader.h>
+
+/*!
+  Default constructor. No file is open.
+*/
+vpFrameSequenceReader::vpFrameSequenceReader()
+  : m_file(), m_filename(), m_frames(), m_zeroCopy(true), m_grey(), m_color()
+{
+}
+
+/*!
+  Open a frame sequence file.
+
+  \param filename : Path of the file.
+  \exception vpException::ioError : If the file cannot be opened or is not a frame sequence.
+*/
+vpFrameSequenceReader::vpFrameSequenceReader(const std::string &filename)
+  : m_file(), m_filename(), m_frames(), m_zeroCopy(true), m_grey(), m_color()
+{
+  open(filename);
+}
+
+/*!
+  Destructor that unmaps the file.
+*/
+vpFrameSequenceReader::~vpFrameSequenceReader()
+{
+}
+
+/*!
+  Unmap the file. The images read without copy are no more valid.
+*/
+void vpFrameSequenceReader::close()
+{
+  m_file.close();
+  m_frames.clear();
+}
+
+/*!
+  Open a frame sequence file. A previously opened file is closed.
+
+  \param filename : Path of the file.
+  \exception vpException::ioError : If the file cannot be opened or is not a frame sequence.
+*/
+void vpFrameSequenceReader::open(const std::string &filename)
+{
+  close();
+  m_file.open(filename);
+  m_filename = filename;
+
+  try {
+    readIndex();
+  }
+  catch(...) {
+    close();
+    throw;
+  }
+}
+
+/*!
+  Read the frame index at the end of the file, or rebuild it if the file was not closed.
+*/
+void vpFrameSequenceReader::readIndex()
+{
+  const unsigned char *data = m_file.getData();
+  const uint64_t fileSize = m_file.getSize();
+  uint64_t frameCount = 0, indexOffset = 0;
+  if (fileSize < FILE_HEADER_SIZE || !decodeFileHeader(data, frameCount, indexOffset)) {
+    throw vpException(vpException::ioError, "%s is not a frame sequence", m_filename.c_str());
+  }
+
+  if (indexOffset == 0) {
+    rebuildIndex();
+    return;
+  }
+
+  if (indexOffset > fileSize || frameCount > (fileSize - indexOffset) / 8) {
+    throw vpException(vpException::ioError, "The frame sequence %s is truncated", m_filename.c_str());
+  }
+
+  m_frames.resize((size_t) frameCount);
+  for (size_t i = 0; i < m_frames.size(); i++) {
+    uint64_t offset;
+    loadUInt64(data + indexOffset + 8 * i, offset);
+    if (offset > fileSize || fileSize - offset < FRAME_HEADER_SIZE ||
+        !decodeFrameHeader(data + offset, m_frames[i]) ||
+        m_frames[i].storedSize > fileSize - offset - FRAME_HEADER_SIZE || !hasValidSize(m_frames[i])) {
+      throw vpException(vpException::ioError, "The frame %u of %s is corrupted", (unsigned int) i, m_filename.c_str());
+    }
+    m_frames[i].offset = offset;
+  }
+}
+
+/*!
+  Rebuild the frame index of a file that was not closed by going through the frames. A
+  frame truncated at the end of the file is ignored.
+*/
+void vpFrameSequenceReader::rebuildIndex()
+{
+  const unsigned char *data = m_file.getData();
+  const uint64_t fileSize = m_file.getSize();
+
+  uint64_t offset = alignOffset(FILE_HEADER_SIZE);
+  vpFrameHeader header;
+  while (offset < fileSize && fileSize - offset >= FRAME_HEADER_SIZE && decodeFrameHeader(data + offset, header) &&
+         header.storedSize <= fileSize - offset - FRAME_HEADER_SIZE && hasValidSize(header)) {
+    header.offset = offset;
+    m_frames.push_back(header);
+    offset = alignOffset(offset + FRAME_HEADER_SIZE + header.storedSize);
+  }
+}
+
+/*!
+  Check that the pixels of a frame fit in memory and, when the frame is not
+  compressed, that they are all stored in the file.
+*/
+bool vpFrameSequenceReader::hasValidSize(const vpFrameHeader &header)
+{
+  // The product of two 32 bits values cannot overflow 64 bits
+  const uint64_t nbPixels = (uint64_t) header.width * header.height;
+  const uint64_t pixelSize = getPixelSize(header.type);
+  if (nbPixels > (uint64_t) ((size_t) -1) / pixelSize) {
+    return false;
+  }
+  return header.compression != NO_COMPRESSION || header.storedSize >= nbPixels * pixelSize;
+}
+
+/*!
+  Return the header of a frame.
+*/
+const vpFrameSequence::vpFrameHeader &vpFrameSequenceReader::getHeader(const unsigned int index) const
+{
+  if (index >= m_frames.size()) {
+    throw vpException(vpException::badValue, "Frame %u is out of the %u frames of the sequence", index,
+                      (unsigned int) m_frames.size());
+  }
+  return m_frames[index];
+}
+
+/*!
+  Return the type of a frame.
+
+  \param index : Index of the frame, from 0 to getFrameCount() - 1.
+  \exception vpException::badValue : If the frame does not exist.
+*/
+vpFrameSequence::vpFrameType vpFrameSequenceReader::getFrameType(const unsigned int index) const
+{
+  return getHeader(index).type;
+}
+
+/*!
+  Return the height of a frame.
+
+  \param index : Index of the frame, from 0 to getFrameCount() - 1.
+  \exception vpException::badValue : If the frame does not exist.
+*/
+unsigned int vpFrameSequenceReader::getHeight(const unsigned int index) const
+{
+  return getHeader(index).height;
+}
+
+/*!
+  Return the timestamp, the camera id and the pose of a frame.
+
+  \param index : Index of the frame, from 0 to getFrameCount() - 1.
+  \exception vpException::badValue : If the frame does not exist.
+*/
+vpFrameSequence::vpFrameMetadata vpFrameSequenceReader::getMetadata(const unsigned int index) const
+{
+  return getHeader(index).metadata;
+}
+
+/*!
+  Return the width of a frame.
+
+  \param index : Index of the frame, from 0 to getFrameCount() - 1.
+  \exception vpException::badValue : If the frame does not exist.
+*/
+unsigned int vpFrameSequenceReader::getWidth(const unsigned int index) const
+{
+  return getHeader(index).width;
+}
+
+/*!
+  Set \e I to the pixels of a frame that has the same type as \e I.
+*/
+template<class Type>
+void vpFrameSequenceReader::readFrame(vpImage<Type> &I, const vpFrameHeader &header)
+{
+  unsigned char *pixels = m_file.getData() + header.offset + FRAME_HEADER_SIZE;
+  const size_t size = (size_t) header.width * header.height * sizeof(Type);
+
+#ifndef VISP_BIG_ENDIAN
+  if (m_zeroCopy && header.compression == NO_COMPRESSION) {
+    // The pixels are 64 bytes aligned in the mapped file
+    I.initView((Type *) pixels, header.height, header.width);
+    return;
+  }
+#endif
+
+  I.resize(header.height, header.width);
+  if (header.compression == LZ4_COMPRESSION) {
+    if (decompressLZ4(pixels, (size_t) header.storedSize, (unsigned char *) I.bitmap, size) != size) {
+      throw vpException(vpException::ioError, "Corrupted frame in %s", m_filename.c_str());
+    }
+  }
+  else if (size > 0) {
+    memcpy((unsigned char *) I.bitmap, pixels, size);
+  }
+
+#ifdef VISP_BIG_ENDIAN
+  if (sizeof(Type) == 2 || (sizeof(Type) == 4 && header.type == FLOAT_FRAME)) {
+    unsigned char *ptr = (unsigned char *) I.bitmap;
+    for (size_t i = 0; i < size; i += sizeof(Type)) {
+      std::reverse(ptr + i, ptr + i + sizeof(Type));
+    }
+  }
+#endif
+}
+
+/*!
+  Read a grey level frame. A color frame is converted to grey level.
+
+  \param I : Image read. When the zero-copy read is enabled and the frame is not
+  compressed, the image points to the mapped file and stays valid until the reader
+  is closed.
+  \param index : Index of the frame, from 0 to getFrameCount() - 1.
+  \exception vpException::badValue : If the frame does not exist or is a depth or float frame.
+  \exception vpException::ioError : If the frame is corrupted.
+*/
+void vpFrameSequenceReader::read(vpImage<unsigned char> &I, const unsigned int index)
+{
+  const vpFrameHeader &header = getHeader(index);
+  if (header.type == GREY_FRAME) {
+    readFrame(I, header);
+  }
+  else if (header.type == RGBA_FRAME) {
+    readFrame(m_color, header);
+    vpImageConvert::convert(m_color, I);
+  }
+  else {
+    throw vpException(vpException::badValue, "Frame %u is not a grey level or color frame", index);
+  }
+}
+
+/*!
+  Read a color frame. A grey level frame is converted to color.
+
+  \param I : Image read. When the zero-copy read is enabled and the frame is not
+  compressed, the image points to the mapped file and stays valid until the reader
+  is closed.
+  \param index : Index of the frame, from 0 to getFrameCount() - 1.
+  \exception vpException::badValue : If the frame does not exist or is a depth or float frame.
+  \exception vpException::ioError : If the frame is corrupted.
+*/
+void vpFrameSequenceReader::read(vpImage<vpRGBa> &I, const unsigned int index)
+{
+  const vpFrameHeader &header = getHeader(index);
+  if (header.type == RGBA_FRAME) {
+    readFrame(I, header);
+  }
+  else if (header.type == GREY_FRAME) {
+    readFrame(m_grey, header);
+    vpImageConvert::convert(m_grey, I);
+  }
+  else {
+    throw vpException(vpException::badValue, "Frame %u is not a grey level or color frame", index);
+  }
+}
+
+/*!
+  Read a depth frame.
+
+  \param I : Image read. When the zero-copy read is enabled and the frame is not
+  compressed, the image points to the mapped file and stays valid until the reader
+  is closed.
+  \param index : Index of the frame, from 0 to getFrameCount() - 1.
+  \exception vpException::badValue : If the frame does not exist or is not a depth frame.
+  \exception vpException::ioError : If the frame is corrupted.
+*/
+void vpFrameSequenceReader::read(vpImage<uint16_t> &I, const unsigned int index)
+{
+  const vpFrameHeader &header = getHeader(index);
+  if (header.type != DEPTH_FRAME) {
+    throw vpException(vpException::badValue, "Frame %u is not a depth frame", index);
+  }
+  readFrame(I, header);
+}
+
+/*!
+  Read a float frame.
+
+  \param I : Image read. When the zero-copy read is enabled and the frame is not
+  compressed, the image points to the mapped file and stays valid until the reader
+  is closed.
+  \param index : Index of the frame, from 0 to getFrameCount() - 1.
+  \exception vpException::badValue : If the frame does not exist or is not a float frame.
+  \exception vpException::ioError : If the frame is corrupted.
+*/
+void vpFrameSequenceReader::read(vpImage<float> &I, const unsigned int index)
+{
+  const vpFrameHeader &header = getHeader(index);
+  if (header.type != FLOAT_FRAME) {
+    throw vpException(vpException::badValue, "Frame %u is not a float frame", index);
+  }
+  readFrame(I, header);
+}
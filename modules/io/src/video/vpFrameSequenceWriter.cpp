@@ -0,0 +1,262 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Write a frame sequence container.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpFrameSequenceWriter.cpp
+  \brief Write a frame sequence container.
+*/
+
+#include <algorithm>
+
+#include <visp3/core/vpException.h>
+#include <visp3/io/vpFrameSequenceWriter.h>
+
+/*!
+  Default constructor. No file is open.
+*/
+vpFrameSequenceWriter::vpFrameSequenceWriter()
+  : m_file(), m_filename(), m_offsets(), m_position(0), m_compression(NO_COMPRESSION), m_buffer()
+{
+}
+
+/*!
+  Create a frame sequence file.
+
+  \param filename : Path of the file.
+  \exception vpException::ioError : If the file cannot be created.
+*/
+vpFrameSequenceWriter::vpFrameSequenceWriter(const std::string &filename)
+  : m_file(), m_filename(), m_offsets(), m_position(0), m_compression(NO_COMPRESSION), m_buffer()
+{
+  open(filename);
+}
+
+/*!
+  Destructor that closes the file.
+*/
+vpFrameSequenceWriter::~vpFrameSequenceWriter()
+{
+  try {
+    close();
+  }
+  catch(...) {
+  }
+}
+
+/*!
+  Write the frame index and close the file. Nothing is done if no file is open.
+
+  \exception vpException::ioError : If the index cannot be written.
+*/
+void vpFrameSequenceWriter::close()
+{
+  if (!m_file.is_open()) {
+    return;
+  }
+
+  // Frame index at the end of the file
+  const uint64_t indexOffset = alignOffset(m_position);
+  writePadding(indexOffset);
+  std::vector<unsigned char> index(8 * m_offsets.size());
+  for (size_t i = 0; i < m_offsets.size(); i++) {
+    storeUInt64(&index[8 * i], m_offsets[i]);
+  }
+  if (!index.empty()) {
+    m_file.write((const char *) &index[0], (std::streamsize) index.size());
+  }
+
+  // The header is completed once the whole file is written
+  unsigned char header[FILE_HEADER_SIZE];
+  encodeFileHeader(m_offsets.size(), indexOffset, header);
+  m_file.seekp(0);
+  m_file.write((const char *) header, FILE_HEADER_SIZE);
+
+  const bool failed = !m_file.good();
+  m_file.close();
+  m_offsets.clear();
+  m_position = 0;
+  if (failed) {
+    throw vpException(vpException::ioError, "Cannot write the frame index of %s", m_filename.c_str());
+  }
+}
+
+/*!
+  Create a frame sequence file. A previously opened file is closed.
+
+  \param filename : Path of the file.
+  \exception vpException::ioError : If the file cannot be created.
+*/
+void vpFrameSequenceWriter::open(const std::string &filename)
+{
+  close();
+
+  m_file.open(filename.c_str(), std::ofstream::binary | std::ofstream::trunc);
+  if (!m_file.is_open()) {
+    throw vpException(vpException::ioError, "Cannot create the frame sequence %s", filename.c_str());
+  }
+  m_filename = filename;
+
+  // No frame and no index until the file is closed
+  unsigned char header[FILE_HEADER_SIZE];
+  encodeFileHeader(0, 0, header);
+  m_file.write((const char *) header, FILE_HEADER_SIZE);
+  m_position = FILE_HEADER_SIZE;
+}
+
+/*!
+  Append a grey level frame.
+
+  \param I : Frame to write.
+  \param metadata : Timestamp, camera id and pose of the frame.
+  \exception vpException::notInitialized : If no file is open.
+  \exception vpException::ioError : If the frame cannot be written.
+*/
+void vpFrameSequenceWriter::write(const vpImage<unsigned char> &I, const vpFrameMetadata &metadata)
+{
+  writeFrame(GREY_FRAME, I.getWidth(), I.getHeight(), I.bitmap, metadata);
+}
+
+/*!
+  Append a color frame.
+
+  \param I : Frame to write.
+  \param metadata : Timestamp, camera id and pose of the frame.
+  \exception vpException::notInitialized : If no file is open.
+  \exception vpException::ioError : If the frame cannot be written.
+*/
+void vpFrameSequenceWriter::write(const vpImage<vpRGBa> &I, const vpFrameMetadata &metadata)
+{
+  writeFrame(RGBA_FRAME, I.getWidth(), I.getHeight(), (const unsigned char *) I.bitmap, metadata);
+}
+
+/*!
+  Append a depth frame.
+
+  \param I : Frame to write.
+  \param metadata : Timestamp, camera id and pose of the frame.
+  \exception vpException::notInitialized : If no file is open.
+  \exception vpException::ioError : If the frame cannot be written.
+*/
+void vpFrameSequenceWriter::write(const vpImage<uint16_t> &I, const vpFrameMetadata &metadata)
+{
+  writeFrame(DEPTH_FRAME, I.getWidth(), I.getHeight(), (const unsigned char *) I.bitmap, metadata);
+}
+
+/*!
+  Append a float frame.
+
+  \param I : Frame to write.
+  \param metadata : Timestamp, camera id and pose of the frame.
+  \exception vpException::notInitialized : If no file is open.
+  \exception vpException::ioError : If the frame cannot be written.
+*/
+void vpFrameSequenceWriter::write(const vpImage<float> &I, const vpFrameMetadata &metadata)
+{
+  writeFrame(FLOAT_FRAME, I.getWidth(), I.getHeight(), (const unsigned char *) I.bitmap, metadata);
+}
+
+/*!
+  Write the header and the pixels of a frame.
+*/
+void vpFrameSequenceWriter::writeFrame(const vpFrameType &type, const unsigned int width, const unsigned int height,
+                                       const unsigned char *data, const vpFrameMetadata &metadata)
+{
+  if (!m_file.is_open()) {
+    throw vpException(vpException::notInitialized, "No frame sequence is open");
+  }
+
+  const size_t size = (size_t) width * height * getPixelSize(type);
+  const unsigned char *pixels = data;
+
+#ifdef VISP_BIG_ENDIAN
+  // The pixels are stored in little endian
+  std::vector<unsigned char> swapped;
+  const size_t elemSize = (type == DEPTH_FRAME || type == FLOAT_FRAME) ? getPixelSize(type) : 1;
+  if (elemSize > 1) {
+    swapped.assign(data, data + size);
+    for (size_t i = 0; i < size; i += elemSize) {
+      std::reverse(&swapped[i], &swapped[i] + elemSize);
+    }
+    pixels = &swapped[0];
+  }
+#endif
+
+  vpFrameHeader header;
+  header.type = type;
+  header.width = width;
+  header.height = height;
+  header.compression = NO_COMPRESSION;
+  header.storedSize = size;
+  header.metadata = metadata;
+
+  if (m_compression == LZ4_COMPRESSION && size > 0) {
+    m_buffer.resize(getLZ4Bound(size));
+    const size_t compressedSize = compressLZ4(pixels, size, &m_buffer[0], m_buffer.size());
+    // The pixels stay raw when they do not compress
+    if (compressedSize < size) {
+      header.compression = LZ4_COMPRESSION;
+      header.storedSize = compressedSize;
+      pixels = &m_buffer[0];
+    }
+  }
+
+  const uint64_t offset = alignOffset(m_position);
+  writePadding(offset);
+  unsigned char headerData[FRAME_HEADER_SIZE];
+  encodeFrameHeader(header, headerData);
+  m_file.write((const char *) headerData, FRAME_HEADER_SIZE);
+  if (header.storedSize > 0) {
+    m_file.write((const char *) pixels, (std::streamsize) header.storedSize);
+  }
+  if (!m_file.good()) {
+    throw vpException(vpException::ioError, "Cannot write a frame in %s", m_filename.c_str());
+  }
+
+  m_position = offset + FRAME_HEADER_SIZE + header.storedSize;
+  m_offsets.push_back(offset);
+}
+
+/*!
+  Write zeros up to the given offset of the file.
+*/
+void vpFrameSequenceWriter::writePadding(const uint64_t offset)
+{
+  const char zeros[BLOCK_ALIGNMENT] = { 0 };
+  while (m_position < offset) {
+    const uint64_t size = (std::min)(offset - m_position, (uint64_t) BLOCK_ALIGNMENT);
+    m_file.write(zeros, (std::streamsize) size);
+    m_position += size;
+  }
+}
@@ -55,13 +55,13 @@
 Basic constructor.
 */
 vpVideoReader::vpVideoReader()
-  : vpFrameGrabber(), imSequence(NULL),
+  : vpFrameGrabber(), imSequence(NULL), frameSequence(NULL), frameSequenceNext(0),
 #if VISP_HAVE_OPENCV_VERSION >= 0x020100
   capture(), frame(),
 #endif
   formatType(FORMAT_UNKNOWN), initFileName(false), isOpen(false), frameCount(0),
   firstFrame(0), lastFrame(0), firstFrameIndexIsSet(false), lastFrameIndexIsSet(false),
-  frameStep(1), frameRate(0.)
+  frameStep(1), frameRate(0.), prefetchBuffers(0), prefetchThreads(1)
 {
 }
 
@@ -74,6 +74,7 @@ vpVideoReader::~vpVideoReader()
   {
     delete imSequence;
   }
+  delete frameSequence;
 }
 
 
@@ -136,6 +137,26 @@ void vpVideoReader::setFileName(const std::string &filename)
   setFileName(filename.c_str());
 }
 
+/*!
+  Enable or disable the prefetch mode when reading a sequence of images: \e nbThreads
+  background threads read and decode the next images of the sequence into a ring of
+  \e nbBuffers images while the current one is processed. The frame step and the frames
+  requested with getFrame() are taken into account. See vpDiskGrabber::setPrefetch().
+
+  This setting has no effect when reading a video file.
+
+  \param nbBuffers : Number of images decoded in advance. 0 disables the prefetch mode.
+  \param nbThreads : Number of decoding threads.
+*/
+void vpVideoReader::setPrefetch(unsigned int nbBuffers, unsigned int nbThreads)
+{
+  prefetchBuffers = nbBuffers;
+  prefetchThreads = nbThreads;
+  if (imSequence != NULL) {
+    imSequence->setPrefetch(prefetchBuffers, prefetchThreads);
+  }
+}
+
 /*!
   Open video stream and get first and last frame indexes.
 */
@@ -151,6 +172,7 @@ void vpVideoReader::getProperties()
     imSequence = new vpDiskGrabber;
     imSequence->setGenericName(fileName);
     imSequence->setStep(frameStep);
+    imSequence->setPrefetch(prefetchBuffers, prefetchThreads);
     if (firstFrameIndexIsSet)
     {
       imSequence->setImageNumber(firstFrame);
@@ -181,6 +203,18 @@ void vpVideoReader::getProperties()
       "To read video files ViSP should be build with opencv 3rd >= 2.1.0 party libraries."));
 #endif
   }
+  else if (formatType == FORMAT_FRAME_SEQUENCE)
+  {
+    delete frameSequence;
+    frameSequence = new vpFrameSequenceReader(fileName);
+    // The images given to acquire() own their pixels
+    frameSequence->setZeroCopy(false);
+    if (frameSequence->getFrameCount() > 0) {
+      width = frameSequence->getWidth(0);
+      height = frameSequence->getHeight(0);
+    }
+    frameRate = -1.;
+  }
   else if (formatType == FORMAT_UNKNOWN)
   {
     //vpERROR_TRACE("The format of the file does not correspond to a readable format.");
@@ -291,6 +325,10 @@ void vpVideoReader::acquire(vpImage< vpRGBa > &I)
       imSequence->setImageNumber(frameCount);
     }
   }
+  else if (frameSequence != NULL)
+  {
+    acquireFrameSequence(I);
+  }
 #if VISP_HAVE_OPENCV_VERSION >= 0x020100
   else
   {
@@ -372,6 +410,10 @@ void vpVideoReader::acquire(vpImage< unsigned char > &I)
       imSequence->setImageNumber(frameCount);
     }
   }
+  else if (frameSequence != NULL)
+  {
+    acquireFrameSequence(I);
+  }
 #if VISP_HAVE_OPENCV_VERSION >= 0x020100
   else
   {
@@ -464,6 +506,10 @@ bool vpVideoReader::getFrame(vpImage<vpRGBa> &I, long frame_index)
       return false;
     }
   }
+  else if (frameSequence != NULL)
+  {
+    return getFrameSequenceFrame(I, frame_index);
+  }
   else
   {
 #if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x030000)
@@ -547,6 +593,10 @@ bool vpVideoReader::getFrame(vpImage<unsigned char> &I, long frame_index)
       return false;
     }
   }
+  else if (frameSequence != NULL)
+  {
+    return getFrameSequenceFrame(I, frame_index);
+  }
   else
   {
 #if VISP_HAVE_OPENCV_VERSION >= 0x030000
@@ -600,6 +650,38 @@ bool vpVideoReader::getFrame(vpImage<unsigned char> &I, long frame_index)
 }
 
 
+/*!
+  Read the next frame of a frame sequence file. As for a sequence of images, the
+  frame index stays on the last frame when the end of the sequence is reached.
+*/
+template<class Type>
+void vpVideoReader::acquireFrameSequence(vpImage<Type> &I)
+{
+  frameSequence->read(I, (unsigned int)frameSequenceNext);
+  frameCount = frameSequenceNext;
+  if (frameCount + frameStep <= lastFrame && frameCount + frameStep >= firstFrame) {
+    frameSequenceNext = frameCount + frameStep;
+  }
+}
+
+/*!
+  Read a frame of a frame sequence file. The next call to acquire() reads the same frame.
+*/
+template<class Type>
+bool vpVideoReader::getFrameSequenceFrame(vpImage<Type> &I, long frame_index)
+{
+  if (frame_index < 0 || frame_index >= (long)frameSequence->getFrameCount()) {
+    vpERROR_TRACE("Couldn't find the %ld th frame", frame_index);
+    return false;
+  }
+  frameSequence->read(I, (unsigned int)frame_index);
+  width = I.getWidth();
+  height = I.getHeight();
+  frameCount = frame_index;
+  frameSequenceNext = frame_index;
+  return true;
+}
+
 /*!
 Gets the format of the file(s) which has/have to be read.
 
@@ -700,6 +782,10 @@ vpVideoReader::vpVideoFormatType
     return FORMAT_MKV;
   else if (ext.compare(".mkv") == 0)
     return FORMAT_MKV;
+  else if (ext.compare(".VPSEQ") == 0)
+    return FORMAT_FRAME_SEQUENCE;
+  else if (ext.compare(".vpseq") == 0)
+    return FORMAT_FRAME_SEQUENCE;
   else
     return FORMAT_UNKNOWN;
 }
@@ -747,6 +833,13 @@ void vpVideoReader::findLastFrameIndex()
     }
   }
 
+  else if (frameSequence != NULL)
+  {
+    if (!lastFrameIndexIsSet)
+    {
+      lastFrame = (long)frameSequence->getFrameCount() - 1;
+    }
+  }
 #if VISP_HAVE_OPENCV_VERSION >= 0x030000
   else if (!lastFrameIndexIsSet)
   {
@@ -797,6 +890,14 @@ void vpVideoReader::findFirstFrameIndex()
       imSequence->setImageNumber(firstFrame);
     }
   }
+  else if (frameSequence != NULL)
+  {
+    if (!firstFrameIndexIsSet)
+    {
+      firstFrame = 0;
+    }
+    frameSequenceNext = firstFrame;
+  }
 #if VISP_HAVE_OPENCV_VERSION >= 0x020100
   else if (!firstFrameIndexIsSet)
   {
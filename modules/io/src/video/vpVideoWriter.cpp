@@ -43,6 +43,7 @@
 */
 
 #include <visp3/core/vpDebug.h>
+#include <visp3/core/vpTime.h>
 #include <visp3/io/vpVideoWriter.h>
 
 #if VISP_HAVE_OPENCV_VERSION >= 0x020200
@@ -58,7 +59,7 @@ vpVideoWriter::vpVideoWriter() :
     writer(), fourcc(0), framerate(0.),
 #endif
     formatType(FORMAT_UNKNOWN), initFileName(false), isOpen(false), frameCount(0),
-    firstFrame(0), width(0), height(0)
+    firstFrame(0), width(0), height(0), frameSequence(NULL)
 {
   initFileName = false;
   firstFrame = 0;
@@ -80,6 +81,7 @@ vpVideoWriter::vpVideoWriter() :
 */
 vpVideoWriter::~vpVideoWriter()
 {
+  delete frameSequence;
 }
 
 
@@ -164,6 +166,13 @@ void vpVideoWriter::open(vpImage< vpRGBa > &I)
     throw (vpException(vpException::fatalError ,"To encode video files ViSP should be build with opencv 3rd >= 2.1.0 party libraries."));
 #endif
   }
+  else if (formatType == FORMAT_FRAME_SEQUENCE)
+  {
+    delete frameSequence;
+    frameSequence = new vpFrameSequenceWriter(fileName);
+    width = I.getWidth();
+    height = I.getHeight();
+  }
 
   frameCount = firstFrame;
 
@@ -209,6 +218,13 @@ void vpVideoWriter::open(vpImage< unsigned char > &I)
     throw (vpException(vpException::fatalError ,"To encode video files ViSP should be build with opencv 3rd >= 2.1.0 party libraries."));
 #endif
   }
+  else if (formatType == FORMAT_FRAME_SEQUENCE)
+  {
+    delete frameSequence;
+    frameSequence = new vpFrameSequenceWriter(fileName);
+    width = I.getWidth();
+    height = I.getHeight();
+  }
 
   frameCount = firstFrame;
 
@@ -243,6 +259,12 @@ void vpVideoWriter::saveFrame (vpImage< vpRGBa > &I)
 
     vpImageIo::write(I, name);
   }
+  else if (formatType == FORMAT_FRAME_SEQUENCE)
+  {
+    vpFrameSequence::vpFrameMetadata metadata;
+    metadata.timestamp = vpTime::measureTimeMs();
+    frameSequence->write(I, metadata);
+  }
   else
   {
 #if VISP_HAVE_OPENCV_VERSION >= 0x020100
@@ -282,6 +304,12 @@ void vpVideoWriter::saveFrame (vpImage< unsigned char > &I)
 
     vpImageIo::write(I, name);
   }
+  else if (formatType == FORMAT_FRAME_SEQUENCE)
+  {
+    vpFrameSequence::vpFrameMetadata metadata;
+    metadata.timestamp = vpTime::measureTimeMs();
+    frameSequence->write(I, metadata);
+  }
   else
   {
 #if VISP_HAVE_OPENCV_VERSION >= 0x030000
@@ -311,6 +339,10 @@ void vpVideoWriter::close()
     vpERROR_TRACE("The video has to be open first with the open method");
     throw (vpException(vpException::notInitialized,"file not yet opened"));
   }
+
+  if (frameSequence != NULL) {
+    frameSequence->close();
+  }
 }
 
 
@@ -370,6 +402,10 @@ vpVideoWriter::getFormat(const char *filename)
     return FORMAT_MOV;
   else if (ext.compare(".mov") == 0)
     return FORMAT_MOV;
+  else if (ext.compare(".VPSEQ") == 0)
+    return FORMAT_FRAME_SEQUENCE;
+  else if (ext.compare(".vpseq") == 0)
+    return FORMAT_FRAME_SEQUENCE;
   else
     return FORMAT_UNKNOWN;
 }
@@ -0,0 +1,279 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Read and write lists of images with vpImageIo::readBatch() and writeBatch().
+ *
+ *****************************************************************************/
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/io/vpImageIo.h>
+
+/*!
+  \example testImageIoBatch.cpp
+
+  \brief Write and read back lists of images with vpImageIo::writeBatch() and
+  vpImageIo::readBatch(), check the errors reported for each file and the progress
+  callback, and compare the time with a serial read. Truncated JPEG and PNG files and
+  empty images written as JPEG are reported as errors of their own file, and JPEG
+  files decoded concurrently give the same images as a serial read.
+*/
+
+namespace {
+  struct vpProgress {
+    vpProgress() : nbCalls(0), nbFailed(0), ordered(true) {}
+    unsigned int nbCalls;
+    unsigned int nbFailed;
+    bool ordered;
+  };
+
+  void progress(unsigned int nbProcessed, unsigned int nbImages, const std::string &, bool success, void *data)
+  {
+    vpProgress *p = static_cast<vpProgress *>(data);
+    p->nbCalls++;
+    p->ordered = p->ordered && nbProcessed == p->nbCalls && nbProcessed <= nbImages;
+    if (!success) {
+      p->nbFailed++;
+    }
+  }
+
+  bool sameImages(const vpImage<unsigned char> &I1, const vpImage<unsigned char> &I2) {
+    if (I1.getHeight() != I2.getHeight() || I1.getWidth() != I2.getWidth()) {
+      return false;
+    }
+    for (unsigned int i = 0; i < I1.getSize(); i++) {
+      if (I1.bitmap[i] != I2.bitmap[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  //! Copy the first half of a file, as an interrupted transfer would do.
+  void truncateFile(const std::string &filename, const std::string &truncatedFilename) {
+    std::ifstream in(filename.c_str(), std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::ofstream out(truncatedFilename.c_str(), std::ios::binary);
+    out.write(&data[0], (std::streamsize) (data.size() / 2));
+  }
+}
+
+int main()
+{
+  try {
+#if defined(_WIN32)
+    std::string path = "C:/temp";
+#else
+    std::string path = "/tmp";
+#endif
+    try {
+      path = vpIoTools::createFilePath(path, vpIoTools::getUserName());
+    }
+    catch(const vpException &) {
+      // No user name, use the temporary directory
+    }
+    path = vpIoTools::createFilePath(path, "testImageIoBatch");
+    if (!vpIoTools::checkDirectory(path)) {
+      vpIoTools::makeDirectory(path);
+    }
+
+    const unsigned int nbImages = 16;
+    std::vector<vpImage<unsigned char> > I(nbImages);
+    std::vector<vpImage<vpRGBa> > Ic(nbImages);
+    std::vector<std::string> filenames, colorFilenames;
+    for (unsigned int k = 0; k < nbImages; k++) {
+      I[k].resize(240, 320 + k);
+      for (unsigned int i = 0; i < I[k].getSize(); i++) {
+        I[k].bitmap[i] = (unsigned char)(i * (k + 1));
+      }
+      vpImageConvert::convert(I[k], Ic[k]);
+      std::ostringstream name;
+      name << "image" << k;
+      filenames.push_back(vpIoTools::createFilePath(path, name.str() + ".pgm"));
+      colorFilenames.push_back(vpIoTools::createFilePath(path, name.str() + ".ppm"));
+    }
+
+    std::vector<std::string> errors;
+    vpProgress writeProgress;
+    if (vpImageIo::writeBatch(I, filenames, errors, 4, progress, &writeProgress) != nbImages ||
+        vpImageIo::writeBatch(Ic, colorFilenames, errors, 0) != nbImages ||
+        writeProgress.nbCalls != nbImages || !writeProgress.ordered || writeProgress.nbFailed != 0) {
+      std::cerr << "Cannot write the images" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // A missing file and a file in an unknown format are reported without stopping the batch
+    std::vector<std::string> readFilenames = filenames;
+    readFilenames.push_back(vpIoTools::createFilePath(path, "missing.pgm"));
+    readFilenames.push_back(vpIoTools::createFilePath(path, "image.unknown"));
+    std::vector<vpImage<unsigned char> > I_read;
+    vpProgress readProgress;
+    unsigned int nbRead = vpImageIo::readBatch(I_read, readFilenames, errors, 4, progress, &readProgress);
+    bool success = nbRead == nbImages && I_read.size() == nbImages + 2 && errors.size() == nbImages + 2 &&
+        readProgress.nbCalls == nbImages + 2 && readProgress.ordered && readProgress.nbFailed == 2 &&
+        !errors[nbImages].empty() && !errors[nbImages + 1].empty();
+    for (unsigned int k = 0; k < nbImages && success; k++) {
+      success = errors[k].empty() && sameImages(I[k], I_read[k]);
+    }
+    if (!success) {
+      std::cerr << "Wrong grey level images read" << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::cout << "Error reported for " << readFilenames[nbImages] << ": " << errors[nbImages] << std::endl;
+
+    std::vector<vpImage<vpRGBa> > Ic_read;
+    if (vpImageIo::readBatch(Ic_read, colorFilenames, errors, 2) != nbImages) {
+      std::cerr << "Cannot read the color images" << std::endl;
+      return EXIT_FAILURE;
+    }
+    for (unsigned int k = 0; k < nbImages; k++) {
+      for (unsigned int i = 0; i < Ic[k].getSize(); i++) {
+        if (!(Ic_read[k].bitmap[i] == Ic[k].bitmap[i])) {
+          std::cerr << "Wrong color image " << k << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    // Serial and batch read times
+    double t = vpTime::measureTimeMs();
+    for (unsigned int k = 0; k < nbImages; k++) {
+      vpImageIo::read(Ic_read[k], colorFilenames[k]);
+    }
+    const double tSerial = vpTime::measureTimeMs() - t;
+    t = vpTime::measureTimeMs();
+    vpImageIo::readBatch(Ic_read, colorFilenames, errors);
+    const double tBatch = vpTime::measureTimeMs() - t;
+    std::cout << "Read " << nbImages << " color images: serial " << tSerial << " ms, batch " << tBatch << " ms"
+              << std::endl;
+
+#if defined(VISP_HAVE_JPEG) || defined(VISP_HAVE_PNG)
+    // Files written by libjpeg or libpng. A truncated file and an empty image are reported
+    // for their own file: the libraries must neither exit nor abort the batch.
+    std::vector<std::string> codecFilenames, codecExtensions;
+#  if defined(VISP_HAVE_JPEG)
+    codecExtensions.push_back(".jpg");
+#  endif
+#  if defined(VISP_HAVE_PNG)
+    codecExtensions.push_back(".png");
+#  endif
+    for (size_t e = 0; e < codecExtensions.size(); e++) {
+      std::vector<std::string> names;
+      for (unsigned int k = 0; k < nbImages; k++) {
+        std::ostringstream name;
+        name << "image" << k << codecExtensions[e];
+        names.push_back(vpIoTools::createFilePath(path, name.str()));
+      }
+      if (vpImageIo::writeBatch(I, names, errors, 4) != nbImages) {
+        std::cerr << "Cannot write the " << codecExtensions[e] << " images" << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      // Concurrent decoding gives the same images as a serial one
+      std::vector<vpImage<unsigned char> > I_serial(nbImages), I_batch;
+      for (unsigned int k = 0; k < nbImages; k++) {
+        vpImageIo::read(I_serial[k], names[k]);
+      }
+      if (vpImageIo::readBatch(I_batch, names, errors, 4) != nbImages) {
+        std::cerr << "Cannot read the " << codecExtensions[e] << " images" << std::endl;
+        return EXIT_FAILURE;
+      }
+      for (unsigned int k = 0; k < nbImages; k++) {
+        if (!sameImages(I_serial[k], I_batch[k])) {
+          std::cerr << "Image " << names[k] << " differs when decoded concurrently" << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+
+      const std::string truncated = vpIoTools::createFilePath(path, "truncated" + codecExtensions[e]);
+      truncateFile(names[0], truncated);
+      std::vector<std::string> readNames(names.begin(), names.begin() + 4);
+      readNames.insert(readNames.begin() + 2, truncated);
+      unsigned int nbRead = vpImageIo::readBatch(I_batch, readNames, errors, 4);
+      if (nbRead != 4 || errors[2].empty() || !errors[0].empty() || !errors[3].empty()) {
+        std::cerr << "The truncated file " << truncated << " is not reported" << std::endl;
+        return EXIT_FAILURE;
+      }
+      std::cout << "Error reported for " << truncated << ": " << errors[2] << std::endl;
+
+      for (unsigned int k = 0; k < nbImages; k++) {
+        codecFilenames.push_back(names[k]);
+      }
+      codecFilenames.push_back(truncated);
+    }
+
+#  if defined(VISP_HAVE_JPEG)
+    std::vector<vpImage<unsigned char> > I_empty(2);
+    I_empty[1] = I[0];
+    std::vector<std::string> emptyFilenames;
+    emptyFilenames.push_back(vpIoTools::createFilePath(path, "empty.jpg"));
+    emptyFilenames.push_back(vpIoTools::createFilePath(path, "not_empty.jpg"));
+    if (vpImageIo::writeBatch(I_empty, emptyFilenames, errors, 2) != 1 || errors[0].empty() || !errors[1].empty()) {
+      std::cerr << "Writing an empty image as JPEG is not reported" << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::cout << "Error reported for " << emptyFilenames[0] << ": " << errors[0] << std::endl;
+    codecFilenames.insert(codecFilenames.end(), emptyFilenames.begin(), emptyFilenames.end());
+#  endif
+
+    for (size_t k = 0; k < codecFilenames.size(); k++) {
+      if (vpIoTools::checkFilename(codecFilenames[k])) {
+        vpIoTools::remove(codecFilenames[k]);
+      }
+    }
+#endif
+
+    // As many images as files are needed
+    std::vector<std::string> oneFilename(1, filenames[0]);
+    try {
+      vpImageIo::writeBatch(I, oneFilename, errors);
+      std::cerr << "Images written with too few file names" << std::endl;
+      return EXIT_FAILURE;
+    }
+    catch(const vpException &) {
+    }
+
+    for (unsigned int k = 0; k < nbImages; k++) {
+      vpIoTools::remove(filenames[k]);
+      vpIoTools::remove(colorFilenames[k]);
+    }
+
+    std::cout << "Batch read and write: ok" << std::endl;
+    return EXIT_SUCCESS;
+  } catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
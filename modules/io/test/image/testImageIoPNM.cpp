@@ -0,0 +1,360 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Read and write PGM, PPM and PFM images with vpImageIo.
+ *
+ *****************************************************************************/
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/io/vpImageIo.h>
+
+/*!
+  \example testImageIoPNM.cpp
+
+  \brief Read and write 8 and 16 bits PGM, PPM and PFM images, check headers with
+  comments and compare the time to read and write a PPM image with a pixel by pixel
+  implementation.
+*/
+
+namespace {
+  const unsigned int height = 97, width = 131;
+
+  template<class Type>
+  bool sameImages(const vpImage<Type> &I1, const vpImage<Type> &I2) {
+    if (I1.getHeight() != I2.getHeight() || I1.getWidth() != I2.getWidth()) {
+      return false;
+    }
+    for (unsigned int i = 0; i < I1.getSize(); i++) {
+      if (!(I1.bitmap[i] == I2.bitmap[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool testGrey(const std::string &path) {
+    const std::string filename = vpIoTools::createFilePath(path, "grey.pgm");
+    vpImage<unsigned char> I(height, width), I_read;
+    for (unsigned int i = 0; i < I.getSize(); i++) {
+      I.bitmap[i] = (unsigned char)(i * 7);
+    }
+    vpImageIo::writePGM(I, filename);
+    vpImageIo::readPGM(I_read, filename);
+    if (!sameImages(I, I_read)) {
+      std::cerr << "Wrong 8 bits PGM image" << std::endl;
+      return false;
+    }
+
+    // An 8 bits PGM image read in a 16 bits image
+    vpImage<uint16_t> I16;
+    vpImageIo::readPGM(I16, filename);
+    for (unsigned int i = 0; i < I.getSize(); i++) {
+      if (I16.bitmap[i] != I.bitmap[i]) {
+        std::cerr << "Wrong 8 bits PGM image read as a 16 bits image" << std::endl;
+        return false;
+      }
+    }
+
+    // A PPM image from a grey level image
+    const std::string ppmFilename = vpIoTools::createFilePath(path, "grey.ppm");
+    vpImageIo::writePPM(I, ppmFilename);
+    vpImage<vpRGBa> Ic;
+    vpImageIo::readPPM(Ic, ppmFilename);
+    vpImageIo::readPPM(I_read, ppmFilename);
+    for (unsigned int i = 0; i < I.getSize(); i++) {
+      if (Ic.bitmap[i].R != I.bitmap[i] || Ic.bitmap[i].G != I.bitmap[i] || Ic.bitmap[i].B != I.bitmap[i] ||
+          Ic.bitmap[i].A != vpRGBa::alpha_default || std::abs((int) I_read.bitmap[i] - (int) I.bitmap[i]) > 1) {
+        std::cerr << "Wrong PPM image written from a grey level image" << std::endl;
+        return false;
+      }
+    }
+
+    vpIoTools::remove(filename);
+    vpIoTools::remove(ppmFilename);
+    std::cout << "8 bits PGM: ok" << std::endl;
+    return true;
+  }
+
+  bool testDepth(const std::string &path) {
+    const std::string filename = vpIoTools::createFilePath(path, "depth.pgm");
+    vpImage<uint16_t> I(height, width), I_read;
+    for (unsigned int i = 0; i < I.getSize(); i++) {
+      I.bitmap[i] = (uint16_t)(i * 263 + 17);
+    }
+    vpImageIo::writePGM(I, filename);
+    vpImageIo::readPGM(I_read, filename);
+    if (!sameImages(I, I_read)) {
+      std::cerr << "Wrong 16 bits PGM image" << std::endl;
+      return false;
+    }
+
+    // The samples are stored in big endian
+    std::ifstream file(filename.c_str(), std::ifstream::binary);
+    std::string magic;
+    unsigned int w, h, maxval;
+    file >> magic >> w >> h >> maxval;
+    file.get();
+    unsigned char sample[2];
+    file.read((char *) sample, 2);
+    if (magic != "P5" || w != width || h != height || maxval != 65535 ||
+        sample[0] != (I.bitmap[0] >> 8) || sample[1] != (I.bitmap[0] & 0xff)) {
+      std::cerr << "Wrong 16 bits PGM file" << std::endl;
+      return false;
+    }
+    file.close();
+
+    // A 16 bits image is not read in a 8 bits image
+    vpImage<unsigned char> I8;
+    try {
+      vpImageIo::readPGM(I8, filename);
+      std::cerr << "A 16 bits PGM image was read in a 8 bits image" << std::endl;
+      return false;
+    }
+    catch(const vpException &) {
+    }
+
+    vpIoTools::remove(filename);
+    std::cout << "16 bits PGM: ok" << std::endl;
+    return true;
+  }
+
+  bool testColor(const std::string &path) {
+    const std::string filename = vpIoTools::createFilePath(path, "color.ppm");
+    vpImage<vpRGBa> I(height, width), I_read;
+    for (unsigned int i = 0; i < I.getSize(); i++) {
+      I.bitmap[i] = vpRGBa((unsigned char)(i * 3), (unsigned char)(i * 5 + 1), (unsigned char)(i * 11 + 2),
+                           vpRGBa::alpha_default);
+    }
+    vpImageIo::writePPM(I, filename);
+    vpImageIo::readPPM(I_read, filename);
+    if (!sameImages(I, I_read)) {
+      std::cerr << "Wrong PPM image" << std::endl;
+      return false;
+    }
+
+    vpImage<unsigned char> I_grey, I_grey_ref;
+    vpImageIo::readPPM(I_grey, filename);
+    vpImageConvert::convert(I, I_grey_ref);
+    for (unsigned int i = 0; i < I.getSize(); i++) {
+      if (std::abs((int) I_grey.bitmap[i] - (int) I_grey_ref.bitmap[i]) > 1) {
+        std::cerr << "Wrong PPM image read as a grey level image" << std::endl;
+        return false;
+      }
+    }
+
+    vpIoTools::remove(filename);
+    std::cout << "PPM: ok" << std::endl;
+    return true;
+  }
+
+  bool testFloat(const std::string &path) {
+    const std::string filename = vpIoTools::createFilePath(path, "float.pfm");
+    vpImage<float> I(height, width), I_read;
+    for (unsigned int i = 0; i < I.getSize(); i++) {
+      I.bitmap[i] = 0.25f * i - 1000.f;
+    }
+    vpImageIo::writePFM(I, filename);
+    vpImageIo::readPFM(I_read, filename);
+    if (!sameImages(I, I_read)) {
+      std::cerr << "Wrong PFM image" << std::endl;
+      return false;
+    }
+
+    vpIoTools::remove(filename);
+    std::cout << "PFM: ok" << std::endl;
+    return true;
+  }
+
+  bool testHeader(const std::string &path) {
+    const std::string filename = vpIoTools::createFilePath(path, "header.pgm");
+    const unsigned char pixels[6] = { 10, 32, 35, 255, 0, 13 };
+
+    // Comments, the whole header on a few lines and pixels that look like white spaces or comments
+    {
+      std::ofstream file(filename.c_str(), std::ofstream::binary);
+      file << "P5\n# A comment\n3 # width\n  2\n#\n255\n";
+      file.write((const char *) pixels, 6);
+    }
+    vpImage<unsigned char> I;
+    vpImageIo::readPGM(I, filename);
+    bool ok = I.getWidth() == 3 && I.getHeight() == 2;
+    for (unsigned int i = 0; i < 6 && ok; i++) {
+      ok = I.bitmap[i] == pixels[i];
+    }
+    if (!ok) {
+      std::cerr << "Wrong PGM image with comments" << std::endl;
+      return false;
+    }
+
+    {
+      std::ofstream file(filename.c_str(), std::ofstream::binary);
+      file << "P5 3 2 255 ";
+      file.write((const char *) pixels, 6);
+    }
+    vpImageIo::readPGM(I, filename);
+    ok = I.getWidth() == 3 && I.getHeight() == 2;
+    for (unsigned int i = 0; i < 6 && ok; i++) {
+      ok = I.bitmap[i] == pixels[i];
+    }
+    if (!ok) {
+      std::cerr << "Wrong PGM image with a single line header" << std::endl;
+      return false;
+    }
+
+    // Bad magic number, truncated header and truncated raster
+    const char *badFiles[3] = { "P6\n3 2\n255\n123456", "P5\n3 ", "P5\n3 2\n255\n123" };
+    for (unsigned int k = 0; k < 3; k++) {
+      {
+        std::ofstream file(filename.c_str(), std::ofstream::binary);
+        file << badFiles[k];
+      }
+      try {
+        vpImageIo::readPGM(I, filename);
+        std::cerr << "The bad PGM file " << k << " was read" << std::endl;
+        return false;
+      }
+      catch(const vpException &) {
+      }
+    }
+
+    vpIoTools::remove(filename);
+    std::cout << "PNM header: ok" << std::endl;
+    return true;
+  }
+
+  // Previous pixel by pixel implementation
+  void readPPMPixelByPixel(vpImage<vpRGBa> &I, const std::string &filename) {
+    std::ifstream fd(filename.c_str(), std::ios::binary);
+    std::string magic;
+    unsigned int w, h, maxval;
+    fd >> magic >> w >> h >> maxval;
+    fd.get();
+    I.resize(h, w);
+    for (unsigned int i = 0; i < I.getHeight(); i++) {
+      for (unsigned int j = 0; j < I.getWidth(); j++) {
+        unsigned char rgb[3];
+        fd.read((char *)&rgb, 3);
+        I[i][j].R = rgb[0];
+        I[i][j].G = rgb[1];
+        I[i][j].B = rgb[2];
+        I[i][j].A = vpRGBa::alpha_default;
+      }
+    }
+  }
+
+  void writePPMPixelByPixel(const vpImage<vpRGBa> &I, const std::string &filename) {
+    FILE *f = fopen(filename.c_str(), "wb");
+    fprintf(f, "P6\n%u %u\n%d\n", I.getWidth(), I.getHeight(), 255);
+    for (unsigned int i = 0; i < I.getHeight(); i++) {
+      for (unsigned int j = 0; j < I.getWidth(); j++) {
+        unsigned char rgb[3] = { I[i][j].R, I[i][j].G, I[i][j].B };
+        fwrite(&rgb, 1, 3, f);
+      }
+    }
+    fclose(f);
+  }
+
+  bool benchmark(const std::string &path) {
+    const unsigned int nb = 20;
+    const std::string filename = vpIoTools::createFilePath(path, "benchmark.ppm");
+    vpImage<vpRGBa> I(480, 640), I_read, I_read_ref;
+    for (unsigned int i = 0; i < I.getSize(); i++) {
+      I.bitmap[i] = vpRGBa((unsigned char)(i % 640), (unsigned char)(i / 640), (unsigned char)(i % 7),
+                           vpRGBa::alpha_default);
+    }
+
+    double t = vpTime::measureTimeMs();
+    for (unsigned int k = 0; k < nb; k++) {
+      writePPMPixelByPixel(I, filename);
+    }
+    const double tWriteRef = vpTime::measureTimeMs() - t;
+    t = vpTime::measureTimeMs();
+    for (unsigned int k = 0; k < nb; k++) {
+      readPPMPixelByPixel(I_read_ref, filename);
+    }
+    const double tReadRef = vpTime::measureTimeMs() - t;
+
+    t = vpTime::measureTimeMs();
+    for (unsigned int k = 0; k < nb; k++) {
+      vpImageIo::writePPM(I, filename);
+    }
+    const double tWrite = vpTime::measureTimeMs() - t;
+    t = vpTime::measureTimeMs();
+    for (unsigned int k = 0; k < nb; k++) {
+      vpImageIo::readPPM(I_read, filename);
+    }
+    const double tRead = vpTime::measureTimeMs() - t;
+    vpIoTools::remove(filename);
+
+    std::cout << "Mean time per 640x480 PPM image, pixel by pixel: write " << tWriteRef / nb << " ms, read "
+              << tReadRef / nb << " ms; vpImageIo: write " << tWrite / nb << " ms, read " << tRead / nb << " ms"
+              << std::endl;
+    if (!sameImages(I_read, I_read_ref) || !sameImages(I_read, I)) {
+      std::cerr << "Wrong PPM image in the benchmark" << std::endl;
+      return false;
+    }
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+#if defined(_WIN32)
+    std::string path = "C:/temp";
+#else
+    std::string path = "/tmp";
+#endif
+    try {
+      path = vpIoTools::createFilePath(path, vpIoTools::getUserName());
+    }
+    catch(const vpException &) {
+      // No user name, use the temporary directory
+    }
+    path = vpIoTools::createFilePath(path, "testImageIoPNM");
+    if (!vpIoTools::checkDirectory(path)) {
+      vpIoTools::makeDirectory(path);
+    }
+
+    bool success = testGrey(path) && testDepth(path) && testColor(path) && testFloat(path) && testHeader(path) &&
+        benchmark(path);
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+  } catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,526 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Record and replay of frame sequence files.
+ *
+ *****************************************************************************/
+
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/io/vpFrameSequenceReader.h>
+#include <visp3/io/vpFrameSequenceWriter.h>
+#include <visp3/io/vpImageIo.h>
+#include <visp3/io/vpVideoReader.h>
+#include <visp3/io/vpVideoWriter.h>
+
+/*!
+  \example testFrameSequence.cpp
+
+  \brief Check the LZ4 codec of vpFrameSequence, the record and replay of grey level, color,
+  depth and float frames with their metadata, the zero-copy read, the recovery of a file that
+  was not closed and the frame sequence format of vpVideoWriter and vpVideoReader. The time
+  to replay a sequence is compared with a sequence of PGM images.
+*/
+
+namespace {
+  const unsigned int nbFrames = 12;
+  const unsigned int height = 120, width = 160;
+
+  unsigned char pixel(const unsigned int frame, const unsigned int i, const unsigned int j) {
+    // Smooth images with some noise so that they are partly compressible
+    return (unsigned char)((frame * 7 + i + j / 4 + ((i * 31 + j * 17) % 5)) % 256);
+  }
+
+  void buildFrames(const unsigned int frame, vpImage<unsigned char> &I, vpImage<vpRGBa> &Ic,
+                   vpImage<uint16_t> &Id, vpImage<float> &If) {
+    I.resize(height, width);
+    Ic.resize(height, width);
+    Id.resize(height, width);
+    If.resize(height, width);
+    for (unsigned int i = 0; i < height; i++) {
+      for (unsigned int j = 0; j < width; j++) {
+        I[i][j] = pixel(frame, i, j);
+        Ic[i][j] = vpRGBa(pixel(frame, i, j), pixel(frame + 1, i, j), pixel(frame + 2, i, j), 255);
+        Id[i][j] = (uint16_t)(1000 + frame * 10 + i * width + j);
+        If[i][j] = 0.5f * frame + 0.25f * i - 0.125f * j;
+      }
+    }
+  }
+
+  template<class Type>
+  bool sameImages(const vpImage<Type> &I1, const vpImage<Type> &I2) {
+    if (I1.getHeight() != I2.getHeight() || I1.getWidth() != I2.getWidth()) {
+      return false;
+    }
+    for (unsigned int i = 0; i < I1.getSize(); i++) {
+      if (!(I1.bitmap[i] == I2.bitmap[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool testLZ4(const std::string &name, const std::vector<unsigned char> &data) {
+    std::vector<unsigned char> compressed(vpFrameSequence::getLZ4Bound(data.size()));
+    std::vector<unsigned char> decompressed(data.size() + 1);
+    const unsigned char *src = data.empty() ? NULL : &data[0];
+    size_t compressedSize = vpFrameSequence::compressLZ4(src, data.size(), &compressed[0], compressed.size());
+    if (compressedSize == 0 || compressedSize > compressed.size()) {
+      std::cerr << "LZ4 " << name << ": compression failed" << std::endl;
+      return false;
+    }
+    size_t size = vpFrameSequence::decompressLZ4(&compressed[0], compressedSize, &decompressed[0], data.size());
+    if (size != data.size() || !std::equal(data.begin(), data.end(), decompressed.begin())) {
+      std::cerr << "LZ4 " << name << ": wrong decompression" << std::endl;
+      return false;
+    }
+
+    // A truncated block is detected
+    if (compressedSize > 1) {
+      try {
+        size = vpFrameSequence::decompressLZ4(&compressed[0], compressedSize - 1, &decompressed[0], data.size());
+        if (size == data.size()) {
+          std::cerr << "LZ4 " << name << ": a truncated block was decompressed" << std::endl;
+          return false;
+        }
+      }
+      catch(const vpException &) {
+      }
+    }
+
+    std::cout << "LZ4 " << name << ": " << data.size() << " bytes compressed in " << compressedSize << " bytes"
+              << std::endl;
+    return true;
+  }
+
+  bool testLZ4() {
+    vpUniRand rng(42);
+    const size_t sizes[] = { 0, 1, 12, 13, 100, 100000 };
+    for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+      std::vector<unsigned char> repeated(sizes[k]), random(sizes[k]), mixed(sizes[k]);
+      for (size_t i = 0; i < sizes[k]; i++) {
+        repeated[i] = (unsigned char)(i % 3);
+        random[i] = (unsigned char)(256 * rng());
+        mixed[i] = (i / 64) % 2 ? random[i] : (unsigned char)(i / 128);
+      }
+      if (!testLZ4("repeated", repeated) || !testLZ4("random", random) || !testLZ4("mixed", mixed)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void writeSequence(const std::string &filename, const vpFrameSequence::vpCompressionType &compression) {
+    vpFrameSequenceWriter writer(filename);
+    writer.setCompression(compression);
+    vpImage<unsigned char> I;
+    vpImage<vpRGBa> Ic;
+    vpImage<uint16_t> Id;
+    vpImage<float> If;
+    for (unsigned int k = 0; k < nbFrames; k++) {
+      buildFrames(k, I, Ic, Id, If);
+      vpFrameSequence::vpFrameMetadata metadata;
+      metadata.timestamp = 1000. + 33.3 * k;
+      metadata.cameraId = k % 4;
+      metadata.hasPose = (k % 2 == 0);
+      metadata.pose.buildFrom(0.1 * k, -0.2, 1.5, 0.01 * k, 0.2, -0.3);
+      switch (k % 4) {
+      case 0: writer.write(I, metadata); break;
+      case 1: writer.write(Ic, metadata); break;
+      case 2: writer.write(Id, metadata); break;
+      default: writer.write(If, metadata); break;
+      }
+    }
+    writer.close();
+  }
+
+  bool checkSequence(const std::string &name, vpFrameSequenceReader &reader, const unsigned int nb) {
+    if (reader.getFrameCount() != nb) {
+      std::cerr << name << ": " << reader.getFrameCount() << " frames instead of " << nb << std::endl;
+      return false;
+    }
+
+    vpImage<unsigned char> I, I_ref;
+    vpImage<vpRGBa> Ic, Ic_ref;
+    vpImage<uint16_t> Id, Id_ref;
+    vpImage<float> If, If_ref;
+    for (unsigned int k = 0; k < nb; k++) {
+      buildFrames(k, I_ref, Ic_ref, Id_ref, If_ref);
+      vpFrameSequence::vpFrameMetadata metadata = reader.getMetadata(k);
+      vpHomogeneousMatrix pose(0.1 * k, -0.2, 1.5, 0.01 * k, 0.2, -0.3);
+      bool ok = reader.getWidth(k) == width && reader.getHeight(k) == height &&
+          metadata.timestamp == 1000. + 33.3 * k && metadata.cameraId == k % 4 &&
+          metadata.hasPose == (k % 2 == 0);
+      for (unsigned int i = 0; i < 4 && ok && metadata.hasPose; i++) {
+        for (unsigned int j = 0; j < 4; j++) {
+          ok = ok && metadata.pose[i][j] == pose[i][j];
+        }
+      }
+      switch (k % 4) {
+      case 0:
+        reader.read(I, k);
+        reader.read(Ic, k);
+        ok = ok && reader.getFrameType(k) == vpFrameSequence::GREY_FRAME && sameImages(I, I_ref);
+        for (unsigned int i = 0; i < Ic.getSize() && ok; i++) {
+          ok = Ic.bitmap[i].R == I_ref.bitmap[i] && Ic.bitmap[i].B == I_ref.bitmap[i];
+        }
+        break;
+      case 1:
+        reader.read(Ic, k);
+        reader.read(I, k);
+        ok = ok && reader.getFrameType(k) == vpFrameSequence::RGBA_FRAME && sameImages(Ic, Ic_ref) &&
+            I.getHeight() == height && I.getWidth() == width;
+        break;
+      case 2:
+        reader.read(Id, k);
+        ok = ok && reader.getFrameType(k) == vpFrameSequence::DEPTH_FRAME && sameImages(Id, Id_ref);
+        break;
+      default:
+        reader.read(If, k);
+        ok = ok && reader.getFrameType(k) == vpFrameSequence::FLOAT_FRAME && sameImages(If, If_ref);
+        break;
+      }
+      if (!ok) {
+        std::cerr << name << ": wrong frame " << k << std::endl;
+        return false;
+      }
+    }
+
+    // A depth frame is not read as a float frame
+    if (nb > 2) {
+      try {
+        reader.read(If, 2);
+        std::cerr << name << ": a depth frame was read as a float frame" << std::endl;
+        return false;
+      }
+      catch(const vpException &) {
+      }
+    }
+
+    std::cout << name << ": ok" << std::endl;
+    return true;
+  }
+
+  bool testSequence(const std::string &filename, const vpFrameSequence::vpCompressionType &compression) {
+    const std::string name = compression == vpFrameSequence::LZ4_COMPRESSION ? "LZ4 sequence" : "Raw sequence";
+    writeSequence(filename, compression);
+
+    vpFrameSequenceReader reader(filename);
+    if (!checkSequence(name, reader, nbFrames)) {
+      return false;
+    }
+
+    // The zero-copy read of a raw frame points to the mapped file
+    vpImage<uint16_t> Id1, Id2;
+    reader.read(Id1, 2);
+    reader.read(Id2, 2);
+    if (compression == vpFrameSequence::NO_COMPRESSION && Id1.bitmap != Id2.bitmap) {
+      std::cerr << name << ": wrong zero-copy read" << std::endl;
+      return false;
+    }
+    reader.setZeroCopy(false);
+    reader.read(Id1, 2);
+    reader.read(Id2, 2);
+    if (Id1.bitmap == Id2.bitmap || !sameImages(Id1, Id2)) {
+      std::cerr << name << ": the frames should be copied" << std::endl;
+      return false;
+    }
+    reader.close();
+
+    // Id1 owns its pixels and stays valid once the file is closed
+    vpImage<unsigned char> I;
+    vpImage<vpRGBa> Ic;
+    vpImage<uint16_t> Id_ref;
+    vpImage<float> If;
+    buildFrames(2, I, Ic, Id_ref, If);
+    return sameImages(Id1, Id_ref);
+  }
+
+  double fileSize(const std::string &filename) {
+    std::ifstream file(filename.c_str(), std::ifstream::binary | std::ifstream::ate);
+    return (double) file.tellg();
+  }
+
+  // A file whose recording stopped in the middle of a frame
+  bool testRecovery(const std::string &filename, const std::string &truncatedFilename) {
+    writeSequence(filename, vpFrameSequence::NO_COMPRESSION);
+
+    // Offset of the pixels of the 6th frame from the zero-copy reads
+    size_t offset = 0;
+    {
+      vpFrameSequenceReader reader(filename);
+      vpImage<unsigned char> I;
+      vpImage<vpRGBa> Ic;
+      reader.read(I, 0);
+      reader.read(Ic, 5);
+      // The pixels of the first frame follow the file header and the frame header
+      offset = (size_t)((const unsigned char *) Ic.bitmap - I.bitmap) + 64 + 192;
+    }
+
+    std::vector<char> data;
+    {
+      std::ifstream file(filename.c_str(), std::ifstream::binary);
+      data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    // No frame count, no index, and only half of the 6th frame
+    std::fill(data.begin() + 16, data.begin() + 32, 0);
+    data.resize(offset + width * height * 2);
+    {
+      std::ofstream file(truncatedFilename.c_str(), std::ofstream::binary);
+      file.write(&data[0], (std::streamsize) data.size());
+    }
+
+    vpFrameSequenceReader recovered(truncatedFilename);
+    return checkSequence("Recovered sequence", recovered, 5);
+  }
+
+  // A frame header whose size does not match the stored pixels
+  bool testCorruptedFrame(const std::string &filename, const std::string &corruptedFilename) {
+    writeSequence(filename, vpFrameSequence::NO_COMPRESSION);
+
+    std::vector<char> data;
+    {
+      std::ifstream file(filename.c_str(), std::ifstream::binary);
+      data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    // The header of the first frame follows the file header
+    const size_t frameOffset = 64;
+    for (unsigned int c = 0; c < 2; c++) {
+      std::vector<char> corrupted = data;
+      if (c == 0) {
+        // A larger image than the stored pixels
+        corrupted[frameOffset + 8 + 1] = (char) 0x10;
+      }
+      else {
+        // A color image whose size overflows 64 bits
+        corrupted[frameOffset + 4] = (char) vpFrameSequence::RGBA_FRAME;
+        std::fill(corrupted.begin() + frameOffset + 8, corrupted.begin() + frameOffset + 16, (char) 0xff);
+      }
+      {
+        std::ofstream file(corruptedFilename.c_str(), std::ofstream::binary);
+        file.write(&corrupted[0], (std::streamsize) corrupted.size());
+      }
+
+      try {
+        vpFrameSequenceReader reader(corruptedFilename);
+        std::cerr << "A frame larger than its stored pixels was opened" << std::endl;
+        return false;
+      }
+      catch(vpException &e) {
+        if (e.getCode() != vpException::ioError) {
+          std::cerr << "Wrong exception for a corrupted frame: " << e.what() << std::endl;
+          return false;
+        }
+      }
+    }
+    std::cout << "Corrupted frame: ok" << std::endl;
+    return true;
+  }
+
+  bool testVideoWriterReader(const std::string &filename) {
+    vpImage<unsigned char> I;
+    vpImage<vpRGBa> Ic;
+    vpImage<uint16_t> Id;
+    vpImage<float> If;
+
+    vpVideoWriter writer;
+    writer.setFileName(filename);
+    buildFrames(0, I, Ic, Id, If);
+    writer.open(I);
+    for (unsigned int k = 0; k < nbFrames; k++) {
+      buildFrames(k, I, Ic, Id, If);
+      writer.saveFrame(I);
+    }
+    writer.close();
+
+    vpVideoReader reader;
+    reader.setFileName(filename);
+    reader.setFrameStep(2);
+    reader.open(I);
+    if (I.getWidth() != width || I.getHeight() != height || reader.getFirstFrameIndex() != 0 ||
+        reader.getLastFrameIndex() != (long) nbFrames - 1) {
+      std::cerr << "vpVideoReader: wrong frame sequence properties" << std::endl;
+      return false;
+    }
+    vpImage<unsigned char> I_ref;
+    long expected = 0;
+    while (!reader.end()) {
+      reader.acquire(I);
+      buildFrames((unsigned int) expected, I_ref, Ic, Id, If);
+      if (reader.getFrameIndex() != expected || !sameImages(I, I_ref)) {
+        std::cerr << "vpVideoReader: wrong frame " << expected << std::endl;
+        return false;
+      }
+      expected += 2;
+    }
+    if (expected != (long) nbFrames) {
+      std::cerr << "vpVideoReader: " << expected / 2 << " frames were read" << std::endl;
+      return false;
+    }
+
+    buildFrames(7, I_ref, Ic, Id, If);
+    if (!reader.getFrame(I, 7) || reader.getFrameIndex() != 7 || !sameImages(I, I_ref) ||
+        reader.getFrame(I, nbFrames)) {
+      std::cerr << "vpVideoReader: wrong frame 7" << std::endl;
+      return false;
+    }
+
+    std::cout << "vpVideoWriter and vpVideoReader: ok" << std::endl;
+    return true;
+  }
+
+  // Time to write and read back a sequence of grey level images
+  void benchmark(const std::string &path) {
+    const unsigned int nb = 50;
+    vpImage<unsigned char> I(480, 640), I_read;
+    for (unsigned int i = 0; i < I.getSize(); i++) {
+      I.bitmap[i] = (unsigned char)((i % 640) / 3 + (i / 640) / 5);
+    }
+
+    const std::string genericName = vpIoTools::createFilePath(path, "image%04d.pgm");
+    double t = vpTime::measureTimeMs();
+    for (unsigned int k = 0; k < nb; k++) {
+      char filename[FILENAME_MAX];
+      sprintf(filename, genericName.c_str(), k);
+      vpImageIo::write(I, filename);
+    }
+    const double tWritePgm = vpTime::measureTimeMs() - t;
+    t = vpTime::measureTimeMs();
+    for (unsigned int k = 0; k < nb; k++) {
+      char filename[FILENAME_MAX];
+      sprintf(filename, genericName.c_str(), k);
+      vpImageIo::read(I_read, filename);
+    }
+    const double tReadPgm = vpTime::measureTimeMs() - t;
+    for (unsigned int k = 0; k < nb; k++) {
+      char filename[FILENAME_MAX];
+      sprintf(filename, genericName.c_str(), k);
+      vpIoTools::remove(filename);
+    }
+
+    const std::string filename = vpIoTools::createFilePath(path, "benchmark.vpseq");
+    t = vpTime::measureTimeMs();
+    {
+      vpFrameSequenceWriter writer(filename);
+      for (unsigned int k = 0; k < nb; k++) {
+        writer.write(I);
+      }
+    }
+    const double tWriteSeq = vpTime::measureTimeMs() - t;
+    t = vpTime::measureTimeMs();
+    {
+      vpFrameSequenceReader reader(filename);
+      for (unsigned int k = 0; k < nb; k++) {
+        reader.read(I_read, k);
+      }
+    }
+    const double tReadSeq = vpTime::measureTimeMs() - t;
+    vpIoTools::remove(filename);
+
+    std::cout << "Mean time per 640x480 frame, PGM images: write " << tWritePgm / nb << " ms, read "
+              << tReadPgm / nb << " ms; frame sequence: write " << tWriteSeq / nb << " ms, zero-copy read "
+              << tReadSeq / nb << " ms" << std::endl;
+  }
+}
+
+int main()
+{
+  try {
+#if defined(_WIN32)
+    std::string path = "C:/temp";
+#else
+    std::string path = "/tmp";
+#endif
+    try {
+      path = vpIoTools::createFilePath(path, vpIoTools::getUserName());
+    }
+    catch(const vpException &) {
+      // No user name, use the temporary directory
+    }
+    path = vpIoTools::createFilePath(path, "testFrameSequence");
+    if (!vpIoTools::checkDirectory(path)) {
+      vpIoTools::makeDirectory(path);
+    }
+
+    const std::string filename = vpIoTools::createFilePath(path, "sequence.vpseq");
+    const std::string truncatedFilename = vpIoTools::createFilePath(path, "truncated.vpseq");
+    bool success = testLZ4() && testSequence(filename, vpFrameSequence::NO_COMPRESSION);
+    const double rawSize = success ? fileSize(filename) : 0;
+    success = success && testSequence(filename, vpFrameSequence::LZ4_COMPRESSION);
+    if (success) {
+      const double lz4Size = fileSize(filename);
+      std::cout << "Size of the sequence: " << rawSize << " bytes, " << lz4Size << " bytes with LZ4" << std::endl;
+      if (lz4Size >= rawSize) {
+        std::cerr << "The LZ4 sequence is not smaller" << std::endl;
+        success = false;
+      }
+    }
+    success = success && testRecovery(filename, truncatedFilename) && testCorruptedFrame(filename, truncatedFilename) &&
+              testVideoWriterReader(filename);
+
+    // A file that is not a frame sequence is rejected
+    if (success) {
+      {
+        std::ofstream file(truncatedFilename.c_str(), std::ofstream::binary);
+        file << "This is not a frame sequence, but a text file that is long enough to hold a header";
+      }
+      try {
+        vpFrameSequenceReader reader(truncatedFilename);
+        std::cerr << "A text file was opened as a frame sequence" << std::endl;
+        success = false;
+      }
+      catch(const vpException &) {
+      }
+    }
+
+    if (success) {
+      benchmark(path);
+    }
+
+    if (vpIoTools::checkFilename(filename)) {
+      vpIoTools::remove(filename);
+    }
+    if (vpIoTools::checkFilename(truncatedFilename)) {
+      vpIoTools::remove(truncatedFilename);
+    }
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+  } catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
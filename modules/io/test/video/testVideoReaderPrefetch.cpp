@@ -0,0 +1,287 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Prefetch mode of vpDiskGrabber and vpVideoReader.
+ *
+ *****************************************************************************/
+
+#include <iostream>
+#include <set>
+#include <vector>
+
+#include <visp3/core/vpImageException.h>
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/io/vpDiskGrabber.h>
+#include <visp3/io/vpImageIo.h>
+#include <visp3/io/vpVideoReader.h>
+
+/*!
+  \example testVideoReaderPrefetch.cpp
+
+  \brief Check that vpDiskGrabber and vpVideoReader return the same images with and without
+  the prefetch mode, including with a frame step, seeks and a change of image type, and
+  that the prefetch mode recycles its buffers.
+*/
+
+namespace {
+  const unsigned int nbFrames = 30;
+
+  unsigned char pixel(const long frame, const unsigned int i, const unsigned int j) {
+    return (unsigned char)((frame * 37 + i * 3 + j) % 256);
+  }
+
+  bool checkFrame(const std::string &name, const vpImage<unsigned char> &I, const long frame) {
+    for (unsigned int i = 0; i < I.getHeight(); i++) {
+      for (unsigned int j = 0; j < I.getWidth(); j++) {
+        if (I[i][j] != pixel(frame, i, j)) {
+          std::cerr << name << ": the image is not the frame " << frame << std::endl;
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  bool checkFrame(const std::string &name, const vpImage<vpRGBa> &I, const long frame) {
+    vpImage<unsigned char> Ig(I.getHeight(), I.getWidth());
+    for (unsigned int i = 0; i < I.getSize(); i++) {
+      Ig.bitmap[i] = I.bitmap[i].R;
+    }
+    return checkFrame(name, Ig, frame);
+  }
+
+  // Read the frames first, first + step, ... with acquire() and check them
+  bool readSequence(const std::string &name, vpDiskGrabber &g, const long first, const long step,
+                    const unsigned int nb, std::set<unsigned char *> &buffers) {
+    vpImage<unsigned char> I;
+    g.setImageNumber(first);
+    g.setStep(step);
+    for (unsigned int k = 0; k < nb; k++) {
+      g.acquire(I);
+      buffers.insert(I.bitmap);
+      if (g.getImageNumber() != first + (long)k * step || !checkFrame(name, I, first + (long)k * step)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool testDiskGrabber(const std::string &genericName, const unsigned int nbBuffers, const unsigned int nbThreads) {
+    vpDiskGrabber g(genericName);
+    g.setPrefetch(nbBuffers, nbThreads);
+
+    std::stringstream ss;
+    ss << "vpDiskGrabber with " << nbBuffers << " buffers and " << nbThreads << " threads";
+    const std::string name = ss.str();
+
+    std::set<unsigned char *> buffers;
+    if (!readSequence(name, g, 0, 1, nbFrames, buffers)) {
+      return false;
+    }
+    if (nbBuffers > 0 && buffers.size() > nbBuffers + 1) {
+      std::cerr << name << ": " << buffers.size() << " buffers were used instead of " << nbBuffers + 1 << std::endl;
+      return false;
+    }
+
+    // Frame steps
+    if (!readSequence(name, g, 1, 2, nbFrames / 2, buffers) || !readSequence(name, g, nbFrames - 1, -3, 10, buffers)) {
+      return false;
+    }
+
+    // Seeks
+    vpImage<unsigned char> I;
+    g.setStep(1);
+    g.setImageNumber(0);
+    g.acquire(I);
+    g.acquire(I, 17);
+    if (!checkFrame(name, I, 17)) {
+      return false;
+    }
+    g.acquire(I);
+    if (g.getImageNumber() != 18 || !checkFrame(name, I, 18)) {
+      return false;
+    }
+    g.setImageNumber(5);
+    g.acquire(I);
+    if (g.getImageNumber() != 5 || !checkFrame(name, I, 5)) {
+      return false;
+    }
+
+    // Change of image type
+    vpImage<vpRGBa> Ic;
+    g.acquire(Ic);
+    if (!checkFrame(name, Ic, 6)) {
+      return false;
+    }
+    g.acquire(I);
+    if (!checkFrame(name, I, 7)) {
+      return false;
+    }
+
+    // The end of the sequence is reported when it is reached
+    g.setImageNumber(nbFrames - 1);
+    g.acquire(I);
+    try {
+      g.acquire(I);
+      std::cerr << name << ": reading after the last frame should throw an exception" << std::endl;
+      return false;
+    }
+    catch(const vpImageException &) {
+    }
+    if (g.getImageNumber() != (long)nbFrames) {
+      std::cerr << name << ": wrong image number after the end of the sequence" << std::endl;
+      return false;
+    }
+
+    std::cout << name << ": ok" << std::endl;
+    return true;
+  }
+
+  bool testVideoReader(const std::string &genericName, const long step, const unsigned int nbBuffers) {
+    std::stringstream ss;
+    ss << "vpVideoReader with a step of " << step << " and " << nbBuffers << " buffers";
+    const std::string name = ss.str();
+
+    vpImage<unsigned char> I;
+    vpVideoReader reader;
+    reader.setFileName(genericName);
+    reader.setFrameStep(step);
+    reader.setPrefetch(nbBuffers, 2);
+    reader.open(I);
+    if (reader.getFirstFrameIndex() != 0 || reader.getLastFrameIndex() != (long)nbFrames - 1) {
+      std::cerr << name << ": wrong first or last frame" << std::endl;
+      return false;
+    }
+
+    long expected = 0;
+    unsigned int nb = 0;
+    while (!reader.end()) {
+      reader.acquire(I);
+      if (reader.getFrameIndex() != expected || !checkFrame(name, I, expected)) {
+        return false;
+      }
+      expected += step;
+      nb++;
+    }
+    if (nb != (nbFrames - 1) / step + 1) {
+      std::cerr << name << ": " << nb << " frames were read" << std::endl;
+      return false;
+    }
+
+    if (!reader.getFrame(I, 10) || reader.getFrameIndex() != 10 || !checkFrame(name, I, 10)) {
+      return false;
+    }
+    reader.acquire(I);
+    if (reader.getFrameIndex() != 10 || !checkFrame(name, I, 10)) {
+      return false;
+    }
+    reader.acquire(I);
+    if (reader.getFrameIndex() != 10 + step || !checkFrame(name, I, 10 + step)) {
+      return false;
+    }
+
+    std::cout << name << ": ok" << std::endl;
+    return true;
+  }
+
+  // Mean time to read an image of the sequence and process it during processingTime ms
+  double readingTime(const std::string &genericName, const unsigned int nbBuffers, const double processingTime) {
+    vpDiskGrabber g(genericName);
+    g.setPrefetch(nbBuffers, 2);
+    vpImage<unsigned char> I;
+    double t = vpTime::measureTimeMs();
+    for (unsigned int k = 0; k < nbFrames; k++) {
+      g.acquire(I);
+      vpTime::sleepMs(processingTime);
+    }
+    return (vpTime::measureTimeMs() - t) / nbFrames;
+  }
+}
+
+int main()
+{
+  try {
+#if defined(_WIN32)
+    std::string path = "C:/temp";
+#else
+    std::string path = "/tmp";
+#endif
+    try {
+      path = vpIoTools::createFilePath(path, vpIoTools::getUserName());
+    }
+    catch(const vpException &) {
+      // No user name, use the temporary directory
+    }
+    path = vpIoTools::createFilePath(path, "testVideoReaderPrefetch");
+    if (!vpIoTools::checkDirectory(path)) {
+      vpIoTools::makeDirectory(path);
+    }
+
+    // A sequence of images where each image can be identified
+    const std::string genericName = vpIoTools::createFilePath(path, "image%04d.pgm");
+    vpImage<unsigned char> I(480, 640);
+    for (unsigned int k = 0; k < nbFrames; k++) {
+      for (unsigned int i = 0; i < I.getHeight(); i++) {
+        for (unsigned int j = 0; j < I.getWidth(); j++) {
+          I[i][j] = pixel(k, i, j);
+        }
+      }
+      char filename[FILENAME_MAX];
+      sprintf(filename, genericName.c_str(), k);
+      vpImageIo::write(I, filename);
+    }
+
+    bool success = testDiskGrabber(genericName, 0, 1) && testDiskGrabber(genericName, 1, 1) &&
+        testDiskGrabber(genericName, 4, 2) && testDiskGrabber(genericName, 8, 3) &&
+        testVideoReader(genericName, 1, 0) && testVideoReader(genericName, 1, 4) &&
+        testVideoReader(genericName, 3, 4);
+
+    if (success) {
+      const double processingTime = 5;
+      std::cout << "Mean time to read an image and process it during " << processingTime << " ms: "
+                << readingTime(genericName, 0, processingTime) << " ms without prefetch, "
+                << readingTime(genericName, 4, processingTime) << " ms with prefetch" << std::endl;
+    }
+
+    for (unsigned int k = 0; k < nbFrames; k++) {
+      char filename[FILENAME_MAX];
+      sprintf(filename, genericName.c_str(), k);
+      vpIoTools::remove(filename);
+    }
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+  } catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
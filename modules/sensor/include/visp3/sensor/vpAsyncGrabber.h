@@ -0,0 +1,175 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Asynchronous acquisition with any frame grabber.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpAsyncGrabber.h
+  \brief Adaptor that runs the acquisition of any vpFrameGrabber in a dedicated thread.
+*/
+
+#ifndef vpAsyncGrabber_h
+#define vpAsyncGrabber_h
+
+#include <visp3/core/vpConfig.h>
+
+#if defined(VISP_HAVE_PTHREAD)
+
+#include <visp3/core/vpFrameGrabber.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpRGBa.h>
+
+/*!
+  \class vpAsyncGrabber
+
+  \ingroup group_sensor_camera
+
+  \brief Adaptor that runs the acquisition of a frame grabber in a dedicated
+  capture thread.
+
+  With a classical frame grabber, acquire() is called in the processing loop:
+  when the processing is slower than the camera, the frames wait in the driver
+  and the returned frame gets older and older. vpAsyncGrabber calls the
+  acquire() method of the wrapped grabber (vpV4l2Grabber, vp1394TwoGrabber,
+  vpFlyCaptureGrabber, vpPylonGrabber, vpOpenCVGrabber, or any class that
+  inherits from vpFrameGrabber) in a capture thread, and hands the frames over
+  to the processing thread with one of the following modes:
+
+  - vpAsyncGrabber::LATEST_FRAME: a triple buffer keeps the last captured
+    frame. acquire() returns the most recent frame, waiting only if it was
+    already returned. The frames that were overwritten before being consumed
+    are counted by getDroppedCount().
+  - vpAsyncGrabber::EVERY_FRAME: a single-producer / single-consumer ring
+    keeps the frames in capture order. acquire() returns the oldest frame not
+    yet consumed. When the ring is full the new frames are dropped and counted
+    by getDroppedCount().
+
+  The frame buffers are exchanged between the threads without lock, and the
+  image given to acquire() is swapped with the captured one so that no pixel
+  is copied. The capture thread takes a lock only to wake up a processing
+  thread that waits for a frame.
+
+  getLatency() gives the time between the end of the capture of a frame and
+  its consumption by acquire(). When the wrapped grabber throws an exception
+  in the capture thread, the capture stops and the exception is thrown again
+  by acquire() once the remaining frames are consumed. An exception that is
+  not a vpException is thrown as a vpException::fatalError.
+
+  \code
+#include <visp3/sensor/vpAsyncGrabber.h>
+#include <visp3/sensor/vpV4l2Grabber.h>
+
+int main()
+{
+#if defined(VISP_HAVE_V4L2) && defined(VISP_HAVE_PTHREAD)
+  vpImage<unsigned char> I;
+  vpV4l2Grabber g;
+  vpAsyncGrabber async(g, vpAsyncGrabber::LATEST_FRAME);
+  async.open(I); // Opens the v4l2 grabber and starts the capture thread
+
+  for (unsigned int cpt = 0; cpt < 100; cpt ++) {
+    async.acquire(I); // Newest frame, without copy
+    // ... process I
+  }
+  std::cout << async.getDroppedCount() << " frames dropped, mean latency "
+            << async.getMeanLatency() << " ms" << std::endl;
+  async.close();
+#endif
+}
+  \endcode
+
+  \note The wrapped grabber must not be used directly between open() and
+  close(). The statistics are to be read from the thread that calls acquire().
+*/
+class VISP_EXPORT vpAsyncGrabber : public vpFrameGrabber
+{
+public:
+  /*! \enum vpAsyncGrabberModeType
+    Hand over policy between the capture thread and acquire().
+  */
+  typedef enum {
+    LATEST_FRAME, /*!< Return the most recent frame, older ones are dropped */
+    EVERY_FRAME   /*!< Return the frames in capture order through a ring buffer */
+  } vpAsyncGrabberModeType;
+
+  explicit vpAsyncGrabber(vpFrameGrabber &grabber, vpAsyncGrabberModeType mode=LATEST_FRAME,
+                          unsigned int nbBuffers=8);
+  virtual ~vpAsyncGrabber();
+
+  void open(vpImage<unsigned char> &I);
+  void open(vpImage<vpRGBa> &I);
+
+  void acquire(vpImage<unsigned char> &I);
+  void acquire(vpImage<vpRGBa> &I);
+
+  void close();
+
+  unsigned int getCapturedCount() const;
+  unsigned int getConsumedCount() const;
+  unsigned int getDroppedCount() const;
+  double getLatency() const;
+  double getMeanLatency() const;
+  double getTimestamp() const;
+
+  /*!
+    Return the hand over mode.
+    \sa setMode()
+  */
+  inline vpAsyncGrabberModeType getMode() const { return m_mode; }
+  /*!
+    Return the number of frames of the ring buffer used in vpAsyncGrabber::EVERY_FRAME mode.
+    \sa setNBuffers()
+  */
+  inline unsigned int getNBuffers() const { return m_nbBuffers; }
+
+  /*!
+    Set the hand over mode. It is taken into account at the next open().
+  */
+  inline void setMode(vpAsyncGrabberModeType mode) { m_mode = mode; }
+  void setNBuffers(unsigned int nbBuffers);
+
+private:
+  class Capture;
+
+  vpFrameGrabber &m_grabber;
+  vpAsyncGrabberModeType m_mode;
+  unsigned int m_nbBuffers;
+  Capture *m_capture;
+
+  // Non copyable
+  vpAsyncGrabber(const vpAsyncGrabber &);
+  vpAsyncGrabber &operator=(const vpAsyncGrabber &);
+};
+
+#endif
+#endif
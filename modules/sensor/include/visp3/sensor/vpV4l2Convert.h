@@ -0,0 +1,90 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Conversion of raw Video For Linux 2 buffers.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpV4l2Convert.h
+  \brief Conversion of the raw buffers filled by a Video For Linux 2 driver.
+*/
+
+#ifndef vpV4l2Convert_h
+#define vpV4l2Convert_h
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpRGBa.h>
+#include <visp3/core/vpRect.h>
+
+/*!
+  \class vpV4l2Convert
+
+  \ingroup group_sensor_camera
+
+  \brief Conversion of the raw buffers filled by a Video For Linux 2 driver
+  into grey level or color images.
+
+  These functions are used by vpV4l2Grabber::acquire() and
+  vpV4l2Grabber::convert(). They only work on memory and do not need the V4L2
+  3rd party, so that they are available even when vpV4l2Grabber is not.
+
+  Only the region of interest is converted: when it spans the whole width the
+  rows are contiguous and converted at once, otherwise they are converted one
+  by one so that only the useful pixels are read.
+*/
+class VISP_EXPORT vpV4l2Convert
+{
+public:
+  /*! \enum vpV4l2PixelFormatType
+    Pixel coding of a raw buffer. The values are the ones of
+    vpV4l2Grabber::vpV4l2PixelFormatType.
+  */
+  typedef enum {
+    V4L2_GREY_FORMAT,  /*!< 8  Greyscale */
+    V4L2_RGB24_FORMAT, /*!< 24  RGB-8-8-8 */
+    V4L2_RGB32_FORMAT, /*!< 32  RGB-8-8-8-8 */
+    V4L2_BGR24_FORMAT, /*!< 24  BGR-8-8-8 */
+    V4L2_YUYV_FORMAT,  /*!< 16  YUYV 4:2:2  */
+    V4L2_MAX_FORMAT
+  } vpV4l2PixelFormatType;
+
+  static unsigned int bytesPerPixel(vpV4l2PixelFormatType pixelformat);
+  static void convert(const unsigned char *bitmap, unsigned int width, unsigned int height,
+                      vpV4l2PixelFormatType pixelformat, vpImage<unsigned char> &I, const vpRect &roi=vpRect());
+  static void convert(const unsigned char *bitmap, unsigned int width, unsigned int height,
+                      vpV4l2PixelFormatType pixelformat, vpImage<vpRGBa> &I, const vpRect &roi=vpRect());
+  static void roiBounds(unsigned int width, unsigned int height, const vpRect &roi,
+                        unsigned int &i_min, unsigned int &j_min, unsigned int &r_height, unsigned int &r_width);
+};
+
+#endif
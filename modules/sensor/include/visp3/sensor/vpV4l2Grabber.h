@@ -59,6 +59,7 @@
 #include <visp3/core/vpFrameGrabber.h>
 #include <visp3/core/vpRGBa.h>
 #include <visp3/core/vpRect.h>
+#include <visp3/sensor/vpV4l2Convert.h>
 
 /*!
   \class vpV4l2Grabber
@@ -126,6 +127,41 @@ int main()
 }
   \endcode
 
+  When the conversion of every frame into a vpImage is too expensive, the
+  streaming API gives a direct read-only access to the memory mapped driver
+  buffers. acquireFrame() dequeues a frame and returns it with its timestamp
+  and its driver sequence number; the buffer stays owned by the caller until
+  it is given back with releaseFrame(). The frame is converted into a
+  caller-owned image only when needed with convert(), and a grey level frame
+  can even be wrapped without any copy with getView(). With the
+  vpV4l2Grabber::V4L2_DROP_OLDEST_POLICY buffer policy set with
+  setBufferPolicy(), acquireFrame() always returns the most recent frame and
+  requeues the older ones, which keeps the latency constant when the
+  processing is slower than the camera.
+  \code
+#include <visp3/sensor/vpV4l2Grabber.h>
+
+int main()
+{
+#if defined(VISP_HAVE_V4L2)
+  vpImage<unsigned char> I;
+  vpV4l2Grabber g;
+  g.setPixelFormat(vpV4l2Grabber::V4L2_GREY_FORMAT);
+  g.setNBuffers(4);
+  g.setBufferPolicy(vpV4l2Grabber::V4L2_DROP_OLDEST_POLICY);
+  g.open(I);
+
+  vpV4l2Grabber::vpV4l2Frame frame;
+  for (unsigned int cpt = 0; cpt < 100; cpt ++) {
+    g.acquireFrame(frame); // Dequeue the newest frame, no copy
+    g.getView(frame, I);   // I points to the driver buffer
+    // ... process I
+    g.releaseFrame(frame); // Give the buffer back to the driver
+  }
+#endif
+}
+  \endcode
+
 
   \author Fabien Spindler (Fabien.Spindler@irisa.fr), Irisa / Inria Rennes
 
@@ -166,14 +202,44 @@ public:
     Pixel format type for capture.
   */
   typedef enum {
-    V4L2_GREY_FORMAT, /*!< 8  Greyscale */
-    V4L2_RGB24_FORMAT, /*!< 24  RGB-8-8-8 */
-    V4L2_RGB32_FORMAT, /*!< 32  RGB-8-8-8-8 */
-    V4L2_BGR24_FORMAT, /*!< 24  BGR-8-8-8 */
-    V4L2_YUYV_FORMAT, /*!< 16  YUYV 4:2:2  */
-    V4L2_MAX_FORMAT
+    V4L2_GREY_FORMAT = vpV4l2Convert::V4L2_GREY_FORMAT, /*!< 8  Greyscale */
+    V4L2_RGB24_FORMAT = vpV4l2Convert::V4L2_RGB24_FORMAT, /*!< 24  RGB-8-8-8 */
+    V4L2_RGB32_FORMAT = vpV4l2Convert::V4L2_RGB32_FORMAT, /*!< 32  RGB-8-8-8-8 */
+    V4L2_BGR24_FORMAT = vpV4l2Convert::V4L2_BGR24_FORMAT, /*!< 24  BGR-8-8-8 */
+    V4L2_YUYV_FORMAT = vpV4l2Convert::V4L2_YUYV_FORMAT, /*!< 16  YUYV 4:2:2  */
+    V4L2_MAX_FORMAT = vpV4l2Convert::V4L2_MAX_FORMAT
   } vpV4l2PixelFormatType;
 
+  /*! \enum vpV4l2BufferPolicyType
+    Policy used by acquireFrame() when several frames are waiting in the
+    ring buffers.
+  */
+  typedef enum {
+    V4L2_BLOCK_POLICY,      /*!< Return the oldest filled buffer, frames are never lost */
+    V4L2_DROP_OLDEST_POLICY /*!< Return the newest filled buffer and requeue the older ones */
+  } vpV4l2BufferPolicyType;
+
+  /*!
+    Frame dequeued from the driver by acquireFrame(). The pixels are not
+    copied: \e data points to the memory mapped driver buffer and stays
+    valid until the frame is given back with releaseFrame().
+  */
+  struct vpV4l2Frame {
+    const unsigned char *data;         //!< Raw pixels in the \e pixelformat coding
+    unsigned int width;                //!< Frame width
+    unsigned int height;               //!< Frame height
+    vpV4l2PixelFormatType pixelformat; //!< Pixel coding of \e data
+    struct timeval timestamp;          //!< Capture time given by the driver
+    unsigned int sequence;             //!< Sequence number given by the driver
+    unsigned int field;                //!< Field of the frame
+    __u32 index;                       //!< Index of the driver buffer
+
+    vpV4l2Frame()
+      : data(NULL), width(0), height(0), pixelformat(V4L2_MAX_FORMAT),
+        timestamp(), sequence(0), field(0), index(0)
+    {}
+  };
+
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
   struct ng_video_fmt {
     unsigned int   pixelformat;         /* VIDEO_* */
@@ -230,6 +296,22 @@ public:
   void acquire(vpImage<vpRGBa> &I);
   void acquire(vpImage<vpRGBa> &I, const vpRect &roi);
   void acquire(vpImage<vpRGBa> &I, struct timeval &timestamp, const vpRect &roi=vpRect());
+
+  void acquireFrame(vpV4l2Frame &frame);
+  void releaseFrame(const vpV4l2Frame &frame);
+  void convert(const vpV4l2Frame &frame, vpImage<unsigned char> &I, const vpRect &roi=vpRect());
+  void convert(const vpV4l2Frame &frame, vpImage<vpRGBa> &I, const vpRect &roi=vpRect());
+  void getView(const vpV4l2Frame &frame, vpImage<unsigned char> &I);
+
+  /*!
+    Get the policy used by acquireFrame() to select the returned buffer.
+
+    \sa setBufferPolicy()
+  */
+  inline vpV4l2BufferPolicyType getBufferPolicy() const
+  {
+    return m_bufferpolicy;
+  }
   bool getField();
   vpV4l2FramerateType getFramerate();
   /*!
@@ -285,12 +367,38 @@ public:
   real-time applications to reach 25 fps or 50 fps a good compromise is to set
   the number of buffers to 3.
 
-  \param nbuffers : Number of ring buffers.
+  With the streaming API, each frame held by the caller between
+  acquireFrame() and releaseFrame() keeps a buffer out of the ring. The number
+  of buffers should thus be larger than the number of frames held at the same
+  time.
+
+  \param nbuffers : Number of ring buffers. The value is limited to
+  vpV4l2Grabber::MAX_BUFFERS.
 
   */
   inline void setNBuffers(unsigned nbuffers)
   {
     this->m_nbuffers = nbuffers;
+    if (this->m_nbuffers > MAX_BUFFERS)
+      this->m_nbuffers = MAX_BUFFERS;
+    if (this->m_nbuffers == 0)
+      this->m_nbuffers = 1;
+  }
+
+  /*!
+    Set the policy used by acquireFrame() when more than one frame is
+    waiting in the ring buffers.
+
+    \param policy :
+    - vpV4l2Grabber::V4L2_BLOCK_POLICY: frames are returned in their capture
+      order; when the processing is slower than the camera the latency grows
+      until the driver runs out of buffers.
+    - vpV4l2Grabber::V4L2_DROP_OLDEST_POLICY: the newest frame is returned and
+      the older ones are requeued immediately.
+  */
+  inline void setBufferPolicy(vpV4l2BufferPolicyType policy)
+  {
+    this->m_bufferpolicy = policy;
   }
 
   /*!
@@ -339,7 +447,9 @@ private:
   void startStreaming();
   void stopStreaming();
   unsigned char * waiton(__u32 &index, struct timeval &timestamp);
+  bool dequeueBuffer(__u32 &index);
   int  queueBuffer();
+  void queueBuffer(__u32 index);
   void queueAll();
   void printBufInfo(struct v4l2_buffer buf);
 
@@ -372,6 +482,7 @@ private:
   vpV4l2FramerateType m_framerate;
   vpV4l2FrameFormatType m_frameformat;
   vpV4l2PixelFormatType m_pixelformat;
+  vpV4l2BufferPolicyType m_bufferpolicy;
 } ;
 
 #endif
@@ -0,0 +1,603 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Asynchronous acquisition with any frame grabber.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpAsyncGrabber.cpp
+  \brief Adaptor that runs the acquisition of any vpFrameGrabber in a dedicated thread.
+*/
+
+#include <visp3/sensor/vpAsyncGrabber.h>
+
+#if defined(VISP_HAVE_PTHREAD)
+
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpFrameGrabberException.h>
+#include <visp3/core/vpThread.h>
+#include <visp3/core/vpTime.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+  // Shared counters and indexes of the hand over. They have a single writer;
+  // the full barriers order the frame buffer accesses with the index updates.
+#if defined(__GNUC__)
+  inline unsigned int vp_atomicExchange(volatile unsigned int *ptr, unsigned int value)
+  {
+    __sync_synchronize();
+    return __sync_lock_test_and_set(ptr, value);
+  }
+
+  inline unsigned int vp_atomicLoad(volatile unsigned int *ptr)
+  {
+    return __sync_fetch_and_add(ptr, 0);
+  }
+
+  inline void vp_atomicStore(volatile unsigned int *ptr, unsigned int value)
+  {
+    __sync_synchronize();
+    *ptr = value;
+    __sync_synchronize();
+  }
+#else
+  pthread_mutex_t vp_atomicMutex = PTHREAD_MUTEX_INITIALIZER;
+
+  inline unsigned int vp_atomicExchange(volatile unsigned int *ptr, unsigned int value)
+  {
+    pthread_mutex_lock(&vp_atomicMutex);
+    unsigned int previous = *ptr;
+    *ptr = value;
+    pthread_mutex_unlock(&vp_atomicMutex);
+    return previous;
+  }
+
+  inline unsigned int vp_atomicLoad(volatile unsigned int *ptr)
+  {
+    pthread_mutex_lock(&vp_atomicMutex);
+    unsigned int value = *ptr;
+    pthread_mutex_unlock(&vp_atomicMutex);
+    return value;
+  }
+
+  inline void vp_atomicStore(volatile unsigned int *ptr, unsigned int value)
+  {
+    pthread_mutex_lock(&vp_atomicMutex);
+    *ptr = value;
+    pthread_mutex_unlock(&vp_atomicMutex);
+  }
+#endif
+}
+
+/*!
+  Frame buffers shared between the capture thread and the thread that calls
+  vpAsyncGrabber::acquire().
+
+  In vpAsyncGrabber::LATEST_FRAME mode the three slots form a triple buffer:
+  the capture thread owns the \e back slot, the consumer owns the \e front slot
+  and the last published slot is stored in \e m_latest with the FRESH flag
+  until it is consumed. Publishing or consuming a frame is a single atomic
+  exchange of slot indexes.
+
+  In vpAsyncGrabber::EVERY_FRAME mode the first slots form a ring indexed by
+  the number of published (\e m_tail) and consumed (\e m_head) frames. The last
+  slot receives the frames captured while the ring is full.
+
+  Frames are given to the consumer by swapping the slot image with the one of
+  the caller, whose buffer is recycled for a next capture.
+*/
+class vpAsyncGrabber::Capture
+{
+public:
+  Capture(vpFrameGrabber &grabber, vpAsyncGrabberModeType mode, unsigned int nbBuffers);
+  ~Capture();
+
+  template<class Type> void start(const vpImage<Type> &I);
+  template<class Type> void acquire(vpImage<Type> &I);
+  void stop();
+
+  unsigned int getCapturedCount() { return vp_atomicLoad(&m_captured); }
+  unsigned int getConsumedCount() const { return m_consumed; }
+  unsigned int getDroppedCount() { return vp_atomicLoad(&m_dropped); }
+  double getLatency() const { return m_latency; }
+  double getMeanLatency() const { return m_consumed ? m_latencySum / m_consumed : 0.; }
+  double getTimestamp() const { return m_timestamp; }
+
+private:
+  typedef enum {
+    IMAGE_NONE,
+    IMAGE_UCHAR,
+    IMAGE_RGBA
+  } vpImageType;
+
+  struct vpSlot {
+    vpSlot() : I_uchar(), I_rgba(), timestamp(0.) {}
+
+    vpImage<unsigned char> I_uchar;
+    vpImage<vpRGBa> I_rgba;
+    double timestamp; //!< Time in ms at which the capture ended
+  };
+
+  static const unsigned int FRESH = 0x80000000;
+
+  static vpImageType getType(const vpImage<unsigned char> &) { return IMAGE_UCHAR; }
+  static vpImageType getType(const vpImage<vpRGBa> &) { return IMAGE_RGBA; }
+  static vpImage<unsigned char> &getBuffer(vpSlot &slot, const vpImage<unsigned char> &) { return slot.I_uchar; }
+  static vpImage<vpRGBa> &getBuffer(vpSlot &slot, const vpImage<vpRGBa> &) { return slot.I_rgba; }
+
+  static vpThread::Return captureThread(vpThread::Args args);
+  template<class Type> void capture();
+  template<class Type> void publish(const vpImage<Type> &type);
+  bool available();
+  void fail(bool grabberError, int errorCode, const std::string &errorMessage);
+  void notify();
+
+  vpFrameGrabber &m_grabber;
+  vpAsyncGrabberModeType m_mode;
+  std::vector<vpSlot> m_slots;
+  vpImageType m_type;
+  vpThread *m_thread;
+  pthread_mutex_t m_mutex;
+  pthread_cond_t m_cond;
+
+  // Written by the capture thread
+  unsigned int m_back;
+  volatile unsigned int m_tail;
+  volatile unsigned int m_captured;
+  volatile unsigned int m_dropped;
+  bool m_failed;
+  bool m_grabberError; //!< true if the error was a vpFrameGrabberException
+  int m_errorCode;
+  std::string m_errorMessage;
+
+  // Written by the consumer
+  unsigned int m_front;
+  volatile unsigned int m_head;
+  volatile unsigned int m_waiting;
+  volatile unsigned int m_stop;
+  unsigned int m_consumed;
+  double m_latency;
+  double m_latencySum;
+  double m_timestamp;
+
+  // Exchanged between both
+  volatile unsigned int m_latest;
+
+  // Non copyable
+  Capture(const Capture &);
+  Capture &operator=(const Capture &);
+};
+
+vpAsyncGrabber::Capture::Capture(vpFrameGrabber &grabber, vpAsyncGrabberModeType mode, unsigned int nbBuffers)
+  : m_grabber(grabber), m_mode(mode), m_slots(mode == LATEST_FRAME ? 3 : nbBuffers + 1), m_type(IMAGE_NONE),
+    m_thread(NULL), m_mutex(), m_cond(), m_back(0), m_tail(0), m_captured(0), m_dropped(0), m_failed(false),
+    m_grabberError(false), m_errorCode(0), m_errorMessage(), m_front(2), m_head(0), m_waiting(0), m_stop(0), m_consumed(0),
+    m_latency(0.), m_latencySum(0.), m_timestamp(0.), m_latest(1)
+{
+  pthread_mutex_init(&m_mutex, NULL);
+  pthread_cond_init(&m_cond, NULL);
+}
+
+vpAsyncGrabber::Capture::~Capture()
+{
+  stop();
+  pthread_cond_destroy(&m_cond);
+  pthread_mutex_destroy(&m_mutex);
+}
+
+/*!
+  Allocate the frame buffers with the size of \e I and launch the capture thread.
+*/
+template<class Type>
+void vpAsyncGrabber::Capture::start(const vpImage<Type> &I)
+{
+  m_type = getType(I);
+  for (size_t i = 0; i < m_slots.size(); i++) {
+    getBuffer(m_slots[i], I).resize(I.getHeight(), I.getWidth());
+  }
+  m_thread = new vpThread(captureThread, (vpThread::Args)this);
+}
+
+/*!
+  Stop the capture thread. It ends after the acquisition in progress.
+*/
+void vpAsyncGrabber::Capture::stop()
+{
+  if (m_thread != NULL) {
+    vp_atomicStore(&m_stop, 1);
+    m_thread->join();
+    delete m_thread;
+    m_thread = NULL;
+  }
+}
+
+vpThread::Return vpAsyncGrabber::Capture::captureThread(vpThread::Args args)
+{
+  Capture *capture = static_cast<Capture *>(args);
+  if (capture->m_type == IMAGE_UCHAR) {
+    capture->capture<unsigned char>();
+  }
+  else {
+    capture->capture<vpRGBa>();
+  }
+  return 0;
+}
+
+/*!
+  Capture thread loop.
+*/
+template<class Type>
+void vpAsyncGrabber::Capture::capture()
+{
+  const vpImage<Type> type;
+  while (vp_atomicLoad(&m_stop) == 0) {
+    try {
+      publish(type);
+    }
+    catch(vpException &e) {
+      fail(dynamic_cast<vpFrameGrabberException *>(&e) != NULL, e.getCode(), e.getStringMessage());
+      return;
+    }
+    catch(const std::exception &e) {
+      fail(false, vpException::fatalError, e.what());
+      return;
+    }
+    catch(...) {
+      fail(false, vpException::fatalError, "Unknown error in the capture thread");
+      return;
+    }
+    notify();
+  }
+}
+
+/*!
+  Record the error that stopped the capture thread and wake up the consumer,
+  which throws it.
+*/
+void vpAsyncGrabber::Capture::fail(bool grabberError, int errorCode, const std::string &errorMessage)
+{
+  pthread_mutex_lock(&m_mutex);
+  m_failed = true;
+  m_grabberError = grabberError;
+  m_errorCode = errorCode;
+  m_errorMessage = errorMessage;
+  pthread_cond_broadcast(&m_cond);
+  pthread_mutex_unlock(&m_mutex);
+}
+
+/*!
+  Acquire a frame with the wrapped grabber and publish it.
+*/
+template<class Type>
+void vpAsyncGrabber::Capture::publish(const vpImage<Type> &type)
+{
+  if (m_mode == LATEST_FRAME) {
+    vpSlot &slot = m_slots[m_back];
+    m_grabber.acquire(getBuffer(slot, type));
+    slot.timestamp = vpTime::measureTimeMs();
+    unsigned int previous = vp_atomicExchange(&m_latest, m_back | FRESH);
+    if (previous & FRESH) {
+      // The previous frame was not consumed
+      vp_atomicStore(&m_dropped, m_dropped + 1);
+    }
+    m_back = previous & ~FRESH;
+  }
+  else {
+    const unsigned int ringSize = (unsigned int)m_slots.size() - 1;
+    if (m_tail - vp_atomicLoad(&m_head) < ringSize) {
+      vpSlot &slot = m_slots[m_tail % ringSize];
+      m_grabber.acquire(getBuffer(slot, type));
+      slot.timestamp = vpTime::measureTimeMs();
+      vp_atomicStore(&m_tail, m_tail + 1);
+    }
+    else {
+      // The ring is full: keep the camera running but drop the frame
+      m_grabber.acquire(getBuffer(m_slots[ringSize], type));
+      vp_atomicStore(&m_dropped, m_dropped + 1);
+    }
+  }
+  vp_atomicStore(&m_captured, m_captured + 1);
+}
+
+/*!
+  Return true if a frame is ready to be consumed.
+*/
+bool vpAsyncGrabber::Capture::available()
+{
+  if (m_mode == LATEST_FRAME) {
+    return (vp_atomicLoad(&m_latest) & FRESH) != 0;
+  }
+  return vp_atomicLoad(&m_tail) != m_head;
+}
+
+/*!
+  Wake up the consumer if it waits for a frame. The flag is set by the consumer
+  before it checks for a frame under the lock, so that a frame published in
+  between is never missed.
+*/
+void vpAsyncGrabber::Capture::notify()
+{
+  if (vp_atomicLoad(&m_waiting)) {
+    pthread_mutex_lock(&m_mutex);
+    pthread_cond_broadcast(&m_cond);
+    pthread_mutex_unlock(&m_mutex);
+  }
+}
+
+/*!
+  Give the next frame to the consumer, waiting for it if needed.
+*/
+template<class Type>
+void vpAsyncGrabber::Capture::acquire(vpImage<Type> &I)
+{
+  if (getType(I) != m_type) {
+    throw(vpFrameGrabberException(vpFrameGrabberException::settingError,
+                                  "The asynchronous grabber was opened with another image type"));
+  }
+
+  if (!available()) {
+    pthread_mutex_lock(&m_mutex);
+    vp_atomicStore(&m_waiting, 1);
+    while (!available() && !m_failed) {
+      pthread_cond_wait(&m_cond, &m_mutex);
+    }
+    vp_atomicStore(&m_waiting, 0);
+    const bool failed = !available() && m_failed;
+    const bool grabberError = m_grabberError;
+    const int errorCode = m_errorCode;
+    const std::string errorMessage = m_errorMessage;
+    pthread_mutex_unlock(&m_mutex);
+
+    if (failed) {
+      if (grabberError) {
+        throw(vpFrameGrabberException(errorCode, errorMessage));
+      }
+      throw(vpException(errorCode, errorMessage));
+    }
+  }
+
+  vpSlot *slot;
+  if (m_mode == LATEST_FRAME) {
+    m_front = vp_atomicExchange(&m_latest, m_front) & ~FRESH;
+    slot = &m_slots[m_front];
+  }
+  else {
+    slot = &m_slots[m_head % (m_slots.size() - 1)];
+  }
+
+  vpImage<Type> &buffer = getBuffer(*slot, I);
+  vpDisplay *display = I.display;
+  swap(I, buffer);
+  buffer.display = I.display;
+  I.display = display;
+
+  m_timestamp = slot->timestamp;
+  m_latency = vpTime::measureTimeMs() - m_timestamp;
+  m_latencySum += m_latency;
+  m_consumed++;
+
+  if (m_mode == EVERY_FRAME) {
+    // Give the slot back to the capture thread
+    vp_atomicStore(&m_head, m_head + 1);
+  }
+}
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Create an asynchronous adaptor of \e grabber. The capture thread is started by open().
+
+  \param grabber : Frame grabber to run in the capture thread. It must stay alive as
+  long as this object.
+  \param mode : Hand over mode between the capture thread and acquire().
+  \param nbBuffers : Number of frames of the ring used in vpAsyncGrabber::EVERY_FRAME mode.
+*/
+vpAsyncGrabber::vpAsyncGrabber(vpFrameGrabber &grabber, vpAsyncGrabberModeType mode, unsigned int nbBuffers)
+  : vpFrameGrabber(), m_grabber(grabber), m_mode(mode), m_nbBuffers(1), m_capture(NULL)
+{
+  setNBuffers(nbBuffers);
+}
+
+/*!
+  Destructor that stops the capture thread and closes the wrapped grabber.
+*/
+vpAsyncGrabber::~vpAsyncGrabber()
+{
+  close();
+  delete m_capture;
+}
+
+/*!
+  Set the number of frames of the ring used in vpAsyncGrabber::EVERY_FRAME mode.
+  It is taken into account at the next open().
+
+  \param nbBuffers : Number of frames; must be greater than 0.
+*/
+void vpAsyncGrabber::setNBuffers(unsigned int nbBuffers)
+{
+  if (nbBuffers == 0) {
+    throw(vpFrameGrabberException(vpFrameGrabberException::settingError,
+                                  "The asynchronous grabber needs at least one buffer"));
+  }
+  m_nbBuffers = nbBuffers;
+}
+
+/*!
+  Open the wrapped grabber and start the capture thread for grey level images.
+
+  \param I : Image with the size of the frames.
+*/
+void vpAsyncGrabber::open(vpImage<unsigned char> &I)
+{
+  close();
+  m_grabber.open(I);
+  width = m_grabber.getWidth();
+  height = m_grabber.getHeight();
+
+  delete m_capture;
+  m_capture = new Capture(m_grabber, m_mode, m_nbBuffers);
+  m_capture->start(I);
+  init = true;
+}
+
+/*!
+  Open the wrapped grabber and start the capture thread for color images.
+
+  \param I : Image with the size of the frames.
+*/
+void vpAsyncGrabber::open(vpImage<vpRGBa> &I)
+{
+  close();
+  m_grabber.open(I);
+  width = m_grabber.getWidth();
+  height = m_grabber.getHeight();
+
+  delete m_capture;
+  m_capture = new Capture(m_grabber, m_mode, m_nbBuffers);
+  m_capture->start(I);
+  init = true;
+}
+
+/*!
+  Return a grey level frame captured by the capture thread. The grabber is opened
+  if needed.
+
+  \param I : Captured frame. Its buffer is exchanged with the one of the frame, no
+  pixel is copied.
+
+  \exception vpFrameGrabberException::settingError : The grabber was opened with
+  color images.
+
+  \exception vpFrameGrabberException, vpException : The exception thrown by the
+  wrapped grabber in the capture thread, once all the captured frames are consumed.
+*/
+void vpAsyncGrabber::acquire(vpImage<unsigned char> &I)
+{
+  if (!init) {
+    open(I);
+  }
+  m_capture->acquire(I);
+}
+
+/*!
+  Return a color frame captured by the capture thread. The grabber is opened if needed.
+
+  \param I : Captured frame. Its buffer is exchanged with the one of the frame, no
+  pixel is copied.
+
+  \exception vpFrameGrabberException::settingError : The grabber was opened with
+  grey level images.
+
+  \exception vpFrameGrabberException, vpException : The exception thrown by the
+  wrapped grabber in the capture thread, once all the captured frames are consumed.
+*/
+void vpAsyncGrabber::acquire(vpImage<vpRGBa> &I)
+{
+  if (!init) {
+    open(I);
+  }
+  m_capture->acquire(I);
+}
+
+/*!
+  Stop the capture thread and close the wrapped grabber. The statistics of the last
+  capture stay available until the next open().
+*/
+void vpAsyncGrabber::close()
+{
+  if (init) {
+    m_capture->stop();
+    m_grabber.close();
+    init = false;
+  }
+}
+
+/*!
+  Return the number of frames acquired by the capture thread since open().
+*/
+unsigned int vpAsyncGrabber::getCapturedCount() const
+{
+  return m_capture ? m_capture->getCapturedCount() : 0;
+}
+
+/*!
+  Return the number of frames returned by acquire() since open().
+*/
+unsigned int vpAsyncGrabber::getConsumedCount() const
+{
+  return m_capture ? m_capture->getConsumedCount() : 0;
+}
+
+/*!
+  Return the number of captured frames that will never be returned by acquire():
+  frames overwritten by a newer one in vpAsyncGrabber::LATEST_FRAME mode, or
+  captured while the ring was full in vpAsyncGrabber::EVERY_FRAME mode.
+*/
+unsigned int vpAsyncGrabber::getDroppedCount() const
+{
+  return m_capture ? m_capture->getDroppedCount() : 0;
+}
+
+/*!
+  Return the time in ms between the end of the capture of the last frame returned by
+  acquire() and its consumption.
+*/
+double vpAsyncGrabber::getLatency() const
+{
+  return m_capture ? m_capture->getLatency() : 0.;
+}
+
+/*!
+  Return the mean of getLatency() over the frames returned by acquire() since open().
+*/
+double vpAsyncGrabber::getMeanLatency() const
+{
+  return m_capture ? m_capture->getMeanLatency() : 0.;
+}
+
+/*!
+  Return the time in ms, as given by vpTime::measureTimeMs(), at which the capture of
+  the last frame returned by acquire() ended.
+*/
+double vpAsyncGrabber::getTimestamp() const
+{
+  return m_capture ? m_capture->getTimestamp() : 0.;
+}
+
+#elif !defined(VISP_BUILD_SHARED_LIBS)
+// Work arround to avoid warning: libvisp_sensor.a(vpAsyncGrabber.cpp.o) has no symbols
+void dummy_vpAsyncGrabber() {};
+#endif
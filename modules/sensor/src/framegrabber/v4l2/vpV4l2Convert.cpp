@@ -0,0 +1,213 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Conversion of raw Video For Linux 2 buffers.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpV4l2Convert.cpp
+  \brief Conversion of the raw buffers filled by a Video For Linux 2 driver.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpImageConvert.h>
+#include <visp3/sensor/vpV4l2Convert.h>
+
+/*!
+  Return the number of bytes used to code a pixel in a raw buffer, or 0 if
+  the pixel format is not handled.
+*/
+unsigned int vpV4l2Convert::bytesPerPixel(vpV4l2PixelFormatType pixelformat)
+{
+  switch(pixelformat) {
+  case V4L2_GREY_FORMAT:  return 1;
+  case V4L2_RGB24_FORMAT: return 3;
+  case V4L2_RGB32_FORMAT: return 4;
+  case V4L2_BGR24_FORMAT: return 3;
+  case V4L2_YUYV_FORMAT:  return 2;
+  default: return 0;
+  }
+}
+
+/*!
+  Compute the bounds of a region of interest clamped to a frame.
+
+  \param width, height : Size of the frame.
+  \param roi : Region of interest. An empty rectangle stands for the whole frame.
+  \param i_min, j_min : Top left pixel of the region.
+  \param r_height, r_width : Size of the region, 0 if it lies outside the frame.
+*/
+void vpV4l2Convert::roiBounds(unsigned int width, unsigned int height, const vpRect &roi,
+                              unsigned int &i_min, unsigned int &j_min, unsigned int &r_height, unsigned int &r_width)
+{
+  if (roi == vpRect()) {
+    i_min = j_min = 0;
+    r_height = height;
+    r_width = width;
+    return;
+  }
+  int top    = (std::max)((int)(ceil(roi.getTop())), 0);
+  int left   = (std::max)((int)(ceil(roi.getLeft())), 0);
+  int bottom = (std::min)((int)(ceil(roi.getTop() + roi.getHeight())), (int)height);
+  int right  = (std::min)((int)(ceil(roi.getLeft() + roi.getWidth())), (int)width);
+  i_min = (unsigned int)top;
+  j_min = (unsigned int)left;
+  r_height = (bottom > top) ? (unsigned int)(bottom - top) : 0;
+  r_width  = (right > left) ? (unsigned int)(right - left) : 0;
+}
+
+/*!
+  Convert the region of interest of a raw buffer into a grey level image.
+
+  \param bitmap : Raw buffer.
+  \param width, height : Size of the frame coded in \e bitmap.
+  \param pixelformat : Pixel coding of \e bitmap.
+  \param I : Converted image, resized to the size of the region of interest.
+  \param roi : Region of interest to convert. By default convert the whole frame.
+*/
+void vpV4l2Convert::convert(const unsigned char *bitmap, unsigned int width, unsigned int height,
+                            vpV4l2PixelFormatType pixelformat, vpImage<unsigned char> &I, const vpRect &roi)
+{
+  unsigned int i_min, j_min, r_height, r_width;
+  roiBounds(width, height, roi, i_min, j_min, r_height, r_width);
+  I.resize(r_height, r_width);
+  if (r_height == 0 || r_width == 0)
+    return;
+
+  unsigned int bpp = bytesPerPixel(pixelformat);
+  bool contiguous = (r_width == width);
+  unsigned int nrows = contiguous ? 1 : r_height;
+  unsigned int npixels = contiguous ? r_width * r_height : r_width;
+
+  for (unsigned int i = 0; i < nrows; i++) {
+    unsigned char *src = const_cast<unsigned char *>(bitmap) + ((i_min + i) * width + j_min) * bpp;
+    unsigned char *dst = I.bitmap + i * r_width;
+    switch(pixelformat) {
+    case V4L2_GREY_FORMAT:
+      memcpy(dst, src, npixels);
+      break;
+    case V4L2_RGB24_FORMAT:
+      vpImageConvert::RGBToGrey(src, dst, npixels);
+      break;
+    case V4L2_RGB32_FORMAT:
+      vpImageConvert::RGBaToGrey(src, dst, npixels);
+      break;
+    case V4L2_BGR24_FORMAT:
+      vpImageConvert::BGRToGrey(src, dst, npixels, 1, false);
+      break;
+    case V4L2_YUYV_FORMAT:
+      if (npixels % 2 == 0)
+        vpImageConvert::YUYVToGrey(src, dst, npixels);
+      else {
+        for (unsigned int j = 0; j < npixels; j++)
+          dst[j] = src[2*j];
+      }
+      break;
+    default:
+      std::cout << "V4L2 conversion not handled" << std::endl;
+      return;
+    }
+  }
+}
+
+/*!
+  Convert the region of interest of a raw buffer into a color image.
+
+  \param bitmap : Raw buffer.
+  \param width, height : Size of the frame coded in \e bitmap.
+  \param pixelformat : Pixel coding of \e bitmap.
+  \param I : Converted image, resized to the size of the region of interest.
+  \param roi : Region of interest to convert. By default convert the whole frame.
+*/
+void vpV4l2Convert::convert(const unsigned char *bitmap, unsigned int width, unsigned int height,
+                            vpV4l2PixelFormatType pixelformat, vpImage<vpRGBa> &I, const vpRect &roi)
+{
+  unsigned int i_min, j_min, r_height, r_width;
+  roiBounds(width, height, roi, i_min, j_min, r_height, r_width);
+  I.resize(r_height, r_width);
+  if (r_height == 0 || r_width == 0)
+    return;
+
+  unsigned int bpp = bytesPerPixel(pixelformat);
+  bool contiguous = (r_width == width);
+  unsigned int nrows = contiguous ? 1 : r_height;
+  unsigned int npixels = contiguous ? r_width * r_height : r_width;
+
+  // YUYV codes the pixels by pairs: a row that starts or ends in the middle
+  // of a pair is converted into a temporary row
+  unsigned int j_pair = j_min - (j_min % 2);
+  unsigned int npairs = (r_width + (j_min - j_pair) + 1) / 2;
+  std::vector<vpRGBa> row;
+  if (pixelformat == V4L2_YUYV_FORMAT && ! contiguous && (j_pair != j_min || r_width % 2))
+    row.resize(2 * npairs);
+
+  for (unsigned int i = 0; i < nrows; i++) {
+    unsigned char *src = const_cast<unsigned char *>(bitmap) + ((i_min + i) * width + j_min) * bpp;
+    unsigned char *dst = (unsigned char *) (I.bitmap + i * r_width);
+    switch(pixelformat) {
+    case V4L2_GREY_FORMAT:
+      vpImageConvert::GreyToRGBa(src, dst, npixels);
+      break;
+    case V4L2_RGB24_FORMAT:
+      vpImageConvert::RGBToRGBa(src, dst, npixels);
+      break;
+    case V4L2_RGB32_FORMAT:
+      // The framegrabber acquire aRGB format. We just shift the data
+      // from 1 byte all the data and initialize the last byte
+      memcpy(dst, src + 1, npixels * sizeof(vpRGBa) - 1);
+      ((vpRGBa *) dst)[npixels-1].A = 0;
+      break;
+    case V4L2_BGR24_FORMAT:
+      vpImageConvert::BGRToRGBa(src, dst, npixels, 1, false);
+      break;
+    case V4L2_YUYV_FORMAT:
+      if (contiguous)
+        vpImageConvert::YUYVToRGBa(src, dst, width, r_height);
+      else if (row.empty())
+        vpImageConvert::YUYVToRGBa(src, dst, npixels, 1);
+      else {
+        src = const_cast<unsigned char *>(bitmap) + ((i_min + i) * width + j_pair) * bpp;
+        vpImageConvert::YUYVToRGBa(src, (unsigned char *) &row[0], 2 * npairs, 1);
+        memcpy(dst, &row[j_min - j_pair], npixels * sizeof(vpRGBa));
+      }
+      break;
+    default:
+      std::cout << "V4L2 conversion not handled" << std::endl;
+      return;
+    }
+  }
+}
@@ -58,12 +58,14 @@
 #include <sys/mman.h>
 #include <errno.h>
 #include <iostream>
+#include <vector>
 
 #include <visp3/sensor/vpV4l2Grabber.h>
 #include <visp3/core/vpFrameGrabberException.h>
 //#include <visp3/io/vpImageIo.h>
 #include <visp3/core/vpImageConvert.h>
 #include <visp3/core/vpImageTools.h>
+#include <visp3/sensor/vpV4l2Convert.h>
 
 const unsigned int vpV4l2Grabber::DEFAULT_INPUT = 2;
 const unsigned int vpV4l2Grabber::DEFAULT_SCALE = 2;
@@ -154,7 +156,8 @@ vpV4l2Grabber::vpV4l2Grabber()
     m_input(vpV4l2Grabber::DEFAULT_INPUT),
     m_framerate(vpV4l2Grabber::framerate_25fps),
     m_frameformat(vpV4l2Grabber::V4L2_FRAME_FORMAT),
-    m_pixelformat(vpV4l2Grabber::V4L2_YUYV_FORMAT)
+    m_pixelformat(vpV4l2Grabber::V4L2_YUYV_FORMAT),
+    m_bufferpolicy(vpV4l2Grabber::V4L2_BLOCK_POLICY)
 {
   setDevice("/dev/video0");
   setNBuffers(3);
@@ -213,7 +216,8 @@ vpV4l2Grabber::vpV4l2Grabber(bool verbose)
     m_input(vpV4l2Grabber::DEFAULT_INPUT),
     m_framerate(vpV4l2Grabber::framerate_25fps),
     m_frameformat(vpV4l2Grabber::V4L2_FRAME_FORMAT),
-    m_pixelformat(vpV4l2Grabber::V4L2_YUYV_FORMAT)
+    m_pixelformat(vpV4l2Grabber::V4L2_YUYV_FORMAT),
+    m_bufferpolicy(vpV4l2Grabber::V4L2_BLOCK_POLICY)
 {
   setDevice("/dev/video0");
   setNBuffers(3);
@@ -263,7 +267,8 @@ vpV4l2Grabber::vpV4l2Grabber(unsigned input, unsigned scale)
     m_input(vpV4l2Grabber::DEFAULT_INPUT),
     m_framerate(vpV4l2Grabber::framerate_25fps),
     m_frameformat(vpV4l2Grabber::V4L2_FRAME_FORMAT),
-    m_pixelformat(vpV4l2Grabber::V4L2_YUYV_FORMAT)
+    m_pixelformat(vpV4l2Grabber::V4L2_YUYV_FORMAT),
+    m_bufferpolicy(vpV4l2Grabber::V4L2_BLOCK_POLICY)
 {
   setDevice("/dev/video0");
   setNBuffers(3);
@@ -312,7 +317,8 @@ vpV4l2Grabber::vpV4l2Grabber(vpImage<unsigned char> &I, unsigned input, unsigned
     m_input(vpV4l2Grabber::DEFAULT_INPUT),
     m_framerate(vpV4l2Grabber::framerate_25fps),
     m_frameformat(vpV4l2Grabber::V4L2_FRAME_FORMAT),
-    m_pixelformat(vpV4l2Grabber::V4L2_YUYV_FORMAT)
+    m_pixelformat(vpV4l2Grabber::V4L2_YUYV_FORMAT),
+    m_bufferpolicy(vpV4l2Grabber::V4L2_BLOCK_POLICY)
 {
   setDevice("/dev/video0");
   setNBuffers(3);
@@ -364,7 +370,8 @@ vpV4l2Grabber::vpV4l2Grabber(vpImage<vpRGBa> &I, unsigned input, unsigned scale
     m_input(vpV4l2Grabber::DEFAULT_INPUT),
     m_framerate(vpV4l2Grabber::framerate_25fps),
     m_frameformat(vpV4l2Grabber::V4L2_FRAME_FORMAT),
-    m_pixelformat(vpV4l2Grabber::V4L2_YUYV_FORMAT)
+    m_pixelformat(vpV4l2Grabber::V4L2_YUYV_FORMAT),
+    m_bufferpolicy(vpV4l2Grabber::V4L2_BLOCK_POLICY)
 {
   setDevice("/dev/video0");
   setNBuffers(3);
@@ -629,60 +636,9 @@ vpV4l2Grabber::acquire(vpImage<unsigned char> &I, struct timeval &timestamp, con
   unsigned char *bitmap ;
   bitmap = waiton(index_buffer, timestamp);
 
-  if (roi == vpRect())
-    I.resize(height, width);
-  else
-    I.resize((unsigned int)roi.getHeight(), (unsigned int)roi.getWidth());
-  switch(m_pixelformat) {
-  case V4L2_GREY_FORMAT:
-    if (roi == vpRect())
-      memcpy(I.bitmap, bitmap, height * width*sizeof(unsigned char));
-    else
-      vpImageTools::crop(bitmap, width, height, roi, I);
-    break;
-  case V4L2_RGB24_FORMAT: // tested
-    if (roi == vpRect())
-      vpImageConvert::RGBToGrey((unsigned char *) bitmap, I.bitmap, width*height);
-    else {
-      vpImage<unsigned char> tmp(height, width);
-      vpImageConvert::RGBToGrey((unsigned char *) bitmap, tmp.bitmap, width*height);
-      vpImageTools::crop(tmp, roi, I);
-    }
-    break;
-  case V4L2_RGB32_FORMAT:
-    if (roi == vpRect())
-      vpImageConvert::RGBaToGrey((unsigned char *) bitmap, I.bitmap, width*height);
-    else {
-      vpImage<unsigned char> tmp(height, width);
-      vpImageConvert::RGBaToGrey((unsigned char *) bitmap, tmp.bitmap, width*height);
-      vpImageTools::crop(tmp, roi, I);
-    }
+  vpV4l2Convert::convert(bitmap, width, height, (vpV4l2Convert::vpV4l2PixelFormatType) m_pixelformat, I, roi);
 
-    break;
-  case V4L2_BGR24_FORMAT: // tested
-    if (roi == vpRect())
-      vpImageConvert::BGRToGrey( (unsigned char *) bitmap, I.bitmap, width, height, false);
-    else {
-      vpImage<unsigned char> tmp(height, width);
-      vpImageConvert::BGRToGrey( (unsigned char *) bitmap, tmp.bitmap, width, height, false);
-      vpImageTools::crop(tmp, roi, I);
-    }
-    break;
-  case V4L2_YUYV_FORMAT: // tested
-    if (roi == vpRect())
-      vpImageConvert::YUYVToGrey( (unsigned char *) bitmap, I.bitmap, width*height);
-    else {
-      vpImage<unsigned char> tmp(height, width);
-      vpImageConvert::YUYVToGrey( (unsigned char *) bitmap, tmp.bitmap, width*height);
-      vpImageTools::crop(tmp, roi, I);
-    }
-    break;
-  default:
-    std::cout << "V4L2 conversion not handled" << std::endl;
-    break;
-  }
-
-  queueAll();
+  queueBuffer(index_buffer);
 }
 
 /*!
@@ -756,71 +712,155 @@ vpV4l2Grabber::acquire(vpImage<vpRGBa> &I, struct timeval &timestamp, const vpRe
                                    "V4l2 frame grabber not initialized") );
   }
 
-  unsigned  char *bitmap ;
+  unsigned char *bitmap ;
   bitmap = waiton(index_buffer, timestamp);
 
-  if (roi == vpRect())
-    I.resize(height, width);
-  else
-    I.resize((unsigned int)roi.getHeight(), (unsigned int)roi.getWidth());
+  vpV4l2Convert::convert(bitmap, width, height, (vpV4l2Convert::vpV4l2PixelFormatType) m_pixelformat, I, roi);
 
-  // The framegrabber acquire aRGB format. We just shift the data from 1 byte all the data and initialize the last byte
+  queueBuffer(index_buffer);
+}
 
-  switch(m_pixelformat) {
-  case V4L2_GREY_FORMAT:
-    if (roi == vpRect())
-      vpImageConvert::GreyToRGBa((unsigned char *) bitmap, (unsigned char *) I.bitmap, width*height);
-    else
-      vpImageTools::crop(bitmap, width, height, roi, I);
-    break;
-  case V4L2_RGB24_FORMAT: // tested
-    if (roi == vpRect())
-      vpImageConvert::RGBToRGBa((unsigned char *) bitmap, (unsigned char *) I.bitmap, width*height);
-    else {
-      vpImage<vpRGBa> tmp(height, width);
-      vpImageConvert::RGBToRGBa((unsigned char *) bitmap, (unsigned char *) tmp.bitmap, width*height);
-      vpImageTools::crop(tmp, roi, I);
-    }
-    break;
-  case V4L2_RGB32_FORMAT:
-    if (roi == vpRect()) {
-      // The framegrabber acquire aRGB format. We just shift the data
-      // from 1 byte all the data and initialize the last byte
-      memcpy(I.bitmap, bitmap + 1, height * width * sizeof(vpRGBa) - 1);
-      I[height-1][width-1].A = 0;
-    }
-    else {
-      for(unsigned int i=0; i<I.getHeight(); i++) {
-        memcpy(I.bitmap, bitmap + 1 + (unsigned int)(roi.getTop()*width + roi.getLeft()), I.getWidth() * sizeof(vpRGBa) - 1);
-        I[i][I.getWidth()-1].A = 0;
-      }
-    }
-    break;
-  case V4L2_BGR24_FORMAT: // tested
-    if (roi == vpRect())
-      vpImageConvert::BGRToRGBa((unsigned char *) bitmap, (unsigned char *) I.bitmap, width, height, false);
-    else {
-      vpImage<vpRGBa> tmp(height, width);
-      vpImageConvert::BGRToRGBa((unsigned char *) bitmap, (unsigned char *) tmp.bitmap, width, height, false);
-      vpImageTools::crop(tmp, roi, I);
-    }
-    break;
-  case V4L2_YUYV_FORMAT: // tested
-    if (roi == vpRect())
-      vpImageConvert::YUYVToRGBa( (unsigned char *) bitmap, (unsigned char *) I.bitmap, width, height);
-    else {
-      vpImage<vpRGBa> tmp(height, width);
-      vpImageConvert::YUYVToRGBa((unsigned char *) bitmap, (unsigned char *) tmp.bitmap, width, height);
-      vpImageTools::crop(tmp, roi, I);
+/*!
+  Dequeue a frame from the driver without any copy nor conversion.
+
+  The returned frame gives a read-only access to the memory mapped driver
+  buffer, with the timestamp and the sequence number of the frame. The buffer
+  is removed from the ring until it is given back with releaseFrame(); in the
+  meantime the grabber uses the remaining buffers. The frame can be converted
+  into a caller-owned image with convert() or wrapped without copy with
+  getView().
+
+  When several frames are waiting, the returned one depends on the buffer
+  policy set with setBufferPolicy().
+
+  \param frame : Dequeued frame.
+
+  \exception vpFrameGrabberException::initializationError : Frame grabber not
+  initialized. The grabber has to be opened with open() before.
+
+  \exception vpFrameGrabberException::otherError : All the buffers are held by
+  the caller, or the frame can't be dequeued.
+
+  \sa releaseFrame(), convert(), getView(), setNBuffers(), setBufferPolicy()
+*/
+void
+vpV4l2Grabber::acquireFrame(vpV4l2Frame &frame)
+{
+  if (init==false || streaming==false)
+  {
+    throw (vpFrameGrabberException(vpFrameGrabberException::initializationError,
+                                   "V4l2 frame grabber not initialized") );
+  }
+
+  if (queue == waiton_cpt) {
+    throw (vpFrameGrabberException(vpFrameGrabberException::otherError,
+                                   "All the %u v4l2 buffers are held, call releaseFrame() first",
+                                   reqbufs.count) );
+  }
+
+  struct timeval timestamp;
+  __u32 index;
+  waiton(index, timestamp);
+
+  if (m_bufferpolicy == V4L2_DROP_OLDEST_POLICY) {
+    // Keep the newest frame, the older ones go back to the driver
+    __u32 newer;
+    while ((queue - waiton_cpt > 0) && dequeueBuffer(newer)) {
+      queueBuffer(index);
+      index = newer;
     }
-    break;
-  default:
-    std::cout << "V4l2 conversion not handled" << std::endl;
-    break;
   }
 
-  queueAll();
+  index_buffer = index;
+
+  frame.data = buf_me[index].data;
+  frame.width = width;
+  frame.height = height;
+  frame.pixelformat = m_pixelformat;
+  frame.timestamp = buf_v4l2[index].timestamp;
+  frame.sequence = buf_v4l2[index].sequence;
+  frame.field = buf_v4l2[index].field;
+  frame.index = index;
+}
+
+/*!
+  Give back to the driver a frame dequeued with acquireFrame(). The frame
+  data must not be accessed anymore after this call.
+
+  \param frame : Frame to release.
+
+  \exception vpFrameGrabberException::otherError : The frame is not held by
+  the caller.
+
+  \sa acquireFrame()
+*/
+void
+vpV4l2Grabber::releaseFrame(const vpV4l2Frame &frame)
+{
+  if (streaming == false || frame.index >= reqbufs.count || buf_me[frame.index].refcount == 0) {
+    throw (vpFrameGrabberException(vpFrameGrabberException::otherError,
+                                   "The v4l2 frame %u is not held", frame.index) );
+  }
+  queueBuffer(frame.index);
 }
+
+/*!
+  Convert a frame dequeued with acquireFrame() into a grey level image.
+  Only the region of interest is converted.
+
+  \param frame : Frame to convert.
+  \param I : Converted image. It is resized if needed.
+  \param roi : Region of interest to convert. By default convert the whole frame.
+
+  \sa acquireFrame()
+*/
+void
+vpV4l2Grabber::convert(const vpV4l2Frame &frame, vpImage<unsigned char> &I, const vpRect &roi)
+{
+  vpV4l2Convert::convert(frame.data, frame.width, frame.height,
+                         (vpV4l2Convert::vpV4l2PixelFormatType) frame.pixelformat, I, roi);
+}
+
+/*!
+  Convert a frame dequeued with acquireFrame() into a color image.
+  Only the region of interest is converted.
+
+  \param frame : Frame to convert.
+  \param I : Converted image. It is resized if needed.
+  \param roi : Region of interest to convert. By default convert the whole frame.
+
+  \sa acquireFrame()
+*/
+void
+vpV4l2Grabber::convert(const vpV4l2Frame &frame, vpImage<vpRGBa> &I, const vpRect &roi)
+{
+  vpV4l2Convert::convert(frame.data, frame.width, frame.height,
+                         (vpV4l2Convert::vpV4l2PixelFormatType) frame.pixelformat, I, roi);
+}
+
+/*!
+  Wrap a grey level frame dequeued with acquireFrame() into an image without
+  copying the pixels. The image points to the driver buffer: it must only be
+  read, and must not be used after releaseFrame().
+
+  \param frame : Frame acquired with the vpV4l2Grabber::V4L2_GREY_FORMAT pixel format.
+  \param I : Image that shares the frame data.
+
+  \exception vpFrameGrabberException::otherError : The frame is not a grey
+  level frame. Use convert() instead.
+
+  \sa acquireFrame(), convert()
+*/
+void
+vpV4l2Grabber::getView(const vpV4l2Frame &frame, vpImage<unsigned char> &I)
+{
+  if (frame.pixelformat != V4L2_GREY_FORMAT || frame.data == NULL) {
+    throw (vpFrameGrabberException(vpFrameGrabberException::otherError,
+                                   "Only grey level v4l2 frames can be viewed without conversion") );
+  }
+  I.initView(const_cast<unsigned char *>(frame.data), frame.height, frame.width);
+}
+
 /*!
 
   Return the field (odd or even) corresponding to the last acquired
@@ -1331,7 +1371,6 @@ vpV4l2Grabber::stopStreaming()
 unsigned char *
 vpV4l2Grabber::waiton(__u32 &index, struct timeval &timestamp)
 {
-  struct v4l2_buffer buf;
   struct timeval tv;
   fd_set rdset;
 
@@ -1359,17 +1398,42 @@ again:
 
 
   /* get it */
+  if (! dequeueBuffer(index)) {
+    index = 0;
+    throw (vpFrameGrabberException(vpFrameGrabberException::otherError,
+                                   "VIDIOC_DQBUF: EAGAIN") );
+    return NULL;
+  }
+
+  timestamp = buf_v4l2[index].timestamp;
+
+  return buf_me[index].data;
+}
+
+/*!
+  Dequeue a filled buffer without waiting.
+
+  \param index : Index of the dequeued buffer.
+
+  \return true if a buffer was dequeued, false if no filled buffer is
+  available yet.
+
+  \exception vpFrameGrabberException::otherError : If can't access to the
+  frame.
+*/
+bool
+vpV4l2Grabber::dequeueBuffer(__u32 &index)
+{
+  struct v4l2_buffer buf;
+
   memset(&buf, 0, sizeof(buf));
   buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
   buf.memory = V4L2_MEMORY_MMAP; // Fabien manquait
   if (-1 == v4l2_ioctl(fd,VIDIOC_DQBUF, &buf)) {
-    index = 0;
     switch(errno)
     {
     case EAGAIN:
-      throw (vpFrameGrabberException(vpFrameGrabberException::otherError,
-                                     "VIDIOC_DQBUF: EAGAIN") );
-      break;
+      return false;
     case EINVAL:
       throw (vpFrameGrabberException(vpFrameGrabberException::otherError,
                                      "VIDIOC_DQBUF: EINVAL") );
@@ -1383,25 +1447,17 @@ again:
                                      "VIDIOC_DQBUF") );
       break;
     }
-    return NULL;
   }
 
   waiton_cpt++;
   buf_v4l2[buf.index] = buf;
+  buf_me[buf.index].refcount = 1;
 
   index = buf.index;
 
   field = buf_v4l2[index].field;
 
-  timestamp = buf_v4l2[index].timestamp;
-
-  // if(m_verbose)
-  // {
-  //   vpERROR_TRACE("field: %d\n", buf_v4l2[index].field);
-
-  //   vpERROR_TRACE("data adress : 0x%p\n", buf_me[buf.index].data);
-  // }
-  return buf_me[buf.index].data;
+  return true;
 }
 
 /*!
@@ -1453,6 +1509,39 @@ vpV4l2Grabber::queueBuffer()
   return rc;
 }
 
+/*!
+
+  Give back to the driver the buffer \e index previously dequeued.
+
+*/
+void
+vpV4l2Grabber::queueBuffer(__u32 index)
+{
+  if (-1 == v4l2_ioctl(fd, VIDIOC_QBUF, &buf_v4l2[index])) {
+    switch(errno)
+    {
+    case EAGAIN:
+      throw (vpFrameGrabberException(vpFrameGrabberException::otherError,
+                                     "VIDIOC_QBUF: EAGAIN") );
+      break;
+    case EINVAL:
+      throw (vpFrameGrabberException(vpFrameGrabberException::otherError,
+                                     "VIDIOC_QBUF: EINVAL") );
+      break;
+    case ENOMEM:
+      throw (vpFrameGrabberException(vpFrameGrabberException::otherError,
+                                     "VIDIOC_QBUF: ENOMEM") );
+      break;
+    default:
+      throw (vpFrameGrabberException(vpFrameGrabberException::otherError,
+                                     "VIDIOC_QBUF") );
+      break;
+    }
+  }
+  buf_me[index].refcount = 0;
+  queue++;
+}
+
 /*!
 
   Call the queue buffer private method if needed
@@ -0,0 +1,349 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test asynchronous acquisition with a synthetic frame grabber.
+ *
+ *****************************************************************************/
+
+/*!
+  \file testAsyncGrabber.cpp
+
+  \brief Test vpAsyncGrabber with a synthetic frame grabber.
+*/
+
+#include <visp3/core/vpConfig.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+#if defined(VISP_HAVE_PTHREAD)
+
+#include <visp3/core/vpFrameGrabberException.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/sensor/vpAsyncGrabber.h>
+
+/*!
+  \example testAsyncGrabber.cpp
+
+  \brief Run a synthetic frame grabber in the capture thread of vpAsyncGrabber and
+  check the frames received in vpAsyncGrabber::EVERY_FRAME and vpAsyncGrabber::LATEST_FRAME
+  modes, the drop counters and the propagation of the grabber errors.
+*/
+
+namespace {
+  /*!
+    Frame grabber that produces a given number of frames at a given rate. The frame
+    number is coded in the first pixels.
+  */
+  class vpSyntheticGrabber : public vpFrameGrabber
+  {
+  public:
+    vpSyntheticGrabber(unsigned int nbFrames, double period)
+      : m_nbFrames(nbFrames), m_period(period), m_count(0)
+    {
+      height = 48;
+      width = 64;
+    }
+
+    void open(vpImage<unsigned char> &I) { I.resize(height, width); m_count = 0; init = true; }
+    void open(vpImage<vpRGBa> &I) { I.resize(height, width); m_count = 0; init = true; }
+
+    void acquire(vpImage<unsigned char> &I)
+    {
+      next();
+      I.resize(height, width);
+      for (unsigned int k = 0; k < 4; k++) {
+        I.bitmap[k] = (unsigned char)((m_count >> (8 * k)) & 0xff);
+      }
+      m_count++;
+    }
+
+    void acquire(vpImage<vpRGBa> &I)
+    {
+      next();
+      I.resize(height, width);
+      I.bitmap[0] = vpRGBa((unsigned char)(m_count & 0xff), (unsigned char)((m_count >> 8) & 0xff),
+                           (unsigned char)((m_count >> 16) & 0xff), (unsigned char)((m_count >> 24) & 0xff));
+      m_count++;
+    }
+
+    void close() { init = false; }
+
+    static unsigned int frameNumber(const vpImage<unsigned char> &I)
+    {
+      return I.bitmap[0] | (I.bitmap[1] << 8) | (I.bitmap[2] << 16) | ((unsigned int)I.bitmap[3] << 24);
+    }
+
+    static unsigned int frameNumber(const vpImage<vpRGBa> &I)
+    {
+      return I.bitmap[0].R | (I.bitmap[0].G << 8) | (I.bitmap[0].B << 16) | ((unsigned int)I.bitmap[0].A << 24);
+    }
+
+  private:
+    void next()
+    {
+      vpTime::wait(m_period);
+      if (m_count >= m_nbFrames) {
+        throw(vpFrameGrabberException(vpFrameGrabberException::otherError, "End of the synthetic sequence"));
+      }
+    }
+
+    unsigned int m_nbFrames;
+    double m_period;
+    unsigned int m_count;
+  };
+
+  /*!
+    Frame grabber whose acquisition throws an exception that is not a vpException.
+  */
+  class vpFailingGrabber : public vpFrameGrabber
+  {
+  public:
+    vpFailingGrabber()
+    {
+      height = 48;
+      width = 64;
+    }
+
+    void open(vpImage<unsigned char> &I) { I.resize(height, width); init = true; }
+    void open(vpImage<vpRGBa> &I) { I.resize(height, width); init = true; }
+    void acquire(vpImage<unsigned char> &) { throw(std::runtime_error("Device lost")); }
+    void acquire(vpImage<vpRGBa> &) { throw(std::runtime_error("Device lost")); }
+    void close() { init = false; }
+  };
+
+  // Consume all the frames until the end of the sequence is reported
+  template<class Type>
+  bool consume(vpAsyncGrabber &g, vpImage<Type> &I, double processing, bool everyFrame, unsigned int nbFrames)
+  {
+    unsigned int nbReceived = 0;
+    unsigned int last = 0;
+    bool end = false;
+    while (!end) {
+      try {
+        g.acquire(I);
+      }
+      catch(vpFrameGrabberException &e) {
+        if (e.getCode() != vpFrameGrabberException::otherError) {
+          std::cerr << "Unexpected error: " << e.getMessage() << std::endl;
+          return false;
+        }
+        end = true;
+        continue;
+      }
+
+      unsigned int number = vpSyntheticGrabber::frameNumber(I);
+      if (I.getHeight() != 48 || I.getWidth() != 64) {
+        std::cerr << "Wrong frame size" << std::endl;
+        return false;
+      }
+      if (nbReceived > 0 && number <= last) {
+        std::cerr << "Frame " << number << " received after frame " << last << std::endl;
+        return false;
+      }
+      if (everyFrame && number != nbReceived) {
+        std::cerr << "Frame " << number << " received instead of frame " << nbReceived << std::endl;
+        return false;
+      }
+      last = number;
+      nbReceived++;
+      if (processing > 0) {
+        vpTime::wait(processing);
+      }
+    }
+
+    std::cout << "  " << nbReceived << " frames received, last " << last << ", "
+              << g.getCapturedCount() << " captured, " << g.getDroppedCount() << " dropped, mean latency "
+              << g.getMeanLatency() << " ms" << std::endl;
+
+    if (last != nbFrames - 1) {
+      std::cerr << "The last frame was not received" << std::endl;
+      return false;
+    }
+    if (g.getCapturedCount() != nbFrames || g.getConsumedCount() != nbReceived) {
+      std::cerr << "Wrong frame counters" << std::endl;
+      return false;
+    }
+    if (g.getConsumedCount() + g.getDroppedCount() != g.getCapturedCount()) {
+      std::cerr << "Captured frames are neither consumed nor dropped" << std::endl;
+      return false;
+    }
+    if (g.getMeanLatency() < 0.) {
+      std::cerr << "Wrong latency" << std::endl;
+      return false;
+    }
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+    const unsigned int nbFrames = 60;
+
+    {
+      std::cout << "Every frame mode with a fast consumer" << std::endl;
+      vpSyntheticGrabber synthetic(nbFrames, 1.);
+      vpAsyncGrabber g(synthetic, vpAsyncGrabber::EVERY_FRAME, nbFrames);
+      vpImage<unsigned char> I;
+      g.open(I);
+      if (!consume(g, I, 0., true, nbFrames)) {
+        return EXIT_FAILURE;
+      }
+      if (g.getDroppedCount() != 0) {
+        std::cerr << "No frame should be dropped" << std::endl;
+        return EXIT_FAILURE;
+      }
+      g.close();
+    }
+
+    {
+      std::cout << "Every frame mode with a slow consumer and a small ring" << std::endl;
+      vpSyntheticGrabber synthetic(nbFrames, 1.);
+      vpAsyncGrabber g(synthetic, vpAsyncGrabber::EVERY_FRAME, 4);
+      vpImage<unsigned char> I;
+      g.open(I);
+      unsigned int nbReceived = 0;
+      unsigned int last = 0;
+      try {
+        for (;;) {
+          g.acquire(I);
+          unsigned int number = vpSyntheticGrabber::frameNumber(I);
+          if (nbReceived > 0 && number <= last) {
+            std::cerr << "Frame " << number << " received after frame " << last << std::endl;
+            return EXIT_FAILURE;
+          }
+          last = number;
+          nbReceived++;
+          vpTime::wait(5.);
+        }
+      }
+      catch(const vpFrameGrabberException &) {
+      }
+      std::cout << "  " << nbReceived << " frames received, " << g.getDroppedCount() << " dropped" << std::endl;
+      if (g.getDroppedCount() == 0 || nbReceived + g.getDroppedCount() != nbFrames) {
+        std::cerr << "Wrong drop counter" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    {
+      std::cout << "Latest frame mode with a slow consumer" << std::endl;
+      vpSyntheticGrabber synthetic(nbFrames, 1.);
+      vpAsyncGrabber g(synthetic, vpAsyncGrabber::LATEST_FRAME);
+      vpImage<unsigned char> I;
+      g.open(I);
+      if (!consume(g, I, 5., false, nbFrames)) {
+        return EXIT_FAILURE;
+      }
+      if (g.getDroppedCount() == 0) {
+        std::cerr << "Frames should be dropped" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    {
+      std::cout << "Latest frame mode with color images" << std::endl;
+      vpSyntheticGrabber synthetic(nbFrames, 1.);
+      vpAsyncGrabber g(synthetic, vpAsyncGrabber::LATEST_FRAME);
+      vpImage<vpRGBa> I;
+      g.open(I);
+      vpImage<unsigned char> I_grey;
+      try {
+        g.acquire(I_grey);
+        std::cerr << "A grey image can't be acquired after a color open()" << std::endl;
+        return EXIT_FAILURE;
+      }
+      catch(vpFrameGrabberException &e) {
+        if (e.getCode() != vpFrameGrabberException::settingError) {
+          throw;
+        }
+      }
+      if (!consume(g, I, 2., false, nbFrames)) {
+        return EXIT_FAILURE;
+      }
+    }
+
+    {
+      std::cout << "Stop the capture before the end of the sequence" << std::endl;
+      vpSyntheticGrabber synthetic(100000, 1.);
+      vpAsyncGrabber g(synthetic);
+      vpImage<unsigned char> I;
+      for (unsigned int i = 0; i < 10; i++) {
+        g.acquire(I);
+      }
+      g.close();
+      if (g.getConsumedCount() != 10 || g.getCapturedCount() < 10) {
+        std::cerr << "Wrong frame counters" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    {
+      std::cout << "Error that is not a vpException in the capture thread" << std::endl;
+      vpFailingGrabber failing;
+      vpAsyncGrabber g(failing);
+      vpImage<unsigned char> I;
+      g.open(I);
+      try {
+        g.acquire(I);
+        std::cerr << "The capture error was not reported" << std::endl;
+        return EXIT_FAILURE;
+      }
+      catch(vpFrameGrabberException &) {
+        std::cerr << "The capture error is not a grabber error" << std::endl;
+        return EXIT_FAILURE;
+      }
+      catch(vpException &e) {
+        if (e.getCode() != vpException::fatalError || e.getStringMessage() != "Device lost") {
+          std::cerr << "Wrong capture error: " << e.getMessage() << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    std::cout << "Test succeed" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cout << "Catch an exception: " << e.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
+
+#else
+int main()
+{
+  std::cout << "vpAsyncGrabber needs pthread" << std::endl;
+  return 0;
+}
+#endif
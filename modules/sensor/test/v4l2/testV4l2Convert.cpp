@@ -0,0 +1,199 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the conversion of raw Video For Linux 2 buffers.
+ *
+ *****************************************************************************/
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpImageConvert.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/sensor/vpV4l2Convert.h>
+
+/*!
+  \example testV4l2Convert.cpp
+
+  \brief Test vpV4l2Convert: a region of interest converted from a raw buffer
+  must be the crop of the whole converted frame, for all the pixel formats.
+*/
+
+namespace {
+  // Convert the whole frame at once with vpImageConvert
+  void fullConvert(const unsigned char *bitmap, unsigned int w, unsigned int h,
+                   vpV4l2Convert::vpV4l2PixelFormatType pixelformat, vpImage<unsigned char> &I)
+  {
+    I.resize(h, w);
+    unsigned char *src = const_cast<unsigned char *>(bitmap);
+    switch(pixelformat) {
+    case vpV4l2Convert::V4L2_GREY_FORMAT:
+      for (unsigned int i = 0; i < w * h; i++)
+        I.bitmap[i] = bitmap[i];
+      break;
+    case vpV4l2Convert::V4L2_RGB24_FORMAT: vpImageConvert::RGBToGrey(src, I.bitmap, w * h); break;
+    case vpV4l2Convert::V4L2_RGB32_FORMAT: vpImageConvert::RGBaToGrey(src, I.bitmap, w * h); break;
+    case vpV4l2Convert::V4L2_BGR24_FORMAT: vpImageConvert::BGRToGrey(src, I.bitmap, w, h, false); break;
+    case vpV4l2Convert::V4L2_YUYV_FORMAT: vpImageConvert::YUYVToGrey(src, I.bitmap, w * h); break;
+    default: break;
+    }
+  }
+
+  void fullConvert(const unsigned char *bitmap, unsigned int w, unsigned int h,
+                   vpV4l2Convert::vpV4l2PixelFormatType pixelformat, vpImage<vpRGBa> &I)
+  {
+    I.resize(h, w);
+    unsigned char *src = const_cast<unsigned char *>(bitmap);
+    unsigned char *dst = (unsigned char *) I.bitmap;
+    switch(pixelformat) {
+    case vpV4l2Convert::V4L2_GREY_FORMAT: vpImageConvert::GreyToRGBa(src, dst, w * h); break;
+    case vpV4l2Convert::V4L2_RGB24_FORMAT: vpImageConvert::RGBToRGBa(src, dst, w * h); break;
+    case vpV4l2Convert::V4L2_RGB32_FORMAT:
+      // aRGB: the color components follow the first byte
+      for (unsigned int i = 0; i < w * h; i++) {
+        I.bitmap[i].R = bitmap[4*i+1];
+        I.bitmap[i].G = bitmap[4*i+2];
+        I.bitmap[i].B = bitmap[4*i+3];
+      }
+      break;
+    case vpV4l2Convert::V4L2_BGR24_FORMAT: vpImageConvert::BGRToRGBa(src, dst, w, h, false); break;
+    case vpV4l2Convert::V4L2_YUYV_FORMAT: vpImageConvert::YUYVToRGBa(src, dst, w, h); break;
+    default: break;
+    }
+  }
+
+  // The SIMD and scalar paths of the vpImageConvert color to grey conversions
+  // round differently, and a row does not split into SIMD blocks like the frame
+  bool samePixel(unsigned char a, unsigned char b, vpV4l2Convert::vpV4l2PixelFormatType pixelformat)
+  {
+    if (pixelformat == vpV4l2Convert::V4L2_GREY_FORMAT || pixelformat == vpV4l2Convert::V4L2_YUYV_FORMAT)
+      return a == b;
+    return std::abs((int) a - (int) b) <= 2;
+  }
+
+  // The alpha value of RGB32 frames is not defined
+  bool samePixel(const vpRGBa &a, const vpRGBa &b, vpV4l2Convert::vpV4l2PixelFormatType pixelformat)
+  {
+    return a.R == b.R && a.G == b.G && a.B == b.B && (pixelformat == vpV4l2Convert::V4L2_RGB32_FORMAT || a.A == b.A);
+  }
+
+  template <class Type>
+  bool checkRoi(const std::vector<unsigned char> &bitmap, unsigned int w, unsigned int h,
+                vpV4l2Convert::vpV4l2PixelFormatType pixelformat, const vpRect &roi)
+  {
+    vpImage<Type> Ifull, Iroi;
+    fullConvert(&bitmap[0], w, h, pixelformat, Ifull);
+    vpV4l2Convert::convert(&bitmap[0], w, h, pixelformat, Iroi, roi);
+
+    unsigned int i_min, j_min, r_height, r_width;
+    vpV4l2Convert::roiBounds(w, h, roi, i_min, j_min, r_height, r_width);
+    if (Iroi.getHeight() != r_height || Iroi.getWidth() != r_width) {
+      std::cerr << "Format " << pixelformat << ", roi " << roi << ": wrong size " << Iroi.getHeight() << "x"
+                << Iroi.getWidth() << " instead of " << r_height << "x" << r_width << std::endl;
+      return false;
+    }
+    for (unsigned int i = 0; i < r_height; i++) {
+      for (unsigned int j = 0; j < r_width; j++) {
+        if (! samePixel(Iroi[i][j], Ifull[i_min + i][j_min + j], pixelformat)) {
+          std::cerr << "Format " << pixelformat << ", roi " << roi << ": pixel (" << i << ", " << j
+                    << ") differs from the full frame conversion" << std::endl;
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+    const unsigned int w = 64, h = 48;
+    vpUniRand rng(11);
+
+    // Region of interest bounds
+    unsigned int i_min, j_min, r_height, r_width;
+    vpV4l2Convert::roiBounds(w, h, vpRect(), i_min, j_min, r_height, r_width);
+    if (i_min != 0 || j_min != 0 || r_height != h || r_width != w) {
+      std::cerr << "An empty roi is not the whole frame" << std::endl;
+      return EXIT_FAILURE;
+    }
+    vpV4l2Convert::roiBounds(w, h, vpRect(-5, -3, 20, 10), i_min, j_min, r_height, r_width);
+    if (i_min != 0 || j_min != 0 || r_height != 7 || r_width != 15) {
+      std::cerr << "The roi is not clamped to the top left corner" << std::endl;
+      return EXIT_FAILURE;
+    }
+    vpV4l2Convert::roiBounds(w, h, vpRect(60, 40, 20, 20), i_min, j_min, r_height, r_width);
+    if (i_min != 40 || j_min != 60 || r_height != 8 || r_width != 4) {
+      std::cerr << "The roi is not clamped to the bottom right corner" << std::endl;
+      return EXIT_FAILURE;
+    }
+    vpV4l2Convert::roiBounds(w, h, vpRect(100, 10, 5, 5), i_min, j_min, r_height, r_width);
+    if (r_height * r_width != 0) {
+      std::cerr << "A roi outside the frame is not empty" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Full frame, even and odd columns and widths, clamped regions
+    std::vector<vpRect> rois;
+    rois.push_back(vpRect());
+    rois.push_back(vpRect(0, 5, w, 10));
+    rois.push_back(vpRect(10, 3, 20, 17));
+    rois.push_back(vpRect(11, 3, 20, 17));
+    rois.push_back(vpRect(10, 3, 21, 17));
+    rois.push_back(vpRect(11, 3, 21, 17));
+    rois.push_back(vpRect(7, 0, 1, h));
+    rois.push_back(vpRect(w - 5, h - 4, 10, 10));
+    rois.push_back(vpRect(-3, -2, 9, 9));
+
+    for (int format = 0; format < (int)vpV4l2Convert::V4L2_MAX_FORMAT; format++) {
+      vpV4l2Convert::vpV4l2PixelFormatType pixelformat = (vpV4l2Convert::vpV4l2PixelFormatType) format;
+      std::vector<unsigned char> bitmap(w * h * vpV4l2Convert::bytesPerPixel(pixelformat));
+      for (size_t i = 0; i < bitmap.size(); i++) {
+        bitmap[i] = (unsigned char) (rng() * 256);
+      }
+
+      for (size_t k = 0; k < rois.size(); k++) {
+        if (! checkRoi<unsigned char>(bitmap, w, h, pixelformat, rois[k]) ||
+            ! checkRoi<vpRGBa>(bitmap, w, h, pixelformat, rois[k])) {
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    std::cout << "vpV4l2Convert is ok" << std::endl;
+    return EXIT_SUCCESS;
+  } catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -58,10 +58,6 @@
 #include <list>
 #include <vector>
 
-#ifdef VISP_USE_MSVC
-#  pragma comment(linker, "/STACK:256000000") // Increase max recursion depth
-#endif
-
 /*!
   \class vpDot
 
@@ -244,9 +240,7 @@ public :
     This list is updated after a call to track().
 
   */
-  inline std::list<vpImagePoint> getConnexities() const {
-    return this->ip_connexities_list;
-  };
+  std::list<vpImagePoint> getConnexities() const;
 
   inline double getGamma() const {return this->gamma;};
   /*!
@@ -369,8 +363,13 @@ public :
   void track(const vpImage<unsigned char> & I, vpImagePoint &ip) ;
 
 private:
-  //! internal use only
-  std::list<vpImagePoint> ip_connexities_list;
+  //! Horizontal run of pixels of the dot, from column u_left to column u_right
+  typedef struct {
+    unsigned int v, u_left, u_right;
+  } vpDotSpan;
+
+  //! Runs of pixels of the dot, from which getConnexities() is built
+  std::vector<vpDotSpan> connexity_spans;
 
   //! List of border points
   std::list<vpImagePoint> ip_edges_list;
@@ -406,12 +405,16 @@ private:
   bool compute_moment ;
   double nbMaxPoint;
 
+  //! Pixels already reached by connexe(), reset on the touched runs only
+  vpImage<unsigned char> visited;
+  //! Seeds of the runs still to fill, as indexes in the image
+  std::vector<unsigned int> seeds;
+
   void init() ;
   void setGrayLevelOut();
   bool connexe(const vpImage<unsigned char>& I,unsigned int u,unsigned int v,
         double &mean_value, double &u_cog, double &v_cog, double &n);
-  bool connexe(const vpImage<unsigned char>& I,unsigned int u,unsigned int v,
-        double &mean_value, double &u_cog, double &v_cog, double &n,std::vector<bool> &checkTab);
+  void clearVisited();
   void COG(const vpImage<unsigned char> &I,double& u, double& v) ;
 
 //Static Functions
@@ -229,6 +229,14 @@ public:
   double getMeanGrayLevel() const {
     return (this->mean_gray_level);
   };
+  /*!
+    Return the number of threads used by searchDotsInArea().
+
+    \sa setNbSearchThreads()
+  */
+  inline unsigned int getNbSearchThreads() const {
+    return nbSearchThreads;
+  };
   /*!
   \return a vpPolygon made from the edges of the dot.
   */
@@ -358,6 +366,16 @@ public:
   void setGrayLevelPrecision( const double & grayLevelPrecision );
   void setHeight( const double & height );
   void setMaxSizeSearchDistancePrecision(const double & maxSizeSearchDistancePrecision);
+  /*!
+    Set the number of threads used by searchDotsInArea(), and by track() when
+    the dot is lost. The rows of the search area are split in stripes searched
+    in parallel when ViSP is built with OpenMP. The default is 1.
+
+    \sa getNbSearchThreads()
+  */
+  inline void setNbSearchThreads(const unsigned int nbThreads) {
+    nbSearchThreads = (nbThreads == 0) ? 1 : nbThreads;
+  };
   void setSizePrecision( const double & sizePrecision );
   void setWidth( const double & width );
 
@@ -366,6 +384,9 @@ public:
 
   static void trackAndDisplay(vpDot2 dot[], const unsigned int &n, vpImage<unsigned char> &I,
                               std::vector<vpImagePoint> &cogs, vpImagePoint* cogStar = NULL);
+  static unsigned int trackDots(const vpImage<unsigned char> &I, std::vector<vpDot2> &dots,
+                                std::vector<vpImagePoint> &cogs, std::vector<bool> &tracked,
+                                const unsigned int nbThreads = 1);
 
 public:
   double m00; /*!< Considering the general distribution moments for \f$ N \f$
@@ -456,6 +477,9 @@ private:
   bool findFirstBorder(const vpImage<unsigned char> &I, const unsigned int &u,
                         const unsigned int &v, unsigned int &border_u,
                         unsigned int &border_v);
+  void searchDotsInStripe(const vpImage<unsigned char>& I,
+                          unsigned int v_min, unsigned int v_max,
+                          std::vector<vpDot2> &niceDots);
   void computeMeanGrayLevel(const vpImage<unsigned char>& I);
 
   /*!
@@ -539,6 +563,7 @@ private:
   bool graphics ; // true for graphic overlay display
 
   unsigned int thickness; // Graphics thickness
+  unsigned int nbSearchThreads; // Threads used to search dots in an area
 
   // Bounding box
   int bbox_u_min, bbox_u_max, bbox_v_min, bbox_v_max;
@@ -48,6 +48,7 @@
 #include <visp3/core/vpColor.h>
 #include <visp3/core/vpTrackingException.h>
 
+#include <string.h>
 #include <vector>
 
 /*
@@ -92,10 +93,10 @@ void vpDot::init()
 
 vpDot::vpDot()
   : m00(0.), m01(0.), m10(0.), m11(0.), m20(0.), m02(0.),
-    mu11(0.), mu20(0.), mu02(0.), ip_connexities_list(), ip_edges_list(), connexityType(CONNEXITY_4),
+    mu11(0.), mu20(0.), mu02(0.), connexity_spans(), ip_edges_list(), connexityType(CONNEXITY_4),
     cog(), u_min(0), u_max(0), v_min(0), v_max(0), graphics(false), thickness(1), maxDotSizePercentage(0.25),
     gray_level_out(0), mean_gray_level(0), gray_level_min(128), gray_level_max(255), grayLevelPrecision(0.85),
-    gamma(1.5), compute_moment(false), nbMaxPoint(0)
+    gamma(1.5), compute_moment(false), nbMaxPoint(0), visited(), seeds()
 {
 }
 
@@ -106,10 +107,10 @@ vpDot::vpDot()
  */
 vpDot::vpDot(const vpImagePoint &ip)
   : m00(0.), m01(0.), m10(0.), m11(0.), m20(0.), m02(0.),
-    mu11(0.), mu20(0.), mu02(0.), ip_connexities_list(), ip_edges_list(), connexityType(CONNEXITY_4),
+    mu11(0.), mu20(0.), mu02(0.), connexity_spans(), ip_edges_list(), connexityType(CONNEXITY_4),
     cog(ip), u_min(0), u_max(0), v_min(0), v_max(0), graphics(false), thickness(1), maxDotSizePercentage(0.25),
     gray_level_out(0), mean_gray_level(0), gray_level_min(128), gray_level_max(255), grayLevelPrecision(0.85),
-    gamma(1.5), compute_moment(false), nbMaxPoint(0)
+    gamma(1.5), compute_moment(false), nbMaxPoint(0), visited(), seeds()
 {
 }
 
@@ -119,10 +120,10 @@ vpDot::vpDot(const vpImagePoint &ip)
 vpDot::vpDot(const vpDot& d)
   : vpTracker(d),
     m00(0.), m01(0.), m10(0.), m11(0.), m20(0.), m02(0.),
-    mu11(0.), mu20(0.), mu02(0.), ip_connexities_list(), ip_edges_list(), connexityType(CONNEXITY_4),
+    mu11(0.), mu20(0.), mu02(0.), connexity_spans(), ip_edges_list(), connexityType(CONNEXITY_4),
     cog(), u_min(0), u_max(0), v_min(0), v_max(0), graphics(false), thickness(1), maxDotSizePercentage(0.25),
     gray_level_out(0), mean_gray_level(0), gray_level_min(128), gray_level_max(255), grayLevelPrecision(0.85),
-    gamma(1.5), compute_moment(false), nbMaxPoint(0)
+    gamma(1.5), compute_moment(false), nbMaxPoint(0), visited(), seeds()
 {
   *this = d ;
 }
@@ -132,7 +133,7 @@ vpDot::vpDot(const vpDot& d)
  */
 vpDot::~vpDot()
 {
-  ip_connexities_list.clear() ;
+  connexity_spans.clear() ;
 }
 
 /*!
@@ -142,7 +143,7 @@ vpDot&
 vpDot::operator=(const vpDot& d)
 {
   ip_edges_list = d.ip_edges_list;
-  ip_connexities_list = d.ip_connexities_list;
+  connexity_spans = d.connexity_spans;
   connexityType = d.connexityType;
   cog = d.getCog();
 
@@ -214,84 +215,121 @@ vpDot::setGrayLevelOut()
   }
 }
 
-/*!
-  Perform the tracking of a dot by connex components.
-
-  \param mean_value : Threshold to use for the next call to track()
-  and corresponding to the mean value of the dot intensity.
-
-  \warning The content of the image is modified thanks to
-  setGrayLevelOut() called before. This method choose a gray level
-  (default is 0) used to modify the "in" dot level in "out" dot
-  level. This gray level is here needed to stop the recursivity . The
-  pixels of the dot are set to this new gray level "\out\".
-
-  \return vpDot::out if an error occurs, vpDot::in otherwise.
-
-  \sa setGrayLevelOut()
-*/
-
-bool vpDot::connexe(const vpImage<unsigned char>& I,unsigned int u,unsigned int v,
-	       double &mean_value, double &u_cog, double &v_cog, double &n)
-{
-  std::vector<bool> checkTab(I.getWidth()*I.getHeight(),false);
-  return connexe(I,u,v,mean_value,u_cog,v_cog,n,checkTab);
+namespace {
+  inline bool inDot(const unsigned char gray_level, const unsigned int level_min, const unsigned int level_max)
+  {
+    return gray_level >= level_min && gray_level <= level_max;
+  }
 }
+
 /*!
-  Perform the tracking of a dot by connex components.
+  Perform the tracking of a dot by connex components, using an iterative
+  scan-line flood fill started from pixel (u, v).
+
+  The dot is filled one horizontal run of pixels at a time. The center of
+  gravity, the bounding box, the moments, the edges and the mean gray level are
+  accumulated in the same pass. The runs are kept to build getConnexities() and
+  to reset the visited pixels, so that the cost only depends on the dot size.
 
   \param mean_value : Threshold to use for the next call to track()
   and corresponding to the mean value of the dot intensity.
 
-  \warning The content of the image is modified thanks to
-  setGrayLevelOut() called before. This method choose a gray level
-  (default is 0) used to modify the "in" dot level in "out" dot
-  level. This gray level is here needed to stop the recursivity . The
-  pixels of the dot are set to this new gray level "\out\".
-
-  \return vpDot::out if an error occurs, vpDot::in otherwise.
+  \return false if (u, v) is outside the image or not in the dot, true otherwise.
 
-  \sa setGrayLevelOut()
+  \exception vpTrackingException::featureLostError : If the dot is larger than
+  allowed by setMaxDotSize().
 */
-
 bool vpDot::connexe(const vpImage<unsigned char>& I,unsigned int u,unsigned int v,
-	       double &mean_value, double &u_cog, double &v_cog, double &n,std::vector<bool> &checkTab)
+                    double &mean_value, double &u_cog, double &v_cog, double &n)
 {
+  const unsigned int width = I.getWidth();
+  const unsigned int height = I.getHeight();
+  const unsigned int level_min = gray_level_min;
+  const unsigned int level_max = gray_level_max;
 
-  unsigned int width = I.getWidth();
-  unsigned int height= I.getHeight();
-
-  // Test if we are in the image
-  if ( (u >= width) || (v >= height) )
-  {
-    //std::cout << "out of bound" << std::endl;
+  // Test if we are in the image and in the dot
+  if ( (u >= width) || (v >= height) || !inDot(I[v][u], level_min, level_max) )
     return false;
-  }
-  
-  if(checkTab[u + v*I.getWidth()])
-    return true;
-  
-  vpImagePoint ip;
-  ip.set_u(u);
-  ip.set_v(v);	
-  
-  if (I[v][u] >= gray_level_min && I[v][u] <= gray_level_max)
-  {
-    checkTab[v*I.getWidth() + u] = true;
 
-    ip_connexities_list.push_back(ip);
+  if (visited.getWidth() != width || visited.getHeight() != height)
+    visited.resize(height, width, 0);
+
+  const bool connexity8 = (connexityType == CONNEXITY_8);
+  double sum_gray_level = mean_value * n;
+
+  seeds.clear();
+  seeds.push_back(v * width + u);
+  while (!seeds.empty()) {
+    const unsigned int seed = seeds.back();
+    seeds.pop_back();
+    const unsigned int sv = seed / width;
+    if (visited[sv][seed % width])
+      continue;
+
+    // Largest run of pixels of the dot containing the seed
+    const unsigned char *row = I[sv];
+    unsigned int ul = seed % width, ur = seed % width;
+    while (ul > 0 && inDot(row[ul-1], level_min, level_max))
+      ul--;
+    while (ur + 1 < width && inDot(row[ur+1], level_min, level_max))
+      ur++;
+
+    vpDotSpan span;
+    span.v = sv;
+    span.u_left = ul;
+    span.u_right = ur;
+    connexity_spans.push_back(span);
+    memset(visited[sv] + ul, 1, ur - ul + 1);
 
-    u_cog += u ;
-    v_cog += v ;
-    n+=1 ;
+    // Bounding box update
+    if (ul < this->u_min) this->u_min = ul;
+    if (ur > this->u_max) this->u_max = ur;
+    if (sv < this->v_min) this->v_min = sv;
+    if (sv > this->v_max) this->v_max = sv;
+
+    const unsigned char *prev = (sv >= 1) ? I[sv-1] : NULL;
+    const unsigned char *next = (sv+1 < height) ? I[sv+1] : NULL;
+    for (unsigned int x = ul; x <= ur; x++) {
+      sum_gray_level += row[x];
+      u_cog += x;
+      v_cog += sv;
+      n += 1;
+      if (compute_moment==true)
+      {
+        m00++ ;
+        m10 += x ;
+        m01 += sv ;
+        m11 += (double)x * sv ;
+        m20 += (double)x * x ;
+        m02 += (double)sv * sv ;
+      }
 
-    if (n > nbMaxPoint) {
-//      vpERROR_TRACE("Too many point %lf (%lf%% of image size). "
-//		    "This threshold can be modified using the setMaxDotSize() "
-//		    "method.",
-//		    n, n / (I.getWidth() * I.getHeight()),
-//		    nbMaxPoint, maxDotSizePercentage) ;
+      // A pixel is on the edge if one of its neighbours in the image is not in the dot
+      bool edge = (x == ul && x >= 1) || (x == ur && x+1 < width);
+      const unsigned int k_min = (connexity8 && x >= 1) ? x-1 : x;
+      const unsigned int k_max = (connexity8 && x+1 < width) ? x+1 : x;
+      for (unsigned int k = k_min; k <= k_max && !edge; k++) {
+        if ((prev != NULL && !inDot(prev[k], level_min, level_max)) ||
+            (next != NULL && !inDot(next[k], level_min, level_max)))
+          edge = true;
+      }
+
+      if (edge) {
+        vpImagePoint ip(sv, x);
+        ip_edges_list.push_back(ip);
+        if (graphics==true)
+        {
+          vpImagePoint ip_(ip);
+          for(unsigned int t=0; t<thickness; t++) {
+            ip_.set_u(ip.get_u() + t);
+            vpDisplay::displayPoint(I, ip_, vpColor::red) ;
+          }
+        }
+      }
+    }
 
+    if (n > nbMaxPoint) {
+      clearVisited();
       throw(vpTrackingException(vpTrackingException::featureLostError,
                                 "Too many point %lf (%lf%% of image size). "
                                 "This threshold can be modified using the setMaxDotSize() "
@@ -300,91 +338,62 @@ bool vpDot::connexe(const vpImage<unsigned char>& I,unsigned int u,unsigned int
                                 nbMaxPoint, maxDotSizePercentage)) ;
     }
 
-    // Bounding box update
-    if (u < this->u_min) this->u_min = u;
-    if (u > this->u_max) this->u_max = u;
-    if (v < this->v_min) this->v_min = v;
-    if (v > this->v_max) this->v_max = v;
-    
-    // Mean value of the dot intensities
-    mean_value = (mean_value *(n-1) + I[v][u]) / n;
-    if (compute_moment==true)
-    {
-      m00++ ;
-      m10 += u ;
-      m01 += v ;
-      m11 += (u*v) ;
-      m20 += u*u ;
-      m02 += v*v ;
-    }
-  }
-  else
-  {
-    //std::cout << "not in" << std::endl;
-    return false;
-  }
-  
-  bool edge = false;
-  
-  //if((int)u-1 >= 0)
-  if(u >= 1)
-    if(!checkTab[u-1 + v*I.getWidth()])
-      if(!connexe(I,u-1,v, mean_value,u_cog,v_cog, n, checkTab))
-	edge = true;
-  
-  if(u+1 < I.getWidth())
-    if(!checkTab[u+1+v*I.getWidth()])
-      if(!connexe(I,u+1,v,mean_value,u_cog, v_cog, n, checkTab))
-	edge = true;
-      
-  if(v >= 1)
-    if(!checkTab[u+(v-1)*I.getWidth()])
-      if(!connexe(I,u, v-1,mean_value,u_cog, v_cog, n, checkTab))
-	edge = true;
-      
-  if(v+1 < I.getHeight())
-    if(!checkTab[u+(v+1)*I.getWidth()])
-      if(!connexe(I,u,v+1,mean_value,u_cog, v_cog, n, checkTab))
-	edge = true;
-  
-  if (connexityType == CONNEXITY_8) {
-    if(v >= 1 && u >= 1)
-      if(!checkTab[u-1+(v-1)*I.getWidth()])
-        if(!connexe(I,u-1,v-1,mean_value,u_cog, v_cog, n, checkTab))
-          edge = true;
-	  
-    if(v >= 1 && u+1 < I.getWidth())
-      if(!checkTab[u+1+(v-1)*I.getWidth()])
-        if(!connexe(I,u+1,v-1,mean_value,u_cog, v_cog, n, checkTab))
-          edge = true;
-	  
-    if(v+1 < I.getHeight() && u >= 1)
-      if(!checkTab[u-1+(v+1)*I.getWidth()])
-        if(!connexe(I,u-1,v+1,mean_value, u_cog, v_cog, n, checkTab))
-          edge = true;
-	  
-    if(v+1 < I.getHeight() && u+1 < I.getWidth())
-      if(!checkTab[u+1+(v+1)*I.getWidth()])
-        if(!connexe(I,u+1,v+1,mean_value,u_cog, v_cog, n, checkTab))
-          edge = true;
-   }
-  
-  if(edge){
-    ip_edges_list.push_back(ip);
-    if (graphics==true)
-    {
-      vpImagePoint ip_(ip);
-      for(unsigned int t=0; t<thickness; t++) {
-        ip_.set_u(ip.get_u() + t);
-        vpDisplay::displayPoint(I, ip_, vpColor::red) ;
+    // Seeds of the runs connected to this one in the rows above and below
+    const unsigned int k_min = (connexity8 && ul >= 1) ? ul-1 : ul;
+    const unsigned int k_max = (connexity8 && ur+1 < width) ? ur+1 : ur;
+    for (int dv = -1; dv <= 1; dv += 2) {
+      const unsigned char *neighbour = (dv < 0) ? prev : next;
+      if (neighbour == NULL)
+        continue;
+      const unsigned int nv = (unsigned int)((int)sv + dv);
+      const unsigned char *neighbour_visited = visited[nv];
+      bool in_run = false;
+      for (unsigned int k = k_min; k <= k_max; k++) {
+        if (inDot(neighbour[k], level_min, level_max) && !neighbour_visited[k]) {
+          if (!in_run)
+            seeds.push_back(nv * width + k);
+          in_run = true;
+        }
+        else
+          in_run = false;
       }
-      //vpDisplay::flush(I);
     }
   }
-  
+
+  clearVisited();
+  mean_value = sum_gray_level / n;
+
   return true;
 }
 
+/*!
+  Reset the pixels of the runs found by connexe() in the mask of the visited pixels.
+*/
+void vpDot::clearVisited()
+{
+  for (size_t i = 0; i < connexity_spans.size(); i++) {
+    const vpDotSpan &span = connexity_spans[i];
+    memset(visited[span.v] + span.u_left, 0, span.u_right - span.u_left + 1);
+  }
+}
+
+/*!
+  Return the list of all the image points inside the dot.
+
+  \return The list of all the images points in the dot.
+  This list is updated after a call to track().
+*/
+std::list<vpImagePoint> vpDot::getConnexities() const
+{
+  std::list<vpImagePoint> connexities;
+  for (size_t i = 0; i < connexity_spans.size(); i++) {
+    const vpDotSpan &span = connexity_spans[i];
+    for (unsigned int u = span.u_left; u <= span.u_right; u++)
+      connexities.push_back(vpImagePoint(span.v, u));
+  }
+  return connexities;
+}
+
 /*!
 
   Compute the center of gravity (COG) of the dot using connex
@@ -421,7 +430,7 @@ vpDot::COG(const vpImage<unsigned char> &I, double& u, double& v)
   double npoint = 0 ;
   this->mean_gray_level = 0 ;
 
-  ip_connexities_list.clear() ;
+  connexity_spans.clear() ;
   ip_edges_list.clear();
   
   // Initialise the boundig box
@@ -445,7 +454,7 @@ vpDot::COG(const vpImage<unsigned char> &I, double& u, double& v)
 	{
 	  u_cog = 0 ;
 	  v_cog = 0 ;
-    ip_connexities_list.clear() ;
+    connexity_spans.clear() ;
 	 
 	  this->mean_gray_level = 0 ;
 	  if (connexe(I, (unsigned int)(u+k*pas),(unsigned int)(v+l*pas),
@@ -481,7 +490,7 @@ vpDot::COG(const vpImage<unsigned char> &I, double& u, double& v)
       for (k=1; k <= right; k++) if(sol==false) {
 	u_cog = 0 ;
 	v_cog = 0 ;
-	ip_connexities_list.clear() ;
+	connexity_spans.clear() ;
 	ip_edges_list.clear();
 	
 	this->mean_gray_level = 0 ;
@@ -495,7 +504,7 @@ vpDot::COG(const vpImage<unsigned char> &I, double& u, double& v)
       for (k=1; k <= botom; k++) if (sol==false) {
 	u_cog = 0 ;
 	v_cog = 0 ;
-	ip_connexities_list.clear() ;
+	connexity_spans.clear() ;
 	ip_edges_list.clear();
 	
 	this->mean_gray_level = 0 ;
@@ -510,7 +519,7 @@ vpDot::COG(const vpImage<unsigned char> &I, double& u, double& v)
       for (k=1; k <= left; k++) if (sol==false) {
 	u_cog = 0 ;
 	v_cog = 0 ;
-	ip_connexities_list.clear() ;
+	connexity_spans.clear() ;
 	ip_edges_list.clear();
 	
 	this->mean_gray_level = 0 ;
@@ -525,7 +534,7 @@ vpDot::COG(const vpImage<unsigned char> &I, double& u, double& v)
       for (k=1; k <= up; k++) if(sol==false) {
 	u_cog = 0 ;
 	v_cog = 0 ;
-	ip_connexities_list.clear() ;
+	connexity_spans.clear() ;
 	ip_edges_list.clear();
 	
 	this->mean_gray_level = 0 ;
@@ -546,17 +555,6 @@ vpDot::COG(const vpImage<unsigned char> &I, double& u, double& v)
   }
 
 #endif
-/*
-  vpImagePoint ip;
-  unsigned int i, j;
-  std::list<vpImagePoint>::iterator it;
-  for (it = ip_connexities_list.begin(); it != ip_connexities_list.end(); it ++) {
-    ip = *it;
-    i = (unsigned int) ip.get_i();
-    j = (unsigned int) ip.get_j();
-    I[i][j] = 255 ;
-  }*/
-
   u_cog = u_cog/npoint ;
   v_cog = v_cog/npoint ;
 
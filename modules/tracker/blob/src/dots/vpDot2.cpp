@@ -57,6 +57,23 @@
 #include <iostream>    
 #include <cmath>    // std::fabs
 #include <limits>   // numeric_limits
+#include <algorithm>
+#include <utility>
+
+namespace {
+  //! Bounding box of a found dot, used to skip the germs inside it
+  typedef struct {
+    double u_min, u_max, v_min, v_max;
+  } vpDotBox;
+
+  //! Two dots found by a search are the same if their centers of gravity are closer than 3 pixels
+  inline bool isSameDot(const vpDot2 &dot1, const vpDot2 &dot2)
+  {
+    const double epsilon = 3.0;
+    return fabs( dot1.getCog().get_u() - dot2.getCog().get_u() ) < epsilon &&
+           fabs( dot1.getCog().get_v() - dot2.getCog().get_v() ) < epsilon;
+  }
+}
 
 /******************************************************************************
  *
@@ -97,6 +114,7 @@ void vpDot2::init()
   compute_moment = false ;
   graphics = false;
   thickness = 1;
+  nbSearchThreads = 1;
 }
 
 /*!
@@ -108,7 +126,7 @@ vpDot2::vpDot2()
     gray_level_min(128), gray_level_max(255), mean_gray_level(0), grayLevelPrecision(0.8), gamma(1.5),
     sizePrecision(0.65), ellipsoidShapePrecision(0.65), maxSizeSearchDistancePrecision(0.65),
     allowedBadPointsPercentage_(0.), area(), direction_list(), ip_edges_list(), compute_moment(false),
-    graphics(false), thickness(1), bbox_u_min(0), bbox_u_max(0), bbox_v_min(0), bbox_v_max(0),
+    graphics(false), thickness(1), nbSearchThreads(1), bbox_u_min(0), bbox_u_max(0), bbox_v_min(0), bbox_v_max(0),
     firstBorder_u(0), firstBorder_v()
 {
 }
@@ -127,7 +145,7 @@ vpDot2::vpDot2(const vpImagePoint &ip)
     gray_level_min(128), gray_level_max(255), mean_gray_level(0), grayLevelPrecision(0.8), gamma(1.5),
     sizePrecision(0.65), ellipsoidShapePrecision(0.65), maxSizeSearchDistancePrecision(0.65),
     allowedBadPointsPercentage_(0.), area(), direction_list(), ip_edges_list(), compute_moment(false),
-    graphics(false), thickness(1), bbox_u_min(0), bbox_u_max(0), bbox_v_min(0), bbox_v_max(0),
+    graphics(false), thickness(1), nbSearchThreads(1), bbox_u_min(0), bbox_u_max(0), bbox_v_min(0), bbox_v_max(0),
     firstBorder_u(0), firstBorder_v()
 {
 }
@@ -142,7 +160,7 @@ vpDot2::vpDot2(const vpDot2& twinDot )
     gray_level_min(128), gray_level_max(255), mean_gray_level(0), grayLevelPrecision(0.8), gamma(1.5),
     sizePrecision(0.65), ellipsoidShapePrecision(0.65), maxSizeSearchDistancePrecision(0.65),
     allowedBadPointsPercentage_(0.), area(), direction_list(), ip_edges_list(), compute_moment(false),
-    graphics(false), thickness(1), bbox_u_min(0), bbox_u_max(0), bbox_v_min(0), bbox_v_max(0),
+    graphics(false), thickness(1), nbSearchThreads(1), bbox_u_min(0), bbox_u_max(0), bbox_v_min(0), bbox_v_max(0),
     firstBorder_u(0), firstBorder_v()
 {
   *this = twinDot;
@@ -175,6 +193,7 @@ vpDot2& vpDot2::operator=(const vpDot2& twinDot )
   compute_moment = twinDot.compute_moment;
   graphics = twinDot.graphics;
   thickness = twinDot.thickness;
+  nbSearchThreads = twinDot.nbSearchThreads;
 
   bbox_u_min = twinDot.bbox_u_min;
   bbox_u_max = twinDot.bbox_u_max;
@@ -473,7 +492,14 @@ void vpDot2::track(const vpImage<unsigned char> &I)
   // function).
   // If the found dot is not similar (or valid), we use this copy to set the current 
   // found dot to the previous one (see below).
+  // The border lists are moved rather than copied: computeParameters() rebuilds them.
+  std::list<unsigned int> previous_direction_list;
+  std::list<vpImagePoint> previous_ip_edges_list;
+  previous_direction_list.swap(direction_list);
+  previous_ip_edges_list.swap(ip_edges_list);
   vpDot2 wantedDot(*this);
+  wantedDot.direction_list.swap(previous_direction_list);
+  wantedDot.ip_edges_list.swap(previous_ip_edges_list);
 
   //   vpDEBUG_TRACE(0, "Previous dot: ");
   //   vpDEBUG_TRACE(0, "u: %f v: %f", get_u(), get_v());
@@ -531,7 +557,7 @@ void vpDot2::track(const vpImage<unsigned char> &I)
     }
 
     // otherwise we've got our dot, update this dot's parameters
-    vpDot2 movingDot = candidates.front();
+    const vpDot2 &movingDot = candidates.front();
 
     setCog( movingDot.getCog() );
     setArea( movingDot.getArea() );
@@ -1032,6 +1058,9 @@ void vpDot2::searchDotsInArea(const vpImage<unsigned char>& I, std::list<vpDot2>
 
   \param niceDots: List of the dots that are found.
 
+  The dots are sorted by increasing distance to the center of the area. The
+  area can be searched by several threads, see setNbSearchThreads().
+
   \warning Allocates memory for the list of vpDot2 returned by this method.
   Desallocation has to be done by yourself, see searchDotsInArea()
 
@@ -1067,55 +1096,128 @@ void vpDot2::searchDotsInArea(const vpImage<unsigned char>& I,
   vpDisplay::displayRectangle(I, area, vpColor::blue);
   vpDisplay::flush(I);
 #endif
-  // start the search loop; for all points of the search grid,
-  // test if the pixel belongs to a valid dot.
-  // if it is so eventually add it to the vector of valid dots.
-  std::list<vpDot2> badDotsVector;
-  std::list<vpDot2>::iterator itnice;
-  std::list<vpDot2>::iterator itbad;
 
-  vpDot2* dotToTest = NULL;
-  vpDot2 tmpDot;
+  // The center used to sort the dots is not the area center available by
+  // area.getCenter(area_center_u, area_center_v) but the center of the input
+  // area which may be partially outside the image.
+  const double area_center_u = area_u + area_w/2.0 - 0.5;
+  const double area_center_v = area_v + area_h/2.0 - 0.5;
+
+  // The rows of the search grid are split in stripes searched independently.
+  // The displays can not be shared between threads.
+  const unsigned int area_v_min = (unsigned int) area.getTop();
+  const unsigned int area_v_max = (unsigned int) area.getBottom();
+  const unsigned int nbGridRows = (area_v_max > area_v_min) ? (area_v_max - area_v_min - 1) / gridHeight + 1 : 0;
+  unsigned int nbThreads = graphics ? 1 : nbSearchThreads;
+  if (nbThreads == 0)
+    nbThreads = 1;
+  // More stripes than threads balance the load between the threads
+  const unsigned int nbStripes = (nbThreads > 1) ? std::min(nbGridRows, 4*nbThreads) : 1;
+
+  std::vector< std::vector<vpDot2> > stripeDots(nbStripes);
+#ifdef VISP_HAVE_OPENMP
+  #pragma omp parallel for schedule(dynamic) num_threads(nbThreads) if(nbThreads > 1)
+#endif
+  for (int s = 0; s < (int)nbStripes; s++) {
+    const unsigned int v_min = area_v_min + (unsigned int)(((unsigned long)s * nbGridRows) / nbStripes) * gridHeight;
+    const unsigned int v_max = std::min(area_v_max,
+      area_v_min + (unsigned int)(((unsigned long)(s+1) * nbGridRows) / nbStripes) * gridHeight);
+    searchDotsInStripe(I, v_min, v_max, stripeDots[(size_t)s]);
+  }
 
-  unsigned int area_u_min = (unsigned int) area.getLeft();
-  unsigned int area_u_max = (unsigned int) area.getRight();
-  unsigned int area_v_min = (unsigned int) area.getTop();
-  unsigned int area_v_max = (unsigned int) area.getBottom();
+  // Merge the stripes: a dot crossing two stripes is kept once, then the dots
+  // are sorted by increasing distance to the center of the area.
+  std::vector<const vpDot2 *> dots;
+  std::vector<std::pair<double, size_t> > distances;
+  for (size_t s = 0; s < stripeDots.size(); s++) {
+    for (size_t i = 0; i < stripeDots[s].size(); i++) {
+      const vpDot2 &dot = stripeDots[s][i];
+      bool duplicated = false;
+      for (size_t j = 0; j < dots.size() && ! duplicated && nbStripes > 1; j++)
+        duplicated = isSameDot(dot, *dots[j]);
+      if (duplicated)
+        continue;
+      const double diff_u = dot.cog.get_u() - area_center_u;
+      const double diff_v = dot.cog.get_v() - area_center_v;
+      distances.push_back(std::make_pair(sqrt(diff_u*diff_u + diff_v*diff_v), dots.size()));
+      dots.push_back(&dot);
+    }
+  }
+  // The index breaks the ties, keeping the order in which the dots are found
+  std::sort(distances.begin(), distances.end());
+  for (size_t i = 0; i < distances.size(); i++)
+    niceDots.push_back(*dots[distances[i].second]);
+}
 
-  unsigned int u, v;
-  vpImagePoint cogTmpDot;
+/*!
 
-  for( v=area_v_min ; v<area_v_max ; v=v+gridHeight )
-  {
-    for( u=area_u_min ; u<area_u_max ; u=u+gridWidth )
-    {
+  Search the dots in the rows of the search grid that are in [\e v_min, \e v_max[.
+
+  A germ is not tested when it is inside the bounding box of a dot already found
+  in the stripe, or when its first border belongs to the border of a dot
+  already rejected in the stripe. The found dots are looked up in a regular grid
+  of cells instead of a list, and the borders of the rejected dots are marked in
+  a mask of the grid rows of the stripe.
+
+  \param I : Image to process.
+  \param v_min, v_max : Rows of the stripe.
+  \param niceDots : Found dots, in the order they are found.
+*/
+void vpDot2::searchDotsInStripe(const vpImage<unsigned char>& I,
+                                 unsigned int v_min, unsigned int v_max,
+                                 std::vector<vpDot2> &niceDots)
+{
+  unsigned int gridWidth;
+  unsigned int gridHeight;
+  getGridSize( gridWidth, gridHeight );
+
+  const unsigned int area_u_min = (unsigned int) area.getLeft();
+  const unsigned int area_u_max = (unsigned int) area.getRight();
+  if (area_u_max <= area_u_min || v_max <= v_min)
+    return;
+  const unsigned int mask_w = area_u_max - area_u_min + 1;
+  const unsigned int nbGridRows = (v_max - v_min - 1) / gridHeight + 1;
+
+  // Cells of the found dots bounding boxes, covering the rows of the stripe
+  const unsigned int cellSize = 32;
+  const unsigned int nbCells_u = mask_w / cellSize + 1;
+  const unsigned int nbCells_v = (v_max - v_min - 1) / cellSize + 1;
+  std::vector< std::vector<unsigned int> > cells(nbCells_u * nbCells_v);
+  std::vector<vpDotBox> boxes;
+
+  // Borders of the rejected dots on the grid rows of the stripe, the only rows
+  // where germs are tested. Allocated with the first rejected dot.
+  std::vector<unsigned char> badBorders;
+
+  // Pixels of the current grid row with the right gray level; this loop is
+  // vectorized by the compiler
+  std::vector<unsigned char> goodLevel(mask_w);
+  const unsigned int level_min = gray_level_min;
+  const unsigned int level_max = gray_level_max;
+
+  vpDot2* dotToTest = NULL;
+  for (unsigned int v = v_min; v < v_max; v += gridHeight) {
+    const unsigned char *row = I[v] + area_u_min;
+    for (unsigned int k = 0; k < mask_w; k++)
+      goodLevel[k] = (unsigned char)((row[k] >= level_min) & (row[k] <= level_max));
+
+    for (unsigned int u = area_u_min; u < area_u_max; u += gridWidth) {
       // if the pixel we're in doesn't have the right color (outside the
       // graylevel interval), no need to check further, just get to the
       // next grid intersection.
-      if( !hasGoodLevel(I, u, v) ) continue;
+      if( !goodLevel[u - area_u_min] ) continue;
 
-      // Test if an other germ is inside the bounding box of a dot previously
+      // Test if the germ is inside the bounding box of a dot previously
       // detected
       bool good_germ = true;
-
-      itnice = niceDots.begin();
-      while( itnice != niceDots.end() && good_germ == true) {
-        tmpDot = *itnice;
-
-        cogTmpDot = tmpDot.getCog();
-        double u0 = cogTmpDot.get_u();
-        double v0 = cogTmpDot.get_v();
-        double half_w = tmpDot.getWidth()  / 2.;
-        double half_h = tmpDot.getHeight() / 2.;
-
-        if ( u >= (u0-half_w) && u <= (u0+half_w) &&
-             v >= (v0-half_h) && v <= (v0+half_h) ) {
+      const std::vector<unsigned int> &cell = cells[((v - v_min) / cellSize) * nbCells_u + (u - area_u_min) / cellSize];
+      for (size_t i = 0; i < cell.size() && good_germ; i++) {
+        const vpDotBox &box = boxes[cell[i]];
+        if (u >= box.u_min && u <= box.u_max && v >= box.v_min && v <= box.v_max) {
           // Germ is in a previously detected dot
           good_germ = false;
         }
-        ++ itnice;
       }
-
       if (! good_germ)
         continue;
 
@@ -1130,36 +1232,11 @@ void vpDot2::searchDotsInArea(const vpImage<unsigned char>& I,
         continue;
       }
 
-      itbad = badDotsVector.begin();
-#define vpBAD_DOT_VALUE (*itbad)
-      vpImagePoint cogBadDot;
-
-      while( itbad != badDotsVector.end() && good_germ == true) {
-        if( (double)u >= vpBAD_DOT_VALUE.bbox_u_min
-            && (double)u <= vpBAD_DOT_VALUE.bbox_u_max &&
-            (double)v >= vpBAD_DOT_VALUE.bbox_v_min
-            && (double)v <= vpBAD_DOT_VALUE.bbox_v_max){
-          std::list<vpImagePoint>::const_iterator it_edges = ip_edges_list.begin();
-          while (it_edges != ip_edges_list.end() && good_germ == true){
-            // Test if the germ belong to a previously detected dot:
-            // - from the germ go right to the border and compare this
-            //   position to the list of pixels of previously detected dots
-            cogBadDot = *it_edges;
-            //if( border_u == cogBadDot.get_u() && v == cogBadDot.get_v()) {
-            if( (std::fabs(border_u - cogBadDot.get_u()) <= vpMath::maximum(std::fabs((double)border_u), std::fabs(cogBadDot.get_u()))*std::numeric_limits<double>::epsilon() )
-              &&
-                  (std::fabs(v - cogBadDot.get_v()) <= vpMath::maximum(std::fabs((double)v), std::fabs(cogBadDot.get_v()))*std::numeric_limits<double>::epsilon() )) {
-              good_germ = false;
-            }
-            ++ it_edges;
-          }
-        }
-        ++itbad;
-      }
-#undef vpBAD_DOT_VALUE
-
-      if (! good_germ) {
-        // Jump all the pixels between v,u and v, dotToTest->getFirstBorder_u()
+      // Test if the germ belongs to a previously rejected dot: from the germ
+      // go right to the border and compare this position to the borders of the
+      // rejected dots. The border is on the row of the germ.
+      if (! badBorders.empty() && border_u <= area_u_max &&
+          badBorders[((border_v - v_min) / gridHeight) * mask_w + border_u - area_u_min]) {
         u = border_u;
         v = border_v;
         continue;
@@ -1199,76 +1276,47 @@ void vpDot2::searchDotsInArea(const vpImage<unsigned char>& I,
       // if the dot to test is valid,
       if( dotToTest->isValid( I, *this ) )
       {
-        vpImagePoint cogDotToTest = dotToTest->getCog();
-        // Compute the distance to the center. The center used here is not the
-        // area center available by area.getCenter(area_center_u,
-        // area_center_v) but the center of the input area which may be
-        // partially outside the image.
-
-        double area_center_u = area_u + area_w/2.0 - 0.5;
-        double area_center_v = area_v + area_h/2.0 - 0.5;
-
-        double thisDiff_u = cogDotToTest.get_u() - area_center_u;
-        double thisDiff_v = cogDotToTest.get_v() - area_center_v;
-        double thisDist = sqrt( thisDiff_u*thisDiff_u + thisDiff_v*thisDiff_v);
-
-        bool stopLoop = false;
-        itnice = niceDots.begin();
-
-        while( itnice != niceDots.end() &&  stopLoop == false )
-        {
-          tmpDot = *itnice;
-
-          //double epsilon = 0.001; // detecte +sieurs points
-          double epsilon = 3.0;
-          // if the center of the dot is the same than the current
-          // don't add it, test the next point of the grid
-          cogTmpDot = tmpDot.getCog();
-
-          if( fabs( cogTmpDot.get_u() - cogDotToTest.get_u() ) < epsilon &&
-              fabs( cogTmpDot.get_v() - cogDotToTest.get_v() ) < epsilon )
-          {
-            stopLoop = true;
-            // Jump all the pixels between v,u and v, tmpDot->getFirstBorder_u()
-            u = border_u;
-            v = border_v;
-            continue;
-          }
-
-          double otherDiff_u = cogTmpDot.get_u() - area_center_u;
-          double otherDiff_v = cogTmpDot.get_v() - area_center_v;
-          double otherDist = sqrt( otherDiff_u*otherDiff_u +
-                                   otherDiff_v*otherDiff_v );
-
-
-          // if the distance of the curent vector element to the center
-          // is greater than the distance of this dot to the center,
-          // then add this dot before the current vector element.
-          if( otherDist > thisDist )
-          {
-            niceDots.insert(itnice, *dotToTest );
-            ++ itnice;
-            stopLoop = true;
-            // Jump all the pixels between v,u and v, tmpDot->getFirstBorder_u()
-            u = border_u;
-            v = border_v;
-            continue;
-          }
-          ++itnice;
-        }
-        vpTRACE(4, "End while (%d, %d)", u, v);
-
-        // if we reached the end of the vector without finding the dot
-        // or inserting it, insert it now.
-        if( itnice == niceDots.end() && stopLoop == false )
-        {
-          niceDots.push_back( *dotToTest );
+        // if the center of the dot is the same than a found one
+        // don't add it, test the next point of the grid
+        bool duplicated = false;
+        for (size_t i = 0; i < niceDots.size() && ! duplicated; i++)
+          duplicated = isSameDot(*dotToTest, niceDots[i]);
+        if (! duplicated) {
+          const double half_w = dotToTest->getWidth()  / 2.;
+          const double half_h = dotToTest->getHeight() / 2.;
+          vpDotBox box;
+          box.u_min = dotToTest->cog.get_u() - half_w;
+          box.u_max = dotToTest->cog.get_u() + half_w;
+          box.v_min = dotToTest->cog.get_v() - half_h;
+          box.v_max = dotToTest->cog.get_v() + half_h;
+
+          const int c_u_min = std::max(0, (int)floor((box.u_min - area_u_min) / cellSize));
+          const int c_u_max = std::min((int)nbCells_u - 1, (int)floor((box.u_max - area_u_min) / cellSize));
+          const int c_v_min = std::max(0, (int)floor((box.v_min - v_min) / cellSize));
+          const int c_v_max = std::min((int)nbCells_v - 1, (int)floor((box.v_max - v_min) / cellSize));
+          for (int c_v = c_v_min; c_v <= c_v_max; c_v++)
+            for (int c_u = c_u_min; c_u <= c_u_max; c_u++)
+              cells[(unsigned int)c_v * nbCells_u + (unsigned int)c_u].push_back((unsigned int)boxes.size());
+          boxes.push_back(box);
+          niceDots.push_back(*dotToTest);
         }
       }
       else {
-        // Store bad dots
-        badDotsVector.push_front( *dotToTest );
+        // Store the border of the bad dot
+        if (badBorders.empty())
+          badBorders.resize((size_t)mask_w * nbGridRows, 0);
+        for (std::list<vpImagePoint>::const_iterator it = dotToTest->ip_edges_list.begin();
+             it != dotToTest->ip_edges_list.end(); ++it) {
+          const int edge_u = vpMath::round(it->get_u());
+          const int edge_v = vpMath::round(it->get_v());
+          if (edge_u >= (int)area_u_min && edge_u <= (int)area_u_max && edge_v >= (int)v_min && edge_v < (int)v_max
+              && (edge_v - (int)v_min) % (int)gridHeight == 0)
+            badBorders[((unsigned int)edge_v - v_min) / gridHeight * mask_w + (unsigned int)edge_u - area_u_min] = 1;
+        }
       }
+      // Jump all the pixels between v,u and v, dotToTest->getFirstBorder_u()
+      u = border_u;
+      v = border_v;
     }
   }
   if( dotToTest != NULL ) delete dotToTest;
@@ -2564,6 +2612,66 @@ void vpDot2::trackAndDisplay(vpDot2 dot[], const unsigned int &n, vpImage<unsign
 	vpDisplay::flush(I);
 }
 
+/*!
+  Track a set of dots in the same image.
+
+  Each dot is tracked as with track(), the dots being distributed over \e nbThreads
+  threads when ViSP is built with OpenMP. A lost dot does not stop the tracking of
+  the other ones: it is only reported in \e tracked.
+
+  \param I : Image to process.
+  \param dots : Dots to track, updated with their new parameters.
+  \param cogs : Centers of gravity of the dots. For a lost dot, the center of
+  gravity it had before the call.
+  \param tracked : For each dot, true if it was tracked, false if it was lost.
+  \param nbThreads : Number of threads. When the display of one of the dots is
+  enabled with setGraphics(), the dots are tracked in the calling thread.
+
+  \return The number of dots that were tracked.
+*/
+unsigned int vpDot2::trackDots(const vpImage<unsigned char> &I, std::vector<vpDot2> &dots,
+                               std::vector<vpImagePoint> &cogs, std::vector<bool> &tracked,
+                               const unsigned int nbThreads)
+{
+  const int n = (int)dots.size();
+  std::vector<vpImagePoint> previous_cogs(dots.size());
+  unsigned int nbWorkers = nbThreads;
+  for (int i = 0; i < n; i++) {
+    previous_cogs[i] = dots[i].getCog();
+    // The displays can not be shared between threads
+    if (dots[i].graphics)
+      nbWorkers = 1;
+  }
+
+  // Flags written by the threads; std::vector<bool> elements can not be written concurrently
+  std::vector<unsigned char> status(dots.size(), 0);
+#ifdef VISP_HAVE_OPENMP
+  #pragma omp parallel for schedule(dynamic) num_threads(nbWorkers) if(nbWorkers > 1)
+#else
+  (void)nbWorkers;
+#endif
+  for (int i = 0; i < n; i++) {
+    try {
+      dots[i].track(I);
+      status[i] = 1;
+    }
+    catch(const vpException &) {
+      status[i] = 0;
+    }
+  }
+
+  cogs.resize(dots.size());
+  tracked.resize(dots.size());
+  unsigned int nbTracked = 0;
+  for (int i = 0; i < n; i++) {
+    tracked[i] = (status[i] != 0);
+    cogs[i] = tracked[i] ? dots[i].getCog() : previous_cogs[i];
+    nbTracked += status[i];
+  }
+
+  return nbTracked;
+}
+
 /*!
 
   Display the dot center of gravity and its list of edges.
@@ -0,0 +1,143 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Batch tracking of a set of vpDot2.
+ *
+ *****************************************************************************/
+
+#include <iostream>
+#include <vector>
+
+#include <visp3/blob/vpDot2.h>
+#include <visp3/core/vpTime.h>
+
+/*!
+  \example testDot2Batch.cpp
+
+  \brief Check that vpDot2::trackDots() gives the same dots as vpDot2::track() called
+  on each dot of a 200 targets calibration board, and that a lost dot is reported
+  without stopping the tracking of the other ones.
+*/
+
+namespace {
+  const unsigned int nbRows = 10, nbCols = 20, spacing = 60, radius = 10;
+
+  //! Black disks on a white background, the board being shifted by (di, dj)
+  void drawBoard(vpImage<unsigned char> &I, const double di, const double dj, const int erased = -1) {
+    I = 255;
+    for (unsigned int r = 0; r < nbRows; r++) {
+      for (unsigned int c = 0; c < nbCols; c++) {
+        if ((int) (r * nbCols + c) == erased) {
+          continue;
+        }
+        const double ci = 40 + r * spacing + di, cj = 40 + c * spacing + dj;
+        for (int i = (int) (ci - radius - 1); i <= (int) (ci + radius + 1); i++) {
+          for (int j = (int) (cj - radius - 1); j <= (int) (cj + radius + 1); j++) {
+            if ((i - ci) * (i - ci) + (j - cj) * (j - cj) <= radius * radius) {
+              I[i][j] = 20;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+int main()
+{
+  try {
+    vpImage<unsigned char> I(nbRows * spacing + 40, nbCols * spacing + 40);
+    drawBoard(I, 0, 0);
+
+    std::vector<vpDot2> dots(nbRows * nbCols);
+    for (unsigned int r = 0; r < nbRows; r++) {
+      for (unsigned int c = 0; c < nbCols; c++) {
+        dots[r * nbCols + c].initTracking(I, vpImagePoint(40 + r * spacing, 40 + c * spacing));
+      }
+    }
+    std::vector<vpDot2> dotsRef = dots;
+
+    std::vector<vpImagePoint> cogs;
+    std::vector<bool> tracked;
+    double tRef = 0, tBatch = 0;
+    const unsigned int nbFrames = 20;
+    for (unsigned int k = 1; k <= nbFrames; k++) {
+      const int erased = (k == nbFrames) ? 57 : -1;
+      drawBoard(I, 0.7 * k, 1.3 * k, erased);
+
+      double t = vpTime::measureTimeMs();
+      std::vector<bool> trackedRef(dotsRef.size(), true);
+      for (size_t i = 0; i < dotsRef.size(); i++) {
+        try {
+          dotsRef[i].track(I);
+        } catch(const vpException &) {
+          trackedRef[i] = false;
+        }
+      }
+      tRef += vpTime::measureTimeMs() - t;
+
+      t = vpTime::measureTimeMs();
+      unsigned int nbTracked = vpDot2::trackDots(I, dots, cogs, tracked, 4);
+      tBatch += vpTime::measureTimeMs() - t;
+
+      if (nbTracked != (erased < 0 ? dots.size() : dots.size() - 1) || tracked != trackedRef ||
+          cogs.size() != dots.size()) {
+        std::cerr << "Frame " << k << ": " << nbTracked << " dots tracked" << std::endl;
+        return EXIT_FAILURE;
+      }
+      for (size_t i = 0; i < dots.size(); i++) {
+        if (!tracked[i]) {
+          continue;
+        }
+        if (cogs[i] != dotsRef[i].getCog() || dots[i].getArea() != dotsRef[i].getArea() ||
+            vpImagePoint::distance(cogs[i], vpImagePoint(40 + (i / nbCols) * spacing + 0.7 * k,
+                                                         40 + (i % nbCols) * spacing + 1.3 * k)) > 0.5) {
+          std::cerr << "Frame " << k << ": dot " << i << " at " << cogs[i] << " instead of "
+                    << dotsRef[i].getCog() << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    if (tracked[57] || cogs[57] != dotsRef[57].getCog()) {
+      std::cerr << "The lost dot is not reported at its previous position" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cout << "Mean time to track " << dots.size() << " dots: " << tRef / nbFrames << " ms with vpDot2::track(), "
+              << tBatch / nbFrames << " ms with vpDot2::trackDots()" << std::endl;
+    return EXIT_SUCCESS;
+  } catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,149 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Search of the dots similar to a vpDot2 in a whole image.
+ *
+ *****************************************************************************/
+
+#include <cmath>
+#include <iostream>
+#include <list>
+#include <sstream>
+#include <vector>
+
+#include <visp3/blob/vpDot2.h>
+#include <visp3/core/vpTime.h>
+
+/*!
+  \example testDot2Search.cpp
+
+  \brief Check that vpDot2::searchDotsInArea() finds each dot of a 200 targets board
+  once, next to large blobs with the same gray level that are rejected, with one
+  and several threads. A dot inside the bounding box of a rejected blob is found.
+*/
+
+namespace {
+  const unsigned int nbRows = 10, nbCols = 20, spacing = 60, radius = 10;
+
+  void drawBoard(vpImage<unsigned char> &I) {
+    I.resize(nbRows * spacing + 140, nbCols * spacing + 40, 255);
+    for (unsigned int r = 0; r < nbRows; r++) {
+      for (unsigned int c = 0; c < nbCols; c++) {
+        const double ci = 40.3 + r * spacing, cj = 40.6 + c * spacing;
+        for (int i = (int) (ci - radius - 1); i <= (int) (ci + radius + 1); i++) {
+          for (int j = (int) (cj - radius - 1); j <= (int) (cj + radius + 1); j++) {
+            if ((i - ci) * (i - ci) + (j - cj) * (j - cj) <= radius * radius) {
+              I[i][j] = 20;
+            }
+          }
+        }
+      }
+    }
+    // L shaped blob with the gray level of the dots around the first dot, which is
+    // inside the bounding box of the blob
+    for (unsigned int i = 4; i < 70; i++) {
+      for (unsigned int j = 4; j < (i < 14 ? 80u : 21u); j++) {
+        I[i][j] = 20;
+      }
+    }
+    // Large blobs with the gray level of the dots, below the board
+    for (unsigned int k = 0; k < 6; k++) {
+      for (unsigned int i = nbRows * spacing + 30; i < nbRows * spacing + 120; i++) {
+        for (unsigned int j = 30 + k * 200; j < 30 + k * 200 + 40 + 20 * k; j++) {
+          I[i][j] = 20;
+        }
+      }
+    }
+  }
+
+  bool checkDots(const std::string &name, const std::list<vpDot2> &dots, const double time) {
+    std::vector<unsigned int> found(nbRows * nbCols, 0);
+    double previousDistance = 0;
+    const double center_u = (nbCols * spacing + 40) / 2.0 - 0.5, center_v = (nbRows * spacing + 140) / 2.0 - 0.5;
+    for (std::list<vpDot2>::const_iterator it = dots.begin(); it != dots.end(); ++it) {
+      const vpImagePoint cog = it->getCog();
+      const int r = vpMath::round((cog.get_i() - 40.3) / spacing), c = vpMath::round((cog.get_j() - 40.6) / spacing);
+      if (r < 0 || c < 0 || r >= (int) nbRows || c >= (int) nbCols ||
+          vpImagePoint::distance(cog, vpImagePoint(40.3 + r * spacing, 40.6 + c * spacing)) > 0.5) {
+        std::cerr << name << ": wrong dot at " << cog << std::endl;
+        return false;
+      }
+      found[r * nbCols + c]++;
+
+      const double distance = sqrt(vpMath::sqr(cog.get_u() - center_u) + vpMath::sqr(cog.get_v() - center_v));
+      if (distance < previousDistance) {
+        std::cerr << name << ": the dots are not sorted by distance to the center" << std::endl;
+        return false;
+      }
+      previousDistance = distance;
+    }
+    for (size_t i = 0; i < found.size(); i++) {
+      if (found[i] != 1) {
+        std::cerr << name << ": dot " << i << " found " << found[i] << " times" << std::endl;
+        return false;
+      }
+    }
+    std::cout << name << ": " << dots.size() << " dots found in " << time << " ms" << std::endl;
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+    vpImage<unsigned char> I;
+    drawBoard(I);
+
+    vpDot2 dot;
+    dot.initTracking(I, vpImagePoint(40, 40));
+
+    const unsigned int nbThreads[2] = { 1, 4 };
+    for (unsigned int k = 0; k < 2; k++) {
+      dot.setNbSearchThreads(nbThreads[k]);
+      std::list<vpDot2> dots;
+      double t = vpTime::measureTimeMs();
+      dot.searchDotsInArea(I, dots);
+      t = vpTime::measureTimeMs() - t;
+
+      std::stringstream name;
+      name << "Search with " << nbThreads[k] << " thread(s)";
+      if (!checkDots(name.str(), dots, t)) {
+        return EXIT_FAILURE;
+      }
+    }
+
+    return EXIT_SUCCESS;
+  } catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
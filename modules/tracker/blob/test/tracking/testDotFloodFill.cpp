@@ -0,0 +1,218 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Flood fill of vpDot on large dots and check of its outputs.
+ *
+ *****************************************************************************/
+
+#include <cmath>
+#include <iostream>
+#include <list>
+#include <set>
+#include <utility>
+
+#include <visp3/blob/vpDot.h>
+#include <visp3/core/vpTime.h>
+
+/*!
+  \example testDotFloodFill.cpp
+
+  \brief Check the pixels, edges and moments computed by vpDot against a brute force
+  labelling, and track a dot covering a quarter of a 4 Mpixels image.
+*/
+
+namespace {
+  typedef std::pair<unsigned int, unsigned int> vpPixel; // (row, column)
+
+  bool inDot(const vpImage<unsigned char> &I, const int i, const int j) {
+    return i >= 0 && j >= 0 && i < (int) I.getHeight() && j < (int) I.getWidth() && I[i][j] >= 200;
+  }
+
+  //! Connected component of pixel (i0, j0) and its edges, by a breadth first search
+  void bruteForce(const vpImage<unsigned char> &I, const unsigned int i0, const unsigned int j0, const bool connexity8,
+                  std::set<vpPixel> &pixels, std::set<vpPixel> &edges) {
+    std::list<vpPixel> queue;
+    queue.push_back(vpPixel(i0, j0));
+    pixels.insert(vpPixel(i0, j0));
+    while (!queue.empty()) {
+      const int i = (int) queue.front().first, j = (int) queue.front().second;
+      queue.pop_front();
+      bool edge = false;
+      for (int di = -1; di <= 1; di++) {
+        for (int dj = -1; dj <= 1; dj++) {
+          if ((di == 0 && dj == 0) || (!connexity8 && di != 0 && dj != 0)) {
+            continue;
+          }
+          const int ni = i + di, nj = j + dj;
+          if (ni < 0 || nj < 0 || ni >= (int) I.getHeight() || nj >= (int) I.getWidth()) {
+            continue;
+          }
+          if (!inDot(I, ni, nj)) {
+            edge = true;
+          } else if (pixels.insert(vpPixel(ni, nj)).second) {
+            queue.push_back(vpPixel(ni, nj));
+          }
+        }
+      }
+      if (edge) {
+        edges.insert(vpPixel(i, j));
+      }
+    }
+  }
+
+  std::set<vpPixel> toSet(const std::list<vpImagePoint> &points) {
+    std::set<vpPixel> pixels;
+    for (std::list<vpImagePoint>::const_iterator it = points.begin(); it != points.end(); ++it) {
+      pixels.insert(vpPixel((unsigned int) it->get_i(), (unsigned int) it->get_j()));
+    }
+    return pixels;
+  }
+
+  bool checkDot(const std::string &name, const vpImage<unsigned char> &I, const unsigned int i0,
+                const unsigned int j0, const bool connexity8) {
+    std::set<vpPixel> pixels, edges;
+    bruteForce(I, i0, j0, connexity8, pixels, edges);
+
+    double m00 = 0, m10 = 0, m01 = 0, m11 = 0, m20 = 0, m02 = 0;
+    for (std::set<vpPixel>::const_iterator it = pixels.begin(); it != pixels.end(); ++it) {
+      const double v = it->first, u = it->second;
+      m00 += 1; m10 += u; m01 += v; m11 += u * v; m20 += u * u; m02 += v * v;
+    }
+
+    vpDot dot;
+    dot.setConnexity(connexity8 ? vpDot::CONNEXITY_8 : vpDot::CONNEXITY_4);
+    dot.setComputeMoments(true);
+    dot.setMaxDotSize(1.0);
+    dot.initTracking(I, vpImagePoint(i0, j0), 200, 255);
+
+    if (toSet(dot.getConnexities()) != pixels || toSet(dot.getEdges()) != edges ||
+        dot.getEdges().size() != edges.size() || dot.getConnexities().size() != pixels.size()) {
+      std::cerr << name << ": " << dot.getConnexities().size() << " pixels and " << dot.getEdges().size()
+                << " edges instead of " << pixels.size() << " and " << edges.size() << std::endl;
+      return false;
+    }
+    if (dot.m00 != m00 || dot.m10 != m10 || dot.m01 != m01 || dot.m11 != m11 || dot.m20 != m20 || dot.m02 != m02 ||
+        std::fabs(dot.getCog().get_u() - m10 / m00) > 1e-9 || std::fabs(dot.getCog().get_v() - m01 / m00) > 1e-9) {
+      std::cerr << name << ": wrong moments" << std::endl;
+      return false;
+    }
+    std::cout << name << ": ok, " << pixels.size() << " pixels, " << edges.size() << " edges" << std::endl;
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+    // A ring with a spiral arm and pixels only connected by their corners
+    vpImage<unsigned char> I(120, 160, 0);
+    for (unsigned int i = 0; i < I.getHeight(); i++) {
+      for (unsigned int j = 0; j < I.getWidth(); j++) {
+        const double r = sqrt(vpMath::sqr(i - 60.0) + vpMath::sqr(j - 70.0));
+        const double theta = atan2(i - 60.0, j - 70.0);
+        if ((r > 20 && r < 35) || (r > 35 && r < 55 && std::fabs(r - 35 - 3 * (theta + M_PI)) < 2)) {
+          I[i][j] = 220 + (unsigned char) ((i + j) % 30);
+        }
+      }
+    }
+    for (unsigned int k = 0; k < 3; k++) {
+      for (unsigned int j = 0; j < 6; j++) {
+        I[5 + k][130 + 6 * k + j] = 255;
+      }
+    }
+    // The dot touches the image border
+    for (unsigned int i = 0; i < I.getHeight(); i++) {
+      for (unsigned int j = 150; j < I.getWidth(); j++) {
+        I[i][j] = 250;
+      }
+    }
+
+    if (!checkDot("Ring 4-connexity", I, 60, 95, false) || !checkDot("Ring 8-connexity", I, 60, 95, true) ||
+        !checkDot("Diagonal 4-connexity", I, 5, 130, false) || !checkDot("Diagonal 8-connexity", I, 5, 130, true) ||
+        !checkDot("Image border", I, 100, 155, false)) {
+      return EXIT_FAILURE;
+    }
+
+    // A dot of more than 1 million pixels in a 4 Mpixels image
+    const unsigned int width = 2304, height = 1728;
+    const double radius = 600;
+    vpImage<unsigned char> Ibig(height, width, 30);
+    double nbPixels = 0;
+    for (unsigned int i = 0; i < height; i++) {
+      for (unsigned int j = 0; j < width; j++) {
+        if (vpMath::sqr(i - 900.0) + vpMath::sqr(j - 1100.0) < radius * radius) {
+          Ibig[i][j] = 240;
+          nbPixels++;
+        }
+      }
+    }
+
+    vpDot dot;
+    dot.setMaxDotSize(0.5);
+    dot.setComputeMoments(true);
+    double t = vpTime::measureTimeMs();
+    dot.initTracking(Ibig, vpImagePoint(900, 1100));
+    const unsigned int nbIterations = 10;
+    for (unsigned int k = 0; k < nbIterations; k++) {
+      dot.track(Ibig);
+    }
+    t = (vpTime::measureTimeMs() - t) / (nbIterations + 1);
+
+    if (dot.m00 != nbPixels || std::fabs(dot.getCog().get_u() - 1100) > 1e-6 ||
+        std::fabs(dot.getCog().get_v() - 900) > 1e-6) {
+      std::cerr << "Large dot: " << dot.m00 << " pixels instead of " << nbPixels << ", cog " << dot.getCog() << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::cout << "Large dot of " << nbPixels << " pixels tracked in " << t << " ms" << std::endl;
+
+    // The dot is larger than allowed
+    dot.setMaxDotSize(0.1);
+    try {
+      dot.track(Ibig);
+      std::cerr << "A too large dot should throw an exception" << std::endl;
+      return EXIT_FAILURE;
+    } catch(const vpException &e) {
+      std::cout << "Expected exception: " << e.getStringMessage() << std::endl;
+    }
+    // The visited pixels were reset before the exception
+    dot.setMaxDotSize(0.5);
+    dot.initTracking(Ibig, vpImagePoint(900, 1100), 200, 255);
+    if (dot.m00 != nbPixels) {
+      std::cerr << "Wrong dot after an exception: " << dot.m00 << " pixels instead of " << nbPixels << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+  } catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -46,6 +46,7 @@
 #ifndef vpMbEdgeTracker_HH
 #define vpMbEdgeTracker_HH
 
+#include <visp3/core/vpImagePyramid.h>
 #include <visp3/core/vpPoint.h>
 #include <visp3/mbt/vpMbTracker.h>
 #include <visp3/me/vpMe.h>
@@ -296,6 +297,9 @@ class VISP_EXPORT vpMbEdgeTracker: public virtual vpMbTracker
     
     //! Pyramid of image associated to the current image. This pyramid is computed in the init() and in the track() methods.
     std::vector< const vpImage<unsigned char>* > Ipyramid;
+
+    //! Buffers of the pyramid levels pointed by Ipyramid, kept from one frame to the next.
+    vpImagePyramid m_imagePyramid;
     
     //! Current scale level used. This attribute must not be modified outside of the downScale() and upScale() methods, as it used to specify to some methods which set of distanceLine use. 
     unsigned int scaleLevel;
@@ -474,6 +478,7 @@ public:
   void setUseEdgeTracking(const std::string &name, const bool &useEdgeTracking);
 
   void track(const vpImage<unsigned char> &I);
+  void track(const vpImagePyramid &pyramid);
   //@}
 
 protected:
@@ -485,6 +490,7 @@ protected:
   void addLine(vpPoint &p1, vpPoint &p2, int polygon = -1, std::string name = "");
   void addPolygon(vpMbtPolygon &p);
 
+  void buildPyramid(const vpImage<unsigned char>& _I);
   void cleanPyramid(std::vector<const vpImage<unsigned char>* >& _pyramid);
   void computeProjectionError(const vpImage<unsigned char>& _I);
 
@@ -510,6 +516,7 @@ protected:
   unsigned int initMbtTracking(unsigned int &nberrors_lines, unsigned int &nberrors_cylinders, unsigned int &nberrors_circles);
   void initMovingEdge(const vpImage<unsigned char> &I, const vpHomogeneousMatrix &_cMo);
   void initPyramid(const vpImage<unsigned char>& _I, std::vector<const vpImage<unsigned char>* >& _pyramid);
+  void initPyramid(const vpImagePyramid& pyramid, std::vector<const vpImage<unsigned char>* >& _pyramid);
   void reInitLevel(const unsigned int _lvl);
   void reinitMovingEdge(const vpImage<unsigned char> &I, const vpHomogeneousMatrix &_cMo);
   void removeCircle(const std::string& name);
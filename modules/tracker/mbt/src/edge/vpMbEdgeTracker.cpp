@@ -70,7 +70,7 @@
 vpMbEdgeTracker::vpMbEdgeTracker()
   : me(), lines(1), circles(1), cylinders(1), nline(0), ncircle(0), ncylinder(0),
     nbvisiblepolygone(0), percentageGdPt(0.4), scales(1),
-    Ipyramid(0), scaleLevel(0), nbFeaturesForProjErrorComputation(0),
+    Ipyramid(0), m_imagePyramid(1, vpImagePyramid::DECIMATION), scaleLevel(0), nbFeaturesForProjErrorComputation(0),
     m_factor(), m_robustLines(), m_robustCylinders(), m_robustCircles(),
     m_wLines(), m_wCylinders(), m_wCircles(), m_errorLines(), m_errorCylinders(), m_errorCircles(),
     m_L_edge(), m_error_edge(), m_w_edge(), m_weightedError_edge(), m_robust_edge()
@@ -126,7 +126,8 @@ vpMbEdgeTracker::~vpMbEdgeTracker()
     }
     circles[i].clear();
   }
-  cleanPyramid(Ipyramid);
+  // Ipyramid only points to the levels of m_imagePyramid
+  Ipyramid.clear();
 }
 
 /*! 
@@ -1040,7 +1041,31 @@ vpMbEdgeTracker::testTracking()
 void
 vpMbEdgeTracker::track(const vpImage<unsigned char> &I)
 { 
-  initPyramid(I, Ipyramid);
+  m_imagePyramid.setNbLevels((unsigned int)scales.size());
+  m_imagePyramid.build(I);
+
+  track(m_imagePyramid);
+}
+
+/*!
+  Compute each state of the tracking procedure for all the feature sets
+  using an image pyramid that was already built, for example to share it with
+  other trackers working on the same frame.
+
+  Level \e i of the pyramid is used for the scale \e i set with setScales().
+  When the pyramid is computed by track(const vpImage<unsigned char> &), the
+  levels are obtained by a simple subsampling (vpImagePyramid::DECIMATION).
+
+  If the tracking is considered as failed an exception is thrown.
+
+  \param pyramid : Pyramid of the current image. It should have at least
+  as many levels as the number of scales.
+ */
+void
+vpMbEdgeTracker::track(const vpImagePyramid &pyramid)
+{
+  const vpImage<unsigned char> &I = pyramid[0];
+  initPyramid(pyramid, Ipyramid);
   
 //  for (int lvl = ((int)scales.size()-1); lvl >= 0; lvl -= 1)
   unsigned int lvl = (unsigned int)scales.size();
@@ -1143,8 +1168,6 @@ vpMbEdgeTracker::track(const vpImage<unsigned char> &I)
       }
     }
   } while(lvl != 0);
-  
-  cleanPyramid(Ipyramid);
 }
 
 /*!
@@ -1177,7 +1200,7 @@ void vpMbEdgeTracker::init(const vpImage<unsigned char>& I)
   if(clippingFlag > 2)
     cam.computeFov(I.getWidth(), I.getHeight());
   
-  initPyramid(I, Ipyramid);
+  buildPyramid(I);
   visibleFace(I, cMo, a);
   unsigned int i = (unsigned int)scales.size();
 
@@ -1199,8 +1222,6 @@ void vpMbEdgeTracker::init(const vpImage<unsigned char>& I)
       upScale(i);
     }
   } while(i != 0);
-  
-  cleanPyramid(Ipyramid);
 }
 
 /*!
@@ -2694,6 +2715,41 @@ vpMbEdgeTracker::initPyramid(const vpImage<unsigned char>& _I, std::vector< cons
   }
 }
 
+/*!
+  Make the pyramid of image point to the levels of an already built image pyramid.
+  Nothing is allocated, so the pyramid must not be passed to cleanPyramid().
+
+  \param pyramid : The image pyramid. It should have at least as many levels as the number of scales.
+  \param _pyramid : The pyramid of image pointing to the levels of \e pyramid that correspond to an active scale.
+*/
+void
+vpMbEdgeTracker::initPyramid(const vpImagePyramid& pyramid, std::vector< const vpImage<unsigned char>* >& _pyramid)
+{
+  if(pyramid.getNbLevels() < scales.size()){
+    throw vpException(vpException::dimensionError, "The image pyramid has %d levels while %d scales are used",
+                      pyramid.getNbLevels(), (unsigned int)scales.size());
+  }
+
+  _pyramid.resize(scales.size());
+  for(unsigned int i=0; i<_pyramid.size(); i += 1){
+    _pyramid[i] = scales[i] ? &pyramid[i] : NULL;
+  }
+}
+
+/*!
+  Compute the pyramid of the image in parameter in the m_imagePyramid buffers that are
+  kept from one call to the other, and make Ipyramid point to its levels.
+
+  \param _I : The input image.
+*/
+void
+vpMbEdgeTracker::buildPyramid(const vpImage<unsigned char>& _I)
+{
+  m_imagePyramid.setNbLevels((unsigned int)scales.size());
+  m_imagePyramid.build(_I);
+  initPyramid(m_imagePyramid, Ipyramid);
+}
+
 /*!
   Clean the pyramid of image allocated with the initPyramid() method. The vector
   has a size equal to zero at the end of the method. 
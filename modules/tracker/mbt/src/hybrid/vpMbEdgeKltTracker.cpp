@@ -82,7 +82,7 @@ vpMbEdgeKltTracker::init(const vpImage<unsigned char>& I)
 {
   vpMbKltTracker::init(I);
 
-  initPyramid(I, Ipyramid);
+  buildPyramid(I);
 
   vpMbEdgeTracker::resetMovingEdge();
 
@@ -95,8 +95,6 @@ vpMbEdgeKltTracker::init(const vpImage<unsigned char>& I)
       upScale(i);
     }
   } while(i != 0);
-
-  cleanPyramid(Ipyramid);
 }
 
 /*!
@@ -121,7 +119,7 @@ vpMbEdgeKltTracker::setPose( const vpImage<unsigned char> &I, const vpHomogeneou
       faces.computeScanLineRender(cam, I.getWidth(), I.getHeight());
     }
 
-    initPyramid(I, Ipyramid);
+    buildPyramid(I);
 
     unsigned int i = (unsigned int)scales.size();
     do {
@@ -132,8 +130,6 @@ vpMbEdgeKltTracker::setPose( const vpImage<unsigned char> &I, const vpHomogeneou
         upScale(i);
       }
     } while(i != 0);
-
-    cleanPyramid(Ipyramid);
 }
 
 /*!
@@ -4642,7 +4642,7 @@ void vpMbGenericTracker::TrackerWrapper::setPose(const vpImage<unsigned char> &I
 
 #if 0
   if (m_trackerType & EDGE_TRACKER) {
-    initPyramid(I, Ipyramid);
+    buildPyramid(I);
 
     unsigned int i = (unsigned int) scales.size();
     do {
@@ -4653,8 +4653,6 @@ void vpMbGenericTracker::TrackerWrapper::setPose(const vpImage<unsigned char> &I
         upScale(i);
       }
     } while(i != 0);
-
-    cleanPyramid(Ipyramid);
   }
 #else
   if (m_trackerType & EDGE_TRACKER)
@@ -51,6 +51,7 @@
 #include <visp3/tt/vpTemplateTrackerZone.h>
 #include <visp3/tt/vpTemplateTrackerWarp.h>
 #include <visp3/core/vpImageFilter.h>
+#include <visp3/core/vpImagePyramid.h>
 
 /*!
   \class vpTemplateTracker
@@ -87,6 +88,9 @@ class VISP_EXPORT vpTemplateTracker
     vpTemplateTrackerZone               *zoneTrackedPyr;
 
     vpImage<unsigned char>     *pyr_IDes;
+    vpImagePyramid              pyr_I; // Pyramid of the current image, kept between two calls to track()
+    std::vector< vpImage<unsigned char> > pyr_Icv; // Levels of the current image computed with cv::pyrDown()
+    std::vector<const vpImage<unsigned char> *> pyr_Ilevels; // Levels of the pyramid being tracked
 
     vpMatrix                    H;
     vpMatrix                    Hdesire;
@@ -167,7 +171,7 @@ class VISP_EXPORT vpTemplateTracker
         ptTemplateInit(false), templateSize(0), templateSizePyr(NULL), ptTemplateSelect(NULL),
         ptTemplateSelectPyr(NULL), ptTemplateSelectInit(false), templateSelectSize(0),
         ptTemplateSupp(NULL), ptTemplateSuppPyr(NULL), ptTemplateCompo(NULL), ptTemplateCompoPyr(NULL),
-        zoneTracked(NULL), zoneTrackedPyr(NULL), pyr_IDes(NULL), H(), Hdesire(), HdesirePyr(NULL),
+        zoneTracked(NULL), zoneTrackedPyr(NULL), pyr_IDes(NULL), pyr_I(), H(), Hdesire(), HdesirePyr(NULL),
         HLM(), HLMdesire(), HLMdesirePyr(NULL), HLMdesireInverse(), HLMdesireInversePyr(NULL),
         G(), gain(0), thresholdGradient(0), costFunctionVerification(false),
         blur(false), useBrent(false), nbIterBrent(0), taillef(0), fgG(NULL), fgdG(NULL),
@@ -254,6 +258,7 @@ class VISP_EXPORT vpTemplateTracker
     void    setUseBrent(bool b){useBrent = b;}
 
     void    track(const vpImage<unsigned char> &I);
+    void    track(const vpImagePyramid &pyramid);
     void    trackRobust(const vpImage<unsigned char> &I);
 
   protected:
@@ -268,6 +273,8 @@ class VISP_EXPORT vpTemplateTracker
     virtual void    initTrackingPyr(const vpImage<unsigned char>& I,vpTemplateTrackerZone &zone);
     virtual void    trackNoPyr(const vpImage<unsigned char> &I) = 0;
     virtual void    trackPyr(const vpImage<unsigned char> &I);
+    virtual void    trackPyr(const vpImagePyramid &pyramid);
+    void            trackPyrLevels(const std::vector<const vpImage<unsigned char> *> &pyramid);
 };
 #endif
 
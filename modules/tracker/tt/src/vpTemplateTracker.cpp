@@ -47,7 +47,7 @@ vpTemplateTracker::vpTemplateTracker(vpTemplateTrackerWarp *_warp)
     ptTemplateSelect(NULL), ptTemplateSelectPyr(NULL), ptTemplateSelectInit(false),
     templateSelectSize(0), ptTemplateSupp(NULL), ptTemplateSuppPyr(NULL),
     ptTemplateCompo(NULL), ptTemplateCompoPyr(NULL), zoneTracked(NULL), zoneTrackedPyr(NULL),
-    pyr_IDes(NULL), H(), Hdesire(), HdesirePyr(), HLM(), HLMdesire(), HLMdesirePyr(),
+    pyr_IDes(NULL), pyr_I(), pyr_Icv(), pyr_Ilevels(), H(), Hdesire(), HdesirePyr(), HLM(), HLMdesire(), HLMdesirePyr(),
     HLMdesireInverse(), HLMdesireInversePyr(), G(), gain(1.), thresholdGradient(40),
     costFunctionVerification(false), blur(true), useBrent(false), nbIterBrent(3),
     taillef(7), fgG(NULL), fgdG(NULL), ratioPixelIn(0), mod_i(1), mod_j(1), nbParam(0),
@@ -822,14 +822,65 @@ void vpTemplateTracker::track(const vpImage<unsigned char> &I)
     trackNoPyr(I);
 }
 
+/*!
+   Track the template using an image pyramid that was already built, for example
+   to share it with other trackers working on the same image.
+   \param pyramid: Pyramid of the image to process, built with the vpImagePyramid::GAUSSIAN_FILTER
+   filter. It should have at least as many levels as set with setPyramidal().
+
+   \warning When ViSP is built with OpenCV, the pyramid of the template and the one computed by
+   track(const vpImage<unsigned char> &) rely on cv::pyrDown() through vpImageFilter::getGaussPyramidal().
+   Since its border handling differs from vpImagePyramid, the result may slightly differ from the one
+   of track(const vpImage<unsigned char> &).
+ */
+void vpTemplateTracker::track(const vpImagePyramid &pyramid)
+{
+  if (nbLvlPyr > 1)
+    trackPyr(pyramid);
+  else
+    trackNoPyr(pyramid[0]);
+}
+
 void vpTemplateTracker::trackPyr(const vpImage<unsigned char> &I)
 {
   //vpTRACE("trackPyr");
-  vpImage<unsigned char> *pyr_I;
-//  pyr_I=new vpImage<unsigned char>[nbLvlPyr+1]; // Why +1 ?
-  pyr_I=new vpImage<unsigned char>[nbLvlPyr]; // Why +1 ?
-  pyr_I[0]=I;
+  pyr_Ilevels.resize(nbLvlPyr);
+  pyr_Ilevels[0] = &I;
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+  // Same filter as the one used for the pyramid of the template, based on cv::pyrDown()
+  pyr_Icv.resize(nbLvlPyr);
+  for (unsigned int i = 1; i < nbLvlPyr; i++) {
+    vpImageFilter::getGaussPyramidal(*pyr_Ilevels[i-1], pyr_Icv[i]);
+    pyr_Ilevels[i] = &pyr_Icv[i];
+  }
+#else
+  pyr_I.setNbLevels(nbLvlPyr);
+  pyr_I.build(I);
+  for (unsigned int i = 1; i < nbLvlPyr; i++) {
+    pyr_Ilevels[i] = &pyr_I[i];
+  }
+#endif
 
+  trackPyrLevels(pyr_Ilevels);
+}
+
+void vpTemplateTracker::trackPyr(const vpImagePyramid &pyramid)
+{
+  if (pyramid.getNbLevels() < nbLvlPyr) {
+    throw(vpTrackingException(vpTrackingException::badValue, "The image pyramid has %d levels while %d are used",
+                              pyramid.getNbLevels(), nbLvlPyr));
+  }
+
+  pyr_Ilevels.resize(nbLvlPyr);
+  for (unsigned int i = 0; i < nbLvlPyr; i++) {
+    pyr_Ilevels[i] = &pyramid[i];
+  }
+
+  trackPyrLevels(pyr_Ilevels);
+}
+
+void vpTemplateTracker::trackPyrLevels(const std::vector<const vpImage<unsigned char> *> &pyramid)
+{
   try
   {
       vpColVector ptemp(nbParam);
@@ -841,7 +892,6 @@ void vpTemplateTracker::trackPyr(const vpImage<unsigned char> &I)
     //    p_sauv[0]=p;
         for(unsigned int i=1;i<nbLvlPyr;i++)
         {
-          vpImageFilter::getGaussPyramidal(pyr_I[i-1],pyr_I[i]);
           //test getParamPyramidDown
           /*vpColVector vX_test(2);vX_test[0]=15.;vX_test[1]=30.;
           vpColVector vX_test2(2);
@@ -879,7 +929,7 @@ void vpTemplateTracker::trackPyr(const vpImage<unsigned char> &I)
             HLM=HLMdesirePyr[i];
             HLMdesireInverse=HLMdesireInversePyr[i];
     //        zoneTracked=&zoneTrackedPyr[i];
-            trackRobust(pyr_I[i]);
+            trackRobust(*pyramid[(size_t)i]);
           }
           //std::cout<<"get p up"<<std::endl;
     //      ptemp=p_sauv[i-1];
@@ -917,12 +967,10 @@ void vpTemplateTracker::trackPyr(const vpImage<unsigned char> &I)
       else
       {
         //std::cout<<"reviens a tracker de base"<<std::endl;
-        trackRobust(I);
+        trackRobust(*pyramid[0]);
       }
-      delete[] pyr_I;
   }
   catch(vpException &e){
-      delete[] pyr_I;
       throw(vpTrackingException(vpTrackingException::badValue, e.getMessage()));
   }
 }
@@ -144,6 +144,8 @@ public:
 
   //! Set the gain for the virtual visual servoing algorithm.
   static double getLambda(){return gain;}
+  //! Get the number of threads used to compute the interaction matrices of the images.
+  static unsigned int getNbThreads(){return nbThreads;}
 
   //!get the residual in pixels
   double getResidual(void) const {return residual;}
@@ -161,6 +163,12 @@ public:
 
   //!set the gain for the virtual visual servoing algorithm 
   static void setLambda(const double &lambda){gain = lambda;}
+  /*!
+    Set the number of threads used by computeCalibrationMulti() to compute the
+    interaction matrix and the error of each image. Only used when ViSP is built
+    with OpenMP. By default, 1 thread is used.
+  */
+  static void setNbThreads(const unsigned int nb){nbThreads = (nb > 0) ? nb : 1;}
   int writeData(const char *filename) ;
 
 private:
@@ -199,6 +207,7 @@ private:
   static double threshold;
   static unsigned int nbIterMax;
   static double gain;
+  static unsigned int nbThreads;
 
 } ;
 
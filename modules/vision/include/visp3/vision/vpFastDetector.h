@@ -0,0 +1,181 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * FAST-9 corner detector.
+ *
+ *****************************************************************************/
+
+#ifndef __vpFastDetector_h__
+#define __vpFastDetector_h__
+
+/*!
+  \file vpFastDetector.h
+  \brief FAST-9 corner detector that does not require OpenCV.
+*/
+
+#include <vector>
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpImagePoint.h>
+#include <visp3/core/vpImagePyramid.h>
+
+/*!
+  \class vpFastKeyPoint
+  \ingroup group_vision_keypoints
+
+  \brief Keypoint detected by vpFastDetector and described by vpOrbExtractor.
+*/
+class VISP_EXPORT vpFastKeyPoint
+{
+public:
+  vpFastKeyPoint() : u(0), v(0), response(0), angle(-1), size(0), octave(0) {}
+  vpFastKeyPoint(const double u_, const double v_, const double response_, const double size_, const unsigned int octave_)
+    : u(u_), v(v_), response(response_), angle(-1), size(size_), octave(octave_) {}
+
+  /*! Return the keypoint location in the full resolution image. */
+  inline vpImagePoint getImagePoint() const { return vpImagePoint(v, u); }
+
+  //! Column coordinate in the full resolution image
+  double u;
+  //! Row coordinate in the full resolution image
+  double v;
+  //! Corner score, the higher the stronger
+  double response;
+  //! Orientation in degrees in [0 ; 360[, or -1 if not computed
+  double angle;
+  //! Diameter of the neighbourhood used for the description, in full resolution pixels
+  double size;
+  //! Pyramid level where the keypoint was detected
+  unsigned int octave;
+};
+
+/*!
+  \class vpFastDetector
+  \ingroup group_vision_keypoints
+
+  \brief FAST-9 corner detector with non-maximum suppression.
+
+  A pixel is a corner when at least 9 contiguous pixels of the Bresenham circle of
+  radius 3 around it are all brighter, or all darker, than the central pixel by
+  more than a threshold \cite Rosten06. The corner response is the sum of the
+  absolute differences above the threshold on the brighter or the darker arc.
+
+  Corners can be searched over several levels of a vpImagePyramid to get keypoints
+  that can be matched across scales. The class does not require OpenCV; it can be
+  selected in vpKeyPoint with the "vpFAST" detector name.
+
+  \code
+#include <visp3/vision/vpFastDetector.h>
+#include <visp3/vision/vpOrbExtractor.h>
+#include <visp3/vision/vpHammingMatcher.h>
+
+int main()
+{
+  vpImage<unsigned char> Iref, Icur;
+  // ... read the images
+
+  vpFastDetector detector;
+  detector.setNbLevels(3);
+  vpOrbExtractor extractor;
+  vpHammingMatcher matcher;
+  matcher.setRatioTest(0.8);
+
+  std::vector<vpFastKeyPoint> kptsRef, kptsCur;
+  vpArray2D<unsigned char> descRef, descCur;
+  detector.detect(Iref, kptsRef);
+  extractor.compute(Iref, kptsRef, descRef);
+  detector.detect(Icur, kptsCur);
+  extractor.compute(Icur, kptsCur, descCur);
+
+  std::vector<vpHammingMatch> matches;
+  matcher.match(descCur, descRef, matches);
+}
+  \endcode
+*/
+class VISP_EXPORT vpFastDetector
+{
+public:
+  vpFastDetector(const int threshold=20, const bool nonMaxSuppression=true);
+  virtual ~vpFastDetector() {}
+
+  void detect(const vpImage<unsigned char> &I, std::vector<vpFastKeyPoint> &keyPoints);
+  void detect(const vpImagePyramid &pyramid, std::vector<vpFastKeyPoint> &keyPoints);
+
+  /*! Return the maximum number of keypoints kept, 0 if there is no limit. */
+  inline unsigned int getMaxFeatures() const { return m_maxFeatures; }
+  /*! Return the number of pyramid levels used for the detection. */
+  inline unsigned int getNbLevels() const { return m_nbLevels; }
+  /*! Return the number of threads used for the detection. */
+  inline unsigned int getNbThreads() const { return m_nbThreads; }
+  /*! Return the intensity difference threshold of the segment test. */
+  inline int getThreshold() const { return m_threshold; }
+  /*! Return true if the non-maximum suppression is enabled. */
+  inline bool getNonMaxSuppression() const { return m_nonMaxSuppression; }
+
+  /*!
+    Set the maximum number of keypoints kept over all the levels. The keypoints with
+    the highest response are kept. 0 means no limit.
+  */
+  inline void setMaxFeatures(const unsigned int maxFeatures) { m_maxFeatures = maxFeatures; }
+  void setNbLevels(const unsigned int nbLevels);
+  /*!
+    Set the number of threads used to compute the corner responses. It is only taken
+    into account when ViSP is built with OpenMP.
+  */
+  inline void setNbThreads(const unsigned int nbThreads) { m_nbThreads = nbThreads > 0 ? nbThreads : 1; }
+  /*! Enable or disable the 3x3 non-maximum suppression of the corner responses. */
+  inline void setNonMaxSuppression(const bool enable) { m_nonMaxSuppression = enable; }
+  /*! Set the intensity difference threshold of the segment test. */
+  inline void setThreshold(const int threshold) { m_threshold = threshold; }
+
+  static const unsigned int patchSize = 31;
+
+private:
+  void detectLevel(const vpImage<unsigned char> &I, const unsigned int level, std::vector<vpFastKeyPoint> &keyPoints);
+
+  //! Maximum number of keypoints, 0 for no limit
+  unsigned int m_maxFeatures;
+  //! Number of pyramid levels
+  unsigned int m_nbLevels;
+  //! Number of threads
+  unsigned int m_nbThreads;
+  //! Non-maximum suppression flag
+  bool m_nonMaxSuppression;
+  //! Pyramid used when detect() is called on a single image
+  vpImagePyramid m_pyramid;
+  //! Corner responses, kept from one call to the other
+  vpImage<int> m_scores;
+  //! Segment test threshold
+  int m_threshold;
+};
+
+#endif
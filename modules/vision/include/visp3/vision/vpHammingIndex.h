@@ -0,0 +1,160 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Multi-index hashing of binary descriptors.
+ *
+ *****************************************************************************/
+
+
+#ifndef __vpHammingIndex_h__
+#define __vpHammingIndex_h__
+
+/*!
+  \file vpHammingIndex.h
+  \brief Approximate nearest neighbour search of binary descriptors.
+*/
+
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpArray2D.h>
+#include <visp3/core/vpConfig.h>
+#include <visp3/vision/vpHammingMatcher.h>
+
+/*!
+  \class vpHammingIndex
+  \ingroup group_vision_keypoints
+
+  \brief Multi-index hashing \cite Norouzi12 of binary descriptors for sub-linear
+  nearest neighbour search in the Hamming space.
+
+  Each descriptor is split into \f$ m \f$ substrings of 16 bits and each substring
+  indexes a direct-address table. Since two descriptors at a distance \f$ d \f$ have at
+  least one substring at a distance lower or equal to \f$ \lfloor d/m \rfloor \f$, the
+  search probes, for increasing radii \f$ r \f$, all the buckets whose key is at a
+  distance \f$ r \f$ of a query substring. The search stops as soon as the \f$ k \f$-th
+  best distance is lower than \f$ m(r+1) \f$, in which case the result is exact, or when
+  the maximum radius set with setMaxRadius() is reached, which trades recall for speed.
+
+  The index does not copy the descriptors given to build(): they have to stay valid
+  as long as the index is used. The tables can be saved with save() and loaded back
+  with load() to avoid rebuilding them.
+
+  \code
+#include <visp3/vision/vpHammingIndex.h>
+
+int main()
+{
+  vpArray2D<unsigned char> trainDescriptors, queryDescriptors;
+  // ... compute the descriptors, for instance with vpOrbExtractor
+
+  vpHammingIndex index;
+  index.build(trainDescriptors);
+  std::vector<std::vector<vpHammingMatch> > matches;
+  index.knnSearch(queryDescriptors, 2, matches);
+}
+  \endcode
+*/
+class VISP_EXPORT vpHammingIndex
+{
+public:
+  vpHammingIndex();
+  virtual ~vpHammingIndex() {}
+
+  void build(const unsigned char *descriptors, const unsigned int nbDescriptors, const unsigned int descriptorSize);
+  void build(const vpArray2D<unsigned char> &descriptors);
+
+  void clear();
+
+  /*! Return the size in bytes of the indexed descriptors. */
+  inline unsigned int getDescriptorSize() const { return m_descriptorSize; }
+  /*! Return the maximum radius probed in each table. */
+  inline unsigned int getMaxRadius() const { return m_maxRadius; }
+  /*! Return the number of indexed descriptors. */
+  inline unsigned int getNbDescriptors() const { return m_nbDescriptors; }
+  /*! Return the number of threads used to process the query descriptors. */
+  inline unsigned int getNbThreads() const { return m_nbThreads; }
+  /*! Return the number of hash tables, i.e. the number of 16 bits substrings. */
+  inline unsigned int getNbTables() const { return (unsigned int) m_tables.size(); }
+
+  /*! Return true if the index was built or loaded. */
+  inline bool isBuilt() const { return m_descriptors != NULL; }
+
+  void knnSearch(const unsigned char *query, const unsigned int nbQuery, const unsigned int k,
+                 std::vector<std::vector<vpHammingMatch> > &matches) const;
+  void knnSearch(const vpArray2D<unsigned char> &query, const unsigned int k,
+                 std::vector<std::vector<vpHammingMatch> > &matches) const;
+
+  void load(std::istream &is, const unsigned char *descriptors, const unsigned int nbDescriptors,
+            const unsigned int descriptorSize);
+  void save(std::ostream &os) const;
+
+  void setMaxRadius(const unsigned int maxRadius);
+  /*!
+    Set the number of threads used to process the query descriptors. It is only taken
+    into account when ViSP is built with OpenMP.
+  */
+  inline void setNbThreads(const unsigned int nbThreads) { m_nbThreads = nbThreads > 0 ? nbThreads : 1; }
+
+private:
+  struct vpHashTable {
+    //! Start of each bucket in ids, 65537 entries
+    std::vector<unsigned int> offsets;
+    //! Descriptor indexes sorted by bucket
+    std::vector<unsigned int> ids;
+  };
+
+  void searchOne(const unsigned char *desc, const unsigned int k, std::vector<unsigned int> &stamps,
+                 const unsigned int stamp, std::vector<vpHammingMatch> &best) const;
+  inline unsigned int substring(const unsigned char *desc, const unsigned int table) const
+  {
+    const unsigned int byte = 2 * table;
+    return byte + 1 < m_descriptorSize ? (unsigned int) desc[byte] | ((unsigned int) desc[byte+1] << 8)
+                                       : (unsigned int) desc[byte];
+  }
+
+  //! Indexed descriptors, not owned
+  const unsigned char *m_descriptors;
+  //! Descriptor size in bytes
+  unsigned int m_descriptorSize;
+  //! Key flip masks sorted by number of set bits, up to m_maxRadius bits
+  std::vector< std::vector<unsigned short> > m_flipMasks;
+  //! Maximum radius probed in each table
+  unsigned int m_maxRadius;
+  //! Number of indexed descriptors
+  unsigned int m_nbDescriptors;
+  //! Number of threads
+  unsigned int m_nbThreads;
+  //! One table per 16 bits substring
+  std::vector<vpHashTable> m_tables;
+};
+
+#endif
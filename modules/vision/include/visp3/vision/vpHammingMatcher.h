@@ -0,0 +1,141 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Brute force Hamming matcher for binary descriptors.
+ *
+ *****************************************************************************/
+
+
+#ifndef __vpHammingMatcher_h__
+#define __vpHammingMatcher_h__
+
+/*!
+  \file vpHammingMatcher.h
+  \brief Brute force Hamming matcher that does not require OpenCV.
+*/
+
+#include <vector>
+
+#include <visp3/core/vpArray2D.h>
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \class vpHammingMatch
+  \ingroup group_vision_keypoints
+
+  \brief Match between a query and a train binary descriptor.
+*/
+class VISP_EXPORT vpHammingMatch
+{
+public:
+  vpHammingMatch() : queryIdx(-1), trainIdx(-1), distance(0) {}
+  vpHammingMatch(const int queryIdx_, const int trainIdx_, const unsigned int distance_)
+    : queryIdx(queryIdx_), trainIdx(trainIdx_), distance(distance_) {}
+
+  //! Index of the query descriptor
+  int queryIdx;
+  //! Index of the train descriptor
+  int trainIdx;
+  //! Hamming distance between the two descriptors
+  unsigned int distance;
+};
+
+/*!
+  \class vpHammingMatcher
+  \ingroup group_vision_keypoints
+
+  \brief Brute force matcher for binary descriptors such as the ones computed by
+  vpOrbExtractor.
+
+  The Hamming distance is computed with the hardware popcount instruction when the
+  CPU supports SSE4.2, on 32 bytes blocks with AVX2 when available, and with a
+  portable bit counting otherwise. The implementation is selected at runtime with
+  vpCPUFeatures. The query descriptors are processed in parallel when ViSP is built
+  with OpenMP.
+
+  A match can be filtered with the ratio test, which rejects a match when the distance
+  to the best train descriptor is not sufficiently smaller than the distance to the
+  second best one, and with the cross check, which keeps a match only when the query
+  descriptor is also the best match of the train descriptor.
+
+  The matcher can be selected in vpKeyPoint with the "vpBruteForce-Hamming" matcher name.
+*/
+class VISP_EXPORT vpHammingMatcher
+{
+public:
+  vpHammingMatcher(const bool crossCheck=false);
+  virtual ~vpHammingMatcher() {}
+
+  void knnMatch(const unsigned char *query, const unsigned int nbQuery, const unsigned char *train,
+                const unsigned int nbTrain, const unsigned int descriptorSize, const unsigned int k,
+                std::vector<std::vector<vpHammingMatch> > &matches);
+  void knnMatch(const vpArray2D<unsigned char> &query, const vpArray2D<unsigned char> &train, const unsigned int k,
+                std::vector<std::vector<vpHammingMatch> > &matches);
+
+  void match(const unsigned char *query, const unsigned int nbQuery, const unsigned char *train,
+             const unsigned int nbTrain, const unsigned int descriptorSize, std::vector<vpHammingMatch> &matches);
+  void match(const vpArray2D<unsigned char> &query, const vpArray2D<unsigned char> &train,
+             std::vector<vpHammingMatch> &matches);
+
+  /*! Return true if the cross check is enabled. */
+  inline bool getCrossCheck() const { return m_crossCheck; }
+  /*! Return the number of threads used to match the query descriptors. */
+  inline unsigned int getNbThreads() const { return m_nbThreads; }
+  /*! Return the ratio used in the ratio test, 1 if the test is disabled. */
+  inline double getRatioTest() const { return m_ratio; }
+
+  /*! Enable or disable the cross check in match(). */
+  inline void setCrossCheck(const bool crossCheck) { m_crossCheck = crossCheck; }
+  /*!
+    Set the number of threads used to match the query descriptors. It is only taken
+    into account when ViSP is built with OpenMP.
+  */
+  inline void setNbThreads(const unsigned int nbThreads) { m_nbThreads = nbThreads > 0 ? nbThreads : 1; }
+  /*!
+    Set the ratio used in match() to keep a match only if the best distance is lower
+    than \e ratio times the second best distance. A ratio greater or equal to 1 disables
+    the test.
+  */
+  inline void setRatioTest(const double ratio) { m_ratio = ratio; }
+
+  static unsigned int distance(const unsigned char *desc1, const unsigned char *desc2,
+                               const unsigned int descriptorSize);
+
+private:
+  //! Cross check flag
+  bool m_crossCheck;
+  //! Number of threads
+  unsigned int m_nbThreads;
+  //! Ratio test threshold
+  double m_ratio;
+};
+
+#endif
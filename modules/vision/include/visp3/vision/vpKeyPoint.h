@@ -56,6 +56,8 @@
 #include <visp3/core/vpPlane.h>
 #include <visp3/core/vpPixelMeterConversion.h>
 #include <visp3/vision/vpPose.h>
+#include <visp3/core/vpMemoryMappedFile.h>
+#include <visp3/vision/vpHammingIndex.h>
 #ifdef VISP_HAVE_MODULE_IO
 #  include <visp3/io/vpImageIo.h>
 #endif
@@ -94,6 +96,11 @@
   So, the classical SIFT and SURF keypoints could be used, as well as ORB, FAST, (etc.) keypoints,
   depending of the version of OpenCV you use.
 
+  The ViSP implementation of the brute force Hamming matcher (vpHammingMatcher) can also be selected with the
+  "vpBruteForce-Hamming" name. From OpenCV 3.0.0, the ViSP implementations of the FAST detector
+  (vpFastDetector) and of the ORB descriptor (vpOrbExtractor) are available with the "vpFAST" and "vpORB"
+  names; they are not available with OpenCV 2.4.x.
+
   \note Due to some patents, SIFT and SURF are packaged in an external module called nonfree module
   in OpenCV version before 3.0.0 and in xfeatures2d from 3.0.0. You have to check you have the
   corresponding module to use SIFT and SURF.
@@ -619,6 +626,11 @@ public:
   /*!
      Get the train descriptors matrix.
 
+     \warning After loadLearningData() of a binary file, the returned matrix does not own its data,
+     which point to the memory-mapped learning file. It is only valid until the next call to
+     loadLearningData(), saveLearningData() or reset(), or until the destruction of this object.
+     Clone it to keep it longer.
+
      \return : Matrix with descriptors values at each row for each train keypoints (or reference keypoints).
    */
   inline cv::Mat getTrainDescriptors() const {
@@ -670,6 +682,17 @@ public:
 
   void saveLearningData(const std::string &filename, const bool binaryMode=false, const bool saveTrainingImages=true);
 
+  /*!
+    Set the maximum radius probed in each table of the index used by the "vpHammingIndex"
+    matcher. A larger radius increases the recall and the matching time, see
+    vpHammingIndex::setMaxRadius().
+
+    \param maxRadius : Maximum radius.
+  */
+  inline void setHammingIndexMaxRadius(const unsigned int maxRadius) {
+    m_hammingIndex.setMaxRadius(maxRadius);
+  }
+
   /*!
     Set if the covariance matrix has to be computed in the Virtual Visual Servoing approach.
 
@@ -814,6 +837,8 @@ public:
        - BruteForce-Hamming
        - BruteForce-Hamming(2)
        - FlannBased
+       - vpBruteForce-Hamming (vpHammingMatcher, cross check set with setUseBruteForceCrossCheck())
+       - vpHammingIndex (approximate search with vpHammingIndex for binary descriptors, see setHammingIndexMaxRadius())
 
      L1 and L2 norms are preferable choices for SIFT and SURF descriptors, NORM_HAMMING should be used with ORB,
      BRISK and BRIEF, NORM_HAMMING2 should be used with ORB when WTA_K==3 or 4.
@@ -963,13 +988,16 @@ public:
     m_useAffineDetection = useAffine;
   }
 
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
   /*!
     Set if cross check method must be used to eliminate some false matches with a brute-force matching method.
+    It is used by the BruteForce matcher with OpenCV 2.4.x and by the vpBruteForce-Hamming matcher with any
+    OpenCV version, only when knn is not used. The cross check is enabled by default.
 
     \param useCrossCheck : True to use cross check, false otherwise
   */
   inline void setUseBruteForceCrossCheck(const bool useCrossCheck) {
+    m_useBruteForceCrossCheck = useCrossCheck;
+#if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
     //Only available with BruteForce and with k=1 (i.e not used with a ratioDistanceThreshold method)
     if(m_matcher != NULL && !m_useKnn && m_matcherName == "BruteForce") {
       m_matcher->set("crossCheck", useCrossCheck);
@@ -977,8 +1005,8 @@ public:
       std::cout << "Warning, you try to set the crossCheck parameter with a BruteForce matcher but knn is enabled";
       std::cout << " (the filtering method uses a ratio constraint)" << std::endl;
     }
-  }
 #endif
+  }
 
   /*!
     Set if we want to match the train keypoints to the query keypoints.
@@ -1048,10 +1076,16 @@ private:
   std::vector<cv::DMatch> m_filteredMatches;
   //! Chosen method of filtering to eliminate false matching.
   vpFilterMatchingType m_filterType;
+  //! Multi-index hashing of the train descriptors, used with the "vpHammingIndex" matcher.
+  vpHammingIndex m_hammingIndex;
+  //! Flag set when m_hammingIndex was built from the current train descriptors.
+  bool m_hammingIndexUpToDate;
   //! Image format to use when saving the training images
   vpImageFormatType m_imageFormat;
   //! List of k-nearest neighbors for each detected keypoints (if the method chosen is based upon on knn).
   std::vector<std::vector<cv::DMatch> > m_knnMatches;
+  //! Memory-mapped learning file whose descriptor block is used in place by m_trainDescriptors.
+  cv::Ptr<vpMemoryMappedFile> m_learningDataFile;
   //! Map descriptor enum type to string.
   std::map<vpFeatureDescriptorType, std::string> m_mapOfDescriptorNames;
   //! Map detector enum type to string.
@@ -1110,11 +1144,9 @@ private:
   std::vector<vpPoint> m_trainVpPoints;
   //! If true, use multiple affine transformations to cober the 6 affine parameters
   bool m_useAffineDetection;
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
   //! If true, some false matches will be eliminate by keeping only pairs (i,j) such that for i-th
   //! query descriptor the j-th descriptor in the matcher’s collection is the nearest and vice versa.
   bool m_useBruteForceCrossCheck;
-#endif
   //! Flag set if a percentage value is used to determine the number of inliers for the Ransac method.
   bool m_useConsensusPercentage;
   //! Flag set if a knn matching method must be used.
@@ -1160,6 +1192,9 @@ private:
     return _Val;
   }
 
+  void releaseLearningDataFile();
+  void updateHammingIndex();
+
 
 #if (VISP_HAVE_OPENCV_VERSION >= 0x030000)
   /*
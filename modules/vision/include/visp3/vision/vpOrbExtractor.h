@@ -0,0 +1,114 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * ORB binary descriptor.
+ *
+ *****************************************************************************/
+
+
+#ifndef __vpOrbExtractor_h__
+#define __vpOrbExtractor_h__
+
+/*!
+  \file vpOrbExtractor.h
+  \brief Oriented BRIEF binary descriptor that does not require OpenCV.
+*/
+
+#include <vector>
+
+#include <visp3/core/vpArray2D.h>
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpImagePyramid.h>
+#include <visp3/vision/vpFastDetector.h>
+
+/*!
+  \class vpOrbExtractor
+  \ingroup group_vision_keypoints
+
+  \brief Oriented BRIEF descriptor \cite Rublee11.
+
+  The orientation of a keypoint is given by the intensity centroid of a disk of
+  radius 15 pixels centred on it. The 256 bits descriptor is then obtained by
+  comparing the sums of 5x5 boxes at pairs of locations drawn once for all from an
+  isotropic Gaussian distribution and rotated by the keypoint orientation. The box
+  sums are read from an integral image computed for each pyramid level, and the
+  rotated patterns are precomputed for 30 orientation bins of 12 degrees.
+
+  The descriptors are 32 bytes long; they can be matched with vpHammingMatcher.
+  The extractor can be selected in vpKeyPoint with the "vpORB" extractor name.
+
+  Keypoints too close to the image border to be described are removed from the
+  list given to compute().
+*/
+class VISP_EXPORT vpOrbExtractor
+{
+public:
+  vpOrbExtractor();
+  virtual ~vpOrbExtractor() {}
+
+  void compute(const vpImage<unsigned char> &I, std::vector<vpFastKeyPoint> &keyPoints,
+               vpArray2D<unsigned char> &descriptors);
+  void compute(const vpImagePyramid &pyramid, std::vector<vpFastKeyPoint> &keyPoints,
+               vpArray2D<unsigned char> &descriptors);
+
+  /*! Return the number of threads used to describe the keypoints. */
+  inline unsigned int getNbThreads() const { return m_nbThreads; }
+  /*!
+    Set the number of threads used to describe the keypoints. It is only taken into
+    account when ViSP is built with OpenMP.
+  */
+  inline void setNbThreads(const unsigned int nbThreads) { m_nbThreads = nbThreads > 0 ? nbThreads : 1; }
+
+  //! Descriptor size in bytes
+  static const unsigned int descriptorSize = 32;
+  //! Distance to the border below which a keypoint cannot be described, in pixels of its pyramid level
+  static const int borderSize = 16;
+
+private:
+  void computeIntegral(const vpImage<unsigned char> &I, vpImage<unsigned int> &integral);
+  double computeOrientation(const vpImage<unsigned char> &I, const int i, const int j) const;
+  void describe(const vpImage<unsigned int> &integral, const int i, const int j, const double angle,
+                unsigned char *desc) const;
+
+  //! Integral images, one per pyramid level
+  std::vector< vpImage<unsigned int> > m_integrals;
+  //! Number of threads
+  unsigned int m_nbThreads;
+  //! Pattern rotated for each orientation bin, (column, row) offsets of the 256 pairs
+  std::vector< std::vector<int> > m_patterns;
+  //! Pyramid used when compute() is called on a single image
+  vpImagePyramid m_pyramid;
+  //! Half width of each line of the disk used for the orientation
+  std::vector<int> m_umax;
+};
+
+#endif
@@ -98,6 +98,14 @@ public:
     CHECK_DEGENERATE_POINTS           = 0x8   /*!< Check for degenerate points during the RANSAC. */
   };
 
+  //! Engines that could be used by poseRansac().
+  typedef enum
+    {
+      RANSAC_UNIFORM_SAMPLING, /*!< Minimal sets drawn uniformly, each hypothesis is scored on all the points. */
+      RANSAC_PROSAC            /*!< Minimal sets drawn from the best quality points first (PROSAC), adaptive number
+                                    of iterations and preemptive scoring of batches of hypotheses. */
+    } vpRansacMethodType;
+
   unsigned int npt;             //!< Number of point used in pose computation
   std::list<vpPoint> listP;     //!< Array of point (use here class vpPoint)
 
@@ -137,6 +145,10 @@ private:
   int nbParallelRansacThreads;
   //! Stop the optimization loop when the residual change (|r-r_prec|) <= epsilon
   double vvsEpsilon;
+  //! Engine used by poseRansac()
+  vpRansacMethodType ransacMethod;
+  //! Quality of each point used to order the PROSAC sampling, the higher the better
+  std::vector<double> ransacQualities;
 
 
   //For parallel RANSAC
@@ -199,6 +211,10 @@ private:
   static vpThread::Return poseRansacImplThread(vpThread::Args arg);
 #endif
 
+  bool poseRansacProsac(const std::vector<vpPoint> &listOfUniquePoints, const std::vector<double> &qualities,
+                        bool (*func)(vpHomogeneousMatrix *), std::vector<unsigned int> &best_consensus,
+                        unsigned int &nbInliers);
+
 
 protected:
   double computeResidualDementhon(const vpHomogeneousMatrix &cMo) ;
@@ -253,6 +269,33 @@ public:
     }
   }
   void setRansacMaxTrials(const int &rM){ ransacMaxTrials = rM; }
+  /*!
+    Set the engine used by poseRansac().
+
+    With vpPose::RANSAC_PROSAC, the minimal sets are first drawn among the points of best
+    quality, see setRansacQualities(), and the number of iterations is reduced as soon as
+    the consensus set found ensures with a probability of 0.99 that an outlier-free
+    minimal set was drawn. The hypotheses are generated by batches, in parallel when
+    setUseParallelRansac() is enabled and ViSP is built with OpenMP, and scored on
+    successive blocks of points, only the best half of the batch being kept after each
+    block \cite Nister05. The reprojection errors are computed with SSE2 when available.
+
+    \param method : RANSAC engine, vpPose::RANSAC_UNIFORM_SAMPLING by default.
+  */
+  inline void setRansacMethod(const vpRansacMethodType &method) { ransacMethod = method; }
+  /*!
+    Get the engine used by poseRansac().
+  */
+  inline vpRansacMethodType getRansacMethod() const { return ransacMethod; }
+  /*!
+    Set the quality of each point, for instance the inverse of the descriptor distance of a
+    keypoint match, used by vpPose::RANSAC_PROSAC to draw the best points first \cite Chum05.
+    When no quality is given, the points are supposed to be added by decreasing quality.
+
+    \param qualities : One value per point, in the order of addPoint(), the higher the better.
+    It is cleared by clearPoint().
+  */
+  inline void setRansacQualities(const std::vector<double> &qualities) { ransacQualities = qualities; }
   unsigned int getRansacNbInliers() const { return (unsigned int) ransacInliers.size(); }
   std::vector<unsigned int> getRansacInlierIndex() const{ return ransacInlierIndex; }
   std::vector<vpPoint> getRansacInliers() const{ return ransacInliers; }
@@ -0,0 +1,118 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Least squares solver for multi-view problems with shared parameters.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpSchurSolver.h
+  \brief Least squares solver for multi-view problems with shared parameters.
+*/
+
+#ifndef vpSchurSolver_h
+#define vpSchurSolver_h
+
+#include <vector>
+
+#include <visp3/core/vpColVector.h>
+#include <visp3/core/vpMatrix.h>
+
+/*!
+  \class vpSchurSolver
+
+  \ingroup group_vision_calib
+
+  \brief Least squares solution of a system whose unknowns are a 6 dof velocity
+  per view and a set of parameters shared by all the views, like the intrinsic
+  parameters in a multi-image calibration.
+
+  The interaction matrix of the whole system is sparse: the rows of a view only
+  depend on the velocity of this view and on the shared parameters.
+  \f[
+  {\bf L} = \left[\begin{array}{cccc}
+  {\bf L}_{v,1} & & {\bf 0} & {\bf L}_{s,1} \\
+  & \ddots & & \vdots \\
+  {\bf 0} & & {\bf L}_{v,n} & {\bf L}_{s,n}
+  \end{array}\right]
+  \f]
+  Instead of the pseudo inverse of \f$ \bf L \f$, whose cost grows with the
+  cube of the number of views, the normal equations are built view by view and
+  the velocities are eliminated with the Schur complement of their 6 by 6
+  blocks. The cost is then linear in the number of views.
+
+  The views can be set from several threads as long as each thread sets
+  different views:
+  \code
+  vpSchurSolver solver(nbViews, 4);
+  #pragma omp parallel for
+  for (int i = 0; i < nbViews; i++) {
+    // Lv: 6 columns, Ls: 4 columns, e: error of the view
+    solver.setView(i, Lv, Ls, e);
+  }
+  std::vector<vpColVector> v;
+  vpColVector s;
+  solver.solve(v, s);
+  \endcode
+
+  Without shared parameters, the views are independent and solve() gives the
+  least squares velocity of each view, as the pseudo inverse of \f$ {\bf L}_{v,i}
+  \f$ does.
+
+  \warning Only the Gauss-Newton step is provided: the normal equations are not
+  damped and there is no Levenberg-Marquardt update. As in
+  vpCalibration::calibVVSMulti(), the caller applies the step with a gain and
+  checks the convergence of the residual.
+*/
+class VISP_EXPORT vpSchurSolver
+{
+public:
+  vpSchurSolver();
+  vpSchurSolver(const unsigned int nbViews, const unsigned int nbShared);
+
+  /*! Return the number of views. */
+  inline unsigned int getNbViews() const { return (unsigned int) m_U.size(); }
+  /*! Return the number of parameters shared by the views. */
+  inline unsigned int getNbShared() const { return m_nbShared; }
+
+  void init(const unsigned int nbViews, const unsigned int nbShared);
+  void setView(const unsigned int view, const vpMatrix &Lv, const vpMatrix &Ls, const vpColVector &e);
+  void solve(std::vector<vpColVector> &v, vpColVector &s) const;
+
+private:
+  unsigned int m_nbShared;
+  //! Blocks of the normal equations of each view: Lv^T Lv, Lv^T Ls, Ls^T Ls, Lv^T e and Ls^T e
+  std::vector<vpMatrix> m_U, m_W, m_V;
+  std::vector<vpColVector> m_bv, m_bs;
+};
+
+#endif
@@ -52,6 +52,7 @@
 double vpCalibration::threshold = 1e-10f;
 unsigned int vpCalibration::nbIterMax = 4000;
 double vpCalibration::gain = 0.25;
+unsigned int vpCalibration::nbThreads = 1;
 /*!
   Basic initialisation (called by the constructors)
 */
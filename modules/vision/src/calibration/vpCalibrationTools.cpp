@@ -41,9 +41,11 @@
 #include <visp3/core/vpMath.h>
 #include <visp3/vision/vpPose.h>
 #include <visp3/core/vpPixelMeterConversion.h>
+#include <visp3/vision/vpSchurSolver.h>
 
 #include <cmath>    // std::fabs
 #include <limits>   // numeric_limits
+#include <vector>
 
 #undef MAX
 #undef MIN
@@ -374,14 +376,15 @@ vpCalibration::calibVVSMulti(std::vector<vpCalibration> &table_cal,
 {
   std::ios::fmtflags original_flags( std::cout.flags() );
   std::cout.precision(10);
-  unsigned int nbPoint[256]; //number of points by image
-  unsigned int nbPointTotal = 0; //total number of points
   unsigned int nbPose = (unsigned int)table_cal.size();
-  unsigned int nbPose6 = 6*nbPose;
+  std::vector<unsigned int> nbPoint(nbPose); //number of points by image
+  std::vector<unsigned int> firstPoint(nbPose); //indice of the first point of each image
+  unsigned int nbPointTotal = 0; //total number of points
 
   for (unsigned int i=0; i<nbPose ; i++)
   {
     nbPoint[i] = table_cal[i].npt;
+    firstPoint[i] = nbPointTotal;
     nbPointTotal += nbPoint[i];
   }
 
@@ -391,14 +394,11 @@ vpCalibration::calibVVSMulti(std::vector<vpCalibration> &table_cal,
                                  "Not enough point to calibrate")) ;
   }
 
-  vpColVector oX(nbPointTotal), cX(nbPointTotal)  ;
-  vpColVector oY(nbPointTotal), cY(nbPointTotal) ;
-  vpColVector oZ(nbPointTotal), cZ(nbPointTotal) ;
+  vpColVector oX(nbPointTotal);
+  vpColVector oY(nbPointTotal);
+  vpColVector oZ(nbPointTotal);
   vpColVector u(nbPointTotal) ;
   vpColVector v(nbPointTotal) ;
-
-  vpColVector P(2*nbPointTotal) ;
-  vpColVector Pd(2*nbPointTotal) ;
   vpImagePoint ip;
 
   unsigned int curPoint = 0 ; //current point indice
@@ -430,6 +430,10 @@ vpCalibration::calibVVSMulti(std::vector<vpCalibration> &table_cal,
   //  double lambda = 0.1 ;
   unsigned int iter = 0 ;
 
+  // The views only share the intrinsic parameters: u0, v0, px, py
+  vpSchurSolver solver;
+  std::vector<double> residualPose(nbPose);
+
   double  residu_1 = 1e12 ;
   double r =1e12-1;
   while (vpMath::equal(residu_1,r,threshold) == false && iter < nbIterMax)
@@ -438,56 +442,39 @@ vpCalibration::calibVVSMulti(std::vector<vpCalibration> &table_cal,
     iter++ ;
     residu_1 = r ;
 
-    double px = cam_est.get_px();
-    double py = cam_est.get_py();
-    double u0 = cam_est.get_u0();
-    double v0 = cam_est.get_v0();
-
-    r = 0 ;
-    curPoint = 0 ; //current point indice
-    for (unsigned int p=0; p<nbPose ; p++)
-    {
-      vpHomogeneousMatrix cMoTmp = table_cal[p].cMo;
-      for (unsigned int i=0 ; i < nbPoint[p]; i++)
-      {
-        unsigned int curPoint2 = 2*curPoint;
-
-        cX[curPoint] = oX[curPoint]*cMoTmp[0][0]+oY[curPoint]*cMoTmp[0][1]
-                       +oZ[curPoint]*cMoTmp[0][2] + cMoTmp[0][3];
-        cY[curPoint] = oX[curPoint]*cMoTmp[1][0]+oY[curPoint]*cMoTmp[1][1]
-                       +oZ[curPoint]*cMoTmp[1][2] + cMoTmp[1][3];
-        cZ[curPoint] = oX[curPoint]*cMoTmp[2][0]+oY[curPoint]*cMoTmp[2][1]
-                       +oZ[curPoint]*cMoTmp[2][2] + cMoTmp[2][3];
-
-        Pd[curPoint2] =   u[curPoint] ;
-        Pd[curPoint2+1] = v[curPoint] ;
-
-        P[curPoint2] =    cX[curPoint]/cZ[curPoint]*px + u0 ;
-        P[curPoint2+1] =  cY[curPoint]/cZ[curPoint]*py + v0 ;
+    const double px = cam_est.get_px();
+    const double py = cam_est.get_py();
+    const double u0 = cam_est.get_u0();
+    const double v0 = cam_est.get_v0();
 
-        r += (vpMath::sqr(P[curPoint2]-Pd[curPoint2])
-               + vpMath::sqr(P[curPoint2+1]-Pd[curPoint2+1])) ;
-        curPoint++;
-      }
-    }
-
-    vpColVector error ;
-    error = P-Pd ;
-    //r = r/nbPointTotal ;
+    solver.init(nbPose, 4);
 
-    vpMatrix L(nbPointTotal*2,nbPose6+4) ;
-    curPoint = 0 ; //current point indice
-    for (unsigned int p=0; p<nbPose ; p++)
+    // Interaction matrix and error of each image
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for num_threads(nbThreads) if(nbThreads > 1) schedule(dynamic)
+#endif
+    for (int p=0; p<(int)nbPose ; p++)
     {
-      unsigned int q = 6*p;
-      for (unsigned int i=0 ; i < nbPoint[p]; i++)
+      const vpHomogeneousMatrix &cMoTmp = table_cal[(size_t)p].cMo;
+      vpMatrix Lv(2*nbPoint[(size_t)p], 6), Ls(2*nbPoint[(size_t)p], 4);
+      vpColVector error(2*nbPoint[(size_t)p]);
+      double rp = 0;
+      for (unsigned int i=0 ; i < nbPoint[(size_t)p]; i++)
       {
-        unsigned int curPoint2 = 2*curPoint;
-        unsigned int curPoint21 = curPoint2 + 1;
+        const unsigned int k = firstPoint[(size_t)p] + i;
+        const unsigned int i2 = 2*i;
+        const unsigned int i21 = i2 + 1;
 
-        double x = cX[curPoint] ;
-        double y = cY[curPoint] ;
-        double z = cZ[curPoint] ;
+        double x = oX[k]*cMoTmp[0][0]+oY[k]*cMoTmp[0][1]
+                   +oZ[k]*cMoTmp[0][2] + cMoTmp[0][3];
+        double y = oX[k]*cMoTmp[1][0]+oY[k]*cMoTmp[1][1]
+                   +oZ[k]*cMoTmp[1][2] + cMoTmp[1][3];
+        double z = oX[k]*cMoTmp[2][0]+oY[k]*cMoTmp[2][1]
+                   +oZ[k]*cMoTmp[2][2] + cMoTmp[2][3];
+
+        error[i2] =  x/z*px + u0 - u[k] ;
+        error[i21] = y/z*py + v0 - v[k] ;
+        rp += vpMath::sqr(error[i2]) + vpMath::sqr(error[i21]) ;
 
         double inv_z = 1/z;
 
@@ -497,65 +484,56 @@ vpCalibration::calibVVSMulti(std::vector<vpCalibration> &table_cal,
         //---------------
         {
           {
-            L[curPoint2][q] =  px * (-inv_z) ;
-            L[curPoint2][q+1] =  0 ;
-            L[curPoint2][q+2] =  px*(X*inv_z) ;
-            L[curPoint2][q+3] =  px*X*Y ;
-            L[curPoint2][q+4] =  -px*(1+X*X) ;
-            L[curPoint2][q+5] =  px*Y ;
+            Lv[i2][0] =  px * (-inv_z) ;
+            Lv[i2][1] =  0 ;
+            Lv[i2][2] =  px*(X*inv_z) ;
+            Lv[i2][3] =  px*X*Y ;
+            Lv[i2][4] =  -px*(1+X*X) ;
+            Lv[i2][5] =  px*Y ;
           }
           {
-            L[curPoint2][nbPose6]= 1 ;
-            L[curPoint2][nbPose6+1]= 0 ;
-            L[curPoint2][nbPose6+2]= X ;
-            L[curPoint2][nbPose6+3]= 0;
+            Ls[i2][0]= 1 ;
+            Ls[i2][1]= 0 ;
+            Ls[i2][2]= X ;
+            Ls[i2][3]= 0;
           }
           {
-            L[curPoint21][q] = 0 ;
-            L[curPoint21][q+1] = py*(-inv_z) ;
-            L[curPoint21][q+2] = py*(Y*inv_z) ;
-            L[curPoint21][q+3] = py* (1+Y*Y) ;
-            L[curPoint21][q+4] = -py*X*Y ;
-            L[curPoint21][q+5] = -py*X ;
+            Lv[i21][0] = 0 ;
+            Lv[i21][1] = py*(-inv_z) ;
+            Lv[i21][2] = py*(Y*inv_z) ;
+            Lv[i21][3] = py* (1+Y*Y) ;
+            Lv[i21][4] = -py*X*Y ;
+            Lv[i21][5] = -py*X ;
           }
           {
-            L[curPoint21][nbPose6]= 0 ;
-            L[curPoint21][nbPose6+1]= 1 ;
-            L[curPoint21][nbPose6+2]= 0;
-            L[curPoint21][nbPose6+3]= Y ;
+            Ls[i21][0]= 0 ;
+            Ls[i21][1]= 1 ;
+            Ls[i21][2]= 0;
+            Ls[i21][3]= Y ;
           }
 
         }
-        curPoint++;
       }    // end interaction
+      residualPose[(size_t)p] = rp;
+      solver.setView((unsigned int)p, Lv, Ls, error);
     }
-    vpMatrix Lp ;
-    Lp = L.pseudoInverse(1e-10) ;
-
-    vpColVector e ;
-    e = Lp*error ;
 
-    vpColVector Tc, Tc_v(nbPose6) ;
-    Tc = -e*gain ;
-
-    //   Tc_v =0 ;
-    for (unsigned int i = 0 ; i < nbPose6 ; i++)
-      Tc_v[i] = Tc[i] ;
+    r = 0 ;
+    for (unsigned int p=0; p<nbPose ; p++)
+      r += residualPose[p];
 
-    cam_est.initPersProjWithoutDistortion(px+Tc[nbPose6+2],
-                                      py+Tc[nbPose6+3],
-                                      u0+Tc[nbPose6],
-                                      v0+Tc[nbPose6+1]) ;
+    std::vector<vpColVector> Tc_v;
+    vpColVector Tc_s;
+    solver.solve(Tc_v, Tc_s);
 
-    //    cam.setKd(get_kd() + Tc[10]) ;
-    vpColVector Tc_v_Tmp(6) ;
+    cam_est.initPersProjWithoutDistortion(px-gain*Tc_s[2],
+                                      py-gain*Tc_s[3],
+                                      u0-gain*Tc_s[0],
+                                      v0-gain*Tc_s[1]) ;
 
     for (unsigned int p = 0 ; p < nbPose ; p++)
     {
-      for (unsigned int i = 0 ; i < 6 ; i++)
-        Tc_v_Tmp[i] = Tc_v[6*p + i];
-
-      table_cal[p].cMo = vpExponentialMap::direct(Tc_v_Tmp,1).inverse()
+      table_cal[p].cMo = vpExponentialMap::direct(-gain*Tc_v[p],1).inverse()
                          * table_cal[p].cMo;
     }
 
@@ -834,13 +812,14 @@ vpCalibration::calibVVSWithDistortionMulti(std::vector<vpCalibration> &table_cal
 {
   std::ios::fmtflags original_flags( std::cout.flags() );
   std::cout.precision(10);
-  unsigned int nbPoint[1024]; //number of points by image
-  unsigned int nbPointTotal = 0; //total number of points
   unsigned int nbPose = (unsigned int)table_cal.size();
-  unsigned int nbPose6 = 6*nbPose;
+  std::vector<unsigned int> nbPoint(nbPose); //number of points by image
+  std::vector<unsigned int> firstPoint(nbPose); //indice of the first point of each image
+  unsigned int nbPointTotal = 0; //total number of points
   for (unsigned int i=0; i<nbPose ; i++)
   {
     nbPoint[i] = table_cal[i].npt;
+    firstPoint[i] = nbPointTotal;
     nbPointTotal += nbPoint[i];
   }
 
@@ -851,14 +830,11 @@ vpCalibration::calibVVSWithDistortionMulti(std::vector<vpCalibration> &table_cal
                                  "Not enough point to calibrate")) ;
   }
 
-  vpColVector oX(nbPointTotal), cX(nbPointTotal)  ;
-  vpColVector oY(nbPointTotal), cY(nbPointTotal) ;
-  vpColVector oZ(nbPointTotal), cZ(nbPointTotal) ;
+  vpColVector oX(nbPointTotal);
+  vpColVector oY(nbPointTotal);
+  vpColVector oZ(nbPointTotal);
   vpColVector u(nbPointTotal) ;
   vpColVector v(nbPointTotal) ;
-
-  vpColVector P(4*nbPointTotal) ;
-  vpColVector Pd(4*nbPointTotal) ;
   vpImagePoint ip;
 
   unsigned int curPoint = 0 ; //current point indice
@@ -889,6 +865,10 @@ vpCalibration::calibVVSWithDistortionMulti(std::vector<vpCalibration> &table_cal
   //  double lambda = 0.1 ;
   unsigned int iter = 0 ;
 
+  // The views share the intrinsic parameters: u0, v0, px, py, kdu, kud
+  vpSchurSolver solver;
+  std::vector<double> residualPose(nbPose);
+
   double  residu_1 = 1e12 ;
   double r =1e12-1;
   while (vpMath::equal(residu_1,r,threshold) == false && iter < nbIterMax)
@@ -896,50 +876,43 @@ vpCalibration::calibVVSWithDistortionMulti(std::vector<vpCalibration> &table_cal
     iter++ ;
     residu_1 = r ;
 
-    r = 0 ;
-    curPoint = 0 ; //current point indice
-    for (unsigned int p=0; p<nbPose ; p++)
-    {
-      vpHomogeneousMatrix cMoTmp = table_cal[p].cMo_dist;
-      for (unsigned int i=0 ; i < nbPoint[p]; i++)
-      {
-        cX[curPoint] = oX[curPoint]*cMoTmp[0][0]+oY[curPoint]*cMoTmp[0][1]
-                       +oZ[curPoint]*cMoTmp[0][2] + cMoTmp[0][3];
-        cY[curPoint] = oX[curPoint]*cMoTmp[1][0]+oY[curPoint]*cMoTmp[1][1]
-                       +oZ[curPoint]*cMoTmp[1][2] + cMoTmp[1][3];
-        cZ[curPoint] = oX[curPoint]*cMoTmp[2][0]+oY[curPoint]*cMoTmp[2][1]
-                       +oZ[curPoint]*cMoTmp[2][2] + cMoTmp[2][3];
+    const double px = cam_est.get_px() ;
+    const double py = cam_est.get_py() ;
+    const double u0 = cam_est.get_u0() ;
+    const double v0 = cam_est.get_v0() ;
 
-        curPoint++;
-      }
-    }
-
-
-    vpMatrix L(nbPointTotal*4,nbPose6+6) ;
-    curPoint = 0 ; //current point indice
-    double px = cam_est.get_px() ;
-    double py = cam_est.get_py() ;
-    double u0 = cam_est.get_u0() ;
-    double v0 = cam_est.get_v0() ;
+    const double inv_px = 1/px ;
+    const double inv_py = 1/py ;
 
-    double inv_px = 1/px ;
-    double inv_py = 1/py ;
+    const double kud = cam_est.get_kud() ;
+    const double kdu = cam_est.get_kdu() ;
 
-    double kud = cam_est.get_kud() ;
-    double kdu = cam_est.get_kdu() ;
+    const double k2ud = 2*kud;
+    const double k2du = 2*kdu;
 
-    double k2ud = 2*kud;
-    double k2du = 2*kdu;
+    solver.init(nbPose, 6);
 
-    for (unsigned int p=0; p<nbPose ; p++)
+    // Interaction matrix and error of each image
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for num_threads(nbThreads) if(nbThreads > 1) schedule(dynamic)
+#endif
+    for (int p=0; p<(int)nbPose ; p++)
     {
-      unsigned int q = 6*p;
-      for (unsigned int i=0 ; i < nbPoint[p]; i++)
+      const vpHomogeneousMatrix &cMoTmp = table_cal[(size_t)p].cMo_dist;
+      vpMatrix Lv(4*nbPoint[(size_t)p], 6), Ls(4*nbPoint[(size_t)p], 6);
+      vpColVector error(4*nbPoint[(size_t)p]);
+      double rp = 0;
+      for (unsigned int i=0 ; i < nbPoint[(size_t)p]; i++)
       {
-        unsigned int curPoint4 = 4*curPoint;
-        double x = cX[curPoint] ;
-        double y = cY[curPoint] ;
-        double z = cZ[curPoint] ;
+        const unsigned int k = firstPoint[(size_t)p] + i;
+        const unsigned int i4 = 4*i;
+
+        double x = oX[k]*cMoTmp[0][0]+oY[k]*cMoTmp[0][1]
+                   +oZ[k]*cMoTmp[0][2] + cMoTmp[0][3];
+        double y = oX[k]*cMoTmp[1][0]+oY[k]*cMoTmp[1][1]
+                   +oZ[k]*cMoTmp[1][2] + cMoTmp[1][3];
+        double z = oX[k]*cMoTmp[2][0]+oY[k]*cMoTmp[2][1]
+                   +oZ[k]*cMoTmp[2][2] + cMoTmp[2][3];
 
         double inv_z = 1/z;
         double X =   x*inv_z ;
@@ -949,11 +922,8 @@ vpCalibration::calibVVSWithDistortionMulti(std::vector<vpCalibration> &table_cal
         double Y2 = Y*Y;
         double XY = X*Y;
 
-        double up = u[curPoint] ;
-        double vp = v[curPoint] ;
-
-        Pd[curPoint4] =   up ;
-        Pd[curPoint4+1] = vp ;
+        double up = u[k] ;
+        double vp = v[k] ;
 
         double up0 = up - u0;
         double vp0 = vp - v0;
@@ -967,8 +937,8 @@ vpCalibration::calibVVSWithDistortionMulti(std::vector<vpCalibration> &table_cal
         double r2du = xp02 + yp02 ;
         double kr2du = kdu * r2du;
 
-        P[curPoint4] =   u0 + px*X - kr2du *(up0) ;
-        P[curPoint4+1] = v0 + py*Y - kr2du *(vp0) ;
+        error[i4] =   u0 + px*X - kr2du *(up0) - up ;
+        error[i4+1] = v0 + py*Y - kr2du *(vp0) - vp ;
 
         double r2ud = X2 + Y2 ;
         double kr2ud = 1 + kud * r2ud;
@@ -978,119 +948,107 @@ vpCalibration::calibVVSWithDistortionMulti(std::vector<vpCalibration> &table_cal
         double Ayy = py*(kr2ud+k2ud*Y2);
         double Ayx = py*k2ud*XY;
 
-        Pd[curPoint4+2] = up ;
-        Pd[curPoint4+3] = vp ;
-
-        P[curPoint4+2] = u0 + px*X*kr2ud ;
-        P[curPoint4+3] = v0 + py*Y*kr2ud ;
+        error[i4+2] = u0 + px*X*kr2ud - up ;
+        error[i4+3] = v0 + py*Y*kr2ud - vp ;
 
-        r += (vpMath::sqr(P[curPoint4]-Pd[curPoint4]) +
-             vpMath::sqr(P[curPoint4+1]-Pd[curPoint4+1]) +
-             vpMath::sqr(P[curPoint4+2]-Pd[curPoint4+2]) +
-             vpMath::sqr(P[curPoint4+3]-Pd[curPoint4+3]))*0.5 ;
+        rp += (vpMath::sqr(error[i4]) +
+               vpMath::sqr(error[i4+1]) +
+               vpMath::sqr(error[i4+2]) +
+               vpMath::sqr(error[i4+3]))*0.5 ;
 
-        unsigned int curInd = curPoint4;
+        unsigned int curInd = i4;
         //---------------
         {
           {
-            L[curInd][q] =  px * (-inv_z) ;
-            L[curInd][q+1] =  0 ;
-            L[curInd][q+2] =  px*X*inv_z ;
-            L[curInd][q+3] =  px*X*Y ;
-            L[curInd][q+4] =  -px*(1+X2) ;
-            L[curInd][q+5] =  px*Y ;
+            Lv[curInd][0] =  px * (-inv_z) ;
+            Lv[curInd][1] =  0 ;
+            Lv[curInd][2] =  px*X*inv_z ;
+            Lv[curInd][3] =  px*X*Y ;
+            Lv[curInd][4] =  -px*(1+X2) ;
+            Lv[curInd][5] =  px*Y ;
           }
           {
-            L[curInd][nbPose6]= 1 + kr2du + k2du*xp02  ;
-            L[curInd][nbPose6+1]= k2du*up0*yp0*inv_py ;
-            L[curInd][nbPose6+2]= X + k2du*xp02*xp0 ;
-            L[curInd][nbPose6+3]= k2du*up0*yp02*inv_py ;
-            L[curInd][nbPose6+4] = -(up0)*(r2du) ;
-            L[curInd][nbPose6+5] = 0 ;
+            Ls[curInd][0]= 1 + kr2du + k2du*xp02  ;
+            Ls[curInd][1]= k2du*up0*yp0*inv_py ;
+            Ls[curInd][2]= X + k2du*xp02*xp0 ;
+            Ls[curInd][3]= k2du*up0*yp02*inv_py ;
+            Ls[curInd][4] = -(up0)*(r2du) ;
+            Ls[curInd][5] = 0 ;
           }
             curInd++;
           {
-            L[curInd][q] = 0 ;
-            L[curInd][q+1] = py*(-inv_z) ;
-            L[curInd][q+2] = py*Y*inv_z ;
-            L[curInd][q+3] = py* (1+Y2) ;
-            L[curInd][q+4] = -py*XY ;
-            L[curInd][q+5] = -py*X ;
+            Lv[curInd][0] = 0 ;
+            Lv[curInd][1] = py*(-inv_z) ;
+            Lv[curInd][2] = py*Y*inv_z ;
+            Lv[curInd][3] = py* (1+Y2) ;
+            Lv[curInd][4] = -py*XY ;
+            Lv[curInd][5] = -py*X ;
           }
           {
-            L[curInd][nbPose6]= k2du*xp0*vp0*inv_px ;
-            L[curInd][nbPose6+1]= 1 + kr2du + k2du*yp02;
-            L[curInd][nbPose6+2]= k2du*vp0*xp02*inv_px;
-            L[curInd][nbPose6+3]= Y + k2du*yp02*yp0;
-            L[curInd][nbPose6+4] = -vp0*r2du ;
-            L[curInd][nbPose6+5] = 0 ;
+            Ls[curInd][0]= k2du*xp0*vp0*inv_px ;
+            Ls[curInd][1]= 1 + kr2du + k2du*yp02;
+            Ls[curInd][2]= k2du*vp0*xp02*inv_px;
+            Ls[curInd][3]= Y + k2du*yp02*yp0;
+            Ls[curInd][4] = -vp0*r2du ;
+            Ls[curInd][5] = 0 ;
           }
             curInd++;
   //---undistorted to distorted
           {
-            L[curInd][q] = Axx*(-inv_z) ;
-            L[curInd][q+1] = Axy*(-inv_z) ;
-            L[curInd][q+2] = Axx*(X*inv_z) + Axy*(Y*inv_z) ;
-            L[curInd][q+3] = Axx*X*Y +  Axy*(1+Y2);
-            L[curInd][q+4] = -Axx*(1+X2) - Axy*XY;
-            L[curInd][q+5] = Axx*Y -Axy*X;
+            Lv[curInd][0] = Axx*(-inv_z) ;
+            Lv[curInd][1] = Axy*(-inv_z) ;
+            Lv[curInd][2] = Axx*(X*inv_z) + Axy*(Y*inv_z) ;
+            Lv[curInd][3] = Axx*X*Y +  Axy*(1+Y2);
+            Lv[curInd][4] = -Axx*(1+X2) - Axy*XY;
+            Lv[curInd][5] = Axx*Y -Axy*X;
           }
           {
-            L[curInd][nbPose6]= 1 ;
-            L[curInd][nbPose6+1]= 0 ;
-            L[curInd][nbPose6+2]= X*kr2ud ;
-            L[curInd][nbPose6+3]= 0;
-            L[curInd][nbPose6+4] = 0 ;
-            L[curInd][nbPose6+5] = px*X*r2ud ;
+            Ls[curInd][0]= 1 ;
+            Ls[curInd][1]= 0 ;
+            Ls[curInd][2]= X*kr2ud ;
+            Ls[curInd][3]= 0;
+            Ls[curInd][4] = 0 ;
+            Ls[curInd][5] = px*X*r2ud ;
           }
             curInd++;
           {
-            L[curInd][q] = Ayx*(-inv_z) ;
-            L[curInd][q+1] = Ayy*(-inv_z) ;
-            L[curInd][q+2] = Ayx*(X*inv_z) + Ayy*(Y*inv_z) ;
-            L[curInd][q+3] = Ayx*XY + Ayy*(1+Y2) ;
-            L[curInd][q+4] = -Ayx*(1+X2) -Ayy*XY ;
-            L[curInd][q+5] = Ayx*Y -Ayy*X;
+            Lv[curInd][0] = Ayx*(-inv_z) ;
+            Lv[curInd][1] = Ayy*(-inv_z) ;
+            Lv[curInd][2] = Ayx*(X*inv_z) + Ayy*(Y*inv_z) ;
+            Lv[curInd][3] = Ayx*XY + Ayy*(1+Y2) ;
+            Lv[curInd][4] = -Ayx*(1+X2) -Ayy*XY ;
+            Lv[curInd][5] = Ayx*Y -Ayy*X;
           }
           {
-            L[curInd][nbPose6]= 0 ;
-            L[curInd][nbPose6+1]= 1;
-            L[curInd][nbPose6+2]= 0;
-            L[curInd][nbPose6+3]= Y*kr2ud ;
-            L[curInd][nbPose6+4] = 0 ;
-            L[curInd][nbPose6+5] = py*Y*r2ud ;
+            Ls[curInd][0]= 0 ;
+            Ls[curInd][1]= 1;
+            Ls[curInd][2]= 0;
+            Ls[curInd][3]= Y*kr2ud ;
+            Ls[curInd][4] = 0 ;
+            Ls[curInd][5] = py*Y*r2ud ;
           }
         }  // end interaction
-        curPoint++;
       }    // end interaction
+      residualPose[(size_t)p] = rp;
+      solver.setView((unsigned int)p, Lv, Ls, error);
     }
 
-    vpColVector error ;
-    error = P-Pd ;
-    //r = r/nbPointTotal ;
+    r = 0 ;
+    for (unsigned int p=0; p<nbPose ; p++)
+      r += residualPose[p];
 
-    vpMatrix Lp ;
-    /*double rank =*/
-    L.pseudoInverse(Lp,1e-10) ;
-    vpColVector e ;
-    e = Lp*error ;
-    vpColVector Tc, Tc_v(6*nbPose) ;
-    Tc = -e*gain ;
-    for (unsigned int i = 0 ; i < 6*nbPose ; i++)
-      Tc_v[i] = Tc[i] ;
+    std::vector<vpColVector> Tc_v;
+    vpColVector Tc_s;
+    solver.solve(Tc_v, Tc_s);
 
-    cam_est.initPersProjWithDistortion(  px+Tc[nbPose6+2], py+Tc[nbPose6+3],
-                                     u0+Tc[nbPose6], v0+Tc[nbPose6+1],
-                                     kud + Tc[nbPose6+5],
-                                     kdu + Tc[nbPose6+4]);
+    cam_est.initPersProjWithDistortion(  px-gain*Tc_s[2], py-gain*Tc_s[3],
+                                     u0-gain*Tc_s[0], v0-gain*Tc_s[1],
+                                     kud-gain*Tc_s[5],
+                                     kdu-gain*Tc_s[4]);
 
-    vpColVector Tc_v_Tmp(6) ;
     for (unsigned int p = 0 ; p < nbPose ; p++)
     {
-      for (unsigned int i = 0 ; i < 6 ; i++)
-        Tc_v_Tmp[i] = Tc_v[6*p + i];
-
-      table_cal[p].cMo_dist = vpExponentialMap::direct(Tc_v_Tmp).inverse()
+      table_cal[p].cMo_dist = vpExponentialMap::direct(-gain*Tc_v[p]).inverse()
                             * table_cal[p].cMo_dist;
     }
     if (verbose)
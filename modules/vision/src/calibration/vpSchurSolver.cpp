@@ -0,0 +1,206 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Least squares solver for multi-view problems with shared parameters.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpSchurSolver.cpp
+  \brief Least squares solver for multi-view problems with shared parameters.
+*/
+
+#include <cmath>
+
+#include <visp3/core/vpException.h>
+#include <visp3/vision/vpSchurSolver.h>
+
+namespace {
+  //! Threshold on the singular values of the scaled normal equations
+  const double svThreshold = 1e-14;
+
+  //! Inverse square roots of the diagonal of a normal matrix, to scale its columns
+  vpColVector columnScales(const vpMatrix &H)
+  {
+    vpColVector d(H.getRows());
+    for (unsigned int j = 0; j < H.getRows(); j++)
+      d[j] = (H[j][j] > 0.) ? 1. / sqrt(H[j][j]) : 1.;
+    return d;
+  }
+
+  //! diag(d1) A diag(d2)
+  vpMatrix scale(const vpColVector &d1, const vpMatrix &A, const vpColVector &d2)
+  {
+    vpMatrix B(A.getRows(), A.getCols());
+    for (unsigned int i = 0; i < A.getRows(); i++)
+      for (unsigned int j = 0; j < A.getCols(); j++)
+        B[i][j] = d1[i] * A[i][j] * d2[j];
+    return B;
+  }
+
+  //! diag(d) b
+  vpColVector scale(const vpColVector &d, const vpColVector &b)
+  {
+    vpColVector c(b.size());
+    for (unsigned int i = 0; i < b.size(); i++)
+      c[i] = d[i] * b[i];
+    return c;
+  }
+}
+
+/*!
+  Default constructor, without view. See init().
+*/
+vpSchurSolver::vpSchurSolver()
+  : m_nbShared(0), m_U(), m_W(), m_V(), m_bv(), m_bs()
+{
+}
+
+/*!
+  Constructor.
+
+  \param nbViews : Number of views.
+  \param nbShared : Number of parameters shared by the views, 0 if the views are independent.
+*/
+vpSchurSolver::vpSchurSolver(const unsigned int nbViews, const unsigned int nbShared)
+  : m_nbShared(0), m_U(), m_W(), m_V(), m_bv(), m_bs()
+{
+  init(nbViews, nbShared);
+}
+
+/*!
+  Set the number of views and of shared parameters, and reset the system.
+
+  \param nbViews : Number of views.
+  \param nbShared : Number of parameters shared by the views, 0 if the views are independent.
+*/
+void vpSchurSolver::init(const unsigned int nbViews, const unsigned int nbShared)
+{
+  m_nbShared = nbShared;
+  m_U.assign(nbViews, vpMatrix(6, 6, 0.));
+  m_W.assign(nbViews, vpMatrix(6, nbShared, 0.));
+  m_V.assign(nbViews, vpMatrix(nbShared, nbShared, 0.));
+  m_bv.assign(nbViews, vpColVector(6, 0.));
+  m_bs.assign(nbViews, vpColVector(nbShared, 0.));
+}
+
+/*!
+  Set the rows of a view: \f$ {\bf L}_v {\bf v} + {\bf L}_s {\bf s} = {\bf e} \f$. Only
+  the normal equations of the view are kept. The views that are not set do not
+  constrain the system.
+
+  This method can be called at the same time from several threads for different views.
+
+  \param view : Index of the view.
+  \param Lv : Interaction matrix of the velocity of the view, with 6 columns.
+  \param Ls : Interaction matrix of the shared parameters, with getNbShared() columns.
+  \param e : Error of the view.
+
+  \exception vpException::dimensionError : If the index or the sizes are not valid.
+*/
+void vpSchurSolver::setView(const unsigned int view, const vpMatrix &Lv, const vpMatrix &Ls, const vpColVector &e)
+{
+  if (view >= m_U.size()) {
+    throw(vpException(vpException::dimensionError, "Cannot set view %d of a system of %d views",
+                      view, (unsigned int) m_U.size()));
+  }
+  if (Lv.getCols() != 6 || Lv.getRows() != e.getRows() ||
+      (m_nbShared > 0 && (Ls.getCols() != m_nbShared || Ls.getRows() != e.getRows()))) {
+    throw(vpException(vpException::dimensionError,
+                      "Cannot set a view from a (%dx%d) and a (%dx%d) interaction matrix and an error of size %d",
+                      Lv.getRows(), Lv.getCols(), Ls.getRows(), Ls.getCols(), e.getRows()));
+  }
+
+  Lv.AtA(m_U[view]);
+  m_bv[view] = Lv.t() * e;
+  if (m_nbShared > 0) {
+    m_W[view] = Lv.t() * Ls;
+    Ls.AtA(m_V[view]);
+    m_bs[view] = Ls.t() * e;
+  }
+}
+
+/*!
+  Compute the least squares solution of the system set by setView(), that is the
+  Gauss-Newton step of the views and of the shared parameters.
+
+  The columns of the normal equations are scaled to a unit diagonal, the 6 by 6
+  block of each view is inverted, then the shared parameters are computed from
+  the Schur complement and the velocities of the views are deduced. When the
+  system is of full rank, the solution is the one of the pseudo inverse of the
+  stacked interaction matrix.
+
+  \param v : Velocity of each view.
+  \param s : Shared parameters, empty if there is none.
+*/
+void vpSchurSolver::solve(std::vector<vpColVector> &v, vpColVector &s) const
+{
+  const size_t nbViews = m_U.size();
+
+  vpMatrix V(m_nbShared, m_nbShared, 0.);
+  vpColVector bs(m_nbShared, 0.);
+  for (size_t i = 0; i < nbViews; i++) {
+    V += m_V[i];
+    bs += m_bs[i];
+  }
+  const vpColVector ds = columnScales(V);
+
+  // Elimination of the velocities of the views
+  vpMatrix S = scale(ds, V, ds);
+  vpColVector g = scale(ds, bs);
+  std::vector<vpColVector> dv(nbViews), c(nbViews);
+  std::vector<vpMatrix> Y(nbViews);
+  for (size_t i = 0; i < nbViews; i++) {
+    dv[i] = columnScales(m_U[i]);
+    const vpMatrix Ui = scale(dv[i], m_U[i], dv[i]).pseudoInverse(svThreshold);
+    c[i] = Ui * scale(dv[i], m_bv[i]);
+    if (m_nbShared > 0) {
+      const vpMatrix Wi = scale(dv[i], m_W[i], ds);
+      Y[i] = Ui * Wi;
+      S -= Wi.t() * Y[i];
+      g -= Wi.t() * c[i];
+    }
+  }
+
+  vpColVector s_scaled(m_nbShared, 0.);
+  if (m_nbShared > 0)
+    s_scaled = S.pseudoInverse(svThreshold) * g;
+  s = scale(ds, s_scaled);
+
+  v.resize(nbViews);
+  for (size_t i = 0; i < nbViews; i++) {
+    if (m_nbShared > 0)
+      v[i] = scale(dv[i], c[i] - Y[i] * s_scaled);
+    else
+      v[i] = scale(dv[i], c[i]);
+  }
+}
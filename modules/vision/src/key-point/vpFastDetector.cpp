@@ -0,0 +1,229 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * FAST-9 corner detector.
+ *
+ *****************************************************************************/
+
+#include <algorithm>
+#include <string.h>
+
+#include <visp3/core/vpException.h>
+#include <visp3/vision/vpFastDetector.h>
+
+namespace {
+  //! Bresenham circle of radius 3, (column, row) offsets
+  const int circle[16][2] = {
+    {0, 3}, {1, 3}, {2, 2}, {3, 1}, {3, 0}, {3, -1}, {2, -2}, {1, -3},
+    {0, -3}, {-1, -3}, {-2, -2}, {-3, -1}, {-3, 0}, {-3, 1}, {-2, 2}, {-1, 3}
+  };
+
+  //! True if the 16 bits circular mask contains at least 9 contiguous set bits
+  inline bool hasArc9(const unsigned int mask)
+  {
+    const unsigned int m = mask | (mask << 16);
+    unsigned int x = m;
+    for (unsigned int k = 1; k < 9; k++) {
+      x &= m >> k;
+    }
+    return (x & 0xFFFF) != 0;
+  }
+
+  /*!
+    Segment test at a given pixel. Return 0 if the pixel is not a corner, otherwise
+    the sum of the absolute differences minus the threshold over the brighter or the
+    darker pixels of the circle, whichever is the largest.
+  */
+  inline int cornerScore(const unsigned char *p, const int *offsets, const int threshold)
+  {
+    const int v = *p;
+    const int hi = v + threshold, lo = v - threshold;
+
+    // A 9 pixels arc contains at least two of the four compass pixels
+    const int c0 = p[offsets[0]], c4 = p[offsets[4]], c8 = p[offsets[8]], c12 = p[offsets[12]];
+    const int nbBrighter = (c0 > hi) + (c4 > hi) + (c8 > hi) + (c12 > hi);
+    const int nbDarker = (c0 < lo) + (c4 < lo) + (c8 < lo) + (c12 < lo);
+    if (nbBrighter < 2 && nbDarker < 2) {
+      return 0;
+    }
+
+    unsigned int brighter = 0, darker = 0;
+    int sumBrighter = 0, sumDarker = 0;
+    for (unsigned int k = 0; k < 16; k++) {
+      const int c = p[offsets[k]];
+      if (c > hi) {
+        brighter |= 1u << k;
+        sumBrighter += c - hi;
+      } else if (c < lo) {
+        darker |= 1u << k;
+        sumDarker += lo - c;
+      }
+    }
+
+    int score = 0;
+    if (nbBrighter >= 2 && hasArc9(brighter)) {
+      score = sumBrighter;
+    }
+    if (nbDarker >= 2 && hasArc9(darker)) {
+      score = (std::max)(score, sumDarker);
+    }
+
+    return score;
+  }
+
+  bool compareResponse(const vpFastKeyPoint &kpt1, const vpFastKeyPoint &kpt2)
+  {
+    return kpt1.response > kpt2.response;
+  }
+}
+
+/*!
+  Default constructor.
+
+  \param threshold : Intensity difference threshold of the segment test.
+  \param nonMaxSuppression : If true, only the local maxima of the corner response are kept.
+*/
+vpFastDetector::vpFastDetector(const int threshold, const bool nonMaxSuppression)
+  : m_maxFeatures(0), m_nbLevels(1), m_nbThreads(1), m_nonMaxSuppression(nonMaxSuppression),
+    m_pyramid(1), m_scores(), m_threshold(threshold)
+{
+}
+
+/*!
+  Detect the corners in an image. When more than one level is set with setNbLevels(),
+  a Gaussian pyramid is built internally and the keypoint coordinates are expressed in
+  the full resolution image.
+
+  \param I : Input image.
+  \param keyPoints : Detected keypoints.
+*/
+void vpFastDetector::detect(const vpImage<unsigned char> &I, std::vector<vpFastKeyPoint> &keyPoints)
+{
+  m_pyramid.setNbLevels(m_nbLevels);
+  m_pyramid.setNbThreads(m_nbThreads);
+  m_pyramid.build(I);
+  detect(m_pyramid, keyPoints);
+}
+
+/*!
+  Detect the corners on the levels of an already built pyramid. Only the first
+  getNbLevels() levels are used.
+
+  \param pyramid : Image pyramid, see vpImagePyramid::build().
+  \param keyPoints : Detected keypoints, expressed in the level 0 image.
+*/
+void vpFastDetector::detect(const vpImagePyramid &pyramid, std::vector<vpFastKeyPoint> &keyPoints)
+{
+  keyPoints.clear();
+  if (!pyramid.isBuilt()) {
+    throw vpException(vpException::notInitialized, "The image pyramid is not built");
+  }
+
+  const unsigned int nbLevels = (std::min)(m_nbLevels, pyramid.getNbLevels());
+  for (unsigned int level = 0; level < nbLevels; level++) {
+    detectLevel(pyramid[level], level, keyPoints);
+  }
+
+  if (m_maxFeatures > 0 && keyPoints.size() > m_maxFeatures) {
+    std::stable_sort(keyPoints.begin(), keyPoints.end(), compareResponse);
+    keyPoints.resize(m_maxFeatures);
+  }
+}
+
+void vpFastDetector::detectLevel(const vpImage<unsigned char> &I, const unsigned int level,
+                                 std::vector<vpFastKeyPoint> &keyPoints)
+{
+  const int height = (int) I.getHeight(), width = (int) I.getWidth();
+  if (height < 7 || width < 7) {
+    return;
+  }
+
+  int offsets[16];
+  for (unsigned int k = 0; k < 16; k++) {
+    offsets[k] = circle[k][1] * width + circle[k][0];
+  }
+
+  m_scores.resize(I.getHeight(), I.getWidth());
+  for (int i = 0; i < 3; i++) {
+    memset(m_scores[i], 0, width * sizeof(int));
+    memset(m_scores[height - 1 - i], 0, width * sizeof(int));
+  }
+
+  const int threshold = (std::max)(m_threshold, 0);
+  const unsigned int nbThreads = m_nbThreads;
+  (void) nbThreads;
+#ifdef VISP_HAVE_OPENMP
+  #pragma omp parallel for num_threads(nbThreads) if(nbThreads > 1)
+#endif
+  for (int i = 3; i < height - 3; i++) {
+    const unsigned char *src = I[i];
+    int *score = m_scores[i];
+    score[0] = score[1] = score[2] = 0;
+    score[width-1] = score[width-2] = score[width-3] = 0;
+    for (int j = 3; j < width - 3; j++) {
+      score[j] = cornerScore(src + j, offsets, threshold);
+    }
+  }
+
+  const double scale = (double) (1u << level);
+  for (int i = 3; i < height - 3; i++) {
+    const int *prev = m_scores[i-1], *cur = m_scores[i], *next = m_scores[i+1];
+    for (int j = 3; j < width - 3; j++) {
+      const int s = cur[j];
+      if (s == 0) {
+        continue;
+      }
+
+      // On a plateau, keep the last pixel in raster order
+      if (m_nonMaxSuppression &&
+          (s < prev[j-1] || s < prev[j] || s < prev[j+1] || s < cur[j-1] ||
+           s <= cur[j+1] || s <= next[j-1] || s <= next[j] || s <= next[j+1])) {
+        continue;
+      }
+
+      keyPoints.push_back(vpFastKeyPoint(j * scale, i * scale, s, patchSize * scale, level));
+    }
+  }
+}
+
+/*!
+  Set the number of pyramid levels used for the detection. Level \f$ k \f$ is the
+  full resolution image subsampled by \f$ 2^k \f$.
+
+  \param nbLevels : Number of levels, at least 1.
+*/
+void vpFastDetector::setNbLevels(const unsigned int nbLevels)
+{
+  if (nbLevels == 0) {
+    throw vpException(vpException::badValue, "The number of pyramid levels should be at least 1");
+  }
+  m_nbLevels = nbLevels;
+}
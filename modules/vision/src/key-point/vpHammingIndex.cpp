@@ -0,0 +1,356 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Multi-index hashing of binary descriptors.
+ *
+ *****************************************************************************/
+
+
+#include <algorithm>
+#include <string.h>
+
+#include <visp3/core/vpException.h>
+#include <visp3/vision/vpHammingIndex.h>
+
+namespace {
+  //! Number of buckets of a table indexed by a 16 bits substring
+  const unsigned int nbBuckets = 1u << 16;
+  //! File signature and format version written by save()
+  const char indexMagic[4] = {'V', 'P', 'H', 'I'};
+  const unsigned int indexVersion = 1;
+
+  void writeUIntLE(std::ostream &os, const unsigned int value)
+  {
+    const unsigned char bytes[4] = { (unsigned char) (value & 0xFF), (unsigned char) ((value >> 8) & 0xFF),
+                                     (unsigned char) ((value >> 16) & 0xFF), (unsigned char) ((value >> 24) & 0xFF) };
+    os.write((const char *) bytes, sizeof(bytes));
+  }
+
+  unsigned int readUIntLE(std::istream &is)
+  {
+    unsigned char bytes[4];
+    if (!is.read((char *) bytes, sizeof(bytes))) {
+      throw vpException(vpException::ioError, "Unexpected end of the Hamming index data");
+    }
+    return (unsigned int) bytes[0] | ((unsigned int) bytes[1] << 8) | ((unsigned int) bytes[2] << 16) |
+           ((unsigned int) bytes[3] << 24);
+  }
+
+  //! Insert a match in a list of at most k matches sorted by increasing distance
+  void insertMatch(std::vector<vpHammingMatch> &best, const unsigned int k, const vpHammingMatch &m)
+  {
+    if (best.size() == k && m.distance >= best.back().distance) {
+      return;
+    }
+    if (best.size() < k) {
+      best.push_back(m);
+    } else {
+      best.back() = m;
+    }
+    for (size_t i = best.size() - 1; i > 0 && best[i].distance < best[i-1].distance; i--) {
+      std::swap(best[i], best[i-1]);
+    }
+  }
+}
+
+/*!
+  Default constructor. The maximum radius is set to 1, that gives an exact search
+  for neighbours closer than \f$ 2m \f$ bits, where \f$ m \f$ is the number of tables.
+*/
+vpHammingIndex::vpHammingIndex()
+  : m_descriptors(NULL), m_descriptorSize(0), m_flipMasks(), m_maxRadius(0), m_nbDescriptors(0), m_nbThreads(1),
+    m_tables()
+{
+  setMaxRadius(1);
+}
+
+/*!
+  Build the hash tables.
+
+  \param descriptors : Descriptors stored contiguously. They are not copied.
+  \param nbDescriptors : Number of descriptors.
+  \param descriptorSize : Size of a descriptor in bytes.
+*/
+void vpHammingIndex::build(const unsigned char *descriptors, const unsigned int nbDescriptors,
+                           const unsigned int descriptorSize)
+{
+  if (descriptorSize == 0) {
+    throw vpException(vpException::badValue, "Cannot index empty descriptors");
+  }
+
+  m_descriptors = descriptors;
+  m_nbDescriptors = nbDescriptors;
+  m_descriptorSize = descriptorSize;
+  m_tables.resize((descriptorSize + 1) / 2);
+
+  for (unsigned int t = 0; t < m_tables.size(); t++) {
+    vpHashTable &table = m_tables[t];
+    table.offsets.assign(nbBuckets + 1, 0);
+    table.ids.resize(nbDescriptors);
+
+    // Counting sort of the descriptors by substring value
+    for (unsigned int i = 0; i < nbDescriptors; i++) {
+      table.offsets[substring(descriptors + (size_t) i * descriptorSize, t) + 1]++;
+    }
+    for (unsigned int b = 0; b < nbBuckets; b++) {
+      table.offsets[b+1] += table.offsets[b];
+    }
+
+    std::vector<unsigned int> next(table.offsets.begin(), table.offsets.end() - 1);
+    for (unsigned int i = 0; i < nbDescriptors; i++) {
+      table.ids[next[substring(descriptors + (size_t) i * descriptorSize, t)]++] = i;
+    }
+  }
+}
+
+/*!
+  Build the hash tables.
+
+  \param descriptors : Descriptors, one per row. They are not copied.
+*/
+void vpHammingIndex::build(const vpArray2D<unsigned char> &descriptors)
+{
+  build(descriptors.data, descriptors.getRows(), descriptors.getCols());
+}
+
+/*!
+  Release the hash tables.
+*/
+void vpHammingIndex::clear()
+{
+  m_descriptors = NULL;
+  m_nbDescriptors = 0;
+  m_descriptorSize = 0;
+  m_tables.clear();
+}
+
+/*!
+  Search the \e k nearest indexed descriptors of each query descriptor.
+
+  \param query : Query descriptors, stored contiguously, of getDescriptorSize() bytes.
+  \param nbQuery : Number of query descriptors.
+  \param k : Number of neighbours.
+  \param matches : For each query descriptor, at most \e k matches sorted by increasing
+  distance. The train indexes are the indexes of the descriptors given to build().
+*/
+void vpHammingIndex::knnSearch(const unsigned char *query, const unsigned int nbQuery, const unsigned int k,
+                               std::vector<std::vector<vpHammingMatch> > &matches) const
+{
+  if (!isBuilt()) {
+    throw vpException(vpException::notInitialized, "The Hamming index is not built");
+  }
+
+  matches.resize(nbQuery);
+  const unsigned int nbThreads = m_nbThreads;
+  (void) nbThreads;
+#ifdef VISP_HAVE_OPENMP
+  #pragma omp parallel num_threads(nbThreads) if(nbThreads > 1)
+#endif
+  {
+    // Last query that visited each descriptor, to compute each distance only once
+    std::vector<unsigned int> stamps(m_nbDescriptors, 0);
+#ifdef VISP_HAVE_OPENMP
+    #pragma omp for
+#endif
+    for (int q = 0; q < (int) nbQuery; q++) {
+      searchOne(query + (size_t) q * m_descriptorSize, k, stamps, (unsigned int) q + 1, matches[(size_t) q]);
+      for (std::vector<vpHammingMatch>::iterator it = matches[(size_t) q].begin(); it != matches[(size_t) q].end(); ++it) {
+        it->queryIdx = q;
+      }
+    }
+  }
+}
+
+/*!
+  Search the \e k nearest indexed descriptors of each query descriptor.
+
+  \param query : Query descriptors, one per row.
+  \param k : Number of neighbours.
+  \param matches : For each query descriptor, at most \e k matches sorted by increasing distance.
+*/
+void vpHammingIndex::knnSearch(const vpArray2D<unsigned char> &query, const unsigned int k,
+                               std::vector<std::vector<vpHammingMatch> > &matches) const
+{
+  if (query.getRows() > 0 && query.getCols() != m_descriptorSize) {
+    throw vpException(vpException::dimensionError, "Query descriptors have %d bytes while indexed descriptors have %d bytes",
+                      query.getCols(), m_descriptorSize);
+  }
+  knnSearch(query.data, query.getRows(), k, matches);
+}
+
+/*!
+  Load hash tables written by save().
+
+  \param is : Input stream, opened in binary mode.
+  \param descriptors : Descriptors the index was built from, stored contiguously. They are not copied.
+  \param nbDescriptors : Number of descriptors.
+  \param descriptorSize : Size of a descriptor in bytes.
+*/
+void vpHammingIndex::load(std::istream &is, const unsigned char *descriptors, const unsigned int nbDescriptors,
+                          const unsigned int descriptorSize)
+{
+  char magic[4];
+  if (!is.read(magic, sizeof(magic)) || memcmp(magic, indexMagic, sizeof(magic)) != 0) {
+    throw vpException(vpException::ioError, "The data is not a Hamming index");
+  }
+
+  const unsigned int version = readUIntLE(is);
+  if (version != indexVersion) {
+    throw vpException(vpException::ioError, "Unsupported Hamming index version %d", version);
+  }
+
+  const unsigned int nbDescriptorsFile = readUIntLE(is);
+  const unsigned int descriptorSizeFile = readUIntLE(is);
+  const unsigned int nbTables = readUIntLE(is);
+  if (nbDescriptorsFile != nbDescriptors || descriptorSizeFile != descriptorSize ||
+      nbTables != (descriptorSize + 1) / 2) {
+    throw vpException(vpException::dimensionError, "The Hamming index was built from other descriptors");
+  }
+
+  clear();
+  std::vector<vpHashTable> tables(nbTables);
+  for (unsigned int t = 0; t < nbTables; t++) {
+    tables[t].offsets.resize(nbBuckets + 1);
+    for (unsigned int b = 0; b <= nbBuckets; b++) {
+      tables[t].offsets[b] = readUIntLE(is);
+      // The buckets have to be contiguous ranges of ids, from 0 to nbDescriptors
+      if ((b == 0 && tables[t].offsets[b] != 0) || (b > 0 && tables[t].offsets[b] < tables[t].offsets[b-1]) ||
+          tables[t].offsets[b] > nbDescriptors) {
+        throw vpException(vpException::ioError, "Corrupted Hamming index table");
+      }
+    }
+    if (tables[t].offsets[nbBuckets] != nbDescriptors) {
+      throw vpException(vpException::ioError, "Corrupted Hamming index table");
+    }
+
+    tables[t].ids.resize(nbDescriptors);
+    for (unsigned int i = 0; i < nbDescriptors; i++) {
+      tables[t].ids[i] = readUIntLE(is);
+      if (tables[t].ids[i] >= nbDescriptors) {
+        throw vpException(vpException::ioError, "Corrupted Hamming index table");
+      }
+    }
+  }
+
+  m_tables.swap(tables);
+  m_descriptors = descriptors;
+  m_nbDescriptors = nbDescriptors;
+  m_descriptorSize = descriptorSize;
+}
+
+/*!
+  Write the hash tables in little endian. The descriptors are not written.
+
+  \param os : Output stream, opened in binary mode.
+*/
+void vpHammingIndex::save(std::ostream &os) const
+{
+  if (!isBuilt()) {
+    throw vpException(vpException::notInitialized, "The Hamming index is not built");
+  }
+
+  os.write(indexMagic, sizeof(indexMagic));
+  writeUIntLE(os, indexVersion);
+  writeUIntLE(os, m_nbDescriptors);
+  writeUIntLE(os, m_descriptorSize);
+  writeUIntLE(os, (unsigned int) m_tables.size());
+  for (std::vector<vpHashTable>::const_iterator it = m_tables.begin(); it != m_tables.end(); ++it) {
+    for (std::vector<unsigned int>::const_iterator it_off = it->offsets.begin(); it_off != it->offsets.end(); ++it_off) {
+      writeUIntLE(os, *it_off);
+    }
+    for (std::vector<unsigned int>::const_iterator it_id = it->ids.begin(); it_id != it->ids.end(); ++it_id) {
+      writeUIntLE(os, *it_id);
+    }
+  }
+}
+
+void vpHammingIndex::searchOne(const unsigned char *desc, const unsigned int k, std::vector<unsigned int> &stamps,
+                               const unsigned int stamp, std::vector<vpHammingMatch> &best) const
+{
+  best.clear();
+  if (k == 0) {
+    return;
+  }
+
+  const unsigned int nbTables = (unsigned int) m_tables.size();
+  for (unsigned int r = 0; r <= m_maxRadius; r++) {
+    const std::vector<unsigned short> &masks = m_flipMasks[r];
+    for (unsigned int t = 0; t < nbTables; t++) {
+      const vpHashTable &table = m_tables[t];
+      const unsigned int key = substring(desc, t);
+      for (std::vector<unsigned short>::const_iterator it = masks.begin(); it != masks.end(); ++it) {
+        const unsigned int bucket = key ^ *it;
+        for (unsigned int i = table.offsets[bucket]; i < table.offsets[bucket+1]; i++) {
+          const unsigned int id = table.ids[i];
+          if (stamps[id] == stamp) {
+            continue;
+          }
+          stamps[id] = stamp;
+          const unsigned int dist = vpHammingMatcher::distance(desc, m_descriptors + (size_t) id * m_descriptorSize,
+                                                               m_descriptorSize);
+          insertMatch(best, k, vpHammingMatch(-1, (int) id, dist));
+        }
+      }
+    }
+
+    // The descriptors not seen yet are at least at nbTables * (r+1) bits
+    if (best.size() == (std::min)(k, m_nbDescriptors) && best.back().distance < nbTables * (r + 1)) {
+      break;
+    }
+  }
+}
+
+/*!
+  Set the maximum Hamming distance between a query substring and the probed bucket
+  keys. The search is exact for neighbours closer than \f$ m(r+1) \f$ bits, where
+  \f$ m \f$ is the number of tables and \f$ r \f$ the maximum radius; farther neighbours
+  may be missed. The number of probed buckets grows as \f$ \binom{16}{r} \f$.
+
+  \param maxRadius : Maximum radius, between 0 and 16.
+*/
+void vpHammingIndex::setMaxRadius(const unsigned int maxRadius)
+{
+  if (maxRadius > 16) {
+    throw vpException(vpException::badValue, "The maximum radius of a 16 bits substring is 16");
+  }
+
+  m_maxRadius = maxRadius;
+  m_flipMasks.assign(maxRadius + 1, std::vector<unsigned short>());
+  for (unsigned int mask = 0; mask < nbBuckets; mask++) {
+    unsigned int nbBits = 0;
+    for (unsigned int v = mask; v; v &= v - 1) {
+      nbBits++;
+    }
+    if (nbBits <= maxRadius) {
+      m_flipMasks[nbBits].push_back((unsigned short) mask);
+    }
+  }
+}
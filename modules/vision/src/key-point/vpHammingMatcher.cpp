@@ -0,0 +1,364 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Brute force Hamming matcher for binary descriptors.
+ *
+ *****************************************************************************/
+
+
+#include <algorithm>
+#include <limits>
+#include <stdint.h>
+#include <string.h>
+
+#include <visp3/core/vpCPUFeatures.h>
+#include <visp3/core/vpException.h>
+#include <visp3/vision/vpHammingMatcher.h>
+
+#if (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#  include <immintrin.h>
+#  define VISP_HAVE_HAMMING_X86 1
+#  define VISP_TARGET_POPCNT __attribute__((target("popcnt")))
+#  define VISP_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#  include <intrin.h>
+#  define VISP_HAVE_HAMMING_X86 1
+#  define VISP_TARGET_POPCNT
+#  define VISP_TARGET_AVX2
+#endif
+
+namespace {
+  typedef unsigned int (*vpHammingFunction)(const unsigned char *, const unsigned char *, const unsigned int);
+
+  const unsigned char popCountTable[256] = {
+    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
+    1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
+    1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
+    2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
+    1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
+    2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
+    2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
+    3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7, 4, 5, 5, 6, 5, 6, 6, 7, 5, 6, 6, 7, 6, 7, 7, 8
+  };
+
+  //! Portable bit counting on 64 bits words
+  unsigned int hammingGeneric(const unsigned char *a, const unsigned char *b, const unsigned int size)
+  {
+    unsigned int dist = 0, i = 0;
+    for (; i + 8 <= size; i += 8) {
+      uint64_t x, y;
+      memcpy(&x, a + i, sizeof(x));
+      memcpy(&y, b + i, sizeof(y));
+      uint64_t v = x ^ y;
+      v = v - ((v >> 1) & 0x5555555555555555ULL);
+      v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+      v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+      dist += (unsigned int) ((v * 0x0101010101010101ULL) >> 56);
+    }
+    for (; i < size; i++) {
+      dist += popCountTable[a[i] ^ b[i]];
+    }
+    return dist;
+  }
+
+#if VISP_HAVE_HAMMING_X86
+  VISP_TARGET_POPCNT unsigned int hammingPopcnt(const unsigned char *a, const unsigned char *b,
+                                                const unsigned int size)
+  {
+    unsigned int dist = 0, i = 0;
+#if defined(__x86_64__) || defined(_M_X64)
+    for (; i + 8 <= size; i += 8) {
+      uint64_t x, y;
+      memcpy(&x, a + i, sizeof(x));
+      memcpy(&y, b + i, sizeof(y));
+      dist += (unsigned int) _mm_popcnt_u64(x ^ y);
+    }
+#endif
+    for (; i + 4 <= size; i += 4) {
+      uint32_t x, y;
+      memcpy(&x, a + i, sizeof(x));
+      memcpy(&y, b + i, sizeof(y));
+      dist += (unsigned int) _mm_popcnt_u32(x ^ y);
+    }
+    for (; i < size; i++) {
+      dist += popCountTable[a[i] ^ b[i]];
+    }
+    return dist;
+  }
+
+  //! Nibble lookup with pshufb on 32 bytes blocks, the remaining bytes use popcnt
+  VISP_TARGET_AVX2 unsigned int hammingAVX2(const unsigned char *a, const unsigned char *b, const unsigned int size)
+  {
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowMask = _mm256_set1_epi8(0x0F);
+    __m256i acc = _mm256_setzero_si256();
+
+    unsigned int i = 0;
+    for (; i + 32 <= size; i += 32) {
+      const __m256i v = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *) (a + i)),
+                                         _mm256_loadu_si256((const __m256i *) (b + i)));
+      const __m256i lo = _mm256_and_si256(v, lowMask);
+      const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask);
+      const __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lut, lo), _mm256_shuffle_epi8(lut, hi));
+      acc = _mm256_add_epi64(acc, _mm256_sad_epu8(cnt, _mm256_setzero_si256()));
+    }
+
+    const __m128i sum128 = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    const __m128i sum64 = _mm_add_epi64(sum128, _mm_unpackhi_epi64(sum128, sum128));
+    unsigned int dist = (unsigned int) _mm_cvtsi128_si32(sum64);
+
+    if (i < size) {
+      dist += hammingPopcnt(a + i, b + i, size - i);
+    }
+    return dist;
+  }
+#endif
+
+  vpHammingFunction selectHammingFunction()
+  {
+#if VISP_HAVE_HAMMING_X86
+    if (vpCPUFeatures::checkAVX2() && vpCPUFeatures::checkSSE42()) {
+      return hammingAVX2;
+    }
+    if (vpCPUFeatures::checkSSE42()) {
+      return hammingPopcnt;
+    }
+#endif
+    return hammingGeneric;
+  }
+
+  vpHammingFunction getHammingFunction()
+  {
+    static const vpHammingFunction func = selectHammingFunction();
+    return func;
+  }
+
+  //! Insert a match in a list of at most k matches sorted by increasing distance
+  void insertMatch(std::vector<vpHammingMatch> &best, const unsigned int k, const vpHammingMatch &m)
+  {
+    if (best.size() == k && m.distance >= best.back().distance) {
+      return;
+    }
+    if (best.size() < k) {
+      best.push_back(m);
+    } else {
+      best.back() = m;
+    }
+    for (size_t i = best.size() - 1; i > 0 && best[i].distance < best[i-1].distance; i--) {
+      std::swap(best[i], best[i-1]);
+    }
+  }
+
+  void checkDescriptors(const vpArray2D<unsigned char> &query, const vpArray2D<unsigned char> &train)
+  {
+    if (query.getRows() > 0 && train.getRows() > 0 && query.getCols() != train.getCols()) {
+      throw vpException(vpException::dimensionError, "Query descriptors have %d bytes while train descriptors have %d bytes",
+                        query.getCols(), train.getCols());
+    }
+  }
+}
+
+/*!
+  Default constructor.
+
+  \param crossCheck : If true, match() only keeps mutual best matches.
+*/
+vpHammingMatcher::vpHammingMatcher(const bool crossCheck) : m_crossCheck(crossCheck), m_nbThreads(1), m_ratio(1.0)
+{
+}
+
+/*!
+  Hamming distance between two binary descriptors.
+
+  \param desc1 : First descriptor.
+  \param desc2 : Second descriptor.
+  \param descriptorSize : Size of the descriptors in bytes.
+  \return The number of different bits.
+*/
+unsigned int vpHammingMatcher::distance(const unsigned char *desc1, const unsigned char *desc2,
+                                        const unsigned int descriptorSize)
+{
+  return getHammingFunction()(desc1, desc2, descriptorSize);
+}
+
+/*!
+  Find the \e k nearest train descriptors of each query descriptor. The ratio test and
+  the cross check are not applied.
+
+  \param query : Query descriptors, stored contiguously.
+  \param nbQuery : Number of query descriptors.
+  \param train : Train descriptors, stored contiguously.
+  \param nbTrain : Number of train descriptors.
+  \param descriptorSize : Size of a descriptor in bytes.
+  \param k : Number of neighbours.
+  \param matches : For each query descriptor, at most \e k matches sorted by increasing distance.
+*/
+void vpHammingMatcher::knnMatch(const unsigned char *query, const unsigned int nbQuery, const unsigned char *train,
+                                const unsigned int nbTrain, const unsigned int descriptorSize, const unsigned int k,
+                                std::vector<std::vector<vpHammingMatch> > &matches)
+{
+  matches.resize(nbQuery);
+  if (k == 0) {
+    for (unsigned int q = 0; q < nbQuery; q++) {
+      matches[q].clear();
+    }
+    return;
+  }
+
+  const vpHammingFunction hamming = getHammingFunction();
+  const unsigned int nbThreads = m_nbThreads;
+  (void) nbThreads;
+#ifdef VISP_HAVE_OPENMP
+  #pragma omp parallel for num_threads(nbThreads) if(nbThreads > 1)
+#endif
+  for (int q = 0; q < (int) nbQuery; q++) {
+    std::vector<vpHammingMatch> &best = matches[(size_t) q];
+    best.clear();
+    const unsigned char *desc = query + (size_t) q * descriptorSize;
+    for (unsigned int t = 0; t < nbTrain; t++) {
+      const unsigned int dist = hamming(desc, train + (size_t) t * descriptorSize, descriptorSize);
+      insertMatch(best, k, vpHammingMatch(q, (int) t, dist));
+    }
+  }
+}
+
+/*!
+  Find the \e k nearest train descriptors of each query descriptor.
+
+  \param query : Query descriptors, one per row.
+  \param train : Train descriptors, one per row.
+  \param k : Number of neighbours.
+  \param matches : For each query descriptor, at most \e k matches sorted by increasing distance.
+*/
+void vpHammingMatcher::knnMatch(const vpArray2D<unsigned char> &query, const vpArray2D<unsigned char> &train,
+                                const unsigned int k, std::vector<std::vector<vpHammingMatch> > &matches)
+{
+  checkDescriptors(query, train);
+  knnMatch(query.data, query.getRows(), train.data, train.getRows(), query.getCols(), k, matches);
+}
+
+/*!
+  Find the best train descriptor of each query descriptor, then apply the ratio test
+  (see setRatioTest()) and the cross check (see setCrossCheck()).
+
+  \param query : Query descriptors, stored contiguously.
+  \param nbQuery : Number of query descriptors.
+  \param train : Train descriptors, stored contiguously.
+  \param nbTrain : Number of train descriptors.
+  \param descriptorSize : Size of a descriptor in bytes.
+  \param matches : Kept matches, sorted by increasing query index.
+*/
+void vpHammingMatcher::match(const unsigned char *query, const unsigned int nbQuery, const unsigned char *train,
+                             const unsigned int nbTrain, const unsigned int descriptorSize,
+                             std::vector<vpHammingMatch> &matches)
+{
+  matches.clear();
+  if (nbQuery == 0 || nbTrain == 0) {
+    return;
+  }
+
+  const vpHammingFunction hamming = getHammingFunction();
+  const unsigned int nbThreads = m_nbThreads;
+  (void) nbThreads;
+  std::vector<int> bestTrain(nbQuery);
+  std::vector<unsigned int> bestDist(nbQuery), secondDist(nbQuery);
+
+#ifdef VISP_HAVE_OPENMP
+  #pragma omp parallel for num_threads(nbThreads) if(nbThreads > 1)
+#endif
+  for (int q = 0; q < (int) nbQuery; q++) {
+    const unsigned char *desc = query + (size_t) q * descriptorSize;
+    unsigned int d1 = (std::numeric_limits<unsigned int>::max)(), d2 = d1;
+    int idx = -1;
+    for (unsigned int t = 0; t < nbTrain; t++) {
+      const unsigned int dist = hamming(desc, train + (size_t) t * descriptorSize, descriptorSize);
+      if (dist < d1) {
+        d2 = d1;
+        d1 = dist;
+        idx = (int) t;
+      } else if (dist < d2) {
+        d2 = dist;
+      }
+    }
+    bestTrain[(size_t) q] = idx;
+    bestDist[(size_t) q] = d1;
+    secondDist[(size_t) q] = d2;
+  }
+
+  std::vector<int> bestQuery;
+  if (m_crossCheck) {
+    bestQuery.resize(nbTrain);
+#ifdef VISP_HAVE_OPENMP
+    #pragma omp parallel for num_threads(nbThreads) if(nbThreads > 1)
+#endif
+    for (int t = 0; t < (int) nbTrain; t++) {
+      const unsigned char *desc = train + (size_t) t * descriptorSize;
+      unsigned int d1 = (std::numeric_limits<unsigned int>::max)();
+      int idx = -1;
+      for (unsigned int q = 0; q < nbQuery; q++) {
+        const unsigned int dist = hamming(query + (size_t) q * descriptorSize, desc, descriptorSize);
+        if (dist < d1) {
+          d1 = dist;
+          idx = (int) q;
+        }
+      }
+      bestQuery[(size_t) t] = idx;
+    }
+  }
+
+  const bool useRatio = m_ratio < 1.0 && nbTrain > 1;
+  for (unsigned int q = 0; q < nbQuery; q++) {
+    if (useRatio && bestDist[q] >= m_ratio * secondDist[q]) {
+      continue;
+    }
+    if (m_crossCheck && bestQuery[(size_t) bestTrain[q]] != (int) q) {
+      continue;
+    }
+    matches.push_back(vpHammingMatch((int) q, bestTrain[q], bestDist[q]));
+  }
+}
+
+/*!
+  Find the best train descriptor of each query descriptor, then apply the ratio test
+  (see setRatioTest()) and the cross check (see setCrossCheck()).
+
+  \param query : Query descriptors, one per row.
+  \param train : Train descriptors, one per row.
+  \param matches : Kept matches, sorted by increasing query index.
+*/
+void vpHammingMatcher::match(const vpArray2D<unsigned char> &query, const vpArray2D<unsigned char> &train,
+                             std::vector<vpHammingMatch> &matches)
+{
+  checkDescriptors(query, train);
+  match(query.data, query.getRows(), train.data, train.getRows(), query.getCols(), matches);
+}
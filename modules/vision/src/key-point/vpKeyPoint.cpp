@@ -38,9 +38,13 @@
 
 #include <limits>
 #include <iomanip>
+#include <string.h> //memcpy
 #include <stdint.h> //uint32_t ; works also with >= VS2010 / _MSC_VER >= 1600
 
 #include <visp3/vision/vpKeyPoint.h>
+#include <visp3/vision/vpFastDetector.h>
+#include <visp3/vision/vpHammingMatcher.h>
+#include <visp3/vision/vpOrbExtractor.h>
 #include <visp3/core/vpIoTools.h>
 
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020101)
@@ -230,65 +234,272 @@ namespace {
   #endif
   }
 
-  //Write an unsigned short in little endian
-  void writeBinaryUShortLE(std::ofstream &file, const unsigned short ushort_value) {
-  #ifdef VISP_BIG_ENDIAN
-    //Swap bytes order to little endian
-    uint16_t swap_ushort = swap16bits(ushort_value);
-    file.write((char *)(&swap_ushort), sizeof(swap_ushort));
-  #else
-    file.write((char *)(&ushort_value), sizeof(ushort_value));
-  #endif
+  //Magic number and version of the memory-mappable learning data file
+  const char learningDataMagic[8] = { 'V', 'P', 'K', 'P', 'D', 'A', 'T', 'A' };
+  const unsigned int learningDataVersion = 1;
+  //Size of the header, of a keypoint record and of a 3D point record, in bytes
+  const uint64_t learningDataHeaderSize = 128;
+  const uint64_t learningDataKeyPointSize = 32;
+  const uint64_t learningDataPointSize = 12;
+  //Size of the header of an embedded training image, in bytes
+  const uint64_t learningDataImageHeaderSize = 16;
+  //The blocks start on a cache line so that they can be used in place once mapped
+  const uint64_t learningDataAlignment = 64;
+  //Flags of the header
+  const unsigned int learningDataHave3DInfo = 0x1;
+  const unsigned int learningDataHaveImages = 0x2;
+  const unsigned int learningDataHaveIndex = 0x4;
+
+  //Round up an offset to the block alignment
+  uint64_t alignOffset(const uint64_t offset) {
+    return (offset + learningDataAlignment - 1) / learningDataAlignment * learningDataAlignment;
   }
 
-  //Write a short in little endian
-  void writeBinaryShortLE(std::ofstream &file, const short short_value) {
-  #ifdef VISP_BIG_ENDIAN
-    //Swap bytes order to little endian
-    uint16_t swap_short = swap16bits((uint16_t) short_value);
-    file.write((char *)(&swap_short), sizeof(swap_short));
-  #else
-    file.write((char *)(&short_value), sizeof(short_value));
-  #endif
+  //Check that a block is inside the learning file
+  void checkBlock(const uint64_t offset, const uint64_t size, const uint64_t fileSize, const std::string &filename) {
+    if(offset > fileSize || size > fileSize - offset) {
+      throw vpException(vpException::ioError, "The learning file %s is truncated", filename.c_str());
+    }
   }
 
-  //Write an int in little endian
-  void writeBinaryIntLE(std::ofstream &file, const int int_value) {
-  #ifdef VISP_BIG_ENDIAN
-    //Swap bytes order to little endian
-    //More info on data type: http://en.cppreference.com/w/cpp/language/types
-    if(sizeof(int_value) == 4) {
-      uint32_t swap_int = swap32bits((uint32_t) int_value);
-      file.write((char *)(&swap_int), sizeof(swap_int));
+  //Store an unsigned 32 bits integer in little endian
+  void storeUInt32LE(unsigned char *ptr, const uint32_t value) {
+    ptr[0] = (unsigned char) value;
+    ptr[1] = (unsigned char) (value >> 8);
+    ptr[2] = (unsigned char) (value >> 16);
+    ptr[3] = (unsigned char) (value >> 24);
+  }
+
+  //Store an unsigned 64 bits integer in little endian
+  void storeUInt64LE(unsigned char *ptr, const uint64_t value) {
+    storeUInt32LE(ptr, (uint32_t) value);
+    storeUInt32LE(ptr + 4, (uint32_t) (value >> 32));
+  }
+
+  //Store a float in little endian
+  void storeFloatLE(unsigned char *ptr, const float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    storeUInt32LE(ptr, bits);
+  }
+
+  //Load an unsigned 32 bits integer stored in little endian
+  uint32_t loadUInt32LE(const unsigned char *ptr) {
+    return (uint32_t) ptr[0] | ((uint32_t) ptr[1] << 8) | ((uint32_t) ptr[2] << 16) | ((uint32_t) ptr[3] << 24);
+  }
+
+  //Load an unsigned 64 bits integer stored in little endian
+  uint64_t loadUInt64LE(const unsigned char *ptr) {
+    return (uint64_t) loadUInt32LE(ptr) | ((uint64_t) loadUInt32LE(ptr + 4) << 32);
+  }
+
+  //Load a float stored in little endian
+  float loadFloatLE(const unsigned char *ptr) {
+    uint32_t bits = loadUInt32LE(ptr);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  //Write zeros up to the given offset of the file
+  void writePadding(std::ofstream &file, const uint64_t offset) {
+    const char zeros[64] = { 0 };
+    uint64_t position = (uint64_t) file.tellp();
+    while(position < offset) {
+      const uint64_t size = (std::min)(offset - position, (uint64_t) sizeof(zeros));
+      file.write(zeros, (std::streamsize) size);
+      position += size;
+    }
+  }
+
+#ifdef VISP_BIG_ENDIAN
+  //Swap in place the bytes of each element of a continuous matrix
+  void swapElementBytes(cv::Mat &mat) {
+    const size_t elemSize = mat.elemSize1();
+    const size_t nbElements = mat.total() * (size_t) mat.channels();
+    unsigned char *ptr = mat.data;
+    for(size_t i = 0; i < nbElements; i++, ptr += elemSize) {
+      std::reverse(ptr, ptr + elemSize);
+    }
+  }
+#endif
+
+  //Stream buffer on a memory block, to parse a block of a mapped file without copy
+  class vpMemoryStreamBuf : public std::streambuf {
+  public:
+    vpMemoryStreamBuf(char *data, const size_t size) {
+      setg(data, data, data + size);
+    }
+  };
+
+#if (VISP_HAVE_OPENCV_VERSION >= 0x030000)
+  //Convert an OpenCV image to a grayscale ViSP image
+  void toGrayImage(cv::InputArray image, vpImage<unsigned char> &I) {
+    cv::Mat matImg = image.getMat();
+    if(matImg.channels() == 3) {
+      cv::Mat grayImg;
+      cv::cvtColor(matImg, grayImg, cv::COLOR_BGR2GRAY);
+      vpImageConvert::convert(grayImg, I);
     } else {
-      uint16_t swap_int = swap16bits((uint16_t) int_value);
-      file.write((char *)(&swap_int), sizeof(swap_int));
+      vpImageConvert::convert(matImg, I);
     }
-  #else
-    file.write((char *)(&int_value), sizeof(int_value));
-  #endif
   }
 
-  //Write a float in little endian
-  void writeBinaryFloatLE(std::ofstream &file, const float float_value) {
-  #ifdef VISP_BIG_ENDIAN
-    //Swap bytes order to little endian
-    float swap_float = swapFloat(float_value);
-    file.write((char *)(&swap_float), sizeof(swap_float));
-  #else
-    file.write((char *)(&float_value), sizeof(float_value));
-  #endif
+  //OpenCV wrapper around vpFastDetector, selected with the "vpFAST" detector name
+  class vpFastFeatureDetector : public cv::Feature2D {
+  public:
+    vpFastFeatureDetector() : m_detector(), m_I() {}
+
+    virtual void detect(cv::InputArray image, std::vector<cv::KeyPoint> &keypoints, cv::InputArray mask=cv::noArray()) {
+      toGrayImage(image, m_I);
+      std::vector<vpFastKeyPoint> kpts;
+      m_detector.detect(m_I, kpts);
+
+      cv::Mat matMask = mask.getMat();
+      keypoints.clear();
+      keypoints.reserve(kpts.size());
+      for(std::vector<vpFastKeyPoint>::const_iterator it = kpts.begin(); it != kpts.end(); ++it) {
+        if(!matMask.empty() && matMask.at<unsigned char>((int) it->v, (int) it->u) == 0) {
+          continue;
+        }
+        keypoints.push_back(cv::KeyPoint((float) it->u, (float) it->v, (float) it->size, (float) it->angle,
+                                         (float) it->response, (int) it->octave));
+      }
+    }
+
+  private:
+    vpFastDetector m_detector;
+    vpImage<unsigned char> m_I;
+  };
+
+  //OpenCV wrapper around vpOrbExtractor, selected with the "vpORB" extractor name
+  class vpOrbDescriptorExtractor : public cv::Feature2D {
+  public:
+    vpOrbDescriptorExtractor() : m_extractor(), m_I() {}
+
+    virtual void compute(cv::InputArray image, std::vector<cv::KeyPoint> &keypoints, cv::OutputArray descriptors) {
+      toGrayImage(image, m_I);
+
+      //Keypoints coming from another detector are described at full resolution
+      std::vector<vpFastKeyPoint> kpts;
+      kpts.reserve(keypoints.size());
+      for(std::vector<cv::KeyPoint>::const_iterator it = keypoints.begin(); it != keypoints.end(); ++it) {
+        unsigned int octave = (it->octave > 0 && it->octave < 8) ? (unsigned int) it->octave : 0;
+        kpts.push_back(vpFastKeyPoint(it->pt.x, it->pt.y, it->response, it->size, octave));
+      }
+
+      vpArray2D<unsigned char> desc;
+      m_extractor.compute(m_I, kpts, desc);
+
+      keypoints.clear();
+      for(std::vector<vpFastKeyPoint>::const_iterator it = kpts.begin(); it != kpts.end(); ++it) {
+        keypoints.push_back(cv::KeyPoint((float) it->u, (float) it->v, (float) it->size, (float) it->angle,
+                                         (float) it->response, (int) it->octave));
+      }
+
+      cv::Mat matDesc((int) desc.getRows(), (int) vpOrbExtractor::descriptorSize, CV_8U);
+      if(desc.size() > 0) {
+        memcpy(matDesc.data, desc.data, desc.size());
+      }
+      matDesc.copyTo(descriptors);
+    }
+
+    virtual int descriptorSize() const { return (int) vpOrbExtractor::descriptorSize; }
+    virtual int descriptorType() const { return CV_8U; }
+    virtual int defaultNorm() const { return cv::NORM_HAMMING; }
+
+  private:
+    vpOrbExtractor m_extractor;
+    vpImage<unsigned char> m_I;
+  };
+
+#endif
+
+  //Match binary descriptors with vpHammingMatcher, used with the "vpBruteForce-Hamming" and "vpHammingIndex" matcher names
+  void matchHamming(const cv::Mat &trainDescriptors, const cv::Mat &queryDescriptors, const bool useKnn,
+                    const bool matchTrainToQuery, const bool crossCheck,
+                    std::vector<std::vector<cv::DMatch> > &knnMatches, std::vector<cv::DMatch> &matches) {
+    if(trainDescriptors.type() != CV_8U || queryDescriptors.type() != CV_8U) {
+      throw vpException(vpException::badValue, "vpBruteForce-Hamming matcher requires binary (CV_8U) descriptors");
+    }
+
+    //Swap the role of the query and train descriptors to match train descriptors to query descriptors
+    const cv::Mat query = matchTrainToQuery ? trainDescriptors : queryDescriptors;
+    const cv::Mat train = matchTrainToQuery ? queryDescriptors : trainDescriptors;
+    const cv::Mat queryCont = query.isContinuous() ? query : query.clone();
+    const cv::Mat trainCont = train.isContinuous() ? train : train.clone();
+
+    matches.clear();
+    if(queryCont.rows == 0 || trainCont.rows == 0) {
+      knnMatches.clear();
+      return;
+    }
+    if(queryCont.cols != trainCont.cols) {
+      throw vpException(vpException::dimensionError, "Query and train descriptors have different sizes");
+    }
+
+    vpHammingMatcher matcher(crossCheck && !useKnn);
+    if(useKnn) {
+      std::vector<std::vector<vpHammingMatch> > knn;
+      matcher.knnMatch(queryCont.data, (unsigned int) queryCont.rows, trainCont.data, (unsigned int) trainCont.rows,
+                       (unsigned int) queryCont.cols, 2, knn);
+
+      knnMatches.resize(knn.size());
+      for(size_t i = 0; i < knn.size(); i++) {
+        knnMatches[i].clear();
+        for(std::vector<vpHammingMatch>::const_iterator it = knn[i].begin(); it != knn[i].end(); ++it) {
+          knnMatches[i].push_back(matchTrainToQuery ? cv::DMatch(it->trainIdx, it->queryIdx, (float) it->distance)
+                                                    : cv::DMatch(it->queryIdx, it->trainIdx, (float) it->distance));
+        }
+      }
+
+      matches.resize(knnMatches.size());
+      std::transform(knnMatches.begin(), knnMatches.end(), matches.begin(), knnToDMatch);
+    } else {
+      std::vector<vpHammingMatch> hammingMatches;
+      matcher.match(queryCont.data, (unsigned int) queryCont.rows, trainCont.data, (unsigned int) trainCont.rows,
+                    (unsigned int) queryCont.cols, hammingMatches);
+
+      for(std::vector<vpHammingMatch>::const_iterator it = hammingMatches.begin(); it != hammingMatches.end(); ++it) {
+        matches.push_back(matchTrainToQuery ? cv::DMatch(it->trainIdx, it->queryIdx, (float) it->distance)
+                                            : cv::DMatch(it->queryIdx, it->trainIdx, (float) it->distance));
+      }
+    }
   }
 
-  //Write a double in little endian
-  void writeBinaryDoubleLE(std::ofstream &file, const double double_value) {
-  #ifdef VISP_BIG_ENDIAN
-    //Swap bytes order to little endian
-    double swap_double = swapDouble(double_value);
-    file.write((char *)(&swap_double), sizeof(swap_double));
-  #else
-    file.write((char *)(&double_value), sizeof(double_value));
-  #endif
+  //Match binary descriptors with a Hamming index built on the train descriptors, used with the "vpHammingIndex" matcher name
+  void matchHammingIndex(const vpHammingIndex &index, const cv::Mat &queryDescriptors, const bool useKnn,
+                         std::vector<std::vector<cv::DMatch> > &knnMatches, std::vector<cv::DMatch> &matches) {
+    if(queryDescriptors.type() != CV_8U || (queryDescriptors.rows > 0 && (unsigned int) queryDescriptors.cols != index.getDescriptorSize())) {
+      throw vpException(vpException::badValue, "Query descriptors do not match the descriptors of the Hamming index");
+    }
+    if(!index.isBuilt()) {
+      knnMatches.clear();
+      matches.clear();
+      return;
+    }
+    const cv::Mat query = queryDescriptors.isContinuous() ? queryDescriptors : queryDescriptors.clone();
+
+    std::vector<std::vector<vpHammingMatch> > knn;
+    index.knnSearch(query.data, (unsigned int) query.rows, useKnn ? 2 : 1, knn);
+
+    knnMatches.resize(knn.size());
+    for(size_t i = 0; i < knn.size(); i++) {
+      knnMatches[i].clear();
+      for(std::vector<vpHammingMatch>::const_iterator it = knn[i].begin(); it != knn[i].end(); ++it) {
+        knnMatches[i].push_back(cv::DMatch(it->queryIdx, it->trainIdx, (float) it->distance));
+      }
+    }
+
+    matches.clear();
+    for(size_t i = 0; i < knnMatches.size(); i++) {
+      if(!knnMatches[i].empty()) {
+        matches.push_back(knnMatches[i][0]);
+      }
+    }
+    if(!useKnn) {
+      knnMatches.clear();
+    }
   }
 }
 
@@ -305,7 +516,8 @@ vpKeyPoint::vpKeyPoint(const vpFeatureDetectorType &detectorType, const vpFeatur
   : m_computeCovariance(false), m_covarianceMatrix(), m_currentImageId(0), m_detectionMethod(detectionScore),
     m_detectionScore(0.15), m_detectionThreshold(100.0), m_detectionTime(0.), m_detectorNames(),
     m_detectors(), m_extractionTime(0.), m_extractorNames(), m_extractors(), m_filteredMatches(), m_filterType(filterType),
-    m_imageFormat(jpgImageFormat), m_knnMatches(), m_mapOfImageId(), m_mapOfImages(),
+    m_hammingIndex(), m_hammingIndexUpToDate(false),
+    m_imageFormat(jpgImageFormat), m_knnMatches(), m_learningDataFile(), m_mapOfImageId(), m_mapOfImages(),
     m_matcher(), m_matcherName(matcherName),
     m_matches(), m_matchingFactorThreshold(2.0), m_matchingRatioThreshold(0.85), m_matchingTime(0.),
     m_matchRansacKeyPointsToPoints(), m_nbRansacIterations(200), m_nbRansacMinInlierCount(100), m_objectFilteredPoints(),
@@ -313,9 +525,7 @@ vpKeyPoint::vpKeyPoint(const vpFeatureDetectorType &detectorType, const vpFeatur
     m_ransacConsensusPercentage(20.0), m_ransacInliers(), m_ransacOutliers(), m_ransacReprojectionError(6.0),
     m_ransacThreshold(0.01), m_trainDescriptors(), m_trainKeyPoints(), m_trainPoints(),
     m_trainVpPoints(), m_useAffineDetection(false),
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
     m_useBruteForceCrossCheck(true),
-#endif
     m_useConsensusPercentage(false),
     m_useKnn(false), m_useMatchTrainToQuery(false), m_useRansacVVS(true), m_useSingleMatchFilter(true)
 {
@@ -340,7 +550,8 @@ vpKeyPoint::vpKeyPoint(const std::string &detectorName, const std::string &extra
   : m_computeCovariance(false), m_covarianceMatrix(), m_currentImageId(0), m_detectionMethod(detectionScore),
     m_detectionScore(0.15), m_detectionThreshold(100.0), m_detectionTime(0.), m_detectorNames(),
     m_detectors(), m_extractionTime(0.), m_extractorNames(), m_extractors(), m_filteredMatches(), m_filterType(filterType),
-    m_imageFormat(jpgImageFormat), m_knnMatches(), m_mapOfImageId(), m_mapOfImages(),
+    m_hammingIndex(), m_hammingIndexUpToDate(false),
+    m_imageFormat(jpgImageFormat), m_knnMatches(), m_learningDataFile(), m_mapOfImageId(), m_mapOfImages(),
     m_matcher(), m_matcherName(matcherName),
     m_matches(), m_matchingFactorThreshold(2.0), m_matchingRatioThreshold(0.85), m_matchingTime(0.),
     m_matchRansacKeyPointsToPoints(), m_nbRansacIterations(200), m_nbRansacMinInlierCount(100), m_objectFilteredPoints(),
@@ -348,9 +559,7 @@ vpKeyPoint::vpKeyPoint(const std::string &detectorName, const std::string &extra
     m_ransacConsensusPercentage(20.0), m_ransacInliers(), m_ransacOutliers(), m_ransacReprojectionError(6.0),
     m_ransacThreshold(0.01), m_trainDescriptors(), m_trainKeyPoints(), m_trainPoints(),
     m_trainVpPoints(), m_useAffineDetection(false),
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
     m_useBruteForceCrossCheck(true),
-#endif
     m_useConsensusPercentage(false),
     m_useKnn(false), m_useMatchTrainToQuery(false), m_useRansacVVS(true), m_useSingleMatchFilter(true)
 {
@@ -375,17 +584,15 @@ vpKeyPoint::vpKeyPoint(const std::vector<std::string> &detectorNames, const std:
   : m_computeCovariance(false), m_covarianceMatrix(), m_currentImageId(0), m_detectionMethod(detectionScore),
     m_detectionScore(0.15), m_detectionThreshold(100.0), m_detectionTime(0.), m_detectorNames(detectorNames),
     m_detectors(), m_extractionTime(0.), m_extractorNames(extractorNames), m_extractors(), m_filteredMatches(),
-    m_filterType(filterType), m_imageFormat(jpgImageFormat), m_knnMatches(), m_mapOfImageId(), m_mapOfImages(),
-    m_matcher(),
+    m_filterType(filterType), m_hammingIndex(), m_hammingIndexUpToDate(false), m_imageFormat(jpgImageFormat),
+    m_knnMatches(), m_learningDataFile(), m_mapOfImageId(), m_mapOfImages(), m_matcher(),
     m_matcherName(matcherName), m_matches(), m_matchingFactorThreshold(2.0), m_matchingRatioThreshold(0.85), m_matchingTime(0.),
     m_matchRansacKeyPointsToPoints(), m_nbRansacIterations(200), m_nbRansacMinInlierCount(100), m_objectFilteredPoints(),
     m_poseTime(0.), m_queryDescriptors(), m_queryFilteredKeyPoints(), m_queryKeyPoints(),
     m_ransacConsensusPercentage(20.0), m_ransacInliers(), m_ransacOutliers(), m_ransacReprojectionError(6.0),
     m_ransacThreshold(0.01), m_trainDescriptors(), m_trainKeyPoints(), m_trainPoints(),
     m_trainVpPoints(), m_useAffineDetection(false),
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
     m_useBruteForceCrossCheck(true),
-#endif
     m_useConsensusPercentage(false),
     m_useKnn(false), m_useMatchTrainToQuery(false), m_useRansacVVS(true), m_useSingleMatchFilter(true)
 {
@@ -537,6 +744,7 @@ unsigned int vpKeyPoint::buildReference(const vpImage<unsigned char> &I,
   //Add train descriptors in matcher object
   m_matcher->clear();
   m_matcher->add(std::vector<cv::Mat>(1, m_trainDescriptors));
+  m_hammingIndexUpToDate = false;
 
   return static_cast<unsigned int>(m_trainKeyPoints.size());
 }
@@ -638,6 +846,7 @@ void vpKeyPoint::buildReference(const vpImage<unsigned char> &I, const std::vect
   //Add train descriptors in matcher object
   m_matcher->clear();
   m_matcher->add(std::vector<cv::Mat>(1, m_trainDescriptors));
+  m_hammingIndexUpToDate = false;
 
   _reference_computed = true;
 }
@@ -1885,6 +2094,13 @@ void vpKeyPoint::init() {
  */
 void vpKeyPoint::initDetector(const std::string &detectorName) {
 #if (VISP_HAVE_OPENCV_VERSION < 0x030000)
+  if(detectorName.find("vpFAST") != std::string::npos) {
+    std::stringstream ss_msg;
+    ss_msg << "Fail to initialize the detector: " << detectorName << ". OpenCV version "
+           << std::hex << VISP_HAVE_OPENCV_VERSION << " but requires at least OpenCV 3.0.";
+    throw vpException(vpException::fatalError, ss_msg.str());
+  }
+
   m_detectors[detectorName] = cv::FeatureDetector::create(detectorName);
 
   if(m_detectors[detectorName] == NULL) {
@@ -1940,6 +2156,13 @@ void vpKeyPoint::initDetector(const std::string &detectorName) {
     } else {
       m_detectors[detectorName] = cv::makePtr<PyramidAdaptedFeatureDetector>(fastDetector);
     }
+  } else if (detectorNameTmp == "vpFAST") {
+    cv::Ptr<cv::FeatureDetector> fastDetector = cv::makePtr<vpFastFeatureDetector>();
+    if (!usePyramid) {
+      m_detectors[detectorNameTmp] = fastDetector;
+    } else {
+      m_detectors[detectorName] = cv::makePtr<PyramidAdaptedFeatureDetector>(fastDetector);
+    }
   } else if (detectorNameTmp == "MSER") {
     cv::Ptr<cv::FeatureDetector> fastDetector = cv::MSER::create();
     if (!usePyramid) {
@@ -2075,6 +2298,13 @@ void vpKeyPoint::initDetectors(const std::vector<std::string> &detectorNames) {
  */
 void vpKeyPoint::initExtractor(const std::string &extractorName) {
 #if (VISP_HAVE_OPENCV_VERSION < 0x030000)
+  if(extractorName == "vpORB") {
+    std::stringstream ss_msg;
+    ss_msg << "Fail to initialize the extractor: " << extractorName << ". OpenCV version "
+           << std::hex << VISP_HAVE_OPENCV_VERSION << " but requires at least OpenCV 3.0.";
+    throw vpException(vpException::fatalError, ss_msg.str());
+  }
+
   m_extractors[extractorName] = cv::DescriptorExtractor::create(extractorName);
 #else
   if(extractorName == "SIFT") {
@@ -2098,6 +2328,8 @@ void vpKeyPoint::initExtractor(const std::string &extractorName) {
 #endif
   } else if(extractorName == "ORB") {
     m_extractors[extractorName] = cv::ORB::create();
+  } else if(extractorName == "vpORB") {
+    m_extractors[extractorName] = cv::makePtr<vpOrbDescriptorExtractor>();
   } else if(extractorName == "BRISK") {
     m_extractors[extractorName] = cv::BRISK::create();
   } else if(extractorName == "FREAK") {
@@ -2320,6 +2552,14 @@ void vpKeyPoint::initMatcher(const std::string &matcherName) {
       m_matcher = new cv::FlannBasedMatcher(new cv::flann::KDTreeIndexParams());
 #endif
     }
+  } else if(matcherName == "vpHammingIndex") {
+    //The matching itself is done with vpHammingIndex in match(), the OpenCV matcher only
+    //keeps the train descriptors
+    m_matcher = cv::DescriptorMatcher::create("BruteForce-Hamming");
+  } else if(matcherName == "vpBruteForce-Hamming") {
+    //The matching itself is done with vpHammingMatcher in match(), the OpenCV matcher only
+    //keeps the train descriptors
+    m_matcher = cv::DescriptorMatcher::create("BruteForce-Hamming");
   } else {
     m_matcher = cv::DescriptorMatcher::create(matcherName);
   }
@@ -2494,6 +2734,13 @@ void vpKeyPoint::loadConfigFile(const std::string &configFile) {
 /*!
    Load learning data saved on disk.
 
+   A binary file written by saveLearningData() is memory-mapped: the train descriptors
+   directly point to the mapped pages, which are only read from the disk when they are
+   accessed, and the Hamming index is not rebuilt if it was saved. Binary files written by
+   previous versions of ViSP are still parsed field by field. As the train descriptors
+   may be memory-mapped, a copy obtained with getTrainDescriptors() has to be cloned to be
+   used after the next call to loadLearningData() or reset().
+
    \param filename : Path of the learning file.
    \param binaryMode : If true, the learning file is in a binary mode, otherwise it is in XML mode.
    \param append : If true, concatenate the learning data, otherwise reset the variables.
@@ -2501,6 +2748,7 @@ void vpKeyPoint::loadConfigFile(const std::string &configFile) {
 void vpKeyPoint::loadLearningData(const std::string &filename, const bool binaryMode, const bool append) {
   int startClassId = 0;
   int startImageId = 0;
+  bool indexLoaded = false;
   if(!append) {
     m_trainKeyPoints.clear();
     m_trainPoints.clear();
@@ -2528,7 +2776,118 @@ void vpKeyPoint::loadLearningData(const std::string &filename, const bool binary
     parent += "/";
   }
 
+  cv::Ptr<vpMemoryMappedFile> learningDataFile;
   if(binaryMode) {
+    learningDataFile = cv::Ptr<vpMemoryMappedFile>(new vpMemoryMappedFile(filename));
+    if(learningDataFile->getSize() < learningDataHeaderSize ||
+       memcmp(learningDataFile->getData(), learningDataMagic, sizeof(learningDataMagic)) != 0) {
+      //Binary file saved by a previous version of ViSP, parsed field by field
+      learningDataFile = cv::Ptr<vpMemoryMappedFile>();
+    }
+  }
+
+  if(!learningDataFile.empty()) {
+    unsigned char *data = learningDataFile->getData();
+    uint64_t fileSize = (uint64_t) learningDataFile->getSize();
+
+    unsigned int version = loadUInt32LE(data + 8);
+    if(version != learningDataVersion) {
+      throw vpException(vpException::ioError, "Unsupported version %u of the learning file %s", version, filename.c_str());
+    }
+    unsigned int flags = loadUInt32LE(data + 12);
+    int nRows = (int) loadUInt32LE(data + 16);
+    int nCols = (int) loadUInt32LE(data + 20);
+    int descriptorType = (int) loadUInt32LE(data + 24);
+    int nbImgs = (int) loadUInt32LE(data + 28);
+    uint64_t keyPointsOffset = loadUInt64LE(data + 32);
+    uint64_t descriptorsOffset = loadUInt64LE(data + 40);
+    uint64_t pointsOffset = loadUInt64LE(data + 48);
+    uint64_t imagesOffset = loadUInt64LE(data + 56);
+    uint64_t indexOffset = loadUInt64LE(data + 64);
+
+    if(nRows < 0 || nCols < 0 || nbImgs < 0) {
+      throw vpException(vpException::ioError, "The learning file %s is corrupted", filename.c_str());
+    }
+    checkBlock(keyPointsOffset, (uint64_t) nRows * learningDataKeyPointSize, fileSize, filename);
+    checkBlock(descriptorsOffset, (uint64_t) nRows * (uint64_t) nCols * (uint64_t) CV_ELEM_SIZE(descriptorType),
+               fileSize, filename);
+
+    //Read the training images
+    if(flags & learningDataHaveImages) {
+      uint64_t offset = imagesOffset;
+      for(int i = 0; i < nbImgs; i++) {
+        checkBlock(offset, learningDataImageHeaderSize, fileSize, filename);
+        int id = (int) loadUInt32LE(data + offset);
+        unsigned int height = loadUInt32LE(data + offset + 4);
+        unsigned int width = loadUInt32LE(data + offset + 8);
+        uint64_t imageSize = (uint64_t) height * (uint64_t) width;
+        checkBlock(offset + learningDataImageHeaderSize, imageSize, fileSize, filename);
+
+        vpImage<unsigned char> &I = m_mapOfImages[id + startImageId];
+        I.resize(height, width);
+        if(imageSize > 0) {
+          memcpy(I.bitmap, data + offset + learningDataImageHeaderSize, (size_t) imageSize);
+        }
+        offset = alignOffset(offset + learningDataImageHeaderSize + imageSize);
+      }
+    }
+
+    //Read the keypoint table
+    const unsigned char *record = data + keyPointsOffset;
+    m_trainKeyPoints.reserve(m_trainKeyPoints.size() + (size_t) nRows);
+    for(int i = 0; i < nRows; i++, record += learningDataKeyPointSize) {
+      int class_id = (int) loadUInt32LE(record + 24);
+      int image_id = (int) loadUInt32LE(record + 28);
+      cv::KeyPoint keyPoint(cv::Point2f(loadFloatLE(record), loadFloatLE(record + 4)), loadFloatLE(record + 8),
+                            loadFloatLE(record + 12), loadFloatLE(record + 16), (int) loadUInt32LE(record + 20),
+                            (class_id + startClassId));
+      m_trainKeyPoints.push_back(keyPoint);
+
+      if(image_id != -1) {
+        //No training images if image_id == -1
+        m_mapOfImageId[m_trainKeyPoints.back().class_id] = image_id + startImageId;
+      }
+    }
+
+    //Read the 3D points
+    if(flags & learningDataHave3DInfo) {
+      checkBlock(pointsOffset, (uint64_t) nRows * learningDataPointSize, fileSize, filename);
+      record = data + pointsOffset;
+      m_trainPoints.reserve(m_trainPoints.size() + (size_t) nRows);
+      for(int i = 0; i < nRows; i++, record += learningDataPointSize) {
+        m_trainPoints.push_back(cv::Point3f(loadFloatLE(record), loadFloatLE(record + 4), loadFloatLE(record + 8)));
+      }
+    }
+
+    //The descriptors are used in place
+    cv::Mat trainDescriptorsTmp(nRows, nCols, descriptorType, data + descriptorsOffset);
+#ifdef VISP_BIG_ENDIAN
+    if(trainDescriptorsTmp.elemSize1() > 1) {
+      trainDescriptorsTmp = trainDescriptorsTmp.clone();
+      swapElementBytes(trainDescriptorsTmp);
+    }
+#endif
+
+    if(!append || m_trainDescriptors.empty()) {
+      m_trainDescriptors = trainDescriptorsTmp;
+    } else {
+      cv::vconcat(m_trainDescriptors, trainDescriptorsTmp, m_trainDescriptors);
+    }
+
+    //The mapping is kept as long as the train descriptors use it
+    if(m_trainDescriptors.data == trainDescriptorsTmp.data) {
+      m_learningDataFile = learningDataFile;
+
+      //Hamming index saved after the other blocks
+      if((flags & learningDataHaveIndex) && indexOffset <= fileSize && m_trainDescriptors.type() == CV_8U) {
+        vpMemoryStreamBuf buffer((char *) data + indexOffset, (size_t) (fileSize - indexOffset));
+        std::istream stream(&buffer);
+        m_hammingIndex.load(stream, m_trainDescriptors.data, (unsigned int) m_trainDescriptors.rows,
+                            (unsigned int) m_trainDescriptors.cols);
+        indexLoaded = true;
+      }
+    }
+  } else if(binaryMode) {
     std::ifstream file(filename.c_str(), std::ifstream::binary);
     if(!file.is_open()){
       throw vpException(vpException::ioError, "Cannot open the file.");
@@ -2703,6 +3062,13 @@ void vpKeyPoint::loadLearningData(const std::string &filename, const bool binary
       cv::vconcat(m_trainDescriptors, trainDescriptorsTmp, m_trainDescriptors);
     }
 
+    //Optional Hamming index saved after the descriptors, only valid if no descriptor was appended
+    if(file.peek() != std::char_traits<char>::eof() && m_trainDescriptors.rows == trainDescriptorsTmp.rows) {
+      m_hammingIndex.load(file, m_trainDescriptors.data, (unsigned int) m_trainDescriptors.rows,
+                          (unsigned int) m_trainDescriptors.cols);
+      indexLoaded = true;
+    }
+
     file.close();
   } else {
 #ifdef VISP_HAVE_XML2
@@ -2929,6 +3295,7 @@ void vpKeyPoint::loadLearningData(const std::string &filename, const bool binary
   //Add train descriptors in matcher object
   m_matcher->clear();
   m_matcher->add(std::vector<cv::Mat>(1, m_trainDescriptors));
+  m_hammingIndexUpToDate = indexLoaded;
 
   //Set _reference_computed to true as we load a learning file
   _reference_computed = true;
@@ -2949,6 +3316,27 @@ void vpKeyPoint::match(const cv::Mat &trainDescriptors, const cv::Mat &queryDesc
                        std::vector<cv::DMatch> &matches, double &elapsedTime) {
   double t = vpTime::measureTimeMs();
 
+  if(m_matcherName == "vpHammingIndex" && !m_useMatchTrainToQuery && trainDescriptors.data == m_trainDescriptors.data &&
+     m_trainDescriptors.type() == CV_8U && m_trainDescriptors.isContinuous()) {
+    updateHammingIndex();
+    matchHammingIndex(m_hammingIndex, queryDescriptors, m_useKnn, m_knnMatches, matches);
+    elapsedTime = vpTime::measureTimeMs() - t;
+    return;
+  } else if(m_matcherName == "vpHammingIndex") {
+    //The index is only built on the train descriptors
+    matchHamming(trainDescriptors, queryDescriptors, m_useKnn, m_useMatchTrainToQuery, false, m_knnMatches, matches);
+    elapsedTime = vpTime::measureTimeMs() - t;
+    return;
+  }
+
+  if(m_matcherName == "vpBruteForce-Hamming") {
+    //The cross check is only done without knn, see setUseBruteForceCrossCheck()
+    matchHamming(trainDescriptors, queryDescriptors, m_useKnn, m_useMatchTrainToQuery, m_useBruteForceCrossCheck,
+                 m_knnMatches, matches);
+    elapsedTime = vpTime::measureTimeMs() - t;
+    return;
+  }
+
   if(m_useKnn) {
     m_knnMatches.clear();
 
@@ -3648,7 +4036,9 @@ void vpKeyPoint::reset() {
   m_detectionScore = 0.15; m_detectionThreshold = 100.0; m_detectionTime = 0.0; m_detectorNames.clear();
   m_detectors.clear(); m_extractionTime = 0.0; m_extractorNames.clear(); m_extractors.clear(); m_filteredMatches.clear();
   m_filterType = ratioDistanceThreshold;
-  m_imageFormat = jpgImageFormat; m_knnMatches.clear(); m_mapOfImageId.clear(); m_mapOfImages.clear();
+  m_hammingIndex.clear(); m_hammingIndexUpToDate = false;
+  m_imageFormat = jpgImageFormat; m_knnMatches.clear(); m_learningDataFile = cv::Ptr<vpMemoryMappedFile>();
+  m_mapOfImageId.clear(); m_mapOfImages.clear();
   m_matcher = cv::Ptr<cv::DescriptorMatcher>(); m_matcherName = "BruteForce-Hamming";
   m_matches.clear(); m_matchingFactorThreshold = 2.0; m_matchingRatioThreshold = 0.85; m_matchingTime = 0.0;
   m_matchRansacKeyPointsToPoints.clear(); m_nbRansacIterations = 200; m_nbRansacMinInlierCount = 100;
@@ -3657,9 +4047,7 @@ void vpKeyPoint::reset() {
   m_ransacConsensusPercentage = 20.0; m_ransacInliers.clear(); m_ransacOutliers.clear(); m_ransacReprojectionError = 6.0;
   m_ransacThreshold = 0.01; m_trainDescriptors = cv::Mat(); m_trainKeyPoints.clear(); m_trainPoints.clear();
   m_trainVpPoints.clear(); m_useAffineDetection = false;
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
   m_useBruteForceCrossCheck = true;
-#endif
   m_useConsensusPercentage = false;
   m_useKnn = true; //as m_filterType == ratioDistanceThreshold
   m_useMatchTrainToQuery = false; m_useRansacVVS = true; m_useSingleMatchFilter = true;
@@ -3670,23 +4058,78 @@ void vpKeyPoint::reset() {
   init();
 }
 
+/*!
+   Copy the train descriptors that point to the memory-mapped learning file, if any, and
+   release the mapping, so that the file can be overwritten.
+ */
+void vpKeyPoint::releaseLearningDataFile() {
+  if(m_learningDataFile.empty()) {
+    return;
+  }
+
+  m_trainDescriptors = m_trainDescriptors.clone();
+  if(m_hammingIndexUpToDate && m_hammingIndex.isBuilt()) {
+    //Point the index to the copy of the descriptors without rebuilding it
+    std::stringstream ss;
+    m_hammingIndex.save(ss);
+    m_hammingIndex.load(ss, m_trainDescriptors.data, (unsigned int) m_trainDescriptors.rows,
+                        (unsigned int) m_trainDescriptors.cols);
+  } else {
+    m_hammingIndex.clear();
+    m_hammingIndexUpToDate = false;
+  }
+  m_learningDataFile = cv::Ptr<vpMemoryMappedFile>();
+}
+
+/*!
+   Build the Hamming index used by the "vpHammingIndex" matcher if the train descriptors
+   changed since the last call.
+ */
+void vpKeyPoint::updateHammingIndex() {
+  if(m_hammingIndexUpToDate) {
+    return;
+  }
+
+  if(m_trainDescriptors.empty()) {
+    m_hammingIndex.clear();
+  } else {
+    if(!m_trainDescriptors.isContinuous()) {
+      m_trainDescriptors = m_trainDescriptors.clone();
+    }
+    m_hammingIndex.build(m_trainDescriptors.data, (unsigned int) m_trainDescriptors.rows,
+                         (unsigned int) m_trainDescriptors.cols);
+  }
+  m_hammingIndexUpToDate = true;
+}
+
 /*!
    Save the learning data in a file in XML or binary mode.
 
+   The binary file is made of a versioned header followed by the keypoint table, the descriptors,
+   the 3D points, the training images and, with the "vpHammingIndex" matcher, the Hamming index.
+   Each block is aligned on 64 bytes and stored in little endian, so that loadLearningData()
+   can memory-map the file and use the descriptors in place, without parsing them.
+   Train descriptors mapped from a learning file loaded before are copied first, so that
+   this file can be overwritten.
+
    \param filename : Path of the save file
    \param binaryMode : If true, the data are saved in binary mode, otherwise in XML mode
-   \param saveTrainingImages : If true, save also the training images on disk
+   \param saveTrainingImages : If true, save also the training images, next to the XML file
+   or embedded in the binary file
  */
 void vpKeyPoint::saveLearningData(const std::string &filename, bool binaryMode, const bool saveTrainingImages) {
+  //The file may be the one the train descriptors are mapped from
+  releaseLearningDataFile();
+
   std::string parent = vpIoTools::getParent(filename);
   if(!parent.empty()) {
     vpIoTools::makeDirectory(parent);
   }
 
   std::map<int, std::string> mapOfImgPath;
-  if(saveTrainingImages) {
+  if(saveTrainingImages && !binaryMode) {
 #ifdef VISP_HAVE_MODULE_IO
-    //Save the training image files in the same directory
+    //Save the training image files in the same directory, in binary mode they are embedded in the learning file
     unsigned int cpt = 0;
 
     for(std::map<int, vpImage<unsigned char> >::const_iterator it = m_mapOfImages.begin(); it != m_mapOfImages.end(); ++it, cpt++) {
@@ -3735,166 +4178,128 @@ void vpKeyPoint::saveLearningData(const std::string &filename, bool binaryMode,
   }
 
   if(binaryMode) {
-    //Save the learning data into little endian binary file.
+    //Save the learning data into a versioned little endian binary file whose blocks are aligned
+    //so that the descriptors can be used in place once the file is memory-mapped
     std::ofstream file(filename.c_str(), std::ofstream::binary);
     if(!file.is_open()) {
       throw vpException(vpException::ioError, "Cannot create the file.");
     }
 
-    //Write info about training images
-    int nbImgs = (int) mapOfImgPath.size();
-//    file.write((char *)(&nbImgs), sizeof(nbImgs));
-    writeBinaryIntLE(file, nbImgs);
-
-#ifdef VISP_HAVE_MODULE_IO
-    for(std::map<int, std::string>::const_iterator it = mapOfImgPath.begin(); it != mapOfImgPath.end(); ++it) {
-      //Write image_id
-      int id = it->first;
-//      file.write((char *)(&id), sizeof(id));
-      writeBinaryIntLE(file, id);
-
-      //Write image path
-      std::string path = it->second;
-      int length = (int) path.length();
-//      file.write((char *)(&length), sizeof(length));
-      writeBinaryIntLE(file, length);
-
-      for(int cpt = 0; cpt < length; cpt++) {
-        file.write((char *) (&path[(size_t)cpt]), sizeof(path[(size_t)cpt]));
-      }
+    //Save the Hamming index after the other blocks to not rebuild it when loading the learning data
+    bool haveIndex = m_matcherName == "vpHammingIndex" && m_trainDescriptors.type() == CV_8U && m_trainDescriptors.rows > 0;
+    if(haveIndex) {
+      updateHammingIndex();
     }
-#endif
 
-    //Write if we have 3D point information
-    int have3DInfoInt = have3DInfo ? 1 : 0;
-//    file.write((char *)(&have3DInfoInt), sizeof(have3DInfoInt));
-    writeBinaryIntLE(file, have3DInfoInt);
-
-
-    int nRows = m_trainDescriptors.rows,
-        nCols = m_trainDescriptors.cols;
-    int descriptorType = m_trainDescriptors.type();
-
-    //Write the number of descriptors
-//    file.write((char *)(&nRows), sizeof(nRows));
-    writeBinaryIntLE(file, nRows);
-
-    //Write the size of the descriptor
-//    file.write((char *)(&nCols), sizeof(nCols));
-    writeBinaryIntLE(file, nCols);
-
-    //Write the type of the descriptor
-//    file.write((char *)(&descriptorType), sizeof(descriptorType));
-    writeBinaryIntLE(file, descriptorType);
-
-    for (int i = 0; i < nRows; i++) {
-      unsigned int i_ = (unsigned int) i;
-      //Write u
-      float u = m_trainKeyPoints[i_].pt.x;
-//      file.write((char *)(&u), sizeof(u));
-      writeBinaryFloatLE(file, u);
-
-      //Write v
-      float v = m_trainKeyPoints[i_].pt.y;
-//      file.write((char *)(&v), sizeof(v));
-      writeBinaryFloatLE(file, v);
-
-      //Write size
-      float size = m_trainKeyPoints[i_].size;
-//      file.write((char *)(&size), sizeof(size));
-      writeBinaryFloatLE(file, size);
-
-      //Write angle
-      float angle = m_trainKeyPoints[i_].angle;
-//      file.write((char *)(&angle), sizeof(angle));
-      writeBinaryFloatLE(file, angle);
-
-      //Write response
-      float response = m_trainKeyPoints[i_].response;
-//      file.write((char *)(&response), sizeof(response));
-      writeBinaryFloatLE(file, response);
-
-      //Write octave
-      int octave = m_trainKeyPoints[i_].octave;
-//      file.write((char *)(&octave), sizeof(octave));
-      writeBinaryIntLE(file, octave);
-
-      //Write class_id
-      int class_id = m_trainKeyPoints[i_].class_id;
-//      file.write((char *)(&class_id), sizeof(class_id));
-      writeBinaryIntLE(file, class_id);
-
-      //Write image_id
-#ifdef VISP_HAVE_MODULE_IO
-      std::map<int, int>::const_iterator it_findImgId = m_mapOfImageId.find(m_trainKeyPoints[i_].class_id);
-      int image_id = (saveTrainingImages && it_findImgId != m_mapOfImageId.end()) ? it_findImgId->second : -1;
-//      file.write((char *)(&image_id), sizeof(image_id));
-      writeBinaryIntLE(file, image_id);
-#else
-      int image_id = -1;
-//      file.write((char *)(&image_id), sizeof(image_id));
-      writeBinaryIntLE(file, image_id);
+    cv::Mat descriptors = m_trainDescriptors.isContinuous() ? m_trainDescriptors : m_trainDescriptors.clone();
+#ifdef VISP_BIG_ENDIAN
+    if(descriptors.elemSize1() > 1) {
+      descriptors = descriptors.clone();
+      swapElementBytes(descriptors);
+    }
 #endif
-
-      if(have3DInfo) {
-        float oX = m_trainPoints[i_].x, oY = m_trainPoints[i_].y, oZ = m_trainPoints[i_].z;
-        //Write oX
-//        file.write((char *)(&oX), sizeof(oX));
-        writeBinaryFloatLE(file, oX);
-
-        //Write oY
-//        file.write((char *)(&oY), sizeof(oY));
-        writeBinaryFloatLE(file, oY);
-
-        //Write oZ
-//        file.write((char *)(&oZ), sizeof(oZ));
-        writeBinaryFloatLE(file, oZ);
+    int nRows = descriptors.rows, nCols = descriptors.cols;
+    int descriptorType = descriptors.type();
+    uint64_t descriptorsSize = (uint64_t) descriptors.total() * (uint64_t) descriptors.elemSize();
+
+    //The training images are embedded in the file
+    bool haveImages = saveTrainingImages && !m_mapOfImages.empty();
+    int nbImgs = haveImages ? (int) m_mapOfImages.size() : 0;
+
+    uint64_t keyPointsOffset = learningDataHeaderSize;
+    uint64_t descriptorsOffset = alignOffset(keyPointsOffset + (uint64_t) nRows * learningDataKeyPointSize);
+    uint64_t pointsOffset = alignOffset(descriptorsOffset + descriptorsSize);
+    uint64_t imagesOffset = alignOffset(pointsOffset + (have3DInfo ? (uint64_t) nRows * learningDataPointSize : 0));
+    uint64_t indexOffset = imagesOffset;
+    if(haveImages) {
+      for(std::map<int, vpImage<unsigned char> >::const_iterator it = m_mapOfImages.begin(); it != m_mapOfImages.end(); ++it) {
+        indexOffset = alignOffset(indexOffset + learningDataImageHeaderSize + (uint64_t) it->second.getSize());
       }
+    }
 
-      for (int j = 0; j < nCols; j++) {
-        //Write the descriptor value
-        switch(descriptorType) {
-        case CV_8U:
-          file.write((char *)(&m_trainDescriptors.at<unsigned char>(i, j)), sizeof(m_trainDescriptors.at<unsigned char>(i, j)));
-          break;
-
-        case CV_8S:
-          file.write((char *)(&m_trainDescriptors.at<char>(i, j)), sizeof(m_trainDescriptors.at<char>(i, j)));
-          break;
-
-        case CV_16U:
-//          file.write((char *)(&m_trainDescriptors.at<unsigned short int>(i, j)), sizeof(m_trainDescriptors.at<unsigned short int>(i, j)));
-          writeBinaryUShortLE(file, m_trainDescriptors.at<unsigned short int>(i, j));
-          break;
-
-        case CV_16S:
-//          file.write((char *)(&m_trainDescriptors.at<short int>(i, j)), sizeof(m_trainDescriptors.at<short int>(i, j)));
-          writeBinaryShortLE(file, m_trainDescriptors.at<short int>(i, j));
-          break;
-
-        case CV_32S:
-//          file.write((char *)(&m_trainDescriptors.at<int>(i, j)), sizeof(m_trainDescriptors.at<int>(i, j)));
-          writeBinaryIntLE(file, m_trainDescriptors.at<int>(i, j));
-          break;
+    //Write the header
+    unsigned char header[learningDataHeaderSize];
+    memset(header, 0, sizeof(header));
+    memcpy(header, learningDataMagic, sizeof(learningDataMagic));
+    storeUInt32LE(header + 8, learningDataVersion);
+    storeUInt32LE(header + 12, (have3DInfo ? learningDataHave3DInfo : 0) | (haveImages ? learningDataHaveImages : 0) |
+                  (haveIndex ? learningDataHaveIndex : 0));
+    storeUInt32LE(header + 16, (uint32_t) nRows);
+    storeUInt32LE(header + 20, (uint32_t) nCols);
+    storeUInt32LE(header + 24, (uint32_t) descriptorType);
+    storeUInt32LE(header + 28, (uint32_t) nbImgs);
+    storeUInt64LE(header + 32, keyPointsOffset);
+    storeUInt64LE(header + 40, descriptorsOffset);
+    storeUInt64LE(header + 48, have3DInfo ? pointsOffset : 0);
+    storeUInt64LE(header + 56, haveImages ? imagesOffset : 0);
+    storeUInt64LE(header + 64, haveIndex ? indexOffset : 0);
+    file.write((char *) header, sizeof(header));
+
+    //Write the keypoint table: u, v, size, angle, response, octave, class_id and image_id
+    std::vector<unsigned char> buffer((size_t) (nRows * learningDataKeyPointSize) + 1);
+    for(int i = 0; i < nRows; i++) {
+      const cv::KeyPoint &kpt = m_trainKeyPoints[(size_t) i];
+      unsigned char *record = &buffer[(size_t) i * learningDataKeyPointSize];
+      storeFloatLE(record, kpt.pt.x);
+      storeFloatLE(record + 4, kpt.pt.y);
+      storeFloatLE(record + 8, kpt.size);
+      storeFloatLE(record + 12, kpt.angle);
+      storeFloatLE(record + 16, kpt.response);
+      storeUInt32LE(record + 20, (uint32_t) kpt.octave);
+      storeUInt32LE(record + 24, (uint32_t) kpt.class_id);
+
+      std::map<int, int>::const_iterator it_findImgId = m_mapOfImageId.find(kpt.class_id);
+      int image_id = (haveImages && it_findImgId != m_mapOfImageId.end()) ? it_findImgId->second : -1;
+      storeUInt32LE(record + 28, (uint32_t) image_id);
+    }
+    file.write((char *) &buffer[0], (std::streamsize) (nRows * learningDataKeyPointSize));
 
-        case CV_32F:
-//          file.write((char *)(&m_trainDescriptors.at<float>(i, j)), sizeof(m_trainDescriptors.at<float>(i, j)));
-          writeBinaryFloatLE(file, m_trainDescriptors.at<float>(i, j));
-          break;
+    //Write the descriptors, row major
+    writePadding(file, descriptorsOffset);
+    if(descriptorsSize > 0) {
+      file.write((char *) descriptors.data, (std::streamsize) descriptorsSize);
+    }
 
-        case CV_64F:
-//          file.write((char *)(&m_trainDescriptors.at<double>(i, j)), sizeof(m_trainDescriptors.at<double>(i, j)));
-          writeBinaryDoubleLE(file, m_trainDescriptors.at<double>(i, j));
-          break;
+    //Write the 3D points
+    if(have3DInfo) {
+      writePadding(file, pointsOffset);
+      buffer.resize((size_t) (nRows * learningDataPointSize) + 1);
+      for(int i = 0; i < nRows; i++) {
+        const cv::Point3f &pt = m_trainPoints[(size_t) i];
+        unsigned char *record = &buffer[(size_t) i * learningDataPointSize];
+        storeFloatLE(record, pt.x);
+        storeFloatLE(record + 4, pt.y);
+        storeFloatLE(record + 8, pt.z);
+      }
+      file.write((char *) &buffer[0], (std::streamsize) (nRows * learningDataPointSize));
+    }
 
-        default:
-          throw vpException(vpException::fatalError, "Problem with the data type of descriptors !");
-          break;
+    //Write the training images: image_id, height, width and the pixels
+    if(haveImages) {
+      uint64_t offset = imagesOffset;
+      for(std::map<int, vpImage<unsigned char> >::const_iterator it = m_mapOfImages.begin(); it != m_mapOfImages.end(); ++it) {
+        writePadding(file, offset);
+        unsigned char imageHeader[learningDataImageHeaderSize];
+        memset(imageHeader, 0, sizeof(imageHeader));
+        storeUInt32LE(imageHeader, (uint32_t) it->first);
+        storeUInt32LE(imageHeader + 4, it->second.getHeight());
+        storeUInt32LE(imageHeader + 8, it->second.getWidth());
+        file.write((char *) imageHeader, sizeof(imageHeader));
+        if(it->second.getSize() > 0) {
+          file.write((char *) it->second.bitmap, (std::streamsize) it->second.getSize());
         }
+        offset = alignOffset(offset + learningDataImageHeaderSize + (uint64_t) it->second.getSize());
       }
     }
 
+    if(haveIndex) {
+      writePadding(file, indexOffset);
+      m_hammingIndex.save(file);
+    }
 
+    if(!file.good()) {
+      throw vpException(vpException::ioError, "Cannot write the file %s", filename.c_str());
+    }
     file.close();
   } else {
 #ifdef VISP_HAVE_XML2
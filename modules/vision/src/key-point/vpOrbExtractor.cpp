@@ -0,0 +1,281 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * ORB binary descriptor.
+ *
+ *****************************************************************************/
+
+
+#include <algorithm>
+#include <cmath>
+#include <stdint.h>
+#include <string.h>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/vision/vpOrbExtractor.h>
+
+namespace {
+  //! Number of point pairs, i.e. number of bits of a descriptor
+  const unsigned int nbPairs = 256;
+  //! Number of precomputed pattern orientations
+  const unsigned int nbAngleBins = 30;
+  //! Radius of the disk used to compute the orientation
+  const int orientationRadius = 15;
+  //! Maximum distance of a pattern point to the keypoint
+  const int patternRadius = 13;
+
+  //! Minimal standard generator of Park and Miller, without any shared state
+  class vpParkMillerRand
+  {
+  public:
+    explicit vpParkMillerRand(const uint32_t seed) : m_state(seed % 2147483647u ? seed % 2147483647u : 1) {}
+
+    //! Uniform value in ]0 ; 1[
+    double operator()()
+    {
+      m_state = (uint32_t) (((uint64_t) m_state * 48271u) % 2147483647u);
+      return m_state / 2147483647.0;
+    }
+
+  private:
+    uint32_t m_state;
+  };
+
+  //! Sum of the 5x5 box centred on (i, j) read from an integral image
+  inline unsigned int boxSum(const vpImage<unsigned int> &integral, const int i, const int j)
+  {
+    const unsigned int *top = integral[i-2], *bottom = integral[i+3];
+    return bottom[j+3] - top[j+3] - bottom[j-2] + top[j-2];
+  }
+}
+
+/*!
+  Default constructor. The sampling pattern is drawn with a fixed seed so that the
+  descriptors computed by two instances can be compared.
+*/
+vpOrbExtractor::vpOrbExtractor()
+  : m_integrals(), m_nbThreads(1), m_patterns(nbAngleBins), m_pyramid(1), m_umax(orientationRadius+1)
+{
+  for (int v = 0; v <= orientationRadius; v++) {
+    m_umax[(size_t) v] = (int) std::floor(std::sqrt((double) (orientationRadius*orientationRadius - v*v)) + 0.5);
+  }
+
+  // Marsaglia polar method on a local generator: vpUniRand and vpGaussRand keep a static
+  // state shared by all their instances, which would make the pattern depend on previous draws
+  vpParkMillerRand rng(0x2545F491);
+  const double sigma = vpFastDetector::patchSize / 5.0;
+  std::vector<double> pattern(4*nbPairs);
+  for (size_t k = 0; k < pattern.size(); k += 2) {
+    double x, y;
+    do {
+      double v1, v2, rsq;
+      do {
+        v1 = 2 * rng() - 1;
+        v2 = 2 * rng() - 1;
+        rsq = v1*v1 + v2*v2;
+      } while (rsq >= 1 || rsq == 0);
+      const double fac = sigma * sqrt(-2 * log(rsq) / rsq);
+      x = v1 * fac;
+      y = v2 * fac;
+    } while (x*x + y*y > patternRadius*patternRadius);
+    pattern[k] = x;
+    pattern[k+1] = y;
+  }
+
+  for (unsigned int bin = 0; bin < nbAngleBins; bin++) {
+    const double theta = vpMath::rad(bin * 360.0 / nbAngleBins);
+    const double c = cos(theta), s = sin(theta);
+    std::vector<int> &rotated = m_patterns[bin];
+    rotated.resize(pattern.size());
+    for (size_t k = 0; k < pattern.size(); k += 2) {
+      rotated[k] = vpMath::round(c * pattern[k] - s * pattern[k+1]);
+      rotated[k+1] = vpMath::round(s * pattern[k] + c * pattern[k+1]);
+    }
+  }
+}
+
+/*!
+  Compute the descriptors of keypoints detected on an image. The keypoint octaves
+  are used to describe each keypoint on the level of a Gaussian pyramid where it
+  was detected.
+
+  \param I : Input image.
+  \param keyPoints : Keypoints to describe. On output, the keypoints that could not be
+  described are removed and the orientation of the others is set.
+  \param descriptors : One row of descriptorSize bytes per keypoint.
+*/
+void vpOrbExtractor::compute(const vpImage<unsigned char> &I, std::vector<vpFastKeyPoint> &keyPoints,
+                             vpArray2D<unsigned char> &descriptors)
+{
+  unsigned int nbLevels = 1;
+  for (std::vector<vpFastKeyPoint>::const_iterator it = keyPoints.begin(); it != keyPoints.end(); ++it) {
+    nbLevels = (std::max)(nbLevels, it->octave + 1);
+  }
+
+  m_pyramid.setNbLevels(nbLevels);
+  m_pyramid.setNbThreads(m_nbThreads);
+  m_pyramid.build(I);
+  compute(m_pyramid, keyPoints, descriptors);
+}
+
+/*!
+  Compute the descriptors of keypoints on the levels of an already built pyramid, for
+  instance the one given to vpFastDetector::detect(const vpImagePyramid &, std::vector<vpFastKeyPoint> &).
+
+  \param pyramid : Image pyramid.
+  \param keyPoints : Keypoints to describe. On output, the keypoints that could not be
+  described are removed and the orientation of the others is set.
+  \param descriptors : One row of descriptorSize bytes per keypoint.
+*/
+void vpOrbExtractor::compute(const vpImagePyramid &pyramid, std::vector<vpFastKeyPoint> &keyPoints,
+                             vpArray2D<unsigned char> &descriptors)
+{
+  if (!pyramid.isBuilt()) {
+    throw vpException(vpException::notInitialized, "The image pyramid is not built");
+  }
+
+  const unsigned int nbLevels = pyramid.getNbLevels();
+  std::vector<bool> usedLevels(nbLevels, false);
+
+  // Remove the keypoints that cannot be described
+  size_t nbKeyPoints = 0;
+  for (size_t k = 0; k < keyPoints.size(); k++) {
+    const vpFastKeyPoint &kpt = keyPoints[k];
+    if (kpt.octave >= nbLevels) {
+      continue;
+    }
+
+    const vpImage<unsigned char> &I = pyramid[kpt.octave];
+    const double scale = (double) (1u << kpt.octave);
+    const int i = vpMath::round(kpt.v / scale), j = vpMath::round(kpt.u / scale);
+    if (i < borderSize || j < borderSize || i >= (int) I.getHeight() - borderSize ||
+        j >= (int) I.getWidth() - borderSize) {
+      continue;
+    }
+
+    usedLevels[kpt.octave] = true;
+    keyPoints[nbKeyPoints++] = kpt;
+  }
+  keyPoints.resize(nbKeyPoints);
+
+  m_integrals.resize(nbLevels);
+  for (unsigned int level = 0; level < nbLevels; level++) {
+    if (usedLevels[level]) {
+      computeIntegral(pyramid[level], m_integrals[level]);
+    }
+  }
+
+  descriptors.resize((unsigned int) nbKeyPoints, descriptorSize, false, false);
+  const unsigned int nbThreads = m_nbThreads;
+  (void) nbThreads;
+#ifdef VISP_HAVE_OPENMP
+  #pragma omp parallel for num_threads(nbThreads) if(nbThreads > 1)
+#endif
+  for (int k = 0; k < (int) nbKeyPoints; k++) {
+    vpFastKeyPoint &kpt = keyPoints[(size_t) k];
+    const double scale = (double) (1u << kpt.octave);
+    const int i = vpMath::round(kpt.v / scale), j = vpMath::round(kpt.u / scale);
+
+    kpt.angle = computeOrientation(pyramid[kpt.octave], i, j);
+    describe(m_integrals[kpt.octave], i, j, kpt.angle, descriptors[(unsigned int) k]);
+  }
+}
+
+void vpOrbExtractor::computeIntegral(const vpImage<unsigned char> &I, vpImage<unsigned int> &integral)
+{
+  const unsigned int height = I.getHeight(), width = I.getWidth();
+  integral.resize(height + 1, width + 1);
+  memset(integral[0], 0, (width + 1) * sizeof(unsigned int));
+
+  for (unsigned int i = 0; i < height; i++) {
+    const unsigned char *src = I[i];
+    const unsigned int *prev = integral[i];
+    unsigned int *dst = integral[i+1];
+    unsigned int rowSum = 0;
+    dst[0] = 0;
+    for (unsigned int j = 0; j < width; j++) {
+      rowSum += src[j];
+      dst[j+1] = prev[j+1] + rowSum;
+    }
+  }
+}
+
+/*!
+  Orientation in degrees of the vector from the keypoint to the intensity centroid of
+  the disk of radius 15 centred on it.
+*/
+double vpOrbExtractor::computeOrientation(const vpImage<unsigned char> &I, const int i, const int j) const
+{
+  int m01 = 0, m10 = 0;
+
+  const unsigned char *center = I[i] + j;
+  for (int u = -orientationRadius; u <= orientationRadius; u++) {
+    m10 += u * center[u];
+  }
+
+  const int width = (int) I.getWidth();
+  for (int v = 1; v <= orientationRadius; v++) {
+    int sumDiff = 0;
+    const int d = m_umax[(size_t) v];
+    for (int u = -d; u <= d; u++) {
+      const int below = center[u + v*width], above = center[u - v*width];
+      sumDiff += below - above;
+      m10 += u * (below + above);
+    }
+    m01 += v * sumDiff;
+  }
+
+  double angle = vpMath::deg(atan2((double) m01, (double) m10));
+  if (angle < 0) {
+    angle += 360.0;
+  }
+
+  return angle;
+}
+
+void vpOrbExtractor::describe(const vpImage<unsigned int> &integral, const int i, const int j, const double angle,
+                              unsigned char *desc) const
+{
+  const unsigned int bin = (unsigned int) vpMath::round(angle * nbAngleBins / 360.0) % nbAngleBins;
+  const int *pattern = &m_patterns[bin][0];
+
+  // The integral image has one more row and column than the image
+  for (unsigned int byte = 0; byte < descriptorSize; byte++) {
+    unsigned char value = 0;
+    for (unsigned int bit = 0; bit < 8; bit++, pattern += 4) {
+      const unsigned int s1 = boxSum(integral, i + pattern[1], j + pattern[0]);
+      const unsigned int s2 = boxSum(integral, i + pattern[3], j + pattern[2]);
+      value |= (unsigned char) ((s1 < s2) << bit);
+    }
+    desc[byte] = value;
+  }
+}
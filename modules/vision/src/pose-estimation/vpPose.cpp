@@ -55,6 +55,7 @@ pour faire du calcul de pose par difference methode
 
 #include <cmath>    // std::fabs
 #include <limits>   // numeric_limits
+#include <vector>
 
 #define DEBUG_LEVEL1 0
 /*!
@@ -86,6 +87,8 @@ vpPose::init()
   useParallelRansac = false;
   nbParallelRansacThreads = 0;
   vvsEpsilon = 1e-8;
+  ransacMethod = RANSAC_UNIFORM_SAMPLING;
+  ransacQualities.clear();
 
 #if (DEBUG_LEVEL1)
   std::cout << "end vpPose::Init() " << std::endl ;
@@ -100,7 +103,7 @@ vpPose::vpPose()
     ransacNbInlierConsensus(4), ransacMaxTrials(1000), ransacInliers(), ransacInlierIndex(), ransacThreshold(0.0001),
     distanceToPlaneForCoplanarityTest(0.001), ransacFlags(PREFILTER_DUPLICATE_POINTS),
     listOfPoints(), useParallelRansac(false), nbParallelRansacThreads(0), //0 means that OpenMP is used to get the number of CPU threads
-    vvsEpsilon(1e-8)
+    vvsEpsilon(1e-8), ransacMethod(RANSAC_UNIFORM_SAMPLING), ransacQualities()
 {
 }
 
@@ -127,6 +130,7 @@ vpPose::clearPoint()
 {
   listP.clear();
   listOfPoints.clear();
+  ransacQualities.clear();
   npt = 0 ;
 }
 
@@ -333,17 +337,22 @@ the pose matrix 'cMo'.
 double
 vpPose::computeResidual(const vpHomogeneousMatrix &cMo) const
 {
-  double residual_ = 0 ;
-  vpPoint P ;
-  for(std::list<vpPoint>::const_iterator it=listP.begin(); it != listP.end(); ++it)
+  // The points are projected together rather than through a vpPoint copy per point
+  std::vector<double> oX(listP.size()), oY(listP.size()), oZ(listP.size()), x, y;
+  size_t i = 0;
+  for(std::list<vpPoint>::const_iterator it=listP.begin(); it != listP.end(); ++it, i++)
   {
-    P = *it;
-    double x = P.get_x() ;
-    double y = P.get_y() ;
-
-    P.track(cMo) ;
+    oX[i] = it->get_oX();
+    oY[i] = it->get_oY();
+    oZ[i] = it->get_oZ();
+  }
+  vpMeterPixelConversion::projectPoints(cMo, oX, oY, oZ, x, y);
 
-    residual_ += vpMath::sqr(x-P.get_x()) + vpMath::sqr(y-P.get_y())  ;
+  double residual_ = 0 ;
+  i = 0;
+  for(std::list<vpPoint>::const_iterator it=listP.begin(); it != listP.end(); ++it, i++)
+  {
+    residual_ += vpMath::sqr(it->get_x()-x[i]) + vpMath::sqr(it->get_y()-y[i])  ;
   }
   return residual_ ;
 }
@@ -54,9 +54,11 @@
 
 #include <visp3/vision/vpPose.h>
 #include <visp3/core/vpColVector.h>
+#include <visp3/core/vpCPUFeatures.h>
 #include <visp3/core/vpRansac.h>
 #include <visp3/vision/vpPoseException.h>
 #include <visp3/core/vpMath.h>
+#include <visp3/core/vpMeterPixelConversion.h>
 
 #if defined (VISP_HAVE_CPP11_COMPATIBILITY)
 #  include <unordered_map>
@@ -66,6 +68,11 @@
 #  include <omp.h>
 #endif
 
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
+
 #define eps 1e-6
 
 
@@ -189,6 +196,165 @@ struct ComparePointDuplicateUnorderedMap {
   }
 };
 #endif
+
+//Number of hypotheses generated and scored together by the PROSAC engine
+const unsigned int prosacBatchSize = 32;
+//Number of points used to score the hypotheses of a batch before keeping the best half
+const unsigned int prosacBlockSize = 64;
+//Number of samples after which PROSAC draws the minimal sets uniformly, as in the original paper
+const double prosacGrowthMaxSamples = 200000.0;
+//Probability that an outlier-free minimal set was drawn, used to stop the PROSAC engine
+const double prosacConfidence = 0.99;
+
+//Xorshift generator, a state per vpPose::poseRansac() call keeps the results reproducible
+class vpRansacRand {
+public:
+  explicit vpRansacRand(const unsigned int seed) : m_state(seed != 0 ? seed : 0x9E3779B9u) {}
+
+  //Return an integer in [0 ; n[
+  unsigned int operator()(const unsigned int n) {
+    m_state ^= (m_state << 13) & 0xFFFFFFFFu;
+    m_state ^= m_state >> 17;
+    m_state ^= (m_state << 5) & 0xFFFFFFFFu;
+    return (unsigned int) (m_state % n);
+  }
+
+private:
+  unsigned long m_state;
+};
+
+//std::stable_sort by decreasing quality
+struct CompareQuality {
+  explicit CompareQuality(const std::vector<double> &qualities) : m_qualities(qualities) { }
+
+  bool operator()(const unsigned int i, const unsigned int j) const {
+    return m_qualities[i] > m_qualities[j];
+  }
+
+  const std::vector<double> &m_qualities;
+};
+
+//std::stable_sort by decreasing score
+struct CompareScore {
+  explicit CompareScore(const std::vector<unsigned int> &scores) : m_scores(scores) { }
+
+  bool operator()(const unsigned int i, const unsigned int j) const {
+    return m_scores[i] > m_scores[j];
+  }
+
+  const std::vector<unsigned int> &m_scores;
+};
+
+//Point coordinates stored as structure of arrays to project them with SIMD instructions
+struct vpRansacPoints {
+  std::vector<double> oX, oY, oZ, x, y;
+};
+
+//Object frame coordinates of the points, to project them with vpMeterPixelConversion::projectPoints()
+void objectCoordinates(const std::vector<vpPoint> &points, vpRansacPoints &pts) {
+  pts.oX.resize(points.size());
+  pts.oY.resize(points.size());
+  pts.oZ.resize(points.size());
+  for (size_t i = 0; i < points.size(); i++) {
+    pts.oX[i] = points[i].get_oX();
+    pts.oY[i] = points[i].get_oY();
+    pts.oZ[i] = points[i].get_oZ();
+  }
+}
+
+//Squared reprojection error of a point, computed in the same order as the SSE2 version
+inline double reprojectionError2(const double *M, const double oX, const double oY, const double oZ,
+                                 const double x, const double y) {
+  double X = M[0] * oX + M[1] * oY + M[2] * oZ + M[3];
+  double Y = M[4] * oX + M[5] * oY + M[6] * oZ + M[7];
+  double Z = M[8] * oX + M[9] * oY + M[10] * oZ + M[11];
+  double dx = X / Z - x;
+  double dy = Y / Z - y;
+  return dx * dx + dy * dy;
+}
+
+//Count the points in [begin ; end[ whose reprojection error is below the threshold
+unsigned int countInliers(const vpHomogeneousMatrix &cMo, const vpRansacPoints &pts, const unsigned int begin,
+                          const unsigned int end, const double threshold2, const bool checkSSE2) {
+  const double M[12] = { cMo[0][0], cMo[0][1], cMo[0][2], cMo[0][3],
+                         cMo[1][0], cMo[1][1], cMo[1][2], cMo[1][3],
+                         cMo[2][0], cMo[2][1], cMo[2][2], cMo[2][3] };
+  const double *oX = pts.oX.empty() ? NULL : &pts.oX[0], *oY = pts.oY.empty() ? NULL : &pts.oY[0];
+  const double *oZ = pts.oZ.empty() ? NULL : &pts.oZ[0];
+  const double *x = pts.x.empty() ? NULL : &pts.x[0], *y = pts.y.empty() ? NULL : &pts.y[0];
+
+  unsigned int nbInliers = 0;
+  unsigned int i = begin;
+#if VISP_HAVE_SSE2
+  if (checkSSE2) {
+    const __m128d m0 = _mm_set1_pd(M[0]), m1 = _mm_set1_pd(M[1]), m2 = _mm_set1_pd(M[2]), m3 = _mm_set1_pd(M[3]);
+    const __m128d m4 = _mm_set1_pd(M[4]), m5 = _mm_set1_pd(M[5]), m6 = _mm_set1_pd(M[6]), m7 = _mm_set1_pd(M[7]);
+    const __m128d m8 = _mm_set1_pd(M[8]), m9 = _mm_set1_pd(M[9]), m10 = _mm_set1_pd(M[10]), m11 = _mm_set1_pd(M[11]);
+    const __m128d thresh = _mm_set1_pd(threshold2);
+
+    for (; i + 2 <= end; i += 2) {
+      const __m128d vX = _mm_loadu_pd(oX + i), vY = _mm_loadu_pd(oY + i), vZ = _mm_loadu_pd(oZ + i);
+      const __m128d X = _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(m0, vX), _mm_mul_pd(m1, vY)), _mm_mul_pd(m2, vZ)), m3);
+      const __m128d Y = _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(m4, vX), _mm_mul_pd(m5, vY)), _mm_mul_pd(m6, vZ)), m7);
+      const __m128d Z = _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(m8, vX), _mm_mul_pd(m9, vY)), _mm_mul_pd(m10, vZ)), m11);
+      const __m128d dx = _mm_sub_pd(_mm_div_pd(X, Z), _mm_loadu_pd(x + i));
+      const __m128d dy = _mm_sub_pd(_mm_div_pd(Y, Z), _mm_loadu_pd(y + i));
+      const int mask = _mm_movemask_pd(_mm_cmplt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), thresh));
+      nbInliers += (unsigned int) ((mask & 1) + (mask >> 1));
+    }
+  }
+#else
+  (void) checkSSE2;
+#endif
+
+  for (; i < end; i++) {
+    if (reprojectionError2(M, oX[i], oY[i], oZ[i], x[i], y[i]) < threshold2) {
+      nbInliers++;
+    }
+  }
+
+  return nbInliers;
+}
+
+//Pose from a minimal set, with the same validation as the uniform sampling engine
+bool computeMinimalPose(vpPose &poseMin, const std::vector<vpPoint> &points, const unsigned int *sample,
+                        const unsigned int nbMinRandom, const double threshold,
+                        bool (*func)(vpHomogeneousMatrix *), vpHomogeneousMatrix &cMo) {
+  poseMin.clearPoint();
+  for (unsigned int k = 0; k < nbMinRandom; k++) {
+    poseMin.addPoint(points[sample[k]]);
+  }
+
+  vpHomogeneousMatrix cMo_lagrange, cMo_dementhon;
+  double r_lagrange = DBL_MAX, r_dementhon = DBL_MAX;
+  try {
+    poseMin.computePose(vpPose::LAGRANGE, cMo_lagrange);
+    r_lagrange = poseMin.computeResidual(cMo_lagrange);
+  } catch(...) { }
+  if (vpMath::isNaN(r_lagrange)) {
+    r_lagrange = DBL_MAX;
+  }
+
+  //Dementhon is only tried when Lagrange does not give a valid hypothesis
+  if (r_lagrange == DBL_MAX || sqrt(r_lagrange) / (double) nbMinRandom >= threshold) {
+    try {
+      poseMin.computePose(vpPose::DEMENTHON, cMo_dementhon);
+      r_dementhon = poseMin.computeResidual(cMo_dementhon);
+    } catch(...) { }
+    if (vpMath::isNaN(r_dementhon)) {
+      r_dementhon = DBL_MAX;
+    }
+  }
+
+  double r = (std::min)(r_lagrange, r_dementhon);
+  if (r == DBL_MAX || sqrt(r) / (double) nbMinRandom >= threshold) {
+    return false;
+  }
+  cMo = r_lagrange <= r_dementhon ? cMo_lagrange : cMo_dementhon;
+
+  //Filter the pose using some criterion (orientation angles, translations, etc.)
+  return func == NULL || func(&cMo);
+}
 }
 
 bool vpPose::RansacFunctor::poseRansacImpl() {
@@ -200,7 +366,9 @@ bool vpPose::RansacFunctor::poseRansacImpl() {
   srand(m_initial_seed);
 #endif
 
-  vpPoint p; //Point used to project using the estimated pose
+  //Points projected using the estimated pose
+  vpRansacPoints pts;
+  objectCoordinates(m_listOfUniquePoints, pts);
 
   bool foundSolution = false;
   while (nbTrials < m_ransacMaxTrials && m_nbInliers < (unsigned int) m_ransacNbInlierConsensus)
@@ -331,12 +499,10 @@ bool vpPose::RansacFunctor::poseRansacImpl() {
       {
         unsigned int nbInliersCur = 0;
         unsigned int iter = 0;
+        vpMeterPixelConversion::projectPoints(m_cMo, pts.oX, pts.oY, pts.oZ, pts.x, pts.y);
         for (std::vector<vpPoint>::const_iterator it = m_listOfUniquePoints.begin(); it != m_listOfUniquePoints.end(); ++it, iter++)
         {
-          p.setWorldCoordinates(it->get_oX(), it->get_oY(), it->get_oZ());
-          p.track(m_cMo);
-
-          double d = vpMath::sqr(p.get_x() - it->get_x()) + vpMath::sqr(p.get_y() - it->get_y());
+          double d = vpMath::sqr(pts.x[iter] - it->get_x()) + vpMath::sqr(pts.y[iter] - it->get_y());
           double error = sqrt(d);
           if(error < m_ransacThreshold) {
             bool degenerate = false;
@@ -392,6 +558,206 @@ vpThread::Return vpPose::poseRansacImplThread(vpThread::Args arg) {
 }
 #endif
 
+/*!
+  PROSAC engine with preemptive scoring, see vpPose::RANSAC_PROSAC.
+
+  \param listOfUniquePoints : Points after the prefiltering.
+  \param qualities : Quality of each point of \e listOfUniquePoints, or empty.
+  \param func : Pointer to a function that checks the pose, or NULL.
+  \param best_consensus : Index of the inliers in \e listOfUniquePoints, in increasing order.
+  \param nbInliers : Size of \e best_consensus.
+  \return True if a pose with a reprojection error of the minimal set below ransacThreshold was found.
+*/
+bool vpPose::poseRansacProsac(const std::vector<vpPoint> &listOfUniquePoints, const std::vector<double> &qualities,
+                              bool (*func)(vpHomogeneousMatrix *), std::vector<unsigned int> &best_consensus,
+                              unsigned int &nbInliers)
+{
+  const unsigned int size = (unsigned int) listOfUniquePoints.size();
+  const unsigned int nbMinRandom = 4;
+  const bool checkDegeneratePoints = (ransacFlags & CHECK_DEGENERATE_POINTS) != 0;
+  const bool checkSSE2 = vpCPUFeatures::checkSSE2();
+  const double threshold2 = ransacThreshold * ransacThreshold;
+
+  best_consensus.clear();
+  nbInliers = 0;
+
+  //Points sorted by decreasing quality, the insertion order is kept for equal qualities
+  std::vector<unsigned int> sortedIndex(size);
+  for (unsigned int i = 0; i < size; i++) {
+    sortedIndex[i] = i;
+  }
+  if (!qualities.empty()) {
+    std::stable_sort(sortedIndex.begin(), sortedIndex.end(), CompareQuality(qualities));
+  }
+
+  //The points are scored in a random order so that each block is representative of the whole set
+  vpRansacRand rng(size);
+  std::vector<unsigned int> scoringIndex(size);
+  for (unsigned int i = 0; i < size; i++) {
+    scoringIndex[i] = i;
+  }
+  for (unsigned int i = size - 1; i > 0; i--) {
+    std::swap(scoringIndex[i], scoringIndex[rng(i + 1)]);
+  }
+
+  vpRansacPoints pts;
+  pts.oX.resize(size);
+  pts.oY.resize(size);
+  pts.oZ.resize(size);
+  pts.x.resize(size);
+  pts.y.resize(size);
+  for (unsigned int i = 0; i < size; i++) {
+    const vpPoint &pt = listOfUniquePoints[scoringIndex[i]];
+    pts.oX[i] = pt.get_oX();
+    pts.oY[i] = pt.get_oY();
+    pts.oZ[i] = pt.get_oZ();
+    pts.x[i] = pt.get_x();
+    pts.y[i] = pt.get_y();
+  }
+
+  int nbThreads = 1;
+#if defined(VISP_HAVE_OPENMP)
+  if (useParallelRansac) {
+    nbThreads = nbParallelRansacThreads > 0 ? nbParallelRansacThreads : omp_get_max_threads();
+  }
+#endif
+  (void) nbThreads;
+
+  //Growth function of the sampling set, see Chum and Matas, PROSAC, CVPR 2005
+  unsigned int n = nbMinRandom;
+  double T_n = prosacGrowthMaxSamples;
+  for (unsigned int i = 0; i < nbMinRandom; i++) {
+    T_n *= (double) (n - i) / (double) (size - i);
+  }
+  double T_n_prime = 1.0;
+  unsigned int t = 0;
+
+  std::vector<unsigned int> samples(prosacBatchSize * nbMinRandom);
+  std::vector<vpHomogeneousMatrix> hypotheses(prosacBatchSize);
+  std::vector<int> validHypotheses(prosacBatchSize);
+  std::vector<unsigned int> scores(prosacBatchSize);
+  std::vector<unsigned int> preemption;
+  preemption.reserve(prosacBatchSize);
+
+  vpHomogeneousMatrix bestPose;
+  unsigned int bestScore = 0;
+  bool foundSolution = false;
+  int nbTrials = 0;
+  int maxTrials = ransacMaxTrials;
+
+  while (nbTrials < maxTrials && bestScore < ransacNbInlierConsensus) {
+    //Draw the minimal sets sequentially to get the same results whatever the number of threads
+    const unsigned int batchSize = (std::min)(prosacBatchSize, (unsigned int) (maxTrials - nbTrials));
+    int nbSamples = 0;
+    for (unsigned int b = 0; b < batchSize; b++) {
+      t++;
+      while (t >= T_n_prime && n < size) {
+        double T_n1 = T_n * (double) (n + 1) / (double) (n + 1 - nbMinRandom);
+        n++;
+        T_n_prime += ceil(T_n1 - T_n);
+        T_n = T_n1;
+      }
+
+      unsigned int *sample = &samples[(size_t) nbSamples * nbMinRandom];
+      unsigned int k = 0;
+      //Until T_n_prime samples, the last point of the sampling set is always used
+      if (T_n_prime >= t) {
+        sample[k++] = sortedIndex[n - 1];
+      }
+      const unsigned int poolSize = k > 0 ? n - 1 : n;
+
+      for (unsigned int nbDraws = 0; k < nbMinRandom && nbDraws < 10 * nbMinRandom; nbDraws++) {
+        const unsigned int index = sortedIndex[rng(poolSize)];
+        bool rejected = false;
+        for (unsigned int j = 0; j < k && !rejected; j++) {
+          rejected = sample[j] == index ||
+              (checkDegeneratePoints && FindDegeneratePoint(listOfUniquePoints[index])(listOfUniquePoints[sample[j]]));
+        }
+        if (!rejected) {
+          sample[k++] = index;
+        }
+      }
+
+      if (k == nbMinRandom) {
+        nbSamples++;
+      }
+    }
+    nbTrials += (int) batchSize;
+
+#ifdef VISP_HAVE_OPENMP
+    #pragma omp parallel for num_threads(nbThreads) if(nbThreads > 1)
+#endif
+    for (int b = 0; b < nbSamples; b++) {
+      vpPose poseMin;
+      validHypotheses[(size_t) b] = computeMinimalPose(poseMin, listOfUniquePoints, &samples[(size_t) b * nbMinRandom],
+                                                       nbMinRandom, ransacThreshold, func, hypotheses[(size_t) b]) ? 1 : 0;
+    }
+
+    //Preemptive scoring: the best half of the hypotheses is kept after each block of points
+    preemption.clear();
+    for (int b = 0; b < nbSamples; b++) {
+      if (validHypotheses[(size_t) b]) {
+        preemption.push_back((unsigned int) b);
+        scores[(size_t) b] = 0;
+      }
+    }
+    if (preemption.empty()) {
+      continue;
+    }
+
+    unsigned int begin = 0;
+    while (preemption.size() > 1 && begin < size) {
+      const unsigned int end = (std::min)(begin + prosacBlockSize, size);
+      for (size_t i = 0; i < preemption.size(); i++) {
+        scores[preemption[i]] += countInliers(hypotheses[preemption[i]], pts, begin, end, threshold2, checkSSE2);
+      }
+      begin = end;
+
+      std::stable_sort(preemption.begin(), preemption.end(), CompareScore(scores));
+      preemption.resize((preemption.size() + 1) / 2);
+    }
+    const unsigned int best = preemption.front();
+    scores[best] += countInliers(hypotheses[best], pts, begin, size, threshold2, checkSSE2);
+
+    if (scores[best] > bestScore) {
+      foundSolution = true;
+      bestScore = scores[best];
+      bestPose = hypotheses[best];
+
+      //Number of samples needed to draw an outlier-free minimal set with the current inlier ratio
+      int nbIterations = computeRansacIterations(prosacConfidence, 1.0 - bestScore / (double) size,
+                                                 (int) nbMinRandom, ransacMaxTrials);
+      if (nbIterations > 0 && nbIterations < maxTrials) {
+        maxTrials = nbIterations;
+      }
+    }
+  }
+
+  if (!foundSolution) {
+    return false;
+  }
+
+  //Consensus set of the best hypothesis, computed as with the uniform sampling engine
+  const double M[12] = { bestPose[0][0], bestPose[0][1], bestPose[0][2], bestPose[0][3],
+                         bestPose[1][0], bestPose[1][1], bestPose[1][2], bestPose[1][3],
+                         bestPose[2][0], bestPose[2][1], bestPose[2][2], bestPose[2][3] };
+  std::vector<vpPoint> cur_inliers;
+  for (unsigned int i = 0; i < size; i++) {
+    const vpPoint &pt = listOfUniquePoints[i];
+    if (reprojectionError2(M, pt.get_oX(), pt.get_oY(), pt.get_oZ(), pt.get_x(), pt.get_y()) < threshold2) {
+      if (checkDegeneratePoints &&
+          std::find_if(cur_inliers.begin(), cur_inliers.end(), FindDegeneratePoint(pt)) != cur_inliers.end()) {
+        continue;
+      }
+      best_consensus.push_back(i);
+      cur_inliers.push_back(pt);
+    }
+  }
+  nbInliers = (unsigned int) best_consensus.size();
+
+  return true;
+}
+
 /*!
   Compute the pose using the Ransac approach.
 
@@ -505,7 +871,13 @@ bool vpPose::poseRansac(vpHomogeneousMatrix & cMo, bool (*func)(vpHomogeneousMat
   }
 
 
-  bool executeParallelVersion = useParallelRansac;
+  if (!ransacQualities.empty() && ransacQualities.size() != listOfPoints.size()) {
+    throw(vpException(vpException::dimensionError, "%d RANSAC qualities were given for %d points",
+                      (int) ransacQualities.size(), (int) listOfPoints.size()));
+  }
+
+  //The PROSAC engine handles its own threads
+  bool executeParallelVersion = useParallelRansac && ransacMethod != RANSAC_PROSAC;
 
 #if defined (VISP_HAVE_PTHREAD) || (defined (_WIN32) && !defined(WINRT_8_0))
 #  define VP_THREAD_OK
@@ -544,7 +916,17 @@ bool vpPose::poseRansac(vpHomogeneousMatrix & cMo, bool (*func)(vpHomogeneousMat
 
   bool foundSolution = false;
 
-  if(executeParallelVersion) {
+  if (ransacMethod == RANSAC_PROSAC) {
+    std::vector<double> uniqueQualities;
+    if (!ransacQualities.empty()) {
+      uniqueQualities.resize(size);
+      for (unsigned int i = 0; i < size; i++) {
+        uniqueQualities[i] = ransacQualities[mapOfUniquePointIndex[i]];
+      }
+    }
+
+    foundSolution = poseRansacProsac(listOfUniquePoints, uniqueQualities, func, best_consensus, nbInliers);
+  } else if(executeParallelVersion) {
 #if defined (PARALLEL_RANSAC_OPEN_MP)
     //List of points picked randomly (minimal sample set, MSS)
     //std::vector<unsigned int> best_randoms; // never used
@@ -577,7 +959,9 @@ bool vpPose::poseRansac(vpHomogeneousMatrix & cMo, bool (*func)(vpHomogeneousMat
       //True if we found a consensus set with a size > ransacNbInlierConsensus
       bool foundSolutionWithConsensus = false;
 
-      vpPoint p; //Point used to project using the estimated pose
+      //Points projected using the estimated pose
+      vpRansacPoints pts;
+      objectCoordinates(listOfUniquePoints, pts);
 
 #pragma omp for
       for(int nbTrials = 0; nbTrials < ransacMaxTrials; nbTrials++) {
@@ -695,11 +1079,9 @@ bool vpPose::poseRansac(vpHomogeneousMatrix & cMo, bool (*func)(vpHomogeneousMat
               if (isPoseValid && r < ransacThreshold) {
                 unsigned int nbInliersCur = 0;
                 unsigned int iter = 0;
+                vpMeterPixelConversion::projectPoints(cMo_tmp, pts.oX, pts.oY, pts.oZ, pts.x, pts.y);
                 for (std::vector<vpPoint>::const_iterator it = listOfUniquePoints.begin(); it != listOfUniquePoints.end(); ++it, iter++) {
-                  p.setWorldCoordinates(it->get_oX(), it->get_oY(), it->get_oZ());
-                  p.track(cMo_tmp);
-
-                  double d = vpMath::sqr(p.get_x() - it->get_x()) + vpMath::sqr(p.get_y() - it->get_y()) ;
+                  double d = vpMath::sqr(pts.x[iter] - it->get_x()) + vpMath::sqr(pts.y[iter] - it->get_y()) ;
                   double error = sqrt(d) ;
                   if(error < ransacThreshold) {
                     bool degenerate = false;
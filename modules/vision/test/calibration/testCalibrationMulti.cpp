@@ -0,0 +1,165 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Multi-image calibration with the Schur complement solver.
+ *
+ *****************************************************************************/
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpHomogeneousMatrix.h>
+#include <visp3/core/vpMeterPixelConversion.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/vision/vpCalibration.h>
+
+/*!
+  \example testCalibrationMulti.cpp
+
+  \brief Calibrate a camera from synthetic views of a planar grid with
+  vpCalibration::computeCalibrationMulti(), with and without distortion, and
+  check the estimated intrinsic parameters.
+*/
+
+namespace {
+  double uniform(vpUniRand &rng, const double a, const double b) {
+    return a + (b - a) * rng();
+  }
+
+  //! Views of a 9 by 7 grid with 3 cm squares, from random poses in front of it
+  std::vector<vpCalibration> buildViews(const vpCameraParameters &cam, const unsigned int nbViews,
+                                        const bool distortion, vpUniRand &rng) {
+    std::vector<vpCalibration> views(nbViews);
+    for (unsigned int i = 0; i < nbViews; i++) {
+      vpHomogeneousMatrix cMo(uniform(rng, -0.15, 0.05), uniform(rng, -0.12, 0.02), uniform(rng, 0.35, 0.6),
+                              vpMath::rad(uniform(rng, -25, 25)), vpMath::rad(uniform(rng, -25, 25)),
+                              vpMath::rad(uniform(rng, -30, 30)));
+      views[i].init();
+      for (unsigned int r = 0; r < 7; r++) {
+        for (unsigned int c = 0; c < 9; c++) {
+          vpColVector oP(4, 1.), cP;
+          oP[0] = 0.03 * c; oP[1] = 0.03 * r; oP[2] = 0;
+          cP = cMo * oP;
+          double u = 0, v = 0;
+          if (distortion) {
+            vpMeterPixelConversion::convertPoint(cam, cP[0] / cP[2], cP[1] / cP[2], u, v);
+          } else {
+            u = cam.get_u0() + cam.get_px() * cP[0] / cP[2];
+            v = cam.get_v0() + cam.get_py() * cP[1] / cP[2];
+          }
+          vpImagePoint ip(v, u);
+          views[i].addPoint(oP[0], oP[1], oP[2], ip);
+        }
+      }
+    }
+    return views;
+  }
+
+  bool checkParameters(const std::string &name, const vpCameraParameters &cam, const vpCameraParameters &cam_ref,
+                       const bool distortion, const double error, const double time) {
+    std::cout << name << ": px " << cam.get_px() << ", py " << cam.get_py() << ", u0 " << cam.get_u0()
+              << ", v0 " << cam.get_v0();
+    if (distortion) {
+      std::cout << ", kud " << cam.get_kud() << ", kdu " << cam.get_kdu();
+    }
+    std::cout << ", reprojection error " << error << " pixel, time " << time << " ms" << std::endl;
+
+    // With distortion, kdu only approximately inverts kud, which biases the estimation
+    const double tolerance = distortion ? 2. : 0.01;
+    bool ok = std::fabs(cam.get_px() - cam_ref.get_px()) < tolerance &&
+              std::fabs(cam.get_py() - cam_ref.get_py()) < tolerance &&
+              std::fabs(cam.get_u0() - cam_ref.get_u0()) < tolerance &&
+              std::fabs(cam.get_v0() - cam_ref.get_v0()) < tolerance;
+    if (distortion) {
+      ok = ok && std::fabs(cam.get_kud() - cam_ref.get_kud()) < 0.005 &&
+           std::fabs(cam.get_kdu() - cam_ref.get_kdu()) < 0.01 && error < 0.1;
+    }
+    return ok;
+  }
+
+  bool calibrate(const std::string &name, const vpCalibration::vpCalibrationMethodType &method,
+                 std::vector<vpCalibration> views, const vpCameraParameters &cam_ref, const unsigned int nbThreads,
+                 vpCameraParameters &cam) {
+    cam.initPersProjWithoutDistortion(cam_ref.get_px() * 1.05, cam_ref.get_py() * 0.95, 330, 250);
+    vpCalibration::setNbThreads(nbThreads);
+    double error, t = vpTime::measureTimeMs();
+    vpCalibration::computeCalibrationMulti(method, views, cam, error, false);
+    t = vpTime::measureTimeMs() - t;
+    return checkParameters(name, cam, cam_ref, method == vpCalibration::CALIB_VIRTUAL_VS_DIST, error, t);
+  }
+
+  bool sameParameters(const vpCameraParameters &cam1, const vpCameraParameters &cam2) {
+    return cam1.get_px() == cam2.get_px() && cam1.get_py() == cam2.get_py() && cam1.get_u0() == cam2.get_u0() &&
+           cam1.get_v0() == cam2.get_v0() && cam1.get_kud() == cam2.get_kud() && cam1.get_kdu() == cam2.get_kdu();
+  }
+}
+
+int main()
+{
+  try {
+    vpUniRand rng(4321);
+    vpCameraParameters cam_ref, cam_dist_ref;
+    cam_ref.initPersProjWithoutDistortion(600, 605, 320, 240);
+    cam_dist_ref.initPersProjWithDistortion(600, 605, 320, 240, -0.05, 0.05);
+
+    vpCameraParameters cam, cam_threads;
+    std::vector<vpCalibration> views = buildViews(cam_ref, 10, false, rng);
+    if (!calibrate("10 views without distortion", vpCalibration::CALIB_VIRTUAL_VS, views, cam_ref, 1, cam)) {
+      return EXIT_FAILURE;
+    }
+
+    views = buildViews(cam_dist_ref, 10, true, rng);
+    if (!calibrate("10 views with distortion", vpCalibration::CALIB_VIRTUAL_VS_DIST, views, cam_dist_ref, 1, cam) ||
+        !calibrate("10 views with distortion, 4 threads", vpCalibration::CALIB_VIRTUAL_VS_DIST, views,
+                   cam_dist_ref, 4, cam_threads)) {
+      return EXIT_FAILURE;
+    }
+    if (!sameParameters(cam, cam_threads)) {
+      std::cerr << "The calibration depends on the number of threads" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // The cost of an iteration is linear in the number of views
+    views = buildViews(cam_dist_ref, 150, true, rng);
+    if (!calibrate("150 views with distortion", vpCalibration::CALIB_VIRTUAL_VS_DIST, views, cam_dist_ref, 1, cam)) {
+      return EXIT_FAILURE;
+    }
+    vpCalibration::setNbThreads(1);
+
+    return EXIT_SUCCESS;
+  } catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,196 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test FAST-9 detection, ORB description and Hamming matching without OpenCV.
+ *
+ *****************************************************************************/
+
+#include <cmath>
+#include <iostream>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/vision/vpFastDetector.h>
+#include <visp3/vision/vpHammingMatcher.h>
+#include <visp3/vision/vpOrbExtractor.h>
+
+/*!
+  \example testFastOrbHamming.cpp
+
+  \brief Detect, describe and match keypoints between a synthetic image and a
+  translated copy, and check that the matches are consistent with the translation.
+*/
+
+namespace {
+  void drawScene(vpImage<unsigned char> &I, vpUniRand &rng)
+  {
+    for (unsigned int i = 0; i < I.getHeight(); i++) {
+      for (unsigned int j = 0; j < I.getWidth(); j++) {
+        I[i][j] = (unsigned char) (60 + (i + 2*j) % 40);
+      }
+    }
+
+    for (int n = 0; n < 150; n++) {
+      const int h = 8 + (int) (rng() * 40), w = 8 + (int) (rng() * 40);
+      const int top = (int) (rng() * (I.getHeight() - h)), left = (int) (rng() * (I.getWidth() - w));
+      const unsigned char value = (unsigned char) (rng() * 256);
+      for (int i = top; i < top + h; i++) {
+        for (int j = left; j < left + w; j++) {
+          I[(unsigned int) i][(unsigned int) j] = value;
+        }
+      }
+    }
+  }
+
+  unsigned int naiveDistance(const unsigned char *a, const unsigned char *b, const unsigned int size)
+  {
+    unsigned int dist = 0;
+    for (unsigned int i = 0; i < size; i++) {
+      for (unsigned int bit = 0; bit < 8; bit++) {
+        dist += ((a[i] ^ b[i]) >> bit) & 1;
+      }
+    }
+    return dist;
+  }
+
+  bool checkMatching(const vpImage<unsigned char> &Iref, const vpImage<unsigned char> &Icur, const int di,
+                     const int dj, const unsigned int nbLevels, const unsigned int nbThreads)
+  {
+    vpFastDetector detector(20);
+    detector.setNbLevels(nbLevels);
+    detector.setNbThreads(nbThreads);
+    detector.setMaxFeatures(1000);
+    vpOrbExtractor extractor;
+    extractor.setNbThreads(nbThreads);
+    vpHammingMatcher matcher(true);
+    matcher.setNbThreads(nbThreads);
+    matcher.setRatioTest(0.8);
+
+    std::vector<vpFastKeyPoint> kptsRef, kptsCur;
+    vpArray2D<unsigned char> descRef, descCur;
+    detector.detect(Iref, kptsRef);
+    extractor.compute(Iref, kptsRef, descRef);
+    detector.detect(Icur, kptsCur);
+    extractor.compute(Icur, kptsCur, descCur);
+
+    if (kptsRef.size() != descRef.getRows() || kptsCur.size() != descCur.getRows() ||
+        descRef.getCols() != vpOrbExtractor::descriptorSize) {
+      std::cerr << "Inconsistent number of keypoints and descriptors" << std::endl;
+      return false;
+    }
+
+    std::vector<vpHammingMatch> matches;
+    matcher.match(descCur, descRef, matches);
+
+    unsigned int nbInliers = 0;
+    for (size_t k = 0; k < matches.size(); k++) {
+      const vpFastKeyPoint &cur = kptsCur[(size_t) matches[k].queryIdx];
+      const vpFastKeyPoint &ref = kptsRef[(size_t) matches[k].trainIdx];
+      if (std::fabs(cur.v - ref.v - di) <= 2 && std::fabs(cur.u - ref.u - dj) <= 2) {
+        nbInliers++;
+      }
+      if (matches[k].distance != naiveDistance(descCur[(unsigned int) matches[k].queryIdx],
+                                               descRef[(unsigned int) matches[k].trainIdx],
+                                               vpOrbExtractor::descriptorSize)) {
+        std::cerr << "Wrong Hamming distance" << std::endl;
+        return false;
+      }
+    }
+
+    std::cout << "  " << kptsRef.size() << " / " << kptsCur.size() << " keypoints, " << matches.size()
+              << " matches, " << nbInliers << " inliers" << std::endl;
+    return matches.size() >= 50 && nbInliers >= 0.9 * matches.size();
+  }
+}
+
+int main()
+{
+  try {
+    vpUniRand rng(3);
+    vpImage<unsigned char> Iref(480, 640);
+    drawScene(Iref, rng);
+
+    const int di = 7, dj = -11;
+    vpImage<unsigned char> Icur(Iref.getHeight(), Iref.getWidth(), 0);
+    for (int i = 0; i < (int) Icur.getHeight(); i++) {
+      for (int j = 0; j < (int) Icur.getWidth(); j++) {
+        const int i0 = i - di, j0 = j - dj;
+        if (i0 >= 0 && j0 >= 0 && i0 < (int) Iref.getHeight() && j0 < (int) Iref.getWidth()) {
+          Icur[(unsigned int) i][(unsigned int) j] = Iref[(unsigned int) i0][(unsigned int) j0];
+        }
+      }
+    }
+
+    // Hamming distance on sizes that are not a multiple of the SIMD width
+    for (unsigned int size = 1; size <= 70; size++) {
+      std::vector<unsigned char> a(size), b(size);
+      for (unsigned int i = 0; i < size; i++) {
+        a[i] = (unsigned char) (rng() * 256);
+        b[i] = (unsigned char) (rng() * 256);
+      }
+      if (vpHammingMatcher::distance(&a[0], &b[0], size) != naiveDistance(&a[0], &b[0], size)) {
+        std::cerr << "Wrong Hamming distance for descriptors of " << size << " bytes" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    for (unsigned int nbLevels = 1; nbLevels <= 2; nbLevels++) {
+      for (unsigned int nbThreads = 1; nbThreads <= 2; nbThreads++) {
+        std::cout << "Check matching with " << nbLevels << " level(s) and " << nbThreads << " thread(s)" << std::endl;
+        if (!checkMatching(Iref, Icur, di, dj, nbLevels, nbThreads)) {
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    vpFastDetector detector;
+    vpOrbExtractor extractor;
+    vpHammingMatcher matcher;
+    std::vector<vpFastKeyPoint> kptsRef, kptsCur;
+    vpArray2D<unsigned char> descRef, descCur;
+    std::vector<vpHammingMatch> matches;
+    double t = vpTime::measureTimeMs();
+    detector.detect(Iref, kptsRef);
+    extractor.compute(Iref, kptsRef, descRef);
+    double t_detect = vpTime::measureTimeMs() - t;
+    detector.detect(Icur, kptsCur);
+    extractor.compute(Icur, kptsCur, descCur);
+    t = vpTime::measureTimeMs();
+    matcher.match(descCur, descRef, matches);
+    double t_match = vpTime::measureTimeMs() - t;
+    std::cout << "Detection + description: " << t_detect << " ms ; matching " << descCur.getRows() << " x "
+              << descRef.getRows() << " descriptors: " << t_match << " ms" << std::endl;
+
+    return EXIT_SUCCESS;
+  } catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,152 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test vpHammingIndex against brute force matching.
+ *
+ *****************************************************************************/
+
+#include <iostream>
+#include <sstream>
+#include <string.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/vision/vpHammingIndex.h>
+#include <visp3/vision/vpHammingMatcher.h>
+
+/*!
+  \example testHammingIndex.cpp
+
+  \brief Check that the multi-index hashing search returns the same nearest neighbours
+  as a brute force search when they are within the exact search radius, and that the
+  index can be saved and loaded.
+*/
+
+int main()
+{
+  try {
+    vpUniRand rng(11);
+    const unsigned int nbTrain = 20000, nbQuery = 500, descriptorSize = 32;
+
+    vpArray2D<unsigned char> train(nbTrain, descriptorSize), query(nbQuery, descriptorSize);
+    for (unsigned int i = 0; i < train.size(); i++) {
+      train.data[i] = (unsigned char) (rng() * 256);
+    }
+
+    // Queries are noisy copies of train descriptors, with up to 40 flipped bits
+    for (unsigned int i = 0; i < nbQuery; i++) {
+      const unsigned int id = (unsigned int) (rng() * nbTrain);
+      memcpy(query[i], train[id], descriptorSize);
+      const unsigned int nbFlips = (unsigned int) (rng() * 41);
+      for (unsigned int f = 0; f < nbFlips; f++) {
+        const unsigned int bit = (unsigned int) (rng() * 8 * descriptorSize);
+        query[i][bit / 8] ^= (unsigned char) (1 << (bit % 8));
+      }
+    }
+
+    vpHammingMatcher matcher;
+    std::vector<std::vector<vpHammingMatch> > bruteForce, indexed, loaded;
+    double t = vpTime::measureTimeMs();
+    matcher.knnMatch(query, train, 2, bruteForce);
+    const double t_bf = vpTime::measureTimeMs() - t;
+
+    vpHammingIndex index;
+    t = vpTime::measureTimeMs();
+    index.build(train);
+    const double t_build = vpTime::measureTimeMs() - t;
+
+    for (unsigned int maxRadius = 0; maxRadius <= 2; maxRadius++) {
+      index.setMaxRadius(maxRadius);
+      index.setNbThreads(maxRadius + 1);
+      t = vpTime::measureTimeMs();
+      index.knnSearch(query, 2, indexed);
+      const double t_index = vpTime::measureTimeMs() - t;
+
+      const unsigned int exactRadius = index.getNbTables() * (index.getMaxRadius() + 1);
+      unsigned int nbFound = 0;
+      for (unsigned int i = 0; i < nbQuery; i++) {
+        if (indexed[i].empty() || indexed[i][0].queryIdx != (int) i) {
+          std::cerr << "Missing match for query " << i << std::endl;
+          return EXIT_FAILURE;
+        }
+        if (indexed[i][0].distance == bruteForce[i][0].distance) {
+          nbFound++;
+        } else if (bruteForce[i][0].distance < exactRadius) {
+          std::cerr << "Query " << i << ": distance " << indexed[i][0].distance << " instead of "
+                    << bruteForce[i][0].distance << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+
+      std::cout << "Radius " << maxRadius << " with " << index.getNbThreads() << " thread(s): recall " << nbFound
+                << " / " << nbQuery << " ; brute force: " << t_bf << " ms ; index build: " << t_build
+                << " ms ; index search: " << t_index << " ms" << std::endl;
+    }
+
+    std::stringstream ss;
+    index.save(ss);
+    vpHammingIndex index2;
+    index2.load(ss, train.data, nbTrain, descriptorSize);
+    index2.knnSearch(query, 2, loaded);
+    for (unsigned int i = 0; i < nbQuery; i++) {
+      if (loaded[i].size() != indexed[i].size() || loaded[i][0].trainIdx != indexed[i][0].trainIdx ||
+          loaded[i][0].distance != indexed[i][0].distance) {
+        std::cerr << "The loaded index gives a different result for query " << i << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Bucket offsets that do not start at 0 or are not sorted are rejected
+    const std::string data = ss.str();
+    const size_t offsetsPos = 20; // After the magic, the version and the sizes
+    for (unsigned int c = 0; c < 2; c++) {
+      std::string corrupted = data;
+      corrupted[offsetsPos + 4 * c] = (char) 0xff;
+      corrupted[offsetsPos + 4 * c + 3] = (char) 0x7f;
+      std::stringstream ss_corrupted(corrupted);
+      vpHammingIndex index3;
+      bool exceptionThrown = false;
+      try {
+        index3.load(ss_corrupted, train.data, nbTrain, descriptorSize);
+      } catch (const vpException &) {
+        exceptionThrown = true;
+      }
+      if (!exceptionThrown) {
+        std::cerr << "A corrupted index is loaded" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    return EXIT_SUCCESS;
+  } catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
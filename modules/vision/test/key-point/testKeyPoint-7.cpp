@@ -368,6 +368,17 @@ int main(int argc, const char ** argv) {
             "binary with train images saved !");
       }
 
+      //Save the loaded learning data over the file they are memory-mapped from
+      read_keypoint1.saveLearningData(filename, true, true);
+      vpKeyPoint read_keypoint1_bis;
+      read_keypoint1_bis.loadLearningData(filename, true);
+      read_keypoint1_bis.getTrainKeyPoints(trainKeyPoints_read);
+      if(!compareKeyPoints(trainKeyPoints, trainKeyPoints_read) ||
+         !compareDescriptors(trainDescriptors, read_keypoint1_bis.getTrainDescriptors())) {
+        throw vpException(vpException::fatalError, "Problem when overwriting the learning file the data were "
+            "loaded from !");
+      }
+
 
       //Save in binary with no training images
       filename = vpIoTools::createFilePath(opath, "bin_without_img");
@@ -0,0 +1,188 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Compare the PROSAC and the uniform sampling RANSAC engines of vpPose.
+ *
+ *****************************************************************************/
+
+#include <iostream>
+#include <visp3/core/vpHomogeneousMatrix.h>
+#include <visp3/core/vpPoint.h>
+#include <visp3/core/vpThetaUVector.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/vision/vpPose.h>
+
+/*!
+  \example testPoseRansacProsac.cpp
+
+  \brief Compare vpPose::RANSAC_PROSAC with vpPose::RANSAC_UNIFORM_SAMPLING on a synthetic
+  scene with 50% of outliers.
+*/
+
+namespace {
+  double uniform(vpUniRand &rng, const double a, const double b) {
+    return a + (b - a) * rng();
+  }
+
+  struct vpRansacResult {
+    vpHomogeneousMatrix cMo;
+    std::vector<unsigned int> inlierIndex;
+    double time;
+  };
+
+  bool runRansac(const std::vector<vpPoint> &points, const std::vector<double> &qualities,
+                 const vpPose::vpRansacMethodType &method, const int nbThreads, vpRansacResult &result) {
+    vpPose pose;
+    for (size_t i = 0; i < points.size(); i++) {
+      pose.addPoint(points[i]);
+    }
+    pose.setRansacMethod(method);
+    pose.setRansacQualities(qualities);
+    pose.setRansacThreshold(0.001);
+    pose.setRansacMaxTrials(2000);
+    pose.setRansacNbInliersToReachConsensus((unsigned int) (0.45 * points.size()));
+    pose.setUseParallelRansac(nbThreads > 1);
+    pose.setNbParallelRansacThreads(nbThreads);
+
+    double t = vpTime::measureTimeMs();
+    bool found = pose.computePose(vpPose::RANSAC, result.cMo);
+    result.time = vpTime::measureTimeMs() - t;
+    result.inlierIndex = pose.getRansacInlierIndex();
+
+    return found;
+  }
+
+  bool checkResult(const std::string &name, const vpRansacResult &result, const vpHomogeneousMatrix &cMo_ref,
+                   const std::vector<bool> &isInlier, const unsigned int nbTrueInliers) {
+    unsigned int nbFound = 0, nbWrong = 0;
+    for (size_t i = 0; i < result.inlierIndex.size(); i++) {
+      if (isInlier[result.inlierIndex[i]]) {
+        nbFound++;
+      } else {
+        nbWrong++;
+      }
+    }
+
+    vpHomogeneousMatrix cdMc = cMo_ref * result.cMo.inverse();
+    double errorT = cdMc.getTranslationVector().euclideanNorm();
+    double errorR = vpMath::deg(vpThetaUVector(cdMc.getRotationMatrix()).getTheta());
+    std::cout << name << ": " << nbFound << "/" << nbTrueInliers << " inliers found, " << nbWrong
+              << " outliers accepted, translation error: " << errorT << " m, rotation error: " << errorR
+              << " deg, time: " << result.time << " ms" << std::endl;
+
+    return nbFound >= 0.95 * nbTrueInliers && nbWrong < 0.01 * nbTrueInliers && errorT < 1e-3 && errorR < 0.1;
+  }
+}
+
+int main()
+{
+  try {
+    vpHomogeneousMatrix cMo_ref(0.1, -0.05, 1.2, vpMath::rad(10), vpMath::rad(-20), vpMath::rad(30));
+    vpUniRand rng(1234);
+
+    const unsigned int nbPoints = 2000;
+    std::vector<vpPoint> points;
+    std::vector<double> qualities;
+    std::vector<bool> isInlier;
+    unsigned int nbTrueInliers = 0;
+    for (unsigned int i = 0; i < nbPoints; i++) {
+      vpPoint pt(uniform(rng, -0.3, 0.3), uniform(rng, -0.3, 0.3), uniform(rng, -0.1, 0.1));
+      pt.project(cMo_ref);
+
+      // Half of the matches are outliers, with a lower but overlapping quality
+      bool inlier = rng() < 0.5;
+      if (inlier) {
+        pt.set_x(pt.get_x() + uniform(rng, -1e-4, 1e-4));
+        pt.set_y(pt.get_y() + uniform(rng, -1e-4, 1e-4));
+        qualities.push_back(uniform(rng, 0.5, 1.5));
+        nbTrueInliers++;
+      } else {
+        pt.set_x(uniform(rng, -0.5, 0.5));
+        pt.set_y(uniform(rng, -0.5, 0.5));
+        qualities.push_back(uniform(rng, 0.0, 1.0));
+      }
+      points.push_back(pt);
+      isInlier.push_back(inlier);
+    }
+
+    vpRansacResult uniformSampling, prosac, prosacParallel, prosacNoQuality;
+    if (!runRansac(points, std::vector<double>(), vpPose::RANSAC_UNIFORM_SAMPLING, 1, uniformSampling) ||
+        !checkResult("Uniform sampling", uniformSampling, cMo_ref, isInlier, nbTrueInliers)) {
+      std::cerr << "The uniform sampling engine failed" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    if (!runRansac(points, qualities, vpPose::RANSAC_PROSAC, 1, prosac) ||
+        !checkResult("PROSAC", prosac, cMo_ref, isInlier, nbTrueInliers)) {
+      std::cerr << "The PROSAC engine failed" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    if (!runRansac(points, qualities, vpPose::RANSAC_PROSAC, 4, prosacParallel) ||
+        !checkResult("PROSAC with 4 threads", prosacParallel, cMo_ref, isInlier, nbTrueInliers)) {
+      std::cerr << "The parallel PROSAC engine failed" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    if (prosacParallel.inlierIndex != prosac.inlierIndex) {
+      std::cerr << "The PROSAC result depends on the number of threads" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    if (!runRansac(points, std::vector<double>(), vpPose::RANSAC_PROSAC, 1, prosacNoQuality) ||
+        !checkResult("PROSAC without quality", prosacNoQuality, cMo_ref, isInlier, nbTrueInliers)) {
+      std::cerr << "The PROSAC engine without quality failed" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // The qualities must match the number of points
+    vpPose pose;
+    for (size_t i = 0; i < 10; i++) {
+      pose.addPoint(points[i]);
+    }
+    pose.setRansacMethod(vpPose::RANSAC_PROSAC);
+    pose.setRansacQualities(qualities);
+    try {
+      vpHomogeneousMatrix cMo;
+      pose.computePose(vpPose::RANSAC, cMo);
+      std::cerr << "A wrong number of qualities should throw an exception" << std::endl;
+      return EXIT_FAILURE;
+    } catch(const vpException &e) {
+      std::cout << "Expected exception: " << e.getStringMessage() << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+  } catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -131,6 +131,11 @@ public:
   virtual vpColVector error(const vpBasicFeature &s_star,
                             const unsigned int select= FEATURE_ALL);
 
+  virtual unsigned int fillError(const vpBasicFeature &s_star, const unsigned int select,
+                                 vpColVector &e, const unsigned int row);
+  virtual unsigned int fillInteraction(const unsigned int select, vpMatrix &L, const unsigned int row);
+  unsigned int fillState(const unsigned int select, vpColVector &state, const unsigned int row) const;
+
   // Get the feature vector.
   vpColVector get_s(unsigned int select=FEATURE_ALL) const;
   vpBasicFeatureDeallocatorType getDeallocate() { return deallocate ; }
@@ -76,10 +76,25 @@ class VISP_EXPORT vpLuminance
   \brief Class that defines the image luminance visual feature
 
   For more details see \cite Collewet08c.
+
+  Since the feature has one component per pixel, the interaction matrix returned by
+  interaction() has hundreds of thousands of rows for a VGA image. The control laws
+  used for photometric visual servoing only need the \f$ 6 \times 6 \f$ matrix
+  \f$ {\bf L}^\top {\bf L} \f$ and the vector \f$ {\bf L}^\top {\bf e} \f$, which are
+  directly accumulated by computeNormalEquations() without building \f$ {\bf L} \f$.
+  This is what vpServoPhotometric uses.
 */
 
 class VISP_EXPORT vpFeatureLuminance : public vpBasicFeature
 {
+ public:
+  //! Image gradient used to compute the interaction matrix in computeNormalEquations().
+  typedef enum {
+    CURRENT, /*!< Gradient of the current image. */
+    DESIRED, /*!< Gradient of the desired image. */
+    MEAN     /*!< Mean of the current and desired image gradients. */
+  } vpLuminanceInteractionType;
+
  protected:
   //! FeaturePoint depth (required to compute the interaction matrix)
   //! default Z = 1m
@@ -95,6 +110,8 @@ class VISP_EXPORT vpFeatureLuminance : public vpBasicFeature
   //! Store the image (as a vector with intensity and gradient I, Ix, Iy) 
   vpLuminance *pixInfo ;
   int  firstTimeIn  ;
+  //! Number of threads used by buildFrom() and computeNormalEquations().
+  unsigned int nbThreads ;
 
  public:
   vpFeatureLuminance() ;
@@ -104,6 +121,9 @@ class VISP_EXPORT vpFeatureLuminance : public vpBasicFeature
 
   void buildFrom(vpImage<unsigned char> &I) ;
 
+  double computeNormalEquations(const vpFeatureLuminance &s_star, vpMatrix &LTL, vpColVector &LTe,
+                                const vpLuminanceInteractionType &type=CURRENT) const ;
+
   void display(const vpCameraParameters &cam,
                const vpImage<unsigned char> &I,
                const vpColor &color=vpColor::green, unsigned int thickness=1) const ;
@@ -122,6 +142,8 @@ class VISP_EXPORT vpFeatureLuminance : public vpBasicFeature
 
 
   double get_Z() const  ;
+  /*! Return the number of threads used by buildFrom() and computeNormalEquations(). */
+  inline unsigned int getNbThreads() const { return nbThreads; }
 
   void init() ;
   void init(unsigned int _nbr, unsigned int _nbc, double _Z) ;
@@ -133,6 +155,11 @@ class VISP_EXPORT vpFeatureLuminance : public vpBasicFeature
   void print(const unsigned int select = FEATURE_ALL ) const ;
 
   void setCameraParameters(vpCameraParameters &_cam)  ;
+  /*!
+    Set the number of threads used by buildFrom() and computeNormalEquations().
+    It is only taken into account when ViSP is built with OpenMP.
+  */
+  inline void setNbThreads(const unsigned int nb) { nbThreads = nb > 0 ? nb : 1; }
   void set_Z(const double Z) ;
 
 
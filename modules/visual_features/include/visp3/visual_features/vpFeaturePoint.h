@@ -211,6 +211,10 @@ public:
   //! Compute the error between a visual features and zero
   vpColVector error(const unsigned int select = FEATURE_ALL)  ;
 
+  unsigned int fillError(const vpBasicFeature &s_star, const unsigned int select,
+                         vpColVector &e, const unsigned int row);
+  unsigned int fillInteraction(const unsigned int select, vpMatrix &L, const unsigned int row);
+
   double get_x()  const ;
 
   double get_y()   const ;
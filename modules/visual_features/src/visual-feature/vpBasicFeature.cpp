@@ -40,6 +40,7 @@
 
 
 #include <visp3/visual_features/vpBasicFeature.h>
+#include <visp3/visual_features/vpFeatureException.h>
 
 const unsigned int vpBasicFeature::FEATURE_LINE [32] =
     {
@@ -191,6 +192,106 @@ vpColVector vpBasicFeature::error(const vpBasicFeature &s_star,
    return e ;
 }
 
+/*!
+  Write the feature vector \f$\bf s\f$ restricted to the selected features in \e state,
+  starting at row \e row. This is the allocation free counterpart of get_s() used
+  by vpServo to stack the task.
+
+  \param select : Subset of the features.
+  \param state : Vector that receives the features. It is not resized.
+  \param row : Index of the first element to write.
+
+  \return The number of elements written.
+
+  \exception vpFeatureException::sizeMismatchError : If \e state is too small.
+*/
+unsigned int vpBasicFeature::fillState(const unsigned int select, vpColVector &state, const unsigned int row) const
+{
+  if (dim_s > 31) {
+    if (row + dim_s > state.getRows()) {
+      throw vpFeatureException(vpFeatureException::sizeMismatchError,
+                               "Cannot write %d features at row %d of a %d size vector", dim_s, row, state.getRows());
+    }
+    for (unsigned int i = 0; i < dim_s; i++) {
+      state[row + i] = s[i];
+    }
+    return dim_s;
+  }
+
+  unsigned int n = 0;
+  for (unsigned int i = 0; i < dim_s; i++) {
+    if (FEATURE_LINE[i] & select) {
+      if (row + n >= state.getRows()) {
+        throw vpFeatureException(vpFeatureException::sizeMismatchError,
+                                 "Cannot write feature %d at row %d of a %d size vector", i, row + n, state.getRows());
+      }
+      state[row + n] = s[i];
+      n++;
+    }
+  }
+  return n;
+}
+
+/*!
+  Write the error between two visual features, restricted to the selected features,
+  in \e e starting at row \e row. The default implementation calls error() and copies
+  its result; features used in high rate control loops override it to avoid any
+  allocation.
+
+  \param s_star : Desired visual feature.
+  \param select : Subset of the features.
+  \param e : Vector that receives the error. It is not resized.
+  \param row : Index of the first element to write.
+
+  \return The number of elements written, which is the size of error(s_star, select).
+
+  \exception vpFeatureException::sizeMismatchError : If \e e is too small.
+*/
+unsigned int vpBasicFeature::fillError(const vpBasicFeature &s_star, const unsigned int select,
+                                       vpColVector &e, const unsigned int row)
+{
+  vpColVector eTmp = error(s_star, select);
+  if (row + eTmp.getRows() > e.getRows()) {
+    throw vpFeatureException(vpFeatureException::sizeMismatchError,
+                             "Cannot write a %d size error at row %d of a %d size vector",
+                             eTmp.getRows(), row, e.getRows());
+  }
+  for (unsigned int i = 0; i < eTmp.getRows(); i++) {
+    e[row + i] = eTmp[i];
+  }
+  return eTmp.getRows();
+}
+
+/*!
+  Write the interaction matrix of the selected features in \e L, starting at row \e row.
+  The default implementation calls interaction() and copies its result; features used
+  in high rate control loops override it to avoid any allocation.
+
+  \param select : Subset of the features.
+  \param L : Matrix that receives the interaction matrix. It is not resized.
+  \param row : Index of the first row to write.
+
+  \return The number of rows written, which is the number of rows of interaction(select).
+
+  \exception vpFeatureException::sizeMismatchError : If \e L is too small or if its number
+  of columns differs from the one of the interaction matrix.
+*/
+unsigned int vpBasicFeature::fillInteraction(const unsigned int select, vpMatrix &L, const unsigned int row)
+{
+  vpMatrix Ltmp = interaction(select);
+  if (row + Ltmp.getRows() > L.getRows() || Ltmp.getCols() != L.getCols()) {
+    throw vpFeatureException(vpFeatureException::sizeMismatchError,
+                             "Cannot write a %dx%d interaction matrix at row %d of a %dx%d matrix",
+                             Ltmp.getRows(), Ltmp.getCols(), row, L.getRows(), L.getCols());
+  }
+  for (unsigned int i = 0; i < Ltmp.getRows(); i++) {
+    for (unsigned int j = 0; j < Ltmp.getCols(); j++) {
+      L[row + i][j] = Ltmp[i][j];
+    }
+  }
+  return Ltmp.getRows();
+}
+
 /*
  * Local variables:
  * c-basic-offset: 4
@@ -37,6 +37,9 @@
  *****************************************************************************/
 
 
+#include <algorithm>
+#include <vector>
+
 #include <visp3/core/vpMatrix.h>
 #include <visp3/core/vpHomogeneousMatrix.h>
 #include <visp3/core/vpDisplay.h>
@@ -47,6 +50,10 @@
 
 #include <visp3/visual_features/vpFeatureLuminance.h>
 
+namespace {
+  //! Number of pixels accumulated by a task of computeNormalEquations()
+  const unsigned int normalEquationsBlockSize = 4096;
+}
 
 /*!
   \file vpFeatureLuminance.cpp
@@ -105,7 +112,7 @@ vpFeatureLuminance::init(unsigned int _nbr, unsigned int _nbc, double _Z)
   Default constructor that build a visual feature.
 */
 vpFeatureLuminance::vpFeatureLuminance()
-  : Z(1), nbr(0), nbc(0), bord(10), pixInfo(NULL), firstTimeIn(0), cam()
+  : Z(1), nbr(0), nbc(0), bord(10), pixInfo(NULL), firstTimeIn(0), nbThreads(1), cam()
 {
     nbParameters = 1;
     dim_s = 0 ;
@@ -118,7 +125,7 @@ vpFeatureLuminance::vpFeatureLuminance()
  Copy constructor.
  */
 vpFeatureLuminance::vpFeatureLuminance(const vpFeatureLuminance& f)
-  : vpBasicFeature(f), Z(1), nbr(0), nbc(0), bord(10), pixInfo(NULL), firstTimeIn(0), cam()
+  : vpBasicFeature(f), Z(1), nbr(0), nbc(0), bord(10), pixInfo(NULL), firstTimeIn(0), nbThreads(1), cam()
 {
   *this = f;
 }
@@ -133,6 +140,7 @@ vpFeatureLuminance &vpFeatureLuminance::operator=(const vpFeatureLuminance& f)
   nbc = f.nbc;
   bord = f.bord;
   firstTimeIn = f.firstTimeIn;
+  nbThreads = f.nbThreads;
   cam = f.cam;
   if (pixInfo)
     delete [] pixInfo;
@@ -191,7 +199,6 @@ void
 vpFeatureLuminance::buildFrom(vpImage<unsigned char> &I)
 {
   unsigned int l = 0;
-  double Ix,Iy ;
 
   double px = cam.get_px() ;
   double py = cam.get_py() ;
@@ -220,27 +227,149 @@ vpFeatureLuminance::buildFrom(vpImage<unsigned char> &I)
 	}
     }
 
-  l= 0 ;
-  for (unsigned int i=bord; i < nbr-bord ; i++)
+  // Same filter as vpImageFilter::derivativeFilterX() / derivativeFilterY(), applied
+  // on whole rows so that the inner loop can be vectorized
+  const int width = (int) (nbc - 2*bord);
+  const int nbRows = (int) (nbr - 2*bord);
+  const unsigned int nbThreads_ = nbThreads;
+  (void) nbThreads_;
+#ifdef VISP_HAVE_OPENMP
+  #pragma omp parallel for num_threads(nbThreads_) if(nbThreads_ > 1)
+#endif
+  for (int k = 0; k < nbRows; k++)
+  {
+    const unsigned int i = bord + (unsigned int) k;
+    const unsigned char *row = I[i] + bord;
+    const unsigned char *up1 = I[i-1] + bord, *up2 = I[i-2] + bord, *up3 = I[i-3] + bord;
+    const unsigned char *down1 = I[i+1] + bord, *down2 = I[i+2] + bord, *down3 = I[i+3] + bord;
+    vpLuminance *pix = pixInfo + (size_t) k * width;
+    double *intensity = s.data + (size_t) k * width;
+
+    for (int j = 0; j < width; j++)
     {
-      //   cout << i << endl ;
-      for (unsigned int j = bord ; j < nbc-bord; j++)
-	{
-	  // cout << dim_s <<" " <<l <<"  " <<i << "  " << j <<endl ;
-          Ix =  px * vpImageFilter::derivativeFilterX(I,i,j) ;
-	  Iy =  py * vpImageFilter::derivativeFilterY(I,i,j) ;
-	  
-	  // Calcul de Z
-	  
-	  pixInfo[l].I  =  I[i][j] ;
-	  s[l]  =  I[i][j] ;
-	  pixInfo[l].Ix  = Ix;
-	  pixInfo[l].Iy  = Iy;
-	  
-	  l++;
-	}
+      double Ix = (2047.0 *(row[j+1] - row[j-1])
+                   +913.0 *(row[j+2] - row[j-2])
+                   +112.0 *(row[j+3] - row[j-3]))/8418.0;
+      double Iy = (2047.0 *(down1[j] - up1[j])
+                   +913.0 *(down2[j] - up2[j])
+                   +112.0 *(down3[j] - up3[j]))/8418.0;
+
+      pix[j].I = row[j];
+      intensity[j] = row[j];
+      pix[j].Ix = px * Ix;
+      pix[j].Iy = py * Iy;
+    }
+  }
+}
+
+/*!
+  Accumulate the normal equations of the photometric visual servoing problem, that is
+  \f$ {\bf L}^\top {\bf L} \f$ and \f$ {\bf L}^\top {\bf e} \f$ with
+  \f$ {\bf e} = {\bf I} - {\bf I}^* \f$, without building the
+  \f$ dim\_s \times 6 \f$ interaction matrix. The pixels are processed by blocks
+  in parallel and the partial sums are added in a fixed order, so that the result
+  does not depend on the number of threads.
+
+  \param s_star : Desired visual feature, built with the same size and camera parameters.
+  \param LTL : \f$ 6 \times 6 \f$ matrix \f$ {\bf L}^\top {\bf L} \f$.
+  \param LTe : 6-dimension vector \f$ {\bf L}^\top {\bf e} \f$.
+  \param type : Image gradient used to compute \f$ {\bf L} \f$.
+  \return The squared norm of the error \f$ {\bf e}^\top {\bf e} \f$.
+*/
+double
+vpFeatureLuminance::computeNormalEquations(const vpFeatureLuminance &s_star, vpMatrix &LTL, vpColVector &LTe,
+                                           const vpLuminanceInteractionType &type) const
+{
+  if (s_star.dim_s != dim_s) {
+    throw vpException(vpException::dimensionError, "The current feature has %d pixels and the desired one %d",
+                      (int) dim_s, (int) s_star.dim_s);
+  }
+
+  double wCur = 1.0, wDes = 0.0;
+  if (type == DESIRED) {
+    wCur = 0.0;
+    wDes = 1.0;
+  } else if (type == MEAN) {
+    wCur = wDes = 0.5;
+  }
+
+  // 21 coefficients of the lower triangle of L^T L, 6 of L^T e and e^T e
+  const unsigned int nbSums = 28;
+  const int nbBlocks = (int) ((dim_s + normalEquationsBlockSize - 1) / normalEquationsBlockSize);
+  std::vector<double> sums((size_t) nbBlocks * nbSums);
+
+  const unsigned int nbThreads_ = nbThreads;
+  (void) nbThreads_;
+#ifdef VISP_HAVE_OPENMP
+  #pragma omp parallel for num_threads(nbThreads_) if(nbThreads_ > 1)
+#endif
+  for (int b = 0; b < nbBlocks; b++)
+  {
+    double acc[nbSums];
+    for (unsigned int k = 0; k < nbSums; k++) {
+      acc[k] = 0.0;
+    }
+
+    const unsigned int begin = (unsigned int) b * normalEquationsBlockSize;
+    const unsigned int end = (std::min)(begin + normalEquationsBlockSize, dim_s);
+    for (unsigned int m = begin; m < end; m++)
+    {
+      double Ix = wCur * pixInfo[m].Ix + wDes * s_star.pixInfo[m].Ix;
+      double Iy = wCur * pixInfo[m].Iy + wDes * s_star.pixInfo[m].Iy;
+
+      double x = pixInfo[m].x ;
+      double y = pixInfo[m].y ;
+      double Zinv =  1 / pixInfo[m].Z;
+
+      double Lm[6];
+      Lm[0] = Ix * Zinv;
+      Lm[1] = Iy * Zinv;
+      Lm[2] = -(x*Ix+y*Iy)*Zinv;
+      Lm[3] = -Ix*x*y-(1+y*y)*Iy;
+      Lm[4] = (1+x*x)*Ix + Iy*x*y;
+      Lm[5]  = Iy*x-Ix*y;
+      double e = s.data[m] - s_star.s.data[m];
+
+      unsigned int k = 0;
+      for (unsigned int r = 0; r < 6; r++) {
+        for (unsigned int c = 0; c <= r; c++) {
+          acc[k++] += Lm[r] * Lm[c];
+        }
+      }
+      for (unsigned int r = 0; r < 6; r++) {
+        acc[k++] += Lm[r] * e;
+      }
+      acc[k] += e * e;
+    }
+
+    for (unsigned int k = 0; k < nbSums; k++) {
+      sums[(size_t) b * nbSums + k] = acc[k];
+    }
+  }
+
+  double total[nbSums];
+  for (unsigned int k = 0; k < nbSums; k++) {
+    total[k] = 0.0;
+  }
+  for (int b = 0; b < nbBlocks; b++) {
+    for (unsigned int k = 0; k < nbSums; k++) {
+      total[k] += sums[(size_t) b * nbSums + k];
+    }
+  }
+
+  LTL.resize(6, 6, false);
+  LTe.resize(6, false);
+  unsigned int k = 0;
+  for (unsigned int r = 0; r < 6; r++) {
+    for (unsigned int c = 0; c <= r; c++, k++) {
+      LTL[r][c] = LTL[c][r] = total[k];
     }
+  }
+  for (unsigned int r = 0; r < 6; r++, k++) {
+    LTe[r] = total[k];
+  }
 
+  return total[k];
 }
 
 
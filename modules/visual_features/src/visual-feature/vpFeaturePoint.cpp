@@ -242,10 +242,31 @@ vpFeaturePoint::set_xyZ(const double x_,
 vpMatrix
 vpFeaturePoint::interaction(const unsigned int select)
 {
-  vpMatrix L ;
+  unsigned int nbRows = 0;
+  if (vpFeaturePoint::selectX() & select)
+    nbRows++;
+  if (vpFeaturePoint::selectY() & select)
+    nbRows++;
+
+  vpMatrix L(nbRows, 6);
+  fillInteraction(select, L, 0);
+  return L ;
+}
+
+/*!
+  Write the interaction matrix of the selected point features in \e L starting
+  at row \e row, without any allocation. The rows are the ones returned by
+  interaction().
 
-  L.resize(0,6) ;
+  \param select : Selection of a subset of the possible point features.
+  \param L : Matrix with 6 columns that receives the interaction matrix.
+  \param row : Index of the first row to write.
 
+  \return The number of rows written.
+*/
+unsigned int
+vpFeaturePoint::fillInteraction(const unsigned int select, vpMatrix &L, const unsigned int row)
+{
   if (deallocate == vpBasicFeature::user)
   {
     for (unsigned int i = 0; i < nbParameters; i++)
@@ -292,34 +313,40 @@ vpFeaturePoint::interaction(const unsigned int select)
 			     "Point Z coordinates is null")) ;
   }
 
+  unsigned int nbRows = 0;
+  if (vpFeaturePoint::selectX() & select)
+    nbRows++;
+  if (vpFeaturePoint::selectY() & select)
+    nbRows++;
+  if (row + nbRows > L.getRows() || L.getCols() != 6) {
+    throw(vpFeatureException(vpFeatureException::sizeMismatchError,
+                             "Cannot write %d point feature rows at row %d of a %dx%d matrix",
+                             nbRows, row, L.getRows(), L.getCols())) ;
+  }
+
+  unsigned int i = row;
   if (vpFeaturePoint::selectX() & select )
   {
-    vpMatrix Lx(1,6) ; Lx = 0;
-
-    Lx[0][0] = -1/Z_  ;
-    Lx[0][1] = 0 ;
-    Lx[0][2] = x_/Z_ ;
-    Lx[0][3] = x_*y_ ;
-    Lx[0][4] = -(1+x_*x_) ;
-    Lx[0][5] = y_ ;
-
-    L = vpMatrix::stack(L,Lx) ;
+    double *Lx = L[i++];
+    Lx[0] = -1/Z_  ;
+    Lx[1] = 0 ;
+    Lx[2] = x_/Z_ ;
+    Lx[3] = x_*y_ ;
+    Lx[4] = -(1+x_*x_) ;
+    Lx[5] = y_ ;
   }
 
   if (vpFeaturePoint::selectY() & select )
   {
-    vpMatrix Ly(1,6) ; Ly = 0;
-
-    Ly[0][0] = 0 ;
-    Ly[0][1]  = -1/Z_ ;
-    Ly[0][2] = y_/Z_ ;
-    Ly[0][3] = 1+y_*y_ ;
-    Ly[0][4] = -x_*y_ ;
-    Ly[0][5] = -x_ ;
-
-    L = vpMatrix::stack(L,Ly) ;
+    double *Ly = L[i++];
+    Ly[0] = 0 ;
+    Ly[1] = -1/Z_ ;
+    Ly[2] = y_/Z_ ;
+    Ly[3] = 1+y_*y_ ;
+    Ly[4] = -x_*y_ ;
+    Ly[5] = -x_ ;
   }
-  return L ;
+  return nbRows ;
 }
 
 
@@ -384,6 +411,41 @@ vpFeaturePoint::error(const vpBasicFeature &s_star,
 
 }
 
+/*!
+  Write the error \f$ (s-s^*)\f$ of the selected point features in \e e starting
+  at row \e row, without any allocation.
+
+  \param s_star : Desired visual feature.
+  \param select : Selection of a subset of the possible point features.
+  \param e : Vector that receives the error.
+  \param row : Index of the first element to write.
+
+  \return The number of elements written.
+*/
+unsigned int
+vpFeaturePoint::fillError(const vpBasicFeature &s_star, const unsigned int select,
+                          vpColVector &e, const unsigned int row)
+{
+  unsigned int i = row;
+  if (vpFeaturePoint::selectX() & select)
+  {
+    if (i >= e.getRows()) {
+      throw(vpFeatureException(vpFeatureException::sizeMismatchError, "Cannot write the x error at row %d", i)) ;
+    }
+    e[i++] = s[0] - s_star[0] ;
+  }
+
+  if (vpFeaturePoint::selectY() & select)
+  {
+    if (i >= e.getRows()) {
+      throw(vpFeatureException(vpFeatureException::sizeMismatchError, "Cannot write the y error at row %d", i)) ;
+    }
+    e[i++] = s[1] - s_star[1] ;
+  }
+
+  return i - row ;
+}
+
 
 /*!
   Print to stdout the values of the current visual feature \f$ s \f$.
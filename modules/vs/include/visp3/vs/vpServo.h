@@ -484,6 +484,10 @@ public:
    */
   void computeProjectionOperators();
 
+  void stackInteractionMatrix(const std::list<vpBasicFeature *> &list, vpMatrix &Ls);
+  void updateError();
+  void updateInteractionMatrix();
+
   public:
   //! Interaction matrix
   vpMatrix L ;
@@ -614,6 +618,21 @@ public:
 
   //! A diag matrix used to determine which are the degrees of freedom that are controlled in the camera frame
   vpMatrix cJc;
+
+  /*
+    Work space reused from one iteration to the other
+  */
+
+  //! Interaction matrix computed from the desired features when the interaction matrix type is MEAN.
+  vpMatrix Lstar;
+  //! Twist transformation matrix \f${^c}V_a\f$ used to build the task Jacobian.
+  vpMatrix cVa;
+  //! Intermediate products \f$L\;{^c}J_c\f$ and \f$L\;{^c}J_c\;{^c}V_a\f$ of the task Jacobian.
+  vpMatrix LcJc, LcVa;
+  //! Images of the task Jacobian and of its transpose.
+  vpMatrix imJ1, imJ1t;
+  //! \f${J_1}^\top e\f$, used to build the large projection operator.
+  vpColVector J1te;
 } ;
 
 #endif
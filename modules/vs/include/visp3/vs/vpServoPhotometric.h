@@ -0,0 +1,168 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Photometric visual servoing control law.
+ *
+ *****************************************************************************/
+
+#ifndef vpServoPhotometric_H
+#define vpServoPhotometric_H
+
+/*!
+  \file vpServoPhotometric.h
+  \brief Photometric visual servoing control law computed from the normal equations.
+*/
+
+#include <visp3/core/vpColVector.h>
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpMatrix.h>
+#include <visp3/visual_features/vpFeatureLuminance.h>
+
+/*!
+  \class vpServoPhotometric
+  \ingroup group_task
+
+  \brief Control law for photometric visual servoing \cite Collewet08c.
+
+  The camera velocity is computed as
+  \f[
+  {\bf v} = -\lambda \left( {\bf H} + \mu\, {\bf D} \right)^{-1} {\bf L}^\top {\bf e}
+  \f]
+  where \f$ {\bf e} = {\bf I} - {\bf I}^* \f$, \f$ {\bf H} = {\bf L}^\top {\bf L} \f$ and
+  \f$ {\bf D} \f$ is either null (Gauss-Newton), the identity (Levenberg) or the diagonal of
+  \f$ {\bf H} \f$ (Levenberg-Marquardt). \f$ {\bf L}^\top {\bf L} \f$ and \f$ {\bf L}^\top {\bf e} \f$
+  are accumulated by vpFeatureLuminance::computeNormalEquations(), so that neither the
+  \f$ dim\_s \times 6 \f$ interaction matrix nor its pseudo-inverse are computed as with
+  vpServo.
+
+  The damping factor \f$ \mu \f$ can be updated at each iteration: it is multiplied by a
+  factor lower than 1 when the error decreased and by a factor greater than 1 otherwise,
+  see setMuUpdate().
+
+  \code
+#include <visp3/vs/vpServoPhotometric.h>
+
+int main()
+{
+  vpImage<unsigned char> I(240, 320), Id(240, 320);
+  vpCameraParameters cam(300, 300, 160, 120);
+  // ... acquire the desired image Id
+
+  vpFeatureLuminance sI, sId;
+  sI.init(I.getHeight(), I.getWidth(), 1.0);
+  sI.setCameraParameters(cam);
+  sId.init(Id.getHeight(), Id.getWidth(), 1.0);
+  sId.setCameraParameters(cam);
+  sId.buildFrom(Id);
+
+  vpServoPhotometric servo;
+  servo.setLambda(30);
+  servo.setDampingType(vpServoPhotometric::LEVENBERG_MARQUARDT);
+  servo.setMu(0.01);
+  servo.setInteractionMatrixType(vpFeatureLuminance::DESIRED);
+
+  for (int iter = 0; iter < 100; iter++) {
+    // ... acquire the current image I
+    sI.buildFrom(I);
+    vpColVector v = servo.computeControlLaw(sI, sId);
+    // ... send v to the robot
+  }
+}
+  \endcode
+*/
+class VISP_EXPORT vpServoPhotometric
+{
+public:
+  //! Damping term added to \f$ {\bf H} = {\bf L}^\top {\bf L} \f$.
+  typedef enum {
+    GAUSS_NEWTON,       /*!< No damping. */
+    LEVENBERG,          /*!< \f$ {\bf H} + \mu {\bf I} \f$. */
+    LEVENBERG_MARQUARDT /*!< \f$ {\bf H} + \mu\, \mathrm{diag}({\bf H}) \f$. */
+  } vpDampingType;
+
+  vpServoPhotometric();
+  virtual ~vpServoPhotometric() {}
+
+  vpColVector computeControlLaw(const vpFeatureLuminance &s, const vpFeatureLuminance &s_star);
+
+  /*! Return the damping term used by computeControlLaw(). */
+  inline vpDampingType getDampingType() const { return m_dampingType; }
+  /*! Return \f$ {\bf e}^\top {\bf e} \f$ computed during the last call to computeControlLaw(). */
+  inline double getErrorSquaredNorm() const { return m_errorSquaredNorm; }
+  /*! Return the image gradient used to compute the interaction matrix. */
+  inline vpFeatureLuminance::vpLuminanceInteractionType getInteractionMatrixType() const { return m_interactionType; }
+  /*! Return the gain \f$ \lambda \f$. */
+  inline double getLambda() const { return m_lambda; }
+  /*! Return \f$ {\bf L}^\top {\bf e} \f$ computed during the last call to computeControlLaw(). */
+  inline const vpColVector &getLTe() const { return m_LTe; }
+  /*! Return \f$ {\bf L}^\top {\bf L} \f$ computed during the last call to computeControlLaw(). */
+  inline const vpMatrix &getLTL() const { return m_LTL; }
+  /*! Return the current damping factor \f$ \mu \f$. */
+  inline double getMu() const { return m_mu; }
+
+  /*! Set the damping term, vpServoPhotometric::LEVENBERG_MARQUARDT by default. */
+  inline void setDampingType(const vpDampingType &type) { m_dampingType = type; }
+  /*!
+    Set the image gradient used to compute the interaction matrix, vpFeatureLuminance::DESIRED
+    by default.
+  */
+  inline void setInteractionMatrixType(const vpFeatureLuminance::vpLuminanceInteractionType &type) {
+    m_interactionType = type;
+  }
+  /*! Set the gain \f$ \lambda \f$. */
+  inline void setLambda(const double lambda) { m_lambda = lambda; }
+  void setMu(const double mu);
+  void setMuUpdate(const double decrease, const double increase);
+
+private:
+  //! Damping term
+  vpDampingType m_dampingType;
+  //! Squared norm of the last error
+  double m_errorSquaredNorm;
+  //! Damped Hessian, kept to avoid allocations
+  vpMatrix m_H;
+  //! Image gradient used for the interaction matrix
+  vpFeatureLuminance::vpLuminanceInteractionType m_interactionType;
+  //! Gain
+  double m_lambda;
+  //! L^T e
+  vpColVector m_LTe;
+  //! L^T L
+  vpMatrix m_LTL;
+  //! Damping factor
+  double m_mu;
+  //! Factor applied to mu when the error decreases
+  double m_muDecrease;
+  //! Factor applied to mu when the error increases
+  double m_muIncrease;
+};
+
+#endif
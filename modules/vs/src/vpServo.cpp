@@ -41,6 +41,8 @@
 
 #include <visp3/vs/vpServo.h>
 
+#include <cmath>
+#include <limits>
 #include <sstream>
 
 // Exception
@@ -49,6 +51,79 @@
 // Debug trace
 #include <visp3/core/vpDebug.h>
 
+namespace {
+  void copyTwist(const vpVelocityTwistMatrix &V, vpMatrix &M)
+  {
+    if (M.getRows() != 6 || M.getCols() != 6)
+      M.resize(6, 6, false);
+    for (unsigned int i = 0; i < 6; i++)
+      for (unsigned int j = 0; j < 6; j++)
+        M[i][j] = V[i][j];
+  }
+
+  //! Number of rows of the task stacked from a feature list.
+  unsigned int stackedDimension(const std::list<vpBasicFeature *> &featureList,
+                                const std::list<unsigned int> &featureSelectionList)
+  {
+    unsigned int dim = 0;
+    std::list<vpBasicFeature *>::const_iterator it;
+    std::list<unsigned int>::const_iterator it_select;
+    for (it = featureList.begin(), it_select = featureSelectionList.begin(); it != featureList.end(); ++it, ++it_select)
+      dim += (*it)->getDimension(*it_select);
+
+    return dim;
+  }
+
+  /*!
+    Stack the interaction matrices of the features in \e L if L already has the size of
+    the stacked task, that is as many rows as the sum of the feature dimensions and 6
+    columns. Return false if it has not, or if the features did not fill it exactly.
+  */
+  bool fillInteractionMatrixFromList(const std::list<vpBasicFeature *> &featureList,
+                                     const std::list<unsigned int> &featureSelectionList, vpMatrix &L)
+  {
+    if (L.getRows() == 0 || L.getCols() != 6 || L.getRows() != stackedDimension(featureList, featureSelectionList))
+      return false;
+
+    unsigned int cursorL = 0;
+    std::list<vpBasicFeature *>::const_iterator it;
+    std::list<unsigned int>::const_iterator it_select;
+    for (it = featureList.begin(), it_select = featureSelectionList.begin(); it != featureList.end(); ++it, ++it_select)
+      cursorL += (*it)->fillInteraction(*it_select, L, cursorL);
+
+    return cursorL == L.getRows();
+  }
+
+  /*!
+    Stack s, s* and the error of the features if the vectors already have the size of
+    the stacked task. Return false if they have not, or if the features did not fill
+    them exactly.
+  */
+  bool fillErrorFromList(const std::list<vpBasicFeature *> &featureList,
+                         const std::list<vpBasicFeature *> &desiredFeatureList,
+                         const std::list<unsigned int> &featureSelectionList,
+                         vpColVector &s, vpColVector &sStar, vpColVector &error)
+  {
+    const unsigned int dim = stackedDimension(featureList, featureSelectionList);
+    if (dim == 0 || error.getRows() != dim || s.getRows() != dim
+        || sStar.getRows() != stackedDimension(desiredFeatureList, featureSelectionList))
+      return false;
+
+    unsigned int cursorS = 0, cursorSStar = 0, cursorError = 0;
+    std::list<vpBasicFeature *>::const_iterator it_s;
+    std::list<vpBasicFeature *>::const_iterator it_s_star;
+    std::list<unsigned int>::const_iterator it_select;
+    for (it_s = featureList.begin(), it_s_star = desiredFeatureList.begin(), it_select = featureSelectionList.begin();
+         it_s != featureList.end(); ++it_s, ++it_s_star, ++it_select) {
+      cursorS += (*it_s)->fillState(*it_select, s, cursorS);
+      cursorSStar += (*it_s_star)->fillState(*it_select, sStar, cursorSStar);
+      cursorError += (*it_s)->fillError(**it_s_star, *it_select, error, cursorError);
+    }
+
+    return cursorS == s.getRows() && cursorSStar == sStar.getRows() && cursorError == error.getRows();
+  }
+}
+
 /*!
   \file vpServo.cpp
   \brief  Class required to compute the visual servoing control law
@@ -73,7 +148,8 @@ vpServo::vpServo()
     cVf(), init_cVf(false), fVe(), init_fVe(false), eJe(), init_eJe(false), fJe(), init_fJe(false),
     errorComputed(false), interactionMatrixComputed(false), dim_task(0), taskWasKilled(false),
     forceInteractionMatrixComputation(false), WpW(), I_WpW(), P(), sv(), mu(4.), e1_initial(),
-    iscJcIdentity(true), cJc(6,6)
+    iscJcIdentity(true), cJc(6,6), Lstar(), cVa(6,6), LcJc(), LcVa(), imJ1(), imJ1t(),
+    J1te()
 {
   cJc.eye();
 }
@@ -98,7 +174,8 @@ vpServo::vpServo(vpServoType servo_type)
     cVf(), init_cVf(false), fVe(), init_fVe(false), eJe(), init_eJe(false), fJe(), init_fJe(false),
     errorComputed(false), interactionMatrixComputed(false), dim_task(0), taskWasKilled(false),
     forceInteractionMatrixComputation(false), WpW(), I_WpW(), P(), sv(), mu(4), e1_initial(),
-    iscJcIdentity(true), cJc(6,6)
+    iscJcIdentity(true), cJc(6,6), Lstar(), cVa(6,6), LcJc(), LcVa(), imJ1(), imJ1t(),
+    J1te()
 {
   cJc.eye();
 }
@@ -669,79 +746,62 @@ static void computeInteractionMatrixFromList  (const std::list<vpBasicFeature *>
 */
 vpMatrix vpServo::computeInteractionMatrix()
 {
-  try {
-
-    switch (interactionMatrixType)
-    {
-    case CURRENT:
-    {
-      try
-      {
-        computeInteractionMatrixFromList(this ->featureList,
-                                         this ->featureSelectionList,
-                                         L);
-        dim_task = L.getRows() ;
-        interactionMatrixComputed = true ;
-      }
-
-      catch(...)
-      {
-        throw ;
-      }
-    }
-      break ;
-    case DESIRED:
-    {
-      try
-      {
-        if (interactionMatrixComputed == false || forceInteractionMatrixComputation == true)
-        {
-          computeInteractionMatrixFromList(this ->desiredFeatureList,
-                                           this ->featureSelectionList, L);
+  updateInteractionMatrix();
+  return L ;
+}
 
-          dim_task = L.getRows() ;
-          interactionMatrixComputed = true ;
-        }
+/*!
+  Stack the interaction matrices of a feature list in \e Ls. As long as the sum of the
+  feature dimensions does not change, the features write their rows in place in the
+  matrix allocated by the previous call, see vpBasicFeature::fillInteraction().
+*/
+void vpServo::stackInteractionMatrix(const std::list<vpBasicFeature *> &list, vpMatrix &Ls)
+{
+  if (!fillInteractionMatrixFromList(list, featureSelectionList, Ls))
+    computeInteractionMatrixFromList(list, featureSelectionList, Ls);
+}
 
-      }
-      catch(...)
-      {
-        throw ;
-      }
-    }
-      break ;
-    case MEAN:
+/*!
+  Compute the interaction matrix \e L without returning a copy of it.
+*/
+void vpServo::updateInteractionMatrix()
+{
+  switch (interactionMatrixType)
+  {
+  case CURRENT:
+    stackInteractionMatrix(featureList, L);
+    dim_task = L.getRows() ;
+    interactionMatrixComputed = true ;
+    break ;
+  case DESIRED:
+    if (interactionMatrixComputed == false || forceInteractionMatrixComputation == true)
     {
-      vpMatrix Lstar (L.getRows(), L.getCols());
-      try
-      {
-        computeInteractionMatrixFromList(this ->featureList,
-                                         this ->featureSelectionList, L);
-        computeInteractionMatrixFromList(this ->desiredFeatureList,
-                                         this ->featureSelectionList, Lstar);
-      }
-      catch(...)
-      {
-        throw ;
-      }
-      L = (L+Lstar)/2;
-
+      stackInteractionMatrix(desiredFeatureList, L);
       dim_task = L.getRows() ;
       interactionMatrixComputed = true ;
     }
-      break ;
-    case USER_DEFINED:
-      // dim_task = L.getRows() ;
-      interactionMatrixComputed = false ;
-      break;
+    break ;
+  case MEAN:
+  {
+    stackInteractionMatrix(featureList, L);
+    stackInteractionMatrix(desiredFeatureList, Lstar);
+    if (L.getRows() != Lstar.getRows() || L.getCols() != Lstar.getCols()) {
+      throw(vpException(vpException::dimensionError, "Cannot add (%dx%d) matrix with (%dx%d) matrix",
+                        L.getRows(), L.getCols(), Lstar.getRows(), Lstar.getCols()));
     }
+    const unsigned int size = L.size();
+    for (unsigned int i = 0; i < size; i++)
+      L.data[i] = (L.data[i] + Lstar.data[i]) / 2;
 
+    dim_task = L.getRows() ;
+    interactionMatrixComputed = true ;
   }
-  catch(...)
-  {
-    throw ;
+    break ;
+  case USER_DEFINED:
+    // dim_task = L.getRows() ;
+    interactionMatrixComputed = false ;
+    return;
   }
-  return L ;
 }
 
 /*!
@@ -753,6 +813,17 @@ vpMatrix vpServo::computeInteractionMatrix()
 
 */
 vpColVector vpServo::computeError()
+{
+  updateError();
+  return error ;
+}
+
+/*!
+  Compute \e s, \e sStar and the error \e error without returning a copy of the error.
+  As long as the sum of the feature dimensions does not change, the features write their
+  values in place, see vpBasicFeature::fillState() and vpBasicFeature::fillError().
+*/
+void vpServo::updateError()
 {
   if (featureList.empty())
   {
@@ -767,6 +838,12 @@ vpColVector vpServo::computeError()
                            "feature list empty, cannot compute Ls")) ;
   }
 
+  if (fillErrorFromList(featureList, desiredFeatureList, featureSelectionList, s, sStar, error)) {
+    dim_task = error.getRows() ;
+    errorComputed = true ;
+    return;
+  }
+
   try {
     vpBasicFeature *current_s ;
     vpBasicFeature *desired_s ;
@@ -859,7 +936,6 @@ vpColVector vpServo::computeError()
   {
     throw ;
   }
-  return error ;
 }
 
 void vpServo::setError(vpColVector pid_error)
@@ -966,9 +1042,6 @@ vpColVector vpServo::computeControlLaw()
 
   try
   {
-    vpVelocityTwistMatrix cVa ; // Twist transformation matrix
-    vpMatrix aJe ;      // Jacobian
-
     if (iteration==0)
     {
       if (testInitialization() == false) {
@@ -984,6 +1057,7 @@ vpColVector vpServo::computeControlLaw()
     }
 
     // test if all the required initialization have been done
+    // cVa and aJe are not copied in temporary matrices to avoid allocations
     switch (servoType)
     {
     case NONE :
@@ -995,33 +1069,41 @@ vpColVector vpServo::computeControlLaw()
     case EYEINHAND_L_cVe_eJe:
     case EYETOHAND_L_cVe_eJe:
 
-      cVa = cVe ;
-      aJe = eJe ;
+      copyTwist(cVe, cVa) ;
 
       init_cVe = false ;
       init_eJe = false ;
       break ;
     case  EYETOHAND_L_cVf_fVe_eJe:
-      cVa = cVf*fVe ;
-      aJe = eJe ;
+      for (unsigned int i = 0; i < 6; i++) {
+        for (unsigned int j = 0; j < 6; j++) {
+          double sum = 0;
+          for (unsigned int k = 0; k < 6; k++)
+            sum += cVf[i][k] * fVe[k][j];
+          cVa[i][j] = sum;
+        }
+      }
       init_fVe = false ;
       init_eJe = false ;
       break ;
     case EYETOHAND_L_cVf_fJe    :
-      cVa = cVf ;
-      aJe = fJe ;
+      copyTwist(cVf, cVa) ;
       init_fJe = false ;
       break ;
     }
+    const vpMatrix &aJe = (servoType == EYETOHAND_L_cVf_fJe) ? fJe : eJe;
 
-    computeInteractionMatrix() ;
-    computeError() ;
+    updateInteractionMatrix() ;
+    updateError() ;
 
     // compute  task Jacobian
     if(iscJcIdentity)
-      J1 = L*cVa*aJe ;
-    else
-      J1 = L*cJc*cVa*aJe ;
+      vpMatrix::mult2Matrices(L, cVa, LcVa) ;
+    else {
+      vpMatrix::mult2Matrices(L, cJc, LcJc) ;
+      vpMatrix::mult2Matrices(LcJc, cVa, LcVa) ;
+    }
+    vpMatrix::mult2Matrices(LcVa, aJe, J1) ;
 
     // handle the eye-in-hand eye-to-hand case
     J1 *= signInteractionMatrix ;
@@ -1030,26 +1112,31 @@ vpColVector vpServo::computeControlLaw()
     // and rank of the task Jacobian
     // the image of J1 is also computed to allows the computation
     // of the projection operator
-    vpMatrix imJ1t, imJ1 ;
     bool imageComputed = false ;
+    const unsigned int n = J1.getCols();
+    // Task Jacobians are usually small enough to be inverted on stack storage
+    const bool smallJacobian = (J1.getRows() <= vpMatrix::smallMatrixMaxSize || n <= vpMatrix::smallMatrixMaxSize);
 
     if (inversionType==PSEUDO_INVERSE)
     {
-      rankJ1 = J1.pseudoInverse(J1p, sv, 1e-6, imJ1, imJ1t) ;
+      if (smallJacobian)
+        rankJ1 = J1.pseudoInverseSmall(J1p, sv, 1e-6, imJ1, imJ1t) ;
+      else
+        rankJ1 = J1.pseudoInverse(J1p, sv, 1e-6, imJ1, imJ1t) ;
 
       imageComputed = true ;
     }
     else
-      J1p = J1.t() ;
+      J1.transpose(J1p) ;
 
-    if (rankJ1 == J1.getCols())
+    if (rankJ1 == n)
     {
       /* if no degrees of freedom remains (rank J1 = ndof)
        WpW = I, multiply by WpW is useless
     */
-      e1 = J1p*error ;// primary task
+      vpMatrix::multMatrixVector(J1p, error, e1) ;// primary task
 
-      WpW.eye(J1.getCols(), J1.getCols()) ;
+      WpW.eye(n, n) ;
     }
     else
     {
@@ -1058,9 +1145,23 @@ vpColVector vpServo::computeControlLaw()
         vpMatrix Jtmp ;
         // image of J1 is computed to allows the computation
         // of the projection operator
-        rankJ1 = J1.pseudoInverse(Jtmp, sv, 1e-6, imJ1, imJ1t) ;
+        if (smallJacobian)
+          rankJ1 = J1.pseudoInverseSmall(Jtmp, sv, 1e-6, imJ1, imJ1t) ;
+        else
+          rankJ1 = J1.pseudoInverse(Jtmp, sv, 1e-6, imJ1, imJ1t) ;
+      }
+
+      // WpW = imJ1t*imJ1t.t()
+      if (WpW.getRows() != n || WpW.getCols() != n)
+        WpW.resize(n, n, false) ;
+      for (unsigned int i = 0; i < n; i++) {
+        for (unsigned int j = 0; j < n; j++) {
+          double sum = 0;
+          for (unsigned int k = 0; k < imJ1t.getCols(); k++)
+            sum += imJ1t[i][k] * imJ1t[j][k];
+          WpW[i][j] = sum;
+        }
       }
-      WpW = imJ1t*imJ1t.t() ;
 
 #ifdef DEBUG
       std::cout << "rank J1: " << rankJ1 << std::endl;
@@ -1071,13 +1172,16 @@ vpColVector vpServo::computeControlLaw()
       J1.print(std::cout, 10, "J1");
       J1p.print(std::cout, 10, "J1p");
 #endif
-      e1 = WpW*J1p*error ;
+      // e1 = WpW*J1p*error, e is used as temporary
+      vpMatrix::multMatrixVector(J1p, error, e) ;
+      vpMatrix::multMatrixVector(WpW, e, e1) ;
     }
-    e = - lambda(e1) * e1 ;
-
-    vpMatrix I ;
 
-    I.eye(J1.getCols(),J1.getCols()) ;
+    const double gain = lambda(e1) ;
+    if (e.getRows() != n)
+      e.resize(n, false) ;
+    for (unsigned int i = 0; i < n; i++)
+      e[i] = - gain * e1[i] ;
 
     computeProjectionOperators();
 
@@ -1144,7 +1248,7 @@ vpColVector vpServo::computeControlLaw_pid()
       break ;
     }
 
-    computeInteractionMatrix() ;
+    updateInteractionMatrix() ;
     //computeError() ;
     // setError();
 
@@ -1304,8 +1408,8 @@ vpColVector vpServo::computeControlLaw(double t)
       break ;
     }
 
-    computeInteractionMatrix() ;
-    computeError() ;
+    updateInteractionMatrix() ;
+    updateError() ;
 
     // compute  task Jacobian
     J1 = L*cVa*aJe ;
@@ -1467,8 +1571,8 @@ vpColVector vpServo::computeControlLaw(double t, const vpColVector &e_dot_init)
       break ;
     }
 
-    computeInteractionMatrix() ;
-    computeError() ;
+    updateInteractionMatrix() ;
+    updateError() ;
 
     // compute  task Jacobian
     J1 = L*cVa*aJe ;
@@ -1552,13 +1656,15 @@ void vpServo::computeProjectionOperators()
 {
   // Initialization
   unsigned int n = J1.getCols();
-  P.resize(n,n);
-
-  vpMatrix I;
-  I.eye(n);
+  if (P.getRows() != n || P.getCols() != n)
+    P.resize(n,n,false);
+  if (I_WpW.getRows() != n || I_WpW.getCols() != n)
+    I_WpW.resize(n,n,false);
 
   //Compute classical projection operator
-  I_WpW = (I - WpW) ;
+  for (unsigned int i = 0; i < n; i++)
+    for (unsigned int j = 0; j < n; j++)
+      I_WpW[i][j] = (i == j ? 1.0 : 0.0) - WpW[i][j];
 
   // Compute gain depending by the task error to ensure a smooth change between the operators.
   double e0_ = 0.1;
@@ -1573,17 +1679,24 @@ void vpServo::computeProjectionOperators()
   else
     sig = 0.0;
 
-  vpMatrix J1t = J1.transpose();
-
-  double pp = (error.t() * (J1 * J1t) * error);
-
-  vpMatrix  ee_t(n,n);
-  ee_t =  error * error.t();
-
-  vpMatrix P_norm_e(n,n);
-  P_norm_e = I - (1.0 / pp ) * J1t * ee_t * J1;
+  // e^T J1 J1^T e = |J1^T e|^2 and J1^T e e^T J1 = (J1^T e) (J1^T e)^T
+  if (J1te.getRows() != n)
+    J1te.resize(n,false);
+  double pp = 0;
+  for (unsigned int j = 0; j < n; j++) {
+    double sum = 0;
+    for (unsigned int i = 0; i < J1.getRows(); i++)
+      sum += J1[i][j] * error[i];
+    J1te[j] = sum;
+    pp += sum * sum;
+  }
 
-  P = sig * P_norm_e + (1 - sig) * I_WpW;
+  for (unsigned int i = 0; i < n; i++) {
+    for (unsigned int j = 0; j < n; j++) {
+      double P_norm_e = (i == j ? 1.0 : 0.0) - J1te[i] * J1te[j] / pp;
+      P[i][j] = sig * P_norm_e + (1 - sig) * I_WpW[i][j];
+    }
+  }
 
   return;
 }
@@ -0,0 +1,106 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Photometric visual servoing control law.
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpException.h>
+#include <visp3/vs/vpServoPhotometric.h>
+
+/*!
+  Default constructor: Levenberg-Marquardt damping with \f$ \mu = 0.01 \f$ kept constant,
+  \f$ \lambda = 1 \f$ and the interaction matrix computed at the desired position.
+*/
+vpServoPhotometric::vpServoPhotometric()
+  : m_dampingType(LEVENBERG_MARQUARDT), m_errorSquaredNorm(-1.0), m_H(6, 6), m_interactionType(vpFeatureLuminance::DESIRED),
+    m_lambda(1.0), m_LTe(6), m_LTL(6, 6), m_mu(0.01), m_muDecrease(1.0), m_muIncrease(1.0)
+{
+}
+
+/*!
+  Compute the camera velocity.
+
+  \param s : Current visual feature, built with vpFeatureLuminance::buildFrom().
+  \param s_star : Desired visual feature.
+  \return The camera velocity \f$ (v_x, v_y, v_z, \omega_x, \omega_y, \omega_z) \f$.
+*/
+vpColVector vpServoPhotometric::computeControlLaw(const vpFeatureLuminance &s, const vpFeatureLuminance &s_star)
+{
+  double errorSquaredNorm = s.computeNormalEquations(s_star, m_LTL, m_LTe, m_interactionType);
+
+  if (m_errorSquaredNorm >= 0) {
+    m_mu *= errorSquaredNorm < m_errorSquaredNorm ? m_muDecrease : m_muIncrease;
+  }
+  m_errorSquaredNorm = errorSquaredNorm;
+
+  m_H = m_LTL;
+  if (m_dampingType == LEVENBERG) {
+    for (unsigned int i = 0; i < 6; i++) {
+      m_H[i][i] += m_mu;
+    }
+  } else if (m_dampingType == LEVENBERG_MARQUARDT) {
+    for (unsigned int i = 0; i < 6; i++) {
+      m_H[i][i] += m_mu * m_LTL[i][i];
+    }
+  }
+
+  return -m_lambda * (m_H.inverseByLU() * m_LTe);
+}
+
+/*!
+  Set the damping factor \f$ \mu \f$. It is not used with vpServoPhotometric::GAUSS_NEWTON.
+
+  \param mu : Positive damping factor.
+*/
+void vpServoPhotometric::setMu(const double mu)
+{
+  if (mu < 0) {
+    throw vpException(vpException::badValue, "The damping factor should be positive");
+  }
+  m_mu = mu;
+}
+
+/*!
+  Set how the damping factor is updated after each call to computeControlLaw(). With the
+  default values of 1, \f$ \mu \f$ is kept constant.
+
+  \param decrease : Factor in ]0 ; 1] applied to \f$ \mu \f$ when the error decreased.
+  \param increase : Factor greater or equal to 1 applied to \f$ \mu \f$ otherwise.
+*/
+void vpServoPhotometric::setMuUpdate(const double decrease, const double increase)
+{
+  if (decrease <= 0 || decrease > 1 || increase < 1) {
+    throw vpException(vpException::badValue, "The damping update factors should be in ]0 ; 1] and [1 ; +inf[");
+  }
+  m_muDecrease = decrease;
+  m_muIncrease = increase;
+}
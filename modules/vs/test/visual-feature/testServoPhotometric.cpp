@@ -0,0 +1,213 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Photometric visual servoing from the normal equations.
+ *
+ *****************************************************************************/
+
+#include <cmath>
+#include <iostream>
+
+#include <visp3/core/vpCameraParameters.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpImageFilter.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/visual_features/vpFeatureLuminance.h>
+#include <visp3/vs/vpServoPhotometric.h>
+
+/*!
+  \example testServoPhotometric.cpp
+
+  \brief Check vpFeatureLuminance::computeNormalEquations() and vpServoPhotometric against the
+  pseudo-inverse of the interaction matrix, and compare their computation times.
+*/
+
+namespace {
+  void createImage(vpImage<unsigned char> &I, const unsigned int height, const unsigned int width,
+                   const double di, const double dj) {
+    I.resize(height, width);
+    for (unsigned int i = 0; i < height; i++) {
+      for (unsigned int j = 0; j < width; j++) {
+        double u = j + dj, v = i + di;
+        double val = 128 + 50 * sin(0.05 * u + 0.3 * sin(0.02 * v)) + 40 * cos(0.07 * v + 0.01 * u);
+        I[i][j] = (unsigned char) vpMath::saturate<unsigned char>(val);
+      }
+    }
+  }
+
+  double maxRelativeError(const vpMatrix &A, const vpMatrix &B) {
+    double maxError = 0, maxValue = 0;
+    for (unsigned int i = 0; i < A.getRows(); i++) {
+      for (unsigned int j = 0; j < A.getCols(); j++) {
+        maxError = (std::max)(maxError, std::fabs(A[i][j] - B[i][j]));
+        maxValue = (std::max)(maxValue, std::fabs(B[i][j]));
+      }
+    }
+    return maxValue > 0 ? maxError / maxValue : maxError;
+  }
+
+  bool checkNormalEquations(const vpFeatureLuminance &s, const vpFeatureLuminance &s_star, const vpMatrix &L,
+                            const vpColVector &e, const vpFeatureLuminance::vpLuminanceInteractionType &type,
+                            const std::string &name) {
+    vpMatrix LTL;
+    vpColVector LTe;
+    double eTe = s.computeNormalEquations(s_star, LTL, LTe, type);
+
+    double errorLTL = maxRelativeError(LTL, L.AtA());
+    double errorLTe = maxRelativeError(LTe, L.t() * e);
+    double errorETe = std::fabs(eTe - e.sumSquare()) / e.sumSquare();
+    std::cout << name << ": relative error on L^T L: " << errorLTL << ", on L^T e: " << errorLTe
+              << ", on e^T e: " << errorETe << std::endl;
+
+    return errorLTL < 1e-10 && errorLTe < 1e-10 && errorETe < 1e-10;
+  }
+}
+
+int main()
+{
+  try {
+    const unsigned int height = 480, width = 640;
+    const double Z = 1.0;
+    vpCameraParameters cam(600, 600, width / 2, height / 2);
+
+    vpImage<unsigned char> I, Id;
+    createImage(Id, height, width, 0, 0);
+    createImage(I, height, width, 1.5, -2.0);
+
+    vpFeatureLuminance sI, sId;
+    sI.init(height, width, Z);
+    sI.setCameraParameters(cam);
+    sI.buildFrom(I);
+    sId.init(height, width, Z);
+    sId.setCameraParameters(cam);
+    sId.buildFrom(Id);
+
+    // The row-wise gradient has to give the same interaction matrix as vpImageFilter
+    vpMatrix L, Ld;
+    sI.interaction(L);
+    sId.interaction(Ld);
+    const unsigned int bord = 10;
+    unsigned int m = 0;
+    for (unsigned int i = bord; i < height - bord; i++) {
+      for (unsigned int j = bord; j < width - bord; j++, m++) {
+        double Ix = cam.get_px() * vpImageFilter::derivativeFilterX(I, i, j);
+        double Iy = cam.get_py() * vpImageFilter::derivativeFilterY(I, i, j);
+        if (L[m][0] != Ix / Z || L[m][1] != Iy / Z) {
+          std::cerr << "Wrong gradient at pixel (" << i << ", " << j << ")" << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    vpColVector e;
+    sI.error(sId, e);
+    if (!checkNormalEquations(sI, sId, L, e, vpFeatureLuminance::CURRENT, "Current interaction matrix") ||
+        !checkNormalEquations(sI, sId, Ld, e, vpFeatureLuminance::DESIRED, "Desired interaction matrix") ||
+        !checkNormalEquations(sI, sId, 0.5 * (L + Ld), e, vpFeatureLuminance::MEAN, "Mean interaction matrix")) {
+      return EXIT_FAILURE;
+    }
+
+    // The result does not depend on the number of threads
+    vpMatrix LTL1, LTL4;
+    vpColVector LTe1, LTe4;
+    sI.computeNormalEquations(sId, LTL1, LTe1);
+    sI.setNbThreads(4);
+    sI.buildFrom(I);
+    sI.computeNormalEquations(sId, LTL4, LTe4);
+    if (maxRelativeError(LTL1, LTL4) != 0 || maxRelativeError(LTe1, LTe4) != 0) {
+      std::cerr << "The normal equations depend on the number of threads" << std::endl;
+      return EXIT_FAILURE;
+    }
+    sI.setNbThreads(1);
+
+    // Gauss-Newton gives the same velocity as the pseudo-inverse of the interaction matrix
+    // computed by vpServo::computeControlLaw()
+    const double lambda = 30;
+    vpServoPhotometric servo;
+    servo.setDampingType(vpServoPhotometric::GAUSS_NEWTON);
+    servo.setInteractionMatrixType(vpFeatureLuminance::CURRENT);
+    servo.setLambda(lambda);
+
+    const int nbIterationsServo = 3, nbIterations = 30;
+    vpColVector v_ref, v;
+    double t = vpTime::measureTimeMs();
+    for (int iter = 0; iter < nbIterationsServo; iter++) {
+      sI.buildFrom(I);
+      sI.interaction(L);
+      sI.error(sId, e);
+      v_ref = -lambda * (L.pseudoInverse() * e);
+    }
+    double t_servo = (vpTime::measureTimeMs() - t) / nbIterationsServo;
+
+    t = vpTime::measureTimeMs();
+    for (int iter = 0; iter < nbIterations; iter++) {
+      sI.buildFrom(I);
+      v = servo.computeControlLaw(sI, sId);
+    }
+    double t_normal = (vpTime::measureTimeMs() - t) / nbIterations;
+
+    double errorV = maxRelativeError(v, v_ref);
+    std::cout << "Pseudo-inverse velocity: " << v_ref.t() << std::endl;
+    std::cout << "vpServoPhotometric velocity: " << v.t() << std::endl;
+    if (errorV > 1e-6) {
+      std::cerr << "The velocities differ, relative error: " << errorV << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    sI.setNbThreads(4);
+    t = vpTime::measureTimeMs();
+    for (int iter = 0; iter < nbIterations; iter++) {
+      sI.buildFrom(I);
+      v = servo.computeControlLaw(sI, sId);
+    }
+    double t_parallel = (vpTime::measureTimeMs() - t) / nbIterations;
+
+    std::cout << "Mean time per iteration on a " << height << "x" << width << " image: pseudo-inverse: " << t_servo
+              << " ms (" << 1000 / t_servo << " Hz) ; vpServoPhotometric: " << t_normal << " ms (" << 1000 / t_normal
+              << " Hz) ; with 4 threads: " << t_parallel << " ms (" << 1000 / t_parallel << " Hz)" << std::endl;
+
+    // The damping factor is updated with the error
+    servo.setDampingType(vpServoPhotometric::LEVENBERG_MARQUARDT);
+    servo.setMu(0.01);
+    servo.setMuUpdate(0.5, 2);
+    sI.buildFrom(Id);
+    servo.computeControlLaw(sI, sId);
+    if (servo.getErrorSquaredNorm() != 0 || servo.getMu() != 0.005) {
+      std::cerr << "Wrong damping factor update: " << servo.getMu() << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+  } catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
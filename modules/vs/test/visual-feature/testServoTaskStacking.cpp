@@ -0,0 +1,238 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * In place task stacking and control law of vpServo.
+ *
+ *****************************************************************************/
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpHomogeneousMatrix.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/visual_features/vpFeaturePoint.h>
+#include <visp3/visual_features/vpFeatureThetaU.h>
+#include <visp3/vs/vpServo.h>
+
+/*!
+  \example testServoTaskStacking.cpp
+
+  \brief Check that vpServo::computeControlLaw(), which stacks the task in place and
+  inverts small task Jacobians with a dedicated SVD, matches the velocity computed from
+  the interaction matrices and vpMatrix::pseudoInverse(), and that its matrices are
+  not reallocated from one iteration to the other.
+*/
+
+namespace {
+  double maxError(const vpMatrix &A, const vpMatrix &B) {
+    if (A.getRows() != B.getRows() || A.getCols() != B.getCols()) {
+      return 1e10;
+    }
+    double err = 0;
+    for (unsigned int i = 0; i < A.size(); i++) {
+      err = (std::max)(err, std::fabs(A.data[i] - B.data[i]));
+    }
+    return err;
+  }
+
+  /*!
+    Reference velocity -lambda (L cVa aJe)^+ e and projection operator W^+W computed from
+    the features.
+  */
+  void referenceControlLaw(const std::vector<vpBasicFeature *> &cur, const std::vector<vpBasicFeature *> &des,
+                           const vpServo::vpServoIteractionMatrixType &type, const vpMatrix &cVaJe,
+                           const double lambda, vpColVector &v, vpMatrix &WpW, unsigned int &rank) {
+    vpMatrix L(0, 6);
+    vpColVector e;
+    for (size_t i = 0; i < cur.size(); i++) {
+      cur[i]->setFlags();
+      des[i]->setFlags();
+      vpMatrix Li = (type == vpServo::DESIRED) ? des[i]->interaction() : cur[i]->interaction();
+      if (type == vpServo::MEAN) {
+        Li = (Li + des[i]->interaction()) / 2;
+      }
+      L = vpMatrix::stack(L, Li);
+      e.stack(cur[i]->error(*des[i]));
+    }
+
+    vpMatrix J1 = L * cVaJe, J1p, imJ1, imJ1t;
+    vpColVector sv;
+    rank = J1.pseudoInverse(J1p, sv, 1e-6, imJ1, imJ1t);
+    v = -lambda * (J1p * e);
+    WpW = imJ1t * imJ1t.t();
+  }
+
+  bool checkTask(const std::string &name, vpServo &task, const std::vector<vpBasicFeature *> &cur,
+                 const std::vector<vpBasicFeature *> &des, const vpMatrix &cVaJe, const vpColVector &v) {
+    vpColVector v_ref;
+    vpMatrix WpW_ref;
+    unsigned int rank_ref;
+    referenceControlLaw(cur, des, task.interactionMatrixType, cVaJe, 0.5, v_ref, WpW_ref, rank_ref);
+
+    double errV = maxError(v, v_ref), errWpW = maxError(task.getWpW(), WpW_ref);
+    if (errV > 1e-9 || errWpW > 1e-9 || task.getTaskRank() != rank_ref) {
+      std::cerr << name << ": velocity error " << errV << ", WpW error " << errWpW << ", rank "
+                << task.getTaskRank() << " instead of " << rank_ref << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  void buildPoints(std::vector<vpFeaturePoint> &points, const vpHomogeneousMatrix &cMo) {
+    const double X[4][3] = { {-0.1, -0.1, 0}, {0.1, -0.1, 0}, {0.1, 0.1, 0}, {-0.1, 0.1, 0.05} };
+    for (size_t i = 0; i < points.size(); i++) {
+      vpColVector oP(4), cP(4);
+      oP[0] = X[i % 4][0]; oP[1] = X[i % 4][1]; oP[2] = X[i % 4][2]; oP[3] = 1;
+      cP = cMo * oP;
+      points[i].buildFrom(cP[0] / cP[2], cP[1] / cP[2], cP[2]);
+    }
+  }
+
+  bool testTask(const std::string &name, const vpServo::vpServoType &servoType,
+                const vpServo::vpServoIteractionMatrixType &type, const vpMatrix &eJe,
+                const unsigned int nbPoints, const bool coincidentPoints) {
+    vpHomogeneousMatrix cdMo(0, 0, 0.8, 0, 0, 0);
+    std::vector<vpFeaturePoint> p(nbPoints), pd(nbPoints);
+    buildPoints(pd, cdMo);
+    vpFeatureThetaU tu(vpFeatureThetaU::cdRc), tud(vpFeatureThetaU::cdRc);
+
+    vpVelocityTwistMatrix cVe(vpHomogeneousMatrix(0.01, 0.02, 0.1, 0, 0, vpMath::rad(10)));
+    vpServo task;
+    task.setServo(servoType);
+    task.setInteractionMatrixType(type);
+    task.setLambda(0.5);
+    if (servoType == vpServo::EYEINHAND_L_cVe_eJe) {
+      task.set_cVe(cVe);
+    }
+    vpMatrix cVaJe = (servoType == vpServo::EYEINHAND_L_cVe_eJe) ? vpMatrix(cVe) * eJe : eJe;
+
+    std::vector<vpBasicFeature *> cur, des;
+    for (unsigned int i = 0; i < nbPoints; i++) {
+      task.addFeature(p[i], pd[i]);
+      cur.push_back(&p[i]);
+      des.push_back(&pd[i]);
+    }
+
+    double *L_data = NULL, *J1_data = NULL, *J1p_data = NULL, *error_data = NULL;
+    for (unsigned int iter = 0; iter < 20; iter++) {
+      vpHomogeneousMatrix cMo(0.05 - 0.002 * iter, -0.03, 1.0 - 0.01 * iter,
+                              vpMath::rad(5), vpMath::rad(-3 + 0.2 * iter), vpMath::rad(20));
+      if (coincidentPoints) {
+        for (unsigned int i = 0; i < nbPoints; i++) {
+          p[i].buildFrom(0.1, -0.05 + 0.001 * iter, 1.0);
+        }
+      } else {
+        buildPoints(p, cMo);
+      }
+      tu.buildFrom(cMo * cdMo.inverse());
+
+      if (iter == 10 && type != vpServo::DESIRED) {
+        // The task layout changes
+        task.addFeature(tu, tud);
+        cur.push_back(&tu);
+        des.push_back(&tud);
+      }
+
+      if (servoType == vpServo::EYEINHAND_L_cVe_eJe) {
+        task.set_eJe(eJe);
+      }
+      vpColVector v = task.computeControlLaw();
+      if (!checkTask(name, task, cur, des, cVaJe, v)) {
+        std::cerr << name << " failed at iteration " << iter << std::endl;
+        task.kill();
+        return false;
+      }
+
+      if (iter == 1 || iter == 11) {
+        L_data = task.L.data; J1_data = task.J1.data; J1p_data = task.J1p.data; error_data = task.error.data;
+      } else if ((iter > 1 && iter < 10) || iter > 11) {
+        if (L_data != task.L.data || J1_data != task.J1.data || J1p_data != task.J1p.data ||
+            error_data != task.error.data) {
+          std::cerr << name << ": the task was reallocated at iteration " << iter << std::endl;
+          task.kill();
+          return false;
+        }
+      }
+    }
+
+    std::cout << name << ": ok, rank " << task.getTaskRank() << std::endl;
+    task.kill();
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+    vpMatrix I6, eJe7(6, 7);
+    I6.eye(6);
+    for (unsigned int i = 0; i < 6; i++) {
+      for (unsigned int j = 0; j < 7; j++) {
+        eJe7[i][j] = (i == j ? 1.0 : 0.0) + 0.1 * sin(1.0 + i + 2.0 * j);
+      }
+    }
+
+    if (!testTask("Eye-in-hand, current L", vpServo::EYEINHAND_CAMERA, vpServo::CURRENT, I6, 4, false) ||
+        !testTask("Eye-in-hand, mean L", vpServo::EYEINHAND_CAMERA, vpServo::MEAN, I6, 4, false) ||
+        !testTask("Eye-in-hand, desired L", vpServo::EYEINHAND_CAMERA, vpServo::DESIRED, I6, 4, false) ||
+        !testTask("Rank deficient task", vpServo::EYEINHAND_CAMERA, vpServo::CURRENT, I6, 3, true) ||
+        !testTask("Single point", vpServo::EYEINHAND_CAMERA, vpServo::CURRENT, I6, 1, false) ||
+        !testTask("7 joints robot", vpServo::EYEINHAND_L_cVe_eJe, vpServo::CURRENT, eJe7, 4, false)) {
+      return EXIT_FAILURE;
+    }
+
+    // Mean time of an iteration of a 4 points task
+    const unsigned int nbIterations = 10000;
+    std::vector<vpFeaturePoint> p(4), pd(4);
+    buildPoints(pd, vpHomogeneousMatrix(0, 0, 0.8, 0, 0, 0));
+    vpServo task;
+    task.setServo(vpServo::EYEINHAND_CAMERA);
+    task.setInteractionMatrixType(vpServo::CURRENT);
+    task.setLambda(0.5);
+    for (unsigned int i = 0; i < 4; i++) {
+      task.addFeature(p[i], pd[i]);
+    }
+    double t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nbIterations; iter++) {
+      buildPoints(p, vpHomogeneousMatrix(0.05, -0.03, 1.0, vpMath::rad(5), vpMath::rad(-3), vpMath::rad(20)));
+      task.computeControlLaw();
+    }
+    t = (vpTime::measureTimeMs() - t) / nbIterations;
+    task.kill();
+
+    std::cout << "Mean time of vpServo::computeControlLaw() for 4 points: " << t * 1000 << " us" << std::endl;
+    return EXIT_SUCCESS;
+  } catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}